@@ -14,31 +14,46 @@
 #include "advection.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "bvals/boundary_conditions.hpp"
 #include "bvals/bvals.hpp"
+#include "bvals/bvals_swarm.hpp"
+#include "coordinates/coordinates.hpp"
 #include "driver/multistage.hpp"
+#include "interface/initial_condition.hpp"
+#include "interface/meshblock_pack.hpp"
 #include "interface/params.hpp"
 #include "interface/state_descriptor.hpp"
+#include "interface/swarm.hpp"
+#include "interface/update_timestep.hpp"
 #include "mesh/mesh.hpp"
+#include "outputs/outputs.hpp"
 #include "parthenon_manager.hpp"
 #include "reconstruct/reconstruction.hpp"
+#include "refinement/amr_criteria.hpp"
 #include "refinement/refinement.hpp"
 
 using parthenon::BlockStageNamesIntegratorTask;
 using parthenon::BlockStageNamesIntegratorTaskFunc;
 using parthenon::BlockTask;
 using parthenon::CellVariable;
+using parthenon::DeviceCoordinates;
 using parthenon::Integrator;
+using parthenon::MeshBlockPack;
 using parthenon::Metadata;
 using parthenon::Params;
 using parthenon::ParArrayND;
 using parthenon::ParthenonManager;
+using parthenon::StageWeights;
+using parthenon::TaskName;
+using parthenon::Update::CellRegion;
 
 // *************************************************//
 // redefine some weakly linked parthenon functions *//
@@ -52,20 +67,6 @@ Packages_t ParthenonManager::ProcessPackages(std::unique_ptr<ParameterInput> &pi
   return packages;
 }
 
-void MeshBlock::ProblemGenerator(ParameterInput *pin) {
-  Container<Real> &rc = real_containers.Get();
-  CellVariable<Real> &q = rc.Get("advected");
-
-  for (int k = 0; k < ncells3; k++) {
-    for (int j = 0; j < ncells2; j++) {
-      for (int i = 0; i < ncells1; i++) {
-        Real rsq = std::pow(pcoord->x1v(i), 2) + std::pow(pcoord->x2v(j), 2);
-        q(k, j, i) = (rsq < 0.15 * 0.15 ? 1.0 : 0.0);
-      }
-    }
-  }
-}
-
 void ParthenonManager::SetFillDerivedFunctions() {
   FillDerivedVariables::SetFillDerivedFunctions(advection_example::Advection::PreFill,
                                                 advection_example::Advection::PostFill);
@@ -83,6 +84,15 @@ void ParthenonManager::SetFillDerivedFunctions() {
 namespace advection_example {
 namespace Advection {
 
+// a cylinder of radius 0.15 around the x3 axis, evaluated on the device for all blocks
+// in place of a host ProblemGenerator
+struct Cylinder {
+  KOKKOS_INLINE_FUNCTION Real operator()(const int n, const Real x1, const Real x2,
+                                         const Real x3) const {
+    return (x1 * x1 + x2 * x2 < 0.15 * 0.15 ? 1.0 : 0.0);
+  }
+};
+
 std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
   auto pkg = std::make_shared<StateDescriptor>("Advection");
 
@@ -96,15 +106,38 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
   pkg->AddParam<>("refine_tol", refine_tol);
   Real derefine_tol = pin->GetOrAddReal("Advection", "derefine_tol", 0.03);
   pkg->AddParam<>("derefine_tol", derefine_tol);
+  // <Advection>/fused_tagging = true tags with the same criterion, but as an AMRMinMax
+  // whose min and max the last update kernel reduces, instead of CheckRefinement.
+  // It sees the interior cells only, where CheckRefinement sees the ghost cells as well.
+  const bool fused_tagging = pin->GetOrAddBoolean("Advection", "fused_tagging", false);
+  pkg->AddParam<>("fused_tagging", fused_tagging);
+  // <Advection>/mesh_timestep = true estimates the time steps of all blocks of the rank
+  // in one launch after the last stage instead of one task per block
+  const bool mesh_timestep = pin->GetOrAddBoolean("Advection", "mesh_timestep", false);
+  pkg->AddParam<>("mesh_timestep", mesh_timestep);
+  // <Advection>/fused_timestep = true does the update of the last stage for all blocks of
+  // the rank in one launch that also estimates their time steps, see AdvectionDriver
+  const bool fused_timestep = pin->GetOrAddBoolean("Advection", "fused_timestep", false);
+  pkg->AddParam<>("fused_timestep", fused_timestep);
+  // <Advection>/tracers_per_block > 0 seeds every block with tracer particles on the
+  // first cycle, which move with the flow and go to their new blocks after each step
+  const int tracers = pin->GetOrAddInteger("Advection", "tracers_per_block", 0);
+  pkg->AddParam<>("tracers_per_block", tracers);
+  if (tracers > 0) pkg->AddSwarm("tracers", Metadata());
 
   std::string field_name = "advected";
   Metadata m(
       {Metadata::Cell, Metadata::Independent, Metadata::Graphics, Metadata::FillGhost});
   pkg->AddField(field_name, m);
+  // <Advection>/init_gl_order > 1 sets cell averages of the cylinder instead of its
+  // values at the cell centers
+  const int init_gl_order = pin->GetOrAddInteger("Advection", "init_gl_order", 0);
+  parthenon::InitialCondition::Enroll(pkg, field_name, Cylinder(), init_gl_order);
 
+  // the derived fields are only read by the outputs, so they are computed for these
   field_name = "one_minus_advected";
-  m = Metadata(
-      {Metadata::Cell, Metadata::Graphics, Metadata::Derived, Metadata::OneCopy});
+  m = Metadata({Metadata::Cell, Metadata::Graphics, Metadata::Derived,
+                Metadata::OnDemand, Metadata::OneCopy});
   pkg->AddField(field_name, m);
 
   field_name = "one_minus_advected_sq";
@@ -112,20 +145,26 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
 
   // for fun make this last one a multi-component field using SparseVariable
   field_name = "one_minus_sqrt_one_minus_advected_sq";
-  m = Metadata({Metadata::Cell, Metadata::Graphics, Metadata::Derived, Metadata::OneCopy,
-                Metadata::Sparse},
+  m = Metadata({Metadata::Cell, Metadata::Graphics, Metadata::Derived,
+                Metadata::OnDemand, Metadata::OneCopy, Metadata::Sparse},
                12 // just picking a sparse_id out of a hat for demonstration
   );
   pkg->AddField(field_name, m);
   // add another component
-  m = Metadata({Metadata::Cell, Metadata::Graphics, Metadata::Derived, Metadata::OneCopy,
-                Metadata::Sparse},
+  m = Metadata({Metadata::Cell, Metadata::Graphics, Metadata::Derived,
+                Metadata::OnDemand, Metadata::OneCopy, Metadata::Sparse},
                37 // just picking a sparse_id out of a hat for demonstration
   );
   pkg->AddField(field_name, m);
 
   pkg->FillDerived = SquareIt;
-  pkg->CheckRefinement = CheckRefinement;
+  if (fused_tagging) {
+    const int max_level = pin->GetOrAddInteger("mesh", "numlevel", 1);
+    pkg->amr_criteria.push_back(std::make_shared<parthenon::AMRMinMax>(
+        "advected", refine_tol, derefine_tol, max_level));
+  } else {
+    pkg->CheckRefinement = CheckRefinement;
+  }
   pkg->EstimateTimestep = EstimateTimestep;
 
   return pkg;
@@ -134,17 +173,23 @@ std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
 AmrTag CheckRefinement(Container<Real> &rc) {
   MeshBlock *pmb = rc.pmy_block;
   // refine on advected, for example.  could also be a derived quantity
-  CellVariable<Real> &v = rc.Get("advected");
-  Real vmin = 1.0;
-  Real vmax = 0.0;
-  for (int k = 0; k < pmb->ncells3; k++) {
-    for (int j = 0; j < pmb->ncells2; j++) {
-      for (int i = 0; i < pmb->ncells1; i++) {
-        vmin = (v(k, j, i) < vmin ? v(k, j, i) : vmin);
-        vmax = (v(k, j, i) > vmax ? v(k, j, i) : vmax);
-      }
-    }
-  }
+  const ParArrayND<Real> v = rc.Get("advected").data;
+  Real vmin = std::numeric_limits<Real>::max();
+  Real vmax = std::numeric_limits<Real>::lowest();
+  pmb->par_reduce(
+      "advection check refinement min", 0, pmb->ncells3 - 1, 0, pmb->ncells2 - 1, 0,
+      pmb->ncells1 - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lmin) {
+        lmin = (v(k, j, i) < lmin ? v(k, j, i) : lmin);
+      },
+      Kokkos::Min<Real>(vmin));
+  pmb->par_reduce(
+      "advection check refinement max", 0, pmb->ncells3 - 1, 0, pmb->ncells2 - 1, 0,
+      pmb->ncells1 - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lmax) {
+        lmax = (v(k, j, i) > lmax ? v(k, j, i) : lmax);
+      },
+      Kokkos::Max<Real>(vmax));
   auto pkg = pmb->packages["Advection"];
   const auto &refine_tol = pkg->Param<Real>("refine_tol");
   const auto &derefine_tol = pkg->Param<Real>("derefine_tol");
@@ -220,6 +265,20 @@ void PostFill(Container<Real> &rc) {
   }
 }
 
+// the stable time step of one cell for the constant velocity field.  It has the form
+// expected by Update::EstimateTimestep(Mesh *, ...), so the same functor serves a whole
+// pack of blocks as well as the single block below.
+struct CellTimestep {
+  Real cfl, abs_vx, abs_vy;
+  KOKKOS_INLINE_FUNCTION Real operator()(const MeshBlockPack<Real> &q,
+                                         const DeviceCoordinates &coords, const int b,
+                                         const int k, const int j, const int i) const {
+    const Real dt1 = coords.Dx1f(i) / abs_vx;
+    const Real dt2 = coords.Dx2f(j) / abs_vy;
+    return cfl * (dt1 < dt2 ? dt1 : dt2);
+  }
+};
+
 // provide the routine that estimates a stable timestep for this package
 Real EstimateTimestep(Container<Real> &rc) {
   MeshBlock *pmb = rc.pmy_block;
@@ -227,45 +286,90 @@ Real EstimateTimestep(Container<Real> &rc) {
   const auto &cfl = pkg->Param<Real>("cfl");
   const auto &vx = pkg->Param<Real>("vx");
   const auto &vy = pkg->Param<Real>("vy");
+  const CellTimestep cell_dt{cfl, std::abs(vx), std::abs(vy)};
+  const DeviceCoordinates coords = pmb->pcoord->GetDeviceCoordinates();
+  const MeshBlockPack<Real> q; // the estimate does not depend on the state
 
-  int is = pmb->is;
-  int js = pmb->js;
-  int ks = pmb->ks;
-  int ie = pmb->ie;
-  int je = pmb->je;
-  int ke = pmb->ke;
+  // this is obviously overkill for this constant velocity problem
+  Real min_dt;
+  pmb->par_reduce(
+      "advection estimate timestep", pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lmin) {
+        const Real dt = cell_dt(q, coords, 0, k, j, i);
+        lmin = (dt < lmin ? dt : lmin);
+      },
+      Kokkos::Min<Real>(min_dt));
+  return min_dt;
+}
 
-  Real min_dt = std::numeric_limits<Real>::max();
-  ParArrayND<Real> dx0("dx0", pmb->ncells1);
-  ParArrayND<Real> dx1("dx1", pmb->ncells1);
+// the same estimate for all blocks of the rank at once
+void EstimateTimestepOnMesh(Mesh *pmesh) {
+  if (pmesh->pblock == nullptr) return;
+  auto pkg = pmesh->pblock->packages["Advection"];
+  const auto &cfl = pkg->Param<Real>("cfl");
+  const auto &vx = pkg->Param<Real>("vx");
+  const auto &vy = pkg->Param<Real>("vy");
+  parthenon::Update::EstimateTimestep(pmesh, "base",
+                                      CellTimestep{cfl, std::abs(vx), std::abs(vy)});
+}
 
-  // this is obviously overkill for this constant velocity problem
-  for (int k = ks; k <= ke; k++) {
-    for (int j = js; j <= je; j++) {
-      pmb->pcoord->CenterWidth1(k, j, is, ie, dx0);
-      pmb->pcoord->CenterWidth2(k, j, is, ie, dx1);
-      for (int i = is; i <= ie; i++) {
-        min_dt = std::min(min_dt, dx0(i) / std::abs(vx));
-        min_dt = std::min(min_dt, dx1(i) / std::abs(vy));
-      }
-    }
-  }
+// base = wgt0 * base + wgt1 * u1 + dt * dUdt for all blocks of the rank, with the time
+// step of each block estimated on the new state in the same launch
+void UpdateAndEstimateTimestepOnMesh(Mesh *pmesh, const std::string &u1_name,
+                                     const Real wgt0, const Real wgt1, const Real dt) {
+  if (pmesh->pblock == nullptr) return;
+  auto pkg = pmesh->pblock->packages["Advection"];
+  const auto &cfl = pkg->Param<Real>("cfl");
+  const auto &vx = pkg->Param<Real>("vx");
+  const auto &vy = pkg->Param<Real>("vy");
+  parthenon::Update::StageUpdateAndEstimateTimestep(
+      pmesh, "base", u1_name, "dUdt", wgt0, wgt1, dt, "base",
+      CellTimestep{cfl, std::abs(vx), std::abs(vy)});
+}
+
+// places n tracers on a regular lattice over the block
+void SeedTracers(MeshBlock *pmb, const int n) {
+  parthenon::Swarm &swarm = *pmb->swarms.at("tracers");
+  const int first = swarm.AddEmptyParticles(n);
+  auto x = swarm.GetReal("x");
+  auto y = swarm.GetReal("y");
+  const int nrow = static_cast<int>(std::ceil(std::sqrt(static_cast<Real>(n))));
+  const parthenon::RegionSize &bs = pmb->block_size;
+  const Real x1min = bs.x1min, x2min = bs.x2min;
+  const Real dx = (bs.x1max - bs.x1min) / nrow, dy = (bs.x2max - bs.x2min) / nrow;
+  pmb->par_for(
+      "Advection::SeedTracers", 0, n - 1, KOKKOS_LAMBDA(const int p) {
+        x(first + p) = x1min + (p % nrow + 0.5) * dx;
+        y(first + p) = x2min + (p / nrow + 0.5) * dy;
+      });
+}
 
-  return cfl * min_dt;
+// moves the tracers of the block with the constant velocity field over dt
+void PushTracers(MeshBlock *pmb, const Real dt) {
+  parthenon::Swarm &swarm = *pmb->swarms.at("tracers");
+  auto pkg = pmb->packages["Advection"];
+  const Real dx = pkg->Param<Real>("vx") * dt, dy = pkg->Param<Real>("vy") * dt;
+  auto x = swarm.GetReal("x");
+  auto y = swarm.GetReal("y");
+  pmb->par_for(
+      "Advection::PushTracers", 0, swarm.GetNumActive() - 1, KOKKOS_LAMBDA(const int p) {
+        x(p) += dx;
+        y(p) += dy;
+      });
 }
 
 // Compute fluxes at faces given the constant velocity field and
 // some field "advected" that we are pushing around.
 // This routine implements all the "physics" in this example
 TaskStatus CalculateFluxes(Container<Real> &rc) {
-  MeshBlock *pmb = rc.pmy_block;
-  int is = pmb->is;
-  int js = pmb->js;
-  int ks = pmb->ks;
-  int ie = pmb->ie;
-  int je = pmb->je;
-  int ke = pmb->ke;
+  CalculateFluxesInRegions(rc, {parthenon::Update::InteriorRegion(rc.pmy_block, 0)});
+  return TaskStatus::complete;
+}
 
+// Compute the fluxes on all faces of the cells in the given regions
+void CalculateFluxesInRegions(Container<Real> &rc,
+                              const std::vector<parthenon::Update::CellRegion> &regions) {
+  MeshBlock *pmb = rc.pmy_block;
   CellVariable<Real> &q = rc.Get("advected");
   auto pkg = pmb->packages["Advection"];
   const auto &vx = pkg->Param<Real>("vx");
@@ -275,48 +379,52 @@ TaskStatus CalculateFluxes(Container<Real> &rc) {
   ParArrayND<Real> ql("ql", maxdim);
   ParArrayND<Real> qr("qr", maxdim);
   ParArrayND<Real> qltemp("qltemp", maxdim);
+  ParArrayND<Real> x1flux = q.GetFlux(parthenon::X1DIR);
+  ParArrayND<Real> x2flux;
+  if (pmb->pmy_mesh->ndim >= 2) x2flux = q.GetFlux(parthenon::X2DIR);
 
-  // get x-fluxes
-  for (int k = ks; k <= ke; k++) {
-    for (int j = js; j <= je; j++) {
-      // get reconstructed state on faces
-      pmb->precon->DonorCellX1(k, j, is - 1, ie + 1, q.data, ql, qr);
-      if (vx > 0.0) {
-        for (int i = is; i <= ie + 1; i++) {
-          q.flux[0](k, j, i) = ql(i) * vx;
-        }
-      } else {
-        for (int i = is; i <= ie + 1; i++) {
-          q.flux[0](k, j, i) = qr(i) * vx;
-        }
-      }
-    }
-  }
-  // get y-fluxes
-  if (pmb->pmy_mesh->ndim >= 2) {
+  for (const auto &r : regions) {
+    const int is = r.is, ie = r.ie, js = r.js, je = r.je, ks = r.ks, ke = r.ke;
+    // get x-fluxes
     for (int k = ks; k <= ke; k++) {
-      pmb->precon->DonorCellX2(k, js - 1, is, ie, q.data, ql, qr);
-      for (int j = js; j <= je + 1; j++) {
-        pmb->precon->DonorCellX2(k, j, is, ie, q.data, qltemp, qr);
-        if (vy > 0.0) {
-          for (int i = is; i <= ie; i++) {
-            q.flux[1](k, j, i) = ql(i) * vy;
+      for (int j = js; j <= je; j++) {
+        // get reconstructed state on faces
+        pmb->precon->DonorCellX1(k, j, is - 1, ie + 1, q.data, ql, qr);
+        if (vx > 0.0) {
+          for (int i = is; i <= ie + 1; i++) {
+            x1flux(k, j, i) = ql(i) * vx;
           }
         } else {
-          for (int i = is; i <= ie; i++) {
-            q.flux[1](k, j, i) = qr(i) * vy;
+          for (int i = is; i <= ie + 1; i++) {
+            x1flux(k, j, i) = qr(i) * vx;
+          }
+        }
+      }
+    }
+    // get y-fluxes
+    if (pmb->pmy_mesh->ndim >= 2) {
+      for (int k = ks; k <= ke; k++) {
+        pmb->precon->DonorCellX2(k, js - 1, is, ie, q.data, ql, qr);
+        for (int j = js; j <= je + 1; j++) {
+          pmb->precon->DonorCellX2(k, j, is, ie, q.data, qltemp, qr);
+          if (vy > 0.0) {
+            for (int i = is; i <= ie; i++) {
+              x2flux(k, j, i) = ql(i) * vy;
+            }
+          } else {
+            for (int i = is; i <= ie; i++) {
+              x2flux(k, j, i) = qr(i) * vy;
+            }
           }
+          auto temp = ql;
+          ql = qltemp;
+          qltemp = temp;
         }
-        auto temp = ql;
-        ql = qltemp;
-        qltemp = temp;
       }
     }
   }
 
   // TODO(jcd): implement z-fluxes
-
-  return TaskStatus::complete;
 }
 
 } // namespace Advection
@@ -328,125 +436,308 @@ TaskStatus CalculateFluxes(Container<Real> &rc) {
 // *************************************************//
 // first some helper tasks
 TaskStatus UpdateContainer(MeshBlock *pmb, int stage,
-                           std::vector<std::string> &stage_name, Integrator *integrator) {
-  // const Real beta = stage_wghts[stage-1].beta;
-  const Real beta = integrator->beta[stage - 1];
-  Container<Real> &base = pmb->real_containers.Get();
-  Container<Real> &cin = pmb->real_containers.Get(stage_name[stage - 1]);
-  Container<Real> &cout = pmb->real_containers.Get(stage_name[stage]);
+                           std::vector<std::string> &register_name,
+                           Integrator *integrator,
+                           const std::vector<CellRegion> &regions, const bool cycle_end) {
+  const StageWeights &w = integrator->stage_wghts[stage - 1];
+  Container<Real> &s1 = pmb->real_containers.Get(register_name[0]);
+  // registers the integrator does not use have zero weights and alias the state
+  Container<Real> &s2 =
+      (integrator->nregisters > 1) ? pmb->real_containers.Get(register_name[1]) : s1;
+  Container<Real> &s3 =
+      (integrator->nregisters > 2) ? pmb->real_containers.Get(register_name[2]) : s1;
   Container<Real> &dudt = pmb->real_containers.Get("dUdt");
-  parthenon::Update::AverageContainers(cin, base, beta);
-  parthenon::Update::UpdateContainer(cin, dudt, beta * pmb->pmy_mesh->dt, cout);
+  // the refinement criterion is evaluated along with the update that ends the cycle
+  const bool tag_refinement =
+      (cycle_end && pmb->packages["Advection"]->Param<bool>("fused_tagging"));
+  const Real dt = pmb->pmy_mesh->LevelDt(pmb->loc.level);
+  parthenon::Update::LowStorageUpdateInRegions(s1, s2, s3, dudt, w.delta, w.gam1, w.gam2,
+                                               w.gam3, w.beta * dt, stage == 1, regions,
+                                               tag_refinement);
   return TaskStatus::complete;
 }
 
+AdvectionDriver::AdvectionDriver(ParameterInput *pin, Mesh *pm, Outputs *pout)
+    : MultiStageBlockTaskDriver(pin, pm, pout) {
+  if (!pin->GetOrAddBoolean("Advection", "fused_timestep", false)) return;
+  // the fused update ends the cycle, which the last stage of a level does not
+  if (pm->subcycling) {
+    throw std::invalid_argument(
+        "<Advection>/fused_timestep does not support <time>/subcycling");
+  }
+  // the fused update is a StageUpdate, which has no S2 accumulation and no S3 term
+  const StageWeights &w = integrator->stage_wghts.back();
+  if (w.delta != 0.0 || w.gam3 != 0.0) {
+    throw std::invalid_argument("<Advection>/fused_timestep needs an integrator whose "
+                                "last stage reads only S1 and S2, e.g. rk2");
+  }
+  if (persistent_task_lists_) {
+    throw std::invalid_argument(
+        "<Advection>/fused_timestep does not support <time>/persistent_task_lists");
+  }
+}
+
 // See the advection.hpp declaration for a description of how this function gets called.
 TaskList AdvectionDriver::MakeTaskList(MeshBlock *pmb, int stage) {
+  return MakeTaskList(pmb, stage, StagePart::whole);
+}
+
+TaskList AdvectionDriver::MakeTaskList(MeshBlock *pmb, int stage, StagePart part) {
   TaskList tl;
   // we're going to populate our list with multiple kinds of tasks
   // these lambdas just clean up the interface to adding tasks of the relevant kinds
-  auto AddMyTask = [&tl, pmb, stage, this](BlockStageNamesIntegratorTaskFunc func,
+  auto AddMyTask = [&tl, pmb, stage, this](const std::string &name,
+                                           BlockStageNamesIntegratorTaskFunc func,
                                            TaskID dep) {
-    return tl.AddTask<BlockStageNamesIntegratorTask>(func, dep, pmb, stage, stage_name,
-                                                     integrator);
+    return tl.AddTask<BlockStageNamesIntegratorTask>(TaskName(name), func, dep, pmb,
+                                                     stage, register_name, integrator);
   };
-  auto AddContainerTask = [&tl](ContainerTaskFunc func, TaskID dep, Container<Real> &rc) {
-    return tl.AddTask<ContainerTask>(func, dep, rc);
+  auto AddContainerTask = [&tl](const std::string &name, ContainerTaskFunc func,
+                                TaskID dep, Container<Real> &rc) {
+    return tl.AddTask<ContainerTask>(TaskName(name), func, dep, rc);
   };
-  auto AddTwoContainerTask = [&tl](TwoContainerTaskFunc f, TaskID dep,
-                                   Container<Real> &rc1, Container<Real> &rc2) {
-    return tl.AddTask<TwoContainerTask>(f, dep, rc1, rc2);
+  auto AddTwoContainerTask = [&tl](const std::string &name, TwoContainerTaskFunc f,
+                                   TaskID dep, Container<Real> &rc1,
+                                   Container<Real> &rc2) {
+    return tl.AddTask<TwoContainerTask>(TaskName(name), f, dep, rc1, rc2);
   };
 
   TaskID none(0);
   // first make other useful containers
-  if (stage == 1) {
+  if (stage == 1 && part != StagePart::exchange) {
     Container<Real> &base = pmb->real_containers.Get();
     pmb->real_containers.Add("dUdt", base);
-    for (int i = 1; i < integrator->nstages; i++)
-      pmb->real_containers.Add(stage_name[i], base);
+    for (int i = 1; i < integrator->nregisters; i++)
+      pmb->real_containers.Add(register_name[i], base);
   }
 
   // pull out the container we'll use to get fluxes and/or compute RHSs
-  Container<Real> &sc0 = pmb->real_containers.Get(stage_name[stage - 1]);
+  Container<Real> &sc0 = pmb->real_containers.Get(register_name[0]);
   // pull out a container we'll use to store dU/dt.
   // This is just -flux_divergence in this example
   Container<Real> &dudt = pmb->real_containers.Get("dUdt");
-  // pull out the container that will hold the updated state
-  // effectively, sc1 = sc0 + dudt*dt
-  Container<Real> &sc1 = pmb->real_containers.Get(stage_name[stage]);
+  // pull out the container that will hold the updated state. The low-storage
+  // integrators update the state in place, so this is sc0 again
+  Container<Real> &sc1 = pmb->real_containers.Get(register_name[0]);
+
+  // The shell of the block holds the cells that are packed into the send buffers. It is
+  // updated first, so that the interior is computed while the messages are in flight.
+  const int width = parthenon::Update::ShellWidth(pmb);
+  const std::vector<CellRegion> shell = parthenon::Update::ShellRegions(pmb, width);
+  const std::vector<CellRegion> interior{parthenon::Update::InteriorRegion(pmb, width)};
+  auto FluxTask = [&tl](Container<Real> &rc, const std::vector<CellRegion> &regions,
+                        TaskID dep) {
+    return tl.AddTask<ContainerTask>(
+        TaskName("CalculateFluxes"),
+        [regions](Container<Real> &rc) {
+          Advection::CalculateFluxesInRegions(rc, regions);
+          return TaskStatus::complete;
+        },
+        dep, rc);
+  };
+  auto FluxDivTask = [&tl](Container<Real> &rc, Container<Real> &du,
+                           const std::vector<CellRegion> &regions, TaskID dep) {
+    return tl.AddTask<TwoContainerTask>(
+        TaskName("FluxDivergence"),
+        [regions](Container<Real> &rc, Container<Real> &du) {
+          parthenon::Update::FluxDivergenceInRegions(rc, du, regions);
+          return TaskStatus::complete;
+        },
+        dep, rc, du);
+  };
+  const bool cycle_end = CycleEndsWithStage(stage);
+  auto UpdateTask = [&AddMyTask, cycle_end](const std::vector<CellRegion> &regions,
+                                            TaskID dep) {
+    return AddMyTask(
+        "UpdateContainer",
+        [regions, cycle_end](MeshBlock *pmb, int stage,
+                             std::vector<std::string> &register_name,
+                             Integrator *integrator) {
+          return UpdateContainer(pmb, stage, register_name, integrator, regions,
+                                 cycle_end);
+        },
+        dep);
+  };
 
-  auto start_recv = AddContainerTask(Container<Real>::StartReceivingTask, none, sc1);
+  // With deep halos, all stages but the last one update the ghost cells the following
+  // stages read as well, and need no communication at all
+  if (!ExchangeAfterStage(stage)) {
+    const std::vector<CellRegion> extended{
+        parthenon::Update::InteriorRegion(pmb, -StageExtension(stage))};
+    auto flux = FluxTask(sc0, extended, none);
+    auto div = FluxDivTask(sc0, dudt, extended, flux);
+    auto update = UpdateTask(extended, div);
+    // ghost cells beyond physical boundaries are set by the boundary conditions instead
+    auto set_bc = AddContainerTask("ApplyBoundaryConditions",
+                                   parthenon::ApplyBoundaryConditions, update, sc1);
+    AddContainerTask("FillDerived", parthenon::FillDerivedVariables::FillDerived, set_bc,
+                     sc1);
+    return tl;
+  }
 
-  auto advect_flux = AddContainerTask(Advection::CalculateFluxes, none, sc0);
+  TaskID send, updated = none;
+  if (part == StagePart::exchange) {
+    // Step() has updated all blocks, only the ghost cells are left
+    send = AddContainerTask("SendBoundaryBuffers",
+                            Container<Real>::SendBoundaryBuffersTask, none, sc1);
+  } else {
+    auto start_recv = AddContainerTask("StartReceiving",
+                                       Container<Real>::StartReceivingTask, none, sc1);
+
+    auto shell_flux = FluxTask(sc0, shell, none);
+
+    auto send_flux = AddContainerTask(
+        "SendFluxCorrection", Container<Real>::SendFluxCorrectionTask, shell_flux, sc0);
+    // the interior needs no ghost data and overlaps with the flux correction messages
+    auto interior_flux = FluxTask(sc0, interior, none);
+    auto recv_flux =
+        AddContainerTask("ReceiveFluxCorrection",
+                         Container<Real>::ReceiveFluxCorrectionTask, shell_flux, sc0);
+
+    // compute the divergence of fluxes of conserved variables
+    auto shell_div = FluxDivTask(sc0, dudt, shell, recv_flux);
+    if (part == StagePart::divergence) {
+      // the update and everything after it wait for Step()
+      FluxDivTask(sc0, dudt, interior, interior_flux);
+      return tl;
+    }
 
-  auto send_flux =
-      AddContainerTask(Container<Real>::SendFluxCorrectionTask, advect_flux, sc0);
-  auto recv_flux =
-      AddContainerTask(Container<Real>::ReceiveFluxCorrectionTask, advect_flux, sc0);
+    // apply du/dt to all independent fields in the container. If sc1 is sc0 (in-place
+    // updates), the fluxes, which read sc0 across the shell boundary, go first.
+    auto shell_update =
+        UpdateTask(shell, (&sc1 == &sc0) ? (shell_div | interior_flux) : shell_div);
 
-  // compute the divergence of fluxes of conserved variables
-  auto flux_div =
-      AddTwoContainerTask(parthenon::Update::FluxDivergence, recv_flux, sc0, dudt);
+    // update ghost cells
+    send = AddContainerTask("SendBoundaryBuffers",
+                            Container<Real>::SendBoundaryBuffersTask, shell_update, sc1);
 
-  // apply du/dt to all independent fields in the container
-  auto update_container = AddMyTask(UpdateContainer, flux_div);
+    // finish the interior while the boundary buffers are in flight
+    auto interior_div = FluxDivTask(sc0, dudt, interior, interior_flux);
+    updated = UpdateTask(interior, interior_div | shell_update);
+  }
 
-  // update ghost cells
-  auto send =
-      AddContainerTask(Container<Real>::SendBoundaryBuffersTask, update_container, sc1);
-  auto recv = AddContainerTask(Container<Real>::ReceiveBoundaryBuffersTask, send, sc1);
-  auto fill_from_bufs = AddContainerTask(Container<Real>::SetBoundariesTask, recv, sc1);
-  auto clear_comm_flags =
-      AddContainerTask(Container<Real>::ClearBoundaryTask, fill_from_bufs, sc1);
+  auto recv = AddContainerTask("ReceiveBoundaryBuffers",
+                               Container<Real>::ReceiveBoundaryBuffersTask, send, sc1);
+  auto fill_from_bufs =
+      AddContainerTask("SetBoundaries", Container<Real>::SetBoundariesTask, recv, sc1);
+  auto clear_comm_flags = AddContainerTask(
+      "ClearBoundary", Container<Real>::ClearBoundaryTask, fill_from_bufs, sc1);
 
   auto prolongBound = tl.AddTask<BlockTask>(
+      TaskName("ProlongateBoundaries"),
       [](MeshBlock *pmb) {
         pmb->pbval->ProlongateBoundaries(0.0, 0.0);
         return TaskStatus::complete;
       },
-      fill_from_bufs, pmb);
+      fill_from_bufs | updated, pmb);
 
   // set physical boundaries
-  auto set_bc = AddContainerTask(parthenon::ApplyBoundaryConditions, prolongBound, sc1);
+  auto set_bc = AddContainerTask("ApplyBoundaryConditions",
+                                 parthenon::ApplyBoundaryConditions, prolongBound, sc1);
 
   // fill in derived fields
-  auto fill_derived =
-      AddContainerTask(parthenon::FillDerivedVariables::FillDerived, set_bc, sc1);
+  auto fill_derived = AddContainerTask(
+      "FillDerived", parthenon::FillDerivedVariables::FillDerived, set_bc, sc1);
+
+  if (cycle_end) AddCycleEndTasks(tl, pmb, fill_derived, part == StagePart::whole);
+  return tl;
+}
 
-  // estimate next time step
-  if (stage == integrator->nstages) {
-    auto new_dt = AddContainerTask(
+// a subcycled step runs these once all levels have caught up
+TaskList AdvectionDriver::MakeCycleEndTaskList(MeshBlock *pmb) {
+  TaskList tl;
+  TaskID none(0);
+  AddCycleEndTasks(tl, pmb, none, true);
+  return tl;
+}
+
+void AdvectionDriver::AddCycleEndTasks(TaskList &tl, MeshBlock *pmb, TaskID dep,
+                                       const bool estimate_timestep) {
+  Container<Real> &sc1 = pmb->real_containers.Get(register_name[0]);
+  // estimate next time step, unless Step() does it for all blocks
+  if (estimate_timestep && !pmb->packages["Advection"]->Param<bool>("mesh_timestep")) {
+    tl.AddTask<ContainerTask>(
+        TaskName("EstimateTimestep"),
         [](Container<Real> &rc) {
           MeshBlock *pmb = rc.pmy_block;
           pmb->SetBlockTimestep(parthenon::Update::EstimateTimestep(rc));
           return TaskStatus::complete;
         },
-        fill_derived, sc1);
-
-    // Update refinement
-    if (pmesh->adaptive) {
-      auto tag_refine = tl.AddTask<BlockTask>(
-          [](MeshBlock *pmb) {
-            pmb->pmr->CheckRefinementCondition();
-            return TaskStatus::complete;
-          },
-          fill_derived, pmb);
-    }
-    // Purge stages -- this task isn't really required.  If we don't purge the containers
-    // then the next time we go to add them, they'll already exist and it will be a no-op.
-    // Not purging the stages is more performant, but if the "base" Container changes, we
-    // need to purge the stages and recreate the non-base containers or else there will be
-    // bugs, e.g. the containers for rk stages won't have the same variables as the "base"
-    // container, likely leading to strange errors and/or segfaults.
+        dep, sc1);
+  }
+
+  // the outputs due at the end of the cycle copy the data of the block to the host
+  // while the other blocks still compute
+  pouts->AddOutputTasks(tl, dep, pmb, pinput);
+
+  // Update refinement
+  if (pmesh->adaptive) {
+    auto tag_refine = tl.AddTask<BlockTask>(
+        TaskName("CheckRefinement"),
+        [](MeshBlock *pmb) {
+          pmb->pmr->CheckRefinementCondition();
+          return TaskStatus::complete;
+        },
+        dep, pmb);
+  }
+  // Purge stages -- this task isn't really required.  If we don't purge the containers
+  // then the next time we go to add them, they'll already exist and it will be a no-op.
+  // Not purging the stages is more performant, but if the "base" Container changes, we
+  // need to purge the stages and recreate the non-base containers or else there will be
+  // bugs, e.g. the containers for rk stages won't have the same variables as the "base"
+  // container, likely leading to strange errors and/or segfaults.
+  // Persistent task lists hold on to the stage containers, so they must not be purged.
+  if (!persistent_task_lists_) {
     auto purge_stages = tl.AddTask<BlockTask>(
+        TaskName("PurgeNonBase"),
         [](MeshBlock *pmb) {
           pmb->real_containers.PurgeNonBase();
           return TaskStatus::complete;
         },
-        fill_derived, pmb);
+        dep, pmb);
   }
-  return tl;
+}
+
+TaskListStatus AdvectionDriver::Step() {
+  auto pkg = pmesh->packages["Advection"];
+  const int tracers = pkg->Param<int>("tracers_per_block");
+  if (tracers > 0 && pmesh->ncycle == 0) {
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      Advection::SeedTracers(pmb, tracers);
+    }
+  }
+  const bool fused_timestep = pkg->Param<bool>("fused_timestep");
+  TaskListStatus status =
+      fused_timestep ? StepWithFusedTimestep() : MultiStageBlockTaskDriver::Step();
+  if (status != TaskListStatus::complete) return status;
+  if (pkg->Param<bool>("mesh_timestep") && !fused_timestep) {
+    Advection::EstimateTimestepOnMesh(pmesh);
+  }
+  if (tracers > 0) {
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      Advection::PushTracers(pmb, pmesh->dt);
+    }
+    parthenon::SwarmBoundaries::Exchange(pmesh, "tracers");
+  }
+  return status;
+}
+
+TaskListStatus AdvectionDriver::StepWithFusedTimestep() {
+  using parthenon::DriverUtils::ConstructAndExecuteBlockTasks;
+  const int nstages = integrator->nstages;
+  TaskListStatus status;
+  for (int stage = 1; stage < nstages; stage++) {
+    status = ConstructAndExecuteBlockTasks<>(this, stage);
+    if (status != TaskListStatus::complete) return status;
+  }
+  status = ConstructAndExecuteBlockTasks<>(this, nstages, StagePart::divergence);
+  if (status != TaskListStatus::complete) return status;
+  // the constructor made sure that the last stage is S1 = gam1 * S1 + gam2 * S2 + ...
+  const StageWeights &w = integrator->stage_wghts[nstages - 1];
+  const std::string &s2 = register_name[std::min(1, integrator->nregisters - 1)];
+  Advection::UpdateAndEstimateTimestepOnMesh(pmesh, s2, w.gam1, w.gam2,
+                                             w.beta * pmesh->dt);
+  return ConstructAndExecuteBlockTasks<>(this, nstages, StagePart::exchange);
 }
 
 } // namespace advection_example
@@ -14,11 +14,14 @@
 #define EXAMPLE_ADVECTION_ADVECTION_HPP_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "driver/driver.hpp"
 #include "driver/multistage.hpp"
 #include "interface/container.hpp"
 #include "interface/state_descriptor.hpp"
+#include "interface/update.hpp"
 #include "mesh/mesh.hpp"
 #include "task_list/tasks.hpp"
 
@@ -34,14 +37,14 @@ using parthenon::Real;
 using parthenon::StateDescriptor;
 using parthenon::TaskID;
 using parthenon::TaskList;
+using parthenon::TaskListStatus;
 using parthenon::TaskStatus;
 
 namespace advection_example {
 
 class AdvectionDriver : public MultiStageBlockTaskDriver {
  public:
-  AdvectionDriver(ParameterInput *pin, Mesh *pm, Outputs *pout)
-      : MultiStageBlockTaskDriver(pin, pm, pout) {}
+  AdvectionDriver(ParameterInput *pin, Mesh *pm, Outputs *pout);
   // This next function essentially defines the driver.
   // Call graph looks like
   // main()
@@ -50,6 +53,23 @@ class AdvectionDriver : public MultiStageBlockTaskDriver {
   //       DriverUtils::ConstructAndExecuteBlockTasks (driver.hpp)
   //         AdvectionDriver::MakeTaskList (advection.cpp)
   TaskList MakeTaskList(MeshBlock *pmb, int stage);
+  // the stages of MultiStageBlockTaskDriver, followed with <Advection>/mesh_timestep by
+  // the time step estimate of all blocks and with <Advection>/tracers_per_block by the
+  // push and exchange of the tracers
+  TaskListStatus Step();
+  // With <Advection>/fused_timestep the last stage is split in two task lists: the one
+  // up to the flux divergence and, after Step() updated all blocks and estimated their
+  // time steps in one launch, the one from the boundary exchange on
+  enum class StagePart { whole, divergence, exchange };
+  TaskList MakeTaskList(MeshBlock *pmb, int stage, StagePart part);
+  TaskList MakeCycleEndTaskList(MeshBlock *pmb);
+
+ private:
+  TaskListStatus StepWithFusedTimestep();
+  // the time step estimate, outputs, refinement check and purge of the stage containers
+  // that follow the last update of the cycle, after dep
+  void AddCycleEndTasks(TaskList &tl, MeshBlock *pmb, TaskID dep,
+                        const bool estimate_timestep);
 };
 
 // demonstrate making a custom Task type
@@ -87,7 +107,14 @@ void PreFill(Container<Real> &rc);
 void SquareIt(Container<Real> &rc);
 void PostFill(Container<Real> &rc);
 Real EstimateTimestep(Container<Real> &rc);
+void EstimateTimestepOnMesh(Mesh *pmesh);
+void UpdateAndEstimateTimestepOnMesh(Mesh *pmesh, const std::string &u1_name,
+                                     const Real wgt0, const Real wgt1, const Real dt);
+void SeedTracers(MeshBlock *pmb, const int n);
+void PushTracers(MeshBlock *pmb, const Real dt);
 TaskStatus CalculateFluxes(Container<Real> &rc);
+void CalculateFluxesInRegions(Container<Real> &rc,
+                              const std::vector<parthenon::Update::CellRegion> &regions);
 
 } // namespace Advection
 
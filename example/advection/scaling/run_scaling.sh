@@ -0,0 +1,78 @@
+#!/bin/bash
+#=========================================================================================
+# (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+#
+# This program was produced under U.S. Government contract 89233218CNA000001 for Los
+# Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+# for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+# in the program are reserved by Triad National Security, LLC, and the U.S. Department
+# of Energy/National Nuclear Security Administration. The Government is granted for
+# itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+# license in this material to reproduce, prepare derivative works, distribute copies to
+# the public, perform publicly and display publicly, and to permit others to do so.
+#=========================================================================================
+
+# Runs the advection example on 1, 2, 4, ... ranks and collects the scaling report of
+# each run in a CSV table on stdout; the full output of each run is kept in
+# <mode>_<ranks>.log.
+#
+#   run_scaling.sh weak|strong <path to advection-example> [max ranks] [input overrides]
+#
+# For weak scaling the mesh of parthinput.weak is the share of one rank and is doubled
+# alternately in x1 and x2 with the number of ranks. For strong scaling the mesh of
+# parthinput.strong is used as is. Further arguments are passed on as input overrides,
+# e.g. mesh/refinement=adaptive or meshblock/nx1=32 meshblock/nx2=32.
+#
+# The MPI launcher is taken from MPIEXEC (default "mpiexec -n"); on GPU systems it has to
+# bind one GPU to each rank.
+
+set -e
+
+mode=$1
+exe=$2
+max_ranks=${3:-1}
+shift $(($# < 3 ? $# : 3))
+if [ "$mode" != "weak" ] && [ "$mode" != "strong" ] || [ ! -x "$exe" ]; then
+  echo "usage: $0 weak|strong <path to advection-example> [max ranks] [overrides]" >&2
+  exit 1
+fi
+mpiexec=${MPIEXEC:-mpiexec -n}
+deck=$(dirname "$0")/parthinput.$mode
+
+# the mesh size of one rank, or of all ranks for strong scaling
+nx1=$(awk -F= '/^<mesh>/{m=1} /^<meshblock>/{m=0} m && $1~/^nx1 */{print $2+0}' "$deck")
+nx2=$(awk -F= '/^<mesh>/{m=1} /^<meshblock>/{m=0} m && $1~/^nx2 */{print $2+0}' "$deck")
+
+echo "ranks,nx1,nx2,zone-cycles/wall_second,zone-cycles/wall_second/rank,efficiency,"\
+"compute,communication,amr,io,other"
+ranks=1
+doublings=0
+base=""
+while [ "$ranks" -le "$max_ranks" ]; do
+  if [ "$mode" = "weak" ]; then
+    mx1=$((nx1 << ((doublings + 1) / 2)))
+    mx2=$((nx2 << (doublings / 2)))
+  else
+    mx1=$nx1
+    mx2=$nx2
+  fi
+  log=${mode}_${ranks}.log
+  $mpiexec "$ranks" "$exe" -i "$deck" mesh/nx1="$mx1" mesh/nx2="$mx2" "$@" > "$log"
+
+  zcs=$(awk '/^zone-cycles\/wall_second =/{print $3}' "$log")
+  zcs_rank=$(awk '/^zone-cycles\/wall_second\/rank =/{print $3}' "$log")
+  # the average over ranks of each phase in percent of the wall time
+  phases=$(awk '/^(compute|communication|amr|io|other) /{printf ",%s", $5}' "$log")
+  if [ -z "$zcs" ]; then
+    echo "no scaling report in $log" >&2
+    exit 1
+  fi
+  # throughput per rank relative to one rank, which is the parallel efficiency of both
+  # weak and strong scaling
+  [ -z "$base" ] && base=$zcs_rank
+  efficiency=$(awk -v a="$zcs_rank" -v b="$base" 'BEGIN{printf "%.3f", a / b}')
+  echo "$ranks,$mx1,$mx2,$zcs,$zcs_rank,$efficiency$phases"
+
+  ranks=$((ranks * 2))
+  doublings=$((doublings + 1))
+done
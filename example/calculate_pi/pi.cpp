@@ -74,12 +74,11 @@ DriverStatus CalculatePi::Execute() {
     area += block_area;
     pmb = pmb->next;
   }
-#ifdef MPI_PARALLEL
-  Real pi_val;
-  MPI_Reduce(&area, &pi_val, 1, MPI_ATHENA_REAL, MPI_SUM, 0, MPI_COMM_WORLD);
-#else
-  Real pi_val = area;
-#endif
+  BatchedReduction reduction;
+  const int ipi = reduction.Add(area, ReductionOp::sum);
+  reduction.Start();
+  reduction.Wait();
+  Real pi_val = reduction.Get(ipi);
   if (my_rank == 0) {
     std::cout << std::endl
               << std::endl
@@ -23,6 +23,7 @@
 #include "task_list/tasks.hpp"
 
 using parthenon::AmrTag;
+using parthenon::BatchedReduction;
 using parthenon::BlockTask;
 using parthenon::BlockTaskFunc;
 using parthenon::CellVariable;
@@ -38,6 +39,7 @@ using parthenon::Outputs;
 using parthenon::ParameterInput;
 using parthenon::Params;
 using parthenon::Real;
+using parthenon::ReductionOp;
 using parthenon::StateDescriptor;
 using parthenon::TaskID;
 using parthenon::TaskList;
@@ -63,6 +63,9 @@ class ArgParse {
         case 'd': // -d <run_directory>
           prundir = argv[++i];
           break;
+        case 's': // -s <stage_directory>
+          stage_dir = argv[++i];
+          break;
         case 'n':
           narg_flag = 1;
           break;
@@ -86,6 +89,8 @@ class ArgParse {
             std::cout << "Options:" << std::endl;
             std::cout << "  -i <file>       specify input file [athinput]\n";
             std::cout << "  -r <file>       restart with this file\n";
+            std::cout << "  -s <directory>  restart from the copy of the file in this "
+                         "directory if present\n";
             std::cout << "  -d <directory>  specify run dir [current dir]\n";
             std::cout << "  -n              parse input file and quit\n";
             std::cout << "  -c              show configuration and quit\n";
@@ -111,6 +116,7 @@ class ArgParse {
   char *input_filename = nullptr;
   char *restart_filename = nullptr;
   char *prundir = nullptr;
+  char *stage_dir = nullptr;
   int res_flag = 0;
   int narg_flag = 0;
   int iarg_flag = 0;
@@ -30,6 +30,13 @@ using Real = double;
 #endif
 #endif
 
+// sums over many values and the simulation time, which accumulates many time steps, are
+// kept in double precision also when Real is float
+using AccumReal = double;
+#ifdef MPI_PARALLEL
+#define MPI_ATHENA_ACCUM_REAL MPI_DOUBLE
+#endif
+
 enum class TaskStatus { fail, complete, incomplete };
 enum class AmrTag : int { derefine = -1, same = 0, refine = 1 };
 
@@ -13,255 +13,185 @@
 
 #include "bvals/boundary_conditions.hpp"
 
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "bvals/bvals_interfaces.hpp"
+#include "bvals/user_boundary_condition.hpp"
+#include "coordinates/coordinates.hpp"
 #include "interface/container.hpp"
 #include "interface/container_iterator.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 
 namespace parthenon {
 
-TaskStatus ApplyBoundaryConditions(Container<Real> &rc) {
-  MeshBlock *pmb = rc.pmy_block;
-  const int is = pmb->is;
-  const int js = pmb->js;
-  const int ks = pmb->ks;
-  const int ie = pmb->ie;
-  const int je = pmb->je;
-  const int ke = pmb->ke;
-  const int imax = pmb->ncells1;
-  const int jmax = pmb->ncells2;
-  const int kmax = pmb->ncells3;
+FaceCells::FaceCells(const MeshBlock *pmb, const BoundaryFace face) : dir(face / 2) {
+  const bool inner = (face % 2 == 0);
+  const int s[3] = {pmb->is, pmb->js, pmb->ks};
+  const int e[3] = {pmb->ie, pmb->je, pmb->ke};
+  const int n[3] = {pmb->ncells1, pmb->ncells2, pmb->ncells3};
+  int lo[3] = {0, 0, pmb->ks}, hi[3] = {n[0] - 1, n[1] - 1, pmb->ke};
+  if (dir == X3DIR) {
+    lo[X3DIR] = 0;
+    hi[X3DIR] = n[2] - 1;
+  }
+  lo[dir] = inner ? 0 : e[dir] + 1;
+  hi[dir] = inner ? s[dir] - 1 : n[dir] - 1;
+  il = lo[0], iu = hi[0], jl = lo[1], ju = hi[1], kl = lo[2], ku = hi[2];
+  bnd = inner ? s[dir] : e[dir];
+  mirror = inner ? 2 * s[dir] - 1 : 2 * e[dir] + 1;
+}
 
-  Metadata m;
-  ContainerIterator<Real> citer(rc, {Metadata::Independent});
-  const int nvars = citer.vars.size();
+namespace {
 
-  switch (pmb->boundary_flag[BoundaryFace::inner_x1]) {
-  case BoundaryFlag::outflow:
-    for (int n = 0; n < nvars; n++) {
-      CellVariable<Real> &q = *citer.vars[n];
-      for (int l = 0; l < q.GetDim(4); l++) {
-        for (int k = ks; k <= ke; k++) {
-          for (int j = 0; j < jmax; j++) {
-            for (int i = 0; i < is; i++) {
-              q(l, k, j, i) = q(l, k, j, is);
-            }
-          }
-        }
-      }
-    }
-    break;
+// copies the interior cell next to the face
+struct OutflowFill {
+  static constexpr bool mirrored = false;
+  KOKKOS_INLINE_FUNCTION Real operator()(const DeviceCoordinates &coords, const int n,
+                                         const int k, const int j, const int i,
+                                         const Real q_src) const {
+    return q_src;
+  }
+};
+
+// mirrors the interior across the face, flipping the sign of component flip (the
+// component of a vector normal to the face, or -1)
+struct ReflectFill {
+  static constexpr bool mirrored = true;
+  KOKKOS_INLINE_FUNCTION Real operator()(const DeviceCoordinates &coords, const int n,
+                                         const int k, const int j, const int i,
+                                         const Real q_src) const {
+    return (n == flip) ? -q_src : q_src;
+  }
+  int flip;
+};
+
+// the same for a MeshBlockPack, vec_dir(n) being the direction of component n if it is
+// a component of a vector and -1 otherwise
+struct ReflectFillOnMesh {
+  static constexpr bool mirrored = true;
+  KOKKOS_INLINE_FUNCTION Real operator()(const DeviceCoordinates &coords, const int n,
+                                         const int k, const int j, const int i,
+                                         const Real q_src) const {
+    return (vec_dir(n) == dir) ? -q_src : q_src;
+  }
+  ParArray1D<int> vec_dir;
+  int dir;
+};
 
-  case BoundaryFlag::reflect:
-    for (int n = 0; n < nvars; n++) {
-      CellVariable<Real> &q = *citer.vars[n];
-      bool vec = q.IsSet(Metadata::Vector);
-      for (int l = 0; l < q.GetDim(4); l++) {
-        Real reflect = (l == 0 && vec ? -1.0 : 1.0);
-        for (int k = ks; k <= ke; k++) {
-          for (int j = 0; j < jmax; j++) {
-            for (int i = 0; i < is; i++) {
-              q(l, k, j, i) = reflect * q(l, k, j, 2 * is - i - 1);
-            }
-          }
-        }
-      }
-    }
-    break;
+bool IsPhysical(const BoundaryFlag flag) {
+  return flag == BoundaryFlag::outflow || flag == BoundaryFlag::reflect ||
+         flag == BoundaryFlag::user;
+}
 
-  default:
-    break;
+// the faces whose boundary conditions are applied for the dimensionality of the mesh
+int NumFaces(const Mesh *pmesh) { return 2 * pmesh->ndim; }
+
+const UserBoundaryCondition &GetUserBoundaryCondition(const Mesh *pmesh,
+                                                      const BoundaryFace face) {
+  const UserBoundaryCondition *bc = pmesh->GetUserBoundaryCondition(face);
+  if (bc == nullptr) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in ApplyBoundaryConditions" << std::endl
+        << "Boundary face " << face << " is user but no boundary condition was enrolled "
+        << "with Mesh::EnrollBoundaryCondition" << std::endl;
+    ATHENA_ERROR(msg);
   }
+  return *bc;
+}
 
-  switch (pmb->boundary_flag[BoundaryFace::outer_x1]) {
-  case BoundaryFlag::outflow:
-    for (int n = 0; n < nvars; n++) {
-      CellVariable<Real> &q = *citer.vars[n];
-      for (int l = 0; l < q.GetDim(4); l++) {
-        for (int k = ks; k <= ke; k++) {
-          for (int j = 0; j < jmax; j++) {
-            for (int i = ie + 1; i < imax; i++) {
-              q(l, k, j, i) = q(l, k, j, ie);
-            }
-          }
-        }
-      }
-    }
-    break;
+} // namespace
 
-  case BoundaryFlag::reflect:
+TaskStatus ApplyBoundaryConditions(Container<Real> &rc) {
+  MeshBlock *pmb = rc.pmy_block;
+  ContainerIterator<Real> citer(rc, {Metadata::Independent});
+  const int nvars = citer.vars.size();
+  const DeviceCoordinates &coords = pmb->pcoord->GetDeviceCoordinates();
+
+  for (int f = 0; f < NumFaces(pmb->pmy_mesh); f++) {
+    const auto face = static_cast<BoundaryFace>(f);
+    const BoundaryFlag flag = pmb->boundary_flag[face];
+    if (!IsPhysical(flag)) continue;
+    const FaceCells fc(pmb, face);
+    int n0 = 0;
     for (int n = 0; n < nvars; n++) {
-      CellVariable<Real> &q = *citer.vars[n];
-      bool vec = q.IsSet(Metadata::Vector);
-      for (int l = 0; l < q.GetDim(4); l++) {
-        Real reflect = (l == 0 && vec ? -1.0 : 1.0);
-        for (int k = ks; k <= ke; k++) {
-          for (int j = 0; j < jmax; j++) {
-            for (int i = ie + 1; i < imax; i++) {
-              q(l, k, j, i) = reflect * q(l, k, j, 2 * ie - i + 1);
-            }
-          }
-        }
+      CellVariable<Real> &v = *citer.vars[n];
+      ParArray4D<Real> q = v.data.Get<4>();
+      if (flag == BoundaryFlag::outflow) {
+        impl::FillFace(pmb->exec_space, fc, q, n0, coords, OutflowFill());
+      } else if (flag == BoundaryFlag::reflect) {
+        const int flip = v.IsSet(Metadata::Vector) ? n0 + fc.dir : -1;
+        impl::FillFace(pmb->exec_space, fc, q, n0, coords, ReflectFill{flip});
+      } else {
+        GetUserBoundaryCondition(pmb->pmy_mesh, face)
+            .Fill(pmb->exec_space, fc, q, n0, coords, pmb->pmy_mesh->time);
       }
+      n0 += v.GetDim(4);
     }
-    break;
-
-  default:
-    break;
   }
+  return TaskStatus::complete;
+}
 
-  if (pmb->pmy_mesh->ndim >= 2) {
-    switch (pmb->boundary_flag[BoundaryFace::inner_x2]) {
-    case BoundaryFlag::outflow:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        for (int l = 0; l < q.GetDim(4); l++) {
-          for (int k = ks; k <= ke; k++) {
-            for (int j = 0; j < js; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = q(l, k, js, i);
-              }
-            }
-          }
-        }
-      }
-      break;
-
-    case BoundaryFlag::reflect:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        bool vec = q.IsSet(Metadata::Vector);
-        for (int l = 0; l < q.GetDim(4); l++) {
-          Real reflect = (l == 1 && vec ? -1.0 : 1.0);
-          for (int k = ks; k <= ke; k++) {
-            for (int j = 0; j < js; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = reflect * q(l, k, 2 * js - j - 1, i);
-              }
-            }
-          }
-        }
-      }
-      break;
-
-    default:
-      break;
+TaskStatus ApplyBoundaryConditionsOnMesh(Mesh *pmesh, const std::string &stage_name) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (pmb == nullptr) return TaskStatus::complete;
+  const std::vector<MetadataFlag> flags({Metadata::Independent});
+  auto q = PackVariablesOnMesh(pmesh, stage_name, flags);
+  auto coords = PackCoordinatesOnMesh(pmesh);
+  const int nblocks = q.GetNBlocks();
+
+  // built on the first call and again after the blocks changed
+  Mesh::BoundaryConditionArrays &arrays = pmesh->bc_arrays[stage_name];
+  if (arrays.bflags.extent(0) == 0 || arrays.generation != pmesh->mesh_generation) {
+    arrays.generation = pmesh->mesh_generation;
+    arrays.bflags = ParArray2D<BoundaryFlag>("ApplyBoundaryConditions flags", nblocks, 6);
+    arrays.vec_dir = ParArray1D<int>("ApplyBoundaryConditions vec_dir", q.GetNVars());
+    auto bflags_h = Kokkos::create_mirror_view(arrays.bflags);
+    auto vec_dir_h = Kokkos::create_mirror_view(arrays.vec_dir);
+    for (int f = 0; f < 6; f++) {
+      arrays.any[f] = false;
     }
-
-    switch (pmb->boundary_flag[BoundaryFace::outer_x2]) {
-    case BoundaryFlag::outflow:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        for (int l = 0; l < q.GetDim(4); l++) {
-          for (int k = ks; k <= ke; k++) {
-            for (int j = je + 1; j < jmax; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = q(l, k, je, i);
-              }
-            }
-          }
-        }
+    int nb = 0;
+    for (MeshBlock *p = pmb; p != nullptr; p = p->next, nb++) {
+      for (int f = 0; f < 6; f++) {
+        bflags_h(nb, f) = p->boundary_flag[f];
+        arrays.any[f] = arrays.any[f] || IsPhysical(p->boundary_flag[f]);
       }
-      break;
-
-    case BoundaryFlag::reflect:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        bool vec = q.IsSet(Metadata::Vector);
-        for (int l = 0; l < q.GetDim(4); l++) {
-          Real reflect = (l == 1 && vec ? -1.0 : 1.0);
-          for (int k = ks; k <= ke; k++) {
-            for (int j = je + 1; j < jmax; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = reflect * q(l, k, 2 * je - j + 1, i);
-              }
-            }
-          }
-        }
-      }
-      break;
-
-    default:
-      break;
     }
-  } // if ndim>=2
-
-  if (pmb->pmy_mesh->ndim >= 3) {
-    switch (pmb->boundary_flag[BoundaryFace::inner_x3]) {
-    case BoundaryFlag::outflow:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        for (int l = 0; l < q.GetDim(4); l++) {
-          for (int k = 0; k < ks; k++) {
-            for (int j = 0; j < jmax; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = q(l, ks, j, i);
-              }
-            }
-          }
-        }
-      }
-      break;
-
-    case BoundaryFlag::reflect:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        bool vec = q.IsSet(Metadata::Vector);
-        for (int l = 0; l < q.GetDim(4); l++) {
-          Real reflect = (l == 2 && vec ? -1.0 : 1.0);
-          for (int k = 0; k < ks; k++) {
-            for (int j = 0; j < jmax; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = reflect * q(l, 2 * ks - k - 1, j, i);
-              }
-            }
-          }
-        }
+    int nc = 0;
+    for (auto &v : pmb->real_containers.Get(stage_name).GetVariablesByFlag(flags)) {
+      const bool vec = v->IsSet(Metadata::Vector);
+      for (int l = 0; l < v->GetDim(4); l++) {
+        vec_dir_h(nc++) = vec ? l : -1;
       }
-      break;
-
-    default:
-      break;
     }
-
-    switch (pmb->boundary_flag[BoundaryFace::outer_x3]) {
-    case BoundaryFlag::outflow:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        for (int l = 0; l < q.GetDim(4); l++) {
-          for (int k = ke + 1; k < kmax; k++) {
-            for (int j = 0; j < jmax; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = q(l, ke, j, i);
-              }
-            }
-          }
-        }
-      }
-      break;
-
-    case BoundaryFlag::reflect:
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *citer.vars[n];
-        bool vec = q.IsSet(Metadata::Vector);
-        for (int l = 0; l < q.GetDim(4); l++) {
-          Real reflect = (l == 2 && vec ? -1.0 : 1.0);
-          for (int k = ke + 1; k < kmax; k++) {
-            for (int j = 0; j < jmax; j++) {
-              for (int i = 0; i < imax; i++) {
-                q(l, k, j, i) = reflect * q(l, 2 * ke - k + 1, j, i);
-              }
-            }
-          }
-        }
-      }
-      break;
-
-    default:
-      break;
+    Kokkos::deep_copy(arrays.bflags, bflags_h);
+    Kokkos::deep_copy(arrays.vec_dir, vec_dir_h);
+  }
+  const auto &bflags = arrays.bflags;
+  const auto &vec_dir = arrays.vec_dir;
+  const bool *any = arrays.any;
+
+  // one launch per face for all blocks, as all blocks on a face of the domain share its
+  // flag; the others return right away
+  for (int f = 0; f < NumFaces(pmesh); f++) {
+    if (!any[f]) continue;
+    const auto face = static_cast<BoundaryFace>(f);
+    const BoundaryFlag flag = pmesh->mesh_bcs[face];
+    const FaceCells fc(pmb, face);
+    if (flag == BoundaryFlag::outflow) {
+      impl::FillFaceOnMesh(fc, f, flag, bflags, q, coords, OutflowFill());
+    } else if (flag == BoundaryFlag::reflect) {
+      impl::FillFaceOnMesh(fc, f, flag, bflags, q, coords,
+                           ReflectFillOnMesh{vec_dir, fc.dir});
+    } else if (flag == BoundaryFlag::user) {
+      GetUserBoundaryCondition(pmesh, face).FillOnMesh(fc, f, bflags, q, coords,
+                                                       pmesh->time);
     }
-  } // if ndim >= 3
-
+  }
   return TaskStatus::complete;
 }
 
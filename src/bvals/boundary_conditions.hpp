@@ -14,12 +14,23 @@
 #ifndef BVALS_BOUNDARY_CONDITIONS_HPP_
 #define BVALS_BOUNDARY_CONDITIONS_HPP_
 
+#include <string>
+
 #include "basic_types.hpp"
 #include "interface/container.hpp"
 
 namespace parthenon {
 
+class Mesh;
+
+// Fills the ghost cells of the faces of a block that lie on an outflow, reflecting or
+// user boundary of the domain (see bvals/user_boundary_condition.hpp), for all
+// independent variables. Runs on the device, one kernel per face and variable on the
+// execution space of the block.
 TaskStatus ApplyBoundaryConditions(Container<Real> &rc);
+// the same for every block of the rank, with a single launch per face; the container is
+// given by its name in MeshBlock::real_containers
+TaskStatus ApplyBoundaryConditionsOnMesh(Mesh *pmesh, const std::string &stage_name);
 
 } // namespace parthenon
 
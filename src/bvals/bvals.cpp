@@ -30,6 +30,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -49,12 +50,15 @@ namespace parthenon {
 // dirs of a MeshBlock
 BoundaryValues::BoundaryValues(MeshBlock *pmb, BoundaryFlag *input_bcs,
                                ParameterInput *pin)
-    : BoundaryBase(pmb->pmy_mesh, pmb->loc, pmb->block_size, input_bcs), pmy_block_(pmb) {
+    : BoundaryBase(pmb->pmy_mesh, pmb->loc, pmb->block_size, input_bcs),
+      flux_register_weight(), coarse_time_fraction(-1.0), pmy_block_(pmb),
+      batched_prolongation_(pin->GetOrAddBoolean("mesh", "batched_prolongation", false)) {
   // Check BC functions for each of the 6 boundaries in turn ---------------------
   for (int i = 0; i < 6; i++) {
     switch (block_bcs[i]) {
     case BoundaryFlag::reflect:
     case BoundaryFlag::outflow:
+    case BoundaryFlag::user:
       apply_bndry_fn_[i] = true;
       break;
     default: // already initialized to false in class
@@ -131,6 +135,40 @@ void BoundaryValues::ClearBoundary(BoundaryCommSubset phase) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryValues::ResetSubcycling()
+//  \brief back to the exchange with all neighbors after a subcycled step
+
+void BoundaryValues::ResetSubcycling() {
+  send_levels = LevelMask();
+  recv_levels = LevelMask();
+  flux_register_weight = 0.0;
+  coarse_time_fraction = -1.0;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryValues::StoreCoarseBoundaries(const CoarseTime when)
+//  \brief copy the coarse arrays, which hold the data of the coarser neighbors at the
+//  start or at the end of their step, for the interpolation in ProlongateBoundaries()
+
+void BoundaryValues::StoreCoarseBoundaries(const CoarseTime when) {
+  MeshBlock *pmb = pmy_block_;
+  MeshRefinement *pmr = pmb->pmr.get();
+  std::vector<ParArrayND<Real>> &copies =
+      (when == CoarseTime::start) ? coarse_start_ : coarse_end_;
+  copies.resize(pmr->pvars_cc_.size());
+  for (int v = 0; v < static_cast<int>(copies.size()); v++) {
+    const ParArrayND<Real> &coarse = std::get<1>(pmr->pvars_cc_[v]);
+    if (copies[v].GetSize() != coarse.GetSize()) {
+      copies[v] =
+          ParArrayND<Real>("coarse time level", coarse.GetDim(6), coarse.GetDim(5),
+                           coarse.GetDim(4), coarse.GetDim(3), coarse.GetDim(2),
+                           coarse.GetDim(1));
+    }
+    pmb->deep_copy(copies[v].Get(), coarse.Get());
+  }
+}
+
 // Public function, to be called in MeshBlock ctor for keeping MPI tag bitfields
 // consistent across MeshBlocks, even if certain MeshBlocks only construct a subset of
 // physical variable classes
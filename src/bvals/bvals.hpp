@@ -19,6 +19,7 @@
 //! \file bvals.hpp
 //  \brief defines BoundaryBase, BoundaryValues classes used for setting BCs on all data
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@
 
 #include "athena.hpp"
 #include "bvals/bvals_interfaces.hpp"
+#include "mesh/mesh_refinement.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
@@ -67,12 +69,13 @@ class BoundaryBase {
   LogicalLocation loc;
   BoundaryFlag block_bcs[6];
 
-  static int CreateBvalsMPITag(int lid, int bufid, int phys);
+  static int CreateBvalsMPITag(int lid, int bufid);
   static int CreateBufferID(int ox1, int ox2, int ox3, int fi1, int fi2);
   static int BufferID(int dim, bool multilevel);
   static int FindBufferID(int ox1, int ox2, int ox3, int fi1, int fi2);
 
   void SearchAndSetNeighbors(MeshBlockTree &tree, int *ranklist, int *nslist);
+  bool RemapNeighbors(const int *newgid, int *ranklist, int *nslist);
 
  protected:
   // 1D refined or unrefined=2
@@ -87,7 +90,12 @@ class BoundaryBase {
  private:
   // calculate 3x shared static data members when constructing only the 1st class instance
   // int maxneighbor_=BufferID() computes ni[] and then calls bufid[]=CreateBufferID()
+  // of a mesh configuration (dimensionality and multilevel), which is kept in called_
   static bool called_;
+  static int table_dim_;
+  static bool table_multilevel_;
+  // inverse of bufid[]: the index of each value of CreateBufferID(), or -1
+  static int bufid_index_[256];
 };
 
 //----------------------------------------------------------------------------------------
@@ -127,6 +135,24 @@ class BoundaryValues : public BoundaryBase, // public BoundaryPhysics,
 
   int AdvanceCounterPhysID(int num_phys);
 
+  // With <time>/subcycling, MultiStageBlockTaskDriver steps one refinement level at a
+  // time and sets these before the task lists of the block run:
+  // the neighbors that the exchanges of the block send to and receive from
+  LevelMask send_levels, recv_levels;
+  // the weight with which SendFluxCorrection() adds the fluxes of a stage to the flux
+  // registers of the faces shared with another level, 0 for none
+  Real flux_register_weight;
+  // the time within the step of the coarser level, as a fraction of it, to which
+  // ProlongateBoundaries() interpolates the data of coarser neighbors between the two
+  // copies kept by StoreCoarseBoundaries(), or negative to use the data as received
+  Real coarse_time_fraction;
+  // exchange with all neighbors again, without flux registers or interpolation
+  void ResetSubcycling();
+
+  // the coarse data received from coarser neighbors at the start or end of their step
+  enum class CoarseTime { start, end };
+  void StoreCoarseBoundaries(const CoarseTime when);
+
  private:
   MeshBlock *pmy_block_; // ptr to MeshBlock containing this BoundaryValues
   int nface_, nedge_;    // used only in fc/flux_correction_fc.cpp calculations
@@ -140,14 +166,42 @@ class BoundaryValues : public BoundaryBase, // public BoundaryPhysics,
   // communication (subset of Mesh::next_phys_id_)
   int bvars_next_phys_id_;
 
+  // tables of all cell-centered buffers of this MeshBlock, reused by the fused
+  // pack/unpack kernels (see fused_buffers_cc.cpp) and only grown when needed
+  BufferCache_t send_cache_, recv_cache_;
+  BufferCache_t::HostMirror send_cache_h_, recv_cache_h_;
+  // same-level neighbors on this rank skip the buffers, their ghost zones are copied
+  // straight from the neighbor's interior using this table
+  CopyCache_t copy_cache_;
+  CopyCache_t::HostMirror copy_cache_h_;
+
+  // with <mesh>/batched_prolongation, ProlongateBoundaries() gathers the coarse-fine
+  // regions of all neighbors into these tables and processes them in two kernels
+  bool batched_prolongation_;
+  RefinementCache_t restrict_cache_, prolong_cache_;
+  RefinementCache_t::HostMirror restrict_cache_h_, prolong_cache_h_;
+
+  // copies of the coarse arrays of pmr->pvars_cc_, see StoreCoarseBoundaries()
+  std::vector<ParArrayND<Real>> coarse_start_, coarse_end_;
+
   // ProlongateBoundaries() wraps the following S/AMR-operations (within nneighbor loop):
   // (the next function is also called within 3x nested loops over nk,nj,ni)
   void RestrictGhostCellsOnSameLevel(const NeighborBlock &nb, int nk, int nj, int ni);
+  void RestrictionIndices(const NeighborBlock &nb, int nk, int nj, int ni, int &ris,
+                          int &rie, int &rjs, int &rje, int &rks, int &rke);
+  // coarse index range of the ghost zones from the coarser neighbor nb, cn cells deep
+  void CoarseGhostIndices(const NeighborBlock &nb, const int cn, int &si, int &ei,
+                          int &sj, int &ej, int &sk, int &ek);
+  // the ghost zones from the coarser neighbor nb at coarse_time_fraction
+  void InterpolateCoarseInTime(const NeighborBlock &nb);
   void ApplyPhysicalBoundariesOnCoarseLevel(const NeighborBlock &nb, const Real time,
                                             const Real dt, int si, int ei, int sj, int ej,
                                             int sk, int ek);
   void ProlongateGhostCells(const NeighborBlock &nb, int si, int ei, int sj, int ej,
                             int sk, int ek);
+  // batched replacement of the two calls above for all neighbors at once
+  void ProlongateBoundariesBatched(const std::vector<std::array<int, 6>> &restrict_boxes,
+                                   const std::vector<std::array<int, 6>> &prolong_boxes);
 
   // temporary--- Added by @tomidakn on 2015-11-27 in f0f989f85f
   // TODO(KGF): consider removing this friendship designation
@@ -0,0 +1,521 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file bvals_aggregate.cpp
+//  \brief implementation of the rank-level aggregation of boundary messages
+
+#include "bvals/bvals_aggregate.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bvals/bvals.hpp"
+#include "globals.hpp"
+#include "mesh/mesh.hpp"
+
+namespace parthenon {
+
+namespace {
+// host view of a slot in a shared window
+using SharedSlot =
+    Kokkos::View<Real *, Kokkos::HostSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+// tag of the empty messages announcing that a shared slot has been filled
+constexpr int kSharedTag = 1;
+} // namespace
+
+AggregatedBoundaryComm::AggregatedBoundaryComm(bool shared_memory,
+                                               bool neighbor_collectives)
+    : nvars_(0), ncleared_(0), recv_started_(false), shared_memory_(shared_memory),
+      neighbor_collectives_(neighbor_collectives), coll_pending_(0),
+      coll_started_(false), coll_done_(false), parity_(0), shm_stride_(0),
+      node_rank_(Globals::nranks, -1) {
+#ifdef MPI_PARALLEL
+  // a separate communicator keeps these messages apart from the per-buffer tags
+  MPI_Comm_dup(MPI_COMM_WORLD, &comm_);
+  node_comm_ = MPI_COMM_NULL;
+  win_ = MPI_WIN_NULL;
+  graph_comm_ = MPI_COMM_NULL;
+  coll_req_ = MPI_REQUEST_NULL;
+  if (shared_memory_) {
+    MPI_Comm_split_type(comm_, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm_);
+    MPI_Group group, node_group;
+    MPI_Comm_group(comm_, &group);
+    MPI_Comm_group(node_comm_, &node_group);
+    std::vector<int> ranks(Globals::nranks);
+    for (int r = 0; r < Globals::nranks; r++) {
+      ranks[r] = r;
+    }
+    MPI_Group_translate_ranks(group, Globals::nranks, ranks.data(), node_group,
+                              node_rank_.data());
+    for (auto &r : node_rank_) {
+      if (r == MPI_UNDEFINED) r = -1;
+    }
+    MPI_Group_free(&group);
+    MPI_Group_free(&node_group);
+  }
+#endif
+}
+
+AggregatedBoundaryComm::~AggregatedBoundaryComm() {
+  FreeRequests_();
+  FreeSharedWindow_();
+  FreeNeighborCollective_();
+#ifdef MPI_PARALLEL
+  if (node_comm_ != MPI_COMM_NULL) MPI_Comm_free(&node_comm_);
+  MPI_Comm_free(&comm_);
+#endif
+}
+
+void AggregatedBoundaryComm::FreeRequests_() {
+#ifdef MPI_PARALLEL
+  for (auto &m : msgs_) {
+    if (m.req_send != MPI_REQUEST_NULL) MPI_Request_free(&m.req_send);
+    if (m.req_recv != MPI_REQUEST_NULL) MPI_Request_free(&m.req_recv);
+  }
+#endif
+}
+
+AggregatedBoundaryComm::RankMessage &AggregatedBoundaryComm::GetMessage_(int rank) {
+  auto it = rank_index_.find(rank);
+  if (it != rank_index_.end()) return msgs_[it->second];
+  rank_index_[rank] = msgs_.size();
+  RankMessage m;
+  m.rank = rank;
+  m.npending = 0;
+  m.arrived = false;
+  m.node_rank = shared_memory_ ? node_rank_[rank] : -1;
+  m.local_recv = nullptr;
+  m.remote_recv = nullptr;
+  m.remote_stride = 0;
+#ifdef MPI_PARALLEL
+  m.req_send = MPI_REQUEST_NULL;
+  m.req_recv = MPI_REQUEST_NULL;
+#endif
+  msgs_.push_back(m);
+  return msgs_.back();
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::Setup(MeshBlock *pblock)
+//  \brief collect the buffers of all blocks in the linked list starting at pblock, then
+//  compute the offsets and create one persistent send/recv request per remote rank.
+//  Collective over all ranks, as is the shared window.
+
+void AggregatedBoundaryComm::Setup(MeshBlock *pblock) {
+  FreeRequests_();
+  FreeSharedWindow_();
+  FreeNeighborCollective_();
+  msgs_.clear();
+  rank_index_.clear();
+  send_index_.clear();
+  nvars_ = 0;
+  ncleared_ = 0;
+  recv_started_ = false;
+
+  for (MeshBlock *pmb = pblock; pmb != nullptr; pmb = pmb->next) {
+    for (auto &bvar : pmb->pbval->bvars) {
+      bvar->SetupAggregatedMPI(*this);
+    }
+  }
+
+  auto by_key = [](const Entry &a, const Entry &b) { return a.key < b.key; };
+  for (int m = 0; m < static_cast<int>(msgs_.size()); m++) {
+    RankMessage &msg = msgs_[m];
+    std::sort(msg.send.begin(), msg.send.end(), by_key);
+    std::sort(msg.recv.begin(), msg.recv.end(), by_key);
+    int ssize = 0, rsize = 0;
+    for (int n = 0; n < static_cast<int>(msg.send.size()); n++) {
+      msg.send[n].offset = ssize;
+      ssize += msg.send[n].size;
+      send_index_[std::make_pair(msg.send[n].bvar, msg.send[n].bufid)] =
+          std::make_pair(m, n);
+    }
+    for (auto &e : msg.recv) {
+      e.offset = rsize;
+      rsize += e.size;
+    }
+    msg.npending = msg.send.size();
+    msg.arrived = false;
+#ifdef MPI_PARALLEL
+    if (msg.node_rank >= 0) {
+      // the data goes through the shared window, the messages only carry the signal
+      if (ssize > 0) {
+        MPI_Send_init(nullptr, 0, MPI_ATHENA_REAL, msg.rank, kSharedTag, comm_,
+                      &msg.req_send);
+      }
+      if (rsize > 0) {
+        MPI_Recv_init(nullptr, 0, MPI_ATHENA_REAL, msg.rank, kSharedTag, comm_,
+                      &msg.req_recv);
+      }
+      continue;
+    }
+    // the buffers of the neighbor collective are slices of the common ones
+    if (neighbor_collectives_) continue;
+    if (ssize > 0) {
+      msg.send_buf = BufArray1D<Real>("aggregated send buffer", ssize);
+      MPI_Send_init(msg.send_buf.data(), ssize, MPI_ATHENA_REAL, msg.rank, 0, comm_,
+                    &msg.req_send);
+    }
+    if (rsize > 0) {
+      msg.recv_buf = BufArray1D<Real>("aggregated recv buffer", rsize);
+      MPI_Recv_init(msg.recv_buf.data(), rsize, MPI_ATHENA_REAL, msg.rank, 0, comm_,
+                    &msg.req_recv);
+    }
+#endif
+  }
+  if (shared_memory_) SetupSharedWindow_();
+  if (neighbor_collectives_) SetupNeighborCollective_();
+}
+
+void AggregatedBoundaryComm::AccountMemory(MemoryUsage::Accounting &acc) const {
+  const std::string label = "(aggregated messages)";
+  acc.AddView(label, "comm", coll_send_buf_);
+  acc.AddView(label, "comm", coll_recv_buf_);
+  for (const RankMessage &m : msgs_) {
+    // the buffers of the neighbor collective are slices of the common ones
+    if (InCollective_(m)) continue;
+    acc.AddView(label, "comm", m.send_buf);
+    acc.AddView(label, "comm", m.recv_buf);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::SetupNeighborCollective_()
+//  \brief create the distributed graph communicator of the off-node messages and lay
+//  out all of them in one send and one receive buffer. Collective over all ranks; those
+//  without off-node partners join the graph with no neighbors.
+
+void AggregatedBoundaryComm::SetupNeighborCollective_() {
+#ifdef MPI_PARALLEL
+  // neighbor relations are mutual, so that the ranks are both sources and destinations,
+  // and in the same order, which gives the order of the counts and displacements
+  std::vector<int> ranks;
+  int ssize = 0, rsize = 0;
+  for (int d = 0; d < 2; d++) {
+    coll_counts_[d].clear();
+    coll_displs_[d].clear();
+  }
+  for (auto &m : msgs_) {
+    if (!InCollective_(m)) continue;
+    ranks.push_back(m.rank);
+    int scount = 0, rcount = 0;
+    for (auto &e : m.send) {
+      scount += e.size;
+    }
+    for (auto &e : m.recv) {
+      rcount += e.size;
+    }
+    coll_displs_[0].push_back(ssize);
+    coll_counts_[0].push_back(scount);
+    coll_displs_[1].push_back(rsize);
+    coll_counts_[1].push_back(rcount);
+    ssize += scount;
+    rsize += rcount;
+    coll_pending_ += m.send.size();
+  }
+  const int n = ranks.size();
+  MPI_Dist_graph_create_adjacent(comm_, n, ranks.data(), MPI_UNWEIGHTED, n, ranks.data(),
+                                 MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graph_comm_);
+  coll_send_buf_ = BufArray1D<Real>("aggregated send buffer", std::max(ssize, 1));
+  coll_recv_buf_ = BufArray1D<Real>("aggregated recv buffer", std::max(rsize, 1));
+  int i = 0;
+  for (auto &m : msgs_) {
+    if (!InCollective_(m)) continue;
+    m.send_buf = Kokkos::subview(
+        coll_send_buf_,
+        std::make_pair(coll_displs_[0][i], coll_displs_[0][i] + coll_counts_[0][i]));
+    m.recv_buf = Kokkos::subview(
+        coll_recv_buf_,
+        std::make_pair(coll_displs_[1][i], coll_displs_[1][i] + coll_counts_[1][i]));
+    i++;
+  }
+#endif
+}
+
+void AggregatedBoundaryComm::FreeNeighborCollective_() {
+#ifdef MPI_PARALLEL
+  if (graph_comm_ != MPI_COMM_NULL) MPI_Comm_free(&graph_comm_);
+#endif
+  coll_pending_ = 0;
+  coll_started_ = false;
+  coll_done_ = false;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::StartNeighborCollective_()
+//  \brief start the exchange of all off-node messages, once all of them are packed
+
+void AggregatedBoundaryComm::StartNeighborCollective_() {
+  exec_space_.fence();
+#ifdef MPI_PARALLEL
+  MPI_Ineighbor_alltoallv(coll_send_buf_.data(), coll_counts_[0].data(),
+                          coll_displs_[0].data(), MPI_ATHENA_REAL, coll_recv_buf_.data(),
+                          coll_counts_[1].data(), coll_displs_[1].data(),
+                          MPI_ATHENA_REAL, graph_comm_, &coll_req_);
+#endif
+  coll_started_ = true;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::SetupSharedWindow_()
+//  \brief allocate the shared window holding, twice, the receive slots of all on-node
+//  messages of this rank, and find the slot of each outgoing on-node message in the
+//  window of its receiver
+
+void AggregatedBoundaryComm::SetupSharedWindow_() {
+#ifdef MPI_PARALLEL
+  int nnode;
+  MPI_Comm_size(node_comm_, &nnode);
+  // (offset of the slot, stride of the copies, size of the slot) for each node rank
+  std::vector<int> layout(3 * nnode, -1), remote(3 * nnode, -1);
+  int total = 0;
+  for (auto &m : msgs_) {
+    if (m.node_rank < 0) continue;
+    int rsize = 0;
+    for (auto &e : m.recv) {
+      rsize += e.size;
+    }
+    layout[3 * m.node_rank] = total;
+    layout[3 * m.node_rank + 2] = rsize;
+    total += rsize;
+  }
+  for (auto &m : msgs_) {
+    if (m.node_rank >= 0) layout[3 * m.node_rank + 1] = total;
+  }
+  MPI_Alltoall(layout.data(), 3, MPI_INT, remote.data(), 3, MPI_INT, node_comm_);
+
+  Real *base;
+  MPI_Win_allocate_shared(static_cast<MPI_Aint>(2 * total) * sizeof(Real), sizeof(Real),
+                          MPI_INFO_NULL, node_comm_, &base, &win_);
+  // a passive epoch for the lifetime of the window, MPI_Win_sync orders the accesses
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+  shm_stride_ = total;
+
+  for (auto &m : msgs_) {
+    if (m.node_rank < 0) continue;
+    m.local_recv = base + layout[3 * m.node_rank];
+    int ssize = 0;
+    for (auto &e : m.send) {
+      ssize += e.size;
+    }
+    if (ssize == 0) continue;
+    if (remote[3 * m.node_rank + 2] != ssize) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in AggregatedBoundaryComm::SetupSharedWindow_" << std::endl
+          << "Rank " << m.rank << " expects " << remote[3 * m.node_rank + 2]
+          << " values from this rank, which sends " << ssize << std::endl;
+      ATHENA_ERROR(msg);
+    }
+    MPI_Aint size;
+    int disp_unit;
+    Real *remote_base;
+    MPI_Win_shared_query(win_, m.node_rank, &size, &disp_unit, &remote_base);
+    m.remote_recv = remote_base + remote[3 * m.node_rank];
+    m.remote_stride = remote[3 * m.node_rank + 1];
+  }
+#endif
+}
+
+void AggregatedBoundaryComm::FreeSharedWindow_() {
+#ifdef MPI_PARALLEL
+  if (win_ != MPI_WIN_NULL) {
+    MPI_Win_unlock_all(win_);
+    MPI_Win_free(&win_);
+  }
+#endif
+  shm_stride_ = 0;
+  parity_ = 0;
+}
+
+void AggregatedBoundaryComm::AddSend(int rank, const MessageKey &key,
+                                     const BoundaryVariable *bvar, int bufid,
+                                     BufArray1D<Real> buf, int size) {
+  GetMessage_(rank).send.push_back(Entry{key, bvar, bufid, buf, size, 0});
+}
+
+void AggregatedBoundaryComm::AddRecv(int rank, const MessageKey &key,
+                                     const BoundaryVariable *bvar, int bufid,
+                                     BufArray1D<Real> buf, int size) {
+  GetMessage_(rank).recv.push_back(Entry{key, bvar, bufid, buf, size, 0});
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::StartReceiving()
+//  \brief post the aggregated receives; only the first call of an exchange does so
+
+void AggregatedBoundaryComm::StartReceiving() {
+#pragma omp critical(AggregatedBoundaryComm)
+  {
+    if (!recv_started_) {
+#ifdef MPI_PARALLEL
+      for (auto &m : msgs_) {
+        if (m.req_recv != MPI_REQUEST_NULL) MPI_Start(&m.req_recv);
+      }
+#endif
+      recv_started_ = true;
+      // every rank of graph_comm_ must take part in each exchange, so a rank with
+      // nothing to send, or without off-node neighbors, starts its part right away.
+      // ClearBoundary() completes it.
+      if (neighbor_collectives_ && coll_pending_ == 0 && !coll_started_) {
+        StartNeighborCollective_();
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::BufferPacked(const BoundaryVariable *bvar, int bufid)
+//  \brief copy a packed buffer into its slot of the aggregated message and start the
+//  message once all of its buffers are in place
+
+void AggregatedBoundaryComm::BufferPacked(const BoundaryVariable *bvar, int bufid) {
+#pragma omp critical(AggregatedBoundaryComm)
+  {
+    auto idx = send_index_.at(std::make_pair(bvar, bufid));
+    RankMessage &m = msgs_[idx.first];
+    const Entry &e = m.send[idx.second];
+    if (m.node_rank >= 0) {
+      Real *slot = m.remote_recv + parity_ * m.remote_stride + e.offset;
+      Kokkos::deep_copy(exec_space_, SharedSlot(slot, e.size),
+                        Kokkos::subview(e.buf, std::make_pair(0, e.size)));
+    } else {
+      Kokkos::deep_copy(
+          exec_space_,
+          Kokkos::subview(m.send_buf, std::make_pair(e.offset, e.offset + e.size)),
+          Kokkos::subview(e.buf, std::make_pair(0, e.size)));
+    }
+    if (InCollective_(m)) {
+      --m.npending;
+      if (--coll_pending_ == 0) StartNeighborCollective_();
+    } else if (--m.npending == 0) {
+      exec_space_.fence();
+#ifdef MPI_PARALLEL
+      // make the stores to the shared slot visible before the signal
+      if (m.node_rank >= 0) MPI_Win_sync(win_);
+      MPI_Start(&m.req_send);
+#endif
+    }
+  }
+}
+
+void AggregatedBoundaryComm::Scatter_(RankMessage &m) {
+  if (m.node_rank >= 0) {
+#ifdef MPI_PARALLEL
+    MPI_Win_sync(win_);
+#endif
+    for (auto &e : m.recv) {
+      Real *slot = m.local_recv + parity_ * shm_stride_ + e.offset;
+      Kokkos::deep_copy(exec_space_, Kokkos::subview(e.buf, std::make_pair(0, e.size)),
+                        SharedSlot(slot, e.size));
+    }
+  } else {
+    for (auto &e : m.recv) {
+      Kokkos::deep_copy(
+          exec_space_, Kokkos::subview(e.buf, std::make_pair(0, e.size)),
+          Kokkos::subview(m.recv_buf, std::make_pair(e.offset, e.offset + e.size)));
+    }
+  }
+  // the blocks unpack on their own execution space instances, which do not order
+  // themselves after the copies on this one
+  exec_space_.fence();
+  m.arrived = true;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn bool AggregatedBoundaryComm::Test(int rank)
+//  \brief true once the message from rank has arrived and been scattered into the
+//  receive buffers of the individual variables
+
+bool AggregatedBoundaryComm::Test(int rank) {
+  bool arrived;
+#pragma omp critical(AggregatedBoundaryComm)
+  {
+    RankMessage &m = msgs_[rank_index_.at(rank)];
+    if (!m.arrived) {
+      int test = 1;
+#ifdef MPI_PARALLEL
+      if (InCollective_(m)) {
+        // the collective completes for all off-node messages at once
+        if (!coll_done_ && coll_started_) {
+          MPI_Test(&coll_req_, &test, MPI_STATUS_IGNORE);
+          coll_done_ = static_cast<bool>(test);
+        }
+        test = coll_done_;
+      } else {
+        MPI_Test(&m.req_recv, &test, MPI_STATUS_IGNORE);
+      }
+#endif
+      if (static_cast<bool>(test)) Scatter_(m);
+    }
+    arrived = m.arrived;
+  }
+  return arrived;
+}
+
+void AggregatedBoundaryComm::Wait(int rank) {
+#pragma omp critical(AggregatedBoundaryComm)
+  {
+    RankMessage &m = msgs_[rank_index_.at(rank)];
+    if (!m.arrived) {
+#ifdef MPI_PARALLEL
+      if (InCollective_(m)) {
+        if (!coll_started_) {
+          std::stringstream msg;
+          msg << "### FATAL ERROR in AggregatedBoundaryComm::Wait" << std::endl
+              << "Waiting for the neighbor collective before all buffers of this rank "
+              << "were sent" << std::endl;
+          ATHENA_ERROR(msg);
+        }
+        if (!coll_done_) MPI_Wait(&coll_req_, MPI_STATUS_IGNORE);
+        coll_done_ = true;
+      } else {
+        MPI_Wait(&m.req_recv, MPI_STATUS_IGNORE);
+      }
+#endif
+      Scatter_(m);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void AggregatedBoundaryComm::ClearBoundary()
+//  \brief called once per participating variable; the last call of an exchange waits
+//  for the sends and resets the state for the next exchange
+
+void AggregatedBoundaryComm::ClearBoundary() {
+#pragma omp critical(AggregatedBoundaryComm)
+  {
+    if (++ncleared_ == nvars_) {
+      for (auto &m : msgs_) {
+#ifdef MPI_PARALLEL
+        if (m.req_send != MPI_REQUEST_NULL) MPI_Wait(&m.req_send, MPI_STATUS_IGNORE);
+#endif
+        m.npending = m.send.size();
+        m.arrived = false;
+        if (InCollective_(m)) coll_pending_ += m.send.size();
+      }
+#ifdef MPI_PARALLEL
+      if (coll_started_ && !coll_done_) MPI_Wait(&coll_req_, MPI_STATUS_IGNORE);
+#endif
+      coll_started_ = false;
+      coll_done_ = false;
+      ncleared_ = 0;
+      recv_started_ = false;
+      parity_ ^= 1;
+    }
+  }
+}
+
+} // namespace parthenon
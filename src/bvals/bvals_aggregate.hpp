@@ -0,0 +1,155 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef BVALS_BVALS_AGGREGATE_HPP_
+#define BVALS_BVALS_AGGREGATE_HPP_
+//! \file bvals_aggregate.hpp
+//  \brief opt-in exchange of all cell-centered boundary buffers between a pair of ranks
+//         as one contiguous message
+
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/memory_usage.hpp"
+
+namespace parthenon {
+
+class BoundaryVariable;
+class MeshBlock;
+
+//----------------------------------------------------------------------------------------
+//! \class AggregatedBoundaryComm
+//  \brief gathers every boundary buffer going to a given remote rank into a single
+//  message (enabled with <mesh>/aggregate_messages). The offset tables are rebuilt by
+//  Setup(), which Mesh::Initialize() calls whenever the neighbor lists have changed.
+//
+//  Both sides order the buffers of a message by (sender gid, receiver gid, variable
+//  index, receiver buffer id), so the offsets agree without any extra communication.
+//  One exchange (StartReceiving ... ClearBoundary) is assumed to be in flight at a time.
+//  The calls made during an exchange are serialized, as blocks may run on many threads.
+//
+//  With <mesh>/shared_memory_exchange, messages to ranks on the same node bypass MPI:
+//  each rank exposes its receive slots in an MPI-3 shared window, senders copy their
+//  buffers straight into the slot of the receiver, and only an empty message signals
+//  that the data is in place. Slots alternate between consecutive exchanges, which is
+//  safe because neighbor relations are mutual: a rank cannot start exchange N+2 before
+//  its partner has sent, and therefore finished reading, in exchange N+1.
+//
+//  With <mesh>/neighbor_collectives, the messages to the other (off-node) ranks are
+//  exchanged by a single MPI_Ineighbor_alltoallv on a distributed graph communicator of
+//  those ranks, started once all of their buffers are packed, so that the MPI library
+//  sees the whole pattern of the exchange at once.
+
+class AggregatedBoundaryComm {
+ public:
+  // (sender gid, receiver gid, bvar_index, buffer id on the receiving block)
+  using MessageKey = std::array<int, 4>;
+
+  explicit AggregatedBoundaryComm(bool shared_memory = false,
+                                  bool neighbor_collectives = false);
+  ~AggregatedBoundaryComm();
+
+  // rebuild offset tables, buffers, and persistent requests for all blocks of this rank
+  void Setup(MeshBlock *pblock);
+
+  // called by BoundaryVariable::SetupAggregatedMPI() during Setup()
+  void AddVariable() { nvars_++; }
+  void AddSend(int rank, const MessageKey &key, const BoundaryVariable *bvar, int bufid,
+               BufArray1D<Real> buf, int size);
+  void AddRecv(int rank, const MessageKey &key, const BoundaryVariable *bvar, int bufid,
+               BufArray1D<Real> buf, int size);
+
+  // called by the participating BoundaryVariable objects
+  void StartReceiving();
+  void BufferPacked(const BoundaryVariable *bvar, int bufid);
+  bool Test(int rank);
+  void Wait(int rank);
+  void ClearBoundary();
+
+  // adds the message buffers to acc under ("(aggregated messages)", "comm"); the shared
+  // window of the on-node messages is allocated by MPI and not counted
+  void AccountMemory(MemoryUsage::Accounting &acc) const;
+
+ private:
+  struct Entry {
+    MessageKey key;
+    const BoundaryVariable *bvar;
+    int bufid;
+    BufArray1D<Real> buf;
+    int size, offset;
+  };
+
+  struct RankMessage {
+    int rank;
+    std::vector<Entry> send, recv;
+    BufArray1D<Real> send_buf, recv_buf;
+    int npending; // send entries not yet packed in the current exchange
+    bool arrived;
+    // on-node messages only: rank in node_comm_, the slot of this message in our
+    // window, and the slot of our data in the window of the receiver, whose two copies
+    // are remote_stride apart
+    int node_rank;
+    Real *local_recv, *remote_recv;
+    int remote_stride;
+#ifdef MPI_PARALLEL
+    MPI_Request req_send, req_recv;
+#endif
+  };
+
+  RankMessage &GetMessage_(int rank);
+  void Scatter_(RankMessage &msg);
+  void FreeRequests_();
+  void SetupSharedWindow_();
+  void FreeSharedWindow_();
+  void SetupNeighborCollective_();
+  void FreeNeighborCollective_();
+  void StartNeighborCollective_();
+  bool InCollective_(const RankMessage &m) const {
+    return neighbor_collectives_ && m.node_rank < 0;
+  }
+
+  int nvars_, ncleared_;
+  bool recv_started_;
+  const bool shared_memory_;
+  const bool neighbor_collectives_;
+  // the off-node messages of the neighbor collective: send entries not yet packed, the
+  // one buffer in each direction holding all of them, and counts and displacements in
+  // the order of the neighbors of graph_comm_
+  int coll_pending_;
+  bool coll_started_, coll_done_;
+  BufArray1D<Real> coll_send_buf_, coll_recv_buf_;
+  std::vector<int> coll_counts_[2], coll_displs_[2];
+  int parity_;     // selects the copy of the shared slots used by the current exchange
+  int shm_stride_; // distance of the two copies in the window of this rank
+  std::vector<int> node_rank_; // rank in node_comm_ of every rank, -1 if off node
+  std::vector<RankMessage> msgs_;
+  std::map<int, int> rank_index_;
+  std::map<std::pair<const BoundaryVariable *, int>, std::pair<int, int>> send_index_;
+  DevSpace exec_space_;
+#ifdef MPI_PARALLEL
+  MPI_Comm comm_;
+  MPI_Comm node_comm_; // the ranks sharing memory with this one
+  MPI_Win win_;
+  MPI_Comm graph_comm_;
+  MPI_Request coll_req_;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // BVALS_BVALS_AGGREGATE_HPP_
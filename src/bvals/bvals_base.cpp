@@ -19,6 +19,7 @@
 
 #include "bvals/bvals.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring> // memcpy()
@@ -38,9 +39,12 @@ namespace parthenon {
 // (zero-initialization is performed for all static storage duration variables)
 // scalar types: integral constant 0 is explicitly converted to type
 bool BoundaryBase::called_;
+int BoundaryBase::table_dim_;
+bool BoundaryBase::table_multilevel_;
 int BoundaryBase::maxneighbor_;
 // array types: each element is zero-initialized
 int BoundaryBase::bufid[56];
+int BoundaryBase::bufid_index_[256];
 // struct type: zero-initializes each non-static data member (this case: all scalar types)
 NeighborIndexes BoundaryBase::ni[56];
 
@@ -102,8 +106,11 @@ BoundaryBase::BoundaryBase(Mesh *pm, LogicalLocation iloc, RegionSize isize,
   loc = iloc;
   block_size_ = isize;
   pmy_mesh_ = pm;
-  if (!called_) {
+  if (!called_ || table_dim_ != pmy_mesh_->ndim ||
+      table_multilevel_ != pmy_mesh_->multilevel) {
     maxneighbor_ = BufferID(pmy_mesh_->ndim, pmy_mesh_->multilevel);
+    table_dim_ = pmy_mesh_->ndim;
+    table_multilevel_ = pmy_mesh_->multilevel;
     called_ = true;
   }
   // copy/set in class the input 6x BoundaryFlag for this local MeshBlock boundaries
@@ -254,6 +261,9 @@ int BoundaryBase::BufferID(int dim, bool multilevel) {
 
   for (int n = 0; n < b; n++)
     bufid[n] = CreateBufferID(ni[n].ox1, ni[n].ox2, ni[n].ox3, ni[n].fi1, ni[n].fi2);
+  std::fill(bufid_index_, bufid_index_ + 256, -1);
+  for (int n = 0; n < b; n++)
+    bufid_index_[bufid[n]] = n;
 
   return b;
 }
@@ -263,32 +273,20 @@ int BoundaryBase::BufferID(int dim, bool multilevel) {
 //  \brief find the boundary buffer ID from the direction
 
 int BoundaryBase::FindBufferID(int ox1, int ox2, int ox3, int fi1, int fi2) {
-  int bid = CreateBufferID(ox1, ox2, ox3, fi1, fi2);
-
-  for (int i = 0; i < maxneighbor_; i++) {
-    if (bid == bufid[i]) return i;
-  }
-  return -1;
+  return bufid_index_[CreateBufferID(ox1, ox2, ox3, fi1, fi2)];
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int BoundaryBase::CreateBvalsMPITag(int lid, int bufid, int phys)
+//! \fn int BoundaryBase::CreateBvalsMPITag(int lid, int bufid)
 //  \brief calculate an MPI tag for Bval communications
-//  MPI tag = local id of destination (remaining bits) + bufid(6 bits) + physics(5 bits)
+//  MPI tag = local id of destination (remaining bits) + bufid(6 bits)
 
-// WARN: The below procedure of generating unsigned integer bitfields from signed integer
-// types and converting output to signed integer tags (required by MPI) is tricky and may
-// lead to unsafe conversions (and overflows from built-in types and MPI_TAG_UB).  Note,
-// the MPI standard requires signed int tag, with MPI_TAG_UB>= 2^15-1 = 32,767 (inclusive)
+// Each "phys" id of the boundary variables has its own communicator
+// (Mesh::GetMPIComm), so the tag only needs to identify the buffer. The MPI standard
+// only guarantees MPI_TAG_UB >= 2^15-1 = 32,767, Mesh::CheckMPITagRange() stops runs with
+// more blocks per rank than the tags can address.
 
-// TODO(felker) Consider adding safety check: if (tag > MPI_TAG_UB) ATHENA_ERROR();
-// TODO(felker) Consider adding safety check: signed int inputs & outputs are positive
-// TODO(felker) Store # of bits for each bitfield component in preprocessor macros
-//              TAG_BITS_PHYS=5, MAX_NUM_PHYS=31
-
-int BoundaryBase::CreateBvalsMPITag(int lid, int bufid, int phys) {
-  return (lid << 11) | (bufid << 5) | phys;
-}
+int BoundaryBase::CreateBvalsMPITag(int lid, int bufid) { return (lid << 6) | bufid; }
 
 //----------------------------------------------------------------------------------------
 // \!fn void BoundaryBase::SearchAndSetNeighbors(MeshBlockTree &tree,
@@ -616,4 +614,25 @@ void BoundaryBase::SearchAndSetNeighbors(MeshBlockTree &tree, int *ranklist,
   return;
 }
 
+//----------------------------------------------------------------------------------------
+// \!fn bool BoundaryBase::RemapNeighbors(const int *newgid, int *ranklist, int *nslist)
+// \brief Update the neighbors after a regrid that changed neither this block nor any of
+// its neighbors, so that only their gids, and with them their ranks and local ids, may
+// differ. newgid maps the previous gid of a block to the new one, or to -1 if the block
+// was refined or derefined. Returns false, leaving the neighbors as they are, if one of
+// them changed; SearchAndSetNeighbors() has to be called instead.
+
+bool BoundaryBase::RemapNeighbors(const int *newgid, int *ranklist, int *nslist) {
+  for (int n = 0; n < nneighbor; n++) {
+    if (newgid[neighbor[n].snb.gid] < 0) return false;
+  }
+  for (int n = 0; n < nneighbor; n++) {
+    SimpleNeighborBlock &snb = neighbor[n].snb;
+    snb.gid = newgid[snb.gid];
+    snb.rank = ranklist[snb.gid];
+    snb.lid = snb.gid - nslist[snb.rank];
+  }
+  return true;
+}
+
 } // namespace parthenon
@@ -22,17 +22,21 @@
 // TODO(felker): deduplicate forward declarations
 // TODO(felker): consider moving enums and structs in a new file? bvals_structs.hpp?
 
+#include <atomic>
 #include <string>
 #include <vector>
 
 #include "parthenon_mpi.hpp"
 
 #include "athena.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
+#include "utils/memory_usage.hpp"
 
 namespace parthenon {
 
 // forward declarations
+class AggregatedBoundaryComm;
 class Mesh;
 class MeshBlock;
 class MeshBlockTree;
@@ -94,7 +98,7 @@ enum BoundaryFace {
 // int to index raw arrays (not ParArrayNDs)--> enumerator vals are explicitly specified
 
 // identifiers for boundary conditions
-enum class BoundaryFlag { block = -1, undef, reflect, outflow, periodic };
+enum class BoundaryFlag { block = -1, undef, reflect, outflow, periodic, user };
 
 // identifiers for types of neighbor blocks (connectivity with current MeshBlock)
 enum class NeighborConnect {
@@ -157,27 +161,100 @@ struct NeighborBlock { // aggregate and POD type. Inheritance breaks standard-la
                    int ifi2 = 0);
 };
 
+//----------------------------------------------------------------------------------------
+//! \struct LevelMask
+//  \brief which neighbors, by their level relative to the block, take part in an
+//  exchange; all of them unless the levels of the mesh are subcycled
+
+struct LevelMask {
+  bool coarser = true, same = true, finer = true;
+
+  bool Includes(const NeighborBlock &nb, const int mylevel) const {
+    return (nb.snb.level < mylevel) ? coarser : (nb.snb.level == mylevel) ? same : finer;
+  }
+};
+
 //----------------------------------------------------------------------------------------
 //! \struct BoundaryData
 //  \brief structure storing boundary information
 
+#ifdef MPI_PARALLEL
+//----------------------------------------------------------------------------------------
+//! \struct PersistentRequestArgs
+//  \brief the arguments a persistent request of a buffer was created with, so that the
+//  request of a connection that a regrid left unchanged is kept instead of recreated
+
+struct PersistentRequestArgs {
+  const void *buf = nullptr;
+  int count = -1, rank = -1, tag = -1;
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  bool operator==(const PersistentRequestArgs &other) const {
+    return buf == other.buf && count == other.count && rank == other.rank &&
+           tag == other.tag && comm == other.comm;
+  }
+};
+#endif
+
 // TODO(felker): consider renaming/be more specific--- what kind of data/info?
 // one for each type of "BoundaryQuantity" corresponding to BoundaryVariable
 
 template <int n = 56>
-struct BoundaryData { // aggregate and POD (even when MPI_PARALLEL is defined)
+struct BoundaryData { // aggregate (buffers are device views, so no longer POD)
   static constexpr int kMaxNeighbor = n;
   // KGF: "nbmax" only used in bvals_var.cpp, Init/DestroyBoundaryData()
-  int nbmax; // actual maximum number of neighboring MeshBlocks
+  int nbmax = 0; // actual maximum number of neighboring MeshBlocks
   // currently, sflag[] is only used by Multgrid (send buffers are reused each stage in
   // red-black comm. pattern; need to check if they are available)
-  BoundaryStatus flag[kMaxNeighbor], sflag[kMaxNeighbor];
-  Real *send[kMaxNeighbor], *recv[kMaxNeighbor];
+  // flag[] is set by the threads of other blocks and by the MPI progress thread
+  std::atomic<BoundaryStatus> flag[kMaxNeighbor];
+  BoundaryStatus sflag[kMaxNeighbor];
+  BufArray1D<Real> send[kMaxNeighbor], recv[kMaxNeighbor];
 #ifdef MPI_PARALLEL
   MPI_Request req_send[kMaxNeighbor], req_recv[kMaxNeighbor];
+  PersistentRequestArgs send_args[kMaxNeighbor], recv_args[kMaxNeighbor];
 #endif
 };
 
+//----------------------------------------------------------------------------------------
+//! \struct BndInfo
+//  \brief index range and views of one (variable, neighbor) communication buffer. A
+//  table of these lets all buffers of a MeshBlock be packed/unpacked by a single kernel
+
+struct BndInfo {
+  int si = 0, ei = -1, sj = 0, ej = -1, sk = 0, ek = -1;
+  int nl = 0, nu = -1;
+  bool single = false;  // buffer holds the values as float
+  BufArray1D<Real> buf; // communication buffer
+  ParArray4D<Real> var; // source (sending) or destination (receiving) array
+};
+
+using BufferCache_t = Kokkos::View<BndInfo *, LayoutWrapper, DevSpace>;
+
+//----------------------------------------------------------------------------------------
+//! \struct BndCopyInfo
+//  \brief ghost zones of one (variable, neighbor) pair that are filled straight from the
+//  interior of a same-level neighbor on the same rank, without any buffer in between
+
+struct BndCopyInfo {
+  int si = 0, ei = -1, sj = 0, ej = -1, sk = 0, ek = -1; // destination (ghost) range
+  int nl = 0, nu = -1;
+  int di = 0, dj = 0, dk = 0; // source index = destination index + offset
+  ParArray4D<Real> src;       // array of the sending block
+  ParArray4D<Real> dst;       // array of the receiving block
+};
+
+using CopyCache_t = Kokkos::View<BndCopyInfo *, LayoutWrapper, DevSpace>;
+
+// kernels over the first n entries of these tables with one team per entry, see
+// fused_buffers_cc.cpp: pack (pack = true) or unpack the buffers of BndInfo entries, and
+// copy the BndCopyInfo entries from src to dst
+template <bool pack>
+void PackUnpackBuffers(const std::string &name, DevSpace exec_space,
+                       const BufferCache_t &cache, const int nbuf);
+void CopyRegions(const std::string &name, DevSpace exec_space, const CopyCache_t &cache,
+                 const int ncopy);
+
 //----------------------------------------------------------------------------------------
 // Interfaces = abstract classes containing ONLY pure virtual functions
 //              Merely lists functions and their argument lists that must be implemented
@@ -227,14 +304,17 @@ class BoundaryBuffer {
 
  protected:
   // universal buffer management methods for Cartesian grids (unrefined and SMR/AMR):
-  virtual int LoadBoundaryBufferSameLevel(Real *buf, const NeighborBlock &nb) = 0;
-  virtual void SetBoundarySameLevel(Real *buf, const NeighborBlock &nb) = 0;
+  virtual int LoadBoundaryBufferSameLevel(BufArray1D<Real> &buf,
+                                          const NeighborBlock &nb) = 0;
+  virtual void SetBoundarySameLevel(BufArray1D<Real> &buf, const NeighborBlock &nb) = 0;
 
   // SMR/AMR-exclusive buffer management methods:
-  virtual int LoadBoundaryBufferToCoarser(Real *buf, const NeighborBlock &nb) = 0;
-  virtual int LoadBoundaryBufferToFiner(Real *buf, const NeighborBlock &nb) = 0;
-  virtual void SetBoundaryFromCoarser(Real *buf, const NeighborBlock &nb) = 0;
-  virtual void SetBoundaryFromFiner(Real *buf, const NeighborBlock &nb) = 0;
+  virtual int LoadBoundaryBufferToCoarser(BufArray1D<Real> &buf,
+                                          const NeighborBlock &nb) = 0;
+  virtual int LoadBoundaryBufferToFiner(BufArray1D<Real> &buf,
+                                        const NeighborBlock &nb) = 0;
+  virtual void SetBoundaryFromCoarser(BufArray1D<Real> &buf, const NeighborBlock &nb) = 0;
+  virtual void SetBoundaryFromFiner(BufArray1D<Real> &buf, const NeighborBlock &nb) = 0;
 };
 
 //----------------------------------------------------------------------------------------
@@ -262,6 +342,18 @@ class BoundaryVariable : public BoundaryCommunication, public BoundaryBuffer {
   void ReceiveAndSetBoundariesWithWait() override;
   void SetBoundaries() override;
 
+  // register the buffers exchanged with other ranks for rank-level aggregation;
+  // variables that do not take part keep the default no-op
+  virtual void SetupAggregatedMPI(AggregatedBoundaryComm &agg) {}
+
+  // true if same-level neighbors on this rank read the ghost data straight from the
+  // sender's interior instead of receiving a copy of the send buffer
+  virtual bool SameProcessDirectCopy() const { return false; }
+
+  // adds the send and receive buffers of the variable and of its flux correction to
+  // acc under (label, "comm")
+  void AccountMemory(MemoryUsage::Accounting &acc, const std::string &label) const;
+
  protected:
   // deferred initialization of BoundaryData objects in derived class constructors
   BoundaryData<> bd_var_, bd_var_flcor_;
@@ -269,12 +361,26 @@ class BoundaryVariable : public BoundaryCommunication, public BoundaryBuffer {
 
   MeshBlock *pmy_block_; // ptr to MeshBlock containing this BoundaryVariable
   Mesh *pmy_mesh_;
+  // true if the variable buffers exchanged with other ranks go through
+  // Mesh::paggcomm instead of their own persistent requests
+  bool aggregated_comm_;
 
   void CopyVariableBufferSameProcess(NeighborBlock &nb, int ssize);
-  void CopyFluxCorrectionBufferSameProcess(NeighborBlock &nb, int ssize);
+  // only flag the data as available, the receiving block reads it from our interior
+  void SignalVariableSameProcess(NeighborBlock &nb);
+  // the same for the flux correction, the coarse block restricts our fluxes itself
+  void SignalFluxCorrectionSameProcess(NeighborBlock &nb);
 
   void InitBoundaryData(BoundaryData<> &bd, BoundaryQuantity type);
   void DestroyBoundaryData(BoundaryData<> &bd);
+#ifdef MPI_PARALLEL
+  // (re)create the persistent request of buffer bufid of bd, unless it was created with
+  // the same arguments, e.g. before a regrid that left the connection unchanged
+  void SetupPersistentSend(BoundaryData<> &bd, int bufid, int count, int rank, int tag,
+                           MPI_Comm comm);
+  void SetupPersistentRecv(BoundaryData<> &bd, int bufid, int count, int rank, int tag,
+                           MPI_Comm comm);
+#endif
 
   // private:
 };
@@ -20,8 +20,11 @@
 #include "bvals/bvals_interfaces.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iterator>
+#include <tuple>
+#include <vector>
 
 #include "fc/bvals_fc.hpp"
 #include "mesh/mesh.hpp"
@@ -77,6 +80,9 @@ namespace parthenon {
 void BoundaryValues::ProlongateBoundaries(const Real time, const Real dt) {
   MeshBlock *pmb = pmy_block_;
   int &mylevel = pmb->loc.level;
+  // the batched mode only covers cell-centered variables
+  const bool batched = batched_prolongation_ && pmb->pmr->pvars_fc_.empty();
+  std::vector<std::array<int, 6>> restrict_boxes, prolong_boxes;
 
   // This hardcoded technique is also used to manually specify the coupling between
   // physical variables in:
@@ -86,6 +92,14 @@ void BoundaryValues::ProlongateBoundaries(const Real time, const Real dt) {
   // downcast BoundaryVariable pointers to known derived class pointer types:
   // RTTI via dynamic_case
 
+  // with subcycling, the data of all coarser neighbors are brought to the time of this
+  // block first, as the prolongation of one reads the ghost zones of the others
+  if (coarse_time_fraction >= 0.0) {
+    for (int n = 0; n < nneighbor; n++) {
+      if (neighbor[n].snb.level < mylevel) InterpolateCoarseInTime(neighbor[n]);
+    }
+  }
+
   // For each finer neighbor, to prolongate a boundary we need to fill one more cell
   // surrounding the boundary zone to calculate the slopes ("ghost-ghost zone"). 3x steps:
   for (int n = 0; n < nneighbor; n++) {
@@ -121,56 +135,24 @@ void BoundaryValues::ProlongateBoundaries(const Real time, const Real dt) {
 
           // this neighbor block is on the same level
           // and needs to be restricted for prolongation
-          RestrictGhostCellsOnSameLevel(nb, nk, nj, ni);
+          if (batched) {
+            std::array<int, 6> box;
+            RestrictionIndices(nb, nk, nj, ni, box[0], box[1], box[2], box[3], box[4],
+                               box[5]);
+            // the ghost-ghost zones of neighboring coarser blocks may coincide
+            if (std::find(restrict_boxes.begin(), restrict_boxes.end(), box) ==
+                restrict_boxes.end())
+              restrict_boxes.push_back(box);
+          } else {
+            RestrictGhostCellsOnSameLevel(nb, nk, nj, ni);
+          }
         }
       }
     }
 
     // calculate the loop limits for the ghost zones
-    int cn = pmb->cnghost - 1;
     int si, ei, sj, ej, sk, ek;
-    if (nb.ni.ox1 == 0) {
-      std::int64_t &lx1 = pmb->loc.lx1;
-      si = pmb->cis, ei = pmb->cie;
-      if ((lx1 & 1LL) == 0LL)
-        ei += cn;
-      else
-        si -= cn;
-    } else if (nb.ni.ox1 > 0) {
-      si = pmb->cie + 1, ei = pmb->cie + cn;
-    } else {
-      si = pmb->cis - cn, ei = pmb->cis - 1;
-    }
-
-    if (nb.ni.ox2 == 0) {
-      sj = pmb->cjs, ej = pmb->cje;
-      if (pmb->block_size.nx2 > 1) {
-        std::int64_t &lx2 = pmb->loc.lx2;
-        if ((lx2 & 1LL) == 0LL)
-          ej += cn;
-        else
-          sj -= cn;
-      }
-    } else if (nb.ni.ox2 > 0) {
-      sj = pmb->cje + 1, ej = pmb->cje + cn;
-    } else {
-      sj = pmb->cjs - cn, ej = pmb->cjs - 1;
-    }
-
-    if (nb.ni.ox3 == 0) {
-      sk = pmb->cks, ek = pmb->cke;
-      if (pmb->block_size.nx3 > 1) {
-        std::int64_t &lx3 = pmb->loc.lx3;
-        if ((lx3 & 1LL) == 0LL)
-          ek += cn;
-        else
-          sk -= cn;
-      }
-    } else if (nb.ni.ox3 > 0) {
-      sk = pmb->cke + 1, ek = pmb->cke + cn;
-    } else {
-      sk = pmb->cks - cn, ek = pmb->cks - 1;
-    }
+    CoarseGhostIndices(nb, pmb->cnghost - 1, si, ei, sj, ej, sk, ek);
 
     // (temp workaround) to automatically call all BoundaryFunction_[] on coarse_prim/b
     // instead of previous targets var_cc=cons, var_fc=b
@@ -182,17 +164,156 @@ void BoundaryValues::ProlongateBoundaries(const Real time, const Real dt) {
     // arrays (not coarse) from coarse primitive variables arrays
 
     // Step 3. Finally, the ghost-ghost zones are ready for prolongation:
-    ProlongateGhostCells(nb, si, ei, sj, ej, sk, ek);
+    if (batched)
+      prolong_boxes.push_back({{si, ei, sj, ej, sk, ek}});
+    else
+      ProlongateGhostCells(nb, si, ei, sj, ej, sk, ek);
   } // end loop over nneighbor
+  if (batched) ProlongateBoundariesBatched(restrict_boxes, prolong_boxes);
   return;
 }
 
-void BoundaryValues::RestrictGhostCellsOnSameLevel(const NeighborBlock &nb, int nk,
-                                                   int nj, int ni) {
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryValues::CoarseGhostIndices(const NeighborBlock &nb, const int cn,
+//           int &si, int &ei, int &sj, int &ej, int &sk, int &ek)
+//  \brief coarse index range of the ghost zones, cn cells deep, that the coarser
+//  neighbor nb covers
+
+void BoundaryValues::CoarseGhostIndices(const NeighborBlock &nb, const int cn, int &si,
+                                        int &ei, int &sj, int &ej, int &sk, int &ek) {
+  MeshBlock *pmb = pmy_block_;
+  if (nb.ni.ox1 == 0) {
+    std::int64_t &lx1 = pmb->loc.lx1;
+    si = pmb->cis, ei = pmb->cie;
+    if ((lx1 & 1LL) == 0LL)
+      ei += cn;
+    else
+      si -= cn;
+  } else if (nb.ni.ox1 > 0) {
+    si = pmb->cie + 1, ei = pmb->cie + cn;
+  } else {
+    si = pmb->cis - cn, ei = pmb->cis - 1;
+  }
+
+  if (nb.ni.ox2 == 0) {
+    sj = pmb->cjs, ej = pmb->cje;
+    if (pmb->block_size.nx2 > 1) {
+      std::int64_t &lx2 = pmb->loc.lx2;
+      if ((lx2 & 1LL) == 0LL)
+        ej += cn;
+      else
+        sj -= cn;
+    }
+  } else if (nb.ni.ox2 > 0) {
+    sj = pmb->cje + 1, ej = pmb->cje + cn;
+  } else {
+    sj = pmb->cjs - cn, ej = pmb->cjs - 1;
+  }
+
+  if (nb.ni.ox3 == 0) {
+    sk = pmb->cks, ek = pmb->cke;
+    if (pmb->block_size.nx3 > 1) {
+      std::int64_t &lx3 = pmb->loc.lx3;
+      if ((lx3 & 1LL) == 0LL)
+        ek += cn;
+      else
+        sk -= cn;
+    }
+  } else if (nb.ni.ox3 > 0) {
+    sk = pmb->cke + 1, ek = pmb->cke + cn;
+  } else {
+    sk = pmb->cks - cn, ek = pmb->cks - 1;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryValues::InterpolateCoarseInTime(const NeighborBlock &nb)
+//  \brief set the ghost zones of the coarse arrays from the coarser neighbor nb, with
+//  the cells the prolongation stencil reaches beyond them, to the linear interpolation
+//  at coarse_time_fraction of the copies kept by StoreCoarseBoundaries()
+
+void BoundaryValues::InterpolateCoarseInTime(const NeighborBlock &nb) {
+  MeshBlock *pmb = pmy_block_;
+  MeshRefinement *pmr = pmb->pmr.get();
+  int si, ei, sj, ej, sk, ek;
+  CoarseGhostIndices(nb, pmb->cnghost, si, ei, sj, ej, sk, ek);
+  const Real theta = coarse_time_fraction;
+  for (int v = 0; v < static_cast<int>(pmr->pvars_cc_.size()); v++) {
+    ParArray4D<Real> coarse = std::get<1>(pmr->pvars_cc_[v]).Get<4>();
+    ParArray4D<Real> start = coarse_start_[v].Get<4>();
+    ParArray4D<Real> end = coarse_end_[v].Get<4>();
+    pmb->par_for(
+        "InterpolateCoarseInTime", 0, coarse.extent_int(0) - 1, sk, ek, sj, ej, si, ei,
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          coarse(n, k, j, i) =
+              (1.0 - theta) * start(n, k, j, i) + theta * end(n, k, j, i);
+        });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryValues::ProlongateBoundariesBatched(
+//           const std::vector<std::array<int, 6>> &restrict_boxes,
+//           const std::vector<std::array<int, 6>> &prolong_boxes)
+//  \brief restrict all ghost-ghost zones and then prolongate all coarse-fine ghost zones
+//  of every cell-centered variable, with one kernel launch each.  Doing every restriction
+//  first is safe: they only read same-level ghost zones and the interior, which the
+//  prolongations never write, and they fill in coarse cells that do not depend on the
+//  order.  Boxes (si, ei, sj, ej, sk, ek) are in coarse indices.
+
+void BoundaryValues::ProlongateBoundariesBatched(
+    const std::vector<std::array<int, 6>> &restrict_boxes,
+    const std::vector<std::array<int, 6>> &prolong_boxes) {
   MeshBlock *pmb = pmy_block_;
   MeshRefinement *pmr = pmb->pmr.get();
+  const int nvar = pmr->pvars_cc_.size();
+  const int nrestrict = restrict_boxes.size() * nvar;
+  const int nprolong = prolong_boxes.size() * nvar;
+  if (restrict_cache_.extent_int(0) < nrestrict) {
+    restrict_cache_ = RefinementCache_t("restrict_cache", nrestrict);
+    restrict_cache_h_ = Kokkos::create_mirror_view(restrict_cache_);
+  }
+  if (prolong_cache_.extent_int(0) < nprolong) {
+    prolong_cache_ = RefinementCache_t("prolong_cache", nprolong);
+    prolong_cache_h_ = Kokkos::create_mirror_view(prolong_cache_);
+  }
 
-  int ris, rie, rjs, rje, rks, rke;
+  auto fill = [&pmr](const std::vector<std::array<int, 6>> &boxes,
+                     RefinementCache_t::HostMirror &cache_h) {
+    int nr = 0;
+    for (auto &box : boxes) {
+      for (auto cc_pair : pmr->pvars_cc_) {
+        RefinementRegion &r = cache_h(nr++);
+        r.si = box[0], r.ei = box[1], r.sj = box[2], r.ej = box[3];
+        r.sk = box[4], r.ek = box[5];
+        r.fine = std::get<0>(cc_pair).Get<4>();
+        r.coarse = std::get<1>(cc_pair).Get<4>();
+        r.nl = 0, r.nu = std::get<0>(cc_pair).GetDim(4) - 1;
+      }
+    }
+  };
+  fill(restrict_boxes, restrict_cache_h_);
+  fill(prolong_boxes, prolong_cache_h_);
+  if (nrestrict > 0) {
+    Kokkos::deep_copy(pmb->exec_space, restrict_cache_, restrict_cache_h_);
+    pmr->RestrictCellCenteredRegions(restrict_cache_, nrestrict);
+  }
+  if (nprolong > 0) {
+    Kokkos::deep_copy(pmb->exec_space, prolong_cache_, prolong_cache_h_);
+    pmr->ProlongateCellCenteredRegions(prolong_cache_, nprolong);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryValues::RestrictionIndices(const NeighborBlock &nb, int nk, int nj,
+//           int ni, int &ris, int &rie, int &rjs, int &rje, int &rks, int &rke)
+//  \brief coarse index range of the part of the ghost-ghost zone of the coarser neighbor
+//  nb that lies in direction (ni, nj, nk), which has to be restricted from this block
+
+void BoundaryValues::RestrictionIndices(const NeighborBlock &nb, int nk, int nj, int ni,
+                                        int &ris, int &rie, int &rjs, int &rje, int &rks,
+                                        int &rke) {
+  MeshBlock *pmb = pmy_block_;
   if (ni == 0) {
     ris = pmb->cis;
     rie = pmb->cie;
@@ -230,6 +351,15 @@ void BoundaryValues::RestrictGhostCellsOnSameLevel(const NeighborBlock &nb, int
   } else { //(nk == -1)
     rks = pmb->cks - 1, rke = pmb->cks - 1;
   }
+}
+
+void BoundaryValues::RestrictGhostCellsOnSameLevel(const NeighborBlock &nb, int nk,
+                                                   int nj, int ni) {
+  MeshBlock *pmb = pmy_block_;
+  MeshRefinement *pmr = pmb->pmr.get();
+
+  int ris, rie, rjs, rje, rks, rke;
+  RestrictionIndices(nb, nk, nj, ni, ris, rie, rjs, rje, rks, rke);
 
   for (auto cc_pair : pmr->pvars_cc_) {
     ParArrayND<Real> var_cc = std::get<0>(cc_pair);
@@ -0,0 +1,352 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file bvals_swarm.cpp
+//  \brief migration of the particles of swarms between MeshBlocks and MPI ranks
+
+#include "bvals/bvals_swarm.hpp"
+
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "bvals/bvals.hpp"
+#include "globals.hpp"
+#include "interface/swarm.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/profiling.hpp"
+
+namespace parthenon {
+
+namespace SwarmBoundaries {
+
+namespace {
+
+// the sizes of the records of a swarm and the positions of x, y and z in its real record
+struct Layout {
+  int nreal, nint;
+  int ix[3];
+};
+
+// from the metadata of the package registering the swarm, so that it is known on ranks
+// without blocks as well
+Layout GetLayout(Mesh *pm, const std::string &swarm_name) {
+  Layout l;
+  bool found = false;
+  for (auto &pkg : pm->packages) {
+    if (pkg.second->AllSwarms().count(swarm_name) == 0) continue;
+    // the values in the order of Swarm::RealNames
+    std::set<std::string> reals = {"x", "y", "z"};
+    l.nint = 0;
+    for (auto &v : pkg.second->AllSwarmValues(swarm_name)) {
+      if (v.second.IsSet(Metadata::Integer)) {
+        l.nint++;
+      } else {
+        reals.insert(v.first);
+      }
+    }
+    l.nreal = reals.size();
+    const char *pos[3] = {"x", "y", "z"};
+    for (int d = 0; d < 3; d++)
+      l.ix[d] = std::distance(reals.begin(), reals.find(pos[d]));
+    found = true;
+  }
+  if (!found) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in SwarmBoundaries" << std::endl
+        << "No package registers the swarm " << swarm_name << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  return l;
+}
+
+// the records of the particles bound for one block or rank; those for a rank carry the
+// gid of the block in front of the integer record
+struct Records {
+  std::vector<Real> reals;
+  std::vector<int> ints;
+  int n = 0;
+};
+
+void Append(Records &to, const Real *reals, const int *ints, const Layout &l,
+            const int gid) {
+  to.reals.insert(to.reals.end(), reals, reals + l.nreal);
+  if (gid >= 0) to.ints.push_back(gid);
+  to.ints.insert(to.ints.end(), ints, ints + l.nint);
+  to.n++;
+}
+
+// sorts n records received from another rank by their block
+void Unpack(const Real *reals, const int *ints, const int n, const Layout &l,
+            std::map<int, Records> &local) {
+  for (int p = 0; p < n; p++) {
+    const int *rec = ints + p * (l.nint + 1);
+    Append(local[rec[0]], reals + p * l.nreal, rec + 1, l, -1);
+  }
+}
+
+void InsertAll(Mesh *pm, const std::string &swarm_name, std::map<int, Records> &local) {
+  for (auto &r : local) {
+    Swarm &swarm = *pm->FindMeshBlock(r.first)->swarms.at(swarm_name);
+    swarm.Insert(r.second.reals.data(), r.second.ints.data(), r.second.n);
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn void SwarmBoundaries::Exchange(Mesh *pm, const std::string &swarm_name,
+//                                     const int sort_interval)
+//  \brief moves the particles that have left their block
+
+void Exchange(Mesh *pm, const std::string &swarm_name, const int sort_interval) {
+  ProfilingRegion region("SwarmBoundaries::Exchange");
+  const Layout l = GetLayout(pm, swarm_name);
+  const int ndim = pm->ndim;
+  const RegionSize &ms = pm->mesh_size;
+  const Real mmin[3] = {ms.x1min, ms.x2min, ms.x3min};
+  const Real mmax[3] = {ms.x1max, ms.x2max, ms.x3max};
+
+  // the ranks owning neighbors of the blocks of this rank, which are mutual
+  std::set<int> peers;
+  for (auto &pmb : pm->block_list) {
+    for (int n = 0; n < pmb->pbval->nneighbor; n++) {
+      const int rank = pmb->pbval->neighbor[n].snb.rank;
+      if (rank != Globals::my_rank) peers.insert(rank);
+    }
+  }
+
+  std::map<int, Records> local;  // by gid
+  std::map<int, Records> remote; // by rank
+  for (auto &pmb : pm->block_list) {
+    Swarm &swarm = *pmb->swarms.at(swarm_name);
+    const int np = swarm.GetNumActive();
+    if (np == 0) continue;
+    const RegionSize &bs = pmb->block_size;
+    const Real bmin[3] = {bs.x1min, bs.x2min, bs.x3min};
+    const Real bmax[3] = {bs.x1max, bs.x2max, bs.x3max};
+    auto x = swarm.GetReal("x"), y = swarm.GetReal("y"), z = swarm.GetReal("z");
+    auto marked = swarm.GetMarked();
+    const int f2 = (ndim >= 2), f3 = (ndim >= 3);
+    const Real x1min = bs.x1min, x1max = bs.x1max, x2min = bs.x2min, x2max = bs.x2max;
+    const Real x3min = bs.x3min, x3max = bs.x3max;
+    pmb->par_for(
+        "SwarmBoundaries::Mark", 0, np - 1, KOKKOS_LAMBDA(const int p) {
+          marked(p) = (x(p) < x1min || x(p) >= x1max) ||
+                      (f2 && (y(p) < x2min || y(p) >= x2max)) ||
+                      (f3 && (z(p) < x3min || z(p) >= x3max));
+        });
+    std::vector<Real> reals;
+    std::vector<int> ints;
+    const int nout = swarm.PopMarked(reals, ints);
+
+    for (int p = 0; p < nout; p++) {
+      Real *r = &reals[p * l.nreal];
+      const int *ip = ints.data() + p * l.nint;
+      int ox[3] = {0, 0, 0}, fi[2] = {0, 0}, nfi = 0;
+      bool far = false, lost = false;
+      for (int d = 0; d < ndim; d++) {
+        Real &xd = r[l.ix[d]];
+        const Real half = 0.5 * (bmax[d] - bmin[d]);
+        ox[d] = (xd < bmin[d]) ? -1 : ((xd >= bmax[d]) ? 1 : 0);
+        // beyond the extent of the finest possible neighbor
+        far = far || (xd < bmin[d] - half) || (xd >= bmax[d] + half);
+        if (ox[d] == 0) fi[nfi++] = (xd >= bmin[d] + half);
+        const int face = 2 * d + (xd >= mmax[d]);
+        if (xd < mmin[d] || xd >= mmax[d]) {
+          if (pm->mesh_bcs[face] != BoundaryFlag::periodic) {
+            lost = true;
+          } else {
+            xd += (xd < mmin[d] ? 1 : -1) * (mmax[d] - mmin[d]);
+          }
+        }
+      }
+      if (lost) continue;
+
+      int gid = -1, rank = -1;
+      if (!far) {
+        BoundaryValues *pbval = pmb->pbval.get();
+        for (int n = 0; n < pbval->nneighbor; n++) {
+          const NeighborBlock &nb = pbval->neighbor[n];
+          if (nb.ni.ox1 != ox[0] || nb.ni.ox2 != ox[1] || nb.ni.ox3 != ox[2]) continue;
+          if (nb.snb.level > pmb->loc.level && (nb.ni.fi1 != fi[0] || nb.ni.fi2 != fi[1]))
+            continue;
+          gid = nb.snb.gid;
+          rank = nb.snb.rank;
+          break;
+        }
+      }
+      if (gid < 0) pm->LocateBlock(r[l.ix[0]], r[l.ix[1]], r[l.ix[2]], gid, rank);
+      if (rank == Globals::my_rank) {
+        Append(local[gid], r, ip, l, -1);
+      } else if (peers.count(rank) > 0) {
+        Append(remote[rank], r, ip, l, gid);
+      } else {
+        std::stringstream msg;
+        msg << "### FATAL ERROR in SwarmBoundaries::Exchange" << std::endl
+            << "A particle of swarm " << swarm_name << " moved from block " << pmb->gid
+            << " to block " << gid << " on rank " << rank
+            << ", which owns no neighbor of the blocks of rank " << Globals::my_rank
+            << "; exchange the particles more often" << std::endl;
+        ATHENA_ERROR(msg);
+      }
+    }
+  }
+
+#ifdef MPI_PARALLEL
+  // the numbers of particles first, then one message per value type and rank
+  MPI_Comm comm = pm->GetMPIComm(Mesh::particle_phys_id);
+  const std::vector<int> peer(peers.begin(), peers.end());
+  const int npeer = peer.size();
+  std::vector<int> nsend(npeer), nrecv(npeer);
+  std::vector<MPI_Request> req(2 * npeer);
+  for (int i = 0; i < npeer; i++) {
+    nsend[i] = remote[peer[i]].n;
+    MPI_Irecv(&nrecv[i], 1, MPI_INT, peer[i], 0, comm, &req[i]);
+  }
+  for (int i = 0; i < npeer; i++)
+    MPI_Isend(&nsend[i], 1, MPI_INT, peer[i], 0, comm, &req[npeer + i]);
+  MPI_Waitall(2 * npeer, req.data(), MPI_STATUSES_IGNORE);
+
+  std::vector<Records> in(npeer);
+  req.clear();
+  for (int i = 0; i < npeer; i++) {
+    if (nrecv[i] == 0) continue;
+    in[i].reals.resize(nrecv[i] * l.nreal);
+    in[i].ints.resize(nrecv[i] * (l.nint + 1));
+    req.emplace_back();
+    MPI_Irecv(in[i].reals.data(), in[i].reals.size(), MPI_ATHENA_REAL, peer[i], 1, comm,
+              &req.back());
+    req.emplace_back();
+    MPI_Irecv(in[i].ints.data(), in[i].ints.size(), MPI_INT, peer[i], 2, comm,
+              &req.back());
+  }
+  for (int i = 0; i < npeer; i++) {
+    if (nsend[i] == 0) continue;
+    Records &out = remote[peer[i]];
+    req.emplace_back();
+    MPI_Isend(out.reals.data(), out.reals.size(), MPI_ATHENA_REAL, peer[i], 1, comm,
+              &req.back());
+    req.emplace_back();
+    MPI_Isend(out.ints.data(), out.ints.size(), MPI_INT, peer[i], 2, comm, &req.back());
+  }
+  MPI_Waitall(req.size(), req.data(), MPI_STATUSES_IGNORE);
+  for (int i = 0; i < npeer; i++)
+    Unpack(in[i].reals.data(), in[i].ints.data(), nrecv[i], l, local);
+#endif // MPI_PARALLEL
+
+  InsertAll(pm, swarm_name, local);
+  if (sort_interval > 0 && pm->ncycle % sort_interval == 0) {
+    for (auto &pmb : pm->block_list)
+      pmb->swarms.at(swarm_name)->SortByCell(pmb);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void SwarmBoundaries::StashParticles(MeshBlock *pmb, ParticleStash &stash)
+//  \brief takes all particles of a block
+
+void StashParticles(MeshBlock *pmb, ParticleStash &stash) {
+  for (auto &s : pmb->swarms) {
+    Swarm &swarm = *s.second;
+    const int np = swarm.GetNumActive();
+    if (np == 0) continue;
+    auto marked = swarm.GetMarked();
+    pmb->par_for(
+        "SwarmBoundaries::Stash", 0, np - 1,
+        KOKKOS_LAMBDA(const int p) { marked(p) = 1; });
+    swarm.PopMarked(stash[s.first].first, stash[s.first].second);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void SwarmBoundaries::RestoreParticles(Mesh *pm, ParticleStash &stash)
+//  \brief hands the stashed particles to the blocks containing them, which may be on
+//  any rank
+
+void RestoreParticles(Mesh *pm, ParticleStash &stash) {
+  // the swarms in the same order on all ranks
+  std::set<std::string> names;
+  for (auto &pkg : pm->packages) {
+    for (auto &q : pkg.second->AllSwarms())
+      names.insert(q.first);
+  }
+  for (auto &name : names) {
+    const Layout l = GetLayout(pm, name);
+    const std::vector<Real> &reals = stash[name].first;
+    const std::vector<int> &ints = stash[name].second;
+    std::map<int, Records> local;
+    std::vector<Records> remote(Globals::nranks);
+    const int np = reals.size() / l.nreal;
+    for (int p = 0; p < np; p++) {
+      const Real *r = &reals[p * l.nreal];
+      const int *ip = ints.data() + p * l.nint;
+      int gid, rank;
+      pm->LocateBlock(r[l.ix[0]], r[l.ix[1]], r[l.ix[2]], gid, rank);
+      if (rank == Globals::my_rank) {
+        Append(local[gid], r, ip, l, -1);
+      } else {
+        Append(remote[rank], r, ip, l, gid);
+      }
+    }
+
+#ifdef MPI_PARALLEL
+    const int nranks = Globals::nranks;
+    MPI_Comm comm = pm->GetMPIComm(Mesh::particle_phys_id);
+    std::vector<int> nsend(nranks), nrecv(nranks);
+    for (int i = 0; i < nranks; i++)
+      nsend[i] = remote[i].n;
+    MPI_Alltoall(nsend.data(), 1, MPI_INT, nrecv.data(), 1, MPI_INT, comm);
+
+    // the counts and displacements of the reals (0) and integers (1)
+    const int size[2] = {l.nreal, l.nint + 1};
+    std::vector<int> scount[2], sdisp[2], rcount[2], rdisp[2];
+    for (int t = 0; t < 2; t++) {
+      scount[t].resize(nranks);
+      sdisp[t].resize(nranks + 1, 0);
+      rcount[t].resize(nranks);
+      rdisp[t].resize(nranks + 1, 0);
+      for (int i = 0; i < nranks; i++) {
+        scount[t][i] = nsend[i] * size[t];
+        sdisp[t][i + 1] = sdisp[t][i] + scount[t][i];
+        rcount[t][i] = nrecv[i] * size[t];
+        rdisp[t][i + 1] = rdisp[t][i] + rcount[t][i];
+      }
+    }
+    std::vector<Real> sreals, rreals(rdisp[0][nranks]);
+    std::vector<int> sints, rints(rdisp[1][nranks]);
+    for (int i = 0; i < nranks; i++) {
+      sreals.insert(sreals.end(), remote[i].reals.begin(), remote[i].reals.end());
+      sints.insert(sints.end(), remote[i].ints.begin(), remote[i].ints.end());
+    }
+    MPI_Alltoallv(sreals.data(), scount[0].data(), sdisp[0].data(), MPI_ATHENA_REAL,
+                  rreals.data(), rcount[0].data(), rdisp[0].data(), MPI_ATHENA_REAL,
+                  comm);
+    MPI_Alltoallv(sints.data(), scount[1].data(), sdisp[1].data(), MPI_INT, rints.data(),
+                  rcount[1].data(), rdisp[1].data(), MPI_INT, comm);
+    Unpack(rreals.data(), rints.data(), rreals.size() / l.nreal, l, local);
+#endif // MPI_PARALLEL
+
+    InsertAll(pm, name, local);
+  }
+  stash.clear();
+}
+
+} // namespace SwarmBoundaries
+
+} // namespace parthenon
@@ -0,0 +1,55 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef BVALS_BVALS_SWARM_HPP_
+#define BVALS_BVALS_SWARM_HPP_
+//! \file bvals_swarm.hpp
+//  \brief migration of the particles of swarms between MeshBlocks and MPI ranks
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "athena.hpp"
+
+namespace parthenon {
+
+class Mesh;
+class MeshBlock;
+
+namespace SwarmBoundaries {
+
+// the records (see Swarm::PopMarked) of the particles taken from blocks, per swarm
+using ParticleStash =
+    std::map<std::string, std::pair<std::vector<Real>, std::vector<int>>>;
+
+// moves the particles of a swarm that have left their block to the block now containing
+// them, on all blocks of the rank; called by all ranks. The destination is taken from
+// the neighbor lists of the block, so the particles of a rank go to ranks owning
+// neighbors of its blocks, in one message (per value type) per rank. Particles leaving
+// the mesh through a periodic face re-enter on the other side, through any other face
+// they are removed. With sort_interval > 0 the particles of each block are sorted by
+// cell every sort_interval cycles afterwards.
+void Exchange(Mesh *pm, const std::string &swarm_name, const int sort_interval = 0);
+
+// for the regrid: takes all particles of a block that is dropped from this rank ...
+void StashParticles(MeshBlock *pmb, ParticleStash &stash);
+// ... and hands them to the new blocks containing them once the new block lists are in
+// place; called by all ranks
+void RestoreParticles(Mesh *pm, ParticleStash &stash);
+
+} // namespace SwarmBoundaries
+
+} // namespace parthenon
+
+#endif // BVALS_BVALS_SWARM_HPP_
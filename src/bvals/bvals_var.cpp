@@ -20,20 +20,21 @@
 
 #include "bvals/bvals_interfaces.hpp"
 
-#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include "parthenon_mpi.hpp"
 
+#include "bvals/bvals_aggregate.hpp"
 #include "globals.hpp"
 #include "mesh/mesh.hpp"
 
 namespace parthenon {
 
 BoundaryVariable::BoundaryVariable(MeshBlock *pmb)
-    : bvar_index(), pmy_block_(pmb), pmy_mesh_(pmb->pmy_mesh) {}
+    : bvar_index(), pmy_block_(pmb), pmy_mesh_(pmb->pmy_mesh), aggregated_comm_(false) {}
 
 //----------------------------------------------------------------------------------------
 //! \fn void BoundaryVariable::InitBoundaryData(BoundaryData<> &bd, BoundaryQuantity type)
@@ -62,8 +63,6 @@ void BoundaryVariable::InitBoundaryData(BoundaryData<> &bd, BoundaryQuantity typ
     // Clear flags and requests
     bd.flag[n] = BoundaryStatus::waiting;
     bd.sflag[n] = BoundaryStatus::waiting;
-    bd.send[n] = nullptr;
-    bd.recv[n] = nullptr;
 #ifdef MPI_PARALLEL
     bd.req_send[n] = MPI_REQUEST_NULL;
     bd.req_recv[n] = MPI_REQUEST_NULL;
@@ -79,8 +78,8 @@ void BoundaryVariable::InitBoundaryData(BoundaryData<> &bd, BoundaryQuantity typ
           << "Invalid boundary type is specified." << std::endl;
       ATHENA_ERROR(msg);
     }
-    bd.send[n] = new Real[size];
-    bd.recv[n] = new Real[size];
+    bd.send[n] = BufArray1D<Real>("bvals send buffer", size);
+    bd.recv[n] = BufArray1D<Real>("bvals recv buffer", size);
   }
 }
 
@@ -90,8 +89,6 @@ void BoundaryVariable::InitBoundaryData(BoundaryData<> &bd, BoundaryQuantity typ
 
 void BoundaryVariable::DestroyBoundaryData(BoundaryData<> &bd) {
   for (int n = 0; n < bd.nbmax; n++) {
-    delete[] bd.send[n];
-    delete[] bd.recv[n];
 #ifdef MPI_PARALLEL
     if (bd.req_send[n] != MPI_REQUEST_NULL) MPI_Request_free(&bd.req_send[n]);
     if (bd.req_recv[n] != MPI_REQUEST_NULL) MPI_Request_free(&bd.req_recv[n]);
@@ -99,13 +96,59 @@ void BoundaryVariable::DestroyBoundaryData(BoundaryData<> &bd) {
   }
 }
 
+void BoundaryVariable::AccountMemory(MemoryUsage::Accounting &acc,
+                                     const std::string &label) const {
+  for (const BoundaryData<> *bd : {&bd_var_, &bd_var_flcor_}) {
+    for (int n = 0; n < bd->nbmax; n++) {
+      acc.AddView(label, "comm", bd->send[n]);
+      acc.AddView(label, "comm", bd->recv[n]);
+    }
+  }
+}
+
+#ifdef MPI_PARALLEL
+void BoundaryVariable::SetupPersistentSend(BoundaryData<> &bd, int bufid, int count,
+                                           int rank, int tag, MPI_Comm comm) {
+  PersistentRequestArgs args;
+  args.buf = bd.send[bufid].data();
+  args.count = count;
+  args.rank = rank;
+  args.tag = tag;
+  args.comm = comm;
+  if (bd.req_send[bufid] != MPI_REQUEST_NULL) {
+    if (args == bd.send_args[bufid]) return;
+    MPI_Request_free(&bd.req_send[bufid]);
+  }
+  MPI_Send_init(bd.send[bufid].data(), count, MPI_ATHENA_REAL, rank, tag, comm,
+                &bd.req_send[bufid]);
+  bd.send_args[bufid] = args;
+}
+
+void BoundaryVariable::SetupPersistentRecv(BoundaryData<> &bd, int bufid, int count,
+                                           int rank, int tag, MPI_Comm comm) {
+  PersistentRequestArgs args;
+  args.buf = bd.recv[bufid].data();
+  args.count = count;
+  args.rank = rank;
+  args.tag = tag;
+  args.comm = comm;
+  if (bd.req_recv[bufid] != MPI_REQUEST_NULL) {
+    if (args == bd.recv_args[bufid]) return;
+    MPI_Request_free(&bd.req_recv[bufid]);
+  }
+  MPI_Recv_init(bd.recv[bufid].data(), count, MPI_ATHENA_REAL, rank, tag, comm,
+                &bd.req_recv[bufid]);
+  bd.recv_args[bufid] = args;
+}
+#endif
+
 //----------------------------------------------------------------------------------------
 //! \fn void BoundaryVariable::CopyVariableBufferSameProcess(NeighborBlock& nb, int ssize)
 //  \brief
 
 //  Called in BoundaryVariable::SendBoundaryBuffer(), SendFluxCorrection() calls when the
 //  destination neighbor block is on the same MPI rank as the sending MeshBlcok. So
-//  std::memcpy() call requires pointer to "void *dst" corresponding to
+//  the device deep_copy() call requires the view corresponding to
 //  bd_var_.recv[nb.targetid] in separate BoundaryVariable object in separate vector in
 //  separate BoundaryValues
 
@@ -115,26 +158,37 @@ void BoundaryVariable::CopyVariableBufferSameProcess(NeighborBlock &nb, int ssiz
   MeshBlock *ptarget_block = pmy_mesh_->FindMeshBlock(nb.snb.gid);
   // 2) which element in vector of BoundaryVariable *?
   BoundaryData<> *ptarget_bdata = &(ptarget_block->pbval->bvars[bvar_index]->bd_var_);
-  std::memcpy(ptarget_bdata->recv[nb.targetid], bd_var_.send[nb.bufid],
-              ssize * sizeof(Real));
+  pmy_block_->deep_copy(
+      Kokkos::subview(ptarget_bdata->recv[nb.targetid], std::make_pair(0, ssize)),
+      Kokkos::subview(bd_var_.send[nb.bufid], std::make_pair(0, ssize)));
+  // the copy is asynchronous and the target block may be polled by another thread, so
+  // the data has to be in place before the flag is published
+  pmy_block_->exec_space.fence();
   // finally, set the BoundaryStatus flag on the destination buffer
   ptarget_bdata->flag[nb.targetid] = BoundaryStatus::arrived;
   return;
 }
 
-// KGF: change ssize to send_count
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryVariable::SignalVariableSameProcess(NeighborBlock& nb)
+//  \brief mark the data for a same-level neighbor on this rank as available without
+//  copying it; the neighbor fills its ghost zones directly from our interior
 
-void BoundaryVariable::CopyFluxCorrectionBufferSameProcess(NeighborBlock &nb, int ssize) {
-  // Locate target buffer
-  // 1) which MeshBlock?
+void BoundaryVariable::SignalVariableSameProcess(NeighborBlock &nb) {
   MeshBlock *ptarget_block = pmy_mesh_->FindMeshBlock(nb.snb.gid);
-  // 2) which element in vector of BoundaryVariable *?
-  BoundaryData<> *ptarget_bdata =
-      &(ptarget_block->pbval->bvars[bvar_index]->bd_var_flcor_);
-  std::memcpy(ptarget_bdata->recv[nb.targetid], bd_var_flcor_.send[nb.bufid],
-              ssize * sizeof(Real));
-  ptarget_bdata->flag[nb.targetid] = BoundaryStatus::arrived;
-  return;
+  ptarget_block->pbval->bvars[bvar_index]->bd_var_.flag[nb.targetid] =
+      BoundaryStatus::arrived;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void BoundaryVariable::SignalFluxCorrectionSameProcess(NeighborBlock& nb)
+//  \brief mark the fluxes for a coarser neighbor on this rank as available without
+//  copying them; the neighbor restricts them directly into its own flux arrays
+
+void BoundaryVariable::SignalFluxCorrectionSameProcess(NeighborBlock &nb) {
+  MeshBlock *ptarget_block = pmy_mesh_->FindMeshBlock(nb.snb.gid);
+  ptarget_block->pbval->bvars[bvar_index]->bd_var_flcor_.flag[nb.targetid] =
+      BoundaryStatus::arrived;
 }
 
 // Default / shared implementations of 4x BoundaryBuffer public functions
@@ -148,7 +202,16 @@ void BoundaryVariable::SendBoundaryBuffers() {
   int mylevel = pmb->loc.level;
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
+    if (!pmb->pbval->send_levels.Includes(nb, mylevel)) continue;
     if (bd_var_.sflag[nb.bufid] == BoundaryStatus::completed) continue;
+    if (nb.snb.rank == Globals::my_rank && nb.snb.level == mylevel &&
+        SameProcessDirectCopy()) {
+      // the neighbor copies straight from our interior once the data is final
+      pmb->exec_space.fence();
+      SignalVariableSameProcess(nb);
+      bd_var_.sflag[nb.bufid] = BoundaryStatus::completed;
+      continue;
+    }
     int ssize;
     if (nb.snb.level == mylevel)
       ssize = LoadBoundaryBufferSameLevel(bd_var_.send[nb.bufid], nb);
@@ -161,7 +224,13 @@ void BoundaryVariable::SendBoundaryBuffers() {
       CopyVariableBufferSameProcess(nb, ssize);
     } else {
 #ifdef MPI_PARALLEL
-      MPI_Start(&(bd_var_.req_send[nb.bufid]));
+      // the buffer is filled asynchronously on the device, so it has to be complete
+      // before MPI is allowed to read from it
+      pmb->exec_space.fence();
+      if (aggregated_comm_)
+        pmy_mesh_->paggcomm->BufferPacked(this, nb.bufid);
+      else
+        MPI_Start(&(bd_var_.req_send[nb.bufid]));
 #endif
     }
 
@@ -176,9 +245,14 @@ void BoundaryVariable::SendBoundaryBuffers() {
 
 bool BoundaryVariable::ReceiveBoundaryBuffers() {
   bool bflag = true;
+#ifdef MPI_PARALLEL
+  bool polled = false;
+#endif
 
+  const int mylevel = pmy_block_->loc.level;
   for (int n = 0; n < pmy_block_->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmy_block_->pbval->neighbor[n];
+    if (!pmy_block_->pbval->recv_levels.Includes(nb, mylevel)) continue;
     if (bd_var_.flag[nb.bufid] == BoundaryStatus::arrived) continue;
     if (bd_var_.flag[nb.bufid] == BoundaryStatus::waiting) {
       if (nb.snb.rank == Globals::my_rank) { // on the same process
@@ -186,15 +260,23 @@ bool BoundaryVariable::ReceiveBoundaryBuffers() {
         continue;
       }
 #ifdef MPI_PARALLEL
-      else { // NOLINT // MPI boundary
-        int test;
-        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &test, MPI_STATUS_IGNORE);
-        MPI_Test(&(bd_var_.req_recv[nb.bufid]), &test, MPI_STATUS_IGNORE);
-        if (!static_cast<bool>(test)) {
+      else if (aggregated_comm_) { // NOLINT // MPI boundary
+        if (!pmy_mesh_->paggcomm->Test(nb.snb.rank)) {
           bflag = false;
           continue;
         }
         bd_var_.flag[nb.bufid] = BoundaryStatus::arrived;
+      } else {
+        // the tracker marks the buffer once it has arrived; one poll serves all of
+        // them, and those of the other blocks of this rank
+        if (!polled) {
+          pmy_mesh_->recv_tracker.Poll();
+          polled = true;
+        }
+        if (bd_var_.flag[nb.bufid] != BoundaryStatus::arrived) {
+          bflag = false;
+          continue;
+        }
       }
 #endif
     }
@@ -211,6 +293,7 @@ void BoundaryVariable::SetBoundaries() {
   int mylevel = pmb->loc.level;
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
+    if (!pmb->pbval->recv_levels.Includes(nb, mylevel)) continue;
     if (nb.snb.level == mylevel)
       SetBoundarySameLevel(bd_var_.recv[nb.bufid], nb);
     else if (nb.snb.level < mylevel) // only sets the prolongation buffer
@@ -219,6 +302,9 @@ void BoundaryVariable::SetBoundaries() {
       SetBoundaryFromFiner(bd_var_.recv[nb.bufid], nb);
     bd_var_.flag[nb.bufid] = BoundaryStatus::completed; // completed
   }
+  // the unpacking kernels run asynchronously; physical boundaries and prolongation
+  // that follow operate on the ghost zones, so wait for them to finish
+  pmb->exec_space.fence();
 
   return;
 }
@@ -232,9 +318,14 @@ void BoundaryVariable::ReceiveAndSetBoundariesWithWait() {
   int mylevel = pmb->loc.level;
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
+    if (!pmb->pbval->recv_levels.Includes(nb, mylevel)) continue;
 #ifdef MPI_PARALLEL
-    if (nb.snb.rank != Globals::my_rank)
-      MPI_Wait(&(bd_var_.req_recv[nb.bufid]), MPI_STATUS_IGNORE);
+    if (nb.snb.rank != Globals::my_rank) {
+      if (aggregated_comm_)
+        pmy_mesh_->paggcomm->Wait(nb.snb.rank);
+      else
+        pmy_mesh_->recv_tracker.Wait(&(bd_var_.req_recv[nb.bufid]));
+    }
 #endif
     if (nb.snb.level == mylevel)
       SetBoundarySameLevel(bd_var_.recv[nb.bufid], nb);
@@ -244,6 +335,7 @@ void BoundaryVariable::ReceiveAndSetBoundariesWithWait() {
       SetBoundaryFromFiner(bd_var_.recv[nb.bufid], nb);
     bd_var_.flag[nb.bufid] = BoundaryStatus::completed; // completed
   }
+  pmb->exec_space.fence();
 
   return;
 }
@@ -31,6 +31,7 @@
 #include "parthenon_mpi.hpp"
 
 #include "basic_types.hpp"
+#include "bvals/bvals_aggregate.hpp"
 #include "coordinates/coordinates.hpp"
 #include "globals.hpp"
 #include "mesh/mesh.hpp"
@@ -44,7 +45,8 @@ CellCenteredBoundaryVariable::CellCenteredBoundaryVariable(MeshBlock *pmb,
                                                            ParArrayND<Real> coarse_var,
                                                            ParArrayND<Real> var_flux[])
     : BoundaryVariable(pmb), var_cc(var), coarse_buf(coarse_var), x1flux(var_flux[X1DIR]),
-      x2flux(var_flux[X2DIR]), x3flux(var_flux[X3DIR]), nl_(0), nu_(var.GetDim(4) - 1) {
+      x2flux(var_flux[X2DIR]), x3flux(var_flux[X3DIR]), single_precision_comm(false),
+      nl_(0), nu_(var.GetDim(4) - 1) {
   // CellCenteredBoundaryVariable should only be used w/ 4D or 3D (nx4=1) ParArrayND
   // For now, assume that full span of 4th dim of input ParArrayND should be used:
   // ---> get the index limits directly from the input ParArrayND
@@ -69,6 +71,7 @@ CellCenteredBoundaryVariable::CellCenteredBoundaryVariable(MeshBlock *pmb,
     cc_flx_phys_id_ = cc_phys_id_ + 1;
 #endif
   }
+  aggregated_comm_ = (pmy_mesh_->paggcomm != nullptr);
 }
 
 // destructor
@@ -117,12 +120,12 @@ int CellCenteredBoundaryVariable::ComputeFluxCorrectionBufferSize(
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int CellCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
-//                                                                const NeighborBlock& nb)
-//  \brief Set cell-centered boundary buffers for sending to a block on the same level
+//! \fn void CellCenteredBoundaryVariable::SendIndicesSameLevel(const NeighborBlock &nb,
+//                                                              BndInfo &b) const
+//  \brief index range of the buffer for sending to a block on the same level
 
-int CellCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
-                                                              const NeighborBlock &nb) {
+void CellCenteredBoundaryVariable::SendIndicesSameLevel(const NeighborBlock &nb,
+                                                        BndInfo &b) const {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
 
@@ -132,19 +135,35 @@ int CellCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
   ej = (nb.ni.ox2 < 0) ? (pmb->js + NGHOST - 1) : pmb->je;
   sk = (nb.ni.ox3 > 0) ? (pmb->ke - NGHOST + 1) : pmb->ks;
   ek = (nb.ni.ox3 < 0) ? (pmb->ks + NGHOST - 1) : pmb->ke;
-  int p = 0;
-  BufferUtility::PackData(var_cc, buf, nl_, nu_, si, ei, sj, ej, sk, ek, p);
 
-  return p;
+  b.si = si, b.ei = ei;
+  b.sj = sj, b.ej = ej;
+  b.sk = sk, b.ek = ek;
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int CellCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
-//                                                                const NeighborBlock& nb)
-//  \brief Set cell-centered boundary buffers for sending to a block on the coarser level
+//! \fn int CellCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
+//  \brief Set cell-centered boundary buffers for sending to a block on the same level
 
-int CellCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
+int CellCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(BufArray1D<Real> &buf,
                                                               const NeighborBlock &nb) {
+  BndInfo b;
+  SendIndicesSameLevel(nb, b);
+
+  int p = 0;
+  PackBuffer(var_cc, buf, b, p);
+
+  return BufferLength(p);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SendIndicesToCoarser(const NeighborBlock &nb,
+//                                                              BndInfo &b) const
+//  \brief index range of the buffer for sending to a block on the coarser level
+
+void CellCenteredBoundaryVariable::SendIndicesToCoarser(const NeighborBlock &nb,
+                                                        BndInfo &b) const {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
   int cn = NGHOST - 1;
@@ -156,20 +175,36 @@ int CellCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
   sk = (nb.ni.ox3 > 0) ? (pmb->cke - cn) : pmb->cks;
   ek = (nb.ni.ox3 < 0) ? (pmb->cks + cn) : pmb->cke;
 
+  b.si = si, b.ei = ei;
+  b.sj = sj, b.ej = ej;
+  b.sk = sk, b.ek = ek;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn int CellCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
+//  \brief Set cell-centered boundary buffers for sending to a block on the coarser level
+
+int CellCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(BufArray1D<Real> &buf,
+                                                              const NeighborBlock &nb) {
+  MeshBlock *pmb = pmy_block_;
+  BndInfo b;
+  SendIndicesToCoarser(nb, b);
+
   int p = 0;
-  pmb->pmr->RestrictCellCenteredValues(var_cc, coarse_buf, nl_, nu_, si, ei, sj, ej, sk,
-                                       ek);
-  BufferUtility::PackData(coarse_buf, buf, nl_, nu_, si, ei, sj, ej, sk, ek, p);
-  return p;
+  pmb->pmr->RestrictCellCenteredValues(var_cc, coarse_buf, nl_, nu_, b.si, b.ei, b.sj,
+                                       b.ej, b.sk, b.ek);
+  PackBuffer(coarse_buf, buf, b, p);
+  return BufferLength(p);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int CellCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
-//                                                                const NeighborBlock& nb)
-//  \brief Set cell-centered boundary buffers for sending to a block on the finer level
+//! \fn void CellCenteredBoundaryVariable::SendIndicesToFiner(const NeighborBlock &nb,
+//                                                            BndInfo &b) const
+//  \brief index range of the buffer for sending to a block on the finer level
 
-int CellCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
-                                                            const NeighborBlock &nb) {
+void CellCenteredBoundaryVariable::SendIndicesToFiner(const NeighborBlock &nb,
+                                                      BndInfo &b) const {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
   int cn = pmb->cnghost - 1;
@@ -216,18 +251,33 @@ int CellCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
     }
   }
 
+  b.si = si, b.ei = ei;
+  b.sj = sj, b.ej = ej;
+  b.sk = sk, b.ek = ek;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn int CellCenteredBoundaryVariable::LoadBoundaryBufferToFiner(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
+//  \brief Set cell-centered boundary buffers for sending to a block on the finer level
+
+int CellCenteredBoundaryVariable::LoadBoundaryBufferToFiner(BufArray1D<Real> &buf,
+                                                            const NeighborBlock &nb) {
+  BndInfo b;
+  SendIndicesToFiner(nb, b);
+
   int p = 0;
-  BufferUtility::PackData(var_cc, buf, nl_, nu_, si, ei, sj, ej, sk, ek, p);
-  return p;
+  PackBuffer(var_cc, buf, b, p);
+  return BufferLength(p);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void CellCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
-//                                                              const NeighborBlock& nb)
-//  \brief Set cell-centered boundary received from a block on the same level
+//! \fn void CellCenteredBoundaryVariable::RecvIndicesSameLevel(const NeighborBlock &nb,
+//                                                              BndInfo &b) const
+//  \brief index range of the buffer for receiving from a block on the same level
 
-void CellCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
-                                                        const NeighborBlock &nb) {
+void CellCenteredBoundaryVariable::RecvIndicesSameLevel(const NeighborBlock &nb,
+                                                        BndInfo &b) const {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
 
@@ -250,18 +300,75 @@ void CellCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
   else
     sk = pmb->ks - NGHOST, ek = pmb->ks - 1;
 
+  b.si = si, b.ei = ei;
+  b.sj = sj, b.ej = ej;
+  b.sk = sk, b.ek = ek;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::CopyIndicesSameProcess(
+//     const NeighborBlock &nb, BndCopyInfo &c) const
+//  \brief ghost range of a same-level neighbor on this rank and where its data lives.
+//  All blocks share the same size, so the source strip is the ghost range shifted by
+//  one block width in the direction of the neighbor
+
+void CellCenteredBoundaryVariable::CopyIndicesSameProcess(const NeighborBlock &nb,
+                                                          BndCopyInfo &c) const {
+  MeshBlock *pmb = pmy_block_;
+  BndInfo b;
+  RecvIndicesSameLevel(nb, b);
+  c.si = b.si, c.ei = b.ei;
+  c.sj = b.sj, c.ej = b.ej;
+  c.sk = b.sk, c.ek = b.ek;
+  c.nl = nl_, c.nu = nu_;
+  c.di = -nb.ni.ox1 * pmb->block_size.nx1;
+  c.dj = -nb.ni.ox2 * pmb->block_size.nx2;
+  c.dk = -nb.ni.ox3 * pmb->block_size.nx3;
+
+  MeshBlock *psrc_block = pmy_mesh_->FindMeshBlock(nb.snb.gid);
+  auto psrc = static_cast<CellCenteredBoundaryVariable *>(
+      psrc_block->pbval->bvars[bvar_index].get());
+  c.src = psrc->var_cc.Get<4>();
+  c.dst = var_cc.Get<4>();
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SetBoundarySameLevel(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
+//  \brief Set cell-centered boundary received from a block on the same level
+
+void CellCenteredBoundaryVariable::SetBoundarySameLevel(BufArray1D<Real> &buf,
+                                                        const NeighborBlock &nb) {
+  MeshBlock *pmb = pmy_block_;
+  if (nb.snb.rank == Globals::my_rank) {
+    // the neighbor only signaled its data, read it from its interior
+    BndCopyInfo c;
+    CopyIndicesSameProcess(nb, c);
+    const int di = c.di, dj = c.dj, dk = c.dk;
+    auto src = c.src;
+    auto dst = c.dst;
+    pmb->par_for(
+        "SetBoundarySameProcess", c.nl, c.nu, c.sk, c.ek, c.sj, c.ej, c.si, c.ei,
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          dst(n, k, j, i) = src(n, k + dk, j + dj, i + di);
+        });
+    return;
+  }
+  BndInfo b;
+  RecvIndicesSameLevel(nb, b);
+
   int p = 0;
 
-  BufferUtility::UnpackData(buf, var_cc, nl_, nu_, si, ei, sj, ej, sk, ek, p);
+  UnpackBuffer(buf, var_cc, b, p);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void CellCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
-//                                                                const NeighborBlock& nb)
-//  \brief Set cell-centered prolongation buffer received from a block on a coarser level
+//! \fn void CellCenteredBoundaryVariable::RecvIndicesFromCoarser(const NeighborBlock &nb,
+//                                                                BndInfo &b) const
+//  \brief index range of the buffer for receiving from a block on a coarser level
 
-void CellCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
-                                                          const NeighborBlock &nb) {
+void CellCenteredBoundaryVariable::RecvIndicesFromCoarser(const NeighborBlock &nb,
+                                                          BndInfo &b) const {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
   int cng = pmb->cnghost;
@@ -304,17 +411,32 @@ void CellCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
     sk = pmb->cks - cng, ek = pmb->cks - 1;
   }
 
+  b.si = si, b.ei = ei;
+  b.sj = sj, b.ej = ej;
+  b.sk = sk, b.ek = ek;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SetBoundaryFromCoarser(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
+//  \brief Set cell-centered prolongation buffer received from a block on a coarser level
+
+void CellCenteredBoundaryVariable::SetBoundaryFromCoarser(BufArray1D<Real> &buf,
+                                                          const NeighborBlock &nb) {
+  BndInfo b;
+  RecvIndicesFromCoarser(nb, b);
+
   int p = 0;
-  BufferUtility::UnpackData(buf, coarse_buf, nl_, nu_, si, ei, sj, ej, sk, ek, p);
+  UnpackBuffer(buf, coarse_buf, b, p);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void CellCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
-//                                                              const NeighborBlock& nb)
-//  \brief Set cell-centered boundary received from a block on a finer level
+//! \fn void CellCenteredBoundaryVariable::RecvIndicesFromFiner(const NeighborBlock &nb,
+//                                                              BndInfo &b) const
+//  \brief index range of the buffer for receiving from a block on a finer level
 
-void CellCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
-                                                        const NeighborBlock &nb) {
+void CellCenteredBoundaryVariable::RecvIndicesFromFiner(const NeighborBlock &nb,
+                                                        BndInfo &b) const {
   MeshBlock *pmb = pmy_block_;
   // receive already restricted data
   int si, sj, sk, ei, ej, ek;
@@ -371,59 +493,178 @@ void CellCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
     sk = pmb->ks - NGHOST, ek = pmb->ks - 1;
   }
 
+  b.si = si, b.ei = ei;
+  b.sj = sj, b.ej = ej;
+  b.sk = sk, b.ek = ek;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SetBoundaryFromFiner(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
+//  \brief Set cell-centered boundary received from a block on a finer level
+
+void CellCenteredBoundaryVariable::SetBoundaryFromFiner(BufArray1D<Real> &buf,
+                                                        const NeighborBlock &nb) {
+  BndInfo b;
+  RecvIndicesFromFiner(nb, b);
+
   int p = 0;
-  BufferUtility::UnpackData(buf, var_cc, nl_, nu_, si, ei, sj, ej, sk, ek, p);
+  UnpackBuffer(buf, var_cc, b, p);
 }
 
-void CellCenteredBoundaryVariable::SetupPersistentMPI() {
-#ifdef MPI_PARALLEL
-  MeshBlock *pmb = pmy_block_;
-  int &mylevel = pmb->loc.level;
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::MessageSizes(const NeighborBlock &nb,
+//                                                       int &ssize, int &rsize) const
+//  \brief number of Reals sent to and received from the neighbor nb
 
+void CellCenteredBoundaryVariable::MessageSizes(const NeighborBlock &nb, int &ssize,
+                                                int &rsize) const {
+  MeshBlock *pmb = pmy_block_;
+  const int mylevel = pmb->loc.level;
   int cng, cng1, cng2, cng3;
   cng = cng1 = pmb->cnghost;
   cng2 = (pmy_mesh_->ndim >= 2) ? cng : 0;
   cng3 = (pmy_mesh_->ndim >= 3) ? cng : 0;
+
+  if (nb.snb.level == mylevel) { // same
+    ssize = rsize = ((nb.ni.ox1 == 0) ? pmb->block_size.nx1 : NGHOST) *
+                    ((nb.ni.ox2 == 0) ? pmb->block_size.nx2 : NGHOST) *
+                    ((nb.ni.ox3 == 0) ? pmb->block_size.nx3 : NGHOST);
+  } else if (nb.snb.level < mylevel) { // coarser
+    ssize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2) : NGHOST) *
+            ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2) : NGHOST) *
+            ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2) : NGHOST);
+    rsize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2 + cng1) : cng1) *
+            ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2 + cng2) : cng2) *
+            ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2 + cng3) : cng3);
+  } else { // finer
+    ssize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2 + cng1) : cng1) *
+            ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2 + cng2) : cng2) *
+            ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2 + cng3) : cng3);
+    rsize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2) : NGHOST) *
+            ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2) : NGHOST) *
+            ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2) : NGHOST);
+  }
+  ssize = BufferLength(ssize * (nu_ + 1));
+  rsize = BufferLength(rsize * (nu_ + 1));
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::PackBuffer(ParArrayND<Real> &src,
+//                             BufArray1D<Real> &buf, const BndInfo &b, int &p)
+//  \brief pack the index range of b into buf, in single precision if requested
+
+void CellCenteredBoundaryVariable::PackBuffer(ParArrayND<Real> &src,
+                                              BufArray1D<Real> &buf, const BndInfo &b,
+                                              int &p) {
+  DevSpace exec_space = pmy_block_->exec_space;
+  if (single_precision_comm)
+    BufferUtility::PackDataSingle(src, buf, nl_, nu_, b.si, b.ei, b.sj, b.ej, b.sk, b.ek,
+                                  p, exec_space);
+  else
+    BufferUtility::PackData(src, buf, nl_, nu_, b.si, b.ei, b.sj, b.ej, b.sk, b.ek, p,
+                            exec_space);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::UnpackBuffer(BufArray1D<Real> &buf,
+//                             ParArrayND<Real> &dst, const BndInfo &b, int &p)
+//  \brief unpack buf into the index range of b, widening single precision data
+
+void CellCenteredBoundaryVariable::UnpackBuffer(BufArray1D<Real> &buf,
+                                                ParArrayND<Real> &dst, const BndInfo &b,
+                                                int &p) {
+  DevSpace exec_space = pmy_block_->exec_space;
+  if (single_precision_comm)
+    BufferUtility::UnpackDataSingle(buf, dst, nl_, nu_, b.si, b.ei, b.sj, b.ej, b.sk,
+                                    b.ek, p, exec_space);
+  else
+    BufferUtility::UnpackData(buf, dst, nl_, nu_, b.si, b.ei, b.sj, b.ej, b.sk, b.ek, p,
+                              exec_space);
+}
+
+int CellCenteredBoundaryVariable::BufferLength(const int p) const {
+  return single_precision_comm ? BufferUtility::SingleBufferLength<Real>(p) : p;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::CopyToContiguous()
+//  \brief refresh var_cc from var_strided, if the variable is stored component innermost
+
+void CellCenteredBoundaryVariable::CopyToContiguous() {
+  if (var_strided.GetSize() == 0) return;
+  MeshBlock *pmb = pmy_block_;
+  auto src = var_strided.Get<4>();
+  ParArray4D<Real> dst = var_cc.Get<4>();
+  pmb->par_for(
+      "CopyToContiguous", nl_, nu_, 0, pmb->ncells3 - 1, 0, pmb->ncells2 - 1, 0,
+      pmb->ncells1 - 1,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        dst(n, k, j, i) = src(n, k, j, i);
+      });
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::CopyGhostsFromContiguous()
+//  \brief copy the ghost zones of var_cc to var_strided, if the variable is stored
+//  component innermost, and wait for the copy. The interior of var_strided may have
+//  been updated since CopyToContiguous(), so it is left alone.
+
+void CellCenteredBoundaryVariable::CopyGhostsFromContiguous() {
+  if (var_strided.GetSize() == 0) return;
+  MeshBlock *pmb = pmy_block_;
+  ParArray4D<Real> src = var_cc.Get<4>();
+  auto dst = var_strided.Get<4>();
+  const int is = pmb->is, ie = pmb->ie, js = pmb->js, je = pmb->je;
+  const int ks = pmb->ks, ke = pmb->ke;
+  pmb->par_for(
+      "CopyGhostsFromContiguous", nl_, nu_, 0, pmb->ncells3 - 1, 0, pmb->ncells2 - 1, 0,
+      pmb->ncells1 - 1,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        if (k < ks || k > ke || j < js || j > je || i < is || i > ie) {
+          dst(n, k, j, i) = src(n, k, j, i);
+        }
+      });
+  pmb->exec_space.fence();
+}
+
+void CellCenteredBoundaryVariable::SendBoundaryBuffers() {
+  CopyToContiguous();
+  BoundaryVariable::SendBoundaryBuffers();
+}
+
+void CellCenteredBoundaryVariable::ReceiveAndSetBoundariesWithWait() {
+  BoundaryVariable::ReceiveAndSetBoundariesWithWait();
+  CopyGhostsFromContiguous();
+}
+
+void CellCenteredBoundaryVariable::SetBoundaries() {
+  BoundaryVariable::SetBoundaries();
+  CopyGhostsFromContiguous();
+}
+
+void CellCenteredBoundaryVariable::SetupPersistentMPI() {
+#ifdef MPI_PARALLEL
+  MeshBlock *pmb = pmy_block_;
+  int &mylevel = pmb->loc.level;
+
   int ssize, rsize;
   int tag;
   // Initialize non-polar neighbor communications to other ranks
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
     if (nb.snb.rank != Globals::my_rank) {
-      if (nb.snb.level == mylevel) { // same
-        ssize = rsize = ((nb.ni.ox1 == 0) ? pmb->block_size.nx1 : NGHOST) *
-                        ((nb.ni.ox2 == 0) ? pmb->block_size.nx2 : NGHOST) *
-                        ((nb.ni.ox3 == 0) ? pmb->block_size.nx3 : NGHOST);
-      } else if (nb.snb.level < mylevel) { // coarser
-        ssize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2) : NGHOST) *
-                ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2) : NGHOST) *
-                ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2) : NGHOST);
-        rsize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2 + cng1) : cng1) *
-                ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2 + cng2) : cng2) *
-                ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2 + cng3) : cng3);
-      } else { // finer
-        ssize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2 + cng1) : cng1) *
-                ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2 + cng2) : cng2) *
-                ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2 + cng3) : cng3);
-        rsize = ((nb.ni.ox1 == 0) ? ((pmb->block_size.nx1 + 1) / 2) : NGHOST) *
-                ((nb.ni.ox2 == 0) ? ((pmb->block_size.nx2 + 1) / 2) : NGHOST) *
-                ((nb.ni.ox3 == 0) ? ((pmb->block_size.nx3 + 1) / 2) : NGHOST);
+      // the variable buffers travel in the rank-level messages when aggregated
+      if (!aggregated_comm_) {
+        MessageSizes(nb, ssize, rsize);
+        // Initialize persistent communication requests attached to specific BoundaryData
+        tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid);
+        SetupPersistentSend(bd_var_, nb.bufid, ssize, nb.snb.rank, tag,
+                            pmy_mesh_->GetMPIComm(cc_phys_id_));
+        tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid);
+        SetupPersistentRecv(bd_var_, nb.bufid, rsize, nb.snb.rank, tag,
+                            pmy_mesh_->GetMPIComm(cc_phys_id_));
       }
-      ssize *= (nu_ + 1);
-      rsize *= (nu_ + 1);
-      // specify the offsets in the view point of the target block: flip ox? signs
-
-      // Initialize persistent communication requests attached to specific BoundaryData
-      tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid, cc_phys_id_);
-      if (bd_var_.req_send[nb.bufid] != MPI_REQUEST_NULL)
-        MPI_Request_free(&bd_var_.req_send[nb.bufid]);
-      MPI_Send_init(bd_var_.send[nb.bufid], ssize, MPI_ATHENA_REAL, nb.snb.rank, tag,
-                    MPI_COMM_WORLD, &(bd_var_.req_send[nb.bufid]));
-      tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid, cc_phys_id_);
-      if (bd_var_.req_recv[nb.bufid] != MPI_REQUEST_NULL)
-        MPI_Request_free(&bd_var_.req_recv[nb.bufid]);
-      MPI_Recv_init(bd_var_.recv[nb.bufid], rsize, MPI_ATHENA_REAL, nb.snb.rank, tag,
-                    MPI_COMM_WORLD, &(bd_var_.req_recv[nb.bufid]));
 
       if (pmy_mesh_->multilevel && nb.ni.type == NeighborConnect::face) {
         int size;
@@ -435,17 +676,13 @@ void CellCenteredBoundaryVariable::SetupPersistentMPI() {
           size = ((pmb->block_size.nx1 + 1) / 2) * ((pmb->block_size.nx2 + 1) / 2);
         size *= (nu_ + 1);
         if (nb.snb.level < mylevel) { // send to coarser
-          tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid, cc_flx_phys_id_);
-          if (bd_var_flcor_.req_send[nb.bufid] != MPI_REQUEST_NULL)
-            MPI_Request_free(&bd_var_flcor_.req_send[nb.bufid]);
-          MPI_Send_init(bd_var_flcor_.send[nb.bufid], size, MPI_ATHENA_REAL, nb.snb.rank,
-                        tag, MPI_COMM_WORLD, &(bd_var_flcor_.req_send[nb.bufid]));
+          tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid);
+          SetupPersistentSend(bd_var_flcor_, nb.bufid, size, nb.snb.rank, tag,
+                              pmy_mesh_->GetMPIComm(cc_flx_phys_id_));
         } else if (nb.snb.level > mylevel) { // receive from finer
-          tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid, cc_flx_phys_id_);
-          if (bd_var_flcor_.req_recv[nb.bufid] != MPI_REQUEST_NULL)
-            MPI_Request_free(&bd_var_flcor_.req_recv[nb.bufid]);
-          MPI_Recv_init(bd_var_flcor_.recv[nb.bufid], size, MPI_ATHENA_REAL, nb.snb.rank,
-                        tag, MPI_COMM_WORLD, &(bd_var_flcor_.req_recv[nb.bufid]));
+          tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid);
+          SetupPersistentRecv(bd_var_flcor_, nb.bufid, size, nb.snb.rank, tag,
+                              pmy_mesh_->GetMPIComm(cc_flx_phys_id_));
         }
       }
     }
@@ -454,19 +691,53 @@ void CellCenteredBoundaryVariable::SetupPersistentMPI() {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SetupAggregatedMPI(AggregatedBoundaryComm &agg)
+//  \brief register the variable buffers of all remote neighbors with the aggregator
+
+void CellCenteredBoundaryVariable::SetupAggregatedMPI(AggregatedBoundaryComm &agg) {
+#ifdef MPI_PARALLEL
+  MeshBlock *pmb = pmy_block_;
+  const int ivar = static_cast<int>(bvar_index);
+  int ssize, rsize;
+  agg.AddVariable();
+  for (int n = 0; n < pmb->pbval->nneighbor; n++) {
+    NeighborBlock &nb = pmb->pbval->neighbor[n];
+    if (nb.snb.rank == Globals::my_rank) continue;
+    MessageSizes(nb, ssize, rsize);
+    // keys are given from the point of view of the receiving block on both sides
+    agg.AddSend(nb.snb.rank, {pmb->gid, nb.snb.gid, ivar, nb.targetid}, this, nb.bufid,
+                bd_var_.send[nb.bufid], ssize);
+    agg.AddRecv(nb.snb.rank, {nb.snb.gid, pmb->gid, ivar, nb.bufid}, this, nb.bufid,
+                bd_var_.recv[nb.bufid], rsize);
+  }
+#endif
+  return;
+}
+
 void CellCenteredBoundaryVariable::StartReceiving(BoundaryCommSubset phase) {
 #ifdef MPI_PARALLEL
   MeshBlock *pmb = pmy_block_;
   int mylevel = pmb->loc.level;
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
+    // a subcycled step receives from the neighbors of some levels only
+    if (!pmb->pbval->recv_levels.Includes(nb, mylevel)) continue;
     if (nb.snb.rank != Globals::my_rank) {
-      MPI_Start(&(bd_var_.req_recv[nb.bufid]));
+      if (!aggregated_comm_) {
+        MPI_Start(&(bd_var_.req_recv[nb.bufid]));
+        pmy_mesh_->recv_tracker.Add(&(bd_var_.req_recv[nb.bufid]),
+                                    &(bd_var_.flag[nb.bufid]));
+      }
       if (phase == BoundaryCommSubset::all && nb.ni.type == NeighborConnect::face &&
-          nb.snb.level > mylevel) // opposite condition in ClearBoundary()
+          nb.snb.level > mylevel) { // opposite condition in ClearBoundary()
         MPI_Start(&(bd_var_flcor_.req_recv[nb.bufid]));
+        pmy_mesh_->recv_tracker.Add(&(bd_var_flcor_.req_recv[nb.bufid]),
+                                    &(bd_var_flcor_.flag[nb.bufid]));
+      }
     }
   }
+  if (aggregated_comm_) pmy_mesh_->paggcomm->StartReceiving();
 #endif
   return;
 }
@@ -484,15 +755,19 @@ void CellCenteredBoundaryVariable::ClearBoundary(BoundaryCommSubset phase) {
 #ifdef MPI_PARALLEL
     MeshBlock *pmb = pmy_block_;
     int mylevel = pmb->loc.level;
-    if (nb.snb.rank != Globals::my_rank) {
+    if (nb.snb.rank != Globals::my_rank &&
+        pmb->pbval->send_levels.Includes(nb, mylevel)) {
       // Wait for Isend
-      MPI_Wait(&(bd_var_.req_send[nb.bufid]), MPI_STATUS_IGNORE);
+      if (!aggregated_comm_) MPI_Wait(&(bd_var_.req_send[nb.bufid]), MPI_STATUS_IGNORE);
       if (phase == BoundaryCommSubset::all && nb.ni.type == NeighborConnect::face &&
           nb.snb.level < mylevel)
         MPI_Wait(&(bd_var_flcor_.req_send[nb.bufid]), MPI_STATUS_IGNORE);
     }
 #endif
   }
+#ifdef MPI_PARALLEL
+  if (aggregated_comm_) pmy_mesh_->paggcomm->ClearBoundary();
+#endif
 }
 
 } // namespace parthenon
@@ -20,6 +20,9 @@
 //  \brief handle boundaries for any ParArrayND type variable that represents a physical
 //         quantity indexed along / located around cell-centers
 
+#include <memory>
+#include <vector>
+
 #include "parthenon_mpi.hpp"
 
 #include "athena.hpp"
@@ -46,6 +49,15 @@ class CellCenteredBoundaryVariable : public BoundaryVariable {
   // nullptr is not allowed
   ParArrayND<Real> x1flux, x2flux, x3flux;
 
+  // with Metadata::SinglePrecisionComm the ghost data is sent as float and widened again
+  // on unpacking; set before SetupPersistentMPI()
+  bool single_precision_comm;
+
+  // with Metadata::ComponentInnermost, the storage of the variable, of which var_cc is a
+  // copy: it is copied to var_cc before the buffers are packed, and the ghost zones set
+  // in var_cc are copied back. Empty otherwise.
+  ParArrayND<Real, Kokkos::LayoutStride> var_strided;
+
   // maximum number of reserved unique "physics ID" component of MPI tag bitfield
   // (CellCenteredBoundaryVariable only actually uses 1x if multilevel==false)
   // must correspond to the # of "int *phys_id_" private members, below. Convert to array?
@@ -54,29 +66,79 @@ class CellCenteredBoundaryVariable : public BoundaryVariable {
   // BoundaryVariable:
   int ComputeVariableBufferSize(const NeighborIndexes &ni, int cng) override;
   int ComputeFluxCorrectionBufferSize(const NeighborIndexes &ni, int cng) override;
+  bool SameProcessDirectCopy() const override { return true; }
 
   // BoundaryCommunication:
   void SetupPersistentMPI() override;
+  void SetupAggregatedMPI(AggregatedBoundaryComm &agg) override;
   void StartReceiving(BoundaryCommSubset phase) override;
   void ClearBoundary(BoundaryCommSubset phase) override;
 
   // BoundaryBuffer:
+  void SendBoundaryBuffers() override;
+  void ReceiveAndSetBoundariesWithWait() override;
+  void SetBoundaries() override;
   void SendFluxCorrection() override;
   bool ReceiveFluxCorrection() override;
 
+  // With <time>/subcycling, SendFluxCorrection() integrates the fluxes through the faces
+  // shared with another level over the steps in the flux registers. At the
+  // synchronization of two levels, the finer block loads them into its fluxes for the
+  // flux correction, and the coarser one corrects its cells for the difference between
+  // the fluxes received and its own.
+  void LoadFluxRegisters();
+  void Reflux();
+
+  // fused alternatives to SendBoundaryBuffers() and SetBoundaries() that pack/unpack the
+  // buffers of all given variables for all neighbors of pmb in a single kernel
+  static void SendBoundaryBuffersFused(
+      MeshBlock *pmb,
+      const std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> &bvars);
+  static void SetBoundariesFused(
+      MeshBlock *pmb,
+      const std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> &bvars);
+
  protected:
   int nl_, nu_;
 
  private:
   // BoundaryBuffer:
-  int LoadBoundaryBufferSameLevel(Real *buf, const NeighborBlock &nb) override;
-  void SetBoundarySameLevel(Real *buf, const NeighborBlock &nb) override;
-
-  int LoadBoundaryBufferToCoarser(Real *buf, const NeighborBlock &nb) override;
-  int LoadBoundaryBufferToFiner(Real *buf, const NeighborBlock &nb) override;
-
-  void SetBoundaryFromCoarser(Real *buf, const NeighborBlock &nb) override;
-  void SetBoundaryFromFiner(Real *buf, const NeighborBlock &nb) override;
+  int LoadBoundaryBufferSameLevel(BufArray1D<Real> &buf,
+                                  const NeighborBlock &nb) override;
+  void SetBoundarySameLevel(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+
+  int LoadBoundaryBufferToCoarser(BufArray1D<Real> &buf,
+                                  const NeighborBlock &nb) override;
+  int LoadBoundaryBufferToFiner(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+
+  void SetBoundaryFromCoarser(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+  void SetBoundaryFromFiner(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+
+  void MessageSizes(const NeighborBlock &nb, int &ssize, int &rsize) const;
+  // see LoadFluxRegisters(); allocated on first use
+  void AccumulateFluxRegisters(const Real weight);
+  ParArrayND<Real> flux_register_[3];
+  // between var_strided and var_cc, see there; only the first is asynchronous
+  void CopyToContiguous();
+  void CopyGhostsFromContiguous();
+  // pack/unpack the index range of b at the precision of the messages; p counts values,
+  // BufferLength(p) gives the number of Reals of the buffer this occupies
+  void PackBuffer(ParArrayND<Real> &src, BufArray1D<Real> &buf, const BndInfo &b,
+                  int &p);
+  void UnpackBuffer(BufArray1D<Real> &buf, ParArrayND<Real> &dst, const BndInfo &b,
+                    int &p);
+  int BufferLength(const int p) const;
+
+  // index ranges of the buffers, shared by the per-variable and fused routines
+  void SendIndicesSameLevel(const NeighborBlock &nb, BndInfo &b) const;
+  void SendIndicesToCoarser(const NeighborBlock &nb, BndInfo &b) const;
+  void SendIndicesToFiner(const NeighborBlock &nb, BndInfo &b) const;
+  void RecvIndicesSameLevel(const NeighborBlock &nb, BndInfo &b) const;
+  void RecvIndicesFromCoarser(const NeighborBlock &nb, BndInfo &b) const;
+  void RecvIndicesFromFiner(const NeighborBlock &nb, BndInfo &b) const;
+  // ghost range and source of a same-level neighbor on this rank, which is copied
+  // directly instead of going through the buffers
+  void CopyIndicesSameProcess(const NeighborBlock &nb, BndCopyInfo &c) const;
 
 #ifdef MPI_PARALLEL
   int cc_phys_id_, cc_flx_phys_id_;
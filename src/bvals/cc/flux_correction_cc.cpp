@@ -17,132 +17,297 @@
 //! \file flux_correction_cc.cpp
 //  \brief functions that perform flux correction for CELL_CENTERED variables
 
-#include <algorithm>
-#include <cmath>
-#include <cstdlib>
-#include <cstring>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
-#include <stdexcept>
-#include <string>
+#include <memory>
 
 #include "parthenon_mpi.hpp"
 
 #include "athena.hpp"
 #include "bvals/cc/bvals_cc.hpp"
 #include "coordinates/coordinates.hpp"
+#include "coordinates/device_coordinates.hpp"
 #include "globals.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
-#include "parameter_input.hpp"
-#include "utils/buffer_utils.hpp"
 
 namespace parthenon {
 
+namespace {
+
+//----------------------------------------------------------------------------------------
+//! \struct FluxCorrectionFace
+//  \brief The faces shared by a fine block and its coarser face neighbor. The coarse
+//  faces are counted by (c2, c1) in the tangential directions d2 and d1; coarse face
+//  (c2, c1) is at coarse + c1 in d1 and + c2 in d2, and it is the restriction of the one,
+//  two or four fine faces starting at fine + 2 * c1 in d1 and + 2 * c2 in d2.
+
+struct FluxCorrectionFace {
+  // fine_face is the face of the fine block towards the coarse one, fi1 and fi2 locate
+  // the fine block in the tangential directions of the coarse face
+  FluxCorrectionFace(const MeshBlock *pmb, const BoundaryFace fine_face, const int fi1,
+                     const int fi2)
+      : dir(fine_face / 2), d1(dir == X1DIR ? X2DIR : X1DIR),
+        d2(dir == X3DIR ? X2DIR : X3DIR) {
+    const int s[3] = {pmb->is, pmb->js, pmb->ks};
+    const int e[3] = {pmb->ie, pmb->je, pmb->ke};
+    const int nx[3] = {pmb->block_size.nx1, pmb->block_size.nx2, pmb->block_size.nx3};
+    n1 = (nx[d1] > 1) ? nx[d1] / 2 : 1;
+    n2 = (nx[d2] > 1) ? nx[d2] / 2 : 1;
+    for (int d = 0; d < 3; d++) {
+      fine[d] = coarse[d] = s[d];
+    }
+    // an inner face of the fine block is an outer face of the coarse one
+    const bool inner = (fine_face % 2 == 0);
+    fine[dir] = inner ? s[dir] : e[dir] + 1;
+    coarse[dir] = inner ? e[dir] + 1 : s[dir];
+    if (nx[d1] > 1) coarse[d1] += fi1 * nx[d1] / 2;
+    if (nx[d2] > 1) coarse[d2] += fi2 * nx[d2] / 2;
+  }
+
+  // position of coarse face (n, c2, c1) in a buffer
+  KOKKOS_INLINE_FUNCTION int BufferIndex(const int n, const int c2, const int c1) const {
+    return c1 + n1 * (c2 + n2 * n);
+  }
+
+  int dir, d1, d2;
+  int n1, n2;
+  int fine[3], coarse[3]; // (i, j, k) of the first fine and coarse face
+};
+
+KOKKOS_INLINE_FUNCTION Real FaceArea(const DeviceCoordinates &coords, const int dir,
+                                     const int k, const int j, const int i) {
+  return (dir == X1DIR) ? coords.Area1(k, j, i)
+                        : (dir == X2DIR) ? coords.Area2(k, j, i) : coords.Area3(k, j, i);
+}
+
+// the area-weighted average of the fine fluxes making up coarse face (c2, c1)
+KOKKOS_INLINE_FUNCTION Real RestrictFlux(const FluxCorrectionFace &f,
+                                         const ParArray4D<Real> &flux,
+                                         const DeviceCoordinates &coords, const int n,
+                                         const int c2, const int c1) {
+  Real fsum = 0.0, asum = 0.0;
+  for (int o2 = 0; o2 < (f.n2 > 1 ? 2 : 1); o2++) {
+    for (int o1 = 0; o1 < (f.n1 > 1 ? 2 : 1); o1++) {
+      int x[3] = {f.fine[0], f.fine[1], f.fine[2]};
+      x[f.d1] += 2 * c1 + o1;
+      x[f.d2] += 2 * c2 + o2;
+      const Real a = FaceArea(coords, f.dir, x[2], x[1], x[0]);
+      fsum += a * flux(n, x[2], x[1], x[0]);
+      asum += a;
+    }
+  }
+  return fsum / asum;
+}
+
+ParArray4D<Real> GetFlux(CellCenteredBoundaryVariable *bvar, const int dir) {
+  return ((dir == X1DIR) ? bvar->x1flux : (dir == X2DIR) ? bvar->x2flux : bvar->x3flux)
+      .Get<4>();
+}
+
+// restrict the fluxes of components nl..nu of the fine block into the send buffer
+void RestrictToBuffer(DevSpace exec_space, const FluxCorrectionFace &f,
+                      const ParArray4D<Real> &flux, const DeviceCoordinates &coords,
+                      const int nl, const int nu, const BufArray1D<Real> &buf) {
+  par_for(
+      "SendFluxCorrection", exec_space, nl, nu, 0, f.n2 - 1, 0, f.n1 - 1,
+      KOKKOS_LAMBDA(const int n, const int c2, const int c1) {
+        buf(f.BufferIndex(n - nl, c2, c1)) = RestrictFlux(f, flux, coords, n, c2, c1);
+      });
+}
+
+// set the coarse fluxes of components nl..nu from a received buffer
+void SetFromBuffer(DevSpace exec_space, const FluxCorrectionFace &f,
+                   const ParArray4D<Real> &flux, const int nl, const int nu,
+                   const BufArray1D<Real> &buf) {
+  par_for(
+      "ReceiveFluxCorrection", exec_space, nl, nu, 0, f.n2 - 1, 0, f.n1 - 1,
+      KOKKOS_LAMBDA(const int n, const int c2, const int c1) {
+        int x[3] = {f.coarse[0], f.coarse[1], f.coarse[2]};
+        x[f.d1] += c1;
+        x[f.d2] += c2;
+        flux(n, x[2], x[1], x[0]) = buf(f.BufferIndex(n - nl, c2, c1));
+      });
+}
+
+// set the coarse fluxes of components nl..nu straight from the fluxes of a fine block
+// on the same rank, without any buffer in between
+void SetFromFine(DevSpace exec_space, const FluxCorrectionFace &f,
+                 const ParArray4D<Real> &flux, const ParArray4D<Real> &fine_flux,
+                 const DeviceCoordinates &fine_coords, const int nl, const int nu) {
+  par_for(
+      "ReceiveFluxCorrectionSameProcess", exec_space, nl, nu, 0, f.n2 - 1, 0, f.n1 - 1,
+      KOKKOS_LAMBDA(const int n, const int c2, const int c1) {
+        int x[3] = {f.coarse[0], f.coarse[1], f.coarse[2]};
+        x[f.d1] += c1;
+        x[f.d2] += c2;
+        flux(n, x[2], x[1], x[0]) = RestrictFlux(f, fine_flux, fine_coords, n, c2, c1);
+      });
+}
+
+// level of the face neighbor across face of the block, -1 at a physical boundary
+int FaceNeighborLevel(const MeshBlock *pmb, const int face) {
+  int o[3] = {1, 1, 1};
+  o[face / 2] += (face % 2 == 0) ? -1 : 1;
+  return pmb->pbval->nblevel[o[2]][o[1]][o[0]];
+}
+
+//----------------------------------------------------------------------------------------
+//! \struct RegisterFace
+//  \brief The faces of one side of the block in a flux register. The register of
+//  direction dir has the shape of the fluxes with the extent 2 in dir, the inner (side 0)
+//  and the outer (side 1) faces of the block.
+
+struct RegisterFace {
+  RegisterFace(const MeshBlock *pmb, const int face) : dir(face / 2), side(face % 2) {
+    const int s[3] = {pmb->is, pmb->js, pmb->ks};
+    const int e[3] = {pmb->ie, pmb->je, pmb->ke};
+    for (int d = 0; d < 3; d++) {
+      lo[d] = s[d], hi[d] = e[d];
+    }
+    lo[dir] = hi[dir] = (side == 0) ? s[dir] : e[dir] + 1;
+    cell = (side == 0) ? s[dir] : e[dir];
+  }
+
+  // the value of the register for the face (k, j, i) of the fluxes
+  KOKKOS_INLINE_FUNCTION Real &operator()(const ParArray4D<Real> &reg, const int n,
+                                          const int k, const int j, const int i) const {
+    int x[3] = {i, j, k};
+    x[dir] = side;
+    return reg(n, x[2], x[1], x[0]);
+  }
+
+  int dir, side;
+  int lo[3], hi[3]; // index range (i, j, k) of the faces in the fluxes
+  int cell;         // index in dir of the cells of the block next to the faces
+};
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::AccumulateFluxRegisters(const Real weight)
+//  \brief add weight times the fluxes through the faces of the block that are shared
+//  with a block on another level to the flux registers
+
+void CellCenteredBoundaryVariable::AccumulateFluxRegisters(const Real weight) {
+  MeshBlock *pmb = pmy_block_;
+  const int nl = nl_, nu = nu_;
+  for (int face = 0; face < 2 * pmy_mesh_->ndim; face++) {
+    const int level = FaceNeighborLevel(pmb, face);
+    if (level < 0 || level == pmb->loc.level) continue;
+    const RegisterFace f(pmb, face);
+    ParArrayND<Real> &reg = flux_register_[f.dir];
+    ParArray4D<Real> flux = GetFlux(this, f.dir);
+    if (reg.GetSize() == 0) {
+      int n[3] = {flux.extent_int(3), flux.extent_int(2), flux.extent_int(1)};
+      n[f.dir] = 2;
+      reg = ParArrayND<Real>("flux register", flux.extent_int(0), n[2], n[1], n[0]);
+    }
+    ParArray4D<Real> r = reg.Get<4>();
+    pmb->par_for(
+        "AccumulateFluxRegisters", nl, nu, f.lo[2], f.hi[2], f.lo[1], f.hi[1], f.lo[0],
+        f.hi[0], KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          f(r, n, k, j, i) += weight * flux(n, k, j, i);
+        });
+  }
+  // the fluxes are overwritten by the next stage
+  pmb->exec_space.fence();
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::LoadFluxRegisters()
+//  \brief on the faces shared with a coarser block, replace the fluxes by the ones
+//  integrated over the step, for SendFluxCorrection(), and clear the registers
+
+void CellCenteredBoundaryVariable::LoadFluxRegisters() {
+  MeshBlock *pmb = pmy_block_;
+  for (int face = 0; face < 2 * pmy_mesh_->ndim; face++) {
+    const int level = FaceNeighborLevel(pmb, face);
+    if (level < 0 || level >= pmb->loc.level) continue;
+    const RegisterFace f(pmb, face);
+    if (flux_register_[f.dir].GetSize() == 0) continue; // nothing accumulated
+    ParArray4D<Real> r = flux_register_[f.dir].Get<4>();
+    ParArray4D<Real> flux = GetFlux(this, f.dir);
+    pmb->par_for(
+        "LoadFluxRegisters", nl_, nu_, f.lo[2], f.hi[2], f.lo[1], f.hi[1], f.lo[0],
+        f.hi[0], KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          flux(n, k, j, i) = f(r, n, k, j, i);
+          f(r, n, k, j, i) = 0.0;
+        });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::Reflux()
+//  \brief on the faces shared with finer blocks, correct the cells next to them for the
+//  difference between the fluxes the finer blocks integrated over the step, which
+//  ReceiveFluxCorrection() has set, and the ones the registers integrated for this
+//  block, and clear the registers
+
+void CellCenteredBoundaryVariable::Reflux() {
+  MeshBlock *pmb = pmy_block_;
+  const DeviceCoordinates coords = pmb->pcoord->GetDeviceCoordinates();
+  ParArray4D<Real> u = var_cc.Get<4>();
+  for (int face = 0; face < 2 * pmy_mesh_->ndim; face++) {
+    const int level = FaceNeighborLevel(pmb, face);
+    if (level <= pmb->loc.level) continue;
+    const RegisterFace f(pmb, face);
+    if (flux_register_[f.dir].GetSize() == 0) continue;
+    ParArray4D<Real> r = flux_register_[f.dir].Get<4>();
+    ParArray4D<Real> flux = GetFlux(this, f.dir);
+    // the flux through an inner face enters the cell, through an outer one it leaves
+    const Real sign = (f.side == 0) ? 1.0 : -1.0;
+    pmb->par_for(
+        "Reflux", nl_, nu_, f.lo[2], f.hi[2], f.lo[1], f.hi[1], f.lo[0], f.hi[0],
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          int x[3] = {i, j, k};
+          x[f.dir] = f.cell;
+          const Real da = FaceArea(coords, f.dir, k, j, i) /
+                          coords.Volume(x[2], x[1], x[0]) *
+                          (flux(n, k, j, i) - f(r, n, k, j, i));
+          u(n, x[2], x[1], x[0]) += sign * da;
+          f(r, n, k, j, i) = 0.0;
+        });
+  }
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void CellCenteredBoundaryVariable::SendFluxCorrection()
-//  \brief Restrict, pack and send the surface flux to the coarse neighbor(s)
+//  \brief Restrict, pack and send the surface flux to the coarse neighbor(s). Coarse
+//  neighbors on the same rank restrict our fluxes themselves and are only signaled.
 
 void CellCenteredBoundaryVariable::SendFluxCorrection() {
   MeshBlock *pmb = pmy_block_;
-  auto &pco = pmb->pcoord;
+  const DeviceCoordinates &coords = pmb->pcoord->GetDeviceCoordinates();
+  // subcycled levels integrate the fluxes through the level boundaries over their
+  // steps and only correct them when the levels are synchronized
+  if (pmb->pbval->flux_register_weight != 0.0)
+    AccumulateFluxRegisters(pmb->pbval->flux_register_weight);
+  if (!pmb->pbval->send_levels.coarser) return;
 
-  // cache pointers to surface area arrays (BoundaryBase protected variable)
-  ParArrayND<Real> &sarea0 = pmb->pbval->sarea_[0];
-  ParArrayND<Real> &sarea1 = pmb->pbval->sarea_[1];
+  bool pending = false;
+  for (int n = 0; n < pmb->pbval->nneighbor; n++) {
+    NeighborBlock &nb = pmb->pbval->neighbor[n];
+    if (nb.ni.type != NeighborConnect::face) break;
+    if (bd_var_flcor_.sflag[nb.bufid] == BoundaryStatus::completed) continue;
+    if (nb.snb.level == pmb->loc.level - 1) {
+      pending = true;
+      if (nb.snb.rank == Globals::my_rank) continue;
+      const FluxCorrectionFace f(pmb, nb.fid, 0, 0);
+      RestrictToBuffer(pmb->exec_space, f, GetFlux(this, f.dir), coords, nl_, nu_,
+                       bd_var_flcor_.send[nb.bufid]);
+    }
+  }
+  if (!pending) return;
+  // the buffers must be complete before they are handed to MPI, and the fluxes before
+  // coarse neighbors on this rank read them
+  pmb->exec_space.fence();
 
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
     if (nb.ni.type != NeighborConnect::face) break;
     if (bd_var_flcor_.sflag[nb.bufid] == BoundaryStatus::completed) continue;
     if (nb.snb.level == pmb->loc.level - 1) {
-      int p = 0;
-      Real *sbuf = bd_var_flcor_.send[nb.bufid];
-      // x1 direction
-      if (nb.fid == BoundaryFace::inner_x1 || nb.fid == BoundaryFace::outer_x1) {
-        int i = pmb->is + (pmb->ie - pmb->is + 1) * nb.fid;
-        if (pmb->block_size.nx3 > 1) { // 3D
-          for (int nn = nl_; nn <= nu_; nn++) {
-            for (int k = pmb->ks; k <= pmb->ke; k += 2) {
-              for (int j = pmb->js; j <= pmb->je; j += 2) {
-                Real amm = pco->GetFace1Area(k, j, i);
-                Real amp = pco->GetFace1Area(k, j + 1, i);
-                Real apm = pco->GetFace1Area(k + 1, j, i);
-                Real app = pco->GetFace1Area(k + 1, j + 1, i);
-                Real tarea = amm + amp + apm + app;
-                sbuf[p++] =
-                    (x1flux(nn, k, j, i) * amm + x1flux(nn, k, j + 1, i) * amp +
-                     x1flux(nn, k + 1, j, i) * apm + x1flux(nn, k + 1, j + 1, i) * app) /
-                    tarea;
-              }
-            }
-          }
-        } else if (pmb->block_size.nx2 > 1) { // 2D
-          int k = pmb->ks;
-          for (int nn = nl_; nn <= nu_; nn++) {
-            for (int j = pmb->js; j <= pmb->je; j += 2) {
-              Real am = pco->GetFace1Area(k, j, i);
-              Real ap = pco->GetFace1Area(k, j + 1, i);
-              Real tarea = am + ap;
-              sbuf[p++] =
-                  (x1flux(nn, k, j, i) * am + x1flux(nn, k, j + 1, i) * ap) / tarea;
-            }
-          }
-        } else { // 1D
-          int k = pmb->ks, j = pmb->js;
-          for (int nn = nl_; nn <= nu_; nn++)
-            sbuf[p++] = x1flux(nn, k, j, i);
-        }
-        // x2 direction
-      } else if (nb.fid == BoundaryFace::inner_x2 || nb.fid == BoundaryFace::outer_x2) {
-        int j = pmb->js + (pmb->je - pmb->js + 1) * (nb.fid & 1);
-        if (pmb->block_size.nx3 > 1) { // 3D
-          for (int nn = nl_; nn <= nu_; nn++) {
-            for (int k = pmb->ks; k <= pmb->ke; k += 2) {
-              pco->Face2Area(k, j, pmb->is, pmb->ie, sarea0);
-              pco->Face2Area(k + 1, j, pmb->is, pmb->ie, sarea1);
-              for (int i = pmb->is; i <= pmb->ie; i += 2) {
-                Real tarea = sarea0(i) + sarea0(i + 1) + sarea1(i) + sarea1(i + 1);
-                sbuf[p++] = (x2flux(nn, k, j, i) * sarea0(i) +
-                             x2flux(nn, k, j, i + 1) * sarea0(i + 1) +
-                             x2flux(nn, k + 1, j, i) * sarea1(i) +
-                             x2flux(nn, k + 1, j, i + 1) * sarea1(i + 1)) /
-                            tarea;
-              }
-            }
-          }
-        } else if (pmb->block_size.nx2 > 1) { // 2D
-          int k = pmb->ks;
-          for (int nn = nl_; nn <= nu_; nn++) {
-            pco->Face2Area(0, j, pmb->is, pmb->ie, sarea0);
-            for (int i = pmb->is; i <= pmb->ie; i += 2) {
-              Real tarea = sarea0(i) + sarea0(i + 1);
-              sbuf[p++] = (x2flux(nn, k, j, i) * sarea0(i) +
-                           x2flux(nn, k, j, i + 1) * sarea0(i + 1)) /
-                          tarea;
-            }
-          }
-        }
-        // x3 direction - 3D onl_y
-      } else if (nb.fid == BoundaryFace::inner_x3 || nb.fid == BoundaryFace::outer_x3) {
-        int k = pmb->ks + (pmb->ke - pmb->ks + 1) * (nb.fid & 1);
-        for (int nn = nl_; nn <= nu_; nn++) {
-          for (int j = pmb->js; j <= pmb->je; j += 2) {
-            pco->Face3Area(k, j, pmb->is, pmb->ie, sarea0);
-            pco->Face3Area(k, j + 1, pmb->is, pmb->ie, sarea1);
-            for (int i = pmb->is; i <= pmb->ie; i += 2) {
-              Real tarea = sarea0(i) + sarea0(i + 1) + sarea1(i) + sarea1(i + 1);
-              sbuf[p++] = (x3flux(nn, k, j, i) * sarea0(i) +
-                           x3flux(nn, k, j, i + 1) * sarea0(i + 1) +
-                           x3flux(nn, k, j + 1, i) * sarea1(i) +
-                           x3flux(nn, k, j + 1, i + 1) * sarea1(i + 1)) /
-                          tarea;
-            }
-          }
-        }
-      }
       if (nb.snb.rank == Globals::my_rank) { // on the same node
-        CopyFluxCorrectionBufferSameProcess(nb, p);
+        SignalFluxCorrectionSameProcess(nb);
       }
 #ifdef MPI_PARALLEL
       else
@@ -160,7 +325,12 @@ void CellCenteredBoundaryVariable::SendFluxCorrection() {
 
 bool CellCenteredBoundaryVariable::ReceiveFluxCorrection() {
   MeshBlock *pmb = pmy_block_;
+  if (!pmb->pbval->recv_levels.finer) return true;
   bool bflag = true;
+  bool applied = false;
+#ifdef MPI_PARALLEL
+  bool polled = false;
+#endif
 
   for (int n = 0; n < pmb->pbval->nneighbor; n++) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
@@ -174,76 +344,37 @@ bool CellCenteredBoundaryVariable::ReceiveFluxCorrection() {
         }
 #ifdef MPI_PARALLEL
         else { // NOLINT
-          int test;
-          MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &test,
-                     MPI_STATUS_IGNORE);
-          MPI_Test(&(bd_var_flcor_.req_recv[nb.bufid]), &test, MPI_STATUS_IGNORE);
-          if (!static_cast<bool>(test)) {
+          // marked as arrived by the rank-level receive tracker
+          if (!polled) {
+            pmy_mesh_->recv_tracker.Poll();
+            polled = true;
+          }
+          if (bd_var_flcor_.flag[nb.bufid] != BoundaryStatus::arrived) {
             bflag = false;
             continue;
           }
-          bd_var_flcor_.flag[nb.bufid] = BoundaryStatus::arrived;
         }
 #endif
       }
       // boundary arrived; apply flux correction
-      int p = 0;
-      Real *rbuf = bd_var_flcor_.recv[nb.bufid];
-      if (nb.fid == BoundaryFace::inner_x1 || nb.fid == BoundaryFace::outer_x1) {
-        int il = pmb->is + (pmb->ie - pmb->is) * nb.fid + nb.fid;
-        int jl = pmb->js, ju = pmb->je, kl = pmb->ks, ku = pmb->ke;
-        if (nb.ni.fi1 == 0)
-          ju -= pmb->block_size.nx2 / 2;
-        else
-          jl += pmb->block_size.nx2 / 2;
-        if (nb.ni.fi2 == 0)
-          ku -= pmb->block_size.nx3 / 2;
-        else
-          kl += pmb->block_size.nx3 / 2;
-        for (int nn = nl_; nn <= nu_; nn++) {
-          for (int k = kl; k <= ku; k++) {
-            for (int j = jl; j <= ju; j++)
-              x1flux(nn, k, j, il) = rbuf[p++];
-          }
-        }
-      } else if (nb.fid == BoundaryFace::inner_x2 || nb.fid == BoundaryFace::outer_x2) {
-        int jl = pmb->js + (pmb->je - pmb->js) * (nb.fid & 1) + (nb.fid & 1);
-        int il = pmb->is, iu = pmb->ie, kl = pmb->ks, ku = pmb->ke;
-        if (nb.ni.fi1 == 0)
-          iu -= pmb->block_size.nx1 / 2;
-        else
-          il += pmb->block_size.nx1 / 2;
-        if (nb.ni.fi2 == 0)
-          ku -= pmb->block_size.nx3 / 2;
-        else
-          kl += pmb->block_size.nx3 / 2;
-        for (int nn = nl_; nn <= nu_; nn++) {
-          for (int k = kl; k <= ku; k++) {
-            for (int i = il; i <= iu; i++)
-              x2flux(nn, k, jl, i) = rbuf[p++];
-          }
-        }
-      } else if (nb.fid == BoundaryFace::inner_x3 || nb.fid == BoundaryFace::outer_x3) {
-        int kl = pmb->ks + (pmb->ke - pmb->ks) * (nb.fid & 1) + (nb.fid & 1);
-        int il = pmb->is, iu = pmb->ie, jl = pmb->js, ju = pmb->je;
-        if (nb.ni.fi1 == 0)
-          iu -= pmb->block_size.nx1 / 2;
-        else
-          il += pmb->block_size.nx1 / 2;
-        if (nb.ni.fi2 == 0)
-          ju -= pmb->block_size.nx2 / 2;
-        else
-          jl += pmb->block_size.nx2 / 2;
-        for (int nn = nl_; nn <= nu_; nn++) {
-          for (int j = jl; j <= ju; j++) {
-            for (int i = il; i <= iu; i++)
-              x3flux(nn, kl, j, i) = rbuf[p++];
-          }
-        }
+      const FluxCorrectionFace f(pmb, static_cast<BoundaryFace>(nb.fid ^ 1), nb.ni.fi1,
+                                 nb.ni.fi2);
+      if (nb.snb.rank == Globals::my_rank) {
+        MeshBlock *pfine = pmy_mesh_->FindMeshBlock(nb.snb.gid);
+        auto *pfine_var = static_cast<CellCenteredBoundaryVariable *>(
+            pfine->pbval->bvars[bvar_index].get());
+        SetFromFine(pmb->exec_space, f, GetFlux(this, f.dir), GetFlux(pfine_var, f.dir),
+                    pfine->pcoord->GetDeviceCoordinates(), nl_, nu_);
+      } else {
+        SetFromBuffer(pmb->exec_space, f, GetFlux(this, f.dir), nl_, nu_,
+                      bd_var_flcor_.recv[nb.bufid]);
       }
+      applied = true;
       bd_var_flcor_.flag[nb.bufid] = BoundaryStatus::completed;
     }
   }
+  // the receive buffers may be reused once the fluxes are set
+  if (applied) pmb->exec_space.fence();
   return bflag;
 }
 
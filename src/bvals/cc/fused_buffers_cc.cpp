@@ -0,0 +1,267 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file fused_buffers_cc.cpp
+//  \brief pack/unpack the boundary buffers of all CELL_CENTERED variables of a MeshBlock
+//         with one kernel each instead of one per (variable, neighbor) pair
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "athena.hpp"
+#include "bvals/bvals_aggregate.hpp"
+#include "bvals/cc/bvals_cc.hpp"
+#include "globals.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+
+namespace parthenon {
+
+// one team per table entry, the cells of each entry are split over the team threads
+template <bool pack>
+void PackUnpackBuffers(const std::string &name, DevSpace exec_space,
+                       const BufferCache_t &cache, const int nbuf) {
+  Kokkos::parallel_for(
+      name, team_policy(exec_space, nbuf, Kokkos::AUTO),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const BndInfo &b = cache(team_member.league_rank());
+        const int ni = b.ei + 1 - b.si;
+        const int nj = b.ej + 1 - b.sj;
+        const int nk = b.ek + 1 - b.sk;
+        const int nn = b.nu + 1 - b.nl;
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange<>(team_member, nn * nk * nj), [&](const int idx) {
+              const int n = idx / (nk * nj);
+              const int k = (idx - n * nk * nj) / nj;
+              const int j = idx - n * nk * nj - k * nj;
+              const int p0 = ni * (j + nj * (k + nk * n));
+              float *fbuf = reinterpret_cast<float *>(b.buf.data());
+              Kokkos::parallel_for(
+                  Kokkos::ThreadVectorRange<>(team_member, ni), [&](const int i) {
+                    Real &v = b.var(n + b.nl, k + b.sk, j + b.sj, i + b.si);
+                    if (pack && b.single)
+                      fbuf[p0 + i] = static_cast<float>(v);
+                    else if (pack)
+                      b.buf(p0 + i) = v;
+                    else if (b.single)
+                      v = static_cast<Real>(fbuf[p0 + i]);
+                    else
+                      v = b.buf(p0 + i);
+                  });
+            });
+      });
+}
+
+// one team per table entry, e.g. fills the ghost zones of the entry from the neighbor's
+// interior without any buffer in between
+void CopyRegions(const std::string &name, DevSpace exec_space, const CopyCache_t &cache,
+                 const int ncopy) {
+  Kokkos::parallel_for(
+      name, team_policy(exec_space, ncopy, Kokkos::AUTO),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const BndCopyInfo &c = cache(team_member.league_rank());
+        const int nj = c.ej + 1 - c.sj;
+        const int nk = c.ek + 1 - c.sk;
+        const int nn = c.nu + 1 - c.nl;
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange<>(team_member, nn * nk * nj), [&](const int idx) {
+              const int n = idx / (nk * nj) + c.nl;
+              const int k = (idx / nj) % nk + c.sk;
+              const int j = idx % nj + c.sj;
+              Kokkos::parallel_for(
+                  Kokkos::ThreadVectorRange<>(team_member, c.si, c.ei + 1),
+                  [&](const int i) {
+                    c.dst(n, k, j, i) = c.src(n, k + c.dk, j + c.dj, i + c.di);
+                  });
+            });
+      });
+}
+
+template void PackUnpackBuffers<true>(const std::string &, DevSpace,
+                                       const BufferCache_t &, const int);
+template void PackUnpackBuffers<false>(const std::string &, DevSpace,
+                                       const BufferCache_t &, const int);
+
+namespace {
+
+// make sure the device table and its host mirror hold at least n entries
+void ReserveBufferCache(BufferCache_t &cache, BufferCache_t::HostMirror &cache_h,
+                        const int n, const char *label) {
+  if (cache.extent_int(0) < n) {
+    cache = BufferCache_t(label, n);
+    cache_h = Kokkos::create_mirror_view(cache);
+  }
+}
+
+// same-level neighbors on this rank exchange ghost zones by a direct copy
+bool DirectCopy(const NeighborBlock &nb, const int mylevel) {
+  return nb.snb.rank == Globals::my_rank && nb.snb.level == mylevel;
+}
+
+int BufferSize(const BndInfo &b) {
+  return (b.nu + 1 - b.nl) * (b.ek + 1 - b.sk) * (b.ej + 1 - b.sj) * (b.ei + 1 - b.si);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SendBoundaryBuffersFused(MeshBlock *pmb,
+//          const std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> &bvars)
+//  \brief Restrict (where needed), pack and send the boundary buffers of all bvars
+
+void CellCenteredBoundaryVariable::SendBoundaryBuffersFused(
+    MeshBlock *pmb,
+    const std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> &bvars) {
+  BoundaryValues *pbval = pmb->pbval.get();
+  const int mylevel = pmb->loc.level;
+  const int nmax = bvars.size() * pbval->nneighbor;
+  ReserveBufferCache(pbval->send_cache_, pbval->send_cache_h_, nmax, "send_cache");
+
+  // gather the table; restriction to the coarse buffer has to precede the packing, and
+  // so has the copy of the variables stored component innermost
+  int nbuf = 0;
+  for (auto &bvar : bvars) {
+    bvar->CopyToContiguous();
+    for (int n = 0; n < pbval->nneighbor; n++) {
+      NeighborBlock &nb = pbval->neighbor[n];
+      if (bvar->bd_var_.sflag[nb.bufid] == BoundaryStatus::completed) continue;
+      if (!pbval->send_levels.Includes(nb, mylevel)) {
+        // the prolongation of our own ghost zones reads this restriction of the
+        // interior, also while a subcycled step sends nothing to the coarser neighbor
+        if (nb.snb.level < mylevel) {
+          BndInfo b;
+          bvar->SendIndicesToCoarser(nb, b);
+          pmb->pmr->RestrictCellCenteredValues(bvar->var_cc, bvar->coarse_buf, bvar->nl_,
+                                               bvar->nu_, b.si, b.ei, b.sj, b.ej, b.sk,
+                                               b.ek);
+        }
+        continue;
+      }
+      if (DirectCopy(nb, mylevel)) continue;
+      BndInfo &b = pbval->send_cache_h_(nbuf++);
+      b.nl = bvar->nl_, b.nu = bvar->nu_;
+      b.single = bvar->single_precision_comm;
+      b.buf = bvar->bd_var_.send[nb.bufid];
+      if (nb.snb.level == mylevel) {
+        bvar->SendIndicesSameLevel(nb, b);
+        b.var = bvar->var_cc.Get<4>();
+      } else if (nb.snb.level < mylevel) {
+        bvar->SendIndicesToCoarser(nb, b);
+        pmb->pmr->RestrictCellCenteredValues(bvar->var_cc, bvar->coarse_buf, b.nl, b.nu,
+                                             b.si, b.ei, b.sj, b.ej, b.sk, b.ek);
+        b.var = bvar->coarse_buf.Get<4>();
+      } else {
+        bvar->SendIndicesToFiner(nb, b);
+        b.var = bvar->var_cc.Get<4>();
+      }
+    }
+  }
+  if (nbuf > 0) {
+    Kokkos::deep_copy(pmb->exec_space, pbval->send_cache_, pbval->send_cache_h_);
+    PackUnpackBuffers<true>("SendBoundaryBuffersFused", pmb->exec_space,
+                            pbval->send_cache_, nbuf);
+  }
+  // the buffers must be complete before they are copied or handed to MPI, and the
+  // interior before neighbors on this rank read from it
+  pmb->exec_space.fence();
+
+  int ibuf = 0;
+  for (auto &bvar : bvars) {
+    for (int n = 0; n < pbval->nneighbor; n++) {
+      NeighborBlock &nb = pbval->neighbor[n];
+      if (bvar->bd_var_.sflag[nb.bufid] == BoundaryStatus::completed) continue;
+      if (!pbval->send_levels.Includes(nb, mylevel)) continue;
+      if (DirectCopy(nb, mylevel)) {
+        bvar->SignalVariableSameProcess(nb);
+        bvar->bd_var_.sflag[nb.bufid] = BoundaryStatus::completed;
+        continue;
+      }
+      const int ssize = bvar->BufferLength(BufferSize(pbval->send_cache_h_(ibuf++)));
+      if (nb.snb.rank == Globals::my_rank) {
+        bvar->CopyVariableBufferSameProcess(nb, ssize);
+      } else {
+#ifdef MPI_PARALLEL
+        if (bvar->aggregated_comm_)
+          pmb->pmy_mesh->paggcomm->BufferPacked(bvar.get(), nb.bufid);
+        else
+          MPI_Start(&(bvar->bd_var_.req_send[nb.bufid]));
+#endif
+      }
+      bvar->bd_var_.sflag[nb.bufid] = BoundaryStatus::completed;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void CellCenteredBoundaryVariable::SetBoundariesFused(MeshBlock *pmb,
+//          const std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> &bvars)
+//  \brief Unpack the received boundary buffers of all bvars
+
+void CellCenteredBoundaryVariable::SetBoundariesFused(
+    MeshBlock *pmb,
+    const std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> &bvars) {
+  BoundaryValues *pbval = pmb->pbval.get();
+  const int mylevel = pmb->loc.level;
+  const int nmax = bvars.size() * pbval->nneighbor;
+  ReserveBufferCache(pbval->recv_cache_, pbval->recv_cache_h_, nmax, "recv_cache");
+  if (pbval->copy_cache_.extent_int(0) < nmax) {
+    pbval->copy_cache_ = CopyCache_t("copy_cache", nmax);
+    pbval->copy_cache_h_ = Kokkos::create_mirror_view(pbval->copy_cache_);
+  }
+
+  int nbuf = 0, ncopy = 0;
+  for (auto &bvar : bvars) {
+    for (int n = 0; n < pbval->nneighbor; n++) {
+      NeighborBlock &nb = pbval->neighbor[n];
+      if (!pbval->recv_levels.Includes(nb, mylevel)) continue;
+      bvar->bd_var_.flag[nb.bufid] = BoundaryStatus::completed;
+      if (DirectCopy(nb, mylevel)) {
+        bvar->CopyIndicesSameProcess(nb, pbval->copy_cache_h_(ncopy++));
+        continue;
+      }
+      BndInfo &b = pbval->recv_cache_h_(nbuf++);
+      b.nl = bvar->nl_, b.nu = bvar->nu_;
+      b.single = bvar->single_precision_comm;
+      b.buf = bvar->bd_var_.recv[nb.bufid];
+      if (nb.snb.level == mylevel) {
+        bvar->RecvIndicesSameLevel(nb, b);
+        b.var = bvar->var_cc.Get<4>();
+      } else if (nb.snb.level < mylevel) { // only sets the prolongation buffer
+        bvar->RecvIndicesFromCoarser(nb, b);
+        b.var = bvar->coarse_buf.Get<4>();
+      } else {
+        bvar->RecvIndicesFromFiner(nb, b);
+        b.var = bvar->var_cc.Get<4>();
+      }
+    }
+  }
+  if (nbuf + ncopy == 0) return;
+  if (nbuf > 0) {
+    Kokkos::deep_copy(pmb->exec_space, pbval->recv_cache_, pbval->recv_cache_h_);
+    PackUnpackBuffers<false>("SetBoundariesFused", pmb->exec_space, pbval->recv_cache_,
+                             nbuf);
+  }
+  if (ncopy > 0) {
+    Kokkos::deep_copy(pmb->exec_space, pbval->copy_cache_, pbval->copy_cache_h_);
+    CopyRegions("SetBoundariesSameProcess", pmb->exec_space, pbval->copy_cache_, ncopy);
+  }
+  for (auto &bvar : bvars) {
+    bvar->CopyGhostsFromContiguous();
+  }
+  // physical boundaries and prolongation that follow operate on the ghost zones
+  pmb->exec_space.fence();
+}
+
+} // namespace parthenon
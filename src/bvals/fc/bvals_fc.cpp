@@ -33,12 +33,69 @@
 
 #include "basic_types.hpp"
 #include "globals.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "parameter_input.hpp"
-#include "utils/buffer_utils.hpp"
 
 namespace parthenon {
 
+namespace {
+
+// The index ranges of the three components of a face-centered boundary buffer, in the
+// order x1f, x2f, x3f, which are packed or unpacked with a single kernel per neighbor.
+struct FaceBufferRanges {
+  ParArrayND<Real> var[3];
+  int si[3], ei[3], sj[3], ej[3], sk[3], ek[3];
+  // with dj (dk) = 1 every value is also written to (k, j + 1, i) ((k + 1, j, i)), which
+  // fills the second face of the collapsed x2 (x3) direction in 1D (1D and 2D)
+  int dj[3], dk[3];
+  // start of each component in the buffer, offset[3] is the size of the buffer
+  int offset[4];
+  int n = 0;
+
+  FaceBufferRanges() { offset[0] = 0; }
+
+  void Add(const ParArrayND<Real> &v, const int is, const int ie, const int js,
+           const int je, const int ks, const int ke, const int djj = 0,
+           const int dkk = 0) {
+    var[n] = v;
+    si[n] = is, ei[n] = ie, sj[n] = js, ej[n] = je, sk[n] = ks, ek[n] = ke;
+    dj[n] = djj, dk[n] = dkk;
+    const int size =
+        std::max(ie + 1 - is, 0) * std::max(je + 1 - js, 0) * std::max(ke + 1 - ks, 0);
+    offset[n + 1] = offset[n] + size;
+    n++;
+  }
+};
+
+// copy all cells of the three ranges between the arrays and the buffer and return the
+// number of values transferred
+template <bool pack>
+int PackUnpackFaceBuffer(const std::string &name, DevSpace exec_space,
+                         const FaceBufferRanges &r, BufArray1D<Real> &buf) {
+  const int size = r.offset[3];
+  if (size == 0) return 0;
+  par_for(
+      name, exec_space, 0, size - 1, KOKKOS_LAMBDA(const int p) {
+        const int c = (p < r.offset[1]) ? 0 : ((p < r.offset[2]) ? 1 : 2);
+        const int ni = r.ei[c] + 1 - r.si[c];
+        const int nj = r.ej[c] + 1 - r.sj[c];
+        const int m = (p - r.offset[c]) / ni;
+        const int i = r.si[c] + (p - r.offset[c]) - m * ni;
+        const int j = r.sj[c] + m % nj;
+        const int k = r.sk[c] + m / nj;
+        const Real value = pack ? r.var[c](k, j, i) : buf(p);
+        if (pack)
+          buf(p) = value;
+        else
+          r.var[c](k, j, i) = value;
+        if (r.dj[c] != 0 || r.dk[c] != 0) r.var[c](k + r.dk[c], j + r.dj[c], i) = value;
+      });
+  return size;
+}
+
+} // namespace
+
 FaceCenteredBoundaryVariable::FaceCenteredBoundaryVariable(MeshBlock *pmb, FaceField *var,
                                                            FaceField &coarse_buf,
                                                            EdgeField &var_flux)
@@ -157,15 +214,15 @@ int FaceCenteredBoundaryVariable::ComputeFluxCorrectionBufferSize(
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
-//                                                               const NeighborBlock& nb)
+//! \fn int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
 //  \brief Set face-centered boundary buffers for sending to a block on the same level
 
-int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
+int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(BufArray1D<Real> &buf,
                                                               const NeighborBlock &nb) {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
-  int p = 0;
+  FaceBufferRanges ranges;
 
   // bx1
   if (nb.ni.ox1 == 0)
@@ -196,7 +253,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
     else if (nb.ni.ox1 < 0)
       si--;
   }
-  BufferUtility::PackData((*var_fc).x1f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x1f, si, ei, sj, ej, sk, ek);
 
   // bx2
   if (nb.ni.ox1 == 0)
@@ -221,7 +278,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
     else if (nb.ni.ox2 < 0)
       sj--;
   }
-  BufferUtility::PackData((*var_fc).x2f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x2f, si, ei, sj, ej, sk, ek);
 
   // bx3
   if (nb.ni.ox2 == 0)
@@ -246,23 +303,23 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferSameLevel(Real *buf,
     else if (nb.ni.ox3 < 0)
       sk--;
   }
-  BufferUtility::PackData((*var_fc).x3f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x3f, si, ei, sj, ej, sk, ek);
 
-  return p;
+  return PackUnpackFaceBuffer<true>("PackFaceBuffer", pmb->exec_space, ranges, buf);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
-//                                                                const NeighborBlock& nb)
+//! \fn int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
 //  \brief Set face-centered boundary buffers for sending to a block on the coarser level
 
-int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
+int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(BufArray1D<Real> &buf,
                                                               const NeighborBlock &nb) {
   MeshBlock *pmb = pmy_block_;
   auto &pmr = pmb->pmr;
   int si, sj, sk, ei, ej, ek;
   int cng = NGHOST;
-  int p = 0;
+  FaceBufferRanges ranges;
 
   // bx1
   if (nb.ni.ox1 == 0)
@@ -294,7 +351,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
       si--;
   }
   pmr->RestrictFieldX1((*var_fc).x1f, coarse_buf.x1f, si, ei, sj, ej, sk, ek);
-  BufferUtility::PackData(coarse_buf.x1f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add(coarse_buf.x1f, si, ei, sj, ej, sk, ek);
 
   // bx2
   if (nb.ni.ox1 == 0)
@@ -320,11 +377,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
       sj--;
   }
   pmr->RestrictFieldX2((*var_fc).x2f, coarse_buf.x2f, si, ei, sj, ej, sk, ek);
-  if (pmb->block_size.nx2 == 1) { // 1D
-    for (int i = si; i <= ei; i++)
-      coarse_buf.x2f(sk, sj + 1, i) = coarse_buf.x2f(sk, sj, i);
-  }
-  BufferUtility::PackData(coarse_buf.x2f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add(coarse_buf.x2f, si, ei, sj, ej, sk, ek, pmb->block_size.nx2 == 1, 0);
 
   // bx3
   if (nb.ni.ox2 == 0)
@@ -350,23 +403,17 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToCoarser(Real *buf,
       sk--;
   }
   pmr->RestrictFieldX3((*var_fc).x3f, coarse_buf.x3f, si, ei, sj, ej, sk, ek);
-  if (pmb->block_size.nx3 == 1) { // 1D or 2D
-    for (int j = sj; j <= ej; j++) {
-      for (int i = si; i <= ei; i++)
-        coarse_buf.x3f(sk + 1, j, i) = coarse_buf.x3f(sk, j, i);
-    }
-  }
-  BufferUtility::PackData(coarse_buf.x3f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add(coarse_buf.x3f, si, ei, sj, ej, sk, ek, 0, pmb->block_size.nx3 == 1);
 
-  return p;
+  return PackUnpackFaceBuffer<true>("PackFaceBuffer", pmb->exec_space, ranges, buf);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
-//                                                                const NeighborBlock& nb)
+//! \fn int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
 //  \brief Set face-centered boundary buffers for sending to a block on the finer level
 
-int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
+int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(BufArray1D<Real> &buf,
                                                             const NeighborBlock &nb) {
   MeshBlock *pmb = pmy_block_;
   int nx1 = pmb->block_size.nx1;
@@ -375,7 +422,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
 
   int si, sj, sk, ei, ej, ek;
   int cn = pmb->cnghost - 1;
-  int p = 0;
+  FaceBufferRanges ranges;
 
   // send the data first and later prolongate on the target block
   // need to add edges for faces, add corners for edges
@@ -433,7 +480,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
     sk = pmb->ks, ek = pmb->ks + cn;
   }
 
-  BufferUtility::PackData((*var_fc).x1f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x1f, si, ei, sj, ej, sk, ek);
 
   // bx2
   if (nb.ni.ox1 == 0) {
@@ -469,7 +516,7 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
     sj = pmb->js, ej = pmb->js + pmb->cnghost;
   }
 
-  BufferUtility::PackData((*var_fc).x2f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x2f, si, ei, sj, ej, sk, ek);
 
   // bx3
   if (nb.ni.ox2 == 0) {
@@ -515,22 +562,22 @@ int FaceCenteredBoundaryVariable::LoadBoundaryBufferToFiner(Real *buf,
     sk = pmb->ks, ek = pmb->ks + pmb->cnghost;
   }
 
-  BufferUtility::PackData((*var_fc).x3f, buf, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x3f, si, ei, sj, ej, sk, ek);
 
-  return p;
+  return PackUnpackFaceBuffer<true>("PackFaceBuffer", pmb->exec_space, ranges, buf);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void FaceCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
-//                                                              const NeighborBlock& nb)
+//! \fn void FaceCenteredBoundaryVariable::SetBoundarySameLevel(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
 //  \brief Set face-centered boundary received from a block on the same level
 
-void FaceCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
+void FaceCenteredBoundaryVariable::SetBoundarySameLevel(BufArray1D<Real> &buf,
                                                         const NeighborBlock &nb) {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
 
-  int p = 0;
+  FaceBufferRanges ranges;
   // bx1
   // for uniform grid: face-neighbors take care of the overlapping faces
   if (nb.ni.ox1 == 0)
@@ -562,7 +609,7 @@ void FaceCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
       ei++;
   }
 
-  BufferUtility::UnpackData(buf, (*var_fc).x1f, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x1f, si, ei, sj, ej, sk, ek);
 
   // bx2
   if (nb.ni.ox1 == 0)
@@ -589,13 +636,7 @@ void FaceCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
       ej++;
   }
 
-  BufferUtility::UnpackData(buf, (*var_fc).x2f, si, ei, sj, ej, sk, ek, p);
-
-  if (pmb->block_size.nx2 == 1) { // 1D
-#pragma omp simd
-    for (int i = si; i <= ei; ++i)
-      (*var_fc).x2f(sk, sj + 1, i) = (*var_fc).x2f(sk, sj, i);
-  }
+  ranges.Add((*var_fc).x2f, si, ei, sj, ej, sk, ek, pmb->block_size.nx2 == 1, 0);
 
   // bx3
   if (nb.ni.ox2 == 0)
@@ -622,30 +663,22 @@ void FaceCenteredBoundaryVariable::SetBoundarySameLevel(Real *buf,
       ek++;
   }
 
-  BufferUtility::UnpackData(buf, (*var_fc).x3f, si, ei, sj, ej, sk, ek, p);
-
-  if (pmb->block_size.nx3 == 1) { // 1D or 2D
-    for (int j = sj; j <= ej; ++j) {
-#pragma omp simd
-      for (int i = si; i <= ei; ++i)
-        (*var_fc).x3f(sk + 1, j, i) = (*var_fc).x3f(sk, j, i);
-    }
-  }
+  ranges.Add((*var_fc).x3f, si, ei, sj, ej, sk, ek, 0, pmb->block_size.nx3 == 1);
 
-  return;
+  PackUnpackFaceBuffer<false>("UnpackFaceBuffer", pmb->exec_space, ranges, buf);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
-//                                                                const NeighborBlock& nb)
+//! \fn void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
 //  \brief Set face-centered prolongation buffer received from a block on the same level
 
-void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
+void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(BufArray1D<Real> &buf,
                                                           const NeighborBlock &nb) {
   MeshBlock *pmb = pmy_block_;
   int si, sj, sk, ei, ej, ek;
   int cng = pmb->cnghost;
-  int p = 0;
+  FaceBufferRanges ranges;
 
   // bx1
   if (nb.ni.ox1 == 0) {
@@ -688,7 +721,7 @@ void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
     sk = pmb->cks - cng, ek = pmb->cks - 1;
   }
 
-  BufferUtility::UnpackData(buf, coarse_buf.x1f, si, ei, sj, ej, sk, ek, p);
+  ranges.Add(coarse_buf.x1f, si, ei, sj, ej, sk, ek);
 
   // bx2
   if (nb.ni.ox1 == 0) {
@@ -718,12 +751,7 @@ void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
     sj = pmb->cjs - cng, ej = pmb->cjs;
   }
 
-  BufferUtility::UnpackData(buf, coarse_buf.x2f, si, ei, sj, ej, sk, ek, p);
-  if (pmb->block_size.nx2 == 1) { // 1D
-#pragma omp simd
-    for (int i = si; i <= ei; ++i)
-      coarse_buf.x2f(sk, sj + 1, i) = coarse_buf.x2f(sk, sj, i);
-  }
+  ranges.Add(coarse_buf.x2f, si, ei, sj, ej, sk, ek, pmb->block_size.nx2 == 1, 0);
 
   // bx3
   if (nb.ni.ox2 == 0) {
@@ -755,29 +783,22 @@ void FaceCenteredBoundaryVariable::SetBoundaryFromCoarser(Real *buf,
     sk = pmb->cks - cng, ek = pmb->cks;
   }
 
-  BufferUtility::UnpackData(buf, coarse_buf.x3f, si, ei, sj, ej, sk, ek, p);
+  ranges.Add(coarse_buf.x3f, si, ei, sj, ej, sk, ek, 0, pmb->block_size.nx3 == 1);
 
-  if (pmb->block_size.nx3 == 1) { // 2D
-    for (int j = sj; j <= ej; ++j) {
-      for (int i = si; i <= ei; ++i)
-        coarse_buf.x3f(sk + 1, j, i) = coarse_buf.x3f(sk, j, i);
-    }
-  }
-
-  return;
+  PackUnpackFaceBuffer<false>("UnpackFaceBuffer", pmb->exec_space, ranges, buf);
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void FaceCenteredBoundaryVariable::SetFielBoundaryFromFiner(Real *buf,
-//                                                                const NeighborBlock& nb)
+//! \fn void FaceCenteredBoundaryVariable::SetFielBoundaryFromFiner(
+//     BufArray1D<Real> &buf, const NeighborBlock& nb)
 //  \brief Set face-centered boundary received from a block on the same level
 
-void FaceCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
+void FaceCenteredBoundaryVariable::SetBoundaryFromFiner(BufArray1D<Real> &buf,
                                                         const NeighborBlock &nb) {
   MeshBlock *pmb = pmy_block_;
   // receive already restricted data
   int si, sj, sk, ei, ej, ek;
-  int p = 0;
+  FaceBufferRanges ranges;
 
   // bx1
   if (nb.ni.ox1 == 0) {
@@ -842,7 +863,7 @@ void FaceCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
     sk = pmb->ks - NGHOST, ek = pmb->ks - 1;
   }
 
-  BufferUtility::UnpackData(buf, (*var_fc).x1f, si, ei, sj, ej, sk, ek, p);
+  ranges.Add((*var_fc).x1f, si, ei, sj, ej, sk, ek);
 
   // bx2
   if (nb.ni.ox1 == 0) {
@@ -887,13 +908,7 @@ void FaceCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
       ej++;
   }
 
-  BufferUtility::UnpackData(buf, (*var_fc).x2f, si, ei, sj, ej, sk, ek, p);
-
-  if (pmb->block_size.nx2 == 1) { // 1D
-#pragma omp simd
-    for (int i = si; i <= ei; ++i)
-      (*var_fc).x2f(sk, sj + 1, i) = (*var_fc).x2f(sk, sj, i);
-  }
+  ranges.Add((*var_fc).x2f, si, ei, sj, ej, sk, ek, pmb->block_size.nx2 == 1, 0);
 
   // bx3
   if (nb.ni.ox2 == 0) {
@@ -947,16 +962,8 @@ void FaceCenteredBoundaryVariable::SetBoundaryFromFiner(Real *buf,
       ek++;
   }
 
-  BufferUtility::UnpackData(buf, (*var_fc).x3f, si, ei, sj, ej, sk, ek, p);
-
-  if (pmb->block_size.nx3 == 1) { // 1D or 2D
-    for (int j = sj; j <= ej; ++j) {
-#pragma omp simd
-      for (int i = si; i <= ei; ++i)
-        (*var_fc).x3f(sk + 1, j, i) = (*var_fc).x3f(sk, j, i);
-    }
-  }
-  return;
+  ranges.Add((*var_fc).x3f, si, ei, sj, ej, sk, ek, 0, pmb->block_size.nx3 == 1);
+  PackUnpackFaceBuffer<false>("UnpackFaceBuffer", pmb->exec_space, ranges, buf);
 }
 
 void FaceCenteredBoundaryVariable::CountFineEdges() {
@@ -1095,16 +1102,12 @@ void FaceCenteredBoundaryVariable::SetupPersistentMPI() {
         ssize = csize, rsize = fsize;
 
       // face-centered field: bd_var_
-      tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid, fc_phys_id_);
-      if (bd_var_.req_send[nb.bufid] != MPI_REQUEST_NULL)
-        MPI_Request_free(&bd_var_.req_send[nb.bufid]);
-      MPI_Send_init(bd_var_.send[nb.bufid], ssize, MPI_ATHENA_REAL, nb.snb.rank, tag,
-                    MPI_COMM_WORLD, &(bd_var_.req_send[nb.bufid]));
-      tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid, fc_phys_id_);
-      if (bd_var_.req_recv[nb.bufid] != MPI_REQUEST_NULL)
-        MPI_Request_free(&bd_var_.req_recv[nb.bufid]);
-      MPI_Recv_init(bd_var_.recv[nb.bufid], rsize, MPI_ATHENA_REAL, nb.snb.rank, tag,
-                    MPI_COMM_WORLD, &(bd_var_.req_recv[nb.bufid]));
+      tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid);
+      SetupPersistentSend(bd_var_, nb.bufid, ssize, nb.snb.rank, tag,
+                          pmy_mesh_->GetMPIComm(fc_phys_id_));
+      tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid);
+      SetupPersistentRecv(bd_var_, nb.bufid, rsize, nb.snb.rank, tag,
+                          pmy_mesh_->GetMPIComm(fc_phys_id_));
 
       // set up flux correction MPI communication buffers
       int f2csize;
@@ -1156,31 +1159,23 @@ void FaceCenteredBoundaryVariable::SetupPersistentMPI() {
       if (nb.snb.level == mylevel) { // the same level
         if ((nb.ni.type == NeighborConnect::face) ||
             ((nb.ni.type == NeighborConnect::edge) && (edge_flag_[nb.eid]))) {
-          tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid, fc_flx_phys_id_);
-          if (bd_var_flcor_.req_send[nb.bufid] != MPI_REQUEST_NULL)
-            MPI_Request_free(&bd_var_flcor_.req_send[nb.bufid]);
-          MPI_Send_init(bd_var_flcor_.send[nb.bufid], size, MPI_ATHENA_REAL, nb.snb.rank,
-                        tag, MPI_COMM_WORLD, &(bd_var_flcor_.req_send[nb.bufid]));
-          tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid, fc_flx_phys_id_);
-          if (bd_var_flcor_.req_recv[nb.bufid] != MPI_REQUEST_NULL)
-            MPI_Request_free(&bd_var_flcor_.req_recv[nb.bufid]);
-          MPI_Recv_init(bd_var_flcor_.recv[nb.bufid], size, MPI_ATHENA_REAL, nb.snb.rank,
-                        tag, MPI_COMM_WORLD, &(bd_var_flcor_.req_recv[nb.bufid]));
+          tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid);
+          SetupPersistentSend(bd_var_flcor_, nb.bufid, size, nb.snb.rank, tag,
+                              pmy_mesh_->GetMPIComm(fc_flx_phys_id_));
+          tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid);
+          SetupPersistentRecv(bd_var_flcor_, nb.bufid, size, nb.snb.rank, tag,
+                              pmy_mesh_->GetMPIComm(fc_flx_phys_id_));
         }
       }
       if (nb.snb.level > mylevel) { // finer neighbor
-        tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid, fc_flx_phys_id_);
-        if (bd_var_flcor_.req_recv[nb.bufid] != MPI_REQUEST_NULL)
-          MPI_Request_free(&bd_var_flcor_.req_recv[nb.bufid]);
-        MPI_Recv_init(bd_var_flcor_.recv[nb.bufid], f2csize, MPI_ATHENA_REAL, nb.snb.rank,
-                      tag, MPI_COMM_WORLD, &(bd_var_flcor_.req_recv[nb.bufid]));
+        tag = pmb->pbval->CreateBvalsMPITag(pmb->lid, nb.bufid);
+        SetupPersistentRecv(bd_var_flcor_, nb.bufid, f2csize, nb.snb.rank, tag,
+                            pmy_mesh_->GetMPIComm(fc_flx_phys_id_));
       }
       if (nb.snb.level < mylevel) { // coarser neighbor
-        tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid, fc_flx_phys_id_);
-        if (bd_var_flcor_.req_send[nb.bufid] != MPI_REQUEST_NULL)
-          MPI_Request_free(&bd_var_flcor_.req_send[nb.bufid]);
-        MPI_Send_init(bd_var_flcor_.send[nb.bufid], f2csize, MPI_ATHENA_REAL, nb.snb.rank,
-                      tag, MPI_COMM_WORLD, &(bd_var_flcor_.req_send[nb.bufid]));
+        tag = pmb->pbval->CreateBvalsMPITag(nb.snb.lid, nb.targetid);
+        SetupPersistentSend(bd_var_flcor_, nb.bufid, f2csize, nb.snb.rank, tag,
+                            pmy_mesh_->GetMPIComm(fc_flx_phys_id_));
       }
     } // neighbor block is on separate MPI process
   }   // end loop over neighbors
@@ -1197,6 +1192,8 @@ void FaceCenteredBoundaryVariable::StartReceiving(BoundaryCommSubset phase) {
     NeighborBlock &nb = pmb->pbval->neighbor[n];
     if (nb.snb.rank != Globals::my_rank && phase != BoundaryCommSubset::gr_amr) {
       MPI_Start(&(bd_var_.req_recv[nb.bufid]));
+      pmy_mesh_->recv_tracker.Add(&(bd_var_.req_recv[nb.bufid]),
+                                  &(bd_var_.flag[nb.bufid]));
       if (phase == BoundaryCommSubset::all &&
           (nb.ni.type == NeighborConnect::face || nb.ni.type == NeighborConnect::edge)) {
         if ((nb.snb.level > mylevel) ||
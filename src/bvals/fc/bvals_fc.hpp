@@ -72,12 +72,14 @@ class FaceCenteredBoundaryVariable : public BoundaryVariable {
 #endif
 
   // BoundaryBuffer:
-  int LoadBoundaryBufferSameLevel(Real *buf, const NeighborBlock &nb) override;
-  void SetBoundarySameLevel(Real *buf, const NeighborBlock &nb) override;
-  int LoadBoundaryBufferToCoarser(Real *buf, const NeighborBlock &nb) override;
-  int LoadBoundaryBufferToFiner(Real *buf, const NeighborBlock &nb) override;
-  void SetBoundaryFromCoarser(Real *buf, const NeighborBlock &nb) override;
-  void SetBoundaryFromFiner(Real *buf, const NeighborBlock &nb) override;
+  int LoadBoundaryBufferSameLevel(BufArray1D<Real> &buf,
+                                  const NeighborBlock &nb) override;
+  void SetBoundarySameLevel(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+  int LoadBoundaryBufferToCoarser(BufArray1D<Real> &buf,
+                                  const NeighborBlock &nb) override;
+  int LoadBoundaryBufferToFiner(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+  void SetBoundaryFromCoarser(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
+  void SetBoundaryFromFiner(BufArray1D<Real> &buf, const NeighborBlock &nb) override;
 
   void CountFineEdges(); // called in SetupPersistentMPI()
 
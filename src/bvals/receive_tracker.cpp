@@ -0,0 +1,133 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file receive_tracker.cpp
+//  \brief implementation of the rank-level completion of boundary receives
+
+#include "bvals/receive_tracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "bvals/bvals_interfaces.hpp"
+
+namespace parthenon {
+
+#ifdef MPI_PARALLEL
+
+void ReceiveTracker::Add(MPI_Request *req, std::atomic<BoundaryStatus> *flag) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_.push_back(*req);
+  owners_.push_back(req);
+  flags_.push_back(flag);
+  npending_.store(requests_.size(), std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn int ReceiveTracker::Poll()
+//  \brief one MPI_Testsome over all outstanding receives, which also progresses MPI,
+//  unless the progress thread does that already
+
+int ReceiveTracker::Poll() {
+  if (progress_.joinable()) return npending_.load(std::memory_order_acquire);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return TestSome_();
+}
+
+void ReceiveTracker::Wait(MPI_Request *req) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(owners_.begin(), owners_.end(), req);
+    if (it != owners_.end()) Remove_(it - owners_.begin());
+    npending_.store(requests_.size(), std::memory_order_release);
+  }
+  // returns at once if a poll has already completed the receive
+  MPI_Wait(req, MPI_STATUS_IGNORE);
+}
+
+void ReceiveTracker::StartProgressThread(int core) {
+  if (progress_.joinable()) return;
+  stop_ = false;
+  progress_ = std::thread(&ReceiveTracker::Progress_, this);
+#ifdef __linux__
+  if (core >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(progress_.native_handle(), sizeof(cpu_set_t), &cpus);
+  }
+#endif
+}
+
+// called with mutex_ held
+int ReceiveTracker::TestSome_() {
+  const int n = requests_.size();
+  if (n > 0) {
+    completed_.resize(n);
+    int ncompleted;
+    MPI_Testsome(n, requests_.data(), &ncompleted, completed_.data(),
+                 MPI_STATUSES_IGNORE);
+    if (ncompleted != MPI_UNDEFINED) {
+      // removing from the back keeps the indices of the entries still to go valid
+      std::sort(completed_.begin(), completed_.begin() + ncompleted,
+                std::greater<int>());
+      for (int c = 0; c < ncompleted; c++) {
+        *flags_[completed_[c]] = BoundaryStatus::arrived;
+        Remove_(completed_[c]);
+      }
+    }
+  }
+  npending_.store(requests_.size(), std::memory_order_release);
+  return requests_.size();
+}
+
+void ReceiveTracker::Remove_(int n) {
+  requests_[n] = requests_.back();
+  owners_[n] = owners_.back();
+  flags_[n] = flags_.back();
+  requests_.pop_back();
+  owners_.pop_back();
+  flags_.pop_back();
+}
+
+void ReceiveTracker::Progress_() {
+  while (!stop_.load(std::memory_order_relaxed)) {
+    int npending;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      npending = TestSome_();
+    }
+    if (npending == 0) {
+      // nothing to receive: keep the sends of this rank moving, then back off
+      int flag;
+      MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, MPI_STATUS_IGNORE);
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+}
+
+#endif // MPI_PARALLEL
+
+void ReceiveTracker::StopProgressThread() {
+  if (!progress_.joinable()) return;
+  stop_ = true;
+  progress_.join();
+}
+
+} // namespace parthenon
@@ -0,0 +1,89 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef BVALS_RECEIVE_TRACKER_HPP_
+#define BVALS_RECEIVE_TRACKER_HPP_
+//! \file receive_tracker.hpp
+//  \brief rank-level completion of the boundary receives of all blocks
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+namespace parthenon {
+
+enum class BoundaryStatus;
+
+//----------------------------------------------------------------------------------------
+//! \class ReceiveTracker
+//  \brief holds the outstanding (per-buffer) boundary receives of all blocks of this rank
+//  in one array, so a poll completes every receive that has arrived with a single
+//  MPI_Testsome instead of an MPI_Iprobe and an MPI_Test per buffer. The flag of each
+//  completed buffer is set to BoundaryStatus::arrived directly, so the receiving task of
+//  its block finds it ready without any MPI call of its own.
+//
+//  Receives are added when they are started and leave the tracker when they complete,
+//  so the tracker is empty between exchanges. The persistent requests stay owned by the
+//  BoundaryData they were created in; the tracker only tests copies of their handles.
+//  Calls are serialized, as blocks may run on many threads.
+//
+//  With a progress thread (<mesh>/progress_thread), the polling moves to a thread of its
+//  own, optionally pinned to a spare core, which keeps MPI progressing while the tasks
+//  are inside long kernels; Poll() then only picks up the flags it has set.
+
+class ReceiveTracker {
+ public:
+  ReceiveTracker() = default;
+  ReceiveTracker(const ReceiveTracker &) = delete;
+  ReceiveTracker &operator=(const ReceiveTracker &) = delete;
+  ~ReceiveTracker() { StopProgressThread(); }
+
+#ifdef MPI_PARALLEL
+  // registers a receive that has just been started with MPI_Start(req)
+  void Add(MPI_Request *req, std::atomic<BoundaryStatus> *flag);
+  // marks every receive that has arrived; returns the number still outstanding
+  int Poll();
+  // blocks until the receive of req has arrived, for the initial exchange
+  void Wait(MPI_Request *req);
+  // core < 0 leaves the placement of the thread to the operating system; requires
+  // MPI_THREAD_MULTIPLE
+  void StartProgressThread(int core);
+#endif
+  void StopProgressThread();
+
+ private:
+  std::vector<std::atomic<BoundaryStatus> *> flags_;
+#ifdef MPI_PARALLEL
+  std::vector<MPI_Request> requests_;
+  std::vector<MPI_Request *> owners_;
+  std::vector<int> completed_;
+#endif
+  std::mutex mutex_;
+  // published after the flags of each poll, so a reader that loads it sees them
+  std::atomic<int> npending_{0};
+  std::thread progress_;
+  std::atomic<bool> stop_{false};
+
+#ifdef MPI_PARALLEL
+  int TestSome_();
+  // drops entry n, moving the last entry into its place
+  void Remove_(int n);
+  void Progress_();
+#endif
+};
+
+} // namespace parthenon
+
+#endif // BVALS_RECEIVE_TRACKER_HPP_
@@ -0,0 +1,176 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef BVALS_USER_BOUNDARY_CONDITION_HPP_
+#define BVALS_USER_BOUNDARY_CONDITION_HPP_
+//! \file user_boundary_condition.hpp
+//  \brief boundary conditions given as device functors, for the faces of the domain with
+//         <mesh>/ixn_bc or oxn_bc = user
+
+#include <memory>
+#include <string>
+
+#include "athena.hpp"
+#include "bvals/bvals_interfaces.hpp"
+#include "coordinates/device_coordinates.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+class MeshBlock;
+
+//----------------------------------------------------------------------------------------
+//! \struct FaceCells
+//  \brief The ghost cells of one face of a block and the interior cells they are filled
+//  from. Faces normal to x1 and x2 leave the x3 ghost cells alone, as in Athena++.
+
+struct FaceCells {
+  FaceCells(const MeshBlock *pmb, const BoundaryFace face);
+
+  // index in direction dir of the interior cell that ghost cell x is filled from, the
+  // interior cell next to the face or, if mirrored, the one at the same distance
+  KOKKOS_INLINE_FUNCTION int Source(const bool mirrored, const int x) const {
+    return mirrored ? mirror - x : bnd;
+  }
+
+  int dir;
+  int kl, ku, jl, ju, il, iu;
+  int bnd;    // the interior cell next to the face
+  int mirror; // a mirrored ghost cell x is filled from interior cell mirror - x
+};
+
+namespace impl {
+
+// Fills the ghost cells fc of components n0, n0 + 1, ... of one block in one launch.
+// fill(coords, n, k, j, i, q_src) returns the value of ghost cell (k, j, i) of component
+// n given the value of the interior cell it is filled from, which is mirrored across the
+// face if Fill::mirrored.
+template <typename Fill>
+void FillFace(DevSpace exec_space, const FaceCells &fc, const ParArray4D<Real> &q,
+              const int n0, const DeviceCoordinates &coords, const Fill &fill) {
+  par_for(
+      "ApplyBoundaryConditions", exec_space, 0, q.extent_int(0) - 1, fc.kl, fc.ku, fc.jl,
+      fc.ju, fc.il, fc.iu,
+      KOKKOS_LAMBDA(const int l, const int k, const int j, const int i) {
+        int src[3] = {i, j, k};
+        src[fc.dir] = fc.Source(Fill::mirrored, src[fc.dir]);
+        q(l, k, j, i) = fill(coords, n0 + l, k, j, i, q(l, src[2], src[1], src[0]));
+      });
+}
+
+// The same for all components of every block in a MeshBlockPack, in one launch; only
+// the blocks whose flag of this face is the given one are filled.
+template <typename Fill>
+void FillFaceOnMesh(const FaceCells &fc, const int face, const BoundaryFlag flag,
+                    const ParArray2D<BoundaryFlag> &bflags, const MeshBlockPack<Real> &q,
+                    const ParArray1D<DeviceCoordinates> &coords, const Fill &fill) {
+  par_for(
+      "ApplyBoundaryConditionsOnMesh", DevSpace(), 0, q.GetNBlocks() - 1, 0,
+      q.GetNVars() - 1, fc.kl, fc.ku, fc.jl, fc.ju, fc.il, fc.iu,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        if (bflags(b, face) != flag) return;
+        int src[3] = {i, j, k};
+        src[fc.dir] = fc.Source(Fill::mirrored, src[fc.dir]);
+        q(b, n, k, j, i) = fill(coords(b), n, k, j, i, q(b, n, src[2], src[1], src[0]));
+      });
+}
+
+// adds the time to the arguments of a user functor
+template <typename F>
+struct UserFill {
+  static constexpr bool mirrored = false;
+  KOKKOS_INLINE_FUNCTION Real operator()(const DeviceCoordinates &coords, const int n,
+                                         const int k, const int j, const int i,
+                                         const Real q_bnd) const {
+    return f(coords, time, n, k, j, i, q_bnd);
+  }
+  F f;
+  Real time;
+};
+
+} // namespace impl
+
+//----------------------------------------------------------------------------------------
+//! \class UserBoundaryCondition
+//  \brief A boundary condition enrolled with Mesh::EnrollBoundaryCondition() for a face
+//  of the domain with <mesh>/ixn_bc or oxn_bc = user. ApplyBoundaryConditions() calls it
+//  in place of the built-in outflow or reflecting conditions, with the same kernels.
+
+class UserBoundaryCondition {
+ public:
+  virtual ~UserBoundaryCondition() = default;
+  // fills the ghost cells fc of one block, q holding components n0, n0 + 1, ...
+  virtual void Fill(DevSpace exec_space, const FaceCells &fc, const ParArray4D<Real> &q,
+                    const int n0, const DeviceCoordinates &coords,
+                    const Real time) const = 0;
+  // fills the ghost cells fc of the blocks in q whose flag of face is user
+  virtual void FillOnMesh(const FaceCells &fc, const int face,
+                          const ParArray2D<BoundaryFlag> &bflags,
+                          const MeshBlockPack<Real> &q,
+                          const ParArray1D<DeviceCoordinates> &coords,
+                          const Real time) const = 0;
+};
+
+//----------------------------------------------------------------------------------------
+//! \class DeviceBoundaryCondition
+//  \brief A UserBoundaryCondition given by a device functor returning the value of a
+//  ghost cell,
+//    Real f(const DeviceCoordinates &coords, const Real time, const int n, const int k,
+//           const int j, const int i, const Real q_bnd)
+//  with n the component, counting the components of all Independent variables in
+//  container order (as in a MeshBlockPack), and q_bnd the value of component n in the
+//  interior cell next to the face on the same line, which outflow would copy.
+
+template <typename F>
+class DeviceBoundaryCondition : public UserBoundaryCondition {
+ public:
+  explicit DeviceBoundaryCondition(const F &f) : f_(f) {}
+
+  void Fill(DevSpace exec_space, const FaceCells &fc, const ParArray4D<Real> &q,
+            const int n0, const DeviceCoordinates &coords,
+            const Real time) const override {
+    impl::FillFace(exec_space, fc, q, n0, coords, impl::UserFill<F>{f_, time});
+  }
+  void FillOnMesh(const FaceCells &fc, const int face,
+                  const ParArray2D<BoundaryFlag> &bflags, const MeshBlockPack<Real> &q,
+                  const ParArray1D<DeviceCoordinates> &coords,
+                  const Real time) const override {
+    impl::FillFaceOnMesh(fc, face, BoundaryFlag::user, bflags, q, coords,
+                         impl::UserFill<F>{f_, time});
+  }
+
+ private:
+  F f_;
+};
+
+//----------------------------------------------------------------------------------------
+//! \class InflowBoundary
+//  \brief Functor for DeviceBoundaryCondition setting every ghost cell of component n to
+//  a fixed value(n)
+
+class InflowBoundary {
+ public:
+  explicit InflowBoundary(const ParArray1D<Real> &value) : value_(value) {}
+  KOKKOS_INLINE_FUNCTION Real operator()(const DeviceCoordinates &coords, const Real time,
+                                         const int n, const int k, const int j,
+                                         const int i, const Real q_bnd) const {
+    return value_(n);
+  }
+
+ private:
+  ParArray1D<Real> value_;
+};
+
+} // namespace parthenon
+
+#endif // BVALS_USER_BOUNDARY_CONDITION_HPP_
@@ -319,6 +319,22 @@ Coordinates::Coordinates(MeshBlock *pmb, ParameterInput *pin, bool flag)
     x3f(kl) = block_size.x3min;
     x3f(ku + 1) = block_size.x3max;
   }
+
+  uniform_spacing = pm->use_uniform_meshgen_fn_[X1DIR] &&
+                    (nc2 == 1 || pm->use_uniform_meshgen_fn_[X2DIR]) &&
+                    (nc3 == 1 || pm->use_uniform_meshgen_fn_[X3DIR]);
+  uniform_dx[X1DIR] = dx1f(il);
+  uniform_dx[X2DIR] = dx2f(jl);
+  uniform_dx[X3DIR] = dx3f(kl);
+
+  if (uniform_spacing) {
+    const int start[3] = {il, jl, kl};
+    const Real xmin[3] = {x1f(il), x2f(jl), x3f(kl)};
+    device_coords_ = DeviceCoordinates(start, xmin, uniform_dx);
+  } else {
+    device_coords_ = DeviceCoordinates(x1f.Get<1>(), x2f.Get<1>(), x3f.Get<1>(),
+                                       dx1f.Get<1>(), dx2f.Get<1>(), dx3f.Get<1>());
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -356,21 +372,6 @@ void Coordinates::Edge3Length(const int k, const int j, const int il, const int
   return;
 }
 
-//----------------------------------------------------------------------------------------
-// GetEdgeXLength functions: return length of edge-X at (i,j,k)
-
-Real Coordinates::GetEdge1Length(const int k, const int j, const int i) {
-  return dx1f(i);
-}
-
-Real Coordinates::GetEdge2Length(const int k, const int j, const int i) {
-  return dx2f(j);
-}
-
-Real Coordinates::GetEdge3Length(const int k, const int j, const int i) {
-  return dx3f(k);
-}
-
 //----------------------------------------------------------------------------------------
 // VolCenterXLength functions: compute physical length connecting cell centers as vector
 // VolCenter1(i,j,k) located at (i+1/2,j,k), i.e. (x1f(i+1), x2v(j), x3v(k))
@@ -465,21 +466,6 @@ void Coordinates::Face3Area(const int k, const int j, const int il, const int iu
   return;
 }
 
-//----------------------------------------------------------------------------------------
-// GetFaceXArea functions: return area of face with normal in X-dir at (i,j,k)
-
-Real Coordinates::GetFace1Area(const int k, const int j, const int i) {
-  return dx2f(j) * dx3f(k);
-}
-
-Real Coordinates::GetFace2Area(const int k, const int j, const int i) {
-  return dx1f(i) * dx3f(k);
-}
-
-Real Coordinates::GetFace3Area(const int k, const int j, const int i) {
-  return dx1f(i) * dx2f(j);
-}
-
 //----------------------------------------------------------------------------------------
 // VolCenterFaceXArea functions: compute area of face with normal in X-dir as vector
 // where the faces are joined by cell centers (for non-ideal MHD)
@@ -528,13 +514,6 @@ void Coordinates::CellVolume(const int k, const int j, const int il, const int i
   return;
 }
 
-//----------------------------------------------------------------------------------------
-// GetCellVolume: returns cell volume at (i,j,k)
-
-Real Coordinates::GetCellVolume(const int k, const int j, const int i) {
-  return dx1f(i) * dx2f(j) * dx3f(k);
-}
-
 //-------------------------------------------------------------------------------------
 // Laplacian: calculate total Laplacian of 4D scalar array s() to second order accuracy
 // may need to replace dx*f with dx*v for nonuniform coordinates for some applications
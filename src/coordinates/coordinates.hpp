@@ -29,6 +29,7 @@
 
 // Athena++ headers
 #include "athena.hpp"
+#include "coordinates/device_coordinates.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
@@ -40,7 +41,9 @@ class ParameterInput;
 
 //----------------------------------------------------------------------------------------
 //! \class Coordinates
-//  \brief abstract base class for all coordinate derived classes
+//  \brief base class for all coordinate derived classes.  The geometry functions used
+//  in loops (lengths, areas, volumes) are non-virtual so that they inline at the call
+//  site; a coordinate system is chosen at compile time through CoordinateSystem below.
 
 class Coordinates {
  public:
@@ -55,50 +58,63 @@ class Coordinates {
   // geometry coefficients (only used in SphericalPolar, Cylindrical, Cartesian)
   ParArrayND<Real> h2f, dh2fd1, h31f, h32f, dh31fd1, dh32fd2;
   ParArrayND<Real> h2v, dh2vd1, h31v, h32v, dh31vd1, dh32vd2;
+  // true if every active direction uses the uniform mesh generator, so that all cells
+  // share the face spacings uniform_dx[X1DIR], uniform_dx[X2DIR], uniform_dx[X3DIR]
+  bool uniform_spacing;
+  Real uniform_dx[3];
+
+  // copyable geometry for device kernels
+  const DeviceCoordinates &GetDeviceCoordinates() const { return device_coords_; }
 
   // functions...
   // ...to compute length of edges
-  virtual void Edge1Length(const int k, const int j, const int il, const int iu,
-                           ParArrayND<Real> &len);
-  virtual void Edge2Length(const int k, const int j, const int il, const int iu,
-                           ParArrayND<Real> &len);
-  virtual void Edge3Length(const int k, const int j, const int il, const int iu,
-                           ParArrayND<Real> &len);
-  virtual Real GetEdge1Length(const int k, const int j, const int i);
-  virtual Real GetEdge2Length(const int k, const int j, const int i);
-  virtual Real GetEdge3Length(const int k, const int j, const int i);
+  void Edge1Length(const int k, const int j, const int il, const int iu,
+                   ParArrayND<Real> &len);
+  void Edge2Length(const int k, const int j, const int il, const int iu,
+                   ParArrayND<Real> &len);
+  void Edge3Length(const int k, const int j, const int il, const int iu,
+                   ParArrayND<Real> &len);
+  Real GetEdge1Length(const int k, const int j, const int i) const { return dx1f(i); }
+  Real GetEdge2Length(const int k, const int j, const int i) const { return dx2f(j); }
+  Real GetEdge3Length(const int k, const int j, const int i) const { return dx3f(k); }
   // ...to compute length connecting cell centers (for non-ideal MHD)
-  virtual void VolCenter1Length(const int k, const int j, const int il, const int iu,
-                                ParArrayND<Real> &len);
-  virtual void VolCenter2Length(const int k, const int j, const int il, const int iu,
-                                ParArrayND<Real> &len);
-  virtual void VolCenter3Length(const int k, const int j, const int il, const int iu,
-                                ParArrayND<Real> &len);
+  void VolCenter1Length(const int k, const int j, const int il, const int iu,
+                        ParArrayND<Real> &len);
+  void VolCenter2Length(const int k, const int j, const int il, const int iu,
+                        ParArrayND<Real> &len);
+  void VolCenter3Length(const int k, const int j, const int il, const int iu,
+                        ParArrayND<Real> &len);
   // ...to compute physical width at cell center
-  virtual void CenterWidth1(const int k, const int j, const int il, const int iu,
-                            ParArrayND<Real> &dx1);
-  virtual void CenterWidth2(const int k, const int j, const int il, const int iu,
-                            ParArrayND<Real> &dx2);
-  virtual void CenterWidth3(const int k, const int j, const int il, const int iu,
-                            ParArrayND<Real> &dx3);
+  void CenterWidth1(const int k, const int j, const int il, const int iu,
+                    ParArrayND<Real> &dx1);
+  void CenterWidth2(const int k, const int j, const int il, const int iu,
+                    ParArrayND<Real> &dx2);
+  void CenterWidth3(const int k, const int j, const int il, const int iu,
+                    ParArrayND<Real> &dx3);
 
   // ...to compute area of faces
-  virtual void Face1Area(const int k, const int j, const int il, const int iu,
-                         ParArrayND<Real> &area);
-  virtual void Face2Area(const int k, const int j, const int il, const int iu,
-                         ParArrayND<Real> &area);
-  virtual void Face3Area(const int k, const int j, const int il, const int iu,
-                         ParArrayND<Real> &area);
-  virtual Real GetFace1Area(const int k, const int j, const int i);
-  virtual Real GetFace2Area(const int k, const int j, const int i);
-  virtual Real GetFace3Area(const int k, const int j, const int i);
+  void Face1Area(const int k, const int j, const int il, const int iu,
+                 ParArrayND<Real> &area);
+  void Face2Area(const int k, const int j, const int il, const int iu,
+                 ParArrayND<Real> &area);
+  void Face3Area(const int k, const int j, const int il, const int iu,
+                 ParArrayND<Real> &area);
+  Real GetFace1Area(const int k, const int j, const int i) const {
+    return dx2f(j) * dx3f(k);
+  }
+  Real GetFace2Area(const int k, const int j, const int i) const {
+    return dx1f(i) * dx3f(k);
+  }
+  Real GetFace3Area(const int k, const int j, const int i) const {
+    return dx1f(i) * dx2f(j);
+  }
   // ...to compute area of faces joined by cell centers (for non-ideal MHD)
-  virtual void VolCenterFace1Area(const int k, const int j, const int il, const int iu,
-                                  ParArrayND<Real> &area);
-  virtual void VolCenterFace2Area(const int k, const int j, const int il, const int iu,
-                                  ParArrayND<Real> &area);
-  virtual void VolCenterFace3Area(const int k, const int j, const int il, const int iu,
-                                  ParArrayND<Real> &area);
+  void VolCenterFace1Area(const int k, const int j, const int il, const int iu,
+                          ParArrayND<Real> &area);
+  void VolCenterFace2Area(const int k, const int j, const int il, const int iu,
+                          ParArrayND<Real> &area);
+  void VolCenterFace3Area(const int k, const int j, const int il, const int iu,
+                          ParArrayND<Real> &area);
 
   // ...to compute Laplacian of quantities in the coord system and orthogonal subspaces
   virtual void Laplacian(const ParArrayND<Real> &s, ParArrayND<Real> &delta_s,
@@ -124,9 +140,11 @@ class Coordinates {
                               const int jl, const int ju, const int il, const int iu);
 
   // ...to compute volume of cells
-  virtual void CellVolume(const int k, const int j, const int il, const int iu,
-                          ParArrayND<Real> &vol);
-  virtual Real GetCellVolume(const int k, const int j, const int i);
+  void CellVolume(const int k, const int j, const int il, const int iu,
+                  ParArrayND<Real> &vol);
+  Real GetCellVolume(const int k, const int j, const int i) const {
+    return dx1f(i) * dx2f(j) * dx3f(k);
+  }
 
   // ...to compute geometrical source terms
   virtual void AddCoordTermsDivergence(const Real dt, const ParArrayND<Real> *flux,
@@ -187,6 +205,7 @@ class Coordinates {
   Mesh *pm;
   int il, iu, jl, ju, kl, ku, ng; // limits of indices of arrays (normal or coarse)
   int nc1, nc2, nc3;              // # cells in each dir of arrays (normal or coarse)
+  DeviceCoordinates device_coords_;
   // Scratch arrays for coordinate factors
   // Format: coord_<type>[<direction>]_<index>[<count>]_
   //   type: vol[ume], area, etc.
@@ -278,14 +297,17 @@ class Coordinates {
 
 //----------------------------------------------------------------------------------------
 //! \class Cartesian
-//  \brief derived class for Cartesian coordinates.  None of the virtual funcs
-//  in the Coordinates abstract base class need to be overridden.
+//  \brief derived class for Cartesian coordinates.  None of the funcs in the
+//  Coordinates base class need to be overridden.
 
-class Cartesian : public Coordinates {
+class Cartesian final : public Coordinates {
  public:
   Cartesian(MeshBlock *pmb, ParameterInput *pin, bool flag);
 };
 
+// the coordinate system every MeshBlock (and its coarse AMR copy) is built with
+using CoordinateSystem = Cartesian;
+
 } // namespace parthenon
 
 #endif // COORDINATES_COORDINATES_HPP_
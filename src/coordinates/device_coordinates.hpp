@@ -0,0 +1,102 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef COORDINATES_DEVICE_COORDINATES_HPP_
+#define COORDINATES_DEVICE_COORDINATES_HPP_
+//! \file device_coordinates.hpp
+//  \brief Cartesian geometry of a MeshBlock that can be evaluated in device kernels
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \class DeviceCoordinates
+//  \brief Positions, spacings, face areas and volumes of the cells of one MeshBlock,
+//  callable from device kernels and cheap to copy into them. Blocks with uniform spacing
+//  only keep the first interior face and the spacing in each direction and compute
+//  everything on the fly; stretched blocks keep views of the face positions and spacings
+//  held by Coordinates. Obtained from Coordinates::GetDeviceCoordinates().
+
+class DeviceCoordinates {
+ public:
+  DeviceCoordinates() = default;
+  // uniform spacing: face index start[d] is at xmin[d], spacing dx[d]
+  DeviceCoordinates(const int start[3], const Real xmin[3], const Real dx[3])
+      : uniform_(true), start_{start[0], start[1], start[2]},
+        xmin_{xmin[0], xmin[1], xmin[2]}, dx_{dx[0], dx[1], dx[2]} {}
+  // stretched spacing
+  DeviceCoordinates(const ParArray1D<Real> &x1f, const ParArray1D<Real> &x2f,
+                    const ParArray1D<Real> &x3f, const ParArray1D<Real> &dx1f,
+                    const ParArray1D<Real> &dx2f, const ParArray1D<Real> &dx3f)
+      : uniform_(false), x1f_(x1f), x2f_(x2f), x3f_(x3f), dx1f_(dx1f), dx2f_(dx2f),
+        dx3f_(dx3f) {}
+
+  KOKKOS_FORCEINLINE_FUNCTION bool IsUniform() const { return uniform_; }
+
+  // face positions and spacings
+  KOKKOS_FORCEINLINE_FUNCTION Real X1f(const int i) const {
+    return uniform_ ? xmin_[0] + (i - start_[0]) * dx_[0] : x1f_(i);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real X2f(const int j) const {
+    return uniform_ ? xmin_[1] + (j - start_[1]) * dx_[1] : x2f_(j);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real X3f(const int k) const {
+    return uniform_ ? xmin_[2] + (k - start_[2]) * dx_[2] : x3f_(k);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real Dx1f(const int i) const {
+    return uniform_ ? dx_[0] : dx1f_(i);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real Dx2f(const int j) const {
+    return uniform_ ? dx_[1] : dx2f_(j);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real Dx3f(const int k) const {
+    return uniform_ ? dx_[2] : dx3f_(k);
+  }
+
+  // cell centers, which in Cartesian coordinates are the face midpoints
+  KOKKOS_FORCEINLINE_FUNCTION Real X1v(const int i) const {
+    return X1f(i) + 0.5 * Dx1f(i);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real X2v(const int j) const {
+    return X2f(j) + 0.5 * Dx2f(j);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real X3v(const int k) const {
+    return X3f(k) + 0.5 * Dx3f(k);
+  }
+
+  // area of the face with normal in direction d at the lower side of cell (k, j, i)
+  KOKKOS_FORCEINLINE_FUNCTION Real Area1(const int k, const int j, const int i) const {
+    return Dx2f(j) * Dx3f(k);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real Area2(const int k, const int j, const int i) const {
+    return Dx1f(i) * Dx3f(k);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real Area3(const int k, const int j, const int i) const {
+    return Dx1f(i) * Dx2f(j);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION Real Volume(const int k, const int j, const int i) const {
+    return Dx1f(i) * Dx2f(j) * Dx3f(k);
+  }
+
+ private:
+  bool uniform_ = true;
+  int start_[3] = {0, 0, 0};
+  Real xmin_[3] = {0.0, 0.0, 0.0};
+  Real dx_[3] = {1.0, 1.0, 1.0};
+  ParArray1D<Real> x1f_, x2f_, x3f_, dx1f_, dx2f_, dx3f_;
+};
+
+} // namespace parthenon
+
+#endif // COORDINATES_DEVICE_COORDINATES_HPP_
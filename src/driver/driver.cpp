@@ -14,9 +14,20 @@
 
 #include "driver/driver.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#ifdef OPENMP_PARALLEL
+#include <omp.h>
+#endif
+
 #include "mesh/mesh.hpp"
 #include "outputs/outputs.hpp"
 #include "parameter_input.hpp"
+#include "utils/phase_timer.hpp"
+#include "utils/task_timer.hpp"
 #include "utils/utils.hpp"
 
 namespace parthenon {
@@ -27,30 +38,220 @@ DriverStatus EvolutionDriver::Execute() {
          (pmesh->nlim < 0 || pmesh->ncycle < pmesh->nlim)) {
     if (Globals::my_rank == 0) pmesh->OutputCycleDiagnostics();
 
+#ifdef KOKKOS_ENABLE_CUDA_UVM
+    // move the variables the outputs read on the host back before the kernels need them
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      for (auto &v : pmb->real_containers.Get().GetCellVariableVector()) {
+        v->PrefetchToDevice();
+      }
+    }
+#endif
+
     TaskListStatus status = Step();
     if (status != TaskListStatus::complete) {
       std::cerr << "Step failed to complete all tasks." << std::endl;
       return DriverStatus::failed;
     }
     // pmesh->UserWorkInLoop();
+    TaskTimer::Get().EndCycle();
 
     pmesh->ncycle++;
     pmesh->time += pmesh->dt;
     pmesh->mbcnt += pmesh->nbtotal;
     pmesh->step_since_lb++;
 
-    pmesh->LoadBalancingAndAdaptiveMeshRefinement(pinput);
+    {
+      PhaseScope amr(Phase::amr);
+      pmesh->LoadBalancingAndAdaptiveMeshRefinement(pinput);
+    }
 
-    pmesh->NewTimeStep();
-    if (pmesh->time < pmesh->tlim) // skip the final output as it happens later
+    // the time step reduction overlaps the outputs, which only wait for it if they
+    // record dt
+    {
+      PhaseScope communication(Phase::communication);
+      pmesh->StartNewTimeStep();
+    }
+    if (pmesh->time < pmesh->tlim) { // skip the final output as it happens later
+      PhaseScope io(Phase::io);
       pouts->MakeOutputs(pmesh, pinput);
+    }
+    {
+      PhaseScope communication(Phase::communication);
+      pmesh->FinishNewTimeStep();
+    }
+    {
+      PhaseScope io(Phase::io);
+      pmesh->ExecuteInSituAnalyses();
+    }
 
-    // check for signals
+    // check for signals: the wall time alarm, or a scheduler or user stopping the run,
+    // ends the run with a restart dump (see ParthenonManager::PostDriver)
     if (SignalHandler::CheckSignalFlags() != 0) {
-      return DriverStatus::failed;
+      return DriverStatus::timeout;
     }
   } // END OF MAIN INTEGRATION LOOP ======================================================
   return DriverStatus::complete;
 }
 
+namespace DriverUtils {
+
+namespace {
+
+// deque of task list indices owned by one thread; the owner works at the front and
+// thieves take from the back
+class TaskListDeque {
+ public:
+  TaskListDeque() {
+#ifdef OPENMP_PARALLEL
+    omp_init_lock(&lock_);
+#endif
+  }
+  ~TaskListDeque() {
+#ifdef OPENMP_PARALLEL
+    omp_destroy_lock(&lock_);
+#endif
+  }
+  TaskListDeque(const TaskListDeque &) = delete;
+  TaskListDeque &operator=(const TaskListDeque &) = delete;
+
+  void PushBack(int i) {
+    Lock();
+    lists_.push_back(i);
+    Unlock();
+  }
+  bool PopFront(int &i) {
+    Lock();
+    bool found = !lists_.empty();
+    if (found) {
+      i = lists_.front();
+      lists_.pop_front();
+    }
+    Unlock();
+    return found;
+  }
+  bool PopBack(int &i) {
+    Lock();
+    bool found = !lists_.empty();
+    if (found) {
+      i = lists_.back();
+      lists_.pop_back();
+    }
+    Unlock();
+    return found;
+  }
+
+ private:
+  void Lock() {
+#ifdef OPENMP_PARALLEL
+    omp_set_lock(&lock_);
+#endif
+  }
+  void Unlock() {
+#ifdef OPENMP_PARALLEL
+    omp_unset_lock(&lock_);
+#endif
+  }
+
+  std::deque<int> lists_;
+#ifdef OPENMP_PARALLEL
+  omp_lock_t lock_;
+#endif
+};
+
+bool StealTaskList(std::vector<TaskListDeque> &deques, const int thief, int &i) {
+  const int nthreads = deques.size();
+  for (int n = 1; n < nthreads; n++) {
+    if (deques[(thief + n) % nthreads].PopBack(i)) return true;
+  }
+  return false;
+}
+
+} // namespace
+
+TaskListStatus ExecuteTaskLists(std::vector<TaskList> &task_lists, int nthreads) {
+  const int nlists = task_lists.size();
+#ifndef OPENMP_PARALLEL
+  nthreads = 1;
+#endif
+  nthreads = std::max(1, std::min(nthreads, nlists));
+
+  // deal the lists out to the threads in contiguous chunks
+  std::vector<TaskListDeque> deques(nthreads);
+  int ncomplete = 0;
+  // wall time of the passes over the lists, split by whether a task completed
+  const bool timed = PhaseTimer::Get().Enabled();
+  double compute = 0.0, waiting = 0.0;
+  for (int i = 0; i < nlists; i++) {
+    if (task_lists[i].IsComplete())
+      ncomplete++;
+    else
+      deques[i * nthreads / nlists].PushBack(i);
+  }
+
+#pragma omp parallel num_threads(nthreads)
+  {
+#ifdef OPENMP_PARALLEL
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+    // the blocks of the lists dealt to this thread, which stay its own as long as the
+    // blocks do, first touch their data here (<mesh>/numa_first_touch)
+    for (int i = 0; i < nlists; i++) {
+      MeshBlock *pmb = task_lists[i].GetMeshBlock();
+      if (pmb != nullptr && i * nthreads / nlists == tid) pmb->FirstTouchData();
+    }
+    // no list runs before all data are in place
+#pragma omp barrier
+    double my_compute = 0.0, my_waiting = 0.0;
+    while (true) {
+      int done;
+#pragma omp atomic read
+      done = ncomplete;
+      if (done == nlists) break;
+
+      int i;
+      if (!deques[tid].PopFront(i) && !StealTaskList(deques, tid, i)) continue;
+      const int ntasks = task_lists[i].Size();
+      MeshBlock *pmb = task_lists[i].GetMeshBlock();
+      std::chrono::steady_clock::time_point start;
+      if (timed) start = std::chrono::steady_clock::now();
+      if (pmb != nullptr) pmb->StartTimeMeasurement();
+      const TaskListStatus status = task_lists[i].DoAvailable();
+      // a pass in which no task completed only polled for messages, which is waiting
+      // rather than work of the block
+      const bool progress =
+          status == TaskListStatus::complete || task_lists[i].Size() != ntasks;
+      if (pmb != nullptr) pmb->StopTimeMeasurement(progress);
+      if (timed) {
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        (progress ? my_compute : my_waiting) += elapsed.count();
+      }
+      if (status == TaskListStatus::complete) {
+#pragma omp atomic
+        ncomplete++;
+        continue;
+      }
+      deques[tid].PushBack(i);
+      // nothing could run, this block waits on communication: look for work elsewhere
+      int j;
+      if (task_lists[i].Size() == ntasks && StealTaskList(deques, tid, j))
+        deques[tid].PushBack(j);
+    }
+#pragma omp atomic
+    compute += my_compute;
+#pragma omp atomic
+    waiting += my_waiting;
+  }
+  // the threads run concurrently, so each phase gets the average over the threads
+  if (timed) {
+    PhaseTimer::Get().Add(Phase::compute, compute / nthreads);
+    PhaseTimer::Get().Add(Phase::communication, waiting / nthreads);
+  }
+  return TaskListStatus::complete;
+}
+
+} // namespace DriverUtils
+
 } // namespace parthenon
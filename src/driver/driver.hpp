@@ -56,31 +56,21 @@ class EvolutionDriver : public Driver {
 
 namespace DriverUtils {
 
+// Execute the task lists on nthreads threads (<mesh>/num_threads). Every thread owns a
+// deque of task lists that it polls round-robin. A thread whose list made no progress,
+// e.g. because it waits for a message, or whose deque ran empty steals a list from
+// another thread, so that the compute work of all blocks keeps the threads busy.
+TaskListStatus ExecuteTaskLists(std::vector<TaskList> &task_lists, int nthreads);
+
 template <typename T, class... Args>
 TaskListStatus ConstructAndExecuteBlockTasks(T *driver, Args... args) {
-#ifdef OPENMP_PARALLEL
-  int nthreads = driver->pmesh->GetNumMeshThreads();
-#endif
-  int nmb = driver->pmesh->GetNumMeshBlocksThisRank(Globals::my_rank);
   std::vector<TaskList> task_lists;
-  MeshBlock *pmb = driver->pmesh->pblock;
-  while (pmb != nullptr) {
+  task_lists.reserve(driver->pmesh->block_list.size());
+  for (MeshBlock *pmb : driver->pmesh->block_list) {
     task_lists.push_back(driver->MakeTaskList(pmb, std::forward<Args>(args)...));
-    pmb = pmb->next;
-  }
-  int complete_cnt = 0;
-  while (complete_cnt != nmb) {
-    // TODO(pgrete): need to let Kokkos::PartitionManager handle this
-    for (auto i = 0; i < nmb; ++i) {
-      if (!task_lists[i].IsComplete()) {
-        auto status = task_lists[i].DoAvailable();
-        if (status == TaskListStatus::complete) {
-          complete_cnt++;
-        }
-      }
-    }
+    task_lists.back().SetMeshBlock(pmb);
   }
-  return TaskListStatus::complete;
+  return ExecuteTaskLists(task_lists, driver->pmesh->GetNumMeshThreads());
 }
 
 } // namespace DriverUtils
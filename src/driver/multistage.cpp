@@ -14,52 +14,389 @@
 
 #include "driver/multistage.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bvals/boundary_conditions.hpp"
+#include "bvals/bvals.hpp"
+#include "interface/container.hpp"
+#include "interface/update.hpp"
+
 namespace parthenon {
 
+Integrator::Integrator(const std::vector<StageWeights> &stage_wghts)
+    : nstages(stage_wghts.size()), nregisters(1), stage_wghts(stage_wghts) {
+  for (const auto &w : stage_wghts) {
+    if (w.delta != 0.0 || w.gam2 != 0.0) nregisters = std::max(nregisters, 2);
+    if (w.gam3 != 0.0) nregisters = 3;
+  }
+  // run the stages on the coefficients of the registers in terms of the initial state
+  // (entry 0) and the F of the stages (entries 1 to nstages)
+  std::vector<Real> s1(nstages + 1, 0.0), s2(nstages + 1, 0.0), s3(nstages + 1, 0.0);
+  s1[0] = 1.0;
+  for (int n = 0; n < nstages; n++) {
+    const StageWeights &w = stage_wghts[n];
+    // with F = 1 and a zero initial state, S1 is the time
+    stage_time.push_back(std::accumulate(s1.begin() + 1, s1.end(), 0.0));
+    for (int m = 0; m <= nstages; m++) {
+      s2[m] = (n == 0 ? 0.0 : s2[m]) + w.delta * s1[m];
+      if (n == 0) s3[m] = s1[m];
+      s1[m] = w.gam1 * s1[m] + w.gam2 * s2[m] + w.gam3 * s3[m];
+    }
+    s1[n + 1] += w.beta;
+  }
+  flux_wghts.assign(s1.begin() + 1, s1.end());
+}
+
 MultiStageDriver::MultiStageDriver(ParameterInput *pin, Mesh *pm, Outputs *pout)
     : EvolutionDriver(pin, pm, pout) {
   pmesh = pm;
   std::string integrator_name = pin->GetOrAddString("time", "integrator", "rk2");
-  int nstages = 2; // default rk2
 
-  std::vector<Real> beta;
+  // {delta, gam1, gam2, gam3, beta} of each stage, see StageWeights
+  std::vector<StageWeights> stage_wghts;
   if (!integrator_name.compare("rk1")) {
-    nstages = 1;
-    beta.resize(nstages);
-    beta[0] = 1.0;
+    stage_wghts = {{0.0, 1.0, 0.0, 0.0, 1.0}};
   } else if (!integrator_name.compare("rk2")) {
-    nstages = 2;
-    beta.resize(nstages);
-    beta[0] = 1.0;
-    beta[1] = 0.5;
+    // Heun's method, SSPRK(2,2)
+    stage_wghts = {{1.0, 0.0, 1.0, 0.0, 1.0}, {0.0, 0.5, 0.5, 0.0, 0.5}};
   } else if (!integrator_name.compare("rk3")) {
-    nstages = 3;
-    beta.resize(nstages);
-    beta[0] = 1.0;
-    beta[1] = 0.25;
-    beta[2] = 2.0 / 3.0;
+    // SSPRK(3,3) of Shu & Osher
+    stage_wghts = {{1.0, 0.0, 1.0, 0.0, 1.0},
+                   {0.0, 0.25, 0.75, 0.0, 0.25},
+                   {0.0, 2.0 / 3.0, 1.0 / 3.0, 0.0, 2.0 / 3.0}};
+  } else if (!integrator_name.compare("rk4")) {
+    // RK4()4[2S] of Ketcheson (2010), Table 2: two registers
+    stage_wghts = {
+        {1.0, 0.0, 1.0, 0.0, 1.193743905974738},
+        {0.217683334308543, 0.121098479554482, 0.721781678111411, 0.0,
+         0.099279895495783},
+        {1.065841341361089, -3.843833699660025, 2.121209265338722, 0.0,
+         1.131678018054042},
+        {0.0, 0.546370891121863, 0.198653035682705, 0.0, 0.310665766509336}};
+  } else if (!integrator_name.compare("ssprk5_4")) {
+    // SSPRK(5,4) of Spiteri & Ruuth (2002) in 3S* form: S3 holds the initial state and
+    // S2 the result of the second stage, the only other one the last stage needs once
+    // its F(u3) term is rewritten in terms of u0, u3 and u4
+    stage_wghts = {
+        {0.0, 0.0, 0.0, 1.0, 0.391752226571890},
+        {0.0, 0.555629506348765, 0.0, 0.444370493651235, 0.368410593050371},
+        {0.517231671970585, 0.379898148511597, 0.0, 0.620101851488403,
+         0.251891774271694},
+        {0.0, 0.821920045606868, 0.0, 0.178079954393132, 0.544974750228521},
+        {0.0, 0.503580947165482, 1.0, -0.020812619136066, 0.226007483236906}};
   } else {
     throw std::invalid_argument("Invalid selection for the time integrator: " +
                                 integrator_name);
   }
 
-  integrator = new Integrator(nstages, beta);
-  stage_name.resize(nstages + 1);
-  stage_name[0] = "base";
-  for (int i = 1; i < nstages; i++) {
-    stage_name[i] = std::to_string(i);
+  integrator = new Integrator(stage_wghts);
+  register_name.resize(integrator->nregisters);
+  register_name[0] = "base";
+  for (int i = 1; i < integrator->nregisters; i++) {
+    register_name[i] = std::to_string(i);
+  }
+
+  deep_halo = pin->GetOrAddBoolean("time", "deep_halo", false);
+  halo_width = pin->GetOrAddInteger("time", "halo_width", NGHOST / integrator->nstages);
+  if (deep_halo) {
+    if (halo_width < 1 || integrator->nstages * halo_width > NGHOST) {
+      throw std::invalid_argument(
+          "<time>/deep_halo needs 1 <= halo_width <= NGHOST/nstages, but NGHOST = " +
+          std::to_string(NGHOST) + ", nstages = " + std::to_string(integrator->nstages) +
+          " and halo_width = " + std::to_string(halo_width) +
+          "; reconfigure with a larger NUMBER_GHOST_CELLS");
+    }
+    // the extended stages leave no room for prolongation and flux correction
+    if (pm->multilevel) {
+      throw std::invalid_argument(
+          "<time>/deep_halo is not supported with mesh refinement");
+    }
+  }
+}
+
+MultiStageBlockTaskDriver::MultiStageBlockTaskDriver(ParameterInput *pin, Mesh *pm,
+                                                     Outputs *pout)
+    : MultiStageDriver(pin, pm, pout),
+      persistent_task_lists_(
+          pin->GetOrAddBoolean("time", "persistent_task_lists", false)),
+      task_lists_generation_(), subcycled_step_(false) {
+  if (pm->subcycling && persistent_task_lists_) {
+    throw std::invalid_argument(
+        "<time>/subcycling does not support <time>/persistent_task_lists");
   }
-  stage_name[nstages] = stage_name[0];
+  // the aggregated messages of a rank always include all of its neighbors
+  if (pm->subcycling && pm->paggcomm != nullptr) {
+    throw std::invalid_argument(
+        "<time>/subcycling does not support <mesh>/aggregate_messages");
+  }
+}
+
+DriverStatus MultiStageBlockTaskDriver::Execute() {
+  DriverStatus status = EvolutionDriver::Execute();
+  // the persistent lists keep the containers of the blocks and with them the MPI
+  // requests of the boundary variables alive, release them while MPI still is
+  task_lists_.clear();
+  return status;
 }
 
 TaskListStatus MultiStageBlockTaskDriver::Step() {
   using DriverUtils::ConstructAndExecuteBlockTasks;
+  subcycled_step_ =
+      pmesh->subcycling && pmesh->GetCurrentLevel() > pmesh->GetRootLevel();
+  if (subcycled_step_) return SubcycledStep();
   TaskListStatus status;
+  if (!persistent_task_lists_) {
+    for (int stage = 1; stage <= integrator->nstages; stage++) {
+      status = ConstructAndExecuteBlockTasks<>(this, stage);
+      if (status != TaskListStatus::complete) break;
+    }
+    return status;
+  }
+
+  // the lists of a stage are built right before their first execution, as in the
+  // non-persistent case, and rebuilt after every change of the mesh
+  const bool rebuild = task_lists_.empty() ||
+                       task_lists_generation_ != pmesh->mesh_generation;
+  if (rebuild) {
+    task_lists_.clear();
+    task_lists_.resize(integrator->nstages);
+    task_lists_generation_ = pmesh->mesh_generation;
+  }
   for (int stage = 1; stage <= integrator->nstages; stage++) {
-    status = ConstructAndExecuteBlockTasks<>(this, stage);
+    std::vector<TaskList> &task_lists = task_lists_[stage - 1];
+    if (rebuild || task_lists.empty()) {
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        task_lists.push_back(MakeTaskList(pmb, stage));
+        task_lists.back().SetMeshBlock(pmb);
+      }
+    } else {
+      for (auto &tl : task_lists) {
+        tl.Restart();
+      }
+    }
+    status = DriverUtils::ExecuteTaskLists(task_lists, pmesh->GetNumMeshThreads());
+    if (status != TaskListStatus::complete) break;
+  }
+  return status;
+}
+
+TaskListStatus MultiStageBlockTaskDriver::SubcycledStep() {
+  // level root + l takes a step with every 2^(L - l)-th of the 2^L steps of the finest
+  const int root = pmesh->GetRootLevel();
+  const int nlevel = pmesh->GetCurrentLevel() - root;
+  TaskListStatus status = TaskListStatus::complete;
+  for (int s = 0; s < (1 << nlevel); s++) {
+    for (int l = 0; l <= nlevel; l++) {
+      if (s % (1 << (nlevel - l)) != 0) continue;
+      status = StepLevel(root + l, (s >> (nlevel - l)) & 1);
+      if (status != TaskListStatus::complete) return status;
+      if (l < nlevel) {
+        status = HandOff(root + l);
+        if (status != TaskListStatus::complete) return status;
+      }
+    }
+    // the finer of two levels is synchronized with the next finer one first
+    for (int l = nlevel - 1; l >= 0; l--) {
+      if ((s + 1) % (1 << (nlevel - l)) != 0) continue;
+      status = Synchronize(root + l);
+      if (status != TaskListStatus::complete) return status;
+    }
+  }
+
+  std::vector<TaskList> task_lists;
+  for (MeshBlock *pmb : pmesh->block_list) {
+    pmb->pbval->ResetSubcycling();
+    task_lists.push_back(MakeCycleEndTaskList(pmb));
+    task_lists.back().SetMeshBlock(pmb);
+  }
+  return DriverUtils::ExecuteTaskLists(task_lists, pmesh->GetNumMeshThreads());
+}
+
+namespace {
+
+bool HasNeighborOnLevel(MeshBlock *pmb, const int level) {
+  for (int n = 0; n < pmb->pbval->nneighbor; n++) {
+    if (pmb->pbval->neighbor[n].snb.level == level) return true;
+  }
+  return false;
+}
+
+// adds a task on the "base" container, the state, of pmb
+TaskID AddBaseTask(TaskList &tl, MeshBlock *pmb, const std::string &name,
+                   const std::function<TaskStatus(Container<Real> &)> &func,
+                   const TaskID dep) {
+  return tl.AddTask<BlockTask>(
+      TaskName(name), [func](MeshBlock *pmb) { return func(pmb->real_containers.Get()); },
+      dep, pmb);
+}
+
+// receives, sets and prolongates the ghost zones of pmb after dep
+TaskID AddReceiveTasks(TaskList &tl, MeshBlock *pmb, TaskID dep) {
+  using C = Container<Real>;
+  auto recv =
+      AddBaseTask(tl, pmb, "ReceiveBoundaryBuffers", C::ReceiveBoundaryBuffersTask, dep);
+  auto set = AddBaseTask(tl, pmb, "SetBoundaries", C::SetBoundariesTask, recv);
+  AddBaseTask(tl, pmb, "ClearBoundary", C::ClearBoundaryTask, set);
+  auto prolong = tl.AddTask<BlockTask>(
+      TaskName("ProlongateBoundaries"),
+      [](MeshBlock *pmb) {
+        pmb->pbval->ProlongateBoundaries(0.0, 0.0);
+        return TaskStatus::complete;
+      },
+      set, pmb);
+  auto set_bc =
+      AddBaseTask(tl, pmb, "ApplyBoundaryConditions", ApplyBoundaryConditions, prolong);
+  return AddBaseTask(tl, pmb, "FillDerived", FillDerivedVariables::FillDerived, set_bc);
+}
+
+} // namespace
+
+TaskListStatus MultiStageBlockTaskDriver::StepLevel(const int level, const int half) {
+  const bool has_coarser = level > pmesh->GetRootLevel();
+  std::vector<MeshBlock *> blocks;
+  for (MeshBlock *pmb : pmesh->block_list) {
+    if (pmb->loc.level != level) continue;
+    blocks.push_back(pmb);
+    pmb->pbval->send_levels = pmb->pbval->recv_levels = LevelMask{false, true, false};
+  }
+  const int nstages = integrator->nstages;
+  TaskListStatus status = TaskListStatus::complete;
+  for (int stage = 1; stage <= nstages; stage++) {
+    // the coarse ghost zones at the time the next stage starts from
+    const Real next = (stage < nstages) ? integrator->stage_time[stage] : 1.0;
+    std::vector<TaskList> task_lists;
+    for (MeshBlock *pmb : blocks) {
+      pmb->pbval->flux_register_weight =
+          integrator->flux_wghts[stage - 1] * pmesh->LevelDt(level);
+      pmb->pbval->coarse_time_fraction = has_coarser ? 0.5 * (half + next) : -1.0;
+      task_lists.push_back(MakeTaskList(pmb, stage));
+      task_lists.back().SetMeshBlock(pmb);
+    }
+    status = DriverUtils::ExecuteTaskLists(task_lists, pmesh->GetNumMeshThreads());
     if (status != TaskListStatus::complete) break;
   }
   return status;
 }
 
+TaskListStatus MultiStageBlockTaskDriver::HandOff(const int level) {
+  using C = Container<Real>;
+  using CoarseTime = BoundaryValues::CoarseTime;
+  std::vector<TaskList> task_lists;
+  for (MeshBlock *pmb : pmesh->block_list) {
+    BoundaryValues *pbval = pmb->pbval.get();
+    pbval->flux_register_weight = 0.0;
+    pbval->coarse_time_fraction = -1.0;
+    TaskList tl;
+    TaskID none(0);
+    if (pmb->loc.level == level && HasNeighborOnLevel(pmb, level + 1)) {
+      pbval->send_levels = LevelMask{false, false, true};
+      pbval->recv_levels = LevelMask{false, false, false};
+      auto send = AddBaseTask(tl, pmb, "SendBoundaryBuffers", C::SendBoundaryBuffersTask,
+                              none);
+      AddBaseTask(tl, pmb, "ClearBoundary", C::ClearBoundaryTask, send);
+    } else if (pmb->loc.level == level + 1 && HasNeighborOnLevel(pmb, level)) {
+      pbval->send_levels = LevelMask{false, false, false};
+      pbval->recv_levels = LevelMask{true, false, false};
+      // the coarse data at the start of the step of level, from the last exchange
+      auto start_recv =
+          AddBaseTask(tl, pmb, "StartReceiving", C::StartReceivingTask, none);
+      auto store_start = tl.AddTask<BlockTask>(
+          TaskName("StoreCoarseBoundaries"),
+          [](MeshBlock *pmb) {
+            pmb->pbval->StoreCoarseBoundaries(CoarseTime::start);
+            return TaskStatus::complete;
+          },
+          none, pmb);
+      auto recv = AddBaseTask(tl, pmb, "ReceiveBoundaryBuffers",
+                              C::ReceiveBoundaryBuffersTask, start_recv);
+      auto set =
+          AddBaseTask(tl, pmb, "SetBoundaries", C::SetBoundariesTask, recv | store_start);
+      auto store_end = tl.AddTask<BlockTask>(
+          TaskName("StoreCoarseBoundaries"),
+          [](MeshBlock *pmb) {
+            pmb->pbval->StoreCoarseBoundaries(CoarseTime::end);
+            return TaskStatus::complete;
+          },
+          set, pmb);
+      AddBaseTask(tl, pmb, "ClearBoundary", C::ClearBoundaryTask, set);
+      // the ghost zones at the start of the step
+      auto prolong = tl.AddTask<BlockTask>(
+          TaskName("ProlongateBoundaries"),
+          [](MeshBlock *pmb) {
+            pmb->pbval->coarse_time_fraction = 0.0;
+            pmb->pbval->ProlongateBoundaries(0.0, 0.0);
+            return TaskStatus::complete;
+          },
+          store_end, pmb);
+      auto set_bc = AddBaseTask(tl, pmb, "ApplyBoundaryConditions",
+                                ApplyBoundaryConditions, prolong);
+      AddBaseTask(tl, pmb, "FillDerived", FillDerivedVariables::FillDerived, set_bc);
+    } else {
+      continue;
+    }
+    task_lists.push_back(std::move(tl));
+    task_lists.back().SetMeshBlock(pmb);
+  }
+  return DriverUtils::ExecuteTaskLists(task_lists, pmesh->GetNumMeshThreads());
+}
+
+TaskListStatus MultiStageBlockTaskDriver::Synchronize(const int level) {
+  using C = Container<Real>;
+  std::vector<TaskList> task_lists;
+  for (MeshBlock *pmb : pmesh->block_list) {
+    BoundaryValues *pbval = pmb->pbval.get();
+    pbval->flux_register_weight = 0.0;
+    pbval->coarse_time_fraction = -1.0;
+    TaskList tl;
+    TaskID none(0);
+    if (pmb->loc.level == level) {
+      // corrected for the fluxes of the finer neighbors, the block sends its boundaries
+      // to its neighbors on the same level as well
+      pbval->send_levels = pbval->recv_levels = LevelMask{false, true, true};
+      auto start_recv =
+          AddBaseTask(tl, pmb, "StartReceiving", C::StartReceivingTask, none);
+      auto recv_flux = AddBaseTask(tl, pmb, "ReceiveFluxCorrection",
+                                   C::ReceiveFluxCorrectionTask, start_recv);
+      auto reflux = AddBaseTask(
+          tl, pmb, "Reflux",
+          [](C &rc) {
+            rc.Reflux();
+            return TaskStatus::complete;
+          },
+          recv_flux);
+      auto send =
+          AddBaseTask(tl, pmb, "SendBoundaryBuffers", C::SendBoundaryBuffersTask, reflux);
+      AddReceiveTasks(tl, pmb, send);
+    } else if (pmb->loc.level == level + 1 && HasNeighborOnLevel(pmb, level)) {
+      // the time integrated fluxes and the restricted state go to the coarser neighbors
+      pbval->send_levels = pbval->recv_levels = LevelMask{true, false, false};
+      auto start_recv =
+          AddBaseTask(tl, pmb, "StartReceiving", C::StartReceivingTask, none);
+      auto load = AddBaseTask(
+          tl, pmb, "LoadFluxRegisters",
+          [](C &rc) {
+            rc.LoadFluxRegisters();
+            return TaskStatus::complete;
+          },
+          start_recv);
+      auto send_flux = AddBaseTask(tl, pmb, "SendFluxCorrection",
+                                   C::SendFluxCorrectionTask, load);
+      auto send = AddBaseTask(tl, pmb, "SendBoundaryBuffers", C::SendBoundaryBuffersTask,
+                              send_flux);
+      AddReceiveTasks(tl, pmb, send);
+    } else {
+      continue;
+    }
+    task_lists.push_back(std::move(tl));
+    task_lists.back().SetMeshBlock(pmb);
+  }
+  return DriverUtils::ExecuteTaskLists(task_lists, pmesh->GetNumMeshThreads());
+}
+
 } // namespace parthenon
@@ -14,6 +14,7 @@
 #ifndef DRIVER_MULTISTAGE_HPP_
 #define DRIVER_MULTISTAGE_HPP_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -23,32 +24,99 @@
 
 namespace parthenon {
 
+// Weights of one stage of a low-storage (Ketcheson 3S*) Runge-Kutta scheme. The state
+// lives in register S1; S2 is an accumulator cleared at the start of each cycle and S3
+// holds the state at the start of the cycle. Each stage performs
+//   S2 = S2 + delta * S1
+//   S1 = gam1 * S1 + gam2 * S2 + gam3 * S3 + beta * dt * F(S1)
+// in one pass over the cells, see Update::LowStorageUpdate. On the first stage S2 is
+// cleared, so that it becomes delta * S1.
+struct StageWeights {
+  Real delta, gam1, gam2, gam3, beta;
+};
+
 struct Integrator {
   Integrator() = default;
-  Integrator(int nstages, std::vector<Real> beta) : nstages(nstages), beta(beta) {}
+  explicit Integrator(const std::vector<StageWeights> &stage_wghts);
   int nstages;
-  std::vector<Real> beta;
+  // number of registers the scheme reads, 1 (S1 only), 2 (2S schemes) or 3 (3S*)
+  int nregisters;
+  std::vector<StageWeights> stage_wghts;
+  // the time at which each stage evaluates F, as a fraction of dt, and the weights b_s
+  // with which the stages add up over the step, S1 = S1 + dt * sum_s b_s F_s. The time
+  // interpolation and the flux registers of subcycled levels use them.
+  std::vector<Real> stage_time, flux_wghts;
 };
 
 class MultiStageDriver : public EvolutionDriver {
  public:
   MultiStageDriver(ParameterInput *pin, Mesh *pm, Outputs *pout);
-  std::vector<std::string> stage_name;
+  // container names of the registers S1, S2, S3; the state S1 is always "base"
+  std::vector<std::string> register_name;
   Integrator *integrator;
   ~MultiStageDriver() { delete integrator; }
 
+  // With <time>/deep_halo the ghost zones are exchanged only after the last stage of a
+  // cycle. Every earlier stage then also updates the ghost cells that the following
+  // stages read, halo_width (the widest stencil of a stage) fewer per stage, which
+  // needs NGHOST >= nstages * halo_width.
+  bool deep_halo;
+  int halo_width;
+  // number of ghost cells by which the update region of stage is extended
+  int StageExtension(const int stage) const {
+    return deep_halo ? (integrator->nstages - stage) * halo_width : 0;
+  }
+  // whether the ghost zones have to be exchanged at the end of stage
+  bool ExchangeAfterStage(const int stage) const {
+    return !deep_halo || stage == integrator->nstages;
+  }
+
  private:
 };
 
 class MultiStageBlockTaskDriver : public MultiStageDriver {
  public:
-  MultiStageBlockTaskDriver(ParameterInput *pin, Mesh *pm, Outputs *pout)
-      : MultiStageDriver(pin, pm, pout) {}
+  MultiStageBlockTaskDriver(ParameterInput *pin, Mesh *pm, Outputs *pout);
+  DriverStatus Execute();
   TaskListStatus Step();
   // An application driver that derives from this class must define this
   // function, which defines the application specific list of tasks and
   // there dependencies that must be executed.
   virtual TaskList MakeTaskList(MeshBlock *pmb, int stage) = 0;
+
+  // With <time>/subcycling and refined blocks in the mesh, Step() advances each level
+  // with its own time step, Mesh::LevelDt(), finest level first within each step of the
+  // next coarser one, and synchronizes two levels whenever their steps end together.
+  // The stages then only exchange with neighbors on the same level, and the last stage
+  // of a level no longer ends the cycle: the tasks that do, e.g. the time step estimate,
+  // belong in MakeCycleEndTaskList(), which runs once all levels are done.
+  bool CycleEndsWithStage(const int stage) const {
+    return stage == integrator->nstages && !subcycled_step_;
+  }
+  virtual TaskList MakeCycleEndTaskList(MeshBlock *pmb) { return TaskList(); }
+
+ protected:
+  // With <time>/persistent_task_lists the task lists of every block and stage are built
+  // once and replayed in later cycles until the mesh changes. MakeTaskList() then must
+  // not capture anything that changes from cycle to cycle.
+  const bool persistent_task_lists_;
+
+ private:
+  std::vector<std::vector<TaskList>> task_lists_; // [stage - 1][block]
+  std::uint64_t task_lists_generation_;
+
+  // whether the current Step() subcycles the levels
+  bool subcycled_step_;
+  TaskListStatus SubcycledStep();
+  // all stages of the blocks of level, in the first (half = 0) or second (half = 1) half
+  // of the step of the next coarser level
+  TaskListStatus StepLevel(const int level, const int half);
+  // sends the data of the blocks of level, one step further, to their finer neighbors,
+  // which interpolate their ghost zones in time from then on
+  TaskListStatus HandOff(const int level);
+  // corrects the blocks of level for the fluxes of their finer neighbors, which have
+  // caught up with them, and exchanges the boundaries of both levels
+  TaskListStatus Synchronize(const int level);
 };
 
 } // namespace parthenon
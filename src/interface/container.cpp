@@ -15,11 +15,13 @@
 
 #include <cstdlib>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
 #include "bvals/cc/bvals_cc.hpp"
 #include "mesh/mesh.hpp"
+#include "utils/profiling.hpp"
 
 namespace parthenon {
 
@@ -61,6 +63,17 @@ void Container<T>::Add(const std::string label, const Metadata &metadata,
                        const std::vector<int> dims) {
   std::array<int, 6> arrDims;
   calcArrDims_(arrDims, dims, metadata);
+  ClearCaches_();
+
+  // the framework evolves, restores and refines Independent variables through data,
+  // which is only a copy of the storage of a ComponentInnermost variable
+  if (metadata.IsSet(Metadata::ComponentInnermost) &&
+      (metadata.Where() != Metadata::Cell || metadata.IsSet(Metadata::Independent) ||
+       metadata.IsSet(Metadata::Sparse))) {
+    throw std::invalid_argument("Variable " + label + ": ComponentInnermost is only "
+                                "supported for dense cell variables that are not "
+                                "Independent");
+  }
 
   // branch on kind of variable
   if (metadata.IsSet(Metadata::Sparse)) {
@@ -102,6 +115,7 @@ void Container<T>::Add(const std::string label, const Metadata &metadata,
     faceMap_[label] = pfv;
   } else {
     auto sv = std::make_shared<CellVariable<T>>(label, arrDims, metadata);
+    varIndex_[label] = varVector_.size();
     varVector_.push_back(sv);
     varMap_[label] = sv;
     if (metadata.IsSet(Metadata::FillGhost)) {
@@ -110,10 +124,50 @@ void Container<T>::Add(const std::string label, const Metadata &metadata,
   }
 }
 
+template <typename T>
+const CellVariableVector<T> &
+Container<T>::GetVariablesByFlag(const std::vector<MetadataFlag> &flagVector) const {
+  for (auto &entry : flagCache_) {
+    if (entry.first == flagVector) return entry.second;
+  }
+  const MetadataFlagMask mask(flagVector);
+  CellVariableVector<T> vars;
+  for (auto &v : varVector_) {
+    if (v->metadata().AnyFlagsSet(mask)) vars.push_back(v);
+  }
+  for (auto &sv : sparseVector_) {
+    for (auto &v : sv->GetVector()) {
+      if (v->metadata().AnyFlagsSet(mask)) vars.push_back(v);
+    }
+  }
+  flagCache_.emplace_back(flagVector, std::move(vars));
+  return flagCache_.back().second;
+}
+
+template <typename T>
+void Container<T>::AllocateSlab() {
+  const CellVariableVector<T> &vars = GetVariablesByFlag({Metadata::Independent});
+  int size = 0;
+  for (auto &v : vars) {
+    size += v->data.GetSize();
+  }
+  if (size == 0) return;
+  slab_ = ParArrayND<T>("slab", size);
+  int offset = 0;
+  for (auto &v : vars) {
+    v->MoveToSlab(slab_, offset);
+    offset += v->data.GetSize();
+  }
+}
+
 // provides a container that has a single sparse slice
 template <typename T>
-Container<T> Container<T>::SparseSlice(int id) {
-  Container<T> c;
+Container<T> &Container<T>::SparseSlice(int id) {
+  auto cached = sliceCache_.find(id);
+  if (cached != sliceCache_.end()) return *(cached->second);
+  auto pc = std::make_shared<Container<T>>();
+  sliceCache_[id] = pc;
+  Container<T> &c = *pc;
 
   // copy in private data
   c.pmy_block = pmy_block;
@@ -121,6 +175,7 @@ Container<T> Container<T>::SparseSlice(int id) {
   // Note that all standard arrays get added
   // add standard arrays
   for (auto v : varVector_) {
+    c.varIndex_[v->label()] = c.varVector_.size();
     c.varVector_.push_back(v);
     c.varMap_[v->label()] = v;
   }
@@ -139,6 +194,7 @@ Container<T> Container<T>::SparseSlice(int id) {
     if (index >= 0) {
       CellVariable<T> &vmat = v->Get(id);
       auto sv = std::make_shared<CellVariable<T>>(vmat);
+      c.varIndex_[v->label()] = c.varVector_.size();
       c.varVector_.push_back(sv);
       c.varMap_[v->label()] = sv;
     }
@@ -151,13 +207,26 @@ Container<T> Container<T>::SparseSlice(int id) {
 // Maybe do only one loop, or do the cleanup at the end.
 template <typename T>
 void Container<T>::Remove(const std::string label) {
+  ClearCaches_();
   throw std::runtime_error("Container<T>::Remove not yet implemented");
 }
 
+// the flux correction exchanges the fluxes in all directions, including the ones no
+// task has asked for (and thereby allocated) yet
+template <typename T>
+static void AllocateFluxes(CellVariable<T> &v, const int ndim) {
+  for (int dir = 0; dir < ndim; dir++) {
+    v.GetFlux(dir);
+  }
+}
+
 template <typename T>
 void Container<T>::SendFluxCorrection() {
+  ProfilingRegion region("Container::SendFluxCorrection");
+  const int ndim = pmy_block->pmy_mesh->ndim;
   for (auto &v : varVector_) {
     if (v->IsSet(Metadata::Independent)) {
+      AllocateFluxes(*v, ndim);
       v->vbvar->SendFluxCorrection();
     }
   }
@@ -165,6 +234,7 @@ void Container<T>::SendFluxCorrection() {
     if ((sv->IsSet(Metadata::Independent))) {
       CellVariableVector<T> vvec = sv->GetVector();
       for (auto &v : vvec) {
+        AllocateFluxes(*v, ndim);
         v->vbvar->SendFluxCorrection();
       }
     }
@@ -173,9 +243,12 @@ void Container<T>::SendFluxCorrection() {
 
 template <typename T>
 bool Container<T>::ReceiveFluxCorrection() {
+  ProfilingRegion region("Container::ReceiveFluxCorrection");
+  const int ndim = pmy_block->pmy_mesh->ndim;
   int success = 0, total = 0;
   for (auto &v : varVector_) {
     if (v->IsSet(Metadata::Independent)) {
+      AllocateFluxes(*v, ndim);
       if (v->vbvar->ReceiveFluxCorrection()) success++;
       total++;
     }
@@ -184,6 +257,7 @@ bool Container<T>::ReceiveFluxCorrection() {
     if (sv->IsSet(Metadata::Independent)) {
       CellVariableVector<T> vvec = sv->GetVector();
       for (auto &v : vvec) {
+        AllocateFluxes(*v, ndim);
         if (v->vbvar->ReceiveFluxCorrection()) success++;
         total++;
       }
@@ -193,26 +267,50 @@ bool Container<T>::ReceiveFluxCorrection() {
 }
 
 template <typename T>
-void Container<T>::SendBoundaryBuffers() {
-  // sends the boundary
-  debug = 0;
-  //  std::cout << "_________SEND from stage:"<<s->name()<<std::endl;
+void Container<T>::LoadFluxRegisters() {
   for (auto &v : varVector_) {
-    if (v->IsSet(Metadata::FillGhost)) {
+    if (v->IsSet(Metadata::Independent)) v->vbvar->LoadFluxRegisters();
+  }
+  for (auto &sv : sparseVector_) {
+    if (sv->IsSet(Metadata::Independent)) {
+      CellVariableVector<T> vvec = sv->GetVector();
+      for (auto &v : vvec) {
+        v->vbvar->LoadFluxRegisters();
+      }
+    }
+  }
+}
+
+// corrects the variables of this container
+template <typename T>
+void Container<T>::Reflux() {
+  for (auto &v : varVector_) {
+    if (v->IsSet(Metadata::Independent)) {
       v->resetBoundary();
-      v->vbvar->SendBoundaryBuffers();
+      v->vbvar->Reflux();
     }
   }
   for (auto &sv : sparseVector_) {
-    if (sv->IsSet(Metadata::FillGhost)) {
+    if (sv->IsSet(Metadata::Independent)) {
       CellVariableVector<T> vvec = sv->GetVector();
       for (auto &v : vvec) {
         v->resetBoundary();
-        v->vbvar->SendBoundaryBuffers();
+        v->vbvar->Reflux();
       }
     }
   }
+  // the exchange that follows sends the corrected cells
+  pmy_block->exec_space.fence();
+}
 
+template <typename T>
+void Container<T>::SendBoundaryBuffers() {
+  ProfilingRegion region("Container::SendBoundaryBuffers");
+  // sends the boundary
+  debug = 0;
+  //  std::cout << "_________SEND from stage:"<<s->name()<<std::endl;
+  CellCenteredBoundaryVariable::SendBoundaryBuffersFused(pmy_block,
+                                                         GetFillGhostBoundaries_());
   return;
 }
 
@@ -239,6 +337,7 @@ void Container<T>::SetupPersistentMPI() {
 
 template <typename T>
 bool Container<T>::ReceiveBoundaryBuffers() {
+  ProfilingRegion region("Container::ReceiveBoundaryBuffers");
   bool ret;
   //  std::cout << "_________RECV from stage:"<<s->name()<<std::endl;
   ret = true;
@@ -274,6 +373,7 @@ bool Container<T>::ReceiveBoundaryBuffers() {
 
 template <typename T>
 void Container<T>::ReceiveAndSetBoundariesWithWait() {
+  ProfilingRegion region("Container::ReceiveAndSetBoundariesWithWait");
   //  std::cout << "_________RSET from stage:"<<s->name()<<std::endl;
   for (auto &v : varVector_) {
     if ((!v->mpiStatus) && v->IsSet(Metadata::FillGhost)) {
@@ -301,38 +401,25 @@ void Container<T>::ReceiveAndSetBoundariesWithWait() {
 // bloat.
 template <typename T>
 void Container<T>::SetBoundaries() {
+  ProfilingRegion region("Container::SetBoundaries");
   //    std::cout << "in set" << std::endl;
   // sets the boundary
   //  std::cout << "_________BSET from stage:"<<s->name()<<std::endl;
-  for (auto &v : varVector_) {
-    if (v->IsSet(Metadata::FillGhost)) {
-      v->resetBoundary();
-      v->vbvar->SetBoundaries();
-    }
-  }
-  for (auto &sv : sparseVector_) {
-    if (sv->IsSet(Metadata::FillGhost)) {
-      CellVariableVector<T> vvec = sv->GetVector();
-      for (auto &v : vvec) {
-        v->resetBoundary();
-        v->vbvar->SetBoundaries();
-      }
-    }
-  }
+  CellCenteredBoundaryVariable::SetBoundariesFused(pmy_block, GetFillGhostBoundaries_());
 }
 
 template <typename T>
 void Container<T>::ResetBoundaryCellVariables() {
   for (auto &v : varVector_) {
     if (v->IsSet(Metadata::FillGhost)) {
-      v->vbvar->var_cc = v->data;
+      v->resetBoundary();
     }
   }
   for (auto &sv : sparseVector_) {
     if (sv->IsSet(Metadata::FillGhost)) {
       CellVariableVector<T> vvec = sv->GetVector();
       for (auto &v : vvec) {
-        v->vbvar->var_cc = v->data;
+        v->resetBoundary();
       }
     }
   }
@@ -382,6 +469,30 @@ void Container<T>::ClearBoundary(BoundaryCommSubset phase) {
   }
 }
 
+// repoint the boundary variables of all FillGhost variables at the data of this
+// container and collect them, in the order of the per-variable loops above
+template <typename T>
+std::vector<std::shared_ptr<CellCenteredBoundaryVariable>>
+Container<T>::GetFillGhostBoundaries_() {
+  std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> bvars;
+  for (auto &v : varVector_) {
+    if (v->IsSet(Metadata::FillGhost)) {
+      v->resetBoundary();
+      bvars.push_back(v->vbvar);
+    }
+  }
+  for (auto &sv : sparseVector_) {
+    if (sv->IsSet(Metadata::FillGhost)) {
+      CellVariableVector<T> vvec = sv->GetVector();
+      for (auto &v : vvec) {
+        v->resetBoundary();
+        bvars.push_back(v->vbvar);
+      }
+    }
+  }
+  return bvars;
+}
+
 template <typename T>
 void Container<T>::Print() {
   std::cout << "Variables are:\n";
@@ -13,9 +13,11 @@
 #ifndef INTERFACE_CONTAINER_HPP_
 #define INTERFACE_CONTAINER_HPP_
 
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -56,11 +58,13 @@ class Container {
   /// We can initialize a container with slices from a different
   /// container.  For variables that have the sparse tag, this will
   /// return the sparse slice.  All other variables are added as
-  /// is. This call returns a new container.
+  /// is.  The slice is built on the first request for a sparse id and
+  /// cached until a variable is added to or removed from this container,
+  /// so the returned reference is only valid until then.
   ///
   /// @param sparse_id The sparse id
-  /// @return New container with slices from all variables
-  Container<T> SparseSlice(int sparse_id);
+  /// @return Container with slices from all variables
+  Container<T> &SparseSlice(int sparse_id);
 
   ///
   /// Set the pointer to the mesh block for this container
@@ -119,34 +123,60 @@ class Container {
   void Add(const std::vector<std::string> labelVector, const Metadata &metadata);
 
   void Add(std::shared_ptr<CellVariable<T>> var) {
+    varIndex_[var->label()] = varVector_.size();
     varVector_.push_back(var);
     varMap_[var->label()] = var;
+    ClearCaches_();
   }
   void Add(std::shared_ptr<FaceVariable<T>> var) {
     faceVector_.push_back(var);
     faceMap_[var->label()] = var;
+    ClearCaches_();
   }
   void Add(std::shared_ptr<SparseVariable<T>> var) {
     sparseVector_.push_back(var);
     sparseMap_[var->label()] = var;
+    ClearCaches_();
   }
 
   //
   // Queries related to CellVariable objects
   //
   const CellVariableVector<T> &GetCellVariableVector() const { return varVector_; }
-  const MapToCellVars<T> GetCellVariableMap() const { return varMap_; }
-  CellVariable<T> &Get(std::string label) {
-    auto it = varMap_.find(label);
-    if (it == varMap_.end()) {
+  const MapToCellVars<T> &GetCellVariableMap() const { return varMap_; }
+  CellVariable<T> &Get(const std::string &label) {
+    auto it = varIndex_.find(label);
+    if (it == varIndex_.end()) {
       throw std::invalid_argument(std::string("\n") + std::string(label) +
                                   std::string(" array not found in Get()\n"));
     }
-    return *(it->second);
+    return *(varVector_[it->second]);
   }
 
+  ///
+  /// Integer handles to cell variables.  Index() resolves a label once to a
+  /// position in GetCellVariableVector(), after which Get(index) is a plain
+  /// array access.  Handles stay valid until a variable is removed.
+  ///
+  /// @param label the name of the variable
+  /// @return the handle, or -1 if there is no such cell variable
+  int Index(const std::string &label) const {
+    auto it = varIndex_.find(label);
+    return (it == varIndex_.end()) ? -1 : it->second;
+  }
   CellVariable<T> &Get(const int index) { return *(varVector_[index]); }
 
+  ///
+  /// The cell variables, including the members of sparse variables, that have any
+  /// of the given flags set.  The list is built on the first request for a given flag
+  /// vector and cached until a variable is added to or removed from the container, so
+  /// the returned reference is only valid until then.
+  ///
+  /// @param flagVector the Metadata flags to match
+  /// @return the matching variables in container order
+  const CellVariableVector<T> &
+  GetVariablesByFlag(const std::vector<MetadataFlag> &flagVector) const;
+
   int Index(const std::string &label) {
     for (int i = 0; i < varVector_.size(); i++) {
       if (!varVector_[i]->label().compare(label)) return i;
@@ -157,8 +187,8 @@ class Container {
   //
   // Queries related to SparseVariable objects
   //
-  const SparseVector<T> GetSparseVector() const { return sparseVector_; }
-  const MapToSparse<T> GetSparseMap() const { return sparseMap_; }
+  const SparseVector<T> &GetSparseVector() const { return sparseVector_; }
+  const MapToSparse<T> &GetSparseMap() const { return sparseMap_; }
   SparseVariable<T> &GetSparseVariable(const std::string &label) {
     auto it = sparseMap_.find(label);
     if (it == sparseMap_.end()) {
@@ -187,7 +217,7 @@ class Container {
   // Queries related to FaceVariable objects
   //
   const FaceVector<T> &GetFaceVector() const { return faceVector_; }
-  const MapToFace<T> GetFaceMap() const { return faceMap_; }
+  const MapToFace<T> &GetFaceMap() const { return faceMap_; }
   FaceVariable<T> &GetFace(std::string label) {
     auto it = faceMap_.find(label);
     if (it == faceMap_.end()) {
@@ -224,6 +254,16 @@ class Container {
                        std::map<std::string, std::pair<int, int>> &indexCount,
                        const std::vector<int> &sparse_ids = {});
 
+  ///
+  /// Move all Metadata::Independent cell variables, including the members of
+  /// sparse variables, into one contiguous allocation (the slab), each variable
+  /// becoming a view of its own range of it.  Call once all variables are added.
+  void AllocateSlab();
+
+  /// The storage of the Independent variables if AllocateSlab() was called, so that a
+  /// block's whole state can be copied at once; empty otherwise
+  const ParArrayND<T> &GetSlab() const { return slab_; }
+
   ///
   /// Remove a variable from the container or throw exception if not
   /// found.
@@ -247,6 +287,9 @@ class Container {
   void ClearBoundary(BoundaryCommSubset phase);
   void SendFluxCorrection();
   bool ReceiveFluxCorrection();
+  // the flux registers of subcycled levels, see CellCenteredBoundaryVariable
+  void LoadFluxRegisters();
+  void Reflux();
   static TaskStatus StartReceivingTask(Container<T> &rc) {
     rc.StartReceiving(BoundaryCommSubset::all);
     return TaskStatus::complete;
@@ -276,6 +319,10 @@ class Container {
     return TaskStatus::complete;
   }
 
+  // whether the variables flagged OnDemand are up to date, see
+  // FillDerivedVariables::FillOnDemand
+  bool on_demand_current = false;
+
   bool operator==(const Container<T> &cmp) {
     // do some kind of check of equality
     // do the two containers contain the same named fields?
@@ -312,9 +359,25 @@ class Container {
   MapToCellVars<T> varMap_ = {};
   MapToFace<T> faceMap_ = {};
   MapToSparse<T> sparseMap_ = {};
+  std::unordered_map<std::string, int> varIndex_ = {}; ///< label -> varVector_ index
+  ParArrayND<T> slab_; ///< storage of the Independent variables, see AllocateSlab()
+
+  // filtered variable lists handed out by GetVariablesByFlag(), keyed on the flags.
+  // There are only a handful of distinct flag vectors, so a linear search is enough;
+  // a list keeps references to earlier entries valid while new ones are added.
+  mutable std::list<std::pair<std::vector<MetadataFlag>, CellVariableVector<T>>>
+      flagCache_ = {};
+  // slices handed out by SparseSlice(), keyed on the sparse id
+  std::unordered_map<int, std::shared_ptr<Container<T>>> sliceCache_ = {};
+
+  void ClearCaches_() {
+    flagCache_.clear();
+    sliceCache_.clear();
+  }
 
   void calcArrDims_(std::array<int, 6> &arrDims, const std::vector<int> &dims,
                     const Metadata &metadata);
+  std::vector<std::shared_ptr<CellCenteredBoundaryVariable>> GetFillGhostBoundaries_();
 };
 
 } // namespace parthenon
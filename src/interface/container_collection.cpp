@@ -15,6 +15,8 @@
 
 #include <string>
 
+#include "mesh/mesh.hpp"
+
 namespace parthenon {
 
 template <typename T>
@@ -36,7 +38,7 @@ void ContainerCollection<T>::Add(const std::string &name, Container<T> &src) {
       // just copy the (shared) pointer
       c->Add(v);
     } else {
-      // allocate new storage
+      // new storage, recycled from the stage arrays of the ArrayPool if possible
       c->Add(v->AllocateCopy());
     }
   }
@@ -61,6 +63,20 @@ void ContainerCollection<T>::Add(const std::string &name, Container<T> &src) {
   containers_[name] = c;
 }
 
+template <typename T>
+void ContainerCollection<T>::PurgeNonBase() {
+  MeshBlock *pmb = containers_["base"]->pmy_block;
+  if (pmb != nullptr) pmb->kernel_graphs.clear();
+  auto c = containers_.begin();
+  while (c != containers_.end()) {
+    if (c->first != "base") {
+      c = containers_.erase(c);
+    } else {
+      ++c;
+    }
+  }
+}
+
 template class ContainerCollection<Real>;
 
 } // namespace parthenon
@@ -40,17 +40,24 @@ class ContainerCollection {
     return *(it->second);
   }
 
-  void PurgeNonBase() {
-    auto c = containers_.begin();
-    while (c != containers_.end()) {
-      if (c->first != "base") {
-        c = containers_.erase(c);
-      } else {
-        ++c;
-      }
+  std::size_t Size() const { return containers_.size(); }
+  // all containers by name, "base" and the stage containers
+  const std::map<std::string, std::shared_ptr<Container<T>>> &GetAll() const {
+    return containers_;
+  }
+
+  // the name of container c, or an empty string if c is not in the collection
+  std::string Label(const Container<T> &c) const {
+    for (auto &entry : containers_) {
+      if (entry.second.get() == &c) return entry.first;
     }
+    return std::string();
   }
 
+  // the arrays of the purged stage containers go back to the ArrayPool, and the block
+  // drops its kernel graphs, which run on them
+  void PurgeNonBase();
+
   void Print() {
     for (auto &c : containers_) {
       std::cout << "Container " << c.first << " has:" << std::endl;
@@ -31,55 +31,22 @@ namespace parthenon {
 template <typename T>
 class ContainerIterator {
  public:
-  /// the subset of variables that match this iterator
-  CellVariableVector<T> vars;
+  /// the subset of variables that match this iterator.  This is the list cached by
+  /// the container, valid until variables are added to or removed from it.
+  const CellVariableVector<T> &vars;
   // std::vector<FaceVariable> varsFace; // face vars that match
   // std::vector<EdgeVariable> varsEdge; // edge vars that match
 
   /// initializes the iterator with a container and a flag to match
   /// @param c the container on which you want the iterator
   /// @param flagVector: a vector of Metadata::flags that you want to match
-  ContainerIterator<T>(const Container<T> &c,
-                       const std::vector<MetadataFlag> &flagVector) {
-    // c.print();
-    auto allVars = c.GetCellVariableVector();
-    for (auto &svar : c.GetSparseVector()) {
-      CellVariableVector<T> &svec = svar->GetVector();
-      allVars.insert(allVars.end(), svec.begin(), svec.end());
-    }
+  ContainerIterator<T>(const Container<T> &c, const std::vector<MetadataFlag> &flagVector)
+      : vars(c.GetVariablesByFlag(flagVector)) {
     // faces not active yet    _allFaceVars = c.faceVars();
     // edges not active yet    _allEdgeVars = c.edgeVars();
-    setMask(allVars, flagVector); // fill subset based on mask vector
-  }
-
-  //~ContainerIterator<T>() {
-  //  _emptyVars();
-  //}
-  /// Changes the mask for the iterator and resets the iterator
-  /// @param flagArray: a vector of MetadataFlag that you want to match
-  void setMask(const CellVariableVector<T> &allVars,
-               const std::vector<MetadataFlag> &flagVector) {
-    // 1: clear out variables stored so far
-    _emptyVars();
-
-    // 2: fill in the subset of variables that match mask
-    for (auto pv : allVars) {
-      if (pv->metadata().AnyFlagsSet(flagVector)) {
-        vars.push_back(pv);
-      }
-    }
   }
 
  private:
-  uint64_t _mask;
-  FaceVector<T> _allFaceVars = {};
-  // EdgeVector<T> _allEdgeVars = {};
-  // CellVariableVector<T> _allVars = {};
-  void _emptyVars() {
-    vars.clear();
-    //  varsFace.clear();
-    //  varsEdge.clear();
-  }
   static bool couldBeEdge(const std::vector<MetadataFlag> &flagVector) {
     // returns true if face is set or if no topology set
     for (auto &f : flagVector) {
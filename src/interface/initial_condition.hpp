@@ -0,0 +1,216 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef INTERFACE_INITIAL_CONDITION_HPP_
+#define INTERFACE_INITIAL_CONDITION_HPP_
+//! \file initial_condition.hpp
+//  \brief initial data set on the device for all blocks of a rank from a function of
+//  position, as an alternative to host loops in MeshBlock::ProblemGenerator
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+#include "coordinates/coordinates.hpp"
+#include "coordinates/device_coordinates.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "interface/state_descriptor.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/gl_quadrature.hpp"
+
+namespace parthenon {
+
+namespace InitialCondition {
+
+// Sets all cells, including ghost cells, of the cell variable var_name in container
+// stage_name of every block of the rank in a single launch. f is a device functor
+//   Real f(const int n, const Real x1, const Real x2, const Real x3)
+// returning component n of the variable at the position (x1, x2, x3). With
+// gl_order > 1 each cell gets the average of f over the cell instead, computed with the
+// gl_order-point Gauss-Legendre rule of utils/gl_quadrature.hpp in each direction of
+// the mesh, which resolves discontinuous initial data to second order.
+template <typename F>
+void SetOnMesh(Mesh *pmesh, const std::string &var_name, const F &f,
+               const int gl_order = 0, const std::string &stage_name = "base");
+// As SetOnMesh with gl_order = N, for the cells of one block only, e.g. from
+// MeshBlock::ProblemGenerator. The number of nodes is a compile-time constant,
+// 1 <= N <= 8 (see GaussLegendre::Rule), and all cells are set in a single launch.
+template <int N, typename F>
+void SetOnBlock(MeshBlock *pmb, const std::string &var_name, const F &f,
+                const std::string &stage_name = "base");
+// Registers SetOnMesh(pmesh, var_name, f, gl_order) with the package, so that
+// Mesh::Initialize applies it to new (not restarted) runs after the ProblemGenerator;
+// gl_order is at most GaussLegendre::max_order
+template <typename F>
+void Enroll(const std::shared_ptr<StateDescriptor> &pkg, const std::string &var_name,
+            const F &f, const int gl_order = 0);
+
+// the average of f(n, x1, x2, x3) over cell (k, j, i) with the N-point rule in the first
+// ndim directions; collapsed directions are sampled once at the cell center
+template <int N, typename F>
+KOKKOS_INLINE_FUNCTION Real CellAverage(const F &f, const int n,
+                                        const DeviceCoordinates &c, const int ndim,
+                                        const int k, const int j, const int i) {
+  const Real x1l = c.X1f(i), x1u = x1l + c.Dx1f(i);
+  const Real x2l = c.X2f(j), x2u = x2l + c.Dx2f(j);
+  const Real x3l = c.X3f(k), x3u = x3l + c.Dx3f(k);
+  if (ndim == 1) {
+    const Real x2 = 0.5 * (x2l + x2u), x3 = 0.5 * (x3l + x3u);
+    return GaussLegendre::integrate<N>([&](const Real x1) { return f(n, x1, x2, x3); },
+                                       x1l, x1u) /
+           (x1u - x1l);
+  }
+  if (ndim == 2) {
+    const Real x3 = 0.5 * (x3l + x3u);
+    return GaussLegendre::integrate<N>(
+               [&](const Real x1, const Real x2) { return f(n, x1, x2, x3); }, x1l,
+               x1u, x2l, x2u) /
+           ((x1u - x1l) * (x2u - x2l));
+  }
+  auto f3 = [&](const Real x1, const Real x2, const Real x3) { return f(n, x1, x2, x3); };
+  return GaussLegendre::integrate<N>(f3, x1l, x1u, x2l, x2u, x3l, x3u) /
+         ((x1u - x1l) * (x2u - x2l) * (x3u - x3l));
+}
+
+template <int N, typename F>
+void SetOnMeshAveraged(const MeshBlockPack<Real> &q,
+                       const ParArray1D<DeviceCoordinates> &coords, const int ndim,
+                       const F &f) {
+  par_for(
+      "InitialCondition::SetOnMeshAveraged", DevSpace(), 0, q.GetNBlocks() - 1, 0,
+      q.GetNVars() - 1, 0, q.GetDim(3) - 1, 0, q.GetDim(2) - 1, 0, q.GetDim(1) - 1,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        q(b, n, k, j, i) = CellAverage<N>(f, n, coords(b), ndim, k, j, i);
+      });
+}
+
+template <typename F>
+void SetOnMesh(Mesh *pmesh, const std::string &var_name, const F &f,
+               const int gl_order, const std::string &stage_name) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (pmb == nullptr) return;
+  auto q = PackVariablesOnMesh(pmesh, stage_name, std::vector<std::string>({var_name}));
+  auto coords = PackCoordinatesOnMesh(pmesh);
+  const int nk = q.GetDim(3), nj = q.GetDim(2), ni = q.GetDim(1);
+
+  if (gl_order <= 1) {
+    par_for(
+        "InitialCondition::SetOnMesh", DevSpace(), 0, q.GetNBlocks() - 1, 0,
+        q.GetNVars() - 1, 0, nk - 1, 0, nj - 1, 0, ni - 1,
+        KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+          const auto &c = coords(b);
+          q(b, n, k, j, i) = f(n, c.X1v(i), c.X2v(j), c.X3v(k));
+        });
+    return;
+  }
+
+  // the common orders unroll with the node tables of GaussLegendre::Rule
+  const int ndim = pmesh->ndim;
+  switch (gl_order) {
+  case 2:
+    return SetOnMeshAveraged<2>(q, coords, ndim, f);
+  case 3:
+    return SetOnMeshAveraged<3>(q, coords, ndim, f);
+  case 4:
+    return SetOnMeshAveraged<4>(q, coords, ndim, f);
+  case 5:
+    return SetOnMeshAveraged<5>(q, coords, ndim, f);
+  case 6:
+    return SetOnMeshAveraged<6>(q, coords, ndim, f);
+  case 7:
+    return SetOnMeshAveraged<7>(q, coords, ndim, f);
+  case 8:
+    return SetOnMeshAveraged<8>(q, coords, ndim, f);
+  }
+
+  std::vector<Real> abscissa, weight;
+  GaussLegendre::Nodes(gl_order, abscissa, weight);
+  ParArray1D<Real> xq("InitialCondition abscissae", gl_order);
+  ParArray1D<Real> wq("InitialCondition weights", gl_order);
+  auto xq_h = Kokkos::create_mirror_view(xq);
+  auto wq_h = Kokkos::create_mirror_view(wq);
+  for (int m = 0; m < gl_order; m++) {
+    xq_h(m) = abscissa[m];
+    wq_h(m) = weight[m];
+  }
+  Kokkos::deep_copy(xq, xq_h);
+  Kokkos::deep_copy(wq, wq_h);
+
+  // collapsed directions are sampled once at the cell center with unit weight
+  const int n1 = gl_order;
+  const int n2 = (ndim >= 2 ? gl_order : 1);
+  const int n3 = (ndim >= 3 ? gl_order : 1);
+  par_for(
+      "InitialCondition::SetOnMeshAveraged", DevSpace(), 0, q.GetNBlocks() - 1, 0,
+      q.GetNVars() - 1, 0, nk - 1, 0, nj - 1, 0, ni - 1,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        const auto &c = coords(b);
+        const Real hdx1 = 0.5 * c.Dx1f(i), hdx2 = 0.5 * c.Dx2f(j);
+        const Real hdx3 = 0.5 * c.Dx3f(k);
+        const Real x1c = c.X1f(i) + hdx1, x2c = c.X2f(j) + hdx2;
+        const Real x3c = c.X3f(k) + hdx3;
+        Real sum = 0.0, wsum = 0.0;
+        for (int m3 = 0; m3 < n3; m3++) {
+          const Real x3 = (n3 > 1 ? x3c + hdx3 * xq(m3) : x3c);
+          const Real w3 = (n3 > 1 ? wq(m3) : 1.0);
+          for (int m2 = 0; m2 < n2; m2++) {
+            const Real x2 = (n2 > 1 ? x2c + hdx2 * xq(m2) : x2c);
+            const Real w23 = w3 * (n2 > 1 ? wq(m2) : 1.0);
+            for (int m1 = 0; m1 < n1; m1++) {
+              const Real w = w23 * wq(m1);
+              sum += w * f(n, x1c + hdx1 * xq(m1), x2, x3);
+              wsum += w;
+            }
+          }
+        }
+        q(b, n, k, j, i) = sum / wsum;
+      });
+}
+
+template <int N, typename F>
+void SetOnBlock(MeshBlock *pmb, const std::string &var_name, const F &f,
+                const std::string &stage_name) {
+  auto q = pmb->real_containers.Get(stage_name).Get(var_name).data.Get<4>();
+  const DeviceCoordinates c = pmb->pcoord->GetDeviceCoordinates();
+  const int ndim = pmb->pmy_mesh->ndim;
+  pmb->par_for(
+      "InitialCondition::SetOnBlock", 0, q.extent_int(0) - 1, 0, q.extent_int(1) - 1, 0,
+      q.extent_int(2) - 1, 0, q.extent_int(3) - 1,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        q(n, k, j, i) = CellAverage<N>(f, n, c, ndim, k, j, i);
+      });
+}
+
+template <typename F>
+void Enroll(const std::shared_ptr<StateDescriptor> &pkg, const std::string &var_name,
+            const F &f, const int gl_order) {
+  if (gl_order > GaussLegendre::max_order) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in InitialCondition::Enroll" << std::endl
+        << "gl_order=" << gl_order << " of variable " << var_name << " exceeds the "
+        << GaussLegendre::max_order << " nodes of the largest Gauss-Legendre rule"
+        << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  pkg->InitialConditions.push_back(
+      [var_name, f, gl_order](Mesh *pmesh) { SetOnMesh(pmesh, var_name, f, gl_order); });
+}
+
+} // namespace InitialCondition
+
+} // namespace parthenon
+
+#endif // INTERFACE_INITIAL_CONDITION_HPP_
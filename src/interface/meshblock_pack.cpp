@@ -0,0 +1,137 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include "interface/meshblock_pack.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "coordinates/coordinates.hpp"
+#include "interface/container.hpp"
+#include "mesh/mesh.hpp"
+
+namespace parthenon {
+
+namespace {
+
+// dir < 0 packs the variables themselves, otherwise their fluxes in direction dir.
+// get_vars returns the variables to pack from the container of each block. The pack is
+// taken from Mesh::pack_cache unless the blocks or the arrays changed since it was built.
+template <typename F>
+MeshBlockPack<Real> PackOnMesh(Mesh *pmesh, const std::string &stage_name, const int dir,
+                               const F &get_vars) {
+  // the kernels over the pack run on the default execution space instance
+  pmesh->FenceExecSpaces();
+  if (pmesh->pblock == nullptr) return MeshBlockPack<Real>();
+  std::string key = stage_name + "/" + std::to_string(dir);
+  int nvar = 0;
+  std::array<int, 3> dims = {{0, 0, 0}};
+  for (auto &v : get_vars(pmesh->pblock->real_containers.Get(stage_name))) {
+    // the pack refers to data, which is only a copy of such a variable
+    if (v->IsSet(Metadata::ComponentInnermost)) {
+      throw std::invalid_argument(v->label() +
+                                  " is stored component innermost and cannot be packed");
+    }
+    key += "/" + v->label();
+    nvar += v->GetDim(4);
+    dims = {{v->GetDim(1), v->GetDim(2), v->GetDim(3)}};
+  }
+
+  // the component arrays of every block, in pack order
+  std::vector<const Real *> arrays;
+  int nblocks = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next, nblocks++) {
+    for (auto &v : get_vars(pmb->real_containers.Get(stage_name))) {
+      const ParArrayND<Real> &arr = (dir < 0) ? v->data : v->GetFlux(dir);
+      for (int l = 0; l < v->GetDim(4); l++) {
+        arrays.push_back(arr.Get(0, 0, l).data());
+      }
+    }
+  }
+  auto cached = pmesh->pack_cache.find(key);
+  if (cached != pmesh->pack_cache.end() &&
+      cached->second.generation == pmesh->mesh_generation &&
+      cached->second.arrays == arrays) {
+    return cached->second.pack;
+  }
+
+  ParArray2D<ParArray3D<Real>> packed("MeshBlockPack", nblocks, nvar);
+  auto packed_h = Kokkos::create_mirror_view(packed);
+  for (int b = 0; b < nblocks; b++) {
+    for (int n = 0; n < nvar; n++) {
+      // unmanaged, so that the cache does not keep the arrays alive
+      packed_h(b, n) = ParArray3D<Real>(const_cast<Real *>(arrays[b * nvar + n]),
+                                        dims[2], dims[1], dims[0]);
+    }
+  }
+  Kokkos::deep_copy(packed, packed_h);
+  Mesh::CachedPack &entry = pmesh->pack_cache[key];
+  entry.generation = pmesh->mesh_generation;
+  entry.arrays = std::move(arrays);
+  entry.pack = MeshBlockPack<Real>(packed, dims);
+  return entry.pack;
+}
+
+} // namespace
+
+MeshBlockPack<Real> PackVariablesOnMesh(Mesh *pmesh, const std::string &stage_name,
+                                        const std::vector<MetadataFlag> &flags) {
+  return PackOnMesh(pmesh, stage_name, -1,
+                    [&flags](Container<Real> &rc) -> const CellVariableVector<Real> & {
+                      return rc.GetVariablesByFlag(flags);
+                    });
+}
+
+MeshBlockPack<Real> PackVariablesOnMesh(Mesh *pmesh, const std::string &stage_name,
+                                        const std::vector<std::string> &names) {
+  return PackOnMesh(pmesh, stage_name, -1, [&names](Container<Real> &rc) {
+    CellVariableVector<Real> vars;
+    for (auto &name : names) {
+      const int h = rc.Index(name);
+      if (h < 0) {
+        throw std::invalid_argument(name + " is not a cell variable of the container");
+      }
+      vars.push_back(rc.GetCellVariableVector()[h]);
+    }
+    return vars;
+  });
+}
+
+MeshBlockPack<Real> PackFluxesOnMesh(Mesh *pmesh, const std::string &stage_name,
+                                     const std::vector<MetadataFlag> &flags,
+                                     const int dir) {
+  return PackOnMesh(pmesh, stage_name, dir,
+                    [&flags](Container<Real> &rc) -> const CellVariableVector<Real> & {
+                      return rc.GetVariablesByFlag(flags);
+                    });
+}
+
+ParArray1D<DeviceCoordinates> PackCoordinatesOnMesh(Mesh *pmesh) {
+  int nblocks = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    nblocks++;
+  }
+  ParArray1D<DeviceCoordinates> coords("MeshBlockPack coords", nblocks);
+  auto coords_h = Kokkos::create_mirror_view(coords);
+  int b = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next, b++) {
+    coords_h(b) = pmb->pcoord->GetDeviceCoordinates();
+  }
+  Kokkos::deep_copy(coords, coords_h);
+  return coords;
+}
+
+} // namespace parthenon
@@ -0,0 +1,78 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_MESHBLOCK_PACK_HPP_
+#define INTERFACE_MESHBLOCK_PACK_HPP_
+//! \file meshblock_pack.hpp
+//  \brief views of the same variables on all MeshBlocks of a rank, so that a single
+//         kernel launch covers the whole rank instead of one launch per block
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+#include "coordinates/device_coordinates.hpp"
+#include "interface/metadata.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+class Mesh;
+
+//----------------------------------------------------------------------------------------
+//! \class MeshBlockPack
+//  \brief a view of views indexed by (block, component, k, j, i). The blocks are in the
+//  order of the Mesh::pblock list and the components are those of the packed variables,
+//  in container order. Meant to be iterated with the 5D par_for.
+
+template <typename T>
+class MeshBlockPack {
+ public:
+  MeshBlockPack() = default;
+  MeshBlockPack(const ParArray2D<ParArray3D<T>> &v, const std::array<int, 3> &dims)
+      : v_(v), dims_(dims), nblocks_(v.extent_int(0)), nvar_(v.extent_int(1)) {}
+
+  KOKKOS_FORCEINLINE_FUNCTION
+  const ParArray3D<T> &operator()(const int b, const int n) const { return v_(b, n); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  T &operator()(const int b, const int n, const int k, const int j, const int i) const {
+    return v_(b, n)(k, j, i);
+  }
+
+  KOKKOS_FORCEINLINE_FUNCTION int GetNBlocks() const { return nblocks_; }
+  KOKKOS_FORCEINLINE_FUNCTION int GetNVars() const { return nvar_; }
+  // extent of each component in direction i (1), j (2) or k (3), same for all blocks
+  KOKKOS_FORCEINLINE_FUNCTION int GetDim(const int i) const { return dims_[i - 1]; }
+
+ private:
+  ParArray2D<ParArray3D<T>> v_;
+  std::array<int, 3> dims_ = {{0, 0, 0}};
+  int nblocks_ = 0, nvar_ = 0;
+};
+
+// all components of the variables matching flags in container stage_name of every block
+MeshBlockPack<Real> PackVariablesOnMesh(Mesh *pmesh, const std::string &stage_name,
+                                        const std::vector<MetadataFlag> &flags);
+// the named cell variables in container stage_name of every block, in the given order
+MeshBlockPack<Real> PackVariablesOnMesh(Mesh *pmesh, const std::string &stage_name,
+                                        const std::vector<std::string> &names);
+// the fluxes of the variables matching flags in direction dir (X1DIR, X2DIR or X3DIR)
+MeshBlockPack<Real> PackFluxesOnMesh(Mesh *pmesh, const std::string &stage_name,
+                                     const std::vector<MetadataFlag> &flags,
+                                     const int dir);
+// the geometry of every block, in the block order of the packs above
+ParArray1D<DeviceCoordinates> PackCoordinatesOnMesh(Mesh *pmesh);
+
+} // namespace parthenon
+
+#endif // INTERFACE_MESHBLOCK_PACK_HPP_
@@ -14,7 +14,8 @@
 #define INTERFACE_METADATA_HPP_
 
 #include <algorithm>
-#include <bitset>
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <stdexcept>
 #include <string>
@@ -63,12 +64,20 @@
   PARTHENON_INTERNAL_FOR_FLAG(Independent)                                               \
   /** is a derived quantity (ignored) */                                                 \
   PARTHENON_INTERNAL_FOR_FLAG(Derived)                                                   \
+  /** derived quantity only computed when read, see FillDerivedVariables::FillOnDemand */\
+  PARTHENON_INTERNAL_FOR_FLAG(OnDemand)                                                  \
   /** only one copy even if multiple stages */                                           \
   PARTHENON_INTERNAL_FOR_FLAG(OneCopy)                                                   \
   /** Do boundary communication */                                                       \
   PARTHENON_INTERNAL_FOR_FLAG(FillGhost)                                                 \
+  /** ghost data is communicated in single precision */                                 \
+  PARTHENON_INTERNAL_FOR_FLAG(SinglePrecisionComm)                                       \
+  /** components are stored innermost, in CellVariable::strided */                       \
+  PARTHENON_INTERNAL_FOR_FLAG(ComponentInnermost)                                        \
   /** Communication arrays are a copy: hint to destructor */                             \
-  PARTHENON_INTERNAL_FOR_FLAG(SharedComms)
+  PARTHENON_INTERNAL_FOR_FLAG(SharedComms)                                               \
+  /** an integer rather than a real value of the particles of a swarm */                 \
+  PARTHENON_INTERNAL_FOR_FLAG(Integer)
 
 namespace parthenon {
 
@@ -117,12 +126,92 @@ class MetadataFlag {
 #endif
 
  private:
+  friend class MetadataFlagMask;
+
   // MetadataFlag can only be instantiated by Metadata
   constexpr explicit MetadataFlag(int flag) : flag_(flag) {}
 
+  // position of the flag in the words of a MetadataFlagMask
+  constexpr int Word() const { return flag_ / 64; }
+  constexpr uint64_t Bit() const { return uint64_t(1) << (flag_ % 64); }
+
   int flag_;
 };
 
+/// A set of flags stored as a bitmask. The first 128 flags, i.e., all built-in flags and
+/// the first user flags, are held inline and only further user flags go to an overflow
+/// vector, so that a query is a few AND operations without touching the heap. A mask
+/// built once from a list of flags tests a Metadata for any of them with one AND per
+/// word, see Metadata::AnyFlagsSet.
+class MetadataFlagMask {
+ public:
+  MetadataFlagMask() = default;
+  explicit MetadataFlagMask(const std::vector<MetadataFlag> &flags) {
+    for (auto const &f : flags) {
+      Set(f, true);
+    }
+  }
+
+  void Set(MetadataFlag f, bool value) {
+    uint64_t *word;
+    if (f.Word() < ninline) {
+      word = &words_[f.Word()];
+    } else {
+      if (f.Word() - ninline >= static_cast<int>(overflow_.size())) {
+        if (!value) return;
+        overflow_.resize(f.Word() - ninline + 1, 0);
+      }
+      word = &overflow_[f.Word() - ninline];
+    }
+    *word = value ? (*word | f.Bit()) : (*word & ~f.Bit());
+  }
+
+  bool IsSet(MetadataFlag f) const { return (GetWord(f.Word()) & f.Bit()) != 0; }
+
+  /// returns true if any flag is set in both masks
+  bool Intersects(const MetadataFlagMask &other) const {
+    if ((words_[0] & other.words_[0]) || (words_[1] & other.words_[1])) return true;
+    auto const n = std::min(overflow_.size(), other.overflow_.size());
+    for (size_t w = 0; w < n; w++) {
+      if (overflow_[w] & other.overflow_[w]) return true;
+    }
+    return false;
+  }
+
+  /// returns one past the highest set flag
+  int NumBits() const {
+    for (int w = ninline + static_cast<int>(overflow_.size()) - 1; w >= 0; w--) {
+      const uint64_t word = GetWord(w);
+      for (int b = 63; b >= 0; b--) {
+        if (word & (uint64_t(1) << b)) return 64 * w + b + 1;
+      }
+    }
+    return 0;
+  }
+
+  bool operator==(const MetadataFlagMask &other) const {
+    const int n = ninline + static_cast<int>(
+                                std::max(overflow_.size(), other.overflow_.size()));
+    for (int w = 0; w < n; w++) {
+      if (GetWord(w) != other.GetWord(w)) return false;
+    }
+    return true;
+  }
+  bool operator!=(const MetadataFlagMask &other) const { return !(*this == other); }
+
+ private:
+  static constexpr int ninline = 2;
+
+  uint64_t GetWord(const int w) const {
+    if (w < ninline) return words_[w];
+    const int o = w - ninline;
+    return (o < static_cast<int>(overflow_.size())) ? overflow_[o] : 0;
+  }
+
+  std::array<uint64_t, ninline> words_ = {{0, 0}};
+  std::vector<uint64_t> overflow_;
+};
+
 /// @brief
 ///
 /// The metadata class is a descriptor for variables in the
@@ -208,8 +297,8 @@ class Metadata {
   /// Returns the attribute flags as a string of 1/0
   std::string MaskAsString() const {
     std::string str;
-    for (auto const bit : bits_) {
-      str += bit ? '1' : '0';
+    for (int i = 0; i < bits_.NumBits(); i++) {
+      str += bits_.IsSet(MetadataFlag(i)) ? '1' : '0';
     }
     return str;
   }
@@ -222,33 +311,18 @@ class Metadata {
                        [this](MetadataFlag const &f) { return IsSet(f); });
   }
 
+  /// Returns true if any flag of the mask is set. Prefer this over the vector version
+  /// when testing many variables for the same flags.
+  bool AnyFlagsSet(MetadataFlagMask const &mask) const { return bits_.Intersects(mask); }
+
   /// returns true if bit is set, false otherwise
-  bool IsSet(MetadataFlag bit) const {
-    return bit.flag_ < bits_.size() && bits_[bit.flag_];
-  }
+  bool IsSet(MetadataFlag bit) const { return bits_.IsSet(bit); }
 
   // Operators
   bool operator==(const Metadata &b) const {
     auto const &a = *this;
-
-    // Check extra bits are unset
-    auto const min_bits = std::min(a.bits_.size(), b.bits_.size());
-    auto const &longer = a.bits_.size() > b.bits_.size() ? a.bits_ : b.bits_;
-    for (auto i = min_bits; i < longer.size(); i++) {
-      if (longer[i]) {
-        // Bits are default false, so if any bit in the extraneous portion of the longer
-        // bit list is set, then it cannot be equal to a.
-        return false;
-      }
-    }
-
-    for (size_t i = 0; i < min_bits; i++) {
-      if (a.bits_[i] != b.bits_[i]) {
-        return false;
-      }
-    }
-
-    return std::tie(a.shape_, a.sparse_id_) == std::tie(b.shape_, b.sparse_id_);
+    return a.bits_ == b.bits_ &&
+           std::tie(a.shape_, a.sparse_id_) == std::tie(b.shape_, b.sparse_id_);
   }
 
   bool operator!=(const Metadata &b) const { return !(*this == b); }
@@ -258,7 +332,7 @@ class Metadata {
 
  private:
   /// the attribute flags that are set for the class
-  std::vector<bool> bits_;
+  MetadataFlagMask bits_;
   std::vector<int> shape_;
   std::string associated_;
   int sparse_id_;
@@ -313,12 +387,7 @@ class Metadata {
   }
 
   /// if flag is true set bit, clears otherwise
-  void DoBit(MetadataFlag bit, bool flag) {
-    if (bit.flag_ >= bits_.size()) {
-      bits_.resize(bit.flag_ + 1);
-    }
-    bits_[bit.flag_] = flag;
-  }
+  void DoBit(MetadataFlag bit, bool flag) { bits_.Set(bit, flag); }
 
   /// Checks if the bit is a topology bit
   bool IsTopology(MetadataFlag bit) const {
@@ -13,23 +13,48 @@
 #ifndef INTERFACE_PARAMS_HPP_
 #define INTERFACE_PARAMS_HPP_
 
-#ifndef DEBUG_
-#define DEBUG_ 0
-#endif
-
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
-#if (DEBUG_ > 0)
-#include <typeindex>
-#include <typeinfo>
-#endif
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
 
 namespace parthenon {
 
+class Params;
+
+/// A typed reference to a parameter as returned by Params::Add. Dereferencing it costs a
+/// pointer load, without the key lookup and type check of Params::Get, so it can be
+/// kept, e.g., by a package and used in task bodies. It stays valid until the Params
+/// are reset or destroyed.
+template <typename T>
+class ParamHandle {
+ public:
+  ParamHandle() = default;
+
+  const T &operator*() const { return *value_; }
+  const T *operator->() const { return value_; }
+  bool IsValid() const { return value_ != nullptr; }
+
+  /// index of the parameter in Params::DeviceValues(), or -1 if it is not mirrored
+  int DeviceIndex() const { return device_index_; }
+
+ private:
+  friend class Params;
+  ParamHandle(const T *value, int device_index)
+      : value_(value), device_index_(device_index) {}
+
+  const T *value_ = nullptr;
+  int device_index_ = -1;
+};
+
 /// Defines a class that can be used to hold parameters
 /// of any kind
 class Params {
@@ -43,27 +68,66 @@ class Params {
   ///
   /// Throws an error if the key is already in use
   template <typename T>
-  void Add(const std::string &key, T value) {
+  ParamHandle<T> Add(const std::string &key, T value) {
     if (hasKey(key)) {
       throw std::invalid_argument("Key value pair already exists, cannot add key.");
     }
-    myParams_[key] = std::unique_ptr<Params::base_t>(new object_t<T>(value));
+    auto obj = new object_t<T>(value);
+    myParams_[key] = std::unique_ptr<Params::base_t>(obj);
     myTypes_[key] = std::string(typeid(value).name());
+    return ParamHandle<T>(obj->pValue.get(), -1);
+  }
+
+  /// Adds a scalar parameter like Add and also mirrors it, converted to Real, into the
+  /// device array returned by DeviceValues() at the index given by the handle, so that
+  /// kernels can read it without capturing it from the host
+  template <typename T>
+  ParamHandle<T> AddMirrored(const std::string &key, T value) {
+    static_assert(std::is_arithmetic<T>::value,
+                  "Only scalar parameters can be mirrored to the device");
+    auto handle = Add(key, value);
+    handle.device_index_ = static_cast<int>(device_values_.size());
+    myParams_[key]->device_index = handle.device_index_;
+    device_values_.push_back(static_cast<Real>(value));
+    device_dirty_ = true;
+    return handle;
   }
 
   void reset() {
     myParams_.clear();
     myTypes_.clear();
+    device_values_.clear();
+    device_dirty_ = true;
   }
 
   template <typename T>
-  const T &Get(const std::string key) {
-    keyCheck(key, false);
-    typeCheck<T>(key, false);
-    auto typed_ptr = dynamic_cast<Params::object_t<T> *>(myParams_[key].get());
-    if (typed_ptr == nullptr)
-      throw std::invalid_argument("Cannot cast Params[" + key + "] to requested type");
-    return *typed_ptr->pValue;
+  const T &Get(const std::string key) const {
+    return *GetTyped<T>(key)->pValue;
+  }
+
+  /// Returns a handle to a parameter that was added elsewhere. Looks up and checks the
+  /// key once, later accesses through the handle do not.
+  template <typename T>
+  ParamHandle<T> GetHandle(const std::string &key) const {
+    auto typed_ptr = GetTyped<T>(key);
+    return ParamHandle<T>(typed_ptr->pValue.get(), typed_ptr->device_index);
+  }
+
+  /// The parameters added with AddMirrored in device memory. The array is updated
+  /// here if parameters were added since the last call, so call it on the host before
+  /// launching a kernel and capture the array.
+  const ParArray1D<Real> &DeviceValues() {
+    if (device_dirty_) {
+      const size_t n = std::max<size_t>(device_values_.size(), 1);
+      device_values_d_ = ParArray1D<Real>("Params::DeviceValues", n);
+      auto device_values_h = Kokkos::create_mirror_view(device_values_d_);
+      for (size_t i = 0; i < device_values_.size(); i++) {
+        device_values_h(i) = device_values_[i];
+      }
+      Kokkos::deep_copy(device_values_d_, device_values_h);
+      device_dirty_ = false;
+    }
+    return device_values_d_;
   }
 
   bool hasKey(const std::string key) const {
@@ -83,47 +147,46 @@ class Params {
  private:
   // private first so that I can use the structs defined here
   struct base_t {
+    explicit base_t(const void *tag) : type_tag(tag) {}
     virtual ~base_t() = default; // for whatever reason I need a virtual destructor
     virtual const void *address() { return nullptr; } // for listing and debugging
+    // identifies the type of the value without RTTI, see TypeTag
+    const void *type_tag;
+    int device_index = -1;
   };
 
   template <typename T>
   struct object_t : base_t {
     std::unique_ptr<T> pValue;
-    explicit object_t(T val) : pValue(std::make_unique<T>(val)) {}
+    explicit object_t(T val) : base_t(TypeTag<T>()), pValue(std::make_unique<T>(val)) {}
     ~object_t() = default;
     const void *address() { return reinterpret_cast<void *>(pValue.get()); }
   };
 
+  // a unique address per type, which is cheaper to compare than type names
   template <typename T>
-  void typeCheck(const std::string key, bool die) {
-    // check on return type
-    if (myTypes_[key].compare(std::string(typeid(T).name()))) {
-      std::cout << "WRONG TYPE FOR KEY '" << key << "'" << std::endl;
-      if (die) throw std::invalid_argument("Wrong type sent to Get<T>()");
-    }
+  static const void *TypeTag() {
+    static const char tag = 0;
+    return &tag;
   }
 
-  void keyCheck(const std::string key, bool die) {
-#if (DEBUG_ > 0)
-    if (!hasKey(key)) {
-      // key alread exists, replace
-      std::cout << std::endl;
-      std::cout << "----------------------------------------------" << std::endl;
-      std::cout << "    WARNING: key '" << key << "' not found." << std::endl;
-      std::cout << "             Swift death will follow..." << std::endl;
-      std::cout << "----------------------------------------------" << std::endl;
-      std::cout << std::endl;
-
-      if (die) {
-        throw std::invalid_argument("Key " + key + " doesn't exist");
-      }
+  template <typename T>
+  const object_t<T> *GetTyped(const std::string &key) const {
+    auto it = myParams_.find(key);
+    if (it == myParams_.end()) {
+      throw std::invalid_argument("Key " + key + " doesn't exist");
+    }
+    if (it->second->type_tag != TypeTag<T>()) {
+      throw std::invalid_argument("Cannot cast Params[" + key + "] to requested type");
     }
-#endif
+    return static_cast<const object_t<T> *>(it->second.get());
   }
 
   std::map<std::string, std::unique_ptr<Params::base_t>> myParams_;
   std::map<std::string, std::string> myTypes_;
+  std::vector<Real> device_values_;
+  bool device_dirty_ = true;
+  ParArray1D<Real> device_values_d_;
 };
 
 } // namespace parthenon
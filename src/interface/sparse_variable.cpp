@@ -13,6 +13,12 @@
 
 #include "interface/sparse_variable.hpp"
 
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "interface/metadata.hpp"
 
 namespace parthenon {
@@ -22,20 +28,56 @@ void SparseVariable<T>::Add(int varIndex) {
   // Now allocate depending on topology
   if ((metadata_.Where() == Metadata::Cell) || (metadata_.Where() == Metadata::Node)) {
     // check if variable index already exists
-    if (varMap_.find(varIndex) != varMap_.end()) {
+    if (GetIndex(varIndex) >= 0) {
       throw std::invalid_argument("Duplicate index in create SparseVariable");
     }
     // create the variable and add to map
     std::string my_name = label_ + "_" + std::to_string(varIndex);
-    auto v = std::make_shared<CellVariable<T>>(my_name, dims_, metadata_);
-    varArray_.push_back(v);
-    indexMap_.push_back(varIndex);
-    varMap_[varIndex] = v;
+    Add(varIndex, std::make_shared<CellVariable<T>>(my_name, dims_, metadata_));
   } else {
     throw std::invalid_argument("unsupported type in SparseVariable");
   }
 }
 
+template <typename T>
+void SparseVariable<T>::Add(int varIndex, std::shared_ptr<CellVariable<T>> cv) {
+  if (varIndex < 0) {
+    throw std::invalid_argument("Negative index in create SparseVariable");
+  }
+  if (varIndex >= static_cast<int>(slot_.size())) slot_.resize(varIndex + 1, -1);
+  slot_[varIndex] = static_cast<int>(varArray_.size());
+  varArray_.push_back(cv);
+  indexMap_.push_back(varIndex);
+  varMap_[varIndex] = cv;
+  pack_current_ = false;
+}
+
+template <typename T>
+const SparsePack<T> &SparseVariable<T>::GetPack() {
+  const int ncomp = varArray_.size(), nid = slot_.size();
+  std::vector<const T *> src(ncomp);
+  for (int s = 0; s < ncomp; s++) {
+    src[s] = varArray_[s]->data.Get().data();
+  }
+  if (pack_current_ && src == pack_src_) return pack_;
+  ParArray1D<ParArray4D<T>> v(label_ + " SparsePack", ncomp);
+  ParArray1D<int> slot(label_ + " SparsePack slots", nid);
+  auto v_h = Kokkos::create_mirror_view(v);
+  auto slot_h = Kokkos::create_mirror_view(slot);
+  for (int s = 0; s < ncomp; s++) {
+    v_h(s) = varArray_[s]->data.Get(0, 0);
+  }
+  for (int id = 0; id < nid; id++) {
+    slot_h(id) = slot_[id];
+  }
+  Kokkos::deep_copy(v, v_h);
+  Kokkos::deep_copy(slot, slot_h);
+  pack_ = SparsePack<T>(v, slot);
+  pack_current_ = true;
+  pack_src_ = std::move(src);
+  return pack_;
+}
+
 template class SparseVariable<Real>;
 
 } // namespace parthenon
@@ -28,12 +28,51 @@
 
 #include "globals.hpp"
 #include "interface/variable.hpp"
+#include "kokkos_abstraction.hpp"
 
 namespace parthenon {
 
 template <typename T>
 using SparseMap = std::map<int, std::shared_ptr<CellVariable<T>>>;
 
+//----------------------------------------------------------------------------------------
+//! \class SparsePack
+//  \brief a view of the allocated components of a SparseVariable indexed by
+//  (sparse id, n, k, j, i), for use inside kernels. The sparse ids are translated to
+//  the dense component list through a table with one entry per id up to the largest
+//  one, so that an access costs two loads rather than a search.
+
+template <typename T>
+class SparsePack {
+ public:
+  SparsePack() = default;
+  SparsePack(const ParArray1D<ParArray4D<T>> &v, const ParArray1D<int> &slot)
+      : v_(v), slot_(slot), ncomp_(v.extent_int(0)), nid_(slot.extent_int(0)) {}
+
+  // by dense index s, 0 <= s < GetNComponents(), in the order the ids were added
+  KOKKOS_FORCEINLINE_FUNCTION
+  const ParArray4D<T> &Component(const int s) const { return v_(s); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  T &operator()(const int id, const int n, const int k, const int j, const int i) const {
+    return v_(slot_(id))(n, k, j, i);
+  }
+  KOKKOS_FORCEINLINE_FUNCTION
+  T &operator()(const int id, const int k, const int j, const int i) const {
+    return v_(slot_(id))(0, k, j, i);
+  }
+
+  // the dense index of sparse id, or -1 if the id is not allocated
+  KOKKOS_FORCEINLINE_FUNCTION int GetSlot(const int id) const {
+    return (id >= 0 && id < nid_) ? slot_(id) : -1;
+  }
+  KOKKOS_FORCEINLINE_FUNCTION int GetNComponents() const { return ncomp_; }
+
+ private:
+  ParArray1D<ParArray4D<T>> v_;
+  ParArray1D<int> slot_;
+  int ncomp_ = 0, nid_ = 0;
+};
+
 ///
 /// SparseVariable builds on top of  the CellVariable class to include a map
 template <typename T>
@@ -60,25 +99,25 @@ class SparseVariable {
   /// create a new variable
   void Add(int sparse_index);
 
-  // accessors
-  inline CellVariable<T> &operator()(const int m) { return *(varMap_[m]); }
-  inline T &operator()(const int m, const int i) { return (*(varMap_[m]))(i); }
+  // accessors, m has to be an allocated sparse id
+  inline CellVariable<T> &operator()(const int m) { return *varArray_[slot_[m]]; }
+  inline T &operator()(const int m, const int i) { return (*varArray_[slot_[m]])(i); }
   inline T &operator()(const int m, const int j, const int i) {
-    return (*(varMap_[m]))(j, i);
+    return (*varArray_[slot_[m]])(j, i);
   }
   inline T &operator()(const int m, const int k, const int j, const int i) {
-    return (*(varMap_[m]))(k, j, i);
+    return (*varArray_[slot_[m]])(k, j, i);
   }
   inline T &operator()(const int m, const int n, const int k, const int j, const int i) {
-    return (*(varMap_[m]))(n, k, j, i);
+    return (*varArray_[slot_[m]])(n, k, j, i);
   }
   inline T &operator()(const int m, const int l, const int n, const int k, const int j,
                        const int i) {
-    return (*(varMap_[m]))(l, n, k, j, i);
+    return (*varArray_[slot_[m]])(l, n, k, j, i);
   }
   inline T &operator()(const int m, const int p, const int l, const int n, const int k,
                        const int j, const int i) {
-    return (*(varMap_[m]))(p, l, n, k, j, i);
+    return (*varArray_[slot_[m]])(p, l, n, k, j, i);
   }
 
   bool IsSet(const MetadataFlag flag) { return metadata_.IsSet(flag); }
@@ -90,18 +129,17 @@ class SparseVariable {
   }
 
   CellVariable<T> &Get(const int index) {
-    auto it = varMap_.find(index);
-    if (it == varMap_.end()) {
+    const int s = GetIndex(index);
+    if (s < 0) {
       throw std::invalid_argument("index " + std::to_string(index) +
                                   "does not exist in SparseVariable");
     }
-    return *(it->second);
+    return *varArray_[s];
   }
 
+  // position of sparse id in GetVector() and GetIndexMap(), or -1 if it doesn't exist
   int GetIndex(int id) {
-    auto it = std::find(indexMap_.begin(), indexMap_.end(), id);
-    if (it == indexMap_.end()) return -1; // indicate the id doesn't exist
-    return std::distance(indexMap_.begin(), it);
+    return (id >= 0 && id < static_cast<int>(slot_.size())) ? slot_[id] : -1;
   }
 
   std::vector<int> &GetIndexMap() { return indexMap_; }
@@ -110,6 +148,10 @@ class SparseVariable {
 
   SparseMap<T> &GetMap() { return varMap_; }
 
+  // all allocated components for use in kernels, rebuilt on the first call after an Add
+  // or after a component moved to other storage (Container::AllocateSlab)
+  const SparsePack<T> &GetPack();
+
   // might want to implement this at some point
   // void DeleteVariable(const int var_id);
 
@@ -124,13 +166,15 @@ class SparseVariable {
   SparseMap<T> varMap_;
   CellVariableVector<T> varArray_;
   std::vector<int> indexMap_;
+  // slot_[id] is the position of sparse id in varArray_, or -1
+  std::vector<int> slot_;
+  SparsePack<T> pack_;
+  bool pack_current_ = false;
+  // the data of each component when pack_ was built
+  std::vector<const T *> pack_src_;
   CellVariableVector<T> _empty;
 
-  void Add(int varIndex, std::shared_ptr<CellVariable<T>> cv) {
-    varArray_.push_back(cv);
-    indexMap_.push_back(varIndex);
-    varMap_[varIndex] = cv;
-  }
+  void Add(int varIndex, std::shared_ptr<CellVariable<T>> cv);
 };
 
 template <typename T>
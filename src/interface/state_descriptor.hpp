@@ -13,8 +13,10 @@
 #ifndef INTERFACE_STATE_DESCRIPTOR_HPP_
 #define INTERFACE_STATE_DESCRIPTOR_HPP_
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -25,6 +27,8 @@
 
 namespace parthenon {
 
+class Mesh;
+
 enum class DerivedOwnership { shared, unique };
 
 /// The state metadata descriptor class.
@@ -44,8 +48,8 @@ class StateDescriptor {
   }
 
   template <typename T>
-  void AddParam(const std::string &key, T &value) {
-    _params.Add<T>(key, value);
+  ParamHandle<T> AddParam(const std::string &key, T &value) {
+    return _params.Add<T>(key, value);
   }
 
   template <typename T>
@@ -53,6 +57,11 @@ class StateDescriptor {
     return _params.Get<T>(key);
   }
 
+  template <typename T>
+  ParamHandle<T> GetParamHandle(const std::string &key) {
+    return _params.GetHandle<T>(key);
+  }
+
   Params &AllParams() { return _params; }
   // retrieve label
   const std::string &label() { return _label; }
@@ -92,6 +101,35 @@ class StateDescriptor {
     return true;
   }
 
+  // add a particle swarm; every swarm has the real values x, y and z, the position
+  bool AddSwarm(const std::string &swarm_name, const Metadata &m) {
+    if (_swarmMetadataMap.count(swarm_name) > 0) {
+      throw std::invalid_argument("Swarm " + swarm_name + " already exists");
+    }
+    _swarmMetadataMap[swarm_name] = m;
+    _swarmValueMetadataMap[swarm_name];
+    return true;
+  }
+  // add a value carried by the particles of a swarm, an integer if m has
+  // Metadata::Integer set and a real otherwise
+  bool AddSwarmValue(const std::string &value_name, const std::string &swarm_name,
+                     const Metadata &m) {
+    auto it = _swarmValueMetadataMap.find(swarm_name);
+    if (it == _swarmValueMetadataMap.end()) {
+      throw std::invalid_argument("Swarm " + swarm_name + " does not exist");
+    }
+    if (it->second.count(value_name) > 0 || value_name == "x" || value_name == "y" ||
+        value_name == "z") {
+      throw std::invalid_argument("Swarm value " + value_name + " already exists");
+    }
+    it->second[value_name] = m;
+    return true;
+  }
+  const std::map<std::string, Metadata> &AllSwarms() { return _swarmMetadataMap; }
+  const std::map<std::string, Metadata> &AllSwarmValues(const std::string &swarm_name) {
+    return _swarmValueMetadataMap.at(swarm_name);
+  }
+
   // retrieve number of fields
   int size() const { return _metadataMap.size(); }
 
@@ -118,16 +156,42 @@ class StateDescriptor {
   // get all metadata for this physics
   const std::map<std::string, Metadata> &AllMetadata() { return _metadataMap; }
 
+  // whether FillDerived only computes variables flagged OnDemand, so that it can wait
+  // until they are read (see FillDerivedVariables::FillOnDemand)
+  bool FillDerivedOnDemand() const {
+    if (FillDerived == nullptr) return false;
+    bool any = false;
+    auto check = [&any](const Metadata &m) {
+      if (!m.IsSet(Metadata::Derived)) return true;
+      any = true;
+      return m.IsSet(Metadata::OnDemand);
+    };
+    for (auto &x : _metadataMap) {
+      if (!check(x.second)) return false;
+    }
+    for (auto &x : _sparseMetadataMap) {
+      for (auto &m : x.second) {
+        if (!check(m)) return false;
+      }
+    }
+    return any;
+  }
+
   std::vector<std::shared_ptr<AMRCriteria>> amr_criteria;
   void (*FillDerived)(Container<Real> &rc);
   Real (*EstimateTimestep)(Container<Real> &rc);
   AmrTag (*CheckRefinement)(Container<Real> &rc);
+  // set initial data on all blocks of a rank for new runs, called in Mesh::Initialize
+  // after MeshBlock::ProblemGenerator; see InitialCondition::Enroll
+  std::vector<std::function<void(Mesh *)>> InitialConditions;
 
  private:
   Params _params;
   const std::string _label;
   std::map<std::string, Metadata> _metadataMap;
   std::map<std::string, std::vector<Metadata>> _sparseMetadataMap;
+  std::map<std::string, Metadata> _swarmMetadataMap;
+  std::map<std::string, std::map<std::string, Metadata>> _swarmValueMetadataMap;
 };
 
 using Packages_t = std::map<std::string, std::shared_ptr<StateDescriptor>>;
@@ -0,0 +1,269 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include "interface/swarm.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Kokkos_Sort.hpp>
+
+#include "mesh/mesh.hpp"
+
+namespace parthenon {
+
+namespace {
+
+// the slot of each marked (or, with keep, unmarked) particle among those particles,
+// and their number
+int Enumerate(const ParArray1D<int> &marked, const int n, const bool keep,
+              ParArray1D<int> &pos) {
+  pos = ParArray1D<int>("Swarm slots", n);
+  auto p = pos;
+  const int want = keep ? 0 : 1;
+  par_scan<int>(
+      "Swarm::Enumerate", DevSpace(), 0, n - 1,
+      KOKKOS_LAMBDA(const int i, int &partial, const bool final) {
+        if (marked(i) == want) {
+          if (final) p(i) = partial;
+          partial++;
+        }
+      });
+  int count = 0;
+  par_reduce(
+      "Swarm::Count", DevSpace(), 0, n - 1,
+      KOKKOS_LAMBDA(const int i, int &sum) { sum += (marked(i) == want); },
+      Kokkos::Sum<int>(count));
+  return count;
+}
+
+// moves the unmarked particles of arr to the front, keeping their order
+template <typename T>
+void Compact(ParArray1D<T> &arr, const ParArray1D<int> &marked,
+             const ParArray1D<int> &dest, const int n, const int nkeep) {
+  ParArray1D<T> tmp("Swarm compact", nkeep);
+  auto a = arr;
+  par_for(
+      "Swarm::Compact", DevSpace(), 0, n - 1, KOKKOS_LAMBDA(const int i) {
+        if (marked(i) == 0) tmp(dest(i)) = a(i);
+      });
+  Kokkos::deep_copy(Kokkos::subview(arr, std::make_pair(0, nkeep)), tmp);
+}
+
+KOKKOS_INLINE_FUNCTION int CellIndex(const Real x, const Real xmin, const Real dx,
+                                     const int nx) {
+  const int i = static_cast<int>((x - xmin) / dx);
+  return (i < 0 ? 0 : (i >= nx ? nx - 1 : i));
+}
+
+} // namespace
+
+Swarm::Swarm(const std::string &label, const Metadata &m)
+    : label_(label), metadata_(m), marked_("Swarm marked", 0) {
+  for (const std::string name : {"x", "y", "z"}) {
+    real_[name] = ParArray1D<Real>(label + "." + name, 0);
+  }
+}
+
+void Swarm::Add(const std::string &value_name, const Metadata &m) {
+  if (real_.count(value_name) > 0 || int_.count(value_name) > 0) {
+    throw std::invalid_argument("Value " + value_name + " already exists in swarm " +
+                                label_);
+  }
+  if (m.IsSet(Metadata::Integer)) {
+    int_[value_name] = ParArray1D<int>(label_ + "." + value_name, capacity_);
+  } else {
+    real_[value_name] = ParArray1D<Real>(label_ + "." + value_name, capacity_);
+  }
+}
+
+ParArray1D<Real> &Swarm::GetReal(const std::string &name) {
+  auto it = real_.find(name);
+  if (it == real_.end()) {
+    throw std::invalid_argument("Swarm " + label_ + " has no real value " + name);
+  }
+  return it->second;
+}
+
+ParArray1D<int> &Swarm::GetInteger(const std::string &name) {
+  auto it = int_.find(name);
+  if (it == int_.end()) {
+    throw std::invalid_argument("Swarm " + label_ + " has no integer value " + name);
+  }
+  return it->second;
+}
+
+std::vector<std::string> Swarm::RealNames() const {
+  std::vector<std::string> names;
+  for (auto &v : real_)
+    names.push_back(v.first);
+  return names;
+}
+
+std::vector<std::string> Swarm::IntegerNames() const {
+  std::vector<std::string> names;
+  for (auto &v : int_)
+    names.push_back(v.first);
+  return names;
+}
+
+void Swarm::Reserve_(const int n) {
+  if (n <= capacity_) return;
+  capacity_ = std::max(n, 2 * capacity_);
+  // the new entries are zero
+  for (auto &v : real_)
+    Kokkos::resize(v.second, capacity_);
+  for (auto &v : int_)
+    Kokkos::resize(v.second, capacity_);
+  Kokkos::resize(marked_, capacity_);
+}
+
+int Swarm::AddEmptyParticles(const int n) {
+  const int first = num_active_;
+  Reserve_(first + n);
+  // slots of removed particles hold their old values
+  const auto range = std::make_pair(first, first + n);
+  for (auto &v : real_)
+    Kokkos::deep_copy(Kokkos::subview(v.second, range), Real(0));
+  for (auto &v : int_)
+    Kokkos::deep_copy(Kokkos::subview(v.second, range), 0);
+  num_active_ += n;
+  return first;
+}
+
+void Swarm::RemoveMarkedParticles() {
+  const int n = num_active_;
+  if (n == 0) return;
+  ParArray1D<int> dest;
+  const int nkeep = Enumerate(marked_, n, true, dest);
+  if (nkeep < n) {
+    for (auto &v : real_)
+      Compact(v.second, marked_, dest, n, nkeep);
+    for (auto &v : int_)
+      Compact(v.second, marked_, dest, n, nkeep);
+  }
+  Kokkos::deep_copy(Kokkos::subview(marked_, std::make_pair(0, n)), 0);
+  num_active_ = nkeep;
+}
+
+int Swarm::PopMarked(std::vector<Real> &reals, std::vector<int> &ints) {
+  const int n = num_active_;
+  if (n == 0) return 0;
+  ParArray1D<int> pos;
+  const int nout = Enumerate(marked_, n, false, pos);
+  if (nout == 0) return 0;
+
+  const int nreal = real_.size(), nint = int_.size();
+  ParArray2D<Real> rout("Swarm::PopMarked reals", nout, nreal);
+  ParArray2D<int> iout("Swarm::PopMarked ints", nout, std::max(nint, 1));
+  auto marked = marked_;
+  int c = 0;
+  for (auto &v : real_) {
+    auto a = v.second;
+    par_for(
+        "Swarm::PopMarked", DevSpace(), 0, n - 1, KOKKOS_LAMBDA(const int i) {
+          if (marked(i) == 1) rout(pos(i), c) = a(i);
+        });
+    c++;
+  }
+  c = 0;
+  for (auto &v : int_) {
+    auto a = v.second;
+    par_for(
+        "Swarm::PopMarked", DevSpace(), 0, n - 1, KOKKOS_LAMBDA(const int i) {
+          if (marked(i) == 1) iout(pos(i), c) = a(i);
+        });
+    c++;
+  }
+  auto rout_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), rout);
+  auto iout_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), iout);
+  for (int p = 0; p < nout; p++) {
+    for (int r = 0; r < nreal; r++)
+      reals.push_back(rout_h(p, r));
+    for (int r = 0; r < nint; r++)
+      ints.push_back(iout_h(p, r));
+  }
+
+  RemoveMarkedParticles();
+  return nout;
+}
+
+void Swarm::Insert(const Real *reals, const int *ints, const int n) {
+  if (n == 0) return;
+  const int nreal = real_.size(), nint = int_.size();
+  ParArray2D<Real> rin("Swarm::Insert reals", n, nreal);
+  ParArray2D<int> iin("Swarm::Insert ints", n, std::max(nint, 1));
+  auto rin_h = Kokkos::create_mirror_view(rin);
+  auto iin_h = Kokkos::create_mirror_view(iin);
+  for (int p = 0; p < n; p++) {
+    for (int r = 0; r < nreal; r++)
+      rin_h(p, r) = reals[p * nreal + r];
+    for (int r = 0; r < nint; r++)
+      iin_h(p, r) = ints[p * nint + r];
+  }
+  Kokkos::deep_copy(rin, rin_h);
+  Kokkos::deep_copy(iin, iin_h);
+
+  const int first = AddEmptyParticles(n);
+  int c = 0;
+  for (auto &v : real_) {
+    auto a = v.second;
+    par_for(
+        "Swarm::Insert", DevSpace(), 0, n - 1,
+        KOKKOS_LAMBDA(const int p) { a(first + p) = rin(p, c); });
+    c++;
+  }
+  c = 0;
+  for (auto &v : int_) {
+    auto a = v.second;
+    par_for(
+        "Swarm::Insert", DevSpace(), 0, n - 1,
+        KOKKOS_LAMBDA(const int p) { a(first + p) = iin(p, c); });
+    c++;
+  }
+}
+
+void Swarm::SortByCell(MeshBlock *pmb) {
+  const int n = num_active_;
+  if (n < 2) return;
+  const RegionSize &bs = pmb->block_size;
+  const int nx1 = bs.nx1, nx2 = bs.nx2, nx3 = bs.nx3;
+  const Real x1min = bs.x1min, x2min = bs.x2min, x3min = bs.x3min;
+  const Real dx1 = (bs.x1max - bs.x1min) / nx1, dx2 = (bs.x2max - bs.x2min) / nx2;
+  const Real dx3 = (bs.x3max - bs.x3min) / nx3;
+  auto x = real_["x"], y = real_["y"], z = real_["z"];
+  ParArray1D<int> key("Swarm cell", n);
+  pmb->par_for(
+      "Swarm::SortByCell", 0, n - 1, KOKKOS_LAMBDA(const int p) {
+        const int i = CellIndex(x(p), x1min, dx1, nx1);
+        const int j = CellIndex(y(p), x2min, dx2, nx2);
+        const int k = CellIndex(z(p), x3min, dx3, nx3);
+        key(p) = (k * nx2 + j) * nx1 + i;
+      });
+
+  // one bin per cell, the order within a cell is arbitrary
+  const int ncells = nx1 * nx2 * nx3;
+  using BinOp = Kokkos::BinOp1D<ParArray1D<int>>;
+  Kokkos::BinSort<ParArray1D<int>, BinOp> sorter(key, 0, n, BinOp(ncells, 0, ncells),
+                                                 false);
+  sorter.create_permute_vector();
+  for (auto &v : real_)
+    sorter.sort(v.second, 0, n);
+  for (auto &v : int_)
+    sorter.sort(v.second, 0, n);
+}
+
+} // namespace parthenon
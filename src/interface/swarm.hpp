@@ -0,0 +1,92 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef INTERFACE_SWARM_HPP_
+#define INTERFACE_SWARM_HPP_
+//! \file swarm.hpp
+//  \brief the Lagrangian particles of a MeshBlock, stored as one device array per value
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "interface/metadata.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+class MeshBlock;
+
+//----------------------------------------------------------------------------------------
+//! \class Swarm
+//  \brief a set of particles with named real and integer values (structure of arrays).
+//  The particles occupy the slots [0, GetNumActive()) of the arrays, so kernels loop over
+//  that range; the arrays grow by doubling when particles are added. Every swarm has the
+//  real values x, y and z, the position of the particle. Swarms are registered with
+//  StateDescriptor::AddSwarm and AddSwarmValue and live in MeshBlock::swarms.
+
+class Swarm {
+ public:
+  Swarm(const std::string &label, const Metadata &m);
+
+  const std::string &label() const { return label_; }
+  const Metadata &metadata() const { return metadata_; }
+
+  // add a value, an integer if m has Metadata::Integer set and a real otherwise
+  void Add(const std::string &value_name, const Metadata &m);
+
+  ParArray1D<Real> &GetReal(const std::string &name);
+  ParArray1D<int> &GetInteger(const std::string &name);
+  // the names of the values in alphabetical order, which is also the order of the
+  // values in the records of PopMarked and Insert
+  std::vector<std::string> RealNames() const;
+  std::vector<std::string> IntegerNames() const;
+
+  int GetNumActive() const { return num_active_; }
+  int GetCapacity() const { return capacity_; }
+
+  // adds n particles at the end with all values zero and returns the first new slot;
+  // the caller sets their values in [first, first + n)
+  int AddEmptyParticles(const int n);
+  // set to 1 in kernels for the particles to be removed by RemoveMarkedParticles or
+  // PopMarked
+  ParArray1D<int> &GetMarked() { return marked_; }
+  void RemoveMarkedParticles();
+  // removes the marked particles and appends their values to reals and ints on the
+  // host, one record of RealNames().size() reals and IntegerNames().size() integers per
+  // particle. Returns the number of particles.
+  int PopMarked(std::vector<Real> &reals, std::vector<int> &ints);
+  // adds n particles from records as written by PopMarked
+  void Insert(const Real *reals, const int *ints, const int n);
+
+  // orders the particles by the cell of the block containing them, so that the
+  // particles of a cell are consecutive in memory
+  void SortByCell(MeshBlock *pmb);
+
+ private:
+  void Reserve_(const int n);
+
+  std::string label_;
+  Metadata metadata_;
+  int num_active_ = 0, capacity_ = 0;
+  std::map<std::string, ParArray1D<Real>> real_;
+  std::map<std::string, ParArray1D<int>> int_;
+  ParArray1D<int> marked_;
+};
+
+using SwarmMap = std::map<std::string, std::shared_ptr<Swarm>>;
+
+} // namespace parthenon
+
+#endif // INTERFACE_SWARM_HPP_
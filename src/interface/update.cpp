@@ -14,113 +14,226 @@
 #include "interface/update.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "coordinates/coordinates.hpp"
 #include "interface/container.hpp"
 #include "interface/container_iterator.hpp"
+#include "interface/meshblock_pack.hpp"
 #include "mesh/mesh.hpp"
+#include "mesh/mesh_refinement.hpp"
+#include "refinement/refinement.hpp"
 
 namespace parthenon {
 
 namespace Update {
 
+CellRegion InteriorRegion(MeshBlock *pmb, const int width) {
+  const int ndim = pmb->pmy_mesh->ndim;
+  CellRegion r{pmb->is + width, pmb->ie - width, pmb->js, pmb->je, pmb->ks, pmb->ke};
+  if (ndim >= 2) r.js += width, r.je -= width;
+  if (ndim >= 3) r.ks += width, r.ke -= width;
+  return r;
+}
+
+std::vector<CellRegion> ShellRegions(MeshBlock *pmb, const int width) {
+  const int ndim = pmb->pmy_mesh->ndim;
+  const CellRegion all = InteriorRegion(pmb, 0);
+  const CellRegion in = InteriorRegion(pmb, width);
+  if (width == 0) return {};
+  if (in.empty()) return {all};
+
+  // slabs normal to x3, then x2 and x1 slabs restricted to the remaining cells
+  std::vector<CellRegion> shell;
+  if (ndim >= 3) {
+    shell.push_back({all.is, all.ie, all.js, all.je, all.ks, in.ks - 1});
+    shell.push_back({all.is, all.ie, all.js, all.je, in.ke + 1, all.ke});
+  }
+  if (ndim >= 2) {
+    shell.push_back({all.is, all.ie, all.js, in.js - 1, in.ks, in.ke});
+    shell.push_back({all.is, all.ie, in.je + 1, all.je, in.ks, in.ke});
+  }
+  shell.push_back({all.is, in.is - 1, in.js, in.je, in.ks, in.ke});
+  shell.push_back({in.ie + 1, all.ie, in.js, in.je, in.ks, in.ke});
+  return shell;
+}
+
+int ShellWidth(MeshBlock *pmb) {
+  // restriction for a coarser neighbor reads 2*NGHOST cells, all other buffers NGHOST
+  return pmb->pmy_mesh->multilevel ? 2 * NGHOST : NGHOST;
+}
+
 TaskStatus FluxDivergence(Container<Real> &in, Container<Real> &dudt_cont) {
-  MeshBlock *pmb = in.pmy_block;
-  int is = pmb->is;
-  int js = pmb->js;
-  int ks = pmb->ks;
-  int ie = pmb->ie;
-  int je = pmb->je;
-  int ke = pmb->ke;
+  FluxDivergenceInRegions(in, dudt_cont, {InteriorRegion(in.pmy_block, 0)});
+  return TaskStatus::complete;
+}
 
-  Metadata m;
-  ContainerIterator<Real> cin_iter(in, {Metadata::Independent});
-  ContainerIterator<Real> cout_iter(dudt_cont, {Metadata::Independent});
-  int nvars = cout_iter.vars.size();
+namespace {
 
-  ParArrayND<Real> x1area("x1area", pmb->ncells1);
-  ParArrayND<Real> x2area0("x2area0", pmb->ncells1);
-  ParArrayND<Real> x2area1("x2area1", pmb->ncells1);
-  ParArrayND<Real> x3area0("x3area0", pmb->ncells1);
-  ParArrayND<Real> x3area1("x3area1", pmb->ncells1);
-  ParArrayND<Real> vol("vol", pmb->ncells1);
-
-  int ndim = pmb->pmy_mesh->ndim;
-  ParArrayND<Real> du("du", pmb->ncells1);
-  for (int k = ks; k <= ke; k++) {
-    for (int j = js; j <= je; j++) {
-      pmb->pcoord->Face1Area(k, j, is, ie + 1, x1area);
-      pmb->pcoord->CellVolume(k, j, is, ie, vol);
-      if (pmb->pmy_mesh->ndim >= 2) {
-        pmb->pcoord->Face2Area(k, j, is, ie, x2area0);
-        pmb->pcoord->Face2Area(k, j + 1, is, ie, x2area1);
-      }
-      if (pmb->pmy_mesh->ndim >= 3) {
-        pmb->pcoord->Face3Area(k, j, is, ie, x3area0);
-        pmb->pcoord->Face3Area(k + 1, j, is, ie, x3area1);
-      }
-      for (int n = 0; n < nvars; n++) {
-        CellVariable<Real> &q = *cin_iter.vars[n];
-        ParArrayND<Real> &x1flux = q.flux[0];
-        ParArrayND<Real> &x2flux = q.flux[1];
-        ParArrayND<Real> &x3flux = q.flux[2];
-        CellVariable<Real> &dudt = *cout_iter.vars[n];
-        for (int l = 0; l < q.GetDim(4); l++) {
-          for (int i = is; i <= ie; i++) {
-            du(i) =
-                (x1area(i + 1) * x1flux(l, k, j, i + 1) - x1area(i) * x1flux(l, k, j, i));
-          }
+// face areas and cell volumes of a Cartesian block, formed as in Coordinates from the
+// face spacings. For uniform spacing they are the same in every cell, so the
+// specialization below turns them into constants of the kernel.
+template <bool uniform>
+struct CartesianGeometry {
+  explicit CartesianGeometry(const Coordinates &coords)
+      : dx1(coords.dx1f.Get<1>()), dx2(coords.dx2f.Get<1>()), dx3(coords.dx3f.Get<1>()) {}
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Area1(const int k, const int j, const int i) const { return dx2(j) * dx3(k); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Area2(const int k, const int j, const int i) const { return dx1(i) * dx3(k); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Area3(const int k, const int j, const int i) const { return dx1(i) * dx2(j); }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Volume(const int k, const int j, const int i) const {
+    return dx1(i) * dx2(j) * dx3(k);
+  }
+  ParArray1D<Real> dx1, dx2, dx3;
+};
+
+template <>
+struct CartesianGeometry<true> {
+  explicit CartesianGeometry(const Coordinates &coords)
+      : area1(coords.uniform_dx[X2DIR] * coords.uniform_dx[X3DIR]),
+        area2(coords.uniform_dx[X1DIR] * coords.uniform_dx[X3DIR]),
+        area3(coords.uniform_dx[X1DIR] * coords.uniform_dx[X2DIR]),
+        volume(coords.uniform_dx[X1DIR] * coords.uniform_dx[X2DIR] *
+               coords.uniform_dx[X3DIR]) {}
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Area1(const int k, const int j, const int i) const { return area1; }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Area2(const int k, const int j, const int i) const { return area2; }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Area3(const int k, const int j, const int i) const { return area3; }
+  KOKKOS_FORCEINLINE_FUNCTION
+  Real Volume(const int k, const int j, const int i) const { return volume; }
+  Real area1, area2, area3, volume;
+};
 
-          if (ndim >= 2) {
-            for (int i = is; i <= ie; i++) {
-              du(i) +=
-                  (x2area1(i) * x2flux(l, k, j + 1, i) - x2area0(i) * x2flux(l, k, j, i));
+// instantiated for each number of dimensions NDIM, so that the loop body has no
+// run-time checks of the dimension
+template <bool uniform, int NDIM>
+void FluxDivergenceKernel(MeshBlock *pmb, const DevSpace &space,
+                          const CellVariableVector<Real> &qin,
+                          const CellVariableVector<Real> &qout,
+                          const std::vector<CellRegion> &regions) {
+  const CartesianGeometry<uniform> geom(*pmb->pcoord);
+  const int nvars = qout.size();
+  for (int n = 0; n < nvars; n++) {
+    CellVariable<Real> &q = *qin[n];
+    ParArray4D<Real> x1flux = q.GetFlux(X1DIR).Get<4>();
+    ParArray4D<Real> x2flux, x3flux;
+    if (NDIM >= 2) x2flux = q.GetFlux(X2DIR).Get<4>();
+    if (NDIM >= 3) x3flux = q.GetFlux(X3DIR).Get<4>();
+    ParArray4D<Real> dudt = qout[n]->data.Get<4>();
+    for (const auto &r : regions) {
+      par_for(
+          "FluxDivergence", space, 0, q.GetDim(4) - 1, r.ks, r.ke, r.js, r.je, r.is, r.ie,
+          KOKKOS_LAMBDA(const int l, const int k, const int j, const int i) {
+            // the flux differences largely cancel, so they are formed in double
+            // precision also when the fluxes are stored in single precision
+            using A = AccumReal;
+            A du = A(geom.Area1(k, j, i + 1)) * x1flux(l, k, j, i + 1) -
+                   A(geom.Area1(k, j, i)) * x1flux(l, k, j, i);
+            if (NDIM >= 2) {
+              du += A(geom.Area2(k, j + 1, i)) * x2flux(l, k, j + 1, i) -
+                    A(geom.Area2(k, j, i)) * x2flux(l, k, j, i);
             }
-          }
-          // TODO(jcd): should the next block be in the preceding if??
-          if (ndim >= 3) {
-            for (int i = is; i <= ie; i++) {
-              du(i) +=
-                  (x3area1(i) * x3flux(l, k + 1, j, i) - x3area0(i) * x3flux(l, k, j, i));
+            if (NDIM >= 3) {
+              du += A(geom.Area3(k + 1, j, i)) * x3flux(l, k + 1, j, i) -
+                    A(geom.Area3(k, j, i)) * x3flux(l, k, j, i);
             }
-          }
-          for (int i = is; i <= ie; i++) {
-            dudt(l, k, j, i) = -du(i) / vol(i);
-          }
-        }
-      }
+            dudt(l, k, j, i) = -du / geom.Volume(k, j, i);
+          });
     }
   }
+}
 
-  return TaskStatus::complete;
+template <bool uniform>
+void FluxDivergenceKernel(MeshBlock *pmb, const DevSpace &space,
+                          const CellVariableVector<Real> &qin,
+                          const CellVariableVector<Real> &qout,
+                          const std::vector<CellRegion> &regions) {
+  switch (pmb->pmy_mesh->ndim) {
+  case 1:
+    FluxDivergenceKernel<uniform, 1>(pmb, space, qin, qout, regions);
+    break;
+  case 2:
+    FluxDivergenceKernel<uniform, 2>(pmb, space, qin, qout, regions);
+    break;
+  default:
+    FluxDivergenceKernel<uniform, 3>(pmb, space, qin, qout, regions);
+  }
+}
+
+} // namespace
+
+void FluxDivergenceInRegions(Container<Real> &in, Container<Real> &dudt_cont,
+                             const std::vector<CellRegion> &regions) {
+  MeshBlock *pmb = in.pmy_block;
+  ContainerIterator<Real> cin_iter(in, {Metadata::Independent});
+  ContainerIterator<Real> cout_iter(dudt_cont, {Metadata::Independent});
+  // one launch per variable and region, which KernelGraph turns into a single one. The
+  // geometry only changes in a regrid, the arrays may be reallocated in between. Each
+  // pair of containers, by name, has a graph of its own, so that the stages do not
+  // recapture it; the signature catches containers that were purged and added again.
+  std::ostringstream key;
+  key << "FluxDivergence " << pmb->real_containers.Label(in) << " "
+      << pmb->real_containers.Label(dudt_cont);
+  for (const auto &r : regions) {
+    for (const int b : {r.is, r.ie, r.js, r.je, r.ks, r.ke}) {
+      key << " " << b;
+    }
+  }
+  std::vector<std::uintptr_t> signature;
+  if (KernelGraph::Enabled()) {
+    for (int n = 0; n < static_cast<int>(cout_iter.vars.size()); n++) {
+      for (int d = X1DIR; d < pmb->pmy_mesh->ndim; d++) {
+        signature.push_back(
+            reinterpret_cast<std::uintptr_t>(cin_iter.vars[n]->GetFlux(d).Get().data()));
+      }
+      signature.push_back(
+          reinterpret_cast<std::uintptr_t>(cout_iter.vars[n]->data.Get().data()));
+    }
+  }
+  pmb->kernel_graphs[key.str()].Run(
+      pmb->exec_space, signature, [&](const DevSpace &space) {
+        if (pmb->pcoord->uniform_spacing) {
+          FluxDivergenceKernel<true>(pmb, space, cin_iter.vars, cout_iter.vars, regions);
+        } else {
+          FluxDivergenceKernel<false>(pmb, space, cin_iter.vars, cout_iter.vars, regions);
+        }
+      });
 }
 
 void UpdateContainer(Container<Real> &in, Container<Real> &dudt_cont, const Real dt,
                      Container<Real> &out) {
-  MeshBlock *pmb = in.pmy_block;
-  int is = pmb->is;
-  int js = pmb->js;
-  int ks = pmb->ks;
-  int ie = pmb->ie;
-  int je = pmb->je;
-  int ke = pmb->ke;
+  UpdateContainerInRegions(in, dudt_cont, dt, out, {InteriorRegion(in.pmy_block, 0)});
+}
 
+void UpdateContainerInRegions(Container<Real> &in, Container<Real> &dudt_cont,
+                              const Real dt, Container<Real> &out,
+                              const std::vector<CellRegion> &regions) {
   Metadata m;
   ContainerIterator<Real> cin_iter(in, {Metadata::Independent});
   ContainerIterator<Real> cout_iter(out, {Metadata::Independent});
   ContainerIterator<Real> du_iter(dudt_cont, {Metadata::Independent});
   int nvars = cout_iter.vars.size();
 
-  for (int n = 0; n < nvars; n++) {
-    CellVariable<Real> &qin = *cin_iter.vars[n];
-    CellVariable<Real> &dudt = *du_iter.vars[n];
-    CellVariable<Real> &qout = *cout_iter.vars[n];
-    for (int l = 0; l < qout.GetDim(4); l++) {
-      for (int k = ks; k <= ke; k++) {
-        for (int j = js; j <= je; j++) {
-          for (int i = is; i <= ie; i++) {
-            qout(l, k, j, i) = qin(l, k, j, i) + dt * dudt(l, k, j, i);
+  for (const auto &r : regions) {
+    for (int n = 0; n < nvars; n++) {
+      CellVariable<Real> &qin = *cin_iter.vars[n];
+      CellVariable<Real> &dudt = *du_iter.vars[n];
+      CellVariable<Real> &qout = *cout_iter.vars[n];
+      for (int l = 0; l < qout.GetDim(4); l++) {
+        for (int k = r.ks; k <= r.ke; k++) {
+          for (int j = r.js; j <= r.je; j++) {
+            for (int i = r.is; i <= r.ie; i++) {
+              qout(l, k, j, i) = qin(l, k, j, i) + dt * dudt(l, k, j, i);
+            }
           }
         }
       }
@@ -130,27 +243,29 @@ void UpdateContainer(Container<Real> &in, Container<Real> &dudt_cont, const Real
 }
 
 void AverageContainers(Container<Real> &c1, Container<Real> &c2, const Real wgt1) {
-  MeshBlock *pmb = c1.pmy_block;
-  int is = pmb->is;
-  int js = pmb->js;
-  int ks = pmb->ks;
-  int ie = pmb->ie;
-  int je = pmb->je;
-  int ke = pmb->ke;
+  // all variables at once; c1 is passed as the unread third input
+  const Real wght[3] = {wgt1, 1 - wgt1, 0.0};
+  c1.pmy_block->WeightedAve(c1, c2, c1, wght);
+}
 
+void AverageContainersInRegions(Container<Real> &c1, Container<Real> &c2,
+                                const Real wgt1,
+                                const std::vector<CellRegion> &regions) {
   Metadata m;
   ContainerIterator<Real> c1_iter(c1, {Metadata::Independent});
   ContainerIterator<Real> c2_iter(c2, {Metadata::Independent});
   int nvars = c2_iter.vars.size();
 
-  for (int n = 0; n < nvars; n++) {
-    CellVariable<Real> &q1 = *c1_iter.vars[n];
-    CellVariable<Real> &q2 = *c2_iter.vars[n];
-    for (int l = 0; l < q1.GetDim(4); l++) {
-      for (int k = ks; k <= ke; k++) {
-        for (int j = js; j <= je; j++) {
-          for (int i = is; i <= ie; i++) {
-            q1(l, k, j, i) = wgt1 * q1(l, k, j, i) + (1 - wgt1) * q2(l, k, j, i);
+  for (const auto &r : regions) {
+    for (int n = 0; n < nvars; n++) {
+      CellVariable<Real> &q1 = *c1_iter.vars[n];
+      CellVariable<Real> &q2 = *c2_iter.vars[n];
+      for (int l = 0; l < q1.GetDim(4); l++) {
+        for (int k = r.ks; k <= r.ke; k++) {
+          for (int j = r.js; j <= r.je; j++) {
+            for (int i = r.is; i <= r.ie; i++) {
+              q1(l, k, j, i) = wgt1 * q1(l, k, j, i) + (1 - wgt1) * q2(l, k, j, i);
+            }
           }
         }
       }
@@ -159,6 +274,246 @@ void AverageContainers(Container<Real> &c1, Container<Real> &c2, const Real wgt1
   return;
 }
 
+namespace {
+
+// runs f(l, k, j, i), which stores the new value of component l of var and returns it,
+// over the region. With tag_refinement and an AMRMinMax criterion on var, the same
+// kernel reduces the min and max of component 0 for the tagging.
+template <typename F>
+void UpdateRegion(MeshBlock *pmb, const std::string &name, const CellVariable<Real> &var,
+                  const CellRegion &r, const bool tag_refinement, const F &f) {
+  const int nl = var.GetDim(4);
+  if (!tag_refinement || !Refinement::HasFusedCriterion(pmb, var.label())) {
+    pmb->par_for(
+        name, 0, nl - 1, r.ks, r.ke, r.js, r.je, r.is, r.ie,
+        KOKKOS_LAMBDA(const int l, const int k, const int j, const int i) {
+          f(l, k, j, i);
+        });
+    return;
+  }
+  using Extrema = MeshRefinement::Extrema;
+  pmb->par_reduce(
+      name, 0, nl - 1, r.ks, r.ke, r.js, r.je, r.is, r.ie,
+      KOKKOS_LAMBDA(const int l, const int k, const int j, const int i, Extrema &lmm) {
+        const Real q = f(l, k, j, i);
+        if (l == 0) {
+          lmm.min_val = (q < lmm.min_val ? q : lmm.min_val);
+          lmm.max_val = (q > lmm.max_val ? q : lmm.max_val);
+        }
+      },
+      Kokkos::MinMax<Real, DevSpace>(pmb->pmr->AddFusedExtrema(var.label())));
+}
+
+} // namespace
+
+void StageUpdate(Container<Real> &u0, Container<Real> &u1, Container<Real> &dudt_cont,
+                 const Real wgt0, const Real wgt1, const Real dt, Container<Real> &out,
+                 const bool tag_refinement) {
+  StageUpdateInRegions(u0, u1, dudt_cont, wgt0, wgt1, dt, out,
+                       {InteriorRegion(u0.pmy_block, 0)}, tag_refinement);
+}
+
+void StageUpdateInRegions(Container<Real> &u0, Container<Real> &u1,
+                          Container<Real> &dudt_cont, const Real wgt0, const Real wgt1,
+                          const Real dt, Container<Real> &out,
+                          const std::vector<CellRegion> &regions,
+                          const bool tag_refinement) {
+  MeshBlock *pmb = u0.pmy_block;
+  ContainerIterator<Real> u0_iter(u0, {Metadata::Independent});
+  ContainerIterator<Real> u1_iter(u1, {Metadata::Independent});
+  ContainerIterator<Real> du_iter(dudt_cont, {Metadata::Independent});
+  ContainerIterator<Real> out_iter(out, {Metadata::Independent});
+  const int nvars = out_iter.vars.size();
+
+  for (int n = 0; n < nvars; n++) {
+    ParArray4D<Real> q0 = u0_iter.vars[n]->data.Get<4>();
+    ParArray4D<Real> q1 = u1_iter.vars[n]->data.Get<4>();
+    ParArray4D<Real> dudt = du_iter.vars[n]->data.Get<4>();
+    ParArray4D<Real> qout = out_iter.vars[n]->data.Get<4>();
+    for (const auto &r : regions) {
+      UpdateRegion(pmb, "StageUpdate", *out_iter.vars[n], r, tag_refinement,
+                   KOKKOS_LAMBDA(const int l, const int k, const int j, const int i) {
+                     return qout(l, k, j, i) =
+                                (wgt0 * q0(l, k, j, i) + wgt1 * q1(l, k, j, i)) +
+                                dt * dudt(l, k, j, i);
+                   });
+    }
+  }
+}
+
+void LowStorageUpdate(Container<Real> &s1, Container<Real> &s2, Container<Real> &s3,
+                      Container<Real> &dudt_cont, const Real delta, const Real gam1,
+                      const Real gam2, const Real gam3, const Real beta_dt,
+                      const bool first_stage, const bool tag_refinement) {
+  LowStorageUpdateInRegions(s1, s2, s3, dudt_cont, delta, gam1, gam2, gam3, beta_dt,
+                            first_stage, {InteriorRegion(s1.pmy_block, 0)},
+                            tag_refinement);
+}
+
+void LowStorageUpdateInRegions(Container<Real> &s1, Container<Real> &s2,
+                               Container<Real> &s3, Container<Real> &dudt_cont,
+                               const Real delta, const Real gam1, const Real gam2,
+                               const Real gam3, const Real beta_dt,
+                               const bool first_stage,
+                               const std::vector<CellRegion> &regions,
+                               const bool tag_refinement) {
+  MeshBlock *pmb = s1.pmy_block;
+  ContainerIterator<Real> s1_iter(s1, {Metadata::Independent});
+  ContainerIterator<Real> s2_iter(s2, {Metadata::Independent});
+  ContainerIterator<Real> s3_iter(s3, {Metadata::Independent});
+  ContainerIterator<Real> du_iter(dudt_cont, {Metadata::Independent});
+  const int nvars = s1_iter.vars.size();
+
+  for (int n = 0; n < nvars; n++) {
+    ParArray4D<Real> q1 = s1_iter.vars[n]->data.Get<4>();
+    ParArray4D<Real> q2 = s2_iter.vars[n]->data.Get<4>();
+    ParArray4D<Real> q3 = s3_iter.vars[n]->data.Get<4>();
+    ParArray4D<Real> dudt = du_iter.vars[n]->data.Get<4>();
+    for (const auto &r : regions) {
+      // all registers are read before any is written, so aliased registers are safe
+      UpdateRegion(pmb, "LowStorageUpdate", *s1_iter.vars[n], r, tag_refinement,
+                   KOKKOS_LAMBDA(const int l, const int k, const int j, const int i) {
+                     const Real u1 = q1(l, k, j, i);
+                     const Real u2 = (first_stage ? 0.0 : q2(l, k, j, i)) + delta * u1;
+                     const Real u3 = first_stage ? u1 : q3(l, k, j, i);
+                     q2(l, k, j, i) = u2;
+                     if (first_stage) q3(l, k, j, i) = u3;
+                     return q1(l, k, j, i) = gam1 * u1 + gam2 * u2 + gam3 * u3 +
+                                             beta_dt * dudt(l, k, j, i);
+                   });
+    }
+  }
+}
+
+namespace {
+
+// the face spacings dx1f, dx2f and dx3f of every block, indexed by (block, direction)
+ParArray2D<ParArray1D<Real>> PackCellWidthsOnMesh(Mesh *pmesh, const int nblocks) {
+  ParArray2D<ParArray1D<Real>> dx("cell widths", nblocks, 3);
+  auto dx_h = Kokkos::create_mirror_view(dx);
+  int b = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next, b++) {
+    dx_h(b, X1DIR) = pmb->pcoord->dx1f.Get<1>();
+    dx_h(b, X2DIR) = pmb->pcoord->dx2f.Get<1>();
+    dx_h(b, X3DIR) = pmb->pcoord->dx3f.Get<1>();
+  }
+  Kokkos::deep_copy(dx, dx_h);
+  return dx;
+}
+
+template <int NDIM>
+void FluxDivergenceOnMesh(const MeshBlock *pmb, const MeshBlockPack<Real> &dudt,
+                          const MeshBlockPack<Real> &x1flux,
+                          const MeshBlockPack<Real> &x2flux,
+                          const MeshBlockPack<Real> &x3flux,
+                          const ParArray2D<ParArray1D<Real>> &dx) {
+  par_for(
+      "FluxDivergenceOnMesh", DevSpace(), 0, dudt.GetNBlocks() - 1, 0,
+      dudt.GetNVars() - 1, pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        const Real dx1 = dx(b, X1DIR)(i);
+        const Real dx2 = dx(b, X2DIR)(j);
+        const Real dx3 = dx(b, X3DIR)(k);
+        const Real area1 = dx2 * dx3;
+        Real du = area1 * x1flux(b, n, k, j, i + 1) - area1 * x1flux(b, n, k, j, i);
+        if (NDIM >= 2) {
+          const Real area2 = dx1 * dx3;
+          du += area2 * x2flux(b, n, k, j + 1, i) - area2 * x2flux(b, n, k, j, i);
+        }
+        if (NDIM >= 3) {
+          const Real area3 = dx1 * dx2;
+          du += area3 * x3flux(b, n, k + 1, j, i) - area3 * x3flux(b, n, k, j, i);
+        }
+        dudt(b, n, k, j, i) = -du / (dx1 * dx2 * dx3);
+      });
+}
+
+} // namespace
+
+// Only Cartesian coordinates exist at the moment, so the face areas and volumes are
+// formed from the cell widths in the kernel, in the same order as Coordinates does.
+TaskStatus FluxDivergence(Mesh *pmesh, const std::string &in_name,
+                          const std::string &dudt_name) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (pmb == nullptr) return TaskStatus::complete;
+  const std::vector<MetadataFlag> flags({Metadata::Independent});
+  const int ndim = pmesh->ndim;
+  auto dudt = PackVariablesOnMesh(pmesh, dudt_name, flags);
+  auto x1flux = PackFluxesOnMesh(pmesh, in_name, flags, X1DIR);
+  MeshBlockPack<Real> x2flux, x3flux;
+  if (ndim >= 2) x2flux = PackFluxesOnMesh(pmesh, in_name, flags, X2DIR);
+  if (ndim >= 3) x3flux = PackFluxesOnMesh(pmesh, in_name, flags, X3DIR);
+  auto dx = PackCellWidthsOnMesh(pmesh, dudt.GetNBlocks());
+
+  switch (ndim) {
+  case 1:
+    FluxDivergenceOnMesh<1>(pmb, dudt, x1flux, x2flux, x3flux, dx);
+    break;
+  case 2:
+    FluxDivergenceOnMesh<2>(pmb, dudt, x1flux, x2flux, x3flux, dx);
+    break;
+  default:
+    FluxDivergenceOnMesh<3>(pmb, dudt, x1flux, x2flux, x3flux, dx);
+  }
+  // the blocks go on with their own execution space instances
+  pmesh->FenceExecSpaces();
+  return TaskStatus::complete;
+}
+
+void UpdateContainer(Mesh *pmesh, const std::string &in_name,
+                     const std::string &dudt_name, const Real dt,
+                     const std::string &out_name) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (pmb == nullptr) return;
+  const std::vector<MetadataFlag> flags({Metadata::Independent});
+  auto qin = PackVariablesOnMesh(pmesh, in_name, flags);
+  auto dudt = PackVariablesOnMesh(pmesh, dudt_name, flags);
+  auto qout = PackVariablesOnMesh(pmesh, out_name, flags);
+  par_for(
+      "UpdateContainerOnMesh", DevSpace(), 0, qout.GetNBlocks() - 1, 0,
+      qout.GetNVars() - 1, pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        qout(b, n, k, j, i) = qin(b, n, k, j, i) + dt * dudt(b, n, k, j, i);
+      });
+  pmesh->FenceExecSpaces();
+}
+
+void AverageContainers(Mesh *pmesh, const std::string &c1_name,
+                       const std::string &c2_name, const Real wgt1) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (pmb == nullptr) return;
+  const std::vector<MetadataFlag> flags({Metadata::Independent});
+  auto q1 = PackVariablesOnMesh(pmesh, c1_name, flags);
+  auto q2 = PackVariablesOnMesh(pmesh, c2_name, flags);
+  par_for(
+      "AverageContainersOnMesh", DevSpace(), 0, q1.GetNBlocks() - 1, 0,
+      q1.GetNVars() - 1, pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        q1(b, n, k, j, i) = wgt1 * q1(b, n, k, j, i) + (1 - wgt1) * q2(b, n, k, j, i);
+      });
+  pmesh->FenceExecSpaces();
+}
+
+void StageUpdate(Mesh *pmesh, const std::string &u0_name, const std::string &u1_name,
+                 const std::string &dudt_name, const Real wgt0, const Real wgt1,
+                 const Real dt, const std::string &out_name) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (pmb == nullptr) return;
+  const std::vector<MetadataFlag> flags({Metadata::Independent});
+  auto q0 = PackVariablesOnMesh(pmesh, u0_name, flags);
+  auto q1 = PackVariablesOnMesh(pmesh, u1_name, flags);
+  auto dudt = PackVariablesOnMesh(pmesh, dudt_name, flags);
+  auto qout = PackVariablesOnMesh(pmesh, out_name, flags);
+  par_for(
+      "StageUpdateOnMesh", DevSpace(), 0, qout.GetNBlocks() - 1, 0,
+      qout.GetNVars() - 1, pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        qout(b, n, k, j, i) = (wgt0 * q0(b, n, k, j, i) + wgt1 * q1(b, n, k, j, i)) +
+                              dt * dudt(b, n, k, j, i);
+      });
+  pmesh->FenceExecSpaces();
+}
+
 Real EstimateTimestep(Container<Real> &rc) {
   MeshBlock *pmb = rc.pmy_block;
   Real dt_min = std::numeric_limits<Real>::max();
@@ -183,20 +538,52 @@ void FillDerivedVariables::SetFillDerivedFunctions(FillDerivedFunc *pre,
   _post_package_fill = post;
 }
 
-TaskStatus FillDerivedVariables::FillDerived(Container<Real> &rc) {
+namespace {
+// runs the FillDerived functions of the packages that are (not) deferred until their
+// variables are read, between the pre and post functions. If there are none, nothing is
+// run at all, except for the pre and post functions of the non-deferred pass when no
+// package has a FillDerived.
+void FillPackages(Container<Real> &rc, const bool on_demand) {
+  int nrun = 0, nother = 0;
+  for (auto &pkg : rc.pmy_block->packages) {
+    auto &desc = pkg.second;
+    if (desc->FillDerived == nullptr) continue;
+    (desc->FillDerivedOnDemand() == on_demand ? nrun : nother)++;
+  }
+  if (nrun == 0 && (on_demand || nother > 0)) return;
   if (_pre_package_fill != nullptr) {
     _pre_package_fill(rc);
   }
   for (auto &pkg : rc.pmy_block->packages) {
     auto &desc = pkg.second;
-    if (desc->FillDerived != nullptr) {
+    if (desc->FillDerived != nullptr && desc->FillDerivedOnDemand() == on_demand) {
       desc->FillDerived(rc);
     }
   }
   if (_post_package_fill != nullptr) {
     _post_package_fill(rc);
   }
+}
+} // namespace
+
+TaskStatus FillDerivedVariables::FillDerived(Container<Real> &rc) {
+  FillPackages(rc, false);
+  rc.on_demand_current = false;
   return TaskStatus::complete;
 }
 
+TaskStatus FillDerivedVariables::FillOnDemand(Container<Real> &rc) {
+  if (!rc.on_demand_current) {
+    FillPackages(rc, true);
+    rc.on_demand_current = true;
+  }
+  return TaskStatus::complete;
+}
+
+void FillDerivedVariables::FillOnDemand(Mesh *pmesh) {
+  for (MeshBlock *pmb : pmesh->block_list) {
+    FillOnDemand(pmb->real_containers.Get());
+  }
+}
+
 } // namespace parthenon
@@ -13,6 +13,9 @@
 #ifndef INTERFACE_UPDATE_HPP_
 #define INTERFACE_UPDATE_HPP_
 
+#include <string>
+#include <vector>
+
 #include "athena.hpp"
 #include "interface/container.hpp"
 #include "mesh/mesh.hpp"
@@ -21,10 +24,83 @@ namespace parthenon {
 
 namespace Update {
 
+// A box of cells [is,ie]x[js,je]x[ks,ke] of a MeshBlock. The work of a stage can be split
+// into the interior, whose cells neither need ghost data nor end up in a send buffer, and
+// the shell around it, so that the interior is computed while messages are in flight.
+struct CellRegion {
+  int is, ie, js, je, ks, ke;
+  bool empty() const { return ie < is || je < js || ke < ks; }
+};
+
+// cells at least width cells away from the block faces in all active directions;
+// InteriorRegion(pmb, 0) is the whole block
+CellRegion InteriorRegion(MeshBlock *pmb, const int width);
+// disjoint regions covering all cells of the block outside InteriorRegion(pmb, width)
+std::vector<CellRegion> ShellRegions(MeshBlock *pmb, const int width);
+// smallest width for which the shell contains every cell packed into a send buffer
+int ShellWidth(MeshBlock *pmb);
+
 TaskStatus FluxDivergence(Container<Real> &in, Container<Real> &dudt_cont);
 void UpdateContainer(Container<Real> &in, Container<Real> &dudt_cont, const Real dt,
                      Container<Real> &out);
 void AverageContainers(Container<Real> &c1, Container<Real> &c2, const Real wgt1);
+
+// the same operations restricted to the given regions
+void FluxDivergenceInRegions(Container<Real> &in, Container<Real> &dudt_cont,
+                             const std::vector<CellRegion> &regions);
+void UpdateContainerInRegions(Container<Real> &in, Container<Real> &dudt_cont,
+                              const Real dt, Container<Real> &out,
+                              const std::vector<CellRegion> &regions);
+void AverageContainersInRegions(Container<Real> &c1, Container<Real> &c2,
+                                const Real wgt1,
+                                const std::vector<CellRegion> &regions);
+
+// out = wgt0 * u0 + wgt1 * u1 + dt * dudt for all independent variables, replacing an
+// AverageContainers/UpdateContainer pair with a single pass over the data. out may be
+// the same container as u0 or u1.
+// With tag_refinement, on the last stage, the kernels of the variables of AMRMinMax
+// criteria also reduce the min and max of component 0 of the new values over each
+// region for the tagging that follows (MeshRefinement::AddFusedExtrema), which then
+// reads no data at all. The same holds for LowStorageUpdate.
+void StageUpdate(Container<Real> &u0, Container<Real> &u1, Container<Real> &dudt_cont,
+                 const Real wgt0, const Real wgt1, const Real dt, Container<Real> &out,
+                 const bool tag_refinement = false);
+void StageUpdateInRegions(Container<Real> &u0, Container<Real> &u1,
+                          Container<Real> &dudt_cont, const Real wgt0, const Real wgt1,
+                          const Real dt, Container<Real> &out,
+                          const std::vector<CellRegion> &regions,
+                          const bool tag_refinement = false);
+
+// One stage of a low-storage Runge-Kutta scheme on the registers s1 (the state), s2 and
+// s3, for all independent variables and cell by cell:
+//   s2 = s2 + delta * s1       (s2 = delta * s1 and s3 = s1 on the first stage)
+//   s1 = gam1 * s1 + gam2 * s2 + gam3 * s3 + beta_dt * dudt
+// Registers a scheme does not need may be given as s1 itself if their weights are zero.
+void LowStorageUpdate(Container<Real> &s1, Container<Real> &s2, Container<Real> &s3,
+                      Container<Real> &dudt_cont, const Real delta, const Real gam1,
+                      const Real gam2, const Real gam3, const Real beta_dt,
+                      const bool first_stage, const bool tag_refinement = false);
+void LowStorageUpdateInRegions(Container<Real> &s1, Container<Real> &s2,
+                               Container<Real> &s3, Container<Real> &dudt_cont,
+                               const Real delta, const Real gam1, const Real gam2,
+                               const Real gam3, const Real beta_dt,
+                               const bool first_stage,
+                               const std::vector<CellRegion> &regions,
+                               const bool tag_refinement = false);
+
+// the same operations on every block of the rank with a single kernel launch each; the
+// containers are given by their names in MeshBlock::real_containers
+TaskStatus FluxDivergence(Mesh *pmesh, const std::string &in_name,
+                          const std::string &dudt_name);
+void UpdateContainer(Mesh *pmesh, const std::string &in_name,
+                     const std::string &dudt_name, const Real dt,
+                     const std::string &out_name);
+void AverageContainers(Mesh *pmesh, const std::string &c1_name,
+                       const std::string &c2_name, const Real wgt1);
+void StageUpdate(Mesh *pmesh, const std::string &u0_name, const std::string &u1_name,
+                 const std::string &dudt_name, const Real wgt0, const Real wgt1,
+                 const Real dt, const std::string &out_name);
+
 Real EstimateTimestep(Container<Real> &rc);
 
 } // namespace Update
@@ -33,7 +109,18 @@ namespace FillDerivedVariables {
 
 using FillDerivedFunc = void(Container<Real> &);
 void SetFillDerivedFunctions(FillDerivedFunc *pre, FillDerivedFunc *post);
+// Runs the FillDerived functions of the packages, between the pre and post functions.
+// Packages whose derived variables are all flagged Metadata::OnDemand are skipped and
+// only run by FillOnDemand(); if all packages with a FillDerived are skipped, so are the
+// pre and post functions.
 TaskStatus FillDerived(Container<Real> &rc);
+// Runs the pre function, the FillDerived functions skipped by FillDerived() and the post
+// function, unless they ran since the last FillDerived(). The outputs and the refinement
+// criteria call it before they read the variables; tasks reading OnDemand variables
+// have to do the same.
+TaskStatus FillOnDemand(Container<Real> &rc);
+// FillOnDemand() for the base container of every block of the rank
+void FillOnDemand(Mesh *pmesh);
 
 } // namespace FillDerivedVariables
 
@@ -0,0 +1,136 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#ifndef INTERFACE_UPDATE_TIMESTEP_HPP_
+#define INTERFACE_UPDATE_TIMESTEP_HPP_
+//! \file update_timestep.hpp
+//  \brief time step estimates on the device for all blocks of a rank, optionally fused
+//  with the update of the last stage. Separate from update.hpp, which mesh.hpp includes,
+//  because the templates below need the complete Mesh and MeshBlock.
+
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+#include "coordinates/device_coordinates.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "interface/metadata.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh.hpp"
+
+namespace parthenon {
+
+namespace Update {
+
+// Device time step estimates for every block of the rank in a single launch. cell_dt is
+// a device functor returning the stable time step of one interior cell,
+//   Real cell_dt(const MeshBlockPack<Real> &q, const DeviceCoordinates &coords,
+//                const int b, const int k, const int j, const int i)
+// with q the independent variables of the named container. The minimum of each block
+// is handed to MeshBlock::SetBlockTimestep; only these minima go back to the host.
+template <typename CellTimestep>
+void EstimateTimestep(Mesh *pmesh, const std::string &name, const CellTimestep &cell_dt);
+// StageUpdate(pmesh, ...) of the last stage fused with EstimateTimestep on out_name:
+// cell_dt is evaluated right after the cell is updated, so the state is read once
+template <typename CellTimestep>
+void StageUpdateAndEstimateTimestep(Mesh *pmesh, const std::string &u0_name,
+                                    const std::string &u1_name,
+                                    const std::string &dudt_name, const Real wgt0,
+                                    const Real wgt1, const Real dt,
+                                    const std::string &out_name,
+                                    const CellTimestep &cell_dt);
+
+namespace impl {
+
+// one team per block reduces f(b, k, j, i) over the interior cells to its minimum, which
+// is set as the time step of the block
+template <typename F>
+void SetBlockTimestepsFromMinima(Mesh *pmesh, const std::string &name,
+                                 const int nblocks, const F &f) {
+  MeshBlock *pmb = pmesh->pblock;
+  if (nblocks == 0) return;
+  const int is = pmb->is, js = pmb->js, ks = pmb->ks;
+  const int ni = pmb->ie + 1 - is, nj = pmb->je + 1 - js, nk = pmb->ke + 1 - ks;
+
+  ParArray1D<Real> minima(name + " minima", nblocks);
+  Kokkos::parallel_for(
+      name, team_policy(DevSpace(), nblocks, Kokkos::AUTO),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const int b = team_member.league_rank();
+        Real bmin;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, nk * nj * ni),
+            [&](const int idx, Real &lmin) {
+              const int k = ks + idx / (nj * ni);
+              const int j = js + (idx / ni) % nj;
+              const int i = is + idx % ni;
+              const Real d = f(b, k, j, i);
+              lmin = (d < lmin ? d : lmin);
+            },
+            Kokkos::Min<Real>(bmin));
+        Kokkos::single(Kokkos::PerTeam(team_member), [&]() { minima(b) = bmin; });
+      });
+  auto minima_h = Kokkos::create_mirror_view(minima);
+  Kokkos::deep_copy(minima_h, minima);
+  int b = 0;
+  for (; pmb != nullptr; pmb = pmb->next, b++) {
+    pmb->SetBlockTimestep(minima_h(b));
+  }
+}
+
+} // namespace impl
+
+template <typename CellTimestep>
+void EstimateTimestep(Mesh *pmesh, const std::string &name, const CellTimestep &cell_dt) {
+  if (pmesh->pblock == nullptr) return;
+  auto q = PackVariablesOnMesh(pmesh, name,
+                               std::vector<MetadataFlag>({Metadata::Independent}));
+  auto coords = PackCoordinatesOnMesh(pmesh);
+  impl::SetBlockTimestepsFromMinima(
+      pmesh, "EstimateTimestepOnMesh", q.GetNBlocks(),
+      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        return cell_dt(q, coords(b), b, k, j, i);
+      });
+}
+
+template <typename CellTimestep>
+void StageUpdateAndEstimateTimestep(Mesh *pmesh, const std::string &u0_name,
+                                    const std::string &u1_name,
+                                    const std::string &dudt_name, const Real wgt0,
+                                    const Real wgt1, const Real dt,
+                                    const std::string &out_name,
+                                    const CellTimestep &cell_dt) {
+  if (pmesh->pblock == nullptr) return;
+  const std::vector<MetadataFlag> flags({Metadata::Independent});
+  auto q0 = PackVariablesOnMesh(pmesh, u0_name, flags);
+  auto q1 = PackVariablesOnMesh(pmesh, u1_name, flags);
+  auto dudt = PackVariablesOnMesh(pmesh, dudt_name, flags);
+  auto qout = PackVariablesOnMesh(pmesh, out_name, flags);
+  auto coords = PackCoordinatesOnMesh(pmesh);
+  const int nvars = qout.GetNVars();
+  impl::SetBlockTimestepsFromMinima(
+      pmesh, "StageUpdateAndEstimateTimestepOnMesh", qout.GetNBlocks(),
+      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i) {
+        for (int n = 0; n < nvars; n++) {
+          qout(b, n, k, j, i) = (wgt0 * q0(b, n, k, j, i) + wgt1 * q1(b, n, k, j, i)) +
+                                dt * dudt(b, n, k, j, i);
+        }
+        return cell_dt(qout, coords(b), b, k, j, i);
+      });
+}
+
+} // namespace Update
+
+} // namespace parthenon
+
+#endif // INTERFACE_UPDATE_TIMESTEP_HPP_
@@ -14,11 +14,17 @@
 #include "interface/variable.hpp"
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 #include "bvals/cc/bvals_cc.hpp"
 #include "mesh/mesh.hpp"
 #include "parthenon_arrays.hpp"
 
+#ifdef KOKKOS_ENABLE_CUDA_UVM
+#include <cuda_runtime_api.h>
+#endif
+
 namespace parthenon {
 
 template <typename T>
@@ -44,6 +50,19 @@ std::string CellVariable<T>::info() {
   return s;
 }
 
+template <typename T>
+CellVariable<T>::~CellVariable() {
+  // the boundary variable refers to the arrays as well
+  vbvar.reset();
+  auto &pool = ArrayPool<T>::Instance();
+  pool.Release(data, stage_);
+  if (flux_.use_count() == 1) {
+    for (int i = 0; i < 3; i++)
+      pool.Release(flux_->arr[i]);
+  }
+  pool.Release(coarse_s);
+}
+
 // copy constructor
 template <typename T>
 std::shared_ptr<CellVariable<T>> CellVariable<T>::AllocateCopy(const bool allocComms,
@@ -57,8 +76,8 @@ std::shared_ptr<CellVariable<T>> CellVariable<T>::AllocateCopy(const bool allocC
     m.Set(Metadata::SharedComms);
   }
 
-  // make the new CellVariable
-  auto cv = std::make_shared<CellVariable<T>>(label(), dims, m);
+  // make the new CellVariable, drawing its data from the stage arrays of the pool
+  auto cv = std::make_shared<CellVariable<T>>(label(), dims, m, true);
 
   if (IsSet(Metadata::FillGhost)) {
     if (allocComms) {
@@ -68,10 +87,8 @@ std::shared_ptr<CellVariable<T>> CellVariable<T>::AllocateCopy(const bool allocC
       // Note that vbvar->var_cc will be set when stage is selected
       cv->vbvar = vbvar;
 
-      // fluxes, etc are always a copy
-      for (int i = 0; i < 3; i++) {
-        cv->flux[i] = flux[i];
-      }
+      // fluxes, etc are always shared, including the ones allocated later
+      cv->flux_ = flux_;
 
       // These members are pointers,
       // point at same memory as src
@@ -81,30 +98,124 @@ std::shared_ptr<CellVariable<T>> CellVariable<T>::AllocateCopy(const bool allocC
   return cv;
 }
 
+template <typename T>
+ParArrayND<T, Kokkos::LayoutStride>
+CellVariable<T>::ComponentInnermostArray(const std::string &label,
+                                         const std::array<int, 6> &dims) {
+  // the extents and strides of the dimensions nx6, nx5, nx4, nx3, nx2 and nx1
+  const int s1 = dims[3], s2 = s1 * dims[0], s3 = s2 * dims[1], s5 = s3 * dims[2];
+  const int s6 = s5 * dims[4];
+  Kokkos::LayoutStride layout(dims[5], s6, dims[4], s5, dims[3], 1, dims[2], s3, dims[1],
+                              s2, dims[0], s1);
+  return ParArrayND<T, Kokkos::LayoutStride>(
+      device_view_t<T, Kokkos::LayoutStride>(label + ".strided", layout));
+}
+
+template <typename T>
+void CellVariable<T>::MoveToSlab(const ParArrayND<T> &slab, const int offset) {
+  ParArrayND<T> old = data;
+  // an unmanaged view, the slab itself is kept alive by slab_
+  data = ParArrayND<T>(device_view_t<T>(slab.Get().data() + offset, GetDim(6), GetDim(5),
+                                        GetDim(4), GetDim(3), GetDim(2), GetDim(1)));
+  Kokkos::deep_copy(data.Get(), old.Get());
+  slab_ = slab;
+  if (vbvar) resetBoundary();
+  ArrayPool<T>::Instance().Release(old, stage_);
+}
+
+template <typename T>
+int CellVariable<T>::device_epoch_ = 0;
+template <typename T>
+bool CellVariable<T>::uvm_prefetch_ = true;
+
+template <typename T>
+void CellVariable<T>::SyncToHost() {
+  if (host_src_ != data.Get().data()) {
+    // first call, or data was moved into a slab since
+    host_data_ = data.GetHostMirror();
+    host_src_ = data.Get().data();
+    host_epoch_ = -1;
+    host_modified_ = false;
+  }
+  if (host_epoch_ == device_epoch_ || host_modified_) return;
+  ContiguousData();
+#ifdef KOKKOS_ENABLE_CUDA_UVM
+  // host_data_ aliases the managed data, which would otherwise migrate page by page
+  if (uvm_prefetch_) {
+    cudaMemPrefetchAsync(data.Get().data(), data.Get().span() * sizeof(T),
+                         cudaCpuDeviceId);
+    on_host_ = true;
+  }
+  Kokkos::fence();
+#else
+  host_data_.DeepCopy(data);
+#endif
+  host_epoch_ = device_epoch_;
+}
+
+template <typename T>
+void CellVariable<T>::SyncToDevice() {
+  if (!host_modified_) return;
+#ifdef KOKKOS_ENABLE_CUDA_UVM
+  PrefetchToDevice();
+#else
+  data.DeepCopy(host_data_);
+#endif
+  if (IsSet(Metadata::ComponentInnermost)) strided.DeepCopy(data);
+  host_modified_ = false;
+}
+
+template <typename T>
+void CellVariable<T>::PrefetchToDevice() {
+#ifdef KOKKOS_ENABLE_CUDA_UVM
+  if (!on_host_) return;
+  cudaMemPrefetchAsync(data.Get().data(), data.Get().span() * sizeof(T),
+                       Kokkos::Cuda().cuda_device());
+  on_host_ = false;
+#endif
+}
+
+template <typename T>
+ParArrayND<T> &CellVariable<T>::GetFlux(const int dir) {
+  if (!flux_) {
+    throw std::invalid_argument("Variable " + label() + " has no fluxes");
+  }
+  ParArrayND<T> &flux = flux_->arr[dir];
+  if (!flux_->allocated[dir]) {
+    flux = ArrayPool<T>::Instance().Get(
+        label() + ".flux" + std::to_string(dir),
+        {{GetDim(6), GetDim(5), GetDim(4), GetDim(3), GetDim(2), GetDim(1)}});
+    flux_->allocated[dir] = true;
+    // the boundary variable keeps its own handles for the flux correction
+    if (vbvar) {
+      if (dir == X1DIR) vbvar->x1flux = flux;
+      if (dir == X2DIR) vbvar->x2flux = flux;
+      if (dir == X3DIR) vbvar->x3flux = flux;
+    }
+  }
+  return flux;
+}
+
 /// allocate communication space based on info in MeshBlock
 /// Initialize a 6D variable
 template <typename T>
 void CellVariable<T>::allocateComms(MeshBlock *pmb) {
   if (!pmb) return;
 
-  // set up fluxes
+  // set up fluxes, which are only allocated by GetFlux()
   std::string base_name = label();
-  if (IsSet(Metadata::Independent)) {
-    flux[0] = ParArrayND<T>(base_name + ".flux0", GetDim(6), GetDim(5), GetDim(4),
-                            GetDim(3), GetDim(2), GetDim(1));
-    if (pmb->pmy_mesh->ndim >= 2)
-      flux[1] = ParArrayND<T>(base_name + ".flux1", GetDim(6), GetDim(5), GetDim(4),
-                              GetDim(3), GetDim(2), GetDim(1));
-    if (pmb->pmy_mesh->ndim >= 3)
-      flux[2] = ParArrayND<T>(base_name + ".flux2", GetDim(6), GetDim(5), GetDim(4),
-                              GetDim(3), GetDim(2), GetDim(1));
-  }
+  ParArrayND<T> noflux[3];
+  if (IsSet(Metadata::Independent)) flux_ = std::make_shared<FluxArrays>();
   if (pmb->pmy_mesh->multilevel)
-    coarse_s = ParArrayND<T>(base_name + ".coarse", GetDim(6), GetDim(5), GetDim(4),
-                             pmb->ncc3, pmb->ncc2, pmb->ncc1);
+    coarse_s = ArrayPool<T>::Instance().Get(
+        base_name + ".coarse",
+        {{GetDim(6), GetDim(5), GetDim(4), pmb->ncc3, pmb->ncc2, pmb->ncc1}});
 
   // Create the boundary object
-  vbvar = std::make_shared<CellCenteredBoundaryVariable>(pmb, data, coarse_s, flux);
+  vbvar = std::make_shared<CellCenteredBoundaryVariable>(
+      pmb, data, coarse_s, flux_ ? flux_->arr : noflux);
+  vbvar->single_precision_comm = IsSet(Metadata::SinglePrecisionComm);
+  vbvar->var_strided = strided;
 
   // enroll CellCenteredBoundaryVariable object
   vbvar->bvar_index = pmb->pbval->bvars.size();
@@ -114,6 +225,24 @@ void CellVariable<T>::allocateComms(MeshBlock *pmb) {
   mpiStatus = false;
 }
 
+template <typename T>
+void CellVariable<T>::AccountMemory(MemoryUsage::Accounting &acc) const {
+  acc.AddView(label_, stage_ ? "stage data" : "data", data.Get());
+  acc.AddView(label_, "strided", strided.Get());
+  if (flux_) {
+    for (int d = 0; d < 3; d++) {
+      if (flux_->allocated[d]) acc.AddView(label_, "flux", flux_->arr[d].Get());
+    }
+  }
+  acc.AddView(label_, "coarse", coarse_s.Get());
+  if (vbvar) {
+    acc.AddView(label_, "coarse", vbvar->coarse_buf.Get());
+    vbvar->AccountMemory(acc, label_);
+  }
+  // without a device of its own the host copy is data itself, which counts once
+  acc.AddView(label_, "host copy", host_data_.Get());
+}
+
 // TODO(jcd): clean these next two info routines up
 template <typename T>
 std::string FaceVariable<T>::info() {
@@ -38,6 +38,8 @@
 #include "bvals/cc/bvals_cc.hpp"
 #include "interface/metadata.hpp"
 #include "parthenon_arrays.hpp"
+#include "utils/array_pool.hpp"
+#include "utils/memory_usage.hpp"
 
 namespace parthenon {
 
@@ -46,11 +48,18 @@ class MeshBlock;
 template <typename T>
 class CellVariable {
  public:
-  /// Initialize a 6D variable
+  /// Initialize a 6D variable, stage is set for the copies in stage containers
   CellVariable<T>(const std::string label, const std::array<int, 6> dims,
-                  const Metadata &metadata)
-      : data(label, dims[5], dims[4], dims[3], dims[2], dims[1], dims[0]),
-        mpiStatus(false), m_(metadata) {}
+                  const Metadata &metadata, const bool stage = false)
+      : data(ArrayPool<T>::Instance().Get(
+            label, {{dims[5], dims[4], dims[3], dims[2], dims[1], dims[0]}}, stage)),
+        mpiStatus(false), m_(metadata), label_(label), stage_(stage) {
+    if (metadata.IsSet(Metadata::ComponentInnermost)) {
+      strided = ComponentInnermostArray(label, dims);
+    }
+  }
+  // hands the arrays no other variable refers to back to the ArrayPool
+  ~CellVariable();
 
   // make a new CellVariable based on an existing one
   std::shared_ptr<CellVariable<T>> AllocateCopy(const bool allocComms = false,
@@ -67,7 +76,7 @@ class CellVariable {
   auto GetDim(const int i) const { return data.GetDim(i); }
 
   ///< retrieve label for variable
-  const std::string label() const { return data.label(); }
+  const std::string label() const { return label_; }
 
   ///< retrieve metadata for variable
   Metadata metadata() const { return m_; }
@@ -80,20 +89,100 @@ class CellVariable {
   /// allocate communication space based on info in MeshBlock
   void allocateComms(MeshBlock *pmb);
 
-  /// Repoint vbvar's var_cc array at the current variable
-  void resetBoundary() { vbvar->var_cc = data; }
+  /// Repoint vbvar's var_cc (and var_strided) array at the current variable
+  void resetBoundary() {
+    vbvar->var_cc = data;
+    vbvar->var_strided = strided;
+  }
+
+  /// Move data into slab (storage shared by the variables of a block) starting at
+  /// element offset, keeping its contents
+  void MoveToSlab(const ParArrayND<T> &slab, const int offset);
 
   bool IsSet(const MetadataFlag bit) const { return m_.IsSet(bit); }
 
+  using HostArray = decltype(std::declval<ParArrayND<T> &>().GetHostMirror());
+  /// Host copy of data for host code such as outputs, kept in the spirit of
+  /// Kokkos::DualView: GetHostData() syncs it to the device data and returns it. Host
+  /// code writing to it calls MarkHostModified() and SyncToDevice() afterwards. With UVM
+  /// (KOKKOS_ENABLE_CUDA_UVM) it is data itself, which is prefetched to the host unless
+  /// <mesh>/uvm_prefetch is false. For a ComponentInnermost variable, the sync goes
+  /// through data, which is refreshed from strided first.
+  HostArray &GetHostData() {
+    SyncToHost();
+    return host_data_;
+  }
+  /// copies data to the host copy unless the copy is current, i.e., neither this
+  /// variable nor all variables were marked modified on the device since the last copy,
+  /// or unless the host copy itself was modified
+  void SyncToHost();
+  /// copies the host copy to data if it was marked modified
+  void SyncToDevice();
+  /// With UVM, prefetches data back to the device if GetHostData moved it to the host
+  void PrefetchToDevice();
+  void MarkHostModified() { host_modified_ = true; }
+  /// the host copy of this variable is stale
+  void MarkDeviceModified() { host_epoch_ = -1; }
+  /// the host copies of all variables are stale, which Outputs::MakeOutputs assumes
+  /// each time it is called
+  static void MarkAllDeviceModified() { device_epoch_++; }
+  static void SetUVMPrefetch(const bool prefetch) { uvm_prefetch_ = prefetch; }
+
+  ///
+  /// The flux of an Independent variable in direction dir (X1DIR, X2DIR or X3DIR).
+  /// Flux arrays are allocated on the first request, so that directions and
+  /// variables no task computes fluxes for cost no memory.  Copies sharing the
+  /// communication space (see AllocateCopy) share the fluxes as well.
+  ParArrayND<T> &GetFlux(const int dir);
+  bool IsFluxAllocated(const int dir) const { return flux_ && flux_->allocated[dir]; }
+
+  /// adds data ("data" or, in a stage container, "stage data"), strided, the fluxes, the
+  /// coarse buffer, the communication buffers and the host copy of this variable to acc
+  void AccountMemory(MemoryUsage::Accounting &acc) const;
+
   ParArrayND<T> data;
-  ParArrayND<T> flux[3];  // used for boundary calculation
+  /// With Metadata::ComponentInnermost, the storage of the variable: the same shape as
+  /// data, but with the component index n moving fastest, for kernels that work on all
+  /// components of a cell.  data is then a copy in the usual layout that the framework
+  /// refreshes from strided to pack boundary buffers and write outputs, and whose
+  /// received ghost zones it copies back.  Empty without the flag.
+  ParArrayND<T, Kokkos::LayoutStride> strided;
+  /// data, refreshed from strided first for a ComponentInnermost variable, for code that
+  /// reads the variable in the usual layout
+  ParArrayND<T> &ContiguousData() {
+    if (IsSet(Metadata::ComponentInnermost)) data.DeepCopy(strided);
+    return data;
+  }
   ParArrayND<T> coarse_s; // used for sending coarse boundary calculation
   // used in case of cell boundary communication
   std::shared_ptr<CellCenteredBoundaryVariable> vbvar;
   bool mpiStatus;
 
  private:
+  // a rank 6 array of dims (nx1 first, as for the constructor) in which the component
+  // index nx4 moves fastest, followed by nx1, nx2, nx3, nx5 and nx6
+  static ParArrayND<T, Kokkos::LayoutStride>
+  ComponentInnermostArray(const std::string &label, const std::array<int, 6> &dims);
+
   Metadata m_;
+  std::string label_; // not data.label(), as data may come from the ArrayPool
+  ParArrayND<T> slab_; // keeps the storage alive if data points into a slab
+  bool stage_;         // data is pooled with the stage arrays
+
+  HostArray host_data_;
+  const T *host_src_ = nullptr; // data host_data_ was made for
+  int host_epoch_ = -1;         // device_epoch_ at the last copy to the host
+  bool host_modified_ = false;  // host_data_ has writes data does not have yet
+  bool on_host_ = false;        // prefetched to the host (UVM)
+  static int device_epoch_;
+  static bool uvm_prefetch_;
+
+  // used for boundary calculation, shared with the copies of the variable
+  struct FluxArrays {
+    ParArrayND<T> arr[3];
+    bool allocated[3] = {false, false, false};
+  };
+  std::shared_ptr<FluxArrays> flux_;
 };
 
 ///
@@ -24,6 +24,10 @@
 
 #include <Kokkos_Core.hpp>
 
+#include "defs.hpp"
+#include "utils/loop_pattern_tuner.hpp"
+#include "utils/profiling.hpp"
+
 namespace parthenon {
 
 #ifdef KOKKOS_ENABLE_CUDA_UVM
@@ -34,6 +38,13 @@ using DevSpace = Kokkos::DefaultExecutionSpace;
 using HostSpace = Kokkos::HostSpace;
 #endif
 
+// The kernels run on a GPU, where the patterns that are plain host loops (SimdFor) or
+// spread the inner loop over the vector lanes of single threads (TPTVR) do not apply.
+#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP) ||                         \
+    defined(KOKKOS_ENABLE_SYCL)
+#define PARTHENON_GPU_BACKEND
+#endif
+
 using LayoutWrapper = Kokkos::LayoutRight;
 
 template <typename T>
@@ -49,9 +60,46 @@ using ParArray5D = Kokkos::View<T *****, LayoutWrapper, DevSpace>;
 template <typename T>
 using ParArray6D = Kokkos::View<T ******, LayoutWrapper, DevSpace>;
 
+// MPI communication buffers live in device memory by default, so that a CUDA-aware MPI
+// library reads and writes them directly. Without one, HOST_COMM_BUFFERS places them in
+// pinned host memory, which the kernels packing and unpacking them can still access.
+#if defined(HOST_COMM_BUFFERS) && defined(KOKKOS_ENABLE_CUDA)
+using BufMemSpace = Kokkos::CudaHostPinnedSpace;
+#elif defined(HOST_COMM_BUFFERS) && defined(KOKKOS_ENABLE_HIP)
+using BufMemSpace = Kokkos::Experimental::HIPHostPinnedSpace;
+#elif defined(HOST_COMM_BUFFERS) && defined(KOKKOS_ENABLE_SYCL)
+using BufMemSpace = Kokkos::Experimental::SYCLHostUSMSpace;
+#else
+using BufMemSpace = DevSpace;
+#endif
+
+template <typename T>
+using BufArray1D = Kokkos::View<T *, LayoutWrapper, BufMemSpace>;
+
 using team_policy = Kokkos::TeamPolicy<>;
 using member_type = Kokkos::TeamPolicy<>::member_type;
 
+// Team size and vector length of the TeamPolicy loop patterns, set at configure time by
+// PAR_TEAM_SIZE and PAR_VECTOR_LENGTH (0 leaves the choice to Kokkos). Only the TPTVR
+// and TPTTRTVR patterns spread the i loop over vector lanes; the TPTTR ones run with a
+// single lane per thread, as their inner TeamThreadRange would repeat on every lane.
+inline team_policy LoopTeamPolicy(DevSpace exec_space, const int league_size,
+                                  const bool vector) {
+  const int vector_length = (vector && PAR_VECTOR_LENGTH > 0) ? PAR_VECTOR_LENGTH : 1;
+  if (PAR_TEAM_SIZE > 0) {
+    return team_policy(exec_space, league_size, PAR_TEAM_SIZE, vector_length);
+  }
+  return team_policy(exec_space, league_size, Kokkos::AUTO, vector_length);
+}
+
+// unmanaged views into the scratch memory of a team, see par_for_outer
+template <typename T>
+using ScratchPad1D = Kokkos::View<T *, LayoutWrapper, member_type::scratch_memory_space,
+                                  Kokkos::MemoryUnmanaged>;
+template <typename T>
+using ScratchPad2D = Kokkos::View<T **, LayoutWrapper, member_type::scratch_memory_space,
+                                  Kokkos::MemoryUnmanaged>;
+
 // Defining tags to determine loop_patterns using a tag dispatch design pattern
 static struct LoopPatternSimdFor {
 } loop_pattern_simdfor_tag;
@@ -65,29 +113,27 @@ static struct LoopPatternTPTVR {
 } loop_pattern_tptvr_tag;
 static struct LoopPatternTPTTRTVR {
 } loop_pattern_tpttrtvr_tag;
+static struct LoopPatternRuntime {
+} loop_pattern_runtime_tag;
 static struct LoopPatternUndefined {
 } loop_pattern_undefined_tag;
 
-// TODO(pgrete) I don't like this and would prefer to make the default a
-// parameter that is read from the parameter file rather than a compile time
-// constant. Any suggestions on how to do this elegantly? One could use
-// parthenon::Globals but then this unit here would get a dependcy on the global
-// part whereas right now it's completely encapuslated.
-// Alternatively, I could think of putting all this in the parthenon::wrapper
-// namespace so that the default variable can live there.
-// Again, I'm open for suggestions.
+// The default pattern is set by PAR_LOOP_LAYOUT at configure time. With RUNTIME_LOOP it
+// is instead chosen per kernel while the code runs, see utils/loop_pattern_tuner.hpp.
 #ifdef MANUAL1D_LOOP
 #define DEFAULT_LOOP_PATTERN loop_pattern_flatrange_tag
 #elif defined SIMDFOR_LOOP
 #define DEFAULT_LOOP_PATTERN loop_pattern_simdfor_tag
 #elif defined MDRANGE_LOOP
 #define DEFAULT_LOOP_PATTERN loop_pattern_mdrange_tag
-#elif defined TP_TTR_LOOP
+#elif defined TPTTR_LOOP
 #define DEFAULT_LOOP_PATTERN loop_pattern_tpttr_tag
-#elif defined TP_TVR_LOOP
+#elif defined TPTVR_LOOP
 #define DEFAULT_LOOP_PATTERN loop_pattern_tptvr_tag
 #elif defined TPTTRTVR_LOOP
 #define DEFAULT_LOOP_PATTERN loop_pattern_tpttrtvr_tag
+#elif defined RUNTIME_LOOP
+#define DEFAULT_LOOP_PATTERN loop_pattern_runtime_tag
 #else
 #define DEFAULT_LOOP_PATTERN loop_pattern_undefined_tag
 #endif
@@ -129,6 +175,16 @@ inline void par_for(const std::string &name, DevSpace exec_space, const int &nl,
           function);
 }
 
+// 5D default loop pattern, the outermost index usually enumerates the blocks of a pack
+template <typename Function>
+inline void par_for(const std::string &name, DevSpace exec_space, const int &bl,
+                    const int &bu, const int &nl, const int &nu, const int &kl,
+                    const int &ku, const int &jl, const int &ju, const int &il,
+                    const int &iu, const Function &function) {
+  par_for(DEFAULT_LOOP_PATTERN, name, exec_space, bl, bu, nl, nu, kl, ku, jl, ju, il, iu,
+          function);
+}
+
 // 1D loop using MDRange loops
 template <typename Function>
 inline void par_for(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
@@ -197,7 +253,7 @@ inline void par_for(LoopPatternTPTTR, const std::string &name, DevSpace exec_spa
   const int Nj = ju - jl + 1;
   const int NkNj = Nk * Nj;
   Kokkos::parallel_for(
-      name, team_policy(exec_space, NkNj, Kokkos::AUTO),
+      name, LoopTeamPolicy(exec_space, NkNj, false),
       KOKKOS_LAMBDA(member_type team_member) {
         const int k = team_member.league_rank() / Nj + kl;
         const int j = team_member.league_rank() % Nj + jl;
@@ -216,7 +272,7 @@ inline void par_for(LoopPatternTPTVR, const std::string &name, DevSpace exec_spa
   const int Nj = ju - jl + 1;
   const int NkNj = Nk * Nj;
   Kokkos::parallel_for(
-      name, team_policy(exec_space, NkNj, Kokkos::AUTO),
+      name, LoopTeamPolicy(exec_space, NkNj, true),
       KOKKOS_LAMBDA(member_type team_member) {
         const int k = team_member.league_rank() / Nj + kl;
         const int j = team_member.league_rank() % Nj + jl;
@@ -232,7 +288,7 @@ inline void par_for(LoopPatternTPTTRTVR, const std::string &name, DevSpace exec_
                     const int &il, const int &iu, const Function &function) {
   const int Nk = ku - kl + 1;
   Kokkos::parallel_for(
-      name, team_policy(exec_space, Nk, Kokkos::AUTO),
+      name, LoopTeamPolicy(exec_space, Nk, true),
       KOKKOS_LAMBDA(member_type team_member) {
         const int k = team_member.league_rank() + kl;
         Kokkos::parallel_for(
@@ -248,13 +304,12 @@ template <typename Function>
 inline void par_for(LoopPatternSimdFor, const std::string &name, DevSpace exec_space,
                     const int &kl, const int &ku, const int &jl, const int &ju,
                     const int &il, const int &iu, const Function &function) {
-  Kokkos::Profiling::pushRegion(name);
+  ProfilingRegion region(name);
   for (auto k = kl; k <= ku; k++)
     for (auto j = jl; j <= ju; j++)
 #pragma omp simd
       for (auto i = il; i <= iu; i++)
         function(k, j, i);
-  Kokkos::Profiling::popRegion();
 }
 
 // 4D loop using Kokkos 1D Range
@@ -309,7 +364,7 @@ inline void par_for(LoopPatternTPTTR, const std::string &name, DevSpace exec_spa
   const int NkNj = Nk * Nj;
   const int NnNkNj = Nn * Nk * Nj;
   Kokkos::parallel_for(
-      name, team_policy(exec_space, NnNkNj, Kokkos::AUTO),
+      name, LoopTeamPolicy(exec_space, NnNkNj, false),
       KOKKOS_LAMBDA(member_type team_member) {
         int n = team_member.league_rank() / NkNj;
         int k = (team_member.league_rank() - n * NkNj) / Nj;
@@ -333,7 +388,7 @@ inline void par_for(LoopPatternTPTVR, const std::string &name, DevSpace exec_spa
   const int NkNj = Nk * Nj;
   const int NnNkNj = Nn * Nk * Nj;
   Kokkos::parallel_for(
-      name, team_policy(exec_space, NnNkNj, Kokkos::AUTO),
+      name, LoopTeamPolicy(exec_space, NnNkNj, true),
       KOKKOS_LAMBDA(member_type team_member) {
         int n = team_member.league_rank() / NkNj;
         int k = (team_member.league_rank() - n * NkNj) / Nj;
@@ -354,7 +409,7 @@ inline void par_for(LoopPatternTPTTRTVR, const std::string &name, DevSpace exec_
   const int Nk = ku - kl + 1;
   const int NnNk = Nn * Nk;
   Kokkos::parallel_for(
-      name, team_policy(exec_space, NnNk, Kokkos::AUTO),
+      name, LoopTeamPolicy(exec_space, NnNk, true),
       KOKKOS_LAMBDA(member_type team_member) {
         int n = team_member.league_rank() / Nk + nl;
         int k = team_member.league_rank() % Nk + kl;
@@ -371,14 +426,1034 @@ template <typename Function>
 inline void par_for(LoopPatternSimdFor, const std::string &name, DevSpace exec_space,
                     const int nl, const int nu, const int kl, const int ku, const int jl,
                     const int ju, const int il, const int iu, const Function &function) {
-  Kokkos::Profiling::pushRegion(name);
+  ProfilingRegion region(name);
   for (auto n = nl; n <= nu; n++)
     for (auto k = kl; k <= ku; k++)
       for (auto j = jl; j <= ju; j++)
 #pragma omp simd
         for (auto i = il; i <= iu; i++)
           function(n, k, j, i);
-  Kokkos::Profiling::popRegion();
+}
+
+// 5D loop using Kokkos 1D Range
+template <typename Function>
+inline void par_for(LoopPatternFlatRange, const std::string &name, DevSpace exec_space,
+                    const int bl, const int bu, const int nl, const int nu, const int kl,
+                    const int ku, const int jl, const int ju, const int il, const int iu,
+                    const Function &function) {
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NbNnNkNjNi = Nb * Nn * Nk * Nj * Ni;
+  const int NnNkNjNi = Nn * Nk * Nj * Ni;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_for(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NbNnNkNjNi),
+      KOKKOS_LAMBDA(const int &idx) {
+        int b = idx / NnNkNjNi;
+        int n = (idx - b * NnNkNjNi) / NkNjNi;
+        int k = (idx - b * NnNkNjNi - n * NkNjNi) / NjNi;
+        int j = (idx - b * NnNkNjNi - n * NkNjNi - k * NjNi) / Ni;
+        int i = idx - b * NnNkNjNi - n * NkNjNi - k * NjNi - j * Ni;
+        b += bl;
+        n += nl;
+        k += kl;
+        j += jl;
+        i += il;
+        function(b, n, k, j, i);
+      });
+}
+
+// 5D loop using MDRange loops
+template <typename Function>
+inline void par_for(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
+                    const int bl, const int bu, const int nl, const int nu, const int kl,
+                    const int ku, const int jl, const int ju, const int il, const int iu,
+                    const Function &function) {
+  Kokkos::parallel_for(name,
+                       Kokkos::Experimental::require(
+                           Kokkos::MDRangePolicy<Kokkos::Rank<5>>(
+                               exec_space, {bl, nl, kl, jl, il},
+                               {bu + 1, nu + 1, ku + 1, ju + 1, iu + 1}),
+                           Kokkos::Experimental::WorkItemProperty::HintLightWeight),
+                       function);
+}
+
+// 5D loop using TeamPolicy loop with inner TeamThreadRange
+template <typename Function>
+inline void par_for(LoopPatternTPTTR, const std::string &name, DevSpace exec_space,
+                    const int bl, const int bu, const int nl, const int nu, const int kl,
+                    const int ku, const int jl, const int ju, const int il, const int iu,
+                    const Function &function) {
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * Nk * Nj;
+  const int NbNnNkNj = Nb * Nn * Nk * Nj;
+  Kokkos::parallel_for(
+      name, LoopTeamPolicy(exec_space, NbNnNkNj, false),
+      KOKKOS_LAMBDA(member_type team_member) {
+        int b = team_member.league_rank() / NnNkNj;
+        int n = (team_member.league_rank() - b * NnNkNj) / NkNj;
+        int k = (team_member.league_rank() - b * NnNkNj - n * NkNj) / Nj;
+        int j = team_member.league_rank() - b * NnNkNj - n * NkNj - k * Nj + jl;
+        b += bl;
+        n += nl;
+        k += kl;
+        Kokkos::parallel_for(Kokkos::TeamThreadRange<>(team_member, il, iu + 1),
+                             [&](const int i) { function(b, n, k, j, i); });
+      });
+}
+
+// 5D loop using TeamPolicy loop with inner ThreadVectorRange
+template <typename Function>
+inline void par_for(LoopPatternTPTVR, const std::string &name, DevSpace exec_space,
+                    const int bl, const int bu, const int nl, const int nu, const int kl,
+                    const int ku, const int jl, const int ju, const int il, const int iu,
+                    const Function &function) {
+  // TODO(pgrete) if exec space is Cuda,throw error
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * Nk * Nj;
+  const int NbNnNkNj = Nb * Nn * Nk * Nj;
+  Kokkos::parallel_for(
+      name, LoopTeamPolicy(exec_space, NbNnNkNj, true),
+      KOKKOS_LAMBDA(member_type team_member) {
+        int b = team_member.league_rank() / NnNkNj;
+        int n = (team_member.league_rank() - b * NnNkNj) / NkNj;
+        int k = (team_member.league_rank() - b * NnNkNj - n * NkNj) / Nj;
+        int j = team_member.league_rank() - b * NnNkNj - n * NkNj - k * Nj + jl;
+        b += bl;
+        n += nl;
+        k += kl;
+        Kokkos::parallel_for(Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+                             [&](const int i) { function(b, n, k, j, i); });
+      });
+}
+
+// 5D loop using TeamPolicy with nested TeamThreadRange and ThreadVectorRange
+template <typename Function>
+inline void par_for(LoopPatternTPTTRTVR, const std::string &name, DevSpace exec_space,
+                    const int bl, const int bu, const int nl, const int nu, const int kl,
+                    const int ku, const int jl, const int ju, const int il, const int iu,
+                    const Function &function) {
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int NnNk = Nn * Nk;
+  const int NbNnNk = Nb * Nn * Nk;
+  Kokkos::parallel_for(
+      name, LoopTeamPolicy(exec_space, NbNnNk, true),
+      KOKKOS_LAMBDA(member_type team_member) {
+        int b = team_member.league_rank() / NnNk;
+        int n = (team_member.league_rank() - b * NnNk) / Nk;
+        int k = team_member.league_rank() - b * NnNk - n * Nk + kl;
+        b += bl;
+        n += nl;
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange<>(team_member, jl, ju + 1), [&](const int j) {
+              Kokkos::parallel_for(Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+                                   [&](const int i) { function(b, n, k, j, i); });
+            });
+      });
+}
+
+// 5D loop using SIMD FOR loops
+template <typename Function>
+inline void par_for(LoopPatternSimdFor, const std::string &name, DevSpace exec_space,
+                    const int bl, const int bu, const int nl, const int nu, const int kl,
+                    const int ku, const int jl, const int ju, const int il, const int iu,
+                    const Function &function) {
+  ProfilingRegion region(name);
+  for (auto b = bl; b <= bu; b++)
+    for (auto n = nl; n <= nu; n++)
+      for (auto k = kl; k <= ku; k++)
+        for (auto j = jl; j <= ju; j++)
+#pragma omp simd
+          for (auto i = il; i <= iu; i++)
+            function(b, n, k, j, i);
+}
+
+// Hierarchical loops for kernels that stage data in team scratch memory. par_for_outer
+// launches one team per iteration of its outer indices and calls
+// function(team_member, indices...), with scratch_size_in_bytes of scratch memory per
+// team at scratch_level (0 is the small, fast level, 1 the larger, slower one). Within
+// the team, par_for_inner distributes the inner indices over the team's threads and
+// vector lanes, and ScratchPad1D/2D views wrap team_member.team_scratch(scratch_level).
+// Passes that read what an earlier pass wrote to scratch need a team_barrier() between
+// them.
+
+// 1D outer loop
+template <typename Function>
+inline void par_for_outer(const std::string &name, DevSpace exec_space,
+                          const size_t &scratch_size_in_bytes, const int &scratch_level,
+                          const int &kl, const int &ku, const Function &function) {
+  const int Nk = ku - kl + 1;
+  Kokkos::parallel_for(
+      name,
+      team_policy(exec_space, Nk, Kokkos::AUTO)
+          .set_scratch_size(scratch_level, Kokkos::PerTeam(scratch_size_in_bytes)),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const int k = team_member.league_rank() + kl;
+        function(team_member, k);
+      });
+}
+
+// 2D outer loop
+template <typename Function>
+inline void par_for_outer(const std::string &name, DevSpace exec_space,
+                          const size_t &scratch_size_in_bytes, const int &scratch_level,
+                          const int &kl, const int &ku, const int &jl, const int &ju,
+                          const Function &function) {
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  Kokkos::parallel_for(
+      name,
+      team_policy(exec_space, NkNj, Kokkos::AUTO)
+          .set_scratch_size(scratch_level, Kokkos::PerTeam(scratch_size_in_bytes)),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const int k = team_member.league_rank() / Nj + kl;
+        const int j = team_member.league_rank() % Nj + jl;
+        function(team_member, k, j);
+      });
+}
+
+// 3D outer loop
+template <typename Function>
+inline void par_for_outer(const std::string &name, DevSpace exec_space,
+                          const size_t &scratch_size_in_bytes, const int &scratch_level,
+                          const int &nl, const int &nu, const int &kl, const int &ku,
+                          const int &jl, const int &ju, const Function &function) {
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * NkNj;
+  Kokkos::parallel_for(
+      name,
+      team_policy(exec_space, NnNkNj, Kokkos::AUTO)
+          .set_scratch_size(scratch_level, Kokkos::PerTeam(scratch_size_in_bytes)),
+      KOKKOS_LAMBDA(member_type team_member) {
+        int n = team_member.league_rank() / NkNj;
+        int k = (team_member.league_rank() - n * NkNj) / Nj;
+        int j = team_member.league_rank() - n * NkNj - k * Nj + jl;
+        n += nl;
+        k += kl;
+        function(team_member, n, k, j);
+      });
+}
+
+// 4D outer loop, the outermost index usually enumerates the blocks of a pack
+template <typename Function>
+inline void par_for_outer(const std::string &name, DevSpace exec_space,
+                          const size_t &scratch_size_in_bytes, const int &scratch_level,
+                          const int &bl, const int &bu, const int &nl, const int &nu,
+                          const int &kl, const int &ku, const int &jl, const int &ju,
+                          const Function &function) {
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * NkNj;
+  const int NbNnNkNj = Nb * NnNkNj;
+  Kokkos::parallel_for(
+      name,
+      team_policy(exec_space, NbNnNkNj, Kokkos::AUTO)
+          .set_scratch_size(scratch_level, Kokkos::PerTeam(scratch_size_in_bytes)),
+      KOKKOS_LAMBDA(member_type team_member) {
+        int b = team_member.league_rank() / NnNkNj;
+        int n = (team_member.league_rank() - b * NnNkNj) / NkNj;
+        int k = (team_member.league_rank() - b * NnNkNj - n * NkNj) / Nj;
+        int j = team_member.league_rank() - b * NnNkNj - n * NkNj - k * Nj + jl;
+        b += bl;
+        n += nl;
+        k += kl;
+        function(team_member, b, n, k, j);
+      });
+}
+
+// 1D inner loop over the threads and vector lanes of a team
+template <typename Function>
+KOKKOS_FORCEINLINE_FUNCTION void par_for_inner(const member_type &team_member,
+                                               const int &il, const int &iu,
+                                               const Function &function) {
+  Kokkos::parallel_for(Kokkos::TeamVectorRange<>(team_member, il, iu + 1), function);
+}
+
+// 2D inner loop, j over the threads and i over the vector lanes of a team
+template <typename Function>
+KOKKOS_FORCEINLINE_FUNCTION void par_for_inner(const member_type &team_member,
+                                               const int &jl, const int &ju,
+                                               const int &il, const int &iu,
+                                               const Function &function) {
+  Kokkos::parallel_for(Kokkos::TeamThreadRange<>(team_member, jl, ju + 1),
+                       [&](const int j) {
+                         Kokkos::parallel_for(
+                             Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+                             [&](const int i) { function(j, i); });
+                       });
+}
+
+// Reductions with the same loop patterns. The function takes the loop indices followed
+// by the thread-local value, e.g. function(k, j, i, lsum), and reducer is a Kokkos
+// reducer such as Kokkos::Sum<Real>(result) that holds the result once the call returns.
+// The team patterns reduce each team with the nested policy and join the team results,
+// so reducer must be constructible from a reference to its value_type.
+
+// 1D default reduction pattern
+template <typename Function, typename Reducer>
+inline void par_reduce(const std::string &name, DevSpace exec_space, const int &il,
+                       const int &iu, const Function &function, const Reducer &reducer) {
+  par_reduce(loop_pattern_mdrange_tag, name, exec_space, il, iu, function, reducer);
+}
+
+// 2D default reduction pattern
+template <typename Function, typename Reducer>
+inline void par_reduce(const std::string &name, DevSpace exec_space, const int &jl,
+                       const int &ju, const int &il, const int &iu,
+                       const Function &function, const Reducer &reducer) {
+  par_reduce(loop_pattern_mdrange_tag, name, exec_space, jl, ju, il, iu, function,
+             reducer);
+}
+
+// 3D default reduction pattern
+template <typename Function, typename Reducer>
+inline void par_reduce(const std::string &name, DevSpace exec_space, const int &kl,
+                       const int &ku, const int &jl, const int &ju, const int &il,
+                       const int &iu, const Function &function, const Reducer &reducer) {
+  par_reduce(DEFAULT_LOOP_PATTERN, name, exec_space, kl, ku, jl, ju, il, iu, function,
+             reducer);
+}
+
+// 4D default reduction pattern
+template <typename Function, typename Reducer>
+inline void par_reduce(const std::string &name, DevSpace exec_space, const int &nl,
+                       const int &nu, const int &kl, const int &ku, const int &jl,
+                       const int &ju, const int &il, const int &iu,
+                       const Function &function, const Reducer &reducer) {
+  par_reduce(DEFAULT_LOOP_PATTERN, name, exec_space, nl, nu, kl, ku, jl, ju, il, iu,
+             function, reducer);
+}
+
+// 5D default reduction pattern
+template <typename Function, typename Reducer>
+inline void par_reduce(const std::string &name, DevSpace exec_space, const int &bl,
+                       const int &bu, const int &nl, const int &nu, const int &kl,
+                       const int &ku, const int &jl, const int &ju, const int &il,
+                       const int &iu, const Function &function, const Reducer &reducer) {
+  par_reduce(DEFAULT_LOOP_PATTERN, name, exec_space, bl, bu, nl, nu, kl, ku, jl, ju, il,
+             iu, function, reducer);
+}
+
+// 1D reduction using MDRange loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  Kokkos::parallel_reduce(name, Kokkos::RangePolicy<>(exec_space, il, iu + 1), function,
+                          reducer);
+}
+
+// 2D reduction using MDRange loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
+                       const int &jl, const int &ju, const int &il, const int &iu,
+                       const Function &function, const Reducer &reducer) {
+  Kokkos::parallel_reduce(
+      name,
+      Kokkos::MDRangePolicy<Kokkos::Rank<2>>(exec_space, {jl, il}, {ju + 1, iu + 1}),
+      function, reducer);
+}
+
+// 3D reduction using Kokkos 1D Range
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternFlatRange, const std::string &name,
+                       DevSpace exec_space, const int &kl, const int &ku, const int &jl,
+                       const int &ju, const int &il, const int &iu,
+                       const Function &function, const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_reduce(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NkNjNi),
+      KOKKOS_LAMBDA(const int &idx, value_type &lred) {
+        int k = idx / NjNi;
+        int j = (idx - k * NjNi) / Ni;
+        int i = idx - k * NjNi - j * Ni;
+        k += kl;
+        j += jl;
+        i += il;
+        function(k, j, i, lred);
+      },
+      reducer);
+}
+
+// 3D reduction using MDRange loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
+                       const int &kl, const int &ku, const int &jl, const int &ju,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  Kokkos::parallel_reduce(name,
+                          Kokkos::MDRangePolicy<Kokkos::Rank<3>>(
+                              exec_space, {kl, jl, il}, {ku + 1, ju + 1, iu + 1}),
+                          function, reducer);
+}
+
+// 3D reduction using TeamPolicy with single inner TeamThreadRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTTR, const std::string &name, DevSpace exec_space,
+                       const int &kl, const int &ku, const int &jl, const int &ju,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NkNj, false),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        const int k = team_member.league_rank() / Nj + kl;
+        const int j = team_member.league_rank() % Nj + jl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, il, iu + 1),
+            [&](const int i, value_type &v) { function(k, j, i, v); }, Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 3D reduction using TeamPolicy with single inner ThreadVectorRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTVR, const std::string &name, DevSpace exec_space,
+                       const int &kl, const int &ku, const int &jl, const int &ju,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NkNj, true),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        const int k = team_member.league_rank() / Nj + kl;
+        const int j = team_member.league_rank() % Nj + jl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamVectorRange<>(team_member, il, iu + 1),
+            [&](const int i, value_type &v) { function(k, j, i, v); }, Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 3D reduction using TeamPolicy with nested TeamThreadRange and ThreadVectorRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTTRTVR, const std::string &name,
+                       DevSpace exec_space, const int &kl, const int &ku, const int &jl,
+                       const int &ju, const int &il, const int &iu,
+                       const Function &function, const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nk = ku - kl + 1;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, Nk, true),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        const int k = team_member.league_rank() + kl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, jl, ju + 1),
+            [&](const int j, value_type &tv) {
+              value_type vec_red;
+              Kokkos::parallel_reduce(
+                  Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+                  [&](const int i, value_type &v) { function(k, j, i, v); },
+                  Reducer(vec_red));
+              reducer.join(tv, vec_red);
+            },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 3D reduction using plain host loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternSimdFor, const std::string &name, DevSpace exec_space,
+                       const int &kl, const int &ku, const int &jl, const int &ju,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  ProfilingRegion region(name);
+  typename Reducer::value_type lred;
+  reducer.init(lred);
+  for (auto k = kl; k <= ku; k++)
+    for (auto j = jl; j <= ju; j++)
+      for (auto i = il; i <= iu; i++)
+        function(k, j, i, lred);
+  reducer.reference() = lred;
+}
+
+// 4D reduction using Kokkos 1D Range
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternFlatRange, const std::string &name,
+                       DevSpace exec_space, const int nl, const int nu, const int kl,
+                       const int ku, const int jl, const int ju, const int il,
+                       const int iu, const Function &function, const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NnNkNjNi = Nn * Nk * Nj * Ni;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_reduce(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NnNkNjNi),
+      KOKKOS_LAMBDA(const int &idx, value_type &lred) {
+        int n = idx / NkNjNi;
+        int k = (idx - n * NkNjNi) / NjNi;
+        int j = (idx - n * NkNjNi - k * NjNi) / Ni;
+        int i = idx - n * NkNjNi - k * NjNi - j * Ni;
+        n += nl;
+        k += kl;
+        j += jl;
+        i += il;
+        function(n, k, j, i, lred);
+      },
+      reducer);
+}
+
+// 4D reduction using MDRange loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
+                       const int nl, const int nu, const int kl, const int ku,
+                       const int jl, const int ju, const int il, const int iu,
+                       const Function &function, const Reducer &reducer) {
+  Kokkos::parallel_reduce(
+      name,
+      Kokkos::MDRangePolicy<Kokkos::Rank<4>>(exec_space, {nl, kl, jl, il},
+                                             {nu + 1, ku + 1, ju + 1, iu + 1}),
+      function, reducer);
+}
+
+// 4D reduction using TeamPolicy loop with inner TeamThreadRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTTR, const std::string &name, DevSpace exec_space,
+                       const int nl, const int nu, const int kl, const int ku,
+                       const int jl, const int ju, const int il, const int iu,
+                       const Function &function, const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * Nk * Nj;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NnNkNj, false),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        int n = team_member.league_rank() / NkNj;
+        int k = (team_member.league_rank() - n * NkNj) / Nj;
+        int j = team_member.league_rank() - n * NkNj - k * Nj + jl;
+        n += nl;
+        k += kl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, il, iu + 1),
+            [&](const int i, value_type &v) { function(n, k, j, i, v); },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 4D reduction using TeamPolicy loop with inner ThreadVectorRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTVR, const std::string &name, DevSpace exec_space,
+                       const int nl, const int nu, const int kl, const int ku,
+                       const int jl, const int ju, const int il, const int iu,
+                       const Function &function, const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * Nk * Nj;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NnNkNj, true),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        int n = team_member.league_rank() / NkNj;
+        int k = (team_member.league_rank() - n * NkNj) / Nj;
+        int j = team_member.league_rank() - n * NkNj - k * Nj + jl;
+        n += nl;
+        k += kl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+            [&](const int i, value_type &v) { function(n, k, j, i, v); },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 4D reduction using TeamPolicy with nested TeamThreadRange and ThreadVectorRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTTRTVR, const std::string &name,
+                       DevSpace exec_space, const int nl, const int nu, const int kl,
+                       const int ku, const int jl, const int ju, const int il,
+                       const int iu, const Function &function, const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int NnNk = Nn * Nk;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NnNk, true),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        int n = team_member.league_rank() / Nk + nl;
+        int k = team_member.league_rank() % Nk + kl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, jl, ju + 1),
+            [&](const int j, value_type &tv) {
+              value_type vec_red;
+              Kokkos::parallel_reduce(
+                  Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+                  [&](const int i, value_type &v) { function(n, k, j, i, v); },
+                  Reducer(vec_red));
+              reducer.join(tv, vec_red);
+            },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 4D reduction using plain host loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternSimdFor, const std::string &name, DevSpace exec_space,
+                       const int nl, const int nu, const int kl, const int ku,
+                       const int jl, const int ju, const int il, const int iu,
+                       const Function &function, const Reducer &reducer) {
+  ProfilingRegion region(name);
+  typename Reducer::value_type lred;
+  reducer.init(lred);
+  for (auto n = nl; n <= nu; n++)
+    for (auto k = kl; k <= ku; k++)
+      for (auto j = jl; j <= ju; j++)
+        for (auto i = il; i <= iu; i++)
+          function(n, k, j, i, lred);
+  reducer.reference() = lred;
+}
+
+// 5D reduction using Kokkos 1D Range
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternFlatRange, const std::string &name,
+                       DevSpace exec_space, const int bl, const int bu, const int nl,
+                       const int nu, const int kl, const int ku, const int jl,
+                       const int ju, const int il, const int iu, const Function &function,
+                       const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NbNnNkNjNi = Nb * Nn * Nk * Nj * Ni;
+  const int NnNkNjNi = Nn * Nk * Nj * Ni;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_reduce(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NbNnNkNjNi),
+      KOKKOS_LAMBDA(const int &idx, value_type &lred) {
+        int b = idx / NnNkNjNi;
+        int n = (idx - b * NnNkNjNi) / NkNjNi;
+        int k = (idx - b * NnNkNjNi - n * NkNjNi) / NjNi;
+        int j = (idx - b * NnNkNjNi - n * NkNjNi - k * NjNi) / Ni;
+        int i = idx - b * NnNkNjNi - n * NkNjNi - k * NjNi - j * Ni;
+        b += bl;
+        n += nl;
+        k += kl;
+        j += jl;
+        i += il;
+        function(b, n, k, j, i, lred);
+      },
+      reducer);
+}
+
+// 5D reduction using MDRange loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternMDRange, const std::string &name, DevSpace exec_space,
+                       const int bl, const int bu, const int nl, const int nu,
+                       const int kl, const int ku, const int jl, const int ju,
+                       const int il, const int iu, const Function &function,
+                       const Reducer &reducer) {
+  Kokkos::parallel_reduce(name,
+                          Kokkos::MDRangePolicy<Kokkos::Rank<5>>(
+                              exec_space, {bl, nl, kl, jl, il},
+                              {bu + 1, nu + 1, ku + 1, ju + 1, iu + 1}),
+                          function, reducer);
+}
+
+// 5D reduction using TeamPolicy loop with inner TeamThreadRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTTR, const std::string &name, DevSpace exec_space,
+                       const int bl, const int bu, const int nl, const int nu,
+                       const int kl, const int ku, const int jl, const int ju,
+                       const int il, const int iu, const Function &function,
+                       const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * Nk * Nj;
+  const int NbNnNkNj = Nb * Nn * Nk * Nj;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NbNnNkNj, false),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        int b = team_member.league_rank() / NnNkNj;
+        int n = (team_member.league_rank() - b * NnNkNj) / NkNj;
+        int k = (team_member.league_rank() - b * NnNkNj - n * NkNj) / Nj;
+        int j = team_member.league_rank() - b * NnNkNj - n * NkNj - k * Nj + jl;
+        b += bl;
+        n += nl;
+        k += kl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, il, iu + 1),
+            [&](const int i, value_type &v) { function(b, n, k, j, i, v); },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 5D reduction using TeamPolicy loop with inner ThreadVectorRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTVR, const std::string &name, DevSpace exec_space,
+                       const int bl, const int bu, const int nl, const int nu,
+                       const int kl, const int ku, const int jl, const int ju,
+                       const int il, const int iu, const Function &function,
+                       const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int NkNj = Nk * Nj;
+  const int NnNkNj = Nn * Nk * Nj;
+  const int NbNnNkNj = Nb * Nn * Nk * Nj;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NbNnNkNj, true),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        int b = team_member.league_rank() / NnNkNj;
+        int n = (team_member.league_rank() - b * NnNkNj) / NkNj;
+        int k = (team_member.league_rank() - b * NnNkNj - n * NkNj) / Nj;
+        int j = team_member.league_rank() - b * NnNkNj - n * NkNj - k * Nj + jl;
+        b += bl;
+        n += nl;
+        k += kl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+            [&](const int i, value_type &v) { function(b, n, k, j, i, v); },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 5D reduction using TeamPolicy with nested TeamThreadRange and ThreadVectorRange
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternTPTTRTVR, const std::string &name,
+                       DevSpace exec_space, const int bl, const int bu, const int nl,
+                       const int nu, const int kl, const int ku, const int jl,
+                       const int ju, const int il, const int iu, const Function &function,
+                       const Reducer &reducer) {
+  using value_type = typename Reducer::value_type;
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int NnNk = Nn * Nk;
+  const int NbNnNk = Nb * Nn * Nk;
+  Kokkos::parallel_reduce(
+      name, LoopTeamPolicy(exec_space, NbNnNk, true),
+      KOKKOS_LAMBDA(member_type team_member, value_type &lred) {
+        int b = team_member.league_rank() / NnNk;
+        int n = (team_member.league_rank() - b * NnNk) / Nk;
+        int k = team_member.league_rank() - b * NnNk - n * Nk + kl;
+        b += bl;
+        n += nl;
+        value_type team_red;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, jl, ju + 1),
+            [&](const int j, value_type &tv) {
+              value_type vec_red;
+              Kokkos::parallel_reduce(
+                  Kokkos::ThreadVectorRange<>(team_member, il, iu + 1),
+                  [&](const int i, value_type &v) { function(b, n, k, j, i, v); },
+                  Reducer(vec_red));
+              reducer.join(tv, vec_red);
+            },
+            Reducer(team_red));
+        Kokkos::single(Kokkos::PerTeam(team_member),
+                       [&]() { reducer.join(lred, team_red); });
+      },
+      reducer);
+}
+
+// 5D reduction using plain host loops
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternSimdFor, const std::string &name, DevSpace exec_space,
+                       const int bl, const int bu, const int nl, const int nu,
+                       const int kl, const int ku, const int jl, const int ju,
+                       const int il, const int iu, const Function &function,
+                       const Reducer &reducer) {
+  ProfilingRegion region(name);
+  typename Reducer::value_type lred;
+  reducer.init(lred);
+  for (auto b = bl; b <= bu; b++)
+    for (auto n = nl; n <= nu; n++)
+      for (auto k = kl; k <= ku; k++)
+        for (auto j = jl; j <= ju; j++)
+          for (auto i = il; i <= iu; i++)
+            function(b, n, k, j, i, lred);
+  reducer.reference() = lred;
+}
+
+// Loops and reductions whose pattern is chosen at runtime, per kernel name, by the
+// LoopPatternTuner. Each call dispatches to one of the patterns above, so all of them are
+// compiled for every kernel that uses the runtime pattern. Autotuning trials are fenced
+// and timed on the host.
+template <typename Launch>
+inline void LaunchWithTunedPattern(const std::string &name, DevSpace exec_space,
+                                   const Launch &launch) {
+  auto &tuner = LoopPatternTuner::Get();
+  bool timed;
+  const LoopPattern pattern = tuner.Choose(name, timed);
+  Kokkos::Timer timer;
+  if (timed) {
+    exec_space.fence();
+    timer.reset();
+  }
+  switch (pattern) {
+  case LoopPattern::mdrange:
+    launch(loop_pattern_mdrange_tag);
+    break;
+  case LoopPattern::tpttr:
+    launch(loop_pattern_tpttr_tag);
+    break;
+  case LoopPattern::tpttrtvr:
+    launch(loop_pattern_tpttrtvr_tag);
+    break;
+#ifndef PARTHENON_GPU_BACKEND
+  case LoopPattern::tptvr:
+    launch(loop_pattern_tptvr_tag);
+    break;
+  case LoopPattern::simdfor:
+    launch(loop_pattern_simdfor_tag);
+    break;
+#endif
+  default:
+    launch(loop_pattern_flatrange_tag);
+  }
+  if (timed) {
+    exec_space.fence();
+    tuner.Record(name, pattern, timer.seconds());
+  }
+}
+
+// 3D loop using the pattern chosen at runtime
+template <typename Function>
+inline void par_for(LoopPatternRuntime, const std::string &name, DevSpace exec_space,
+                    const int &kl, const int &ku, const int &jl, const int &ju,
+                    const int &il, const int &iu, const Function &function) {
+  LaunchWithTunedPattern(name, exec_space, [&](auto tag) {
+    par_for(tag, name, exec_space, kl, ku, jl, ju, il, iu, function);
+  });
+}
+
+// 4D loop using the pattern chosen at runtime
+template <typename Function>
+inline void par_for(LoopPatternRuntime, const std::string &name, DevSpace exec_space,
+                    const int &nl, const int &nu, const int &kl, const int &ku,
+                    const int &jl, const int &ju, const int &il, const int &iu,
+                    const Function &function) {
+  LaunchWithTunedPattern(name, exec_space, [&](auto tag) {
+    par_for(tag, name, exec_space, nl, nu, kl, ku, jl, ju, il, iu, function);
+  });
+}
+
+// 5D loop using the pattern chosen at runtime
+template <typename Function>
+inline void par_for(LoopPatternRuntime, const std::string &name, DevSpace exec_space,
+                    const int &bl, const int &bu, const int &nl, const int &nu,
+                    const int &kl, const int &ku, const int &jl, const int &ju,
+                    const int &il, const int &iu, const Function &function) {
+  LaunchWithTunedPattern(name, exec_space, [&](auto tag) {
+    par_for(tag, name, exec_space, bl, bu, nl, nu, kl, ku, jl, ju, il, iu, function);
+  });
+}
+
+// 3D reduction using the pattern chosen at runtime
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternRuntime, const std::string &name, DevSpace exec_space,
+                       const int &kl, const int &ku, const int &jl, const int &ju,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  LaunchWithTunedPattern(name, exec_space, [&](auto tag) {
+    par_reduce(tag, name, exec_space, kl, ku, jl, ju, il, iu, function, reducer);
+  });
+}
+
+// 4D reduction using the pattern chosen at runtime
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternRuntime, const std::string &name, DevSpace exec_space,
+                       const int &nl, const int &nu, const int &kl, const int &ku,
+                       const int &jl, const int &ju, const int &il, const int &iu,
+                       const Function &function, const Reducer &reducer) {
+  LaunchWithTunedPattern(name, exec_space, [&](auto tag) {
+    par_reduce(tag, name, exec_space, nl, nu, kl, ku, jl, ju, il, iu, function, reducer);
+  });
+}
+
+// 5D reduction using the pattern chosen at runtime
+template <typename Function, typename Reducer>
+inline void par_reduce(LoopPatternRuntime, const std::string &name, DevSpace exec_space,
+                       const int &bl, const int &bu, const int &nl, const int &nu,
+                       const int &kl, const int &ku, const int &jl, const int &ju,
+                       const int &il, const int &iu, const Function &function,
+                       const Reducer &reducer) {
+  LaunchWithTunedPattern(name, exec_space, [&](auto tag) {
+    par_reduce(tag, name, exec_space, bl, bu, nl, nu, kl, ku, jl, ju, il, iu, function,
+               reducer);
+  });
+}
+
+// Prefix scans over the cells in row-major order (the innermost index runs fastest). The
+// function takes the loop indices followed by the running value and whether this is the
+// final pass, function(k, j, i, partial, final), as in Kokkos::parallel_scan. The type T
+// of the running value has to be given explicitly, e.g. par_scan<int>(...). Scans are
+// always flattened onto a 1D range.
+
+// 1D scan
+template <typename T, typename Function>
+inline void par_scan(const std::string &name, DevSpace exec_space, const int &il,
+                     const int &iu, const Function &function) {
+  Kokkos::parallel_scan(
+      name, Kokkos::RangePolicy<>(exec_space, il, iu + 1),
+      KOKKOS_LAMBDA(const int &i, T &partial, const bool final) {
+        function(i, partial, final);
+      });
+}
+
+// 2D scan
+template <typename T, typename Function>
+inline void par_scan(const std::string &name, DevSpace exec_space, const int &jl,
+                     const int &ju, const int &il, const int &iu,
+                     const Function &function) {
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_scan(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NjNi),
+      KOKKOS_LAMBDA(const int &idx, T &partial, const bool final) {
+        const int j = idx / Ni;
+        const int i = idx - j * Ni;
+        function(j + jl, i + il, partial, final);
+      });
+}
+
+// 3D scan
+template <typename T, typename Function>
+inline void par_scan(const std::string &name, DevSpace exec_space, const int &kl,
+                     const int &ku, const int &jl, const int &ju, const int &il,
+                     const int &iu, const Function &function) {
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_scan(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NkNjNi),
+      KOKKOS_LAMBDA(const int &idx, T &partial, const bool final) {
+        const int k = idx / NjNi;
+        const int j = (idx - k * NjNi) / Ni;
+        const int i = idx - k * NjNi - j * Ni;
+        function(k + kl, j + jl, i + il, partial, final);
+      });
+}
+
+// 4D scan
+template <typename T, typename Function>
+inline void par_scan(const std::string &name, DevSpace exec_space, const int nl,
+                     const int nu, const int kl, const int ku, const int jl,
+                     const int ju, const int il, const int iu, const Function &function) {
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NnNkNjNi = Nn * Nk * Nj * Ni;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_scan(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NnNkNjNi),
+      KOKKOS_LAMBDA(const int &idx, T &partial, const bool final) {
+        const int n = idx / NkNjNi;
+        const int k = (idx - n * NkNjNi) / NjNi;
+        const int j = (idx - n * NkNjNi - k * NjNi) / Ni;
+        const int i = idx - n * NkNjNi - k * NjNi - j * Ni;
+        function(n + nl, k + kl, j + jl, i + il, partial, final);
+      });
+}
+
+// 5D scan
+template <typename T, typename Function>
+inline void par_scan(const std::string &name, DevSpace exec_space, const int bl,
+                     const int bu, const int nl, const int nu, const int kl,
+                     const int ku, const int jl, const int ju, const int il,
+                     const int iu, const Function &function) {
+  const int Nb = bu - bl + 1;
+  const int Nn = nu - nl + 1;
+  const int Nk = ku - kl + 1;
+  const int Nj = ju - jl + 1;
+  const int Ni = iu - il + 1;
+  const int NbNnNkNjNi = Nb * Nn * Nk * Nj * Ni;
+  const int NnNkNjNi = Nn * Nk * Nj * Ni;
+  const int NkNjNi = Nk * Nj * Ni;
+  const int NjNi = Nj * Ni;
+  Kokkos::parallel_scan(
+      name, Kokkos::RangePolicy<>(exec_space, 0, NbNnNkNjNi),
+      KOKKOS_LAMBDA(const int &idx, T &partial, const bool final) {
+        const int b = idx / NnNkNjNi;
+        const int n = (idx - b * NnNkNjNi) / NkNjNi;
+        const int k = (idx - b * NnNkNjNi - n * NkNjNi) / NjNi;
+        const int j = (idx - b * NnNkNjNi - n * NkNjNi - k * NjNi) / Ni;
+        const int i = idx - b * NnNkNjNi - n * NkNjNi - k * NjNi - j * Ni;
+        function(b + bl, n + nl, k + kl, j + jl, i + il, partial, final);
+      });
 }
 
 // reused from kokoks/core/perf_test/PerfTest_ExecSpacePartitioning.cpp
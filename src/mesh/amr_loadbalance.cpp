@@ -21,29 +21,108 @@
 #include <cstdint>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "parthenon_mpi.hpp"
 
 #include "athena.hpp"
 #include "bvals/boundary_conditions.hpp"
+#include "bvals/bvals_interfaces.hpp"
+#include "bvals/bvals_swarm.hpp"
 #include "globals.hpp"
 #include "interface/update.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/mesh_refinement.hpp"
 #include "mesh/meshblock_tree.hpp"
 #include "parthenon_arrays.hpp"
 #include "utils/buffer_utils.hpp"
+#include "utils/profiling.hpp"
 
 namespace parthenon {
 
+namespace {
+
+// a derefinement flag as exchanged by Mesh::UpdateMeshBlockTree(): either the parent of
+// a group of flagged siblings that one rank has merged by itself (merged = 1), or a
+// flagged block whose siblings are possibly on another rank (merged = 0)
+struct DerefinementItem {
+  LogicalLocation loc;
+  int merged;
+};
+
+bool IsFirstSibling(const LogicalLocation &loc) {
+  return (loc.lx1 & 1LL) == 0LL && (loc.lx2 & 1LL) == 0LL && (loc.lx3 & 1LL) == 0LL;
+}
+
+bool AreSiblings(const LogicalLocation &a, const LogicalLocation &b) {
+  return (a.lx1 >> 1) == (b.lx1 >> 1) && (a.lx2 >> 1) == (b.lx2 >> 1) &&
+         (a.lx3 >> 1) == (b.lx3 >> 1) && a.level == b.level;
+}
+
+LogicalLocation ParentOf(const LogicalLocation &loc) {
+  LogicalLocation parent;
+  parent.lx1 = loc.lx1 >> 1;
+  parent.lx2 = loc.lx2 >> 1;
+  parent.lx3 = loc.lx3 >> 1;
+  parent.level = loc.level - 1;
+  return parent;
+}
+
+// the table entry of components 0..nu of var over the index range, stored in buf from
+// element p on; advances p past it. The order of the elements is that of
+// BufferUtility::PackData().
+BndInfo BufferEntry(const ParArrayND<Real> &var, const BufArray1D<Real> &buf,
+                    const int nu, const int si, const int ei, const int sj, const int ej,
+                    const int sk, const int ek, int &p) {
+  BndInfo b;
+  b.si = si, b.ei = ei, b.sj = sj, b.ej = ej, b.sk = sk, b.ek = ek;
+  b.nl = 0, b.nu = nu;
+  const int size = (nu + 1) * (ek + 1 - sk) * (ej + 1 - sj) * (ei + 1 - si);
+  b.buf = Kokkos::subview(buf, std::make_pair(p, p + size));
+  b.var = var.Get<4>();
+  p += size;
+  return b;
+}
+
+// restriction or prolongation of all components of a (fine, coarse) pair over the
+// coarse index range
+RefinementRegion
+RefinementEntry(const std::tuple<ParArrayND<Real>, ParArrayND<Real>> &cc_pair,
+                const int si, const int ei, const int sj, const int ej, const int sk,
+                const int ek) {
+  RefinementRegion r;
+  r.si = si, r.ei = ei, r.sj = sj, r.ej = ej, r.sk = sk, r.ek = ek;
+  r.nl = 0, r.nu = std::get<0>(cc_pair).GetDim(4) - 1;
+  r.fine = std::get<0>(cc_pair).Get<4>();
+  r.coarse = std::get<1>(cc_pair).Get<4>();
+  return r;
+}
+
+// packs (pack = true) or unpacks the first n entries of the table with one kernel
+template <bool pack>
+void PackUnpackAMRBuffers(const std::string &name, DevSpace exec_space,
+                          const BufferCache_t &cache,
+                          const BufferCache_t::HostMirror &cache_h, const int n) {
+  if (n == 0) return;
+  Kokkos::deep_copy(exec_space, cache, cache_h);
+  PackUnpackBuffers<pack>(name, exec_space, cache, n);
+}
+
+} // namespace
+
 //----------------------------------------------------------------------------------------
 // \!fn void Mesh::LoadBalancingAndAdaptiveMeshRefinement(ParameterInput *pin)
 // \brief Main function for adaptive mesh refinement
 
 void Mesh::LoadBalancingAndAdaptiveMeshRefinement(ParameterInput *pin) {
+  ProfilingRegion region("Mesh::LoadBalancingAndAdaptiveMeshRefinement");
   int nnew = 0, ndel = 0;
 
-  if (adaptive) {
+  if (adaptive && ncycle % refine_interval_ == 0) {
     UpdateMeshBlockTree(nnew, ndel);
     nbnew += nnew;
     nbdel += ndel;
@@ -64,14 +143,174 @@ void Mesh::LoadBalancingAndAdaptiveMeshRefinement(ParameterInput *pin) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::ReadPartitioningOptions(ParameterInput *pin)
+// \brief <loadbalancing>/ordering selects the curve along which the MeshBlocks are
+// numbered (morton or hilbert), <loadbalancing>/partition how that list is cut into one
+// contiguous segment per rank (greedy or prefix_sum). Both have to be known before the
+// first MeshBlockTree::GetMeshBlockList() call.
+
+void Mesh::ReadPartitioningOptions(ParameterInput *pin) {
+  std::stringstream msg;
+  const std::string ordering = pin->GetOrAddString("loadbalancing", "ordering", "morton");
+  if (ordering != "morton" && ordering != "hilbert") {
+    msg << "### FATAL ERROR in Mesh constructor" << std::endl
+        << "Unknown <loadbalancing>/ordering = " << ordering
+        << ", use morton or hilbert" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  const std::string partition =
+      pin->GetOrAddString("loadbalancing", "partition", "greedy");
+  if (partition == "greedy") {
+    partition_ = Partitioner::greedy;
+  } else if (partition == "prefix_sum") {
+    partition_ = Partitioner::prefix_sum;
+  } else if (partition == "diffusion") {
+    partition_ = Partitioner::diffusion;
+  } else {
+    msg << "### FATAL ERROR in Mesh constructor" << std::endl
+        << "Unknown <loadbalancing>/partition = " << partition
+        << ", use greedy, prefix_sum or diffusion" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  diffusion_tolerance_ = pin->GetOrAddReal("loadbalancing", "diffusion_tolerance", 0.05);
+  hilbert_ordering_ = (ordering == "hilbert");
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::ReadRefinementOptions(ParameterInput *pin)
+// \brief <mesh>/refine_interval is the number of cycles between updates of the
+// MeshBlockTree, <mesh>/refine_buffer the number of blocks around a block tagged for
+// refinement that are refined with it and kept from derefining (0 turns it off).
+// Together with <mesh>/derefine_count they keep blocks from flipping between levels.
+
+void Mesh::ReadRefinementOptions(ParameterInput *pin) {
+  std::stringstream msg;
+  refine_interval_ = pin->GetOrAddInteger("mesh", "refine_interval", 1);
+  refine_buffer_ = pin->GetOrAddInteger("mesh", "refine_buffer", 0);
+  coarse_on_demand_ =
+      multilevel && pin->GetOrAddBoolean("mesh", "coarse_buffers_on_demand", false);
+  if (refine_interval_ < 1 || refine_buffer_ < 0) {
+    msg << "### FATAL ERROR in Mesh constructor" << std::endl
+        << "<mesh>/refine_interval = " << refine_interval_
+        << " must be positive and <mesh>/refine_buffer = " << refine_buffer_
+        << " non-negative" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::UpdateCoarseArrays()
+// \brief With <mesh>/coarse_buffers_on_demand the coarse arrays of the variables, which
+// are only used at refinement boundaries and when blocks change level, are kept only on
+// the blocks with a neighbor on another level. Called whenever the neighbors are set.
+
+void Mesh::UpdateCoarseArrays() {
+  if (!coarse_on_demand_) return;
+  for (MeshBlock *pmb : block_list) {
+    pmb->pmr->SetCoarseArrays(pmb->pmr->NeedsCoarseArrays());
+  }
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn bool Mesh::WithinRefineBuffer(const LogicalLocation &a, const LogicalLocation &b,
+//                                   const int level) const
+// \brief true if the blocks a and b are less than refine_buffer_ blocks of the given
+// level (at least the level of both) apart in every direction; adjacent blocks are 0
+// blocks apart. The distance wraps around periodic boundaries.
+
+bool Mesh::WithinRefineBuffer(const LogicalLocation &a, const LogicalLocation &b,
+                              const int level) const {
+  const std::int64_t la[3] = {a.lx1, a.lx2, a.lx3}, lb[3] = {b.lx1, b.lx2, b.lx3};
+  const std::int64_t nrb[3] = {nrbx1, nrbx2, nrbx3};
+  const int sa = level - a.level, sb = level - b.level;
+  for (int d = 0; d < ndim; d++) {
+    const std::int64_t a0 = la[d] << sa, a1 = (la[d] + 1) << sa;
+    const std::int64_t b0 = lb[d] << sb, b1 = (lb[d] + 1) << sb;
+    std::int64_t gap = std::max(b0 - a1, a0 - b1);
+    if (mesh_bcs[2 * d] == BoundaryFlag::periodic) {
+      const std::int64_t n = nrb[d] << (level - root_level);
+      gap = std::min(gap, std::max(b0 + n - a1, a0 - b1 - n));
+      gap = std::min(gap, std::max(b0 - n - a1, a0 - b1 + n));
+    }
+    if (gap >= refine_buffer_) return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::DiffuseLoadBalance(const double *clist, int *rlist, int nb)
+// \brief Incrementally improve the partition rlist, which must assign nondecreasing
+// ranks, by handing the blocks at the ends of the segments to the neighboring ranks.
+// Blocks move one at a time between the two ranks of a segment boundary, and only if
+// that reduces their difference in cost, until the most loaded rank is within
+// <loadbalancing>/diffusion_tolerance of the average. All other blocks stay put.
+
+void Mesh::DiffuseLoadBalance(const double *clist, int *rlist, int nb) {
+  const int nranks = Globals::nranks;
+  // segment r is [start[r], start[r + 1]); segments may start out empty
+  std::vector<int> start(nranks + 1, nb);
+  std::vector<double> load(nranks, 0.0);
+  double totalcost = 0.0;
+  for (int i = nb - 1; i >= 0; i--) {
+    start[rlist[i]] = i;
+    load[rlist[i]] += clist[i];
+    totalcost += clist[i];
+  }
+  for (int r = nranks - 1; r >= 0; r--)
+    start[r] = std::min(start[r], start[r + 1]);
+  start[0] = 0;
+
+  const double maxload = (1.0 + diffusion_tolerance_) * totalcost / nranks;
+  bool moved = true;
+  while (moved) {
+    bool balanced = true;
+    for (int r = 0; r < nranks; r++)
+      balanced = balanced && load[r] <= maxload && start[r + 1] > start[r];
+    if (balanced) break;
+    moved = false;
+    for (int r = 0; r < nranks - 1; r++) {
+      const double diff = load[r] - load[r + 1];
+      if (diff > 0.0 && start[r + 1] - start[r] > 1) {
+        const double c = clist[start[r + 1] - 1];
+        if (c < diff || start[r + 2] == start[r + 1]) {
+          start[r + 1]--;
+          load[r] -= c, load[r + 1] += c;
+          moved = true;
+        }
+      } else if (diff < 0.0 && start[r + 2] - start[r + 1] > 1) {
+        const double c = clist[start[r + 1]];
+        if (c < -diff || start[r + 1] == start[r]) {
+          start[r + 1]++;
+          load[r] += c, load[r + 1] -= c;
+          moved = true;
+        }
+      }
+    }
+  }
+  for (int r = 0; r < nranks; r++) {
+    for (int i = start[r]; i < start[r + 1]; i++)
+      rlist[i] = r;
+  }
+}
+
 //----------------------------------------------------------------------------------------
 // \!fn void Mesh::CalculateLoadBalance(double *clist, int *rlist, int *slist,
-//                                      int *nlist, int nb)
-// \brief Calculate distribution of MeshBlocks based on the cost list
+//                                      int *nlist, int nb, const int *rprev)
+// \brief Calculate distribution of MeshBlocks based on the cost list. rprev, if given,
+// is the rank each block is on now; the diffusion partitioner starts from it and
+// otherwise from the prefix_sum partition.
 
 void Mesh::CalculateLoadBalance(double *clist, int *rlist, int *slist, int *nlist,
-                                int nb) {
+                                int nb, const int *rprev) {
   std::stringstream msg;
+  if (nb < Globals::nranks) {
+    msg << "### FATAL ERROR in CalculateLoadBalance" << std::endl
+        << "There are fewer MeshBlocks (" << nb << ") than MPI ranks ("
+        << Globals::nranks << ")" << std::endl
+        << "Decrease the number of processes or use smaller MeshBlocks." << std::endl;
+    ATHENA_ERROR(msg);
+  }
   double real_max = std::numeric_limits<double>::max();
   double totalcost = 0, maxcost = 0.0, mincost = (real_max);
 
@@ -83,22 +322,46 @@ void Mesh::CalculateLoadBalance(double *clist, int *rlist, int *slist, int *nlis
 
   int j = (Globals::nranks)-1;
   double targetcost = totalcost / Globals::nranks;
-  double mycost = 0.0;
-  // create rank list from the end: the master MPI rank should have less load
-  for (int i = nb - 1; i >= 0; i--) {
+  if (partition_ == Partitioner::diffusion && rprev != nullptr) {
+    for (int i = 0; i < nb; i++)
+      rlist[i] = rprev[i];
+    DiffuseLoadBalance(clist, rlist, nb);
+  } else if (partition_ != Partitioner::greedy) {
     if (targetcost == 0.0) {
       msg << "### FATAL ERROR in CalculateLoadBalance" << std::endl
           << "There is at least one process which has no MeshBlock" << std::endl
           << "Decrease the number of processes or use smaller MeshBlocks." << std::endl;
       ATHENA_ERROR(msg);
     }
-    mycost += clist[i];
-    rlist[i] = j;
-    if (mycost >= targetcost && j > 0) {
-      j--;
-      totalcost -= mycost;
-      mycost = 0.0;
-      targetcost = totalcost / (j + 1);
+    // each block goes to the rank whose share [r, r+1)*targetcost of the cost prefix sum
+    // contains the middle of the block, as long as every rank keeps at least one block
+    double prefix = 0.0;
+    for (int i = 0; i < nb; i++) {
+      int r = static_cast<int>((prefix + 0.5 * clist[i]) / targetcost);
+      prefix += clist[i];
+      const int hi = (i == 0) ? 0 : std::min(rlist[i - 1] + 1, Globals::nranks - 1);
+      const int lo = std::min(hi, std::max((i == 0) ? 0 : rlist[i - 1],
+                                           Globals::nranks - (nb - i)));
+      rlist[i] = std::max(lo, std::min(hi, r));
+    }
+  } else {
+    double mycost = 0.0;
+    // create rank list from the end: the master MPI rank should have less load
+    for (int i = nb - 1; i >= 0; i--) {
+      if (targetcost == 0.0) {
+        msg << "### FATAL ERROR in CalculateLoadBalance" << std::endl
+            << "There is at least one process which has no MeshBlock" << std::endl
+            << "Decrease the number of processes or use smaller MeshBlocks." << std::endl;
+        ATHENA_ERROR(msg);
+      }
+      mycost += clist[i];
+      rlist[i] = j;
+      if (mycost >= targetcost && j > 0) {
+        j--;
+        totalcost -= mycost;
+        mycost = 0.0;
+        targetcost = totalcost / (j + 1);
+      }
     }
   }
   slist[0] = 0;
@@ -157,11 +420,9 @@ void Mesh::CalculateLoadBalance(double *clist, int *rlist, int *slist, int *nlis
 
 void Mesh::ResetLoadBalanceVariables() {
   if (lb_automatic_) {
-    MeshBlock *pmb = pblock;
-    while (pmb != nullptr) {
+    for (MeshBlock *pmb : block_list) {
       costlist[pmb->gid] = TINY_NUMBER;
       pmb->ResetTimeMeasurement();
-      pmb = pmb->next;
     }
   }
   lb_flag_ = false;
@@ -173,17 +434,16 @@ void Mesh::ResetLoadBalanceVariables() {
 // \brief update the cost list
 
 void Mesh::UpdateCostList() {
-  MeshBlock *pmb = pblock;
   if (lb_automatic_) {
     double w = static_cast<double>(lb_interval_ - 1) / static_cast<double>(lb_interval_);
-    while (pmb != nullptr) {
+    for (MeshBlock *pmb : block_list) {
       costlist[pmb->gid] = costlist[pmb->gid] * w + pmb->cost_;
-      pmb = pmb->next;
+      // cost_ holds the time measured since the last update
+      pmb->ResetTimeMeasurement();
     }
   } else if (lb_flag_) {
-    while (pmb != nullptr) {
+    for (MeshBlock *pmb : block_list) {
       costlist[pmb->gid] = pmb->cost_;
-      pmb = pmb->next;
     }
   }
 }
@@ -193,6 +453,7 @@ void Mesh::UpdateCostList() {
 // \brief collect refinement flags and manipulate the MeshBlockTree
 
 void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
+  ProfilingRegion region("Mesh::UpdateMeshBlockTree");
   // compute nleaf= number of leaf MeshBlocks per refined block
   MeshBlock *pmb;
   int nleaf = 2, dim = 1;
@@ -200,15 +461,71 @@ void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
   if (mesh_size.nx3 > 1) nleaf = 8, dim = 3;
 
   // collect refinement flags from all the meshblocks
-  // count the number of the blocks to be (de)refined
+  // count the number of the blocks to be refined
   nref[Globals::my_rank] = 0;
-  nderef[Globals::my_rank] = 0;
+  std::vector<LogicalLocation> lflag; // this rank's derefinement flags, in gid order
+  std::vector<int> gflag;
+  std::vector<LogicalLocation> ltag; // the centers of the refinement buffer
   pmb = pblock;
   while (pmb != nullptr) {
     if (pmb->pmr->refine_flag_ == 1) nref[Globals::my_rank]++;
-    if (pmb->pmr->refine_flag_ == -1) nderef[Globals::my_rank]++;
+    if (pmb->pmr->refine_flag_ == -1) {
+      lflag.push_back(pmb->loc);
+      gflag.push_back(pmb->gid);
+    }
+    if (refine_buffer_ > 0 && pmb->pmr->refine_tagged_) ltag.push_back(pmb->loc);
+    pmb->pmr->refine_tagged_ = false;
     pmb = pmb->next;
   }
+  // every rank needs all tagged blocks to extend the refinement around them
+  std::vector<LogicalLocation> tagged = ltag;
+#ifdef MPI_PARALLEL
+  if (refine_buffer_ > 0) {
+    std::vector<int> ntag(Globals::nranks), btag(Globals::nranks);
+    std::vector<int> btdisp(Globals::nranks);
+    ntag[Globals::my_rank] = ltag.size();
+    MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, ntag.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    int td = 0;
+    for (int n = 0; n < Globals::nranks; n++) {
+      btag[n] = static_cast<int>(ntag[n] * sizeof(LogicalLocation));
+      btdisp[n] = static_cast<int>(td * sizeof(LogicalLocation));
+      td += ntag[n];
+    }
+    tagged.resize(td);
+    if (td > 0) {
+      MPI_Allgatherv(ltag.data(), btag[Globals::my_rank], MPI_BYTE, tagged.data(),
+                     btag.data(), btdisp.data(), MPI_BYTE, MPI_COMM_WORLD);
+    }
+  }
+#endif
+
+  // Siblings are consecutive in gid order, so all but the groups cut by the ends of the
+  // segment of this rank can be merged here. Only their parents, and the flags of the
+  // blocks near the ends of the segment, are exchanged.
+  const int nflag = lflag.size();
+  std::vector<int> merged(nflag, 0);
+  for (int n = 0; n < nflag; n++) {
+    if (!IsFirstSibling(lflag[n])) continue;
+    int rr = 0;
+    for (int r = std::max(0, n - nleaf + 1); r < std::min(nflag, n + nleaf); r++) {
+      if (AreSiblings(lflag[r], lflag[n])) rr++;
+    }
+    if (rr < nleaf) continue;
+    for (int r = std::max(0, n - nleaf + 1); r < std::min(nflag, n + nleaf); r++) {
+      if (AreSiblings(lflag[r], lflag[n])) merged[r] = 1;
+    }
+  }
+  const int nbs = nslist[Globals::my_rank];
+  const int nbe = nbs + nblist[Globals::my_rank] - 1;
+  std::vector<DerefinementItem> litem;
+  for (int n = 0; n < nflag; n++) {
+    if (merged[n]) {
+      if (IsFirstSibling(lflag[n])) litem.push_back({ParentOf(lflag[n]), 1});
+    } else if (gflag[n] < nbs + nleaf - 1 || gflag[n] > nbe - nleaf + 1) {
+      litem.push_back({lflag[n], 0});
+    }
+  }
+  nderef[Globals::my_rank] = litem.size();
 #ifdef MPI_PARALLEL
   MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, nref, 1, MPI_INT, MPI_COMM_WORLD);
   MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, nderef, 1, MPI_INT, MPI_COMM_WORLD);
@@ -220,7 +537,7 @@ void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
     tnref += nref[n];
     tnderef += nderef[n];
   }
-  if (tnref == 0 && tnderef < nleaf) // nothing to do
+  if (tnref == 0 && tnderef == 0 && tagged.empty()) // nothing to do
     return;
 
   int rd = 0, dd = 0;
@@ -232,78 +549,90 @@ void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
     // on many platforms (LP64). However, these are used below in MPI calls for
     // integer arguments (recvcounts, displs). MPI does not support > 64-bit count ranges
     bnref[n] = static_cast<int>(nref[n] * sizeof(LogicalLocation));
-    bnderef[n] = static_cast<int>(nderef[n] * sizeof(LogicalLocation));
+    bnderef[n] = static_cast<int>(nderef[n] * sizeof(DerefinementItem));
     brdisp[n] = static_cast<int>(rd * sizeof(LogicalLocation));
-    bddisp[n] = static_cast<int>(dd * sizeof(LogicalLocation));
+    bddisp[n] = static_cast<int>(dd * sizeof(DerefinementItem));
     rd += nref[n];
     dd += nderef[n];
   }
 
   // allocate memory for the location arrays
-  LogicalLocation *lref{}, *lderef{}, *clderef{};
+  LogicalLocation *lref{}, *clderef{};
+  DerefinementItem *lderef{};
   if (tnref > 0) lref = new LogicalLocation[tnref];
-  if (tnderef >= nleaf) {
-    lderef = new LogicalLocation[tnderef];
-    clderef = new LogicalLocation[tnderef / nleaf];
+  if (tnderef > 0) {
+    lderef = new DerefinementItem[tnderef];
+    clderef = new LogicalLocation[tnderef];
   }
 
   // collect the locations and costs
-  int iref = rdisp[Globals::my_rank], ideref = ddisp[Globals::my_rank];
+  int iref = rdisp[Globals::my_rank];
   pmb = pblock;
   while (pmb != nullptr) {
     if (pmb->pmr->refine_flag_ == 1) lref[iref++] = pmb->loc;
-    if (pmb->pmr->refine_flag_ == -1 && tnderef >= nleaf) lderef[ideref++] = pmb->loc;
     pmb = pmb->next;
   }
+  std::copy(litem.begin(), litem.end(), lderef + ddisp[Globals::my_rank]);
 #ifdef MPI_PARALLEL
   if (tnref > 0) {
     MPI_Allgatherv(MPI_IN_PLACE, bnref[Globals::my_rank], MPI_BYTE, lref, bnref, brdisp,
                    MPI_BYTE, MPI_COMM_WORLD);
   }
-  if (tnderef >= nleaf) {
+  if (tnderef > 0) {
     MPI_Allgatherv(MPI_IN_PLACE, bnderef[Globals::my_rank], MPI_BYTE, lderef, bnderef,
                    bddisp, MPI_BYTE, MPI_COMM_WORLD);
   }
 #endif
 
-  // calculate the list of the newly derefined blocks
+  // calculate the list of the newly derefined blocks, in the gid order of their first
+  // leaf; the groups cut by rank boundaries are consecutive in the exchanged list
   int ctnd = 0;
-  if (tnderef >= nleaf) {
-    int lk = 0, lj = 0;
-    if (mesh_size.nx2 > 1) lj = 1;
-    if (mesh_size.nx3 > 1) lk = 1;
-    for (int n = 0; n < tnderef; n++) {
-      if ((lderef[n].lx1 & 1LL) == 0LL && (lderef[n].lx2 & 1LL) == 0LL &&
-          (lderef[n].lx3 & 1LL) == 0LL) {
-        int r = n, rr = 0;
-        for (std::int64_t k = 0; k <= lk; k++) {
-          for (std::int64_t j = 0; j <= lj; j++) {
-            for (std::int64_t i = 0; i <= 1; i++) {
-              if (r < tnderef) {
-                if ((lderef[n].lx1 + i) == lderef[r].lx1 &&
-                    (lderef[n].lx2 + j) == lderef[r].lx2 &&
-                    (lderef[n].lx3 + k) == lderef[r].lx3 &&
-                    lderef[n].level == lderef[r].level)
-                  rr++;
-                r++;
-              }
-            }
-          }
-        }
-        if (rr == nleaf) {
-          clderef[ctnd].lx1 = lderef[n].lx1 >> 1;
-          clderef[ctnd].lx2 = lderef[n].lx2 >> 1;
-          clderef[ctnd].lx3 = lderef[n].lx3 >> 1;
-          clderef[ctnd].level = lderef[n].level - 1;
-          ctnd++;
-        }
+  for (int n = 0; n < tnderef; n++) {
+    if (lderef[n].merged) {
+      clderef[ctnd++] = lderef[n].loc;
+    } else if (IsFirstSibling(lderef[n].loc)) {
+      // the siblings are consecutive in the list, which is in gid order, but with the
+      // Hilbert ordering the first of them is not necessarily this one
+      int rr = 0;
+      for (int r = std::max(0, n - nleaf + 1); r < std::min(tnderef, n + nleaf); r++) {
+        if (!lderef[r].merged && AreSiblings(lderef[r].loc, lderef[n].loc)) rr++;
       }
+      if (rr == nleaf) clderef[ctnd++] = ParentOf(lderef[n].loc);
     }
   }
   // sort the lists by level
   if (ctnd > 1) std::sort(clderef, &(clderef[ctnd - 1]), LogicalLocation::Greater);
 
-  if (tnderef >= nleaf) delete[] lderef;
+  if (tnderef > 0) delete[] lderef;
+
+  // the refinement buffer: refine the blocks near a tagged one that are not finer than
+  // it, and keep the blocks near one from derefining, with the distance counted in
+  // blocks of the finer level
+  std::vector<LogicalLocation> lbuf;
+  if (!tagged.empty()) {
+    for (int n = 0; n < nbtotal; n++) {
+      const LogicalLocation &loc = loclist[n];
+      if (loc.level >= max_level) continue;
+      for (const LogicalLocation &t : tagged) {
+        if (loc.level <= t.level && WithinRefineBuffer(loc, t, t.level)) {
+          lbuf.push_back(loc);
+          break;
+        }
+      }
+    }
+    int nkeep = 0;
+    for (int n = 0; n < ctnd; n++) {
+      bool keep = true;
+      for (const LogicalLocation &t : tagged) {
+        if (WithinRefineBuffer(clderef[n], t, std::max(clderef[n].level + 1, t.level))) {
+          keep = false;
+          break;
+        }
+      }
+      if (keep) clderef[nkeep++] = clderef[n];
+    }
+    ctnd = nkeep;
+  }
 
   // Now the lists of the blocks to be refined and derefined are completed
   // Start tree manipulation
@@ -313,13 +642,18 @@ void Mesh::UpdateMeshBlockTree(int &nnew, int &ndel) {
     bt->Refine(nnew);
   }
   if (tnref != 0) delete[] lref;
+  // the blocks of the buffer, some of which may have been refined already
+  for (const LogicalLocation &loc : lbuf) {
+    MeshBlockTree *bt = tree.FindMeshBlock(loc);
+    bt->Refine(nnew);
+  }
 
   // Step 2. perform derefinement
   for (int n = 0; n < ctnd; n++) {
     MeshBlockTree *bt = tree.FindMeshBlock(clderef[n]);
     bt->Derefine(ndel);
   }
-  if (tnderef >= nleaf) delete[] clderef;
+  if (tnderef > 0) delete[] clderef;
 
   return;
 }
@@ -360,6 +694,7 @@ bool Mesh::GatherCostListAndCheckBalance() {
 // \brief redistribute MeshBlocks according to the new load balance
 
 void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
+  ProfilingRegion region("Mesh::RedistributeAndRefineMeshBlocks");
   // compute nleaf= number of leaf MeshBlocks per refined block
   int nleaf = 2;
   if (mesh_size.nx2 > 1) nleaf = 4;
@@ -389,6 +724,24 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
   // fill the last block
   for (; mb_idx < nbtold; mb_idx++)
     oldtonew[mb_idx] = ntot - 1;
+  // the blocks of this rank that change level restrict or prolongate their data
+  // through the coarse arrays
+  if (coarse_on_demand_) {
+    for (int n = 0; n < ntot; n++) {
+      const int on = newtoold[n];
+      if (newloc[n].level == loclist[on].level) continue;
+      const int nold = (newloc[n].level < loclist[on].level) ? nleaf : 1;
+      for (int l = 0; l < nold; l++) {
+        if (ranklist[on + l] == Globals::my_rank)
+          FindMeshBlock(on + l)->pmr->SetCoarseArrays(true);
+      }
+    }
+  }
+  // the new gid of each block that is neither refined nor derefined, otherwise -1
+  std::vector<int> samegid(nbtold, -1);
+  for (int n = 0; n < ntot; n++) {
+    if (newloc[n].level == loclist[newtoold[n]].level) samegid[newtoold[n]] = n;
+  }
 
   current_level = 0;
   for (int n = 0; n < ntot; n++) {
@@ -410,41 +763,24 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
   int onbs = nslist[Globals::my_rank];
   int onbe = onbs + nblist[Globals::my_rank] - 1;
 #endif
-  // Step 2. Calculate new load balance
-  CalculateLoadBalance(newcost, newrank, nslist, nblist, ntot);
+  // Step 2. Calculate new load balance; every new block starts out on the rank of the
+  // (first) old block it derives from
+  std::vector<int> prevrank(ntot);
+  for (int n = 0; n < ntot; n++)
+    prevrank[n] = ranklist[newtoold[n]];
+  CalculateLoadBalance(newcost, newrank, nslist, nblist, ntot, prevrank.data());
+  CheckMPITagRange(nblist);
 
   int nbs = nslist[Globals::my_rank];
   int nbe = nbs + nblist[Globals::my_rank] - 1;
+  // the new MeshBlocks of this rank by local id, set as they are constructed in step 7
+  std::vector<MeshBlock *> newblocks(nbe - nbs + 1, nullptr);
 
 #ifdef MPI_PARALLEL
   int bnx1 = pblock->block_size.nx1;
   int bnx2 = pblock->block_size.nx2;
   int bnx3 = pblock->block_size.nx3;
-  // Step 3. count the number of the blocks to be sent / received
-  int nsend = 0, nrecv = 0;
-  for (int n = nbs; n <= nbe; n++) {
-    int on = newtoold[n];
-    if (loclist[on].level > newloc[n].level) { // f2c
-      for (int k = 0; k < nleaf; k++) {
-        if (ranklist[on + k] != Globals::my_rank) nrecv++;
-      }
-    } else {
-      if (ranklist[on] != Globals::my_rank) nrecv++;
-    }
-  }
-  for (int n = onbs; n <= onbe; n++) {
-    int nn = oldtonew[n];
-    if (loclist[n].level < newloc[nn].level) { // c2f
-      for (int k = 0; k < nleaf; k++) {
-        if (newrank[nn + k] != Globals::my_rank) nsend++;
-      }
-    } else {
-      if (newrank[nn] != Globals::my_rank) nsend++;
-    }
-  }
-
-  // Step 4. calculate buffer sizes
-  Real **sendbuf, **recvbuf;
+  // Step 3. calculate buffer sizes
   // use the first MeshBlock in the linked list of blocks belonging to this MPI rank as a
   // representative of all MeshBlocks for counting the "load-balancing registered" and
   // "SMR/AMR-enrolled" quantities (loop over MeshBlock::vars_cc_, not MeshRefinement)
@@ -481,48 +817,70 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
   // add one more element to buffer size for storing the derefinement counter
   bssame++;
 
-  MPI_Request *req_send, *req_recv;
-  // Step 5. allocate and start receiving buffers
-  if (nrecv != 0) {
-    recvbuf = new Real *[nrecv];
-    req_recv = new MPI_Request[nrecv];
-    int rb_idx = 0; // recv buffer index
-    for (int n = nbs; n <= nbe; n++) {
-      int on = newtoold[n];
-      LogicalLocation &oloc = loclist[on];
-      LogicalLocation &nloc = newloc[n];
-      if (oloc.level > nloc.level) { // f2c
-        for (int l = 0; l < nleaf; l++) {
-          if (ranklist[on + l] == Globals::my_rank) continue;
-          LogicalLocation &lloc = loclist[on + l];
-          int ox1 = ((lloc.lx1 & 1LL) == 1LL), ox2 = ((lloc.lx2 & 1LL) == 1LL),
-              ox3 = ((lloc.lx3 & 1LL) == 1LL);
-          recvbuf[rb_idx] = new Real[bsf2c];
-          int tag = CreateAMRMPITag(n - nbs, ox1, ox2, ox3);
-          MPI_Irecv(recvbuf[rb_idx], bsf2c, MPI_ATHENA_REAL, ranklist[on + l], tag,
-                    MPI_COMM_WORLD, &(req_recv[rb_idx]));
-          rb_idx++;
-        }
-      } else { // same level or c2f
-        if (ranklist[on] == Globals::my_rank) continue;
-        int size;
-        if (oloc.level == nloc.level) {
-          size = bssame;
-        } else {
-          size = bsc2f;
-        }
-        recvbuf[rb_idx] = new Real[size];
-        int tag = CreateAMRMPITag(n - nbs, 0, 0, 0);
-        MPI_Irecv(recvbuf[rb_idx], size, MPI_ATHENA_REAL, ranklist[on], tag,
-                  MPI_COMM_WORLD, &(req_recv[rb_idx]));
-        rb_idx++;
+  // Step 4. count the blocks to be sent / received and the buffer space they need
+  // for each receive, the old (source) and new (destination) gid of the block
+  std::vector<int> recv_old, recv_new;
+  std::vector<std::size_t> recv_offset(1, 0), send_offset(1, 0);
+  for (int n = nbs; n <= nbe; n++) {
+    int on = newtoold[n];
+    if (loclist[on].level > newloc[n].level) { // f2c
+      for (int k = 0; k < nleaf; k++) {
+        if (ranklist[on + k] == Globals::my_rank) continue;
+        recv_old.push_back(on + k);
+        recv_new.push_back(n);
+        recv_offset.push_back(recv_offset.back() + bsf2c);
       }
+    } else {
+      if (ranklist[on] == Globals::my_rank) continue;
+      recv_old.push_back(on);
+      recv_new.push_back(n);
+      int size = (loclist[on].level == newloc[n].level) ? bssame : bsc2f;
+      recv_offset.push_back(recv_offset.back() + size);
     }
   }
-  // Step 6. allocate, pack and start sending buffers
+  for (int n = onbs; n <= onbe; n++) {
+    int nn = oldtonew[n];
+    if (loclist[n].level < newloc[nn].level) { // c2f
+      for (int k = 0; k < nleaf; k++) {
+        if (newrank[nn + k] != Globals::my_rank)
+          send_offset.push_back(send_offset.back() + bsc2f);
+      }
+    } else if (newrank[nn] != Globals::my_rank) {
+      int size = (loclist[n].level == newloc[nn].level) ? bssame : bsf2c;
+      send_offset.push_back(send_offset.back() + size);
+    }
+  }
+  const int nsend = send_offset.size() - 1, nrecv = recv_offset.size() - 1;
+  // the buffers are reused by later regrids and only grow (all requests of the previous
+  // migration completed before it returned)
+  if (amr_sendbuf_.extent(0) < send_offset.back())
+    amr_sendbuf_ = BufArray1D<Real>("amr_sendbuf", send_offset.back());
+  if (amr_recvbuf_.extent(0) < recv_offset.back())
+    amr_recvbuf_ = BufArray1D<Real>("amr_recvbuf", recv_offset.back());
+  // the part of a buffer between two offsets
+  auto slice = [](BufArray1D<Real> &buf, std::size_t s, std::size_t e) {
+    return BufArray1D<Real>(Kokkos::subview(buf, std::make_pair(s, e)));
+  };
+
+  std::vector<MPI_Request> req_send(nsend), req_recv(nrecv);
+  // Step 5. start receiving buffers
+  for (int rb_idx = 0; rb_idx < nrecv; rb_idx++) {
+    int on = recv_old[rb_idx], n = recv_new[rb_idx];
+    int tag;
+    if (loclist[on].level > newloc[n].level) { // f2c
+      LogicalLocation &lloc = loclist[on];
+      int ox1 = ((lloc.lx1 & 1LL) == 1LL), ox2 = ((lloc.lx2 & 1LL) == 1LL),
+          ox3 = ((lloc.lx3 & 1LL) == 1LL);
+      tag = CreateAMRMPITag(n - nbs, ox1, ox2, ox3);
+    } else { // same level or c2f
+      tag = CreateAMRMPITag(n - nbs, 0, 0, 0);
+    }
+    int size = recv_offset[rb_idx + 1] - recv_offset[rb_idx];
+    MPI_Irecv(amr_recvbuf_.data() + recv_offset[rb_idx], size, MPI_ATHENA_REAL,
+              ranklist[on], tag, GetMPIComm(amr_phys_id), &(req_recv[rb_idx]));
+  }
+  // Step 6. pack and start sending buffers
   if (nsend != 0) {
-    sendbuf = new Real *[nsend];
-    req_send = new MPI_Request[nsend];
     int sb_idx = 0; // send buffer index
     for (int n = onbs; n <= onbe; n++) {
       int nn = oldtonew[n];
@@ -531,43 +889,109 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
       MeshBlock *pb = FindMeshBlock(n);
       if (nloc.level == oloc.level) { // same level
         if (newrank[nn] == Globals::my_rank) continue;
-        sendbuf[sb_idx] = new Real[bssame];
-        PrepareSendSameLevel(pb, sendbuf[sb_idx]);
+        auto sendbuf =
+            slice(amr_sendbuf_, send_offset[sb_idx], send_offset[sb_idx + 1]);
+        PrepareSendSameLevel(pb, sendbuf);
         int tag = CreateAMRMPITag(nn - nslist[newrank[nn]], 0, 0, 0);
-        MPI_Isend(sendbuf[sb_idx], bssame, MPI_ATHENA_REAL, newrank[nn], tag,
-                  MPI_COMM_WORLD, &(req_send[sb_idx]));
+        MPI_Isend(sendbuf.data(), bssame, MPI_ATHENA_REAL, newrank[nn], tag,
+                  GetMPIComm(amr_phys_id), &(req_send[sb_idx]));
         sb_idx++;
       } else if (nloc.level > oloc.level) { // c2f
         // c2f must communicate to multiple leaf blocks (unlike f2c, same2same)
         for (int l = 0; l < nleaf; l++) {
           if (newrank[nn + l] == Globals::my_rank) continue;
-          sendbuf[sb_idx] = new Real[bsc2f];
-          PrepareSendCoarseToFineAMR(pb, sendbuf[sb_idx], newloc[nn + l]);
+          auto sendbuf =
+              slice(amr_sendbuf_, send_offset[sb_idx], send_offset[sb_idx + 1]);
+          PrepareSendCoarseToFineAMR(pb, sendbuf, newloc[nn + l]);
           int tag = CreateAMRMPITag(nn + l - nslist[newrank[nn + l]], 0, 0, 0);
-          MPI_Isend(sendbuf[sb_idx], bsc2f, MPI_ATHENA_REAL, newrank[nn + l], tag,
-                    MPI_COMM_WORLD, &(req_send[sb_idx]));
+          MPI_Isend(sendbuf.data(), bsc2f, MPI_ATHENA_REAL, newrank[nn + l], tag,
+                    GetMPIComm(amr_phys_id), &(req_send[sb_idx]));
           sb_idx++;
         }      // end loop over nleaf (unique to c2f branch in this step 6)
       } else { // f2c: restrict + pack + send
         if (newrank[nn] == Globals::my_rank) continue;
-        sendbuf[sb_idx] = new Real[bsf2c];
-        PrepareSendFineToCoarseAMR(pb, sendbuf[sb_idx]);
+        auto sendbuf =
+            slice(amr_sendbuf_, send_offset[sb_idx], send_offset[sb_idx + 1]);
+        PrepareSendFineToCoarseAMR(pb, sendbuf);
         int ox1 = ((oloc.lx1 & 1LL) == 1LL), ox2 = ((oloc.lx2 & 1LL) == 1LL),
             ox3 = ((oloc.lx3 & 1LL) == 1LL);
         int tag = CreateAMRMPITag(nn - nslist[newrank[nn]], ox1, ox2, ox3);
-        MPI_Isend(sendbuf[sb_idx], bsf2c, MPI_ATHENA_REAL, newrank[nn], tag,
-                  MPI_COMM_WORLD, &(req_send[sb_idx]));
+        MPI_Isend(sendbuf.data(), bsf2c, MPI_ATHENA_REAL, newrank[nn], tag,
+                  GetMPIComm(amr_phys_id), &(req_send[sb_idx]));
         sb_idx++;
       }
     }
   }    // if (nsend !=0)
+
+  // unpack the receives that have completed into their (already constructed) blocks;
+  // with wait = true, block until at least one more receive has completed
+  std::vector<int> arrived, completed(nrecv);
+  int nunpacked = 0;
+  auto unpack_arrived = [&](bool wait) {
+    int ncompleted = MPI_UNDEFINED;
+    if (wait)
+      MPI_Waitsome(nrecv, req_recv.data(), &ncompleted, completed.data(),
+                   MPI_STATUSES_IGNORE);
+    else
+      MPI_Testsome(nrecv, req_recv.data(), &ncompleted, completed.data(),
+                   MPI_STATUSES_IGNORE);
+    if (ncompleted != MPI_UNDEFINED)
+      arrived.insert(arrived.end(), completed.begin(), completed.begin() + ncompleted);
+    int nwaiting = 0;
+    for (int rb_idx : arrived) {
+      int on = recv_old[rb_idx], n = recv_new[rb_idx];
+      MeshBlock *pb = newblocks[n - nbs];
+      if (pb == nullptr) { // the destination block has not been constructed yet
+        arrived[nwaiting++] = rb_idx;
+        continue;
+      }
+      auto recvbuf =
+          slice(amr_recvbuf_, recv_offset[rb_idx], recv_offset[rb_idx + 1]);
+      if (loclist[on].level == newloc[n].level) { // same
+        FinishRecvSameLevel(pb, recvbuf);
+      } else if (loclist[on].level > newloc[n].level) { // f2c
+        FinishRecvFineToCoarseAMR(pb, recvbuf, loclist[on]);
+      } else { // c2f
+        FinishRecvCoarseToFineAMR(pb, recvbuf);
+      }
+      nunpacked++;
+    }
+    arrived.resize(nwaiting);
+  };
 #endif // MPI_PARALLEL
 
+  // the particles of the blocks leaving this rank or changing level go to the blocks
+  // containing them once the new lists are in place
+  bool has_swarms = false;
+  for (auto &pkg : packages)
+    has_swarms = has_swarms || !pkg.second->AllSwarms().empty();
+  SwarmBoundaries::ParticleStash stash;
+  if (has_swarms) {
+    for (MeshBlock *pb : block_list) {
+      if (samegid[pb->gid] < nbs || samegid[pb->gid] > nbe)
+        SwarmBoundaries::StashParticles(pb, stash);
+    }
+  }
+
   // Step 7. construct a new MeshBlock list (moving the data within the MPI rank)
   MeshBlock *newlist = nullptr;
   MeshBlock *pmb = nullptr;
   RegionSize block_size = pblock->block_size;
 
+  // the blocks on a different refinement level or MPI rank are constructed up front on
+  // the mesh threads, the loop below only links and fills them
+  std::vector<int> create_gids;
+  // the blocks that keep their neighbor information, as they are moved
+  std::vector<bool> moved(nbe - nbs + 1, false);
+  for (int n = nbs; n <= nbe; n++) {
+    int on = newtoold[n];
+    if ((ranklist[on] != Globals::my_rank) || (loclist[on].level != newloc[n].level))
+      create_gids.push_back(n);
+  }
+  std::vector<MeshBlock *> created = ConstructMeshBlocks(
+      create_gids, nbs, newloc, block_size, pin, properties, packages, true);
+  int ncreated = 0;
+
   for (int n = nbs; n <= nbe; n++) {
     int on = newtoold[n];
     if ((ranklist[on] == Globals::my_rank) && (loclist[on].level == newloc[n].level)) {
@@ -591,18 +1015,15 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
       }
       pmb->gid = n;
       pmb->lid = n - nbs;
+      moved[n - nbs] = true;
     } else {
-      // on a different refinement level or MPI rank - create a new block
-      BoundaryFlag block_bcs[6];
-      SetBlockSizeAndBoundaries(newloc[n], block_size, block_bcs);
+      // on a different refinement level or MPI rank - use the new block
       // insert new block in singly-linked list of MeshBlocks
       if (n == nbs) { // first node
-        newlist = new MeshBlock(n, n - nbs, newloc[n], block_size, block_bcs, this, pin,
-                                properties, packages, gflag, true);
+        newlist = created[ncreated++];
         pmb = newlist;
       } else {
-        pmb->next = new MeshBlock(n, n - nbs, newloc[n], block_size, block_bcs, this, pin,
-                                  properties, packages, gflag, true);
+        pmb->next = created[ncreated++];
         pmb->next->prev = pmb;
         pmb = pmb->next;
       }
@@ -623,6 +1044,11 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
       ApplyBoundaryConditions(pmb->real_containers.Get());
       FillDerivedVariables::FillDerived(pmb->real_containers.Get());
     }
+    newblocks[n - nbs] = pmb;
+#ifdef MPI_PARALLEL
+    // unpack whatever has arrived while the remaining blocks are being constructed
+    if (nunpacked < nrecv) unpack_arrived(false);
+#endif
   }
 
   // discard remaining MeshBlocks
@@ -635,37 +1061,12 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
 
   // Replace the MeshBlock list
   pblock = newlist;
+  BuildBlockList();
 
-  // Step 8. Receive the data and load into MeshBlocks
-  // This is a test: try MPI_Waitall later.
+  // Step 8. Receive the remaining data and load into MeshBlocks, in order of arrival
 #ifdef MPI_PARALLEL
-  if (nrecv != 0) {
-    int rb_idx = 0; // recv buffer index
-    for (int n = nbs; n <= nbe; n++) {
-      int on = newtoold[n];
-      LogicalLocation &oloc = loclist[on];
-      LogicalLocation &nloc = newloc[n];
-      MeshBlock *pb = FindMeshBlock(n);
-      if (oloc.level == nloc.level) { // same
-        if (ranklist[on] == Globals::my_rank) continue;
-        MPI_Wait(&(req_recv[rb_idx]), MPI_STATUS_IGNORE);
-        FinishRecvSameLevel(pb, recvbuf[rb_idx]);
-        rb_idx++;
-      } else if (oloc.level > nloc.level) { // f2c
-        for (int l = 0; l < nleaf; l++) {
-          if (ranklist[on + l] == Globals::my_rank) continue;
-          MPI_Wait(&(req_recv[rb_idx]), MPI_STATUS_IGNORE);
-          FinishRecvFineToCoarseAMR(pb, recvbuf[rb_idx], loclist[on + l]);
-          rb_idx++;
-        }
-      } else { // c2f
-        if (ranklist[on] == Globals::my_rank) continue;
-        MPI_Wait(&(req_recv[rb_idx]), MPI_STATUS_IGNORE);
-        FinishRecvCoarseToFineAMR(pb, recvbuf[rb_idx]);
-        rb_idx++;
-      }
-    }
-  }
+  while (nunpacked < nrecv)
+    unpack_arrived(true);
 #endif
 
   // deallocate arrays
@@ -675,19 +1076,8 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
   delete[] newtoold;
   delete[] oldtonew;
 #ifdef MPI_PARALLEL
-  if (nsend != 0) {
-    MPI_Waitall(nsend, req_send, MPI_STATUSES_IGNORE);
-    for (int n = 0; n < nsend; n++)
-      delete[] sendbuf[n];
-    delete[] sendbuf;
-    delete[] req_send;
-  }
-  if (nrecv != 0) {
-    for (int n = 0; n < nrecv; n++)
-      delete[] recvbuf[n];
-    delete[] recvbuf;
-    delete[] req_recv;
-  }
+  // the send buffers are reused by the next migration
+  if (nsend != 0) MPI_Waitall(nsend, req_send.data(), MPI_STATUSES_IGNORE);
 #endif
 
   // update the lists
@@ -695,22 +1085,44 @@ void Mesh::RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot) {
   ranklist = newrank;
   costlist = newcost;
 
-  // re-initialize the MeshBlocks
-  pmb = pblock;
-  while (pmb != nullptr) {
-    pmb->pbval->SearchAndSetNeighbors(tree, ranklist, nslist);
-    pmb = pmb->next;
+  // re-initialize the MeshBlocks; the neighbors of moved blocks away from the refined
+  // and derefined ones are only renumbered instead of searched in the tree again
+  for (MeshBlock *pb : block_list) {
+    if (!moved[pb->lid] || !pb->pbval->RemapNeighbors(samegid.data(), ranklist, nslist))
+      pb->pbval->SearchAndSetNeighbors(tree, ranklist, nslist);
+    pb->kernel_graphs.clear();
   }
+  if (has_swarms) SwarmBoundaries::RestoreParticles(this, stash);
+  UpdateCoarseArrays();
   Initialize(2, pin);
+  mesh_generation++;
 
   ResetLoadBalanceVariables();
 
   return;
 }
 
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::ReserveAMRCaches(const int n)
+// \brief the tables of the block migration hold at least n entries. The host mirrors are
+// refilled for every block, so the kernels of the previous block that read them are
+// completed first.
+
+void Mesh::ReserveAMRCaches(const int n) {
+  Kokkos::fence();
+  if (amr_buf_cache_.extent_int(0) < n) {
+    amr_buf_cache_ = BufferCache_t("amr_buf_cache", n);
+    amr_buf_cache_h_ = Kokkos::create_mirror_view(amr_buf_cache_);
+    amr_copy_cache_ = CopyCache_t("amr_copy_cache", n);
+    amr_copy_cache_h_ = Kokkos::create_mirror_view(amr_copy_cache_);
+    amr_refine_cache_ = RefinementCache_t("amr_refine_cache", n);
+    amr_refine_cache_h_ = Kokkos::create_mirror_view(amr_refine_cache_);
+  }
+}
+
 // AMR: step 6, branch 1 (same2same: just pack+send)
 
-void Mesh::PrepareSendSameLevel(MeshBlock *pb, Real *sendbuf) {
+void Mesh::PrepareSendSameLevel(MeshBlock *pb, BufArray1D<Real> &sendbuf) {
   // pack
   int p = 0;
 
@@ -723,35 +1135,37 @@ void Mesh::PrepareSendSameLevel(MeshBlock *pb, Real *sendbuf) {
   // TODO(felker): add explicit check to ensure that elements of pb->vars_cc/fc_ and
   // pb->pmr->pvars_cc/fc_ v point to the same objects, if adaptive
 
-  // (C++11) range-based for loop: (automatic type deduction fails when iterating over
-  // container with std::reference_wrapper; could use auto var_cc_r = var_cc.get())
-  for (auto &pvar_cc : pb->vars_cc_) {
-    int nu = pvar_cc->GetDim(4) - 1;
-    auto &var_cc = pvar_cc->data;
-    BufferUtility::PackData(var_cc, sendbuf, 0, nu, pb->is, pb->ie, pb->js, pb->je,
-                            pb->ks, pb->ke, p);
+  // all cell-centered variables are packed by one kernel
+  const int nvar = pb->vars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    auto &pvar_cc = pb->vars_cc_[v];
+    amr_buf_cache_h_(v) = BufferEntry(pvar_cc->data, sendbuf, pvar_cc->GetDim(4) - 1,
+                                      pb->is, pb->ie, pb->js, pb->je, pb->ks, pb->ke, p);
   }
+  PackUnpackAMRBuffers<true>("PrepareSendSameLevel", pb->exec_space, amr_buf_cache_,
+                             amr_buf_cache_h_, nvar);
   for (auto &pvar_fc : pb->vars_fc_) {
     auto &var_fc = *pvar_fc;
     BufferUtility::PackData(var_fc.x1f, sendbuf, pb->is, pb->ie + 1, pb->js, pb->je,
-                            pb->ks, pb->ke, p);
+                            pb->ks, pb->ke, p, pb->exec_space);
     BufferUtility::PackData(var_fc.x2f, sendbuf, pb->is, pb->ie, pb->js, pb->je + f2,
-                            pb->ks, pb->ke, p);
+                            pb->ks, pb->ke, p, pb->exec_space);
     BufferUtility::PackData(var_fc.x3f, sendbuf, pb->is, pb->ie, pb->js, pb->je, pb->ks,
-                            pb->ke + f3, p);
-  }
-  // WARNING(felker): casting from "Real *" to "int *" in order to append single integer
-  // to send buffer is slightly unsafe (especially if sizeof(int) > sizeof(Real))
-  if (adaptive) {
-    int *dcp = reinterpret_cast<int *>(&(sendbuf[p]));
-    *dcp = pb->pmr->deref_count_;
+                            pb->ke + f3, p, pb->exec_space);
   }
+  // the derefinement counter travels as a Real in the last element
+  if (adaptive)
+    Kokkos::deep_copy(Kokkos::subview(sendbuf, p),
+                      static_cast<Real>(pb->pmr->deref_count_));
+  // the buffer is handed to MPI next
+  pb->exec_space.fence();
   return;
 }
 
 // step 6, branch 2 (c2f: just pack+send)
 
-void Mesh::PrepareSendCoarseToFineAMR(MeshBlock *pb, Real *sendbuf,
+void Mesh::PrepareSendCoarseToFineAMR(MeshBlock *pb, BufArray1D<Real> &sendbuf,
                                       LogicalLocation &lloc) {
   const int f2 = (ndim >= 2) ? 1 : 0; // extra cells/faces from being 2d
   const int f3 = (ndim >= 3) ? 1 : 0; // extra cells/faces from being 3d
@@ -781,53 +1195,73 @@ void Mesh::PrepareSendCoarseToFineAMR(MeshBlock *pb, Real *sendbuf,
     ku = pb->ke + f3;
   }
   int p = 0;
-  for (auto cc_pair : pb->pmr->pvars_cc_) {
-    ParArrayND<Real> var_cc = std::get<0>(cc_pair);
-    int nu = var_cc.GetDim(4) - 1;
-    BufferUtility::PackData(var_cc, sendbuf, 0, nu, il, iu, jl, ju, kl, ku, p);
+  const int nvar = pb->pmr->pvars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    ParArrayND<Real> var_cc = std::get<0>(pb->pmr->pvars_cc_[v]);
+    amr_buf_cache_h_(v) =
+        BufferEntry(var_cc, sendbuf, var_cc.GetDim(4) - 1, il, iu, jl, ju, kl, ku, p);
   }
+  PackUnpackAMRBuffers<true>("PrepareSendCoarseToFineAMR", pb->exec_space,
+                             amr_buf_cache_, amr_buf_cache_h_, nvar);
   for (auto fc_pair : pb->pmr->pvars_fc_) {
     FaceField *var_fc = std::get<0>(fc_pair);
-    BufferUtility::PackData((*var_fc).x1f, sendbuf, il, iu + 1, jl, ju, kl, ku, p);
-    BufferUtility::PackData((*var_fc).x2f, sendbuf, il, iu, jl, ju + f2, kl, ku, p);
-    BufferUtility::PackData((*var_fc).x3f, sendbuf, il, iu, jl, ju, kl, ku + f3, p);
+    BufferUtility::PackData((*var_fc).x1f, sendbuf, il, iu + 1, jl, ju, kl, ku, p,
+                            pb->exec_space);
+    BufferUtility::PackData((*var_fc).x2f, sendbuf, il, iu, jl, ju + f2, kl, ku, p,
+                            pb->exec_space);
+    BufferUtility::PackData((*var_fc).x3f, sendbuf, il, iu, jl, ju, kl, ku + f3, p,
+                            pb->exec_space);
   }
+  // the buffer is handed to MPI next
+  pb->exec_space.fence();
   return;
 }
 
 // step 6, branch 3 (f2c: restrict, pack, send)
 
-void Mesh::PrepareSendFineToCoarseAMR(MeshBlock *pb, Real *sendbuf) {
+void Mesh::PrepareSendFineToCoarseAMR(MeshBlock *pb, BufArray1D<Real> &sendbuf) {
   // restrict and pack
   const int f2 = (ndim >= 2) ? 1 : 0; // extra cells/faces from being 2d
   const int f3 = (ndim >= 3) ? 1 : 0; // extra cells/faces from being 3d
   auto &pmr = pb->pmr;
   int p = 0;
-  for (auto cc_pair : pmr->pvars_cc_) {
-    ParArrayND<Real> var_cc = std::get<0>(cc_pair);
-    ParArrayND<Real> coarse_cc = std::get<1>(cc_pair);
-    int nu = var_cc.GetDim(4) - 1;
-    pmr->RestrictCellCenteredValues(var_cc, coarse_cc, 0, nu, pb->cis, pb->cie, pb->cjs,
-                                    pb->cje, pb->cks, pb->cke);
-    BufferUtility::PackData(coarse_cc, sendbuf, 0, nu, pb->cis, pb->cie, pb->cjs, pb->cje,
-                            pb->cks, pb->cke, p);
+  // one kernel restricts all cell-centered variables, the next one packs them
+  const int nvar = pmr->pvars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    ParArrayND<Real> coarse_cc = std::get<1>(pmr->pvars_cc_[v]);
+    amr_refine_cache_h_(v) =
+        RefinementEntry(pmr->pvars_cc_[v], pb->cis, pb->cie, pb->cjs, pb->cje, pb->cks,
+                        pb->cke);
+    amr_buf_cache_h_(v) =
+        BufferEntry(coarse_cc, sendbuf, coarse_cc.GetDim(4) - 1, pb->cis, pb->cie,
+                    pb->cjs, pb->cje, pb->cks, pb->cke, p);
   }
+  if (nvar > 0) {
+    Kokkos::deep_copy(pb->exec_space, amr_refine_cache_, amr_refine_cache_h_);
+    pmr->RestrictCellCenteredRegions(amr_refine_cache_, nvar);
+  }
+  PackUnpackAMRBuffers<true>("PrepareSendFineToCoarseAMR", pb->exec_space,
+                             amr_buf_cache_, amr_buf_cache_h_, nvar);
   for (auto fc_pair : pb->pmr->pvars_fc_) {
     FaceField *var_fc = std::get<0>(fc_pair);
     FaceField *coarse_fc = std::get<1>(fc_pair);
     pmr->RestrictFieldX1((*var_fc).x1f, (*coarse_fc).x1f, pb->cis, pb->cie + 1, pb->cjs,
                          pb->cje, pb->cks, pb->cke);
     BufferUtility::PackData((*coarse_fc).x1f, sendbuf, pb->cis, pb->cie + 1, pb->cjs,
-                            pb->cje, pb->cks, pb->cke, p);
+                            pb->cje, pb->cks, pb->cke, p, pb->exec_space);
     pmr->RestrictFieldX2((*var_fc).x2f, (*coarse_fc).x2f, pb->cis, pb->cie, pb->cjs,
                          pb->cje + f2, pb->cks, pb->cke);
     BufferUtility::PackData((*coarse_fc).x2f, sendbuf, pb->cis, pb->cie, pb->cjs,
-                            pb->cje + f2, pb->cks, pb->cke, p);
+                            pb->cje + f2, pb->cks, pb->cke, p, pb->exec_space);
     pmr->RestrictFieldX3((*var_fc).x3f, (*coarse_fc).x3f, pb->cis, pb->cie, pb->cjs,
                          pb->cje, pb->cks, pb->cke + f3);
     BufferUtility::PackData((*coarse_fc).x3f, sendbuf, pb->cis, pb->cie, pb->cjs, pb->cje,
-                            pb->cks, pb->cke + f3, p);
+                            pb->cks, pb->cke + f3, p, pb->exec_space);
   }
+  // the buffer is handed to MPI next
+  pb->exec_space.fence();
   return;
 }
 
@@ -840,29 +1274,29 @@ void Mesh::FillSameRankFineToCoarseAMR(MeshBlock *pob, MeshBlock *pmb,
   int jl = pmb->js + ((loc.lx2 & 1LL) == 1LL) * pmb->block_size.nx2 / 2;
   int kl = pmb->ks + ((loc.lx3 & 1LL) == 1LL) * pmb->block_size.nx3 / 2;
 
-  // absent a zip() feature for range-based for loops, manually advance the
-  // iterator over "SMR/AMR-enrolled" cell-centered quantities on the new
-  // MeshBlock in lock-step with pob
-  auto pmb_cc_it = pmb->pmr->pvars_cc_.begin();
-  // iterate MeshRefinement std::vectors on pob
-  for (auto cc_pair : pmr->pvars_cc_) {
-    ParArrayND<Real> var_cc = std::get<0>(cc_pair);
-    ParArrayND<Real> coarse_cc = std::get<1>(cc_pair);
-    int nu = var_cc.GetDim(4) - 1;
-    pmr->RestrictCellCenteredValues(var_cc, coarse_cc, 0, nu, pob->cis, pob->cie,
-                                    pob->cjs, pob->cje, pob->cks, pob->cke);
-    // copy from old/original/other MeshBlock (pob) to newly created block (pmb)
-    ParArrayND<Real> src = coarse_cc;
-    ParArrayND<Real> dst = std::get<0>(*pmb_cc_it);
-    for (int nv = 0; nv <= nu; nv++) {
-      for (int k = kl, fk = pob->cks; fk <= pob->cke; k++, fk++) {
-        for (int j = jl, fj = pob->cjs; fj <= pob->cje; j++, fj++) {
-          for (int i = il, fi = pob->cis; fi <= pob->cie; i++, fi++)
-            dst(nv, k, j, i) = src(nv, fk, fj, fi);
-        }
-      }
-    }
-    pmb_cc_it++;
+  // the "SMR/AMR-enrolled" cell-centered quantities of pob are restricted by one kernel
+  // and copied into the new MeshBlock pmb by another, pairing the variables by index
+  const int nvar = pmr->pvars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    amr_refine_cache_h_(v) = RefinementEntry(pmr->pvars_cc_[v], pob->cis, pob->cie,
+                                             pob->cjs, pob->cje, pob->cks, pob->cke);
+    BndCopyInfo &c = amr_copy_cache_h_(v);
+    ParArrayND<Real> src = std::get<1>(pmr->pvars_cc_[v]);
+    ParArrayND<Real> dst = std::get<0>(pmb->pmr->pvars_cc_[v]);
+    c.si = il, c.ei = il + pob->cie - pob->cis;
+    c.sj = jl, c.ej = jl + pob->cje - pob->cjs;
+    c.sk = kl, c.ek = kl + pob->cke - pob->cks;
+    c.nl = 0, c.nu = src.GetDim(4) - 1;
+    c.di = pob->cis - il, c.dj = pob->cjs - jl, c.dk = pob->cks - kl;
+    c.src = src.Get<4>();
+    c.dst = dst.Get<4>();
+  }
+  if (nvar > 0) {
+    Kokkos::deep_copy(pob->exec_space, amr_refine_cache_, amr_refine_cache_h_);
+    pmr->RestrictCellCenteredRegions(amr_refine_cache_, nvar);
+    Kokkos::deep_copy(pob->exec_space, amr_copy_cache_, amr_copy_cache_h_);
+    CopyRegions("FillSameRankFineToCoarseAMR", pob->exec_space, amr_copy_cache_, nvar);
   }
 
   const int f2 = (ndim >= 2) ? 1 : 0; // extra cells/faces from being 2d
@@ -913,6 +1347,8 @@ void Mesh::FillSameRankFineToCoarseAMR(MeshBlock *pob, MeshBlock *pmb,
     }
     pmb_fc_it++;
   }
+  // the boundary conditions of pmb follow
+  pob->exec_space.fence();
   return;
 }
 
@@ -931,27 +1367,27 @@ void Mesh::FillSameRankCoarseToFineAMR(MeshBlock *pob, MeshBlock *pmb,
   int cjs = ((newloc.lx2 & 1LL) == 1LL) * pob->block_size.nx2 / 2 + pob->js - f2;
   int cks = ((newloc.lx3 & 1LL) == 1LL) * pob->block_size.nx3 / 2 + pob->ks - f3;
 
-  auto pob_cc_it = pob->pmr->pvars_cc_.begin();
-  // iterate MeshRefinement std::vectors on new pmb
-  for (auto cc_pair : pmr->pvars_cc_) {
-    ParArrayND<Real> var_cc = std::get<0>(cc_pair);
-    ParArrayND<Real> coarse_cc = std::get<1>(cc_pair);
-    int nu = var_cc.GetDim(4) - 1;
-
-    ParArrayND<Real> src = std::get<0>(*pob_cc_it);
-    ParArrayND<Real> dst = coarse_cc;
-    // fill the coarse buffer
-    for (int nv = 0; nv <= nu; nv++) {
-      for (int k = kl, ck = cks; k <= ku; k++, ck++) {
-        for (int j = jl, cj = cjs; j <= ju; j++, cj++) {
-          for (int i = il, ci = cis; i <= iu; i++, ci++)
-            dst(nv, k, j, i) = src(nv, ck, cj, ci);
-        }
-      }
-    }
-    pmr->ProlongateCellCenteredValues(dst, var_cc, 0, nu, pob->cis, pob->cie, pob->cjs,
-                                      pob->cje, pob->cks, pob->cke);
-    pob_cc_it++;
+  // the cell-centered quantities of pob are copied into the coarse arrays of the new
+  // MeshBlock pmb by one kernel and prolongated by another
+  const int nvar = pmr->pvars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    BndCopyInfo &c = amr_copy_cache_h_(v);
+    ParArrayND<Real> src = std::get<0>(pob->pmr->pvars_cc_[v]);
+    ParArrayND<Real> dst = std::get<1>(pmr->pvars_cc_[v]);
+    c.si = il, c.ei = iu, c.sj = jl, c.ej = ju, c.sk = kl, c.ek = ku;
+    c.nl = 0, c.nu = dst.GetDim(4) - 1;
+    c.di = cis - il, c.dj = cjs - jl, c.dk = cks - kl;
+    c.src = src.Get<4>();
+    c.dst = dst.Get<4>();
+    amr_refine_cache_h_(v) = RefinementEntry(pmr->pvars_cc_[v], pob->cis, pob->cie,
+                                             pob->cjs, pob->cje, pob->cks, pob->cke);
+  }
+  if (nvar > 0) {
+    Kokkos::deep_copy(pmb->exec_space, amr_copy_cache_, amr_copy_cache_h_);
+    CopyRegions("FillSameRankCoarseToFineAMR", pmb->exec_space, amr_copy_cache_, nvar);
+    Kokkos::deep_copy(pmb->exec_space, amr_refine_cache_, amr_refine_cache_h_);
+    pmr->ProlongateCellCenteredRegions(amr_refine_cache_, nvar);
   }
   auto pob_fc_it = pob->pmr->pvars_fc_.begin();
   // iterate MeshRefinement std::vectors on new pmb
@@ -989,29 +1425,35 @@ void Mesh::FillSameRankCoarseToFineAMR(MeshBlock *pob, MeshBlock *pmb,
                                  pob->cks, pob->cke);
     pob_fc_it++;
   }
+  // the boundary conditions of pmb follow
+  pmb->exec_space.fence();
   return;
 }
 
 // step 8 (receive and load), branch 1 (same2same: unpack)
-void Mesh::FinishRecvSameLevel(MeshBlock *pb, Real *recvbuf) {
+void Mesh::FinishRecvSameLevel(MeshBlock *pb, BufArray1D<Real> &recvbuf) {
   int p = 0;
   const int f2 = (ndim >= 2) ? 1 : 0; // extra cells/faces from being 2d
   const int f3 = (ndim >= 3) ? 1 : 0; // extra cells/faces from being 3d
 
-  for (auto &pvar_cc : pb->vars_cc_) {
-    int nu = pvar_cc->GetDim(4) - 1;
-    auto &var_cc = pvar_cc->data;
-    BufferUtility::UnpackData(recvbuf, var_cc, 0, nu, pb->is, pb->ie, pb->js, pb->je,
-                              pb->ks, pb->ke, p);
+  const int nvar = pb->vars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    auto &pvar_cc = pb->vars_cc_[v];
+    amr_buf_cache_h_(v) = BufferEntry(pvar_cc->data, recvbuf, pvar_cc->GetDim(4) - 1,
+                                      pb->is, pb->ie, pb->js, pb->je, pb->ks, pb->ke, p);
   }
+  PackUnpackAMRBuffers<false>("FinishRecvSameLevel", pb->exec_space, amr_buf_cache_,
+                              amr_buf_cache_h_, nvar);
   for (auto &pvar_fc : pb->vars_fc_) {
     auto &var_fc = *pvar_fc;
     BufferUtility::UnpackData(recvbuf, var_fc.x1f, pb->is, pb->ie + 1, pb->js, pb->je,
-                              pb->ks, pb->ke, p);
+                              pb->ks, pb->ke, p, pb->exec_space);
     BufferUtility::UnpackData(recvbuf, var_fc.x2f, pb->is, pb->ie, pb->js, pb->je + f2,
-                              pb->ks, pb->ke, p);
+                              pb->ks, pb->ke, p, pb->exec_space);
     BufferUtility::UnpackData(recvbuf, var_fc.x3f, pb->is, pb->ie, pb->js, pb->je, pb->ks,
-                              pb->ke + f3, p);
+                              pb->ke + f3, p, pb->exec_space);
+    pb->exec_space.fence();
     if (pb->block_size.nx2 == 1) {
       for (int i = pb->is; i <= pb->ie; i++)
         var_fc.x2f(pb->ks, pb->js + 1, i) = var_fc.x2f(pb->ks, pb->js, i);
@@ -1023,17 +1465,17 @@ void Mesh::FinishRecvSameLevel(MeshBlock *pb, Real *recvbuf) {
       }
     }
   }
-  // WARNING(felker): casting from "Real *" to "int *" in order to read single
-  // appended integer from received buffer is slightly unsafe
+  // the derefinement counter travels as a Real in the last element
   if (adaptive) {
-    int *dcp = reinterpret_cast<int *>(&(recvbuf[p]));
-    pb->pmr->deref_count_ = *dcp;
+    Real deref_count;
+    Kokkos::deep_copy(deref_count, Kokkos::subview(recvbuf, p));
+    pb->pmr->deref_count_ = static_cast<int>(deref_count);
   }
   return;
 }
 
 // step 8 (receive and load), branch 2 (f2c: unpack)
-void Mesh::FinishRecvFineToCoarseAMR(MeshBlock *pb, Real *recvbuf,
+void Mesh::FinishRecvFineToCoarseAMR(MeshBlock *pb, BufArray1D<Real> &recvbuf,
                                      LogicalLocation &lloc) {
   const int f2 = (ndim >= 2) ? 1 : 0; // extra cells/faces from being 2d
   const int f3 = (ndim >= 3) ? 1 : 0; // extra cells/faces from being 3d
@@ -1054,17 +1496,25 @@ void Mesh::FinishRecvFineToCoarseAMR(MeshBlock *pb, Real *recvbuf,
   else
     kl = pb->ks + pb->block_size.nx3 / 2, ku = pb->ke;
 
-  for (auto cc_pair : pb->pmr->pvars_cc_) {
-    ParArrayND<Real> var_cc = std::get<0>(cc_pair);
-    int nu = var_cc.GetDim(4) - 1;
-    BufferUtility::UnpackData(recvbuf, var_cc, 0, nu, il, iu, jl, ju, kl, ku, p);
+  const int nvar = pb->pmr->pvars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    ParArrayND<Real> var_cc = std::get<0>(pb->pmr->pvars_cc_[v]);
+    amr_buf_cache_h_(v) =
+        BufferEntry(var_cc, recvbuf, var_cc.GetDim(4) - 1, il, iu, jl, ju, kl, ku, p);
   }
+  PackUnpackAMRBuffers<false>("FinishRecvFineToCoarseAMR", pb->exec_space,
+                              amr_buf_cache_, amr_buf_cache_h_, nvar);
   for (auto fc_pair : pb->pmr->pvars_fc_) {
     FaceField *var_fc = std::get<0>(fc_pair);
     FaceField &dst_b = *var_fc;
-    BufferUtility::UnpackData(recvbuf, dst_b.x1f, il, iu + 1, jl, ju, kl, ku, p);
-    BufferUtility::UnpackData(recvbuf, dst_b.x2f, il, iu, jl, ju + f2, kl, ku, p);
-    BufferUtility::UnpackData(recvbuf, dst_b.x3f, il, iu, jl, ju, kl, ku + f3, p);
+    BufferUtility::UnpackData(recvbuf, dst_b.x1f, il, iu + 1, jl, ju, kl, ku, p,
+                              pb->exec_space);
+    BufferUtility::UnpackData(recvbuf, dst_b.x2f, il, iu, jl, ju + f2, kl, ku, p,
+                              pb->exec_space);
+    BufferUtility::UnpackData(recvbuf, dst_b.x3f, il, iu, jl, ju, kl, ku + f3, p,
+                              pb->exec_space);
+    pb->exec_space.fence();
     if (pb->block_size.nx2 == 1) {
       for (int i = il; i <= iu; i++)
         dst_b.x2f(pb->ks, pb->js + 1, i) = dst_b.x2f(pb->ks, pb->js, i);
@@ -1080,28 +1530,42 @@ void Mesh::FinishRecvFineToCoarseAMR(MeshBlock *pb, Real *recvbuf,
 }
 
 // step 8 (receive and load), branch 2 (c2f: unpack+prolongate)
-void Mesh::FinishRecvCoarseToFineAMR(MeshBlock *pb, Real *recvbuf) {
+void Mesh::FinishRecvCoarseToFineAMR(MeshBlock *pb, BufArray1D<Real> &recvbuf) {
   const int f2 = (ndim >= 2) ? 1 : 0; // extra cells/faces from being 2d
   const int f3 = (ndim >= 3) ? 1 : 0; // extra cells/faces from being 3d
   auto &pmr = pb->pmr;
   int p = 0;
   int il = pb->cis - 1, iu = pb->cie + 1, jl = pb->cjs - f2, ju = pb->cje + f2,
       kl = pb->cks - f3, ku = pb->cke + f3;
-  for (auto cc_pair : pb->pmr->pvars_cc_) {
-    ParArrayND<Real> var_cc = std::get<0>(cc_pair);
-    ParArrayND<Real> coarse_cc = std::get<1>(cc_pair);
-    int nu = var_cc.GetDim(4) - 1;
-    BufferUtility::UnpackData(recvbuf, coarse_cc, 0, nu, il, iu, jl, ju, kl, ku, p);
-    pmr->ProlongateCellCenteredValues(coarse_cc, var_cc, 0, nu, pb->cis, pb->cie, pb->cjs,
-                                      pb->cje, pb->cks, pb->cke);
+  // one kernel unpacks all cell-centered variables into the coarse arrays, the next one
+  // prolongates them
+  const int nvar = pmr->pvars_cc_.size();
+  ReserveAMRCaches(nvar);
+  for (int v = 0; v < nvar; v++) {
+    ParArrayND<Real> coarse_cc = std::get<1>(pmr->pvars_cc_[v]);
+    amr_buf_cache_h_(v) = BufferEntry(coarse_cc, recvbuf, coarse_cc.GetDim(4) - 1, il,
+                                      iu, jl, ju, kl, ku, p);
+    amr_refine_cache_h_(v) = RefinementEntry(pmr->pvars_cc_[v], pb->cis, pb->cie,
+                                             pb->cjs, pb->cje, pb->cks, pb->cke);
+  }
+  PackUnpackAMRBuffers<false>("FinishRecvCoarseToFineAMR", pb->exec_space,
+                              amr_buf_cache_, amr_buf_cache_h_, nvar);
+  if (nvar > 0) {
+    Kokkos::deep_copy(pb->exec_space, amr_refine_cache_, amr_refine_cache_h_);
+    pmr->ProlongateCellCenteredRegions(amr_refine_cache_, nvar);
   }
   for (auto fc_pair : pb->pmr->pvars_fc_) {
     FaceField *var_fc = std::get<0>(fc_pair);
     FaceField *coarse_fc = std::get<1>(fc_pair);
 
-    BufferUtility::UnpackData(recvbuf, (*coarse_fc).x1f, il, iu + 1, jl, ju, kl, ku, p);
-    BufferUtility::UnpackData(recvbuf, (*coarse_fc).x2f, il, iu, jl, ju + f2, kl, ku, p);
-    BufferUtility::UnpackData(recvbuf, (*coarse_fc).x3f, il, iu, jl, ju, kl, ku + f3, p);
+    BufferUtility::UnpackData(recvbuf, (*coarse_fc).x1f, il, iu + 1, jl, ju, kl, ku, p,
+                              pb->exec_space);
+    BufferUtility::UnpackData(recvbuf, (*coarse_fc).x2f, il, iu, jl, ju + f2, kl, ku, p,
+                              pb->exec_space);
+    BufferUtility::UnpackData(recvbuf, (*coarse_fc).x3f, il, iu, jl, ju, kl, ku + f3, p,
+                              pb->exec_space);
+    // the face-centered prolongation runs on the host
+    pb->exec_space.fence();
     pmr->ProlongateSharedFieldX1((*coarse_fc).x1f, (*var_fc).x1f, pb->cis, pb->cie + 1,
                                  pb->cjs, pb->cje, pb->cks, pb->cke);
     pmr->ProlongateSharedFieldX2((*coarse_fc).x2f, (*var_fc).x2f, pb->cis, pb->cie,
@@ -1118,13 +1582,11 @@ void Mesh::FinishRecvCoarseToFineAMR(MeshBlock *pb, Real *recvbuf) {
 //! \fn int CreateAMRMPITag(int lid, int ox1, int ox2, int ox3)
 //  \brief calculate an MPI tag for AMR block transfer
 // tag = local id of destination (remaining bits) + ox1(1 bit) + ox2(1 bit) + ox3(1 bit)
-//       + physics(5 bits)
-
-// See comments on BoundaryBase::CreateBvalsMPITag()
+// The messages are sent on GetMPIComm(amr_phys_id), CheckMPITagRange() ensures that the
+// tags stay below MPI_TAG_UB.
 
 int Mesh::CreateAMRMPITag(int lid, int ox1, int ox2, int ox3) {
-  // former "AthenaTagMPI" AthenaTagMPI::amr=8 redefined to 0
-  return (lid << 8) | (ox1 << 7) | (ox2 << 6) | (ox3 << 5) | 0;
+  return (lid << 3) | (ox1 << 2) | (ox2 << 1) | ox3;
 }
 
 } // namespace parthenon
@@ -0,0 +1,191 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file block_size_calibration.cpp
+//  \brief timing of candidate MeshBlock sizes on the mesh of the input
+
+#include "mesh/block_size_calibration.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "parthenon_mpi.hpp"
+
+#include "athena.hpp"
+#include "bvals/boundary_conditions.hpp"
+#include "globals.hpp"
+#include "interface/update.hpp"
+#include "mesh/mesh.hpp"
+#include "parameter_input.hpp"
+
+namespace parthenon {
+namespace BlockSizeCalibration {
+
+namespace {
+
+void SetBlockSize(ParameterInput *pin, const std::array<int, 3> &nx) {
+  pin->SetInteger("meshblock", "nx1", nx[0]);
+  pin->SetInteger("meshblock", "nx2", nx[1]);
+  pin->SetInteger("meshblock", "nx3", nx[2]);
+}
+
+// one cycle of the work that depends on the block size and not on the driver: the
+// boundary exchange of the base containers and the package functions run on each block
+void Cycle(Mesh *pmesh) {
+  const std::vector<MeshBlock *> &blocks = pmesh->block_list;
+  const int nmb = blocks.size();
+  const int nthreads = pmesh->GetNumMeshThreads();
+#pragma omp parallel num_threads(nthreads)
+  {
+#pragma omp for
+    for (int i = 0; i < nmb; ++i) {
+      blocks[i]->real_containers.Get().StartReceiving(BoundaryCommSubset::all);
+    }
+#pragma omp for
+    for (int i = 0; i < nmb; ++i) {
+      blocks[i]->real_containers.Get().SendBoundaryBuffers();
+    }
+#pragma omp for
+    for (int i = 0; i < nmb; ++i) {
+      blocks[i]->real_containers.Get().ReceiveAndSetBoundariesWithWait();
+    }
+#pragma omp for
+    for (int i = 0; i < nmb; ++i) {
+      blocks[i]->real_containers.Get().ClearBoundary(BoundaryCommSubset::all);
+    }
+#pragma omp for
+    for (int i = 0; i < nmb; ++i) {
+      MeshBlock *pmb = blocks[i];
+      Container<Real> &rc = pmb->real_containers.Get();
+      if (pmesh->multilevel) pmb->pbval->ProlongateBoundaries(pmesh->time, 0.0);
+      ApplyBoundaryConditions(rc);
+      FillDerivedVariables::FillDerived(rc);
+      pmb->SetBlockTimestep(Update::EstimateTimestep(rc));
+    }
+  }
+  Kokkos::fence();
+}
+
+} // namespace
+
+std::vector<std::array<int, 3>> Candidates(ParameterInput *pin) {
+  const std::array<int, 3> mesh_nx{{pin->GetInteger("mesh", "nx1"),
+                                    pin->GetOrAddInteger("mesh", "nx2", 1),
+                                    pin->GetOrAddInteger("mesh", "nx3", 1)}};
+  std::vector<int> edges;
+  std::istringstream list(
+      pin->GetOrAddString("meshblock", "calibrate_sizes", "8,16,32,64,128"));
+  std::string edge;
+  while (std::getline(list, edge, ',')) {
+    if (!edge.empty()) edges.push_back(std::stoi(edge));
+  }
+
+  std::vector<std::array<int, 3>> sizes;
+  auto add = [&](const std::array<int, 3> &nx) {
+    std::int64_t nblocks = 1;
+    for (int d = 0; d < 3; d++) {
+      if (mesh_nx[d] % nx[d] != 0 || (mesh_nx[d] > 1 && nx[d] < 4)) return;
+      nblocks *= mesh_nx[d] / nx[d];
+    }
+    if (nblocks < Globals::nranks) return;
+    if (std::find(sizes.begin(), sizes.end(), nx) == sizes.end()) sizes.push_back(nx);
+  };
+  for (const int n : edges) {
+    std::array<int, 3> nx;
+    for (int d = 0; d < 3; d++) {
+      nx[d] = std::min(n, mesh_nx[d]);
+    }
+    add(nx);
+  }
+  add({{pin->GetOrAddInteger("meshblock", "nx1", mesh_nx[0]),
+        pin->GetOrAddInteger("meshblock", "nx2", mesh_nx[1]),
+        pin->GetOrAddInteger("meshblock", "nx3", mesh_nx[2])}});
+  return sizes;
+}
+
+void Calibrate(ParameterInput *pin, Properties_t &properties, Packages_t &packages) {
+  if (!pin->GetOrAddBoolean("meshblock", "calibrate", false)) return;
+  const std::vector<std::array<int, 3>> sizes = Candidates(pin);
+  if (sizes.size() < 2) return;
+  const int trials =
+      std::max(1, pin->GetOrAddInteger("meshblock", "calibrate_trials", 3));
+
+  if (Globals::my_rank == 0) {
+    std::cout << std::endl
+              << "Calibrating the MeshBlock size on " << Globals::nranks << " ranks"
+              << std::endl
+              << std::setw(16) << "block" << std::setw(10) << "blocks" << std::setw(16)
+              << "s/cycle" << std::setw(20) << "zone-cycles/wall_s" << std::endl;
+  }
+  std::array<int, 3> best = sizes.back();
+  double best_zcs = 0.0;
+  for (const auto &nx : sizes) {
+    SetBlockSize(pin, nx);
+    auto pmesh = std::make_unique<Mesh>(pin, properties, packages);
+    // as in ParthenonManager::ParthenonInit, max_level counts from the root level, which
+    // depends on the block size
+    for (auto const &ph : packages) {
+      for (auto &amr : ph.second->amr_criteria) {
+        amr->max_level += pmesh->GetRootLevel();
+      }
+    }
+    pmesh->Initialize(0, pin);
+
+    double seconds = std::numeric_limits<double>::max();
+    for (int n = 0; n <= trials; n++) {
+      const auto start = std::chrono::steady_clock::now();
+      Cycle(pmesh.get());
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      double cycle = elapsed.count();
+#ifdef MPI_PARALLEL
+      MPI_Allreduce(MPI_IN_PLACE, &cycle, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+      // the first cycle is a warmup
+      if (n > 0) seconds = std::min(seconds, cycle);
+    }
+    const double zcs = static_cast<double>(pmesh->GetTotalCells()) / seconds;
+    if (Globals::my_rank == 0) {
+      std::ostringstream block;
+      block << nx[0] << "x" << nx[1] << "x" << nx[2];
+      std::cout << std::setw(16) << block.str() << std::setw(10) << pmesh->nbtotal
+                << std::scientific << std::setprecision(3) << std::setw(16) << seconds
+                << std::setw(20) << zcs << std::defaultfloat << std::endl;
+    }
+    if (zcs > best_zcs) {
+      best_zcs = zcs;
+      best = nx;
+    }
+
+    for (auto const &ph : packages) {
+      for (auto &amr : ph.second->amr_criteria) {
+        amr->max_level -= pmesh->GetRootLevel();
+      }
+    }
+  }
+
+  SetBlockSize(pin, best);
+  if (Globals::my_rank == 0) {
+    std::cout << "Using MeshBlock size " << best[0] << "x" << best[1] << "x" << best[2]
+              << std::endl;
+  }
+}
+
+} // namespace BlockSizeCalibration
+} // namespace parthenon
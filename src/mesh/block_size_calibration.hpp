@@ -0,0 +1,52 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef MESH_BLOCK_SIZE_CALIBRATION_HPP_
+#define MESH_BLOCK_SIZE_CALIBRATION_HPP_
+//! \file block_size_calibration.hpp
+//  \brief choice of the MeshBlock size by timing candidate sizes at startup
+
+#include <array>
+#include <vector>
+
+#include "interface/properties_interface.hpp"
+#include "interface/state_descriptor.hpp"
+
+namespace parthenon {
+
+class ParameterInput;
+
+namespace BlockSizeCalibration {
+
+// the block sizes to try: for each edge length of <meshblock>/calibrate_sizes (by default
+// 8, 16, 32, 64 and 128), the cube of that edge in the dimensions of the mesh, clipped to
+// the mesh, and the size given in <meshblock>. Sizes that do not divide the mesh, have
+// an edge of fewer than 4 cells, or give fewer blocks than ranks are left out.
+std::vector<std::array<int, 3>> Candidates(ParameterInput *pin);
+
+//----------------------------------------------------------------------------------------
+//! \fn void Calibrate(ParameterInput *pin, Properties_t &properties,
+//                     Packages_t &packages)
+//  \brief With <meshblock>/calibrate = true, builds the mesh of the input on all ranks
+//  with each candidate size in turn, sets the initial conditions, and times cycles of
+//  the boundary exchange, the boundary conditions and the FillDerived and
+//  EstimateTimestep functions of the packages. The best of <meshblock>/calibrate_trials
+//  cycles (default 3, after one untimed warmup cycle) of the slowest rank gives the
+//  projected zone-cycles per wall second of the size, and the fastest size is written
+//  to <meshblock>/nx1, nx2 and nx3. Collective; rank 0 prints the timings.
+
+void Calibrate(ParameterInput *pin, Properties_t &properties, Packages_t &packages);
+
+} // namespace BlockSizeCalibration
+} // namespace parthenon
+
+#endif // MESH_BLOCK_SIZE_CALIBRATION_HPP_
@@ -18,6 +18,7 @@
 //  \brief implementation of functions in Mesh class
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <cmath>
 #include <cstdint>
@@ -29,6 +30,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "parthenon_mpi.hpp"
@@ -38,13 +40,19 @@
 #include "bvals/bvals.hpp"
 #include "coordinates/coordinates.hpp"
 #include "globals.hpp"
+#include "interface/container_iterator.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/mesh_refinement.hpp"
 #include "mesh/meshblock_tree.hpp"
+#include "outputs/initial_data.hpp"
 #include "outputs/io_wrapper.hpp"
+#include "outputs/restart.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
+#include "refinement/refinement.hpp"
+#include "utils/array_pool.hpp"
 #include "utils/buffer_utils.hpp"
+#include "utils/memory_usage.hpp"
 
 namespace parthenon {
 
@@ -80,18 +88,20 @@ Mesh::Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
           (adaptive || pin->GetOrAddString("mesh", "refinement", "none") == "static")
               ? true
               : false),
+      subcycling(pin->GetOrAddBoolean("time", "subcycling", false) && multilevel),
       start_time(pin->GetOrAddReal("time", "start_time", 0.0)), time(start_time),
       tlim(pin->GetReal("time", "tlim")), dt(std::numeric_limits<Real>::max()),
       dt_hyperbolic(dt), dt_parabolic(dt), dt_user(dt),
       nlim(pin->GetOrAddInteger("time", "nlim", -1)), ncycle(),
       ncycle_out(pin->GetOrAddInteger("time", "ncycle_out", 1)),
-      dt_diagnostics(pin->GetOrAddInteger("time", "dt_diagnostics", -1)), nbnew(),
-      nbdel(), step_since_lb(), gflag(), pblock(nullptr), properties(properties),
-      packages(packages),
+      dt_diagnostics(pin->GetOrAddInteger("time", "dt_diagnostics", -1)),
+      perf_diagnostics(pin->GetOrAddInteger("time", "perf_diagnostics", -1)), nbnew(),
+      nbdel(), step_since_lb(), gflag(), mesh_generation(), pblock(nullptr),
+      properties(properties), packages(packages),
       // private members:
       next_phys_id_(), num_mesh_threads_(pin->GetOrAddInteger("mesh", "num_threads", 1)),
       tree(this), use_uniform_meshgen_fn_{true, true, true}, nuser_history_output_(),
-      lb_flag_(true), lb_automatic_(),
+      lb_flag_(true), lb_automatic_(), lb_fence_timing_(),
       lb_manual_(), MeshGenerator_{UniformMeshGeneratorX1, UniformMeshGeneratorX2,
                                    UniformMeshGeneratorX3},
       BoundaryFunction_{nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}, AMRFlag_{},
@@ -99,7 +109,6 @@ Mesh::Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
   std::stringstream msg;
   RegionSize block_size;
   MeshBlock *pfirst{};
-  BoundaryFlag block_bcs[6];
   std::int64_t nbmax;
 
   // mesh test
@@ -109,6 +118,7 @@ Mesh::Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
   // reserve phys=0 for former TAG_AMR=8; now hard-coded in Mesh::CreateAMRMPITag()
   next_phys_id_ = 1;
   ReserveMeshBlockPhysIDs();
+  CreateMPIComms();
 #endif
 
   // check number of OpenMP threads for mesh
@@ -242,6 +252,10 @@ Mesh::Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
 
   tree.CreateRootGrid();
 
+  // ordering of the MeshBlocks and how it is cut into the segments of the ranks
+  ReadPartitioningOptions(pin);
+  ReadRefinementOptions(pin);
+
   // Load balancing flag and parameters
 #ifdef MPI_PARALLEL
   if (pin->GetOrAddString("loadbalancing", "balancer", "default") == "automatic")
@@ -250,7 +264,28 @@ Mesh::Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
     lb_manual_ = true;
   lb_tolerance_ = pin->GetOrAddReal("loadbalancing", "tolerance", 0.5);
   lb_interval_ = pin->GetOrAddReal("loadbalancing", "interval", 10);
+  lb_fence_timing_ = pin->GetOrAddBoolean("loadbalancing", "fence_timing", false);
+  // the shared memory tier for on-node partners and the neighbor collective for the
+  // others are part of the aggregated exchange
+  const bool shared_memory =
+      pin->GetOrAddBoolean("mesh", "shared_memory_exchange", false);
+  const bool neighbor_collectives =
+      pin->GetOrAddBoolean("mesh", "neighbor_collectives", false);
+  if (pin->GetOrAddBoolean("mesh", "aggregate_messages", false) || shared_memory ||
+      neighbor_collectives)
+    paggcomm =
+        std::make_unique<AggregatedBoundaryComm>(shared_memory, neighbor_collectives);
+  if (pin->GetOrAddBoolean("mesh", "progress_thread", false))
+    StartProgressThread(pin->GetOrAddInteger("mesh", "progress_thread_core", -1));
 #endif
+  ArrayPool<Real>::Instance().Enable(
+      pin->GetOrAddBoolean("mesh", "pool_block_arrays", false),
+      pin->GetOrAddBoolean("mesh", "pool_stage_arrays", true));
+  CellVariable<Real>::SetUVMPrefetch(pin->GetOrAddBoolean("mesh", "uvm_prefetch", true));
+  KernelGraph::Enable(pin->GetOrAddBoolean("mesh", "kernel_graphs", false));
+  numa_first_touch_ = pin->GetOrAddBoolean("mesh", "numa_first_touch", false) &&
+                      std::is_same<DevSpace, Kokkos::DefaultHostExecutionSpace>::value;
+  CreateExecSpaces(pin->GetOrAddInteger("mesh", "num_exec_space_instances", 1));
 
   // SMR / AMR:
   if (adaptive) {
@@ -460,35 +495,38 @@ Mesh::Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
   // create MeshBlock list for this process
   int nbs = nslist[Globals::my_rank];
   int nbe = nbs + nblist[Globals::my_rank] - 1;
-  // create MeshBlock list for this process
+  std::vector<int> gids(nbe - nbs + 1);
+  for (int i = nbs; i <= nbe; i++)
+    gids[i - nbs] = i;
+  std::vector<MeshBlock *> blocks = ConstructMeshBlocks(gids, nbs, loclist, block_size,
+                                                       pin, properties, packages, false);
+  // link the blocks into the list
   for (int i = nbs; i <= nbe; i++) {
-    SetBlockSizeAndBoundaries(loclist[i], block_size, block_bcs);
-    // create a block and add into the link list
     if (i == nbs) {
-      pblock = new MeshBlock(i, i - nbs, loclist[i], block_size, block_bcs, this, pin,
-                             properties, packages, gflag);
+      pblock = blocks[0];
       pfirst = pblock;
     } else {
-      pblock->next = new MeshBlock(i, i - nbs, loclist[i], block_size, block_bcs, this,
-                                   pin, properties, packages, gflag);
+      pblock->next = blocks[i - nbs];
       pblock->next->prev = pblock;
       pblock = pblock->next;
     }
     pblock->pbval->SearchAndSetNeighbors(tree, ranklist, nslist);
   }
   pblock = pfirst;
+  BuildBlockList();
+  CheckMPITagRange(nblist);
+  UpdateCoarseArrays();
 
   ResetLoadBalanceVariables();
 }
 
 //----------------------------------------------------------------------------------------
-// Mesh constructor for restarts. Load the restart file
-#if 0
-Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
+// Mesh constructor for restarts. Rebuilds the mesh from the logical locations stored in
+// the restart file and loads the independent variables of the blocks on this rank.
+Mesh::Mesh(ParameterInput *pin, RestartReader &rr, Properties_t &properties,
            Packages_t &packages, int mesh_test)
     : // public members:
       // aggregate initialization of RegionSize struct:
-      // (will be overwritten by memcpy from restart file, in this case)
       mesh_size{pin->GetReal("mesh", "x1min"),
                 pin->GetReal("mesh", "x2min"),
                 pin->GetReal("mesh", "x3min"),
@@ -514,28 +552,27 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
           (adaptive || pin->GetOrAddString("mesh", "refinement", "none") == "static")
               ? true
               : false),
-      start_time(pin->GetOrAddReal("time", "start_time", 0.0)), time(start_time),
-      tlim(pin->GetReal("time", "tlim")), dt(std::numeric_limits<Real>::max()),
-      dt_hyperbolic(dt), dt_parabolic(dt), dt_user(dt),
-      nlim(pin->GetOrAddInteger("time", "nlim", -1)), ncycle(),
+      subcycling(pin->GetOrAddBoolean("time", "subcycling", false) && multilevel),
+      start_time(pin->GetOrAddReal("time", "start_time", 0.0)),
+      time(rr.GetAttrReal("Time")), tlim(pin->GetReal("time", "tlim")),
+      dt(rr.GetAttrReal("dt")), dt_hyperbolic(dt), dt_parabolic(dt), dt_user(dt),
+      nlim(pin->GetOrAddInteger("time", "nlim", -1)), ncycle(rr.GetAttrInt("NCycle")),
       ncycle_out(pin->GetOrAddInteger("time", "ncycle_out", 1)),
-      dt_diagnostics(pin->GetOrAddInteger("time", "dt_diagnostics", -1)), nbnew(),
-      nbdel(), step_since_lb(), gflag(), pblock(nullptr), properties(properties),
-      packages(packages),
+      dt_diagnostics(pin->GetOrAddInteger("time", "dt_diagnostics", -1)),
+      perf_diagnostics(pin->GetOrAddInteger("time", "perf_diagnostics", -1)), nbnew(),
+      nbdel(), step_since_lb(), gflag(), mesh_generation(), pblock(nullptr),
+      properties(properties), packages(packages),
       // private members:
       next_phys_id_(), num_mesh_threads_(pin->GetOrAddInteger("mesh", "num_threads", 1)),
-      tree(this), use_uniform_meshgen_fn_{true, true, true}, nreal_user_mesh_data_(),
-      nint_user_mesh_data_(), nuser_history_output_(), lb_flag_(true), lb_automatic_(),
+      tree(this), use_uniform_meshgen_fn_{true, true, true}, nuser_history_output_(),
+      lb_flag_(true), lb_automatic_(), lb_fence_timing_(),
       lb_manual_(), MeshGenerator_{UniformMeshGeneratorX1, UniformMeshGeneratorX2,
                                    UniformMeshGeneratorX3},
       BoundaryFunction_{nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}, AMRFlag_{},
-      UserSourceTerm_{}, UserTimeStep_{}, FieldDiffusivity_{} {
+      UserSourceTerm_{}, UserTimeStep_{} {
   std::stringstream msg;
   RegionSize block_size;
-  BoundaryFlag block_bcs[6];
   MeshBlock *pfirst{};
-  IOWrapperSizeT *offset{};
-  IOWrapperSizeT datasize, listsize, headeroffset;
 
   // mesh test
   if (mesh_test > 0) Globals::nranks = mesh_test;
@@ -544,6 +581,7 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
   // reserve phys=0 for former TAG_AMR=8; now hard-coded in Mesh::CreateAMRMPITag()
   next_phys_id_ = 1;
   ReserveMeshBlockPhysIDs();
+  CreateMPIComms();
 #endif
 
   // check the number of OpenMP threads for mesh
@@ -554,54 +592,36 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
     ATHENA_ERROR(msg);
   }
 
-  // get the end of the header
-  headeroffset = resfile.GetPosition();
-  // read the restart file
-  // the file is already open and the pointer is set to after <par_end>
-  IOWrapperSizeT headersize =
-      sizeof(int) * 3 + sizeof(Real) * 2 + sizeof(RegionSize) + sizeof(IOWrapperSizeT);
-  char *headerdata = new char[headersize];
-  if (Globals::my_rank == 0) { // the master process reads the header data
-    if (resfile.Read(headerdata, 1, headersize) != headersize) {
-      msg << "### FATAL ERROR in Mesh constructor" << std::endl
-          << "The restart file is broken." << std::endl;
-      ATHENA_ERROR(msg);
-    }
-  }
-#ifdef MPI_PARALLEL
-  // then broadcast the header data
-  MPI_Bcast(headerdata, headersize, MPI_BYTE, 0, MPI_COMM_WORLD);
-#endif
-  IOWrapperSizeT hdos = 0;
-  std::memcpy(&nbtotal, &(headerdata[hdos]), sizeof(int));
-  hdos += sizeof(int);
-  std::memcpy(&root_level, &(headerdata[hdos]), sizeof(int));
-  hdos += sizeof(int);
+  // read the mesh metadata
+  nbtotal = rr.GetAttrInt("NumMeshBlocks");
+  root_level = rr.GetAttrInt("RootLevel");
   current_level = root_level;
-  std::memcpy(&mesh_size, &(headerdata[hdos]), sizeof(RegionSize));
-  hdos += sizeof(RegionSize);
-  std::memcpy(&time, &(headerdata[hdos]), sizeof(Real));
-  hdos += sizeof(Real);
-  std::memcpy(&dt, &(headerdata[hdos]), sizeof(Real));
-  hdos += sizeof(Real);
-  std::memcpy(&ncycle, &(headerdata[hdos]), sizeof(int));
-  hdos += sizeof(int);
-  std::memcpy(&datasize, &(headerdata[hdos]), sizeof(IOWrapperSizeT));
-  hdos += sizeof(IOWrapperSizeT); // (this updated value is never used)
-
-  delete[] headerdata;
-
-  // initialize
-  loclist = new LogicalLocation[nbtotal];
-  offset = new IOWrapperSizeT[nbtotal];
-  costlist = new double[nbtotal];
-  ranklist = new int[nbtotal];
-  nslist = new int[Globals::nranks];
-  nblist = new int[Globals::nranks];
 
+  block_size.x1rat = mesh_size.x1rat;
+  block_size.x2rat = mesh_size.x2rat;
+  block_size.x3rat = mesh_size.x3rat;
   block_size.nx1 = pin->GetOrAddInteger("meshblock", "nx1", mesh_size.nx1);
-  block_size.nx2 = pin->GetOrAddInteger("meshblock", "nx2", mesh_size.nx2);
-  block_size.nx3 = pin->GetOrAddInteger("meshblock", "nx3", mesh_size.nx3);
+  if (ndim >= 2)
+    block_size.nx2 = pin->GetOrAddInteger("meshblock", "nx2", mesh_size.nx2);
+  else
+    block_size.nx2 = mesh_size.nx2;
+  if (ndim >= 3)
+    block_size.nx3 = pin->GetOrAddInteger("meshblock", "nx3", mesh_size.nx3);
+  else
+    block_size.nx3 = mesh_size.nx3;
+
+  // check consistency of the restart file and the input parameters
+  auto rst_block_size = rr.GetAttrIntArray("MeshBlockSize");
+  auto rst_mesh_size = rr.GetAttrIntArray("RootGridSize");
+  if (rr.GetAttrInt("NGhost") != NGHOST || rst_block_size[0] != block_size.nx1 ||
+      rst_block_size[1] != block_size.nx2 || rst_block_size[2] != block_size.nx3 ||
+      rst_mesh_size[0] != mesh_size.nx1 || rst_mesh_size[1] != mesh_size.nx2 ||
+      rst_mesh_size[2] != mesh_size.nx3) {
+    msg << "### FATAL ERROR in Mesh constructor" << std::endl
+        << "The restart file is broken or input parameters are inconsistent."
+        << std::endl;
+    ATHENA_ERROR(msg);
+  }
 
   // calculate the number of the blocks
   nrbx1 = mesh_size.nx1 / block_size.nx1;
@@ -622,6 +642,10 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
     MeshGenerator_[X3DIR] = DefaultMeshGeneratorX3;
   }
 
+  // ordering of the MeshBlocks and how it is cut into the segments of the ranks
+  ReadPartitioningOptions(pin);
+  ReadRefinementOptions(pin);
+
   // Load balancing flag and parameters
 #ifdef MPI_PARALLEL
   if (pin->GetOrAddString("loadbalancing", "balancer", "default") == "automatic")
@@ -630,7 +654,28 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
     lb_manual_ = true;
   lb_tolerance_ = pin->GetOrAddReal("loadbalancing", "tolerance", 0.5);
   lb_interval_ = pin->GetOrAddReal("loadbalancing", "interval", 10);
+  lb_fence_timing_ = pin->GetOrAddBoolean("loadbalancing", "fence_timing", false);
+  // the shared memory tier for on-node partners and the neighbor collective for the
+  // others are part of the aggregated exchange
+  const bool shared_memory =
+      pin->GetOrAddBoolean("mesh", "shared_memory_exchange", false);
+  const bool neighbor_collectives =
+      pin->GetOrAddBoolean("mesh", "neighbor_collectives", false);
+  if (pin->GetOrAddBoolean("mesh", "aggregate_messages", false) || shared_memory ||
+      neighbor_collectives)
+    paggcomm =
+        std::make_unique<AggregatedBoundaryComm>(shared_memory, neighbor_collectives);
+  if (pin->GetOrAddBoolean("mesh", "progress_thread", false))
+    StartProgressThread(pin->GetOrAddInteger("mesh", "progress_thread_core", -1));
 #endif
+  ArrayPool<Real>::Instance().Enable(
+      pin->GetOrAddBoolean("mesh", "pool_block_arrays", false),
+      pin->GetOrAddBoolean("mesh", "pool_stage_arrays", true));
+  CellVariable<Real>::SetUVMPrefetch(pin->GetOrAddBoolean("mesh", "uvm_prefetch", true));
+  KernelGraph::Enable(pin->GetOrAddBoolean("mesh", "kernel_graphs", false));
+  numa_first_touch_ = pin->GetOrAddBoolean("mesh", "numa_first_touch", false) &&
+                      std::is_same<DevSpace, Kokkos::DefaultHostExecutionSpace>::value;
+  CreateExecSpaces(pin->GetOrAddInteger("mesh", "num_exec_space_instances", 1));
 
   // SMR / AMR
   if (adaptive) {
@@ -647,69 +692,18 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
 
   InitUserMeshData(pin);
 
-  // read user Mesh data
-  IOWrapperSizeT udsize = 0;
-  for (int n = 0; n < nint_user_mesh_data_; n++)
-    udsize += iuser_mesh_data[n].GetSizeInBytes();
-  for (int n = 0; n < nreal_user_mesh_data_; n++)
-    udsize += ruser_mesh_data[n].GetSizeInBytes();
-  if (udsize != 0) {
-    char *userdata = new char[udsize];
-    if (Globals::my_rank == 0) { // only the master process reads the ID list
-      if (resfile.Read(userdata, 1, udsize) != udsize) {
-        msg << "### FATAL ERROR in Mesh constructor" << std::endl
-            << "The restart file is broken." << std::endl;
-        ATHENA_ERROR(msg);
-      }
-    }
-#ifdef MPI_PARALLEL
-    // then broadcast the ID list
-    MPI_Bcast(userdata, udsize, MPI_BYTE, 0, MPI_COMM_WORLD);
-#endif
-
-    IOWrapperSizeT udoffset = 0;
-    for (int n = 0; n < nint_user_mesh_data_; n++) {
-      std::memcpy(iuser_mesh_data[n].data(), &(userdata[udoffset]),
-                  iuser_mesh_data[n].GetSizeInBytes());
-      udoffset += iuser_mesh_data[n].GetSizeInBytes();
-    }
-    for (int n = 0; n < nreal_user_mesh_data_; n++) {
-      std::memcpy(ruser_mesh_data[n].data(), &(userdata[udoffset]),
-                  ruser_mesh_data[n].GetSizeInBytes());
-      udoffset += ruser_mesh_data[n].GetSizeInBytes();
-    }
-    delete[] userdata;
-  }
-
-  // read the ID list
-  listsize = sizeof(LogicalLocation) + sizeof(Real);
-  // allocate the idlist buffer
-  char *idlist = new char[listsize * nbtotal];
-  if (Globals::my_rank == 0) { // only the master process reads the ID list
-    if (resfile.Read(idlist, listsize, nbtotal) != static_cast<unsigned int>(nbtotal)) {
-      msg << "### FATAL ERROR in Mesh constructor" << std::endl
-          << "The restart file is broken." << std::endl;
-      ATHENA_ERROR(msg);
-    }
-  }
-#ifdef MPI_PARALLEL
-  // then broadcast the ID list
-  MPI_Bcast(idlist, listsize * nbtotal, MPI_BYTE, 0, MPI_COMM_WORLD);
-#endif
-
-  int os = 0;
+  // read the logical locations of all blocks
+  std::vector<std::int64_t> lx123;
+  std::vector<int> level;
+  rr.ReadLocations(lx123, level);
+  loclist = new LogicalLocation[nbtotal];
   for (int i = 0; i < nbtotal; i++) {
-    std::memcpy(&(loclist[i]), &(idlist[os]), sizeof(LogicalLocation));
-    os += sizeof(LogicalLocation);
-    std::memcpy(&(costlist[i]), &(idlist[os]), sizeof(double));
-    os += sizeof(double);
+    loclist[i].lx1 = lx123[3 * i];
+    loclist[i].lx2 = lx123[3 * i + 1];
+    loclist[i].lx3 = lx123[3 * i + 2];
+    loclist[i].level = level[i];
     if (loclist[i].level > current_level) current_level = loclist[i].level;
   }
-  delete[] idlist;
-
-  // calculate the header offset and seek
-  headeroffset += headersize + udsize + listsize * nbtotal;
-  if (Globals::my_rank != 0) resfile.Seek(headeroffset);
 
   // rebuild the Block Tree
   tree.CreateRootGrid();
@@ -736,12 +730,15 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
       std::cout << "### Warning in Mesh constructor" << std::endl
                 << "Too few mesh blocks: nbtotal (" << nbtotal << ") < nranks ("
                 << Globals::nranks << ")" << std::endl;
-      delete[] offset;
       return;
     }
   }
 #endif
 
+  ranklist = new int[nbtotal];
+  nslist = new int[Globals::nranks];
+  nblist = new int[Globals::nranks];
+  costlist = new double[nbtotal];
   if (adaptive) { // allocate arrays for AMR
     nref = new int[Globals::nranks];
     nderef = new int[Globals::nranks];
@@ -753,62 +750,84 @@ Mesh::Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
     bddisp = new int[Globals::nranks];
   }
 
+  // the restart may use a different number of ranks, so the blocks are redistributed
+  // with the simplest cost estimate
+  for (int i = 0; i < nbtotal; i++)
+    costlist[i] = 1.0;
+
   CalculateLoadBalance(costlist, ranklist, nslist, nblist, nbtotal);
 
   // Output MeshBlock list and quit (mesh test only); do not create meshes
   if (mesh_test > 0) {
     if (Globals::my_rank == 0) OutputMeshStructure(ndim);
-    delete[] offset;
     return;
   }
 
-  // allocate data buffer
-  int nb = nblist[Globals::my_rank];
-  int nbs = nslist[Globals::my_rank];
-  int nbe = nbs + nb - 1;
-  char *mbdata = new char[datasize * nb];
-  // load MeshBlocks (parallel)
-  if (resfile.Read_at_all(mbdata, datasize, nb, headeroffset + nbs * datasize) !=
-      static_cast<unsigned int>(nb)) {
-    msg << "### FATAL ERROR in Mesh constructor" << std::endl
-        << "The restart file is broken or input parameters are inconsistent."
-        << std::endl;
-    ATHENA_ERROR(msg);
-  }
-  for (int i = nbs; i <= nbe; i++) {
-    // Match fixed-width integer precision of IOWrapperSizeT datasize
-    std::uint64_t buff_os = datasize * (i - nbs);
-    SetBlockSizeAndBoundaries(loclist[i], block_size, block_bcs);
-    // create a block and add into the link list
+  // create MeshBlock list for this process
+  const int nbs = nslist[Globals::my_rank];
+  const int nb = nblist[Globals::my_rank];
+  std::vector<int> gids(nb);
+  for (int i = nbs; i < nbs + nb; i++)
+    gids[i - nbs] = i;
+  std::vector<MeshBlock *> blocks = ConstructMeshBlocks(gids, nbs, loclist, block_size,
+                                                       pin, properties, packages, false);
+  // link the blocks into the list
+  for (int i = nbs; i < nbs + nb; i++) {
     if (i == nbs) {
-      pblock = new MeshBlock(i, i - nbs, this, pin, properties, packages, loclist[i],
-                             block_size, block_bcs, costlist[i], mbdata + buff_os, gflag);
+      pblock = blocks[0];
       pfirst = pblock;
     } else {
-      pblock->next =
-          new MeshBlock(i, i - nbs, this, pin, properties, packages, loclist[i],
-                        block_size, block_bcs, costlist[i], mbdata + buff_os, gflag);
+      pblock->next = blocks[i - nbs];
       pblock->next->prev = pblock;
       pblock = pblock->next;
     }
     pblock->pbval->SearchAndSetNeighbors(tree, ranklist, nslist);
   }
   pblock = pfirst;
-  delete[] mbdata;
-  // check consistency
-  if (datasize != pblock->GetBlockSizeInBytes()) {
-    msg << "### FATAL ERROR in Mesh constructor" << std::endl
-        << "The restart file is broken or input parameters are inconsistent."
-        << std::endl;
-    ATHENA_ERROR(msg);
+  BuildBlockList();
+  CheckMPITagRange(nblist);
+  UpdateCoarseArrays();
+
+  // load the independent variables of this rank's blocks, one variable at a time
+  ContainerIterator<Real> ci(pblock->real_containers.Get(), {Metadata::Independent});
+  std::vector<Real> tmpData;
+  for (int n = 0; n < static_cast<int>(ci.vars.size()); n++) {
+    const int nv6 = ci.vars[n]->GetDim(6), nv5 = ci.vars[n]->GetDim(5);
+    const int nv4 = ci.vars[n]->GetDim(4);
+    int vlen;
+    rr.ReadBlocks(ci.vars[n]->label(), nbs, nb, tmpData, vlen);
+    if (vlen != nv6 * nv5 * nv4) {
+      msg << "### FATAL ERROR in Mesh constructor" << std::endl
+          << "Variable " << ci.vars[n]->label()
+          << " in the restart file has an inconsistent shape." << std::endl;
+      ATHENA_ERROR(msg);
+    }
+    for (MeshBlock *pmb = pblock; pmb != nullptr; pmb = pmb->next) {
+      ContainerIterator<Real> cib(pmb->real_containers.Get(), {Metadata::Independent});
+      auto &v = cib.vars[n];
+      auto &h = v->GetHostData();
+      std::int64_t index = static_cast<std::int64_t>(pmb->lid) * block_size.nx3 *
+                           block_size.nx2 * block_size.nx1 * vlen;
+      for (int k = pmb->ks; k <= pmb->ke; k++) {
+        for (int j = pmb->js; j <= pmb->je; j++) {
+          for (int i = pmb->is; i <= pmb->ie; i++) {
+            for (int l6 = 0; l6 < nv6; l6++) {
+              for (int l5 = 0; l5 < nv5; l5++) {
+                for (int l4 = 0; l4 < nv4; l4++, index++) {
+                  h(l6, l5, l4, k, j, i) = tmpData[index];
+                }
+              }
+            }
+          }
+        }
+      }
+      v->MarkHostModified();
+      v->SyncToDevice();
+    }
   }
 
   ResetLoadBalanceVariables();
-
-  // clean up
-  delete[] offset;
 }
-#endif
 
 //----------------------------------------------------------------------------------------
 // destructor
@@ -821,6 +840,14 @@ Mesh::~Mesh() {
       delete pblock->next;
     delete pblock;
   }
+#ifdef MPI_PARALLEL
+  for (auto &comm : mpi_comm_)
+    MPI_Comm_free(&comm);
+#endif
+  // the pooled arrays have to go before Kokkos is finalized
+  ArrayPool<Real>::Instance().Clear();
+  for (auto &space : exec_spaces_)
+    SpaceInstance<DevSpace>::destroy(space);
   delete[] nslist;
   delete[] nblist;
   delete[] ranklist;
@@ -841,6 +868,8 @@ Mesh::~Mesh() {
     delete[] user_history_output_names_;
     delete[] user_history_func_;
     delete[] user_history_ops_;
+    delete[] user_history_vars_;
+    delete[] user_history_components_;
   }
 }
 
@@ -998,38 +1027,86 @@ void Mesh::OutputMeshStructure(int ndim) {
 // \brief function that loops over all MeshBlocks and find new timestep
 
 void Mesh::NewTimeStep() {
-  MeshBlock *pmb = pblock;
+  StartNewTimeStep();
+  FinishNewTimeStep();
+}
 
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::StartNewTimeStep()
+// \brief finds the new timestep of this rank and starts its reduction over all ranks,
+// together with everything added to step_reductions during the step.  dt keeps the
+// value of the last step until FinishNewTimeStep() is called.
+
+void Mesh::StartNewTimeStep() {
   // prevent timestep from growing too fast in between 2x cycles (even if every MeshBlock
   // has new_block_dt > 2.0*dt_old)
-  // dt = static_cast<Real>(2.0)*dt;
-  // consider first MeshBlock on this MPI rank's linked list of blocks:
-  // dt = std::min(dt, pmb->new_block_dt_);
-  // dt_hyperbolic = pmb->new_block_dt_hyperbolic_;
-  // dt_parabolic = pmb->new_block_dt_parabolic_;
-  // dt_user = pmb->new_block_dt_user_;
-  // pmb = pmb->next;
-
   Real dt_max = 2.0 * dt;
-  dt = std::numeric_limits<Real>::max();
-  while (pmb != nullptr) {
-    dt = std::min(dt, pmb->new_block_dt_);
+  Real new_dt = std::numeric_limits<Real>::max();
+  // current_level is the same on all ranks, so every rank adds as many entries
+  std::vector<Real> new_dt_level(current_level - root_level + 1,
+                                 std::numeric_limits<Real>::max());
+  for (MeshBlock *pmb : block_list) {
+    // with subcycling, dt is the step of the root level, 2^l times that of level l
+    new_dt = std::min(new_dt, subcycling ? std::ldexp(pmb->new_block_dt_,
+                                                      pmb->loc.level - root_level)
+                                         : pmb->new_block_dt_);
+    Real &level_dt = new_dt_level[pmb->loc.level - root_level];
+    level_dt = std::min(level_dt, pmb->new_block_dt_);
     // dt_hyperbolic  = std::min(dt_hyperbolic, pmb->new_block_dt_hyperbolic_);
     // dt_parabolic  = std::min(dt_parabolic, pmb->new_block_dt_parabolic_);
     // dt_user  = std::min(dt_user, pmb->new_block_dt_user_);
-    pmb = pmb->next;
   }
-  dt = std::min(dt_max, dt);
+  new_dt = std::min(dt_max, new_dt);
+
+  // the four time steps and then the level time steps are consecutive entries
+  dt_reduction_ = step_reductions.Add(new_dt, ReductionOp::min);
+  step_reductions.Add(dt_hyperbolic, ReductionOp::min);
+  step_reductions.Add(dt_parabolic, ReductionOp::min);
+  step_reductions.Add(dt_user, ReductionOp::min);
+  for (const Real level_dt : new_dt_level) {
+    step_reductions.Add(level_dt, ReductionOp::min);
+  }
+  // the memory use for the next cycle diagnostics, in the order of memory_
+  if (perf_diagnostics != -1 && ncycle_out != 0 && ncycle % ncycle_out == 0) {
+    const std::size_t host = MemoryUsage::HostCurrent();
+    const std::size_t device = MemoryUsage::DeviceCurrent();
+    device_memory_peak_ = std::max(device_memory_peak_, device);
+    memory_reduction_ = step_reductions.Add(host, ReductionOp::sum);
+    step_reductions.Add(host, ReductionOp::max);
+    step_reductions.Add(MemoryUsage::HostPeak(), ReductionOp::max);
+    step_reductions.Add(device, ReductionOp::sum);
+    step_reductions.Add(device, ReductionOp::max);
+    step_reductions.Add(device_memory_peak_, ReductionOp::max);
+    const std::size_t pooled = ArrayPool<Real>::Instance().HeldBytes();
+    step_reductions.Add(pooled, ReductionOp::sum);
+    step_reductions.Add(pooled, ReductionOp::max);
+  }
+  step_reductions.Start();
+}
 
-#ifdef MPI_PARALLEL
-  // pack array, MPI allreduce over array, then unpack into Mesh variables
-  Real dt_array[4] = {dt, dt_hyperbolic, dt_parabolic, dt_user};
-  MPI_Allreduce(MPI_IN_PLACE, dt_array, 4, MPI_ATHENA_REAL, MPI_MIN, MPI_COMM_WORLD);
-  dt = dt_array[0];
-  dt_hyperbolic = dt_array[1];
-  dt_parabolic = dt_array[2];
-  dt_user = dt_array[3];
-#endif
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::FinishNewTimeStep()
+// \brief completes the reduction started in StartNewTimeStep() and sets the new timestep.
+// Does nothing if no reduction is pending, so it is safe to call before any use of dt.
+
+void Mesh::FinishNewTimeStep() {
+  if (dt_reduction_ < 0) return;
+  step_reductions.Wait();
+  dt = step_reductions.Get(dt_reduction_);
+  dt_hyperbolic = step_reductions.Get(dt_reduction_ + 1);
+  dt_parabolic = step_reductions.Get(dt_reduction_ + 2);
+  dt_user = step_reductions.Get(dt_reduction_ + 3);
+  dt_level.resize(current_level - root_level + 1);
+  for (int l = 0; l < static_cast<int>(dt_level.size()); l++) {
+    dt_level[l] = step_reductions.Get(dt_reduction_ + 4 + l);
+  }
+  dt_reduction_ = -1;
+  if (memory_reduction_ >= 0) {
+    for (int n = 0; n < 8; n++) {
+      memory_[n] = step_reductions.Get(memory_reduction_ + n);
+    }
+    memory_reduction_ = -1;
+  }
 
   if (time < tlim && (tlim - time) < dt) // timestep would take us past desired endpoint
     dt = tlim - time;
@@ -1042,7 +1119,8 @@ void Mesh::NewTimeStep() {
 //  \brief Enroll a user-defined boundary function
 
 void Mesh::EnrollUserBoundaryFunction(BoundaryFace dir, BValFunc my_bc) {
-  throw std::runtime_error("Mesh::EnrollUserBoundaryFunction is not implemented");
+  throw std::runtime_error("Mesh::EnrollUserBoundaryFunction is not implemented, use "
+                           "Mesh::EnrollBoundaryCondition with a device functor");
 }
 
 // DEPRECATED(felker): provide trivial overloads for old-style BoundaryFace enum argument
@@ -1051,6 +1129,29 @@ void Mesh::EnrollUserBoundaryFunction(int dir, BValFunc my_bc) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::EnrollBoundaryCondition(BoundaryFace face,
+//                                        std::shared_ptr<UserBoundaryCondition> bc)
+//  \brief Enroll the boundary condition of a face with <mesh>/ixn_bc or oxn_bc = user
+
+void Mesh::EnrollBoundaryCondition(BoundaryFace face,
+                                   std::shared_ptr<UserBoundaryCondition> bc) {
+  if (face < BoundaryFace::inner_x1 || face > BoundaryFace::outer_x3) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in EnrollBoundaryCondition" << std::endl
+        << "face = " << face << " is out of range" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  if (mesh_bcs[face] != BoundaryFlag::user) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in EnrollBoundaryCondition" << std::endl
+        << "A boundary condition is enrolled for face " << face << ", whose flag is "
+        << GetBoundaryString(mesh_bcs[face]) << " instead of user" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  user_bcs_[face] = bc;
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void Mesh::EnrollUserRefinementCondition(AMRFlagFunc amrflag)
 //  \brief Enroll a user-defined function for checking refinement criteria
@@ -1121,8 +1222,12 @@ void Mesh::AllocateUserHistoryOutput(int n) {
   user_history_output_names_ = new std::string[n];
   user_history_func_ = new HistoryOutputFunc[n];
   user_history_ops_ = new UserHistoryOperation[n];
-  for (int i = 0; i < n; i++)
+  user_history_vars_ = new std::string[n];
+  user_history_components_ = new int[n];
+  for (int i = 0; i < n; i++) {
     user_history_func_[i] = nullptr;
+    user_history_components_[i] = 0;
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -1144,6 +1249,37 @@ void Mesh::EnrollUserHistoryOutput(int i, HistoryOutputFunc my_func, const char
   user_history_ops_[i] = op;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::EnrollUserHistoryOutput(int i, const std::string &var, int component,
+//                                         const char *name, UserHistoryOperation op)
+//  \brief Enroll a history output computed on the device: the volume integral (sum),
+//  minimum or maximum of one component of a cell variable over all MeshBlocks
+
+void Mesh::EnrollUserHistoryOutput(int i, const std::string &var, int component,
+                                   const char *name, UserHistoryOperation op) {
+  EnrollUserHistoryOutput(i, static_cast<HistoryOutputFunc>(nullptr), name, op);
+  user_history_vars_[i] = var;
+  user_history_components_[i] = component;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::EnrollInSituAnalysis(std::shared_ptr<InSituAnalysis> analysis)
+//  \brief Enroll an in-situ analysis plugin, called every analysis->GetInterval() cycles
+
+void Mesh::EnrollInSituAnalysis(std::shared_ptr<InSituAnalysis> analysis) {
+  insitu_analyses_.push_back(analysis);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::ExecuteInSituAnalyses()
+//  \brief Run the enrolled in-situ analyses that are due in the current cycle
+
+void Mesh::ExecuteInSituAnalyses() {
+  for (auto &analysis : insitu_analyses_) {
+    analysis->ExecuteIfDue(this);
+  }
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void Mesh::EnrollUserMetric(MetricFunc my_func)
 //  \brief Enroll a user-defined metric for arbitrary GR coordinates
@@ -1158,10 +1294,8 @@ void Mesh::EnrollUserMetric(MetricFunc my_func) {
 // \brief Apply MeshBlock::UserWorkBeforeOutput
 
 void Mesh::ApplyUserWorkBeforeOutput(ParameterInput *pin) {
-  MeshBlock *pmb = pblock;
-  while (pmb != nullptr) {
+  for (MeshBlock *pmb : block_list) {
     pmb->UserWorkBeforeOutput(pin);
-    pmb = pmb->next;
   }
 }
 
@@ -1175,18 +1309,12 @@ void Mesh::Initialize(int res_flag, ParameterInput *pin) {
 #ifdef OPENMP_PARALLEL
   int nthreads = GetNumMeshThreads();
 #endif
-  int nmb = GetNumMeshBlocksThisRank(Globals::my_rank);
-  std::vector<MeshBlock *> pmb_array(nmb);
+  // follows the regrids of the loop below
+  const std::vector<MeshBlock *> &pmb_array = block_list;
+  int nmb;
 
   do {
-    // initialize a vector of MeshBlock pointers
-    nmb = GetNumMeshBlocksThisRank(Globals::my_rank);
-    if (static_cast<unsigned int>(nmb) != pmb_array.size()) pmb_array.resize(nmb);
-    MeshBlock *pmbl = pblock;
-    for (int i = 0; i < nmb; ++i) {
-      pmb_array[i] = pmbl;
-      pmbl = pmbl->next;
-    }
+    nmb = pmb_array.size();
 
     if (res_flag == 0) {
 #pragma omp parallel for num_threads(nthreads)
@@ -1194,6 +1322,24 @@ void Mesh::Initialize(int res_flag, ParameterInput *pin) {
         MeshBlock *pmb = pmb_array[i];
         pmb->ProblemGenerator(pin);
       }
+      // device initial conditions of the packages, each covering all blocks at once
+      for (auto &pkg : packages) {
+        for (auto &set_initial_condition : pkg.second->InitialConditions) {
+          set_initial_condition(this);
+        }
+      }
+      // cells covered by an HDF5 output of another run take their values from it
+      if (pin->DoesParameterExist("initial_data", "file")) {
+        std::vector<std::string> variables;
+        if (pin->DoesParameterExist("initial_data", "variables")) {
+          std::istringstream list(pin->GetString("initial_data", "variables"));
+          std::string name;
+          while (std::getline(list, name, ',')) {
+            if (!name.empty()) variables.push_back(name);
+          }
+        }
+        ReadInitialData(this, pin->GetString("initial_data", "file"), variables);
+      }
     }
 
     int call = 0;
@@ -1205,6 +1351,8 @@ void Mesh::Initialize(int res_flag, ParameterInput *pin) {
       pmb->pbval->SetupPersistentMPI();
       pmb->real_containers.Get().SetupPersistentMPI();
     }
+    // the neighbor lists may have changed, so the message layouts are rebuilt as well
+    if (paggcomm) paggcomm->Setup(pblock);
     call++; // 1
 
 #pragma omp parallel num_threads(nthreads)
@@ -1257,15 +1405,10 @@ void Mesh::Initialize(int res_flag, ParameterInput *pin) {
         FillDerivedVariables::FillDerived(pmb->real_containers.Get());
       }
 
-      if (!res_flag && adaptive) {
-#pragma omp for
-        for (int i = 0; i < nmb; ++i) {
-          pmb_array[i]->pmr->CheckRefinementCondition();
-        }
-      }
     } // omp parallel
 
     if (!res_flag && adaptive) {
+      Refinement::CheckAllRefinement(this);
       iflag = false;
       int onb = nbtotal;
       LoadBalancingAndAdaptiveMeshRefinement(pin);
@@ -1286,6 +1429,8 @@ void Mesh::Initialize(int res_flag, ParameterInput *pin) {
       }
     }
   } while (!iflag);
+  // a regrid that kept the number of blocks may still have moved them
+  nmb = pmb_array.size();
 
   // calculate the first time step
 #pragma omp parallel for num_threads(nthreads)
@@ -1298,17 +1443,160 @@ void Mesh::Initialize(int res_flag, ParameterInput *pin) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::BuildBlockList()
+//  \brief collects the blocks of the pblock list into block_list, in order of lid
+
+void Mesh::BuildBlockList() {
+  block_list.clear();
+  for (MeshBlock *pmb = pblock; pmb != nullptr; pmb = pmb->next) {
+    block_list.push_back(pmb);
+  }
+  block_list_gid0_ = (pblock != nullptr ? pblock->gid : 0);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::CreateMPIComms()
+//  \brief duplicates MPI_COMM_WORLD for each "phys" id of the boundary and AMR messages
+
+void Mesh::CreateMPIComms() {
+#ifdef MPI_PARALLEL
+  for (auto &comm : mpi_comm_)
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+  void *ub;
+  int flag;
+  MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &ub, &flag);
+  // the standard guarantees at least 32767
+  mpi_tag_ub_ = (flag ? *static_cast<int *>(ub) : 32767);
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::CheckMPITagRange(const int *nlist)
+//  \brief stops if a rank is to hold more blocks (nlist[rank]) than the MPI tags of the
+//  boundary and AMR messages can address
+
+void Mesh::CheckMPITagRange(const int *nlist) {
+#ifdef MPI_PARALLEL
+  const int nmax = *std::max_element(nlist, nlist + Globals::nranks);
+  // the block takes the bits above the 3 offset bits of CreateAMRMPITag and, unless the
+  // boundary messages are aggregated per rank, above the 6 buffer bits of
+  // CreateBvalsMPITag
+  const int shift = (paggcomm == nullptr ? 6 : 3);
+  const int max_blocks = (mpi_tag_ub_ >> shift) + 1;
+  if (nmax > max_blocks) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in Mesh::CheckMPITagRange" << std::endl
+        << "A rank would hold " << nmax << " MeshBlocks, but the MPI tags (MPI_TAG_UB = "
+        << mpi_tag_ub_ << ") address at most " << max_blocks << "." << std::endl;
+    if (paggcomm == nullptr) {
+      msg << "With <mesh>/aggregate_messages = true up to " << (mpi_tag_ub_ >> 3) + 1
+          << " MeshBlocks per rank are possible." << std::endl;
+    }
+    ATHENA_ERROR(msg);
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::LocateBlock(const Real x1, const Real x2, const Real x3, int &gid,
+//                            int &rank)
+//  \brief find the leaf of the tree containing a position by descending the levels
+
+void Mesh::LocateBlock(const Real x1, const Real x2, const Real x3, int &gid,
+                       int &rank) {
+  if (!use_uniform_meshgen_fn_[X1DIR] || !use_uniform_meshgen_fn_[X2DIR] ||
+      !use_uniform_meshgen_fn_[X3DIR]) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in Mesh::LocateBlock" << std::endl
+        << "Positions can only be located on meshes with uniform cell spacing"
+        << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  // the position in units of the root grid blocks
+  const Real r1 = (x1 - mesh_size.x1min) / (mesh_size.x1max - mesh_size.x1min) * nrbx1;
+  const Real r2 = (x2 - mesh_size.x2min) / (mesh_size.x2max - mesh_size.x2min) * nrbx2;
+  const Real r3 = (x3 - mesh_size.x3min) / (mesh_size.x3max - mesh_size.x3min) * nrbx3;
+  for (int level = root_level; level <= max_level; level++) {
+    const std::int64_t n = 1LL << (level - root_level);
+    LogicalLocation loc;
+    loc.level = level;
+    loc.lx1 = std::min(std::max(static_cast<std::int64_t>(r1 * n), std::int64_t(0)),
+                       nrbx1 * n - 1);
+    loc.lx2 = (ndim >= 2) ? std::min(std::max(static_cast<std::int64_t>(r2 * n),
+                                              std::int64_t(0)),
+                                     nrbx2 * n - 1)
+                          : 0;
+    loc.lx3 = (ndim >= 3) ? std::min(std::max(static_cast<std::int64_t>(r3 * n),
+                                              std::int64_t(0)),
+                                     nrbx3 * n - 1)
+                          : 0;
+    MeshBlockTree *bt = tree.FindMeshBlock(loc);
+    if (bt != nullptr && bt->pleaf_ == nullptr) {
+      gid = bt->gid_;
+      rank = ranklist[gid];
+      return;
+    }
+  }
+  gid = rank = -1;
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn MeshBlock* Mesh::FindMeshBlock(int tgid)
 //  \brief return the MeshBlock whose gid is tgid
 
 MeshBlock *Mesh::FindMeshBlock(int tgid) {
-  MeshBlock *pbl = pblock;
-  while (pbl != nullptr) {
-    if (pbl->gid == tgid) break;
-    pbl = pbl->next;
+  // the blocks are still linked but not indexed while the mesh is constructed
+  if (block_list.empty()) {
+    MeshBlock *pbl = pblock;
+    while (pbl != nullptr && pbl->gid != tgid)
+      pbl = pbl->next;
+    return pbl;
+  }
+  // block_list keeps the gids of the old blocks until a regrid has built the new list
+  const int lid = tgid - block_list_gid0_;
+  if (lid < 0 || lid >= static_cast<int>(block_list.size())) return nullptr;
+  return block_list[lid];
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn std::vector<MeshBlock *> Mesh::ConstructMeshBlocks(const std::vector<int> &gids,
+//                 int nbs, const LogicalLocation *locs, const RegionSize &block_size,
+//                 ParameterInput *pin, Properties_t &properties, Packages_t &packages,
+//                 bool ref_flag)
+// \brief Constructs the MeshBlocks with global ids gids (and local ids gids - nbs) at the
+//  logical locations locs[gid], using the mesh threads. block_size provides the number
+//  of cells and ratios of the blocks. The blocks are returned in the order of gids and
+//  are not linked into the block list yet.
+
+std::vector<MeshBlock *>
+Mesh::ConstructMeshBlocks(const std::vector<int> &gids, int nbs,
+                          const LogicalLocation *locs, const RegionSize &block_size,
+                          ParameterInput *pin, Properties_t &properties,
+                          Packages_t &packages, bool ref_flag) {
+  const int n = gids.size();
+  std::vector<MeshBlock *> blocks(n, nullptr);
+  auto construct = [&](const int b) {
+    const int gid = gids[b];
+    RegionSize size = block_size;
+    BoundaryFlag block_bcs[6];
+    SetBlockSizeAndBoundaries(locs[gid], size, block_bcs);
+    blocks[b] = new MeshBlock(gid, gid - nbs, locs[gid], size, block_bcs, this, pin,
+                              properties, packages, gflag, ref_flag);
+  };
+  if (n == 0) return blocks;
+
+  // the first block is built alone, as it does the one-time setup shared by all blocks
+  // (e.g., the buffer ids of BoundaryBase)
+  construct(0);
+#ifdef OPENMP_PARALLEL
+  int nthreads = GetNumMeshThreads();
+#endif
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+  for (int b = 1; b < n; b++) {
+    construct(b);
   }
-  return pbl;
+  return blocks;
 }
 
 //----------------------------------------------------------------------------------------
@@ -1425,6 +1713,160 @@ int Mesh::ReserveTagPhysIDs(int num_phys) {
 
 void Mesh::ReserveMeshBlockPhysIDs() { return; }
 
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::CreateExecSpaces(const int num_instances)
+//  \brief Creates the execution space instances the MeshBlocks are dealt out to, so that
+//  kernels and copies of different blocks may overlap. Everything that depends on the
+//  work of another block, like ghost zones filled on the same rank, waits for a fence of
+//  the sending block's instance before it is signaled. Kernels over whole MeshBlockPacks
+//  run on the default instance, which is not ordered with the others, so they are
+//  bracketed by FenceExecSpaces().
+
+void Mesh::CreateExecSpaces(const int num_instances) {
+  if (num_instances < 1) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in Mesh constructor" << std::endl
+        << "<mesh>/num_exec_space_instances must be at least 1" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  if (num_instances == 1) return;
+  for (int n = 0; n < num_instances; n++)
+    exec_spaces_.push_back(SpaceInstance<DevSpace>::create());
+}
+
+#ifdef MPI_PARALLEL
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::StartProgressThread(const int core)
+//  \brief starts the MPI progress thread of the receive tracker, which calls MPI
+//  concurrently with the threads of the tasks
+
+void Mesh::StartProgressThread(const int core) {
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided != MPI_THREAD_MULTIPLE) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in Mesh constructor" << std::endl
+        << "<mesh>/progress_thread requires MPI_THREAD_MULTIPLE, but MPI provides "
+        << "thread level " << provided << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  recv_tracker.StartProgressThread(core);
+}
+#endif
+
+//----------------------------------------------------------------------------------------
+//! \fn void Mesh::FenceExecSpaces() const
+//  \brief waits for the work of all blocks and of the default instance; does nothing
+//  when the blocks share the default instance
+
+void Mesh::FenceExecSpaces() const {
+  if (exec_spaces_.empty()) return;
+  for (auto &space : exec_spaces_)
+    space.fence();
+  DevSpace().fence();
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::OutputPerformanceDiagnostics()
+// \brief prints the zone-cycles per wall second since the last report, the memory in use
+// on all ranks, and the number of blocks on each level
+
+void Mesh::OutputPerformanceDiagnostics() {
+  const auto now = std::chrono::steady_clock::now();
+  // mbcnt restarts from zero when the driver starts
+  if (perf_started_ && mbcnt > perf_mbcnt_) {
+    const std::chrono::duration<double> elapsed = now - perf_wall_;
+    const Real zcs = static_cast<Real>(mbcnt - perf_mbcnt_) *
+                     GetNumberOfMeshBlockCells() / elapsed.count();
+    std::cout << "\nzone-cycles/wall_second=" << std::setprecision(3) << zcs
+              << " per_rank=" << zcs / Globals::nranks;
+  }
+  perf_started_ = true;
+  perf_wall_ = now;
+  perf_mbcnt_ = mbcnt;
+
+  const Real mib = 1024.0 * 1024.0;
+  std::cout << std::fixed << std::setprecision(1) << "\nhost_memory_MiB total="
+            << memory_[0] / mib << " max_rank=" << memory_[1] / mib
+            << " peak_rank=" << memory_[2] / mib;
+  if (memory_[3] > 0.0) {
+    std::cout << "\ndevice_memory_MiB total=" << memory_[3] / mib
+              << " max_rank=" << memory_[4] / mib << " peak_rank=" << memory_[5] / mib;
+  }
+  auto &pool = ArrayPool<Real>::Instance();
+  if (pool.Enabled() || pool.Enabled(true)) {
+    std::cout << "\npooled_arrays_MiB total=" << memory_[6] / mib
+              << " max_rank=" << memory_[7] / mib;
+  }
+
+  std::vector<int> nblocks(current_level - root_level + 1, 0);
+  for (int n = 0; n < nbtotal; n++) {
+    const int l = loclist[n].level - root_level;
+    if (l >= 0 && l < static_cast<int>(nblocks.size())) nblocks[l]++;
+  }
+  std::cout << "\nnblocks=" << nbtotal;
+  for (int l = 0; l < static_cast<int>(nblocks.size()); l++) {
+    std::cout << " level" << l << "=" << nblocks[l];
+  }
+  std::cout << std::scientific
+            << std::setprecision(std::numeric_limits<Real>::max_digits10 - 1);
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn MemoryUsage::Accounting Mesh::AccountMemory() const
+// \brief the arrays of the blocks of this rank, the buffers of the aggregated messages,
+// and the memory held in the free lists of the array pool
+
+MemoryUsage::Accounting Mesh::AccountMemory() const {
+  MemoryUsage::Accounting acc;
+  for (const MeshBlock *pmb : block_list) {
+    pmb->AccountMemory(acc);
+  }
+  if (paggcomm) paggcomm->AccountMemory(acc);
+  // the pooled arrays are device arrays; the pool stands in for their addresses
+  const auto &pool = ArrayPool<Real>::Instance();
+  using PoolSpace = typename device_view_t<Real>::memory_space;
+  acc.Add("(array pool)", "free lists",
+          MemoryUsage::IsHostSpace<PoolSpace>::value ? MemoryUsage::Space::host
+                                                     : MemoryUsage::Space::device,
+          &pool, pool.HeldBytes());
+  return acc;
+}
+
+//----------------------------------------------------------------------------------------
+// \!fn void Mesh::OutputLevelTimestepDiagnostics()
+// \brief prints the stable time step of each refinement level and the work that
+// subcycling in time by level (each level taking half the step of the next coarser one)
+// needs relative to a global time step, from the block counts of all levels
+
+void Mesh::OutputLevelTimestepDiagnostics() {
+  const int nlevels = dt_level.size();
+  std::vector<std::int64_t> nblocks(nlevels, 0);
+  for (int n = 0; n < nbtotal; n++) {
+    const int l = loclist[n].level - root_level;
+    if (l >= 0 && l < nlevels) nblocks[l]++;
+  }
+  // the coarsest step that keeps every level stable when level l takes dt0 / 2^l
+  Real dt0 = std::numeric_limits<Real>::max();
+  for (int l = 0; l < nlevels; l++) {
+    dt0 = std::min(dt0, std::ldexp(dt_level[l], l));
+  }
+  // block updates per unit time with the global step and with subcycling; with
+  // subcycling on, the finest level takes the step that all would take without
+  const Real dt_global = LevelDt(root_level + nlevels - 1);
+  Real work_global = 0.0, work_subcycled = 0.0;
+  for (int l = 0; l < nlevels; l++) {
+    work_global += nblocks[l] / dt_global;
+    work_subcycled += std::ldexp(static_cast<Real>(nblocks[l]), l) / dt0;
+  }
+  for (int l = 0; l < nlevels; l++) {
+    std::cout << "\ndt_level" << l << "=" << dt_level[l] << " nblocks=" << nblocks[l];
+  }
+  std::cout << "\nsubcycled_work=" << std::setprecision(3)
+            << work_subcycled / work_global
+            << std::setprecision(std::numeric_limits<Real>::max_digits10 - 1);
+}
+
 void Mesh::OutputCycleDiagnostics() {
   const int dt_precision = std::numeric_limits<Real>::max_digits10 - 1;
   const int ratio_precision = 3;
@@ -1448,8 +1890,10 @@ void Mesh::OutputCycleDiagnostics() {
                       << " ratio=" << std::setprecision(ratio_precision) << ratio
                       << std::setprecision(dt_precision);
           }
+          if (dt_level.size() > 1) OutputLevelTimestepDiagnostics();
         } // else (empty): dt_diagnostics = -1 -> provide no additional timestep
           // diagnostics
+        if (perf_diagnostics != -1) OutputPerformanceDiagnostics();
         std::cout << std::endl;
       }
     }
@@ -21,29 +21,43 @@
 //  The Mesh is the overall grid structure, and MeshBlocks are local patches of data
 //  (potentially on different levels) that tile the entire domain.
 
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "athena.hpp"
 #include "bvals/bvals.hpp"
+#include "bvals/bvals_aggregate.hpp"
 #include "bvals/bvals_interfaces.hpp"
+#include "bvals/receive_tracker.hpp"
+#include "bvals/user_boundary_condition.hpp"
 #include "interface/container.hpp"
 #include "interface/container_collection.hpp"
+#include "interface/meshblock_pack.hpp"
 #include "interface/properties_interface.hpp"
 #include "interface/state_descriptor.hpp"
+#include "interface/swarm.hpp"
 #include "interface/update.hpp"
 #include "kokkos_abstraction.hpp"
 #include "mesh/mesh_refinement.hpp"
 #include "mesh/meshblock_tree.hpp"
+#include "outputs/insitu_analysis.hpp"
 #include "outputs/io_wrapper.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
 #include "reconstruct/reconstruction.hpp"
+#include "utils/batched_reduction.hpp"
 #include "utils/interp_table.hpp"
+#include "utils/kernel_graph.hpp"
+#include "utils/memory_usage.hpp"
 
 namespace parthenon {
 
@@ -55,6 +69,7 @@ class MeshBlockTree;
 class BoundaryValues;
 class Coordinates;
 class Reconstruction;
+class RestartReader;
 
 // template class Container<Real>;
 
@@ -96,6 +111,9 @@ class MeshBlock {
 
   // Kokkos execution space for this MeshBlock
   DevSpace exec_space;
+  // kernel sequences of this block recorded by KernelGraph, by name, dropped by the Mesh
+  // whenever it redistributes or refines the blocks and by PurgeNonBase of the containers
+  std::map<std::string, KernelGraph> kernel_graphs;
 
   // data
   Mesh *pmy_mesh; // ptr to Mesh containing this MeshBlock
@@ -110,9 +128,18 @@ class MeshBlock {
   int gid, lid;
   int cis, cie, cjs, cje, cks, cke, cnghost;
   int gflag;
+  // where the independent variables of this block were last written by an incremental
+  // RestartOutput (file number, -1 if never, and row) and their checksum at the time
+  int restart_file = -1, restart_row = 0;
+  std::uint64_t restart_checksum = 0;
+  // the cycle for whose outputs the copy-out task of Outputs::AddOutputTasks copied the
+  // data of this block to the host, -1 if none
+  int output_copy_cycle = -1;
 
   // The User defined containers
   ContainerCollection<Real> real_containers;
+  // the particle swarms of the packages by name, see SwarmBoundaries for their exchange
+  SwarmMap swarms;
 
   Properties_t properties;
   Packages_t packages;
@@ -170,13 +197,83 @@ class MeshBlock {
     parthenon::par_for(name, exec_space, nl, nu, kl, ku, jl, ju, il, iu, function);
   }
 
+  // 1D hierarchical outer loop, see parthenon::par_for_outer
+  template <typename Function>
+  inline void par_for_outer(const std::string &name, const size_t &scratch_size_in_bytes,
+                            const int &scratch_level, const int &kl, const int &ku,
+                            const Function &function) {
+    parthenon::par_for_outer(name, exec_space, scratch_size_in_bytes, scratch_level, kl,
+                             ku, function);
+  }
+
+  // 2D hierarchical outer loop
+  template <typename Function>
+  inline void par_for_outer(const std::string &name, const size_t &scratch_size_in_bytes,
+                            const int &scratch_level, const int &kl, const int &ku,
+                            const int &jl, const int &ju, const Function &function) {
+    parthenon::par_for_outer(name, exec_space, scratch_size_in_bytes, scratch_level, kl,
+                             ku, jl, ju, function);
+  }
+
+  // 3D hierarchical outer loop
+  template <typename Function>
+  inline void par_for_outer(const std::string &name, const size_t &scratch_size_in_bytes,
+                            const int &scratch_level, const int &nl, const int &nu,
+                            const int &kl, const int &ku, const int &jl, const int &ju,
+                            const Function &function) {
+    parthenon::par_for_outer(name, exec_space, scratch_size_in_bytes, scratch_level, nl,
+                             nu, kl, ku, jl, ju, function);
+  }
+
+  // 1D default reduction pattern
+  template <typename Function, typename Reducer>
+  inline void par_reduce(const std::string &name, const int &il, const int &iu,
+                         const Function &function, const Reducer &reducer) {
+    parthenon::par_reduce(name, exec_space, il, iu, function, reducer);
+  }
+
+  // 2D default reduction pattern
+  template <typename Function, typename Reducer>
+  inline void par_reduce(const std::string &name, const int &jl, const int &ju,
+                         const int &il, const int &iu, const Function &function,
+                         const Reducer &reducer) {
+    parthenon::par_reduce(name, exec_space, jl, ju, il, iu, function, reducer);
+  }
+
+  // 3D default reduction pattern
+  template <typename Function, typename Reducer>
+  inline void par_reduce(const std::string &name, const int &kl, const int &ku,
+                         const int &jl, const int &ju, const int &il, const int &iu,
+                         const Function &function, const Reducer &reducer) {
+    parthenon::par_reduce(name, exec_space, kl, ku, jl, ju, il, iu, function, reducer);
+  }
+
+  // 4D default reduction pattern
+  template <typename Function, typename Reducer>
+  inline void par_reduce(const std::string &name, const int &nl, const int &nu,
+                         const int &kl, const int &ku, const int &jl, const int &ju,
+                         const int &il, const int &iu, const Function &function,
+                         const Reducer &reducer) {
+    parthenon::par_reduce(name, exec_space, nl, nu, kl, ku, jl, ju, il, iu, function,
+                          reducer);
+  }
+
+  // bytes of the arrays of the block, as counted by AccountMemory
   std::size_t GetBlockSizeInBytes();
+  // adds the arrays of the variables of the block in all of its containers to acc
+  void AccountMemory(MemoryUsage::Accounting &acc) const;
   int GetNumberOfMeshBlockCells() {
     return block_size.nx1 * block_size.nx2 * block_size.nx3;
   }
   void SearchAndSetNeighbors(MeshBlockTree &tree, int *ranklist, int *nslist);
+  // u_out = wght[0] * u_out + wght[1] * u_in1 + wght[2] * u_in2 over the interior cells
+  // or faces, in a kernel specialized for the zero and unit weights. u_in2 is not read
+  // if wght[2] == 0. The container version covers all independent variables with one
+  // launch per eight variables.
   void WeightedAve(ParArrayND<Real> &u_out, ParArrayND<Real> &u_in1,
                    ParArrayND<Real> &u_in2, const Real wght[3]);
+  void WeightedAve(Container<Real> &c_out, Container<Real> &c_in1,
+                   Container<Real> &c_in2, const Real wght[3]);
   void WeightedAve(FaceField &b_out, FaceField &b_in1, FaceField &b_in2,
                    const Real wght[3]);
 
@@ -192,6 +289,17 @@ class MeshBlock {
   void UserWorkBeforeOutput(ParameterInput *pin); // called in Mesh fn (friend class)
   void UserWorkInLoop();                          // called in TimeIntegratorTaskList
   void SetBlockTimestep(const Real dt) { new_block_dt_ = dt; }
+  Real GetBlockTimestep() const { return new_block_dt_; }
+  // with <loadbalancing>/balancer = automatic, the wall time between these calls is
+  // charged to the cost of the block unless charge is false; the task executor brackets
+  // each pass over the task list of the block with them
+  void StartTimeMeasurement();
+  void StopTimeMeasurement(const bool charge = true);
+  // with <mesh>/numa_first_touch, moves the independent variables of all containers of
+  // the block into a slab allocated, and so first touched, by the calling thread. The
+  // task executor calls it from the home thread of the block; it only does work after
+  // containers were added to the block.
+  void FirstTouchData();
 
  private:
   // data
@@ -211,8 +319,9 @@ class MeshBlock {
   // functions and variables for automatic load balancing based on timing
   double cost_, lb_time_;
   void ResetTimeMeasurement();
-  void StartTimeMeasurement();
-  void StopTimeMeasurement();
+
+  // the containers whose data FirstTouchData() moved
+  std::vector<std::weak_ptr<Container<Real>>> first_touched_;
 };
 
 //----------------------------------------------------------------------------------------
@@ -227,7 +336,9 @@ class Mesh {
   friend class BoundaryBase;
   friend class BoundaryValues;
   friend class Coordinates;
+  friend class FFTPoissonSolver;
   friend class MeshRefinement;
+  friend class MultigridSolver;
 #ifdef HDF5OUTPUT
   friend class ATHDF5Output;
 #endif
@@ -236,62 +347,181 @@ class Mesh {
   // 2x function overloads of ctor: normal and restarted simulation
   Mesh(ParameterInput *pin, Properties_t &properties, Packages_t &packages,
        int test_flag = 0);
-  Mesh(ParameterInput *pin, IOWrapper &resfile, Properties_t &properties,
+  Mesh(ParameterInput *pin, RestartReader &rr, Properties_t &properties,
        Packages_t &packages, int test_flag = 0);
   ~Mesh();
 
   // accessors
   int GetNumMeshBlocksThisRank(int my_rank) { return nblist[my_rank]; }
   int GetNumMeshThreads() const { return num_mesh_threads_; }
-  std::int64_t GetTotalCells() {
-    return static_cast<std::int64_t>(nbtotal) * pblock->block_size.nx1 *
-           pblock->block_size.nx2 * pblock->block_size.nx3;
+  MeshBlockTree &GetTree() { return tree; }
+  // execution space instance of the MeshBlock with local id lid, the instances of
+  // <mesh>/num_exec_space_instances are dealt out round robin
+  DevSpace GetExecSpace(const int lid) const {
+    return exec_spaces_.empty() ? DevSpace() : exec_spaces_[lid % exec_spaces_.size()];
   }
+  // kernels over all blocks run on the default instance and have to wait for, and be
+  // waited for by, the work of the blocks on their own instances
+  void FenceExecSpaces() const;
+  // interior cells of every MeshBlock in each direction, known on ranks without blocks
+  std::array<int, 3> GetBlockCells() const {
+    return {{mesh_size.nx1 / nrbx1, mesh_size.nx2 / nrbx2, mesh_size.nx3 / nrbx3}};
+  }
+  // interior cells of one MeshBlock, as MeshBlock::GetNumberOfMeshBlockCells
+  std::int64_t GetNumberOfMeshBlockCells() const {
+    const std::array<int, 3> nx = GetBlockCells();
+    return static_cast<std::int64_t>(nx[0]) * nx[1] * nx[2];
+  }
+  std::int64_t GetTotalCells() const { return nbtotal * GetNumberOfMeshBlockCells(); }
 
   // data
   RegionSize mesh_size;
   BoundaryFlag mesh_bcs[6];
   const int ndim; // number of dimensions
   const bool adaptive, multilevel;
-  Real start_time, time, tlim, dt, dt_hyperbolic, dt_parabolic, dt_user;
-  int nlim, ncycle, ncycle_out, dt_diagnostics;
+  // with <time>/subcycling, the blocks of each refinement level step with half the dt of
+  // the next coarser level, see MultiStageBlockTaskDriver; dt is the step of the root
+  // level and LevelDt() that of any level
+  const bool subcycling;
+  AccumReal start_time, time, tlim;
+  Real dt, dt_hyperbolic, dt_parabolic, dt_user;
+  // stable time step of the blocks of each refinement level, counted from the root
+  // level, for diagnostics. Without subcycling all levels take the global dt, at most
+  // the smallest of these.
+  std::vector<Real> dt_level;
+  Real LevelDt(const int level) const {
+    return subcycling ? std::ldexp(dt, root_level - level) : dt;
+  }
+  int nlim, ncycle, ncycle_out, dt_diagnostics, perf_diagnostics;
   int nbtotal, nbnew, nbdel;
   std::uint64_t mbcnt;
 
   int step_since_lb;
   int gflag;
+  // incremented whenever the MeshBlocks of this rank are refined or redistributed
+  std::uint64_t mesh_generation;
+  // the boundary flags of the blocks and the vector direction of each packed component
+  // (else -1) of ApplyBoundaryConditionsOnMesh, by container name, kept for as long as
+  // the blocks of the generation they were built for
+  struct BoundaryConditionArrays {
+    std::uint64_t generation;
+    ParArray2D<BoundaryFlag> bflags;
+    ParArray1D<int> vec_dir;
+    bool any[6];
+  };
+  std::map<std::string, BoundaryConditionArrays> bc_arrays;
+  // the packs of PackVariablesOnMesh and PackFluxesOnMesh by container, direction and
+  // variables, with the arrays they point to. The packs hold unmanaged views, so a
+  // stage container can still return its arrays to the ArrayPool, and are rebuilt when
+  // the generation or any of the arrays changes
+  struct CachedPack {
+    std::uint64_t generation;
+    std::vector<const Real *> arrays;
+    MeshBlockPack<Real> pack;
+  };
+  std::map<std::string, CachedPack> pack_cache;
 
   // ptr to first MeshBlock (node) in linked list of blocks belonging to this MPI rank:
   MeshBlock *pblock;
+  // the same blocks by local id (MeshBlock::lid), for loops that index the blocks or
+  // share them out among threads; rebuilt by BuildBlockList() whenever the list changes
+  std::vector<MeshBlock *> block_list;
   Properties_t properties;
   Packages_t packages;
+  // rank-level aggregation of boundary messages, nullptr unless <mesh>/aggregate_messages
+  std::unique_ptr<AggregatedBoundaryComm> paggcomm;
+  // outstanding per-buffer boundary receives of all blocks, completed together
+  ReceiveTracker recv_tracker;
+  // scalars reduced over all ranks at the end of each step, in the same collective as
+  // the new time step; results are available after FinishNewTimeStep()
+  BatchedReduction step_reductions;
 
   // functions
   void Initialize(int res_flag, ParameterInput *pin);
   void SetBlockSizeAndBoundaries(LogicalLocation loc, RegionSize &block_size,
                                  BoundaryFlag *block_bcs);
   void NewTimeStep();
+  void StartNewTimeStep();
+  void FinishNewTimeStep();
   void OutputCycleDiagnostics();
+  void OutputLevelTimestepDiagnostics();
+  void OutputPerformanceDiagnostics();
+  // the arrays of all blocks of this rank, the aggregated messages and the free lists of
+  // the array pool; MemoryUsage::Accounting::Report reduces it over the ranks
+  MemoryUsage::Accounting AccountMemory() const;
   void LoadBalancingAndAdaptiveMeshRefinement(ParameterInput *pin);
   int CreateAMRMPITag(int lid, int ox1, int ox2, int ox3);
   MeshBlock *FindMeshBlock(int tgid);
   void ApplyUserWorkBeforeOutput(ParameterInput *pin);
+  void EnrollInSituAnalysis(std::shared_ptr<InSituAnalysis> analysis);
+  // boundary condition of a face of the domain with <mesh>/ixn_bc or oxn_bc = user,
+  // either a UserBoundaryCondition or a device functor for DeviceBoundaryCondition
+  void EnrollBoundaryCondition(BoundaryFace face,
+                               std::shared_ptr<UserBoundaryCondition> bc);
+  template <typename F, typename = typename std::enable_if<!std::is_convertible<
+                            F, std::shared_ptr<UserBoundaryCondition>>::value>::type>
+  void EnrollBoundaryCondition(BoundaryFace face, const F &f) {
+    EnrollBoundaryCondition(face, std::make_shared<DeviceBoundaryCondition<F>>(f));
+  }
+  // nullptr if none was enrolled
+  const UserBoundaryCondition *GetUserBoundaryCondition(BoundaryFace face) const {
+    return user_bcs_[face].get();
+  }
+  void ExecuteInSituAnalyses();
+  // the gid of the leaf block containing the position (x1, x2, x3) inside the mesh and
+  // the rank owning it; only for meshes with uniform cell spacing
+  void LocateBlock(const Real x1, const Real x2, const Real x3, int &gid, int &rank);
 
   // function for distributing unique "phys" bitfield IDs to BoundaryVariable objects and
   // other categories of MPI communication for generating unique MPI_TAGs
   int ReserveTagPhysIDs(int num_phys);
+#ifdef MPI_PARALLEL
+  // the boundary and AMR messages of each "phys" id travel on their own communicator,
+  // so that their tags (see CreateBvalsMPITag and CreateAMRMPITag) only have to tell
+  // apart the destination block and buffer
+  MPI_Comm GetMPIComm(const int phys) const { return mpi_comm_[phys]; }
+  // the ids of the messages that are not those of a boundary variable
+  static constexpr int amr_phys_id = 0, particle_phys_id = 3, multigrid_phys_id = 4;
+#endif
 
   // defined in either the prob file or default_pgen.cpp in ../pgen/
   void UserWorkAfterLoop(ParameterInput *pin); // called in main loop
   void UserWorkInLoop();                       // called in main after each cycle
   int GetRootLevel() { return root_level; }
   int GetMaxLevel() { return max_level; }
+  // the finest level of the blocks of the mesh
+  int GetCurrentLevel() { return current_level; }
+  // whether blocks a and b are within <mesh>/refine_buffer blocks of the given level of
+  // each other, see UpdateMeshBlockTree
+  bool WithinRefineBuffer(const LogicalLocation &a, const LogicalLocation &b,
+                          const int level) const;
 
  private:
   // data
   int next_phys_id_; // next unused value for encoding final component of MPI tag bitfield
+#ifdef MPI_PARALLEL
+  // AMR transfers (0), variables (1), flux corrections (2), particles (3) and multigrid
+  // ghost cells (4)
+  static constexpr int num_phys_ids_ = 5;
+  MPI_Comm mpi_comm_[num_phys_ids_];
+  int mpi_tag_ub_;
+#endif
+  int dt_reduction_ = -1; // index of dt in step_reductions while the reduction is pending
+  // <time>/perf_diagnostics: the memory use of the ranks is reduced together with dt on
+  // the cycles that are reported (host and then device: total, max, and max peak over
+  // ranks, then the free arrays of the ArrayPool: total and max, in bytes), and the
+  // zone-cycle rate is taken over the interval since the last report
+  int memory_reduction_ = -1;
+  Real memory_[8] = {};
+  std::size_t device_memory_peak_ = 0;
+  std::chrono::steady_clock::time_point perf_wall_;
+  std::uint64_t perf_mbcnt_ = 0;
+  bool perf_started_ = false;
   int root_level, max_level, current_level;
   int num_mesh_threads_;
+  // execution space instances (CUDA streams) shared by the MeshBlocks of this rank;
+  // empty if all of them use the default instance
+  std::vector<DevSpace> exec_spaces_;
   int *nslist, *ranklist, *nblist;
   double *costlist;
   // 8x arrays used exclusively for AMR (not SMR):
@@ -315,26 +545,83 @@ class Mesh {
   int nuser_history_output_;
   std::string *user_history_output_names_;
   UserHistoryOperation *user_history_ops_;
+  // variable and component of the history outputs reduced on the device
+  std::string *user_history_vars_;
+  int *user_history_components_;
+
+  // <loadbalancing>/ordering = hilbert, and how the ordered list is cut into the
+  // segments of the ranks (<loadbalancing>/partition)
+  enum class Partitioner { greedy, prefix_sum, diffusion };
+  bool hilbert_ordering_;
+  Partitioner partition_;
+  double diffusion_tolerance_;
+
+  // buffers of the block migration in RedistributeAndRefineMeshBlocks(), kept between
+  // regrids and grown only when a migration needs more space than any before it
+  BufArray1D<Real> amr_sendbuf_, amr_recvbuf_;
+  // tables of the kernels that pack, unpack, copy, restrict and prolongate all
+  // cell-centered variables of a block at once during the migration
+  BufferCache_t amr_buf_cache_;
+  BufferCache_t::HostMirror amr_buf_cache_h_;
+  CopyCache_t amr_copy_cache_;
+  CopyCache_t::HostMirror amr_copy_cache_h_;
+  RefinementCache_t amr_refine_cache_;
+  RefinementCache_t::HostMirror amr_refine_cache_h_;
+  // blocks move their data into memory first touched by their home thread in the task
+  // executor (host builds with OpenMP only)
+  bool numa_first_touch_ = false;
 
   // variables for load balancing control
   bool lb_flag_, lb_automatic_, lb_manual_;
+  // fence the execution space of a block before its time measurement is stopped, so
+  // that the cost includes the device time of the kernels it launched
+  bool lb_fence_timing_;
   double lb_tolerance_;
   int lb_interval_;
 
+  // the tree is updated every refine_interval_ cycles; blocks less than refine_buffer_
+  // blocks away from one tagged for refinement are refined along and not derefined
+  int refine_interval_, refine_buffer_;
+  // keep the coarse arrays only on blocks with a neighbor on another level
+  bool coarse_on_demand_;
+
+  // gid of block_list[0]; the gids of the blocks of a rank are consecutive
+  int block_list_gid0_;
+
   // functions
   MeshGenFunc MeshGenerator_[3];
   BValFunc BoundaryFunction_[6];
+  std::shared_ptr<UserBoundaryCondition> user_bcs_[6];
   AMRFlagFunc AMRFlag_;
   SrcTermFunc UserSourceTerm_;
   TimeStepFunc UserTimeStep_;
   HistoryOutputFunc *user_history_func_;
+  std::vector<std::shared_ptr<InSituAnalysis>> insitu_analyses_;
   MetricFunc UserMetric_;
 
   void OutputMeshStructure(int dim);
-  void CalculateLoadBalance(double *clist, int *rlist, int *slist, int *nlist, int nb);
+  void ReadPartitioningOptions(ParameterInput *pin);
+  void ReadRefinementOptions(ParameterInput *pin);
+  void UpdateCoarseArrays();
+  void CalculateLoadBalance(double *clist, int *rlist, int *slist, int *nlist, int nb,
+                            const int *rprev = nullptr);
+  void DiffuseLoadBalance(const double *clist, int *rlist, int nb);
   void ResetLoadBalanceVariables();
-
+  std::vector<MeshBlock *> ConstructMeshBlocks(const std::vector<int> &gids, int nbs,
+                                               const LogicalLocation *locs,
+                                               const RegionSize &block_size,
+                                               ParameterInput *pin,
+                                               Properties_t &properties,
+                                               Packages_t &packages, bool ref_flag);
+
+  void BuildBlockList();
+  void CreateMPIComms();
+  void CheckMPITagRange(const int *nlist);
   void ReserveMeshBlockPhysIDs();
+  void CreateExecSpaces(const int num_instances);
+#ifdef MPI_PARALLEL
+  void StartProgressThread(const int core);
+#endif
 
   // Mesh::LoadBalancingAndAdaptiveMeshRefinement() helper functions:
   void UpdateCostList();
@@ -343,18 +630,22 @@ class Mesh {
   void RedistributeAndRefineMeshBlocks(ParameterInput *pin, int ntot);
 
   // Mesh::RedistributeAndRefineMeshBlocks() helper functions:
+  // grow the amr_*_cache_ tables to n entries, once the kernels using them completed
+  void ReserveAMRCaches(const int n);
   // step 6: send
-  void PrepareSendSameLevel(MeshBlock *pb, Real *sendbuf);
-  void PrepareSendCoarseToFineAMR(MeshBlock *pb, Real *sendbuf, LogicalLocation &lloc);
-  void PrepareSendFineToCoarseAMR(MeshBlock *pb, Real *sendbuf);
+  void PrepareSendSameLevel(MeshBlock *pb, BufArray1D<Real> &sendbuf);
+  void PrepareSendCoarseToFineAMR(MeshBlock *pb, BufArray1D<Real> &sendbuf,
+                                  LogicalLocation &lloc);
+  void PrepareSendFineToCoarseAMR(MeshBlock *pb, BufArray1D<Real> &sendbuf);
   // step 7: create new MeshBlock list (same MPI rank but diff level: create new block)
   void FillSameRankFineToCoarseAMR(MeshBlock *pob, MeshBlock *pmb, LogicalLocation &loc);
   void FillSameRankCoarseToFineAMR(MeshBlock *pob, MeshBlock *pmb,
                                    LogicalLocation &newloc);
   // step 8: receive
-  void FinishRecvSameLevel(MeshBlock *pb, Real *recvbuf);
-  void FinishRecvFineToCoarseAMR(MeshBlock *pb, Real *recvbuf, LogicalLocation &lloc);
-  void FinishRecvCoarseToFineAMR(MeshBlock *pb, Real *recvbuf);
+  void FinishRecvSameLevel(MeshBlock *pb, BufArray1D<Real> &recvbuf);
+  void FinishRecvFineToCoarseAMR(MeshBlock *pb, BufArray1D<Real> &recvbuf,
+                                 LogicalLocation &lloc);
+  void FinishRecvCoarseToFineAMR(MeshBlock *pb, BufArray1D<Real> &recvbuf);
 
   // defined in either the prob file or default_pgen.cpp in ../pgen/
   void InitUserMeshData(ParameterInput *pin);
@@ -371,6 +662,9 @@ class Mesh {
   void AllocateUserHistoryOutput(int n);
   void EnrollUserHistoryOutput(int i, HistoryOutputFunc my_func, const char *name,
                                UserHistoryOperation op = UserHistoryOperation::sum);
+  void EnrollUserHistoryOutput(int i, const std::string &var, int component,
+                               const char *name,
+                               UserHistoryOperation op = UserHistoryOperation::sum);
   void EnrollUserMetric(MetricFunc my_func);
 };
 
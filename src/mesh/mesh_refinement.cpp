@@ -20,32 +20,330 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "athena.hpp"
 #include "coordinates/coordinates.hpp"
 #include "globals.hpp"
+#include "interface/container_iterator.hpp"
 #include "mesh/mesh.hpp"
 #include "mesh/mesh_refinement.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
 #include "refinement/refinement.hpp"
+#include "utils/array_pool.hpp"
 
 namespace parthenon {
 
+namespace {
+
+// Geometry of the restriction and prolongation kernels.  The uniform versions hold the
+// single value that every cell shares, so the kernels read no coordinate arrays at all.
+
+// volume of fine cell (k,j,i)
+struct FineVolumes {
+  ParArray1D<Real> dx1, dx2, dx3;
+  KOKKOS_INLINE_FUNCTION Real operator()(const int k, const int j, const int i) const {
+    return dx1(i) * dx2(j) * dx3(k);
+  }
+};
+struct UniformVolumes {
+  Real vol;
+  KOKKOS_INLINE_FUNCTION Real operator()(const int k, const int j, const int i) const {
+    return vol;
+  }
+};
+
+// distances from the center of coarse cell c in direction d to its neighbors (m = 0, 1)
+// and to the centers of the two fine cells it covers (m = 2, 3)
+struct GeometricWeights {
+  ParArray2D<Real> w1, w2, w3;
+  KOKKOS_INLINE_FUNCTION Real operator()(const int d, const int m, const int c) const {
+    return (d == X1DIR) ? w1(m, c) : ((d == X2DIR) ? w2(m, c) : w3(m, c));
+  }
+};
+
+struct UniformWeights {
+  Real dxc[3], dxf[3]; // coarse cell width and half the fine cell width
+  KOKKOS_INLINE_FUNCTION Real operator()(const int d, const int m, const int c) const {
+    return (m < 2) ? dxc[d] : dxf[d];
+  }
+};
+
+// minmod limited gradient from the differences to the left and right neighbors
+KOKKOS_INLINE_FUNCTION Real MinmodGradient(const Real dql, const Real dqr, const Real dxl,
+                                           const Real dxr) {
+  const Real gl = dql / dxl;
+  const Real gr = dqr / dxr;
+  return 0.5 * (SIGN(gl) + SIGN(gr)) * std::min(std::abs(gl), std::abs(gr));
+}
+
+// volume weighted average of the 2^NDIM fine cells starting at (k, j, i), which are
+// covered by coarse cell (ck, cj, ci)
+template <int NDIM, typename Volumes, typename Fine, typename Coarse>
+KOKKOS_INLINE_FUNCTION void RestrictCell(const Volumes &fvol, const Fine &fine,
+                                         const Coarse &coarse, const int n, const int ck,
+                                         const int cj, const int ci, const int k,
+                                         const int j, const int i) {
+  if (NDIM == 3) {
+    const Real v000 = fvol(k, j, i), v001 = fvol(k, j, i + 1);
+    const Real v010 = fvol(k, j + 1, i), v011 = fvol(k, j + 1, i + 1);
+    const Real v100 = fvol(k + 1, j, i), v101 = fvol(k + 1, j, i + 1);
+    const Real v110 = fvol(k + 1, j + 1, i), v111 = fvol(k + 1, j + 1, i + 1);
+    // KGF: add the off-centered quantities first to preserve FP symmetry
+    const Real tvol = ((v000 + v010) + (v001 + v011)) + ((v100 + v110) + (v101 + v111));
+    // KGF: add the off-centered quantities first to preserve FP symmetry
+    coarse(n, ck, cj, ci) =
+        (((fine(n, k, j, i) * v000 + fine(n, k, j + 1, i) * v010) +
+          (fine(n, k, j, i + 1) * v001 + fine(n, k, j + 1, i + 1) * v011)) +
+         ((fine(n, k + 1, j, i) * v100 + fine(n, k + 1, j + 1, i) * v110) +
+          (fine(n, k + 1, j, i + 1) * v101 + fine(n, k + 1, j + 1, i + 1) * v111))) /
+        tvol;
+  } else if (NDIM == 2) {
+    const Real v00 = fvol(k, j, i), v01 = fvol(k, j, i + 1);
+    const Real v10 = fvol(k, j + 1, i), v11 = fvol(k, j + 1, i + 1);
+    // KGF: add the off-centered quantities first to preserve FP symmetry
+    const Real tvol = (v00 + v10) + (v01 + v11);
+    // KGF: add the off-centered quantities first to preserve FP symmetry
+    coarse(n, ck, cj, ci) =
+        ((fine(n, k, j, i) * v00 + fine(n, k, j + 1, i) * v10) +
+         (fine(n, k, j, i + 1) * v01 + fine(n, k, j + 1, i + 1) * v11)) /
+        tvol;
+  } else {
+    const Real v0 = fvol(k, j, i), v1 = fvol(k, j, i + 1);
+    const Real tvol = v0 + v1;
+    coarse(n, ck, cj, ci) = (fine(n, k, j, i) * v0 + fine(n, k, j, i + 1) * v1) / tvol;
+  }
+}
+
+// limited linear interpolation of coarse cell (k, j, i) onto the 2^NDIM fine cells
+// starting at (fk, fj, fi)
+template <int NDIM, typename Weights, typename Coarse, typename Fine>
+KOKKOS_INLINE_FUNCTION void ProlongateCell(const Weights &w, const Coarse &coarse,
+                                           const Fine &fine, const int n, const int k,
+                                           const int j, const int i, const int fk,
+                                           const int fj, const int fi) {
+  const Real ccval = coarse(n, k, j, i);
+  const Real dx1fm = w(X1DIR, 2, i), dx1fp = w(X1DIR, 3, i);
+  // calculate the gradients using the minmod limiter
+  const Real gx1c = MinmodGradient(ccval - coarse(n, k, j, i - 1),
+                                   coarse(n, k, j, i + 1) - ccval, w(X1DIR, 0, i),
+                                   w(X1DIR, 1, i));
+  if (NDIM == 1) {
+    // interpolate on to the finer grid
+    fine(n, fk, fj, fi) = ccval - gx1c * dx1fm;
+    fine(n, fk, fj, fi + 1) = ccval + gx1c * dx1fp;
+    return;
+  }
+  const Real dx2fm = w(X2DIR, 2, j), dx2fp = w(X2DIR, 3, j);
+  const Real gx2c = MinmodGradient(ccval - coarse(n, k, j - 1, i),
+                                   coarse(n, k, j + 1, i) - ccval, w(X2DIR, 0, j),
+                                   w(X2DIR, 1, j));
+  if (NDIM == 2) {
+    // KGF: add the off-centered quantities first to preserve FP symmetry
+    // interpolate onto the finer grid
+    fine(n, fk, fj, fi) = ccval - (gx1c * dx1fm + gx2c * dx2fm);
+    fine(n, fk, fj, fi + 1) = ccval + (gx1c * dx1fp - gx2c * dx2fm);
+    fine(n, fk, fj + 1, fi) = ccval - (gx1c * dx1fm - gx2c * dx2fp);
+    fine(n, fk, fj + 1, fi + 1) = ccval + (gx1c * dx1fp + gx2c * dx2fp);
+    return;
+  }
+  const Real dx3fm = w(X3DIR, 2, k), dx3fp = w(X3DIR, 3, k);
+  const Real gx3c = MinmodGradient(ccval - coarse(n, k - 1, j, i),
+                                   coarse(n, k + 1, j, i) - ccval, w(X3DIR, 0, k),
+                                   w(X3DIR, 1, k));
+
+  // KGF: add the off-centered quantities first to preserve FP symmetry
+  // interpolate onto the finer grid
+  fine(n, fk, fj, fi) = ccval - (gx1c * dx1fm + gx2c * dx2fm + gx3c * dx3fm);
+  fine(n, fk, fj, fi + 1) = ccval + (gx1c * dx1fp - gx2c * dx2fm - gx3c * dx3fm);
+  fine(n, fk, fj + 1, fi) = ccval - (gx1c * dx1fm - gx2c * dx2fp + gx3c * dx3fm);
+  fine(n, fk, fj + 1, fi + 1) = ccval + (gx1c * dx1fp + gx2c * dx2fp - gx3c * dx3fm);
+  fine(n, fk + 1, fj, fi) = ccval - (gx1c * dx1fm + gx2c * dx2fm - gx3c * dx3fp);
+  fine(n, fk + 1, fj, fi + 1) = ccval + (gx1c * dx1fp - gx2c * dx2fm + gx3c * dx3fp);
+  fine(n, fk + 1, fj + 1, fi) = ccval - (gx1c * dx1fm - gx2c * dx2fp - gx3c * dx3fp);
+  fine(n, fk + 1, fj + 1, fi + 1) = ccval + (gx1c * dx1fp + gx2c * dx2fp + gx3c * dx3fp);
+}
+
+template <typename Volumes>
+void RestrictCellCentered(MeshBlock *pmb, const Volumes fvol,
+                          const ParArray4D<Real> &fine, ParArray4D<Real> coarse,
+                          const int sn, const int en, const int csi, const int cei,
+                          const int csj, const int cej, const int csk, const int cek) {
+  const int cis = pmb->cis, cjs = pmb->cjs, cks = pmb->cks;
+  const int is = pmb->is, js = pmb->js, ks = pmb->ks;
+  // store the restricted data in the prolongation buffer for later use
+  if (pmb->block_size.nx3 > 1) { // 3D
+    pmb->par_for(
+        "RestrictCellCenteredValues3D", sn, en, csk, cek, csj, cej, csi, cei,
+        KOKKOS_LAMBDA(const int n, const int ck, const int cj, const int ci) {
+          const int k = (ck - cks) * 2 + ks;
+          const int j = (cj - cjs) * 2 + js;
+          const int i = (ci - cis) * 2 + is;
+          RestrictCell<3>(fvol, fine, coarse, n, ck, cj, ci, k, j, i);
+        });
+  } else if (pmb->block_size.nx2 > 1) { // 2D
+    pmb->par_for(
+        "RestrictCellCenteredValues2D", sn, en, csj, cej, csi, cei,
+        KOKKOS_LAMBDA(const int n, const int cj, const int ci) {
+          const int j = (cj - cjs) * 2 + js;
+          const int i = (ci - cis) * 2 + is;
+          RestrictCell<2>(fvol, fine, coarse, n, cks, cj, ci, ks, j, i);
+        });
+  } else { // 1D
+    pmb->par_for(
+        "RestrictCellCenteredValues1D", sn, en, csi, cei,
+        KOKKOS_LAMBDA(const int n, const int ci) {
+          const int i = (ci - cis) * 2 + is;
+          RestrictCell<1>(fvol, fine, coarse, n, cks, cjs, ci, ks, js, i);
+        });
+  }
+}
+
+template <typename Weights>
+void ProlongateCellCentered(MeshBlock *pmb, const Weights w,
+                            const ParArray4D<Real> &coarse, ParArray4D<Real> fine,
+                            const int sn, const int en, const int si, const int ei,
+                            const int sj, const int ej, const int sk, const int ek) {
+  const int cis = pmb->cis, cjs = pmb->cjs, cks = pmb->cks;
+  const int is = pmb->is, js = pmb->js, ks = pmb->ks;
+  if (pmb->block_size.nx3 > 1) {
+    pmb->par_for(
+        "ProlongateCellCenteredValues3D", sn, en, sk, ek, sj, ej, si, ei,
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          const int fk = (k - cks) * 2 + ks;
+          const int fj = (j - cjs) * 2 + js;
+          const int fi = (i - cis) * 2 + is;
+          ProlongateCell<3>(w, coarse, fine, n, k, j, i, fk, fj, fi);
+        });
+  } else if (pmb->block_size.nx2 > 1) {
+    pmb->par_for(
+        "ProlongateCellCenteredValues2D", sn, en, sj, ej, si, ei,
+        KOKKOS_LAMBDA(const int n, const int j, const int i) {
+          const int fj = (j - cjs) * 2 + js;
+          const int fi = (i - cis) * 2 + is;
+          ProlongateCell<2>(w, coarse, fine, n, cks, j, i, ks, fj, fi);
+        });
+  } else { // 1D
+    pmb->par_for(
+        "ProlongateCellCenteredValues1D", sn, en, si, ei,
+        KOKKOS_LAMBDA(const int n, const int i) {
+          const int fi = (i - cis) * 2 + is;
+          ProlongateCell<1>(w, coarse, fine, n, cks, cjs, i, ks, js, fi);
+        });
+  }
+}
+
+// Calls f(r, n, k, j, i) for every component n and coarse cell (k, j, i) of the first
+// nregion entries r of the table, with one team per entry.  In fewer than three
+// dimensions the unused coarse indices of every entry are cks and cjs, so the fine
+// indices (k - cks) * 2 + ks etc. computed by f reduce to ks and js.
+template <typename F>
+void ForEachRegionCell(const std::string &name, DevSpace exec_space,
+                       const RefinementCache_t &regions, const int nregion, const F &f) {
+  Kokkos::parallel_for(
+      name, team_policy(exec_space, nregion, Kokkos::AUTO),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const RefinementRegion &r = regions(team_member.league_rank());
+        const int ni = r.ei + 1 - r.si;
+        const int nj = r.ej + 1 - r.sj;
+        const int nk = r.ek + 1 - r.sk;
+        const int nn = r.nu + 1 - r.nl;
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange<>(team_member, nn * nk * nj), [&](const int idx) {
+              const int n = idx / (nk * nj);
+              const int k = (idx - n * nk * nj) / nj;
+              const int j = idx - n * nk * nj - k * nj;
+              Kokkos::parallel_for(
+                  Kokkos::ThreadVectorRange<>(team_member, ni), [&](const int i) {
+                    f(r, n + r.nl, k + r.sk, j + r.sj, i + r.si);
+                  });
+            });
+      });
+}
+
+template <typename Volumes>
+void RestrictRegions(MeshBlock *pmb, const Volumes fvol, const RefinementCache_t &regions,
+                     const int nregion) {
+  const int cis = pmb->cis, cjs = pmb->cjs, cks = pmb->cks;
+  const int is = pmb->is, js = pmb->js, ks = pmb->ks;
+  const char *name = "RestrictCellCenteredRegions";
+  if (pmb->block_size.nx3 > 1) {
+    ForEachRegionCell(
+        name, pmb->exec_space, regions, nregion,
+        KOKKOS_LAMBDA(const RefinementRegion &r, const int n, const int ck,
+                      const int cj, const int ci) {
+          RestrictCell<3>(fvol, r.fine, r.coarse, n, ck, cj, ci, (ck - cks) * 2 + ks,
+                          (cj - cjs) * 2 + js, (ci - cis) * 2 + is);
+        });
+  } else if (pmb->block_size.nx2 > 1) {
+    ForEachRegionCell(
+        name, pmb->exec_space, regions, nregion,
+        KOKKOS_LAMBDA(const RefinementRegion &r, const int n, const int ck,
+                      const int cj, const int ci) {
+          RestrictCell<2>(fvol, r.fine, r.coarse, n, ck, cj, ci, ks, (cj - cjs) * 2 + js,
+                          (ci - cis) * 2 + is);
+        });
+  } else {
+    ForEachRegionCell(
+        name, pmb->exec_space, regions, nregion,
+        KOKKOS_LAMBDA(const RefinementRegion &r, const int n, const int ck,
+                      const int cj, const int ci) {
+          RestrictCell<1>(fvol, r.fine, r.coarse, n, ck, cj, ci, ks, js,
+                          (ci - cis) * 2 + is);
+        });
+  }
+}
+
+template <typename Weights>
+void ProlongateRegions(MeshBlock *pmb, const Weights w, const RefinementCache_t &regions,
+                       const int nregion) {
+  const int cis = pmb->cis, cjs = pmb->cjs, cks = pmb->cks;
+  const int is = pmb->is, js = pmb->js, ks = pmb->ks;
+  const char *name = "ProlongateCellCenteredRegions";
+  if (pmb->block_size.nx3 > 1) {
+    ForEachRegionCell(
+        name, pmb->exec_space, regions, nregion,
+        KOKKOS_LAMBDA(const RefinementRegion &r, const int n, const int k, const int j,
+                      const int i) {
+          ProlongateCell<3>(w, r.coarse, r.fine, n, k, j, i, (k - cks) * 2 + ks,
+                            (j - cjs) * 2 + js, (i - cis) * 2 + is);
+        });
+  } else if (pmb->block_size.nx2 > 1) {
+    ForEachRegionCell(
+        name, pmb->exec_space, regions, nregion,
+        KOKKOS_LAMBDA(const RefinementRegion &r, const int n, const int k, const int j,
+                      const int i) {
+          ProlongateCell<2>(w, r.coarse, r.fine, n, k, j, i, ks, (j - cjs) * 2 + js,
+                            (i - cis) * 2 + is);
+        });
+  } else {
+    ForEachRegionCell(
+        name, pmb->exec_space, regions, nregion,
+        KOKKOS_LAMBDA(const RefinementRegion &r, const int n, const int k, const int j,
+                      const int i) {
+          ProlongateCell<1>(w, r.coarse, r.fine, n, k, j, i, ks, js, (i - cis) * 2 + is);
+        });
+  }
+}
+
+} // namespace
+
 //----------------------------------------------------------------------------------------
 //! \fn MeshRefinement::MeshRefinement(MeshBlock *pmb, ParameterInput *pin)
 //  \brief constructor
 
 MeshRefinement::MeshRefinement(MeshBlock *pmb, ParameterInput *pin)
-    : pmy_block_(pmb), deref_count_(0),
+    : pmy_block_(pmb), refine_flag_(0), deref_count_(0), refine_tagged_(false),
       deref_threshold_(pin->GetOrAddInteger("mesh", "derefine_count", 10)),
       AMRFlag_(pmb->pmy_mesh->AMRFlag_) {
   // Create coarse mesh object for parent grid
-  pcoarsec = new Cartesian(pmb, pin, true);
+  pcoarsec = new CoordinateSystem(pmb, pin, true);
 
   if (NGHOST % 2) {
     std::stringstream msg;
@@ -56,10 +354,6 @@ MeshRefinement::MeshRefinement(MeshBlock *pmb, ParameterInput *pin)
   }
 
   int nc1 = pmb->ncells1;
-  fvol_[0][0] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
-  fvol_[0][1] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
-  fvol_[1][0] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
-  fvol_[1][1] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
   sarea_x1_[0][0] = ParArrayND<Real>(PARARRAY_TEMP, nc1 + 1);
   sarea_x1_[0][1] = ParArrayND<Real>(PARARRAY_TEMP, nc1 + 1);
   sarea_x1_[1][0] = ParArrayND<Real>(PARARRAY_TEMP, nc1 + 1);
@@ -76,6 +370,28 @@ MeshRefinement::MeshRefinement(MeshBlock *pmb, ParameterInput *pin)
   sarea_x3_[1][1] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
   sarea_x3_[2][0] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
   sarea_x3_[2][1] = ParArrayND<Real>(PARARRAY_TEMP, nc1);
+
+  // the geometry does not change over the life of the block, so the coarse/fine
+  // distances used by the prolongation are computed once here
+  const int fs[3] = {pmb->is, pmb->js, pmb->ks};
+  const int cs[3] = {pmb->cis, pmb->cjs, pmb->cks};
+  const int nf[3] = {pmb->ncells1, pmb->ncells2, pmb->ncells3};
+  const int nc[3] = {pmb->ncc1, pmb->ncc2, pmb->ncc3};
+  const ParArrayND<Real> *xc[3] = {&pcoarsec->x1v, &pcoarsec->x2v, &pcoarsec->x3v};
+  const ParArrayND<Real> *xf[3] = {&pmb->pcoord->x1v, &pmb->pcoord->x2v,
+                                   &pmb->pcoord->x3v};
+  for (int d = 0; d < 3; d++) {
+    prolong_wgt_[d] = ParArrayND<Real>("prolongation weights", 4, nc[d]);
+    for (int c = 1; c < nc[d] - 1; c++) {
+      const int f = (c - cs[d]) * 2 + fs[d];
+      if (f < 0 || f + 1 >= nf[d]) continue;
+      const Real x0 = (*xc[d])(c);
+      prolong_wgt_[d](0, c) = x0 - (*xc[d])(c - 1);
+      prolong_wgt_[d](1, c) = (*xc[d])(c + 1) - x0;
+      prolong_wgt_[d](2, c) = x0 - (*xf[d])(f);
+      prolong_wgt_[d](3, c) = (*xf[d])(f + 1) - x0;
+    }
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -96,74 +412,16 @@ void MeshRefinement::RestrictCellCenteredValues(const ParArrayND<Real> &fine,
                                                 int csk, int cek) {
   MeshBlock *pmb = pmy_block_;
   auto &pco = pmb->pcoord;
-  int si = (csi - pmb->cis) * 2 + pmb->is, ei = (cei - pmb->cis) * 2 + pmb->is + 1;
-
-  // store the restricted data in the prolongation buffer for later use
-  if (pmb->block_size.nx3 > 1) { // 3D
-    for (int n = sn; n <= en; ++n) {
-      for (int ck = csk; ck <= cek; ck++) {
-        int k = (ck - pmb->cks) * 2 + pmb->ks;
-        for (int cj = csj; cj <= cej; cj++) {
-          int j = (cj - pmb->cjs) * 2 + pmb->js;
-          pco->CellVolume(k, j, si, ei, fvol_[0][0]);
-          pco->CellVolume(k, j + 1, si, ei, fvol_[0][1]);
-          pco->CellVolume(k + 1, j, si, ei, fvol_[1][0]);
-          pco->CellVolume(k + 1, j + 1, si, ei, fvol_[1][1]);
-          for (int ci = csi; ci <= cei; ci++) {
-            int i = (ci - pmb->cis) * 2 + pmb->is;
-            // KGF: add the off-centered quantities first to preserve FP symmetry
-            Real tvol = ((fvol_[0][0](i) + fvol_[0][1](i)) +
-                         (fvol_[0][0](i + 1) + fvol_[0][1](i + 1))) +
-                        ((fvol_[1][0](i) + fvol_[1][1](i)) +
-                         (fvol_[1][0](i + 1) + fvol_[1][1](i + 1)));
-            // KGF: add the off-centered quantities first to preserve FP symmetry
-            coarse(n, ck, cj, ci) =
-                (((fine(n, k, j, i) * fvol_[0][0](i) +
-                   fine(n, k, j + 1, i) * fvol_[0][1](i)) +
-                  (fine(n, k, j, i + 1) * fvol_[0][0](i + 1) +
-                   fine(n, k, j + 1, i + 1) * fvol_[0][1](i + 1))) +
-                 ((fine(n, k + 1, j, i) * fvol_[1][0](i) +
-                   fine(n, k + 1, j + 1, i) * fvol_[1][1](i)) +
-                  (fine(n, k + 1, j, i + 1) * fvol_[1][0](i + 1) +
-                   fine(n, k + 1, j + 1, i + 1) * fvol_[1][1](i + 1)))) /
-                tvol;
-          }
-        }
-      }
-    }
-  } else if (pmb->block_size.nx2 > 1) { // 2D
-    for (int n = sn; n <= en; ++n) {
-      for (int cj = csj; cj <= cej; cj++) {
-        int j = (cj - pmb->cjs) * 2 + pmb->js;
-        pco->CellVolume(0, j, si, ei, fvol_[0][0]);
-        pco->CellVolume(0, j + 1, si, ei, fvol_[0][1]);
-        for (int ci = csi; ci <= cei; ci++) {
-          int i = (ci - pmb->cis) * 2 + pmb->is;
-          // KGF: add the off-centered quantities first to preserve FP symmetry
-          Real tvol = (fvol_[0][0](i) + fvol_[0][1](i)) +
-                      (fvol_[0][0](i + 1) + fvol_[0][1](i + 1));
-
-          // KGF: add the off-centered quantities first to preserve FP symmetry
-          coarse(n, 0, cj, ci) = ((fine(n, 0, j, i) * fvol_[0][0](i) +
-                                   fine(n, 0, j + 1, i) * fvol_[0][1](i)) +
-                                  (fine(n, 0, j, i + 1) * fvol_[0][0](i + 1) +
-                                   fine(n, 0, j + 1, i + 1) * fvol_[0][1](i + 1))) /
-                                 tvol;
-        }
-      }
-    }
-  } else { // 1D
-    int j = pmb->js, cj = pmb->cjs, k = pmb->ks, ck = pmb->cks;
-    for (int n = sn; n <= en; ++n) {
-      pco->CellVolume(k, j, si, ei, fvol_[0][0]);
-      for (int ci = csi; ci <= cei; ci++) {
-        int i = (ci - pmb->cis) * 2 + pmb->is;
-        Real tvol = fvol_[0][0](i) + fvol_[0][0](i + 1);
-        coarse(n, ck, cj, ci) = (fine(n, k, j, i) * fvol_[0][0](i) +
-                                 fine(n, k, j, i + 1) * fvol_[0][0](i + 1)) /
-                                tvol;
-      }
-    }
+  if (pco->uniform_spacing) {
+    const Real vol = pco->uniform_dx[X1DIR] * pco->uniform_dx[X2DIR] *
+                     pco->uniform_dx[X3DIR];
+    RestrictCellCentered(pmb, UniformVolumes{vol}, fine.Get<4>(), coarse.Get<4>(), sn,
+                         en, csi, cei, csj, cej, csk, cek);
+  } else {
+    RestrictCellCentered(pmb, FineVolumes{pco->dx1f.Get<1>(), pco->dx2f.Get<1>(),
+                                          pco->dx3f.Get<1>()},
+                         fine.Get<4>(), coarse.Get<4>(), sn, en, csi, cei, csj, cej, csk,
+                         cek);
   }
 }
 
@@ -361,153 +619,65 @@ void MeshRefinement::ProlongateCellCenteredValues(const ParArrayND<Real> &coarse
                                                   int ek) {
   MeshBlock *pmb = pmy_block_;
   auto &pco = pmb->pcoord;
-  if (pmb->block_size.nx3 > 1) {
-    for (int n = sn; n <= en; n++) {
-      for (int k = sk; k <= ek; k++) {
-        int fk = (k - pmb->cks) * 2 + pmb->ks;
-        const Real &x3m = pcoarsec->x3v(k - 1);
-        const Real &x3c = pcoarsec->x3v(k);
-        const Real &x3p = pcoarsec->x3v(k + 1);
-        Real dx3m = x3c - x3m;
-        Real dx3p = x3p - x3c;
-        const Real &fx3m = pco->x3v(fk);
-        const Real &fx3p = pco->x3v(fk + 1);
-        Real dx3fm = x3c - fx3m;
-        Real dx3fp = fx3p - x3c;
-        for (int j = sj; j <= ej; j++) {
-          int fj = (j - pmb->cjs) * 2 + pmb->js;
-          const Real &x2m = pcoarsec->x2v(j - 1);
-          const Real &x2c = pcoarsec->x2v(j);
-          const Real &x2p = pcoarsec->x2v(j + 1);
-          Real dx2m = x2c - x2m;
-          Real dx2p = x2p - x2c;
-          const Real &fx2m = pco->x2v(fj);
-          const Real &fx2p = pco->x2v(fj + 1);
-          Real dx2fm = x2c - fx2m;
-          Real dx2fp = fx2p - x2c;
-          for (int i = si; i <= ei; i++) {
-            int fi = (i - pmb->cis) * 2 + pmb->is;
-            const Real &x1m = pcoarsec->x1v(i - 1);
-            const Real &x1c = pcoarsec->x1v(i);
-            const Real &x1p = pcoarsec->x1v(i + 1);
-            Real dx1m = x1c - x1m;
-            Real dx1p = x1p - x1c;
-            const Real &fx1m = pco->x1v(fi);
-            const Real &fx1p = pco->x1v(fi + 1);
-            Real dx1fm = x1c - fx1m;
-            Real dx1fp = fx1p - x1c;
-            Real ccval = coarse(n, k, j, i);
-
-            // calculate 3D gradients using the minmod limiter
-            Real gx1m = (ccval - coarse(n, k, j, i - 1)) / dx1m;
-            Real gx1p = (coarse(n, k, j, i + 1) - ccval) / dx1p;
-            Real gx1c = 0.5 * (SIGN(gx1m) + SIGN(gx1p)) *
-                        std::min(std::abs(gx1m), std::abs(gx1p));
-            Real gx2m = (ccval - coarse(n, k, j - 1, i)) / dx2m;
-            Real gx2p = (coarse(n, k, j + 1, i) - ccval) / dx2p;
-            Real gx2c = 0.5 * (SIGN(gx2m) + SIGN(gx2p)) *
-                        std::min(std::abs(gx2m), std::abs(gx2p));
-            Real gx3m = (ccval - coarse(n, k - 1, j, i)) / dx3m;
-            Real gx3p = (coarse(n, k + 1, j, i) - ccval) / dx3p;
-            Real gx3c = 0.5 * (SIGN(gx3m) + SIGN(gx3p)) *
-                        std::min(std::abs(gx3m), std::abs(gx3p));
-
-            // KGF: add the off-centered quantities first to preserve FP symmetry
-            // interpolate onto the finer grid
-            fine(n, fk, fj, fi) = ccval - (gx1c * dx1fm + gx2c * dx2fm + gx3c * dx3fm);
-            fine(n, fk, fj, fi + 1) =
-                ccval + (gx1c * dx1fp - gx2c * dx2fm - gx3c * dx3fm);
-            fine(n, fk, fj + 1, fi) =
-                ccval - (gx1c * dx1fm - gx2c * dx2fp + gx3c * dx3fm);
-            fine(n, fk, fj + 1, fi + 1) =
-                ccval + (gx1c * dx1fp + gx2c * dx2fp - gx3c * dx3fm);
-            fine(n, fk + 1, fj, fi) =
-                ccval - (gx1c * dx1fm + gx2c * dx2fm - gx3c * dx3fp);
-            fine(n, fk + 1, fj, fi + 1) =
-                ccval + (gx1c * dx1fp - gx2c * dx2fm + gx3c * dx3fp);
-            fine(n, fk + 1, fj + 1, fi) =
-                ccval - (gx1c * dx1fm - gx2c * dx2fp - gx3c * dx3fp);
-            fine(n, fk + 1, fj + 1, fi + 1) =
-                ccval + (gx1c * dx1fp + gx2c * dx2fp + gx3c * dx3fp);
-          }
-        }
-      }
+  if (pco->uniform_spacing) {
+    UniformWeights w;
+    for (int d = 0; d < 3; d++) {
+      w.dxc[d] = pcoarsec->uniform_dx[d];
+      w.dxf[d] = 0.5 * pco->uniform_dx[d];
     }
-  } else if (pmb->block_size.nx2 > 1) {
-    int k = pmb->cks, fk = pmb->ks;
-    for (int n = sn; n <= en; n++) {
-      for (int j = sj; j <= ej; j++) {
-        int fj = (j - pmb->cjs) * 2 + pmb->js;
-        const Real &x2m = pcoarsec->x2v(j - 1);
-        const Real &x2c = pcoarsec->x2v(j);
-        const Real &x2p = pcoarsec->x2v(j + 1);
-        Real dx2m = x2c - x2m;
-        Real dx2p = x2p - x2c;
-        const Real &fx2m = pco->x2v(fj);
-        const Real &fx2p = pco->x2v(fj + 1);
-        Real dx2fm = x2c - fx2m;
-        Real dx2fp = fx2p - x2c;
-        for (int i = si; i <= ei; i++) {
-          int fi = (i - pmb->cis) * 2 + pmb->is;
-          const Real &x1m = pcoarsec->x1v(i - 1);
-          const Real &x1c = pcoarsec->x1v(i);
-          const Real &x1p = pcoarsec->x1v(i + 1);
-          Real dx1m = x1c - x1m;
-          Real dx1p = x1p - x1c;
-          const Real &fx1m = pco->x1v(fi);
-          const Real &fx1p = pco->x1v(fi + 1);
-          Real dx1fm = x1c - fx1m;
-          Real dx1fp = fx1p - x1c;
-          Real ccval = coarse(n, k, j, i);
-
-          // calculate 2D gradients using the minmod limiter
-          Real gx1m = (ccval - coarse(n, k, j, i - 1)) / dx1m;
-          Real gx1p = (coarse(n, k, j, i + 1) - ccval) / dx1p;
-          Real gx1c =
-              0.5 * (SIGN(gx1m) + SIGN(gx1p)) * std::min(std::abs(gx1m), std::abs(gx1p));
-          Real gx2m = (ccval - coarse(n, k, j - 1, i)) / dx2m;
-          Real gx2p = (coarse(n, k, j + 1, i) - ccval) / dx2p;
-          Real gx2c =
-              0.5 * (SIGN(gx2m) + SIGN(gx2p)) * std::min(std::abs(gx2m), std::abs(gx2p));
+    ProlongateCellCentered(pmb, w, coarse.Get<4>(), fine.Get<4>(), sn, en, si, ei, sj,
+                           ej, sk, ek);
+  } else {
+    const GeometricWeights w{prolong_wgt_[X1DIR].Get<2>(), prolong_wgt_[X2DIR].Get<2>(),
+                             prolong_wgt_[X3DIR].Get<2>()};
+    ProlongateCellCentered(pmb, w, coarse.Get<4>(), fine.Get<4>(), sn, en, si, ei, sj,
+                           ej, sk, ek);
+  }
+}
 
-          // KGF: add the off-centered quantities first to preserve FP symmetry
-          // interpolate onto the finer grid
-          fine(n, fk, fj, fi) = ccval - (gx1c * dx1fm + gx2c * dx2fm);
-          fine(n, fk, fj, fi + 1) = ccval + (gx1c * dx1fp - gx2c * dx2fm);
-          fine(n, fk, fj + 1, fi) = ccval - (gx1c * dx1fm - gx2c * dx2fp);
-          fine(n, fk, fj + 1, fi + 1) = ccval + (gx1c * dx1fp + gx2c * dx2fp);
-        }
-      }
-    }
-  } else { // 1D
-    int k = pmb->cks, fk = pmb->ks, j = pmb->cjs, fj = pmb->js;
-    for (int n = sn; n <= en; n++) {
-      for (int i = si; i <= ei; i++) {
-        int fi = (i - pmb->cis) * 2 + pmb->is;
-        const Real &x1m = pcoarsec->x1v(i - 1);
-        const Real &x1c = pcoarsec->x1v(i);
-        const Real &x1p = pcoarsec->x1v(i + 1);
-        Real dx1m = x1c - x1m;
-        Real dx1p = x1p - x1c;
-        const Real &fx1m = pco->x1v(fi);
-        const Real &fx1p = pco->x1v(fi + 1);
-        Real dx1fm = x1c - fx1m;
-        Real dx1fp = fx1p - x1c;
-        Real ccval = coarse(n, k, j, i);
+//----------------------------------------------------------------------------------------
+//! \fn void MeshRefinement::RestrictCellCenteredRegions(
+//        const RefinementCache_t &regions, int nregion)
+//  \brief restrict the first nregion entries of the table, which must be on the device
 
-        // calculate 1D gradient using the min-mod limiter
-        Real gx1m = (ccval - coarse(n, k, j, i - 1)) / dx1m;
-        Real gx1p = (coarse(n, k, j, i + 1) - ccval) / dx1p;
-        Real gx1c =
-            0.5 * (SIGN(gx1m) + SIGN(gx1p)) * std::min(std::abs(gx1m), std::abs(gx1p));
+void MeshRefinement::RestrictCellCenteredRegions(const RefinementCache_t &regions,
+                                                 int nregion) {
+  MeshBlock *pmb = pmy_block_;
+  auto &pco = pmb->pcoord;
+  if (nregion == 0) return;
+  if (pco->uniform_spacing) {
+    const Real vol = pco->uniform_dx[X1DIR] * pco->uniform_dx[X2DIR] *
+                     pco->uniform_dx[X3DIR];
+    RestrictRegions(pmb, UniformVolumes{vol}, regions, nregion);
+  } else {
+    RestrictRegions(
+        pmb, FineVolumes{pco->dx1f.Get<1>(), pco->dx2f.Get<1>(), pco->dx3f.Get<1>()},
+        regions, nregion);
+  }
+}
 
-        // interpolate on to the finer grid
-        fine(n, fk, fj, fi) = ccval - gx1c * dx1fm;
-        fine(n, fk, fj, fi + 1) = ccval + gx1c * dx1fp;
-      }
+//----------------------------------------------------------------------------------------
+//! \fn void MeshRefinement::ProlongateCellCenteredRegions(
+//        const RefinementCache_t &regions, int nregion)
+//  \brief prolongate the first nregion entries of the table, which must be on the device
+
+void MeshRefinement::ProlongateCellCenteredRegions(const RefinementCache_t &regions,
+                                                   int nregion) {
+  MeshBlock *pmb = pmy_block_;
+  auto &pco = pmb->pcoord;
+  if (nregion == 0) return;
+  if (pco->uniform_spacing) {
+    UniformWeights w;
+    for (int d = 0; d < 3; d++) {
+      w.dxc[d] = pcoarsec->uniform_dx[d];
+      w.dxf[d] = 0.5 * pco->uniform_dx[d];
     }
+    ProlongateRegions(pmb, w, regions, nregion);
+  } else {
+    const GeometricWeights w{prolong_wgt_[X1DIR].Get<2>(), prolong_wgt_[X2DIR].Get<2>(),
+                             prolong_wgt_[X3DIR].Get<2>()};
+    ProlongateRegions(pmb, w, regions, nregion);
   }
-  return;
 }
 
 //----------------------------------------------------------------------------------------
@@ -996,9 +1166,56 @@ void MeshRefinement::CheckRefinementCondition() {
   SetRefinement(ret);
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn Kokkos::View<MeshRefinement::Extrema, DevSpace>
+//       MeshRefinement::AddFusedExtrema(const std::string &field)
+//  \brief a new slot for the extrema of field over one region, as the result of the
+//  reduction of an update kernel. The view does not own its memory and stays valid
+//  until the slots are cleared.
+
+Kokkos::View<MeshRefinement::Extrema, DevSpace>
+MeshRefinement::AddFusedExtrema(const std::string &field) {
+  const int slot = fused_fields_.size();
+  if (fused_extrema_.extent_int(0) <= slot) {
+    // the kernels that reduce into the old slots finish first, their values are kept
+    Kokkos::fence();
+    Kokkos::resize(fused_extrema_, 2 * slot + 4);
+    fused_extrema_h_ = Kokkos::create_mirror_view(fused_extrema_);
+  }
+  fused_fields_.push_back(field);
+  fused_copied_ = false;
+  return Kokkos::View<Extrema, DevSpace>(fused_extrema_.data() + slot);
+}
+
+bool MeshRefinement::GetFusedExtrema(const std::string &field, Real &qmin, Real &qmax) {
+  if (std::find(fused_fields_.begin(), fused_fields_.end(), field) ==
+      fused_fields_.end())
+    return false;
+  if (!fused_copied_) {
+    Kokkos::deep_copy(fused_extrema_h_, fused_extrema_);
+    fused_copied_ = true;
+  }
+  qmin = std::numeric_limits<Real>::max();
+  qmax = std::numeric_limits<Real>::lowest();
+  for (int slot = 0; slot < fused_fields_.size(); slot++) {
+    if (fused_fields_[slot] != field) continue;
+    qmin = std::min(qmin, fused_extrema_h_(slot).min_val);
+    qmax = std::max(qmax, fused_extrema_h_(slot).max_val);
+  }
+  return true;
+}
+
 void MeshRefinement::SetRefinement(AmrTag flag) {
   MeshBlock *pmb = pmy_block_;
   int aret = std::max(-1, static_cast<int>(flag));
+  // the extrema of the last stage are consumed by this tag
+  fused_fields_.clear();
+  fused_copied_ = false;
+
+  // With <mesh>/refine_interval > 1 the tags of several cycles go into one update of the
+  // tree. A refinement request is kept until then; the block is replaced by the update.
+  if (aret > 0) refine_tagged_ = true;
+  if (refine_flag_ == 1 && aret <= 0) return;
 
   if (aret == 0) refine_flag_ = 0;
 
@@ -1051,6 +1268,84 @@ void MeshRefinement::SetRefinement(AmrTag flag) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn bool MeshRefinement::NeedsCoarseArrays() const
+//  \brief whether a neighbor is on another level, i.e., the ghost zones are restricted
+//  or prolongated through the coarse arrays
+
+bool MeshRefinement::NeedsCoarseArrays() const {
+  const BoundaryValues *pbval = pmy_block_->pbval.get();
+  for (int k = 0; k <= 2; k++) {
+    for (int j = 0; j <= 2; j++) {
+      for (int i = 0; i <= 2; i++) {
+        const int level = pbval->nblevel[k][j][i];
+        if (level >= 0 && level != pmy_block_->loc.level) return true;
+      }
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MeshRefinement::SetCoarseArrays(const bool allocate)
+//  \brief allocate (from the array pool) or release the coarse arrays of the independent
+//  cell-centered variables. The arrays are referred to by the variable in every container
+//  of the block, its boundary variable and pvars_cc_; all of them are updated.
+
+void MeshRefinement::SetCoarseArrays(const bool allocate) {
+  MeshBlock *pmb = pmy_block_;
+  auto &pool = ArrayPool<Real>::Instance();
+  // the same iteration as the registration in the MeshBlock constructor
+  ContainerIterator<Real> ci(pmb->real_containers.Get(), {Metadata::Independent});
+  const int nvars = std::min(static_cast<int>(ci.vars.size()),
+                             static_cast<int>(pvars_cc_.size()));
+  for (int n = 0; n < nvars; n++) {
+    auto &v = ci.vars[n];
+    if (!v->vbvar || (v->coarse_s.GetSize() > 0) == allocate) continue;
+    // the copies of the variable in the stage containers share its coarse array
+    std::vector<CellVariable<Real> *> copies;
+    for (auto &c : pmb->real_containers.GetAll()) {
+      if (c.first == "base") continue;
+      CellVariable<Real> &copy = c.second->Get(v->label());
+      if (copy.vbvar == v->vbvar) copies.push_back(&copy);
+    }
+    ParArrayND<Real> &coarse = std::get<1>(pvars_cc_[n]);
+    if (allocate) {
+      v->coarse_s = pool.Get(
+          v->label() + ".coarse",
+          {{v->GetDim(6), v->GetDim(5), v->GetDim(4), pmb->ncc3, pmb->ncc2, pmb->ncc1}});
+    } else {
+      // the pool only takes the array back from its last holder
+      coarse = ParArrayND<Real>();
+      v->vbvar->coarse_buf = ParArrayND<Real>();
+      for (auto copy : copies) {
+        copy->coarse_s = ParArrayND<Real>();
+      }
+      pool.Release(v->coarse_s);
+      v->coarse_s = ParArrayND<Real>();
+    }
+    coarse = v->coarse_s;
+    v->vbvar->coarse_buf = v->coarse_s;
+    for (auto copy : copies) {
+      copy->coarse_s = v->coarse_s;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MeshRefinement::ResetCellArrays()
+//  \brief points pvars_cc_ at the current data and coarse arrays of the variables
+
+void MeshRefinement::ResetCellArrays() {
+  // the same iteration as the registration in the MeshBlock constructor
+  ContainerIterator<Real> ci(pmy_block_->real_containers.Get(), {Metadata::Independent});
+  const int nvars = std::min(static_cast<int>(ci.vars.size()),
+                             static_cast<int>(pvars_cc_.size()));
+  for (int n = 0; n < nvars; n++) {
+    pvars_cc_[n] = std::make_tuple(ci.vars[n]->data, ci.vars[n]->coarse_s);
+  }
+}
+
 // TODO(felker): consider merging w/ MeshBlock::pvars_cc, etc. See meshblock.cpp
 
 int MeshRefinement::AddToRefinement(ParArrayND<Real> pvar_cc,
@@ -19,12 +19,14 @@
 //! \file mesh_refinement.hpp
 //  \brief defines MeshRefinement class used for static/adaptive mesh refinement
 
+#include <string>
 #include <tuple>
 #include <vector>
 
 #include "parthenon_mpi.hpp"
 
 #include "athena.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
@@ -34,6 +36,20 @@ class ParameterInput;
 class Coordinates;
 class BoundaryValues;
 
+//----------------------------------------------------------------------------------------
+//! \struct RefinementRegion
+//  \brief restriction or prolongation of components nl..nu of one cell-centered variable
+//  over the coarse index range (si..ei, sj..ej, sk..ek). A table of these lets all
+//  regions of a MeshBlock be restricted or prolongated by a single kernel
+
+struct RefinementRegion {
+  int si = 0, ei = -1, sj = 0, ej = -1, sk = 0, ek = -1;
+  int nl = 0, nu = -1;
+  ParArray4D<Real> fine, coarse;
+};
+
+using RefinementCache_t = Kokkos::View<RefinementRegion *, LayoutWrapper, DevSpace>;
+
 //----------------------------------------------------------------------------------------
 //! \class MeshRefinement
 //  \brief
@@ -61,6 +77,9 @@ class MeshRefinement {
   void ProlongateCellCenteredValues(const ParArrayND<Real> &coarse,
                                     ParArrayND<Real> &fine, int sn, int en, int si,
                                     int ei, int sj, int ej, int sk, int ek);
+  // the same operations on the first nregion entries of a table, in one kernel launch
+  void RestrictCellCenteredRegions(const RefinementCache_t &regions, int nregion);
+  void ProlongateCellCenteredRegions(const RefinementCache_t &regions, int nregion);
   void ProlongateSharedFieldX1(const ParArrayND<Real> &coarse, ParArrayND<Real> &fine,
                                int si, int ei, int sj, int ej, int sk, int ek);
   void ProlongateSharedFieldX2(const ParArrayND<Real> &coarse, ParArrayND<Real> &fine,
@@ -71,6 +90,31 @@ class MeshRefinement {
                                int ek);
   void CheckRefinementCondition();
   void SetRefinement(AmrTag flag);
+  // true if a neighbor of the block is on another level, see
+  // <mesh>/coarse_buffers_on_demand
+  bool NeedsCoarseArrays() const;
+  // (de)allocate the coarse arrays of the cell-centered variables, updating the
+  // boundary variables and pvars_cc_ that refer to them
+  void SetCoarseArrays(const bool allocate);
+  // points pvars_cc_ again at the arrays of the independent cell-centered variables of
+  // the base container, after these were moved (see MeshBlock::FirstTouchData)
+  void ResetCellArrays();
+  // the n-th enrolled cell-centered array and its coarse copy
+  const ParArrayND<Real> &GetCellArray(const int n) const {
+    return std::get<0>(pvars_cc_[n]);
+  }
+  const ParArrayND<Real> &GetCoarseCellArray(const int n) const {
+    return std::get<1>(pvars_cc_[n]);
+  }
+
+  // The update kernels of the last stage reduce the min and max of component 0 of the
+  // fields of the AMRMinMax criteria over each region they update into a slot of their
+  // own (AddFusedExtrema), so the criteria need no pass over the data of their own.
+  // GetFusedExtrema() combines the slots of a field, false if there are none; they are
+  // cleared when the next tag is set.
+  using Extrema = Kokkos::MinMaxScalar<Real>;
+  Kokkos::View<Extrema, DevSpace> AddFusedExtrema(const std::string &field);
+  bool GetFusedExtrema(const std::string &field, Real &qmin, Real &qmax);
 
   // setter functions for "enrolling" variable arrays in refinement via Mesh::AMR()
   // and/or in BoundaryValues::ProlongateBoundaries() (for SMR and AMR)
@@ -82,12 +126,23 @@ class MeshRefinement {
   MeshBlock *pmy_block_;
   Coordinates *pcoarsec;
 
-  ParArrayND<Real> fvol_[2][2], sarea_x1_[2][2], sarea_x2_[2][3], sarea_x3_[3][2];
+  ParArrayND<Real> sarea_x1_[2][2], sarea_x2_[2][3], sarea_x3_[3][2];
+  // (dxm, dxp, dxfm, dxfp) of each coarse cell in each direction, see the constructor
+  ParArrayND<Real> prolong_wgt_[3];
   int refine_flag_, neighbor_rflag_, deref_count_, deref_threshold_;
+  // tagged for refinement since the last Mesh::UpdateMeshBlockTree(), even if the block
+  // is on the maximum level; these blocks are the centers of the refinement buffer
+  bool refine_tagged_;
 
   // functions
   AMRFlagFunc AMRFlag_; // duplicate of Mesh class member
 
+  // the slots of AddFusedExtrema(), with the field of each slot in use
+  Kokkos::View<Extrema *, DevSpace> fused_extrema_;
+  Kokkos::View<Extrema *, DevSpace>::HostMirror fused_extrema_h_;
+  std::vector<std::string> fused_fields_;
+  bool fused_copied_ = false; // fused_extrema_h_ holds the values of all slots in use
+
   // tuples of references to AMR-enrolled arrays (quantity, coarse_quantity)
   std::vector<std::tuple<ParArrayND<Real>, ParArrayND<Real>>> pvars_cc_;
   std::vector<std::tuple<FaceField *, FaceField *>> pvars_fc_;
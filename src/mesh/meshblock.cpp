@@ -18,12 +18,13 @@
 //  \brief implementation of functions in MeshBlock class
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
-#include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -52,10 +53,11 @@ MeshBlock::MeshBlock(int igid, int ilid, LogicalLocation iloc, RegionSize input_
                      BoundaryFlag *input_bcs, Mesh *pm, ParameterInput *pin,
                      Properties_t &properties, Packages_t &packages, int igflag,
                      bool ref_flag)
-    : exec_space(DevSpace()), pmy_mesh(pm), loc(iloc), block_size(input_block), gid(igid),
-      lid(ilid), gflag(igflag), properties(properties), packages(packages), prev(nullptr),
-      next(nullptr), new_block_dt_{}, new_block_dt_hyperbolic_{},
-      new_block_dt_parabolic_{}, new_block_dt_user_{}, cost_(1.0) {
+    : exec_space(pm->GetExecSpace(ilid)), pmy_mesh(pm), loc(iloc),
+      block_size(input_block), gid(igid), lid(ilid), gflag(igflag),
+      properties(properties), packages(packages), prev(nullptr), next(nullptr),
+      new_block_dt_{}, new_block_dt_hyperbolic_{}, new_block_dt_parabolic_{},
+      new_block_dt_user_{}, cost_(1.0) {
   // initialize grid indices
   is = NGHOST;
   ie = is + block_size.nx1 - 1;
@@ -109,7 +111,7 @@ MeshBlock::MeshBlock(int igid, int ilid, LogicalLocation iloc, RegionSize input_
   pbval->SetBoundaryFlags(boundary_flag);
 
   // Coordinates
-  pcoord = std::make_unique<Cartesian>(this, pin, false);
+  pcoord = std::make_unique<CoordinateSystem>(this, pin, false);
 
   // Set the block for containers
   real_container.setBlock(this);
@@ -135,6 +137,16 @@ MeshBlock::MeshBlock(int igid, int ilid, LogicalLocation iloc, RegionSize input_
         real_container.Add(q.first, m);
       }
     }
+    for (auto const &q : pkg.second->AllSwarms()) {
+      auto swarm = std::make_shared<Swarm>(q.first, q.second);
+      for (auto const &v : pkg.second->AllSwarmValues(q.first)) {
+        swarm->Add(v.first, v.second);
+      }
+      swarms[q.first] = swarm;
+    }
+  }
+  if (pin->GetOrAddBoolean("mesh", "slab_block_data", false)) {
+    real_container.AllocateSlab();
   }
 
   // TODO(jdolence): Should these loops be moved to Variable creation
@@ -220,7 +232,7 @@ MeshBlock::MeshBlock(int igid, int ilid, Mesh *pm, ParameterInput *pin,
   pbval = std::make_unique<BoundaryValues>(this, input_bcs, pin);
 
   // Coordinates
-  pcoord = std::make_unique<Cartesian>(this, pin, false);
+  pcoord = std::make_unique<CoordinateSystem>(this, pin, false);
 
   // Reconstruction (constructor may implicitly depend on Coordinates)
   precon = std::make_unique<Reconstruction>(this, pin);
@@ -252,16 +264,46 @@ MeshBlock::MeshBlock(int igid, int ilid, Mesh *pm, ParameterInput *pin,
 // MeshBlock destructor
 
 MeshBlock::~MeshBlock() {
+  // the arrays of the block may go back to a pool shared with blocks on other instances
+  exec_space.fence();
   if (prev != nullptr) prev->next = next;
   if (next != nullptr) next->prev = prev;
 }
 
 //----------------------------------------------------------------------------------------
 //! \fn std::size_t MeshBlock::GetBlockSizeInBytes()
-//  \brief Calculate the block data size required for restart.
+//  \brief the bytes of all arrays of the block in host and device memory, see
+//  AccountMemory
 
 std::size_t MeshBlock::GetBlockSizeInBytes() {
-  throw std::runtime_error("MeshBlock::GetBlockSizeInBytes not yet implemented.");
+  MemoryUsage::Accounting acc;
+  AccountMemory(acc);
+  return acc.Total();
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MeshBlock::AccountMemory(MemoryUsage::Accounting &acc) const
+//  \brief adds the variables of every container of the block, with their fluxes, coarse
+//  and communication buffers and host copies. The copies in the stage containers add
+//  only the arrays they do not share with "base".
+
+void MeshBlock::AccountMemory(MemoryUsage::Accounting &acc) const {
+  for (const auto &c : real_containers.GetAll()) {
+    const Container<Real> &container = *c.second;
+    for (const auto &v : container.GetCellVariableVector()) {
+      v->AccountMemory(acc);
+    }
+    for (const auto &sv : container.GetSparseVector()) {
+      for (const auto &v : sv->GetVector()) {
+        v->AccountMemory(acc);
+      }
+    }
+    for (const auto &v : container.GetFaceVector()) {
+      acc.AddView(v->label(), "data", v->data.x1f.Get());
+      acc.AddView(v->label(), "data", v->data.x2f.Get());
+      acc.AddView(v->label(), "data", v->data.x3f.Get());
+    }
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -289,29 +331,54 @@ void MeshBlock::ResetTimeMeasurement() {
 
 void MeshBlock::StartTimeMeasurement() {
   if (pmy_mesh->lb_automatic_) {
-#ifdef OPENMP_PARALLEL
-    lb_time_ = omp_get_wtime();
-#else
-    lb_time_ = static_cast<double>(clock());
-#endif
+    lb_time_ = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count();
   }
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn void MeshBlock::StartTimeMeasurement()
-//  \brief stop time measurement and accumulate it in the MeshBlock cost
-
-void MeshBlock::StopTimeMeasurement() {
-  if (pmy_mesh->lb_automatic_) {
-#ifdef OPENMP_PARALLEL
-    lb_time_ = omp_get_wtime() - lb_time_;
-#else
-    lb_time_ = static_cast<double>(clock()) - lb_time_;
-#endif
+//! \fn void MeshBlock::StopTimeMeasurement(const bool charge)
+//  \brief stop time measurement and accumulate the wall-clock time in the MeshBlock cost
+
+void MeshBlock::StopTimeMeasurement(const bool charge) {
+  if (pmy_mesh->lb_automatic_ && charge) {
+    if (pmy_mesh->lb_fence_timing_) exec_space.fence();
+    lb_time_ = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count() -
+               lb_time_;
     cost_ += lb_time_;
   }
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void MeshBlock::FirstTouchData()
+//  \brief moves the independent variables into memory first touched by this thread
+
+void MeshBlock::FirstTouchData() {
+  if (!pmy_mesh->numa_first_touch_) return;
+  // the stage containers are added with the first task lists of the block, after the
+  // block and its base container were made by the master thread. Containers are told
+  // apart by identity, as a purged stage container may be added again under its name.
+  bool moved = false;
+  for (auto &c : real_containers.GetAll()) {
+    auto same = [&c](const std::weak_ptr<Container<Real>> &touched) {
+      return touched.lock() == c.second;
+    };
+    if (std::any_of(first_touched_.begin(), first_touched_.end(), same)) continue;
+    c.second->AllocateSlab();
+    moved = true;
+  }
+  if (!moved) return;
+  first_touched_.clear();
+  for (auto &c : real_containers.GetAll()) {
+    first_touched_.push_back(c.second);
+  }
+  // the refinement refers to the arrays of the base container
+  if (pmr) pmr->ResetCellArrays();
+}
+
 void MeshBlock::RegisterMeshBlockData(std::shared_ptr<CellVariable<Real>> pvar_cc) {
   vars_cc_.push_back(pvar_cc);
   return;
@@ -22,10 +22,13 @@
 // grid (user-specified root grid) will be greater than zero if it contains more than
 // one MeshBlock
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "athena.hpp"
 #include "globals.hpp"
@@ -38,6 +41,57 @@ namespace parthenon {
 Mesh *pmesh_;
 MeshBlockTree *MeshBlockTree::proot_;
 int MeshBlockTree::nleaf_;
+std::unordered_map<LogicalLocation, MeshBlockTree *, LogicalLocationHash,
+                   LogicalLocationEqual>
+    MeshBlockTree::nodes_;
+
+namespace {
+
+// spread the low 21 bits of x apart so that two zero bits follow each of them
+std::uint64_t SpreadBits3(std::uint64_t x) {
+  x &= 0x1fffffULL;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
+}
+
+// Skilling's transform (AIP Conf. Proc. 707, 381 (2004)) of the coordinates x[0..ndim-1]
+// of a cell of a 2^nbits grid into the "transposed" Hilbert index; the bits of the
+// index are, from the top, bit nbits-1 of x[0], ..., x[ndim-1], then bit nbits-2, etc.
+void HilbertTranspose(std::uint64_t *x, const int ndim, const int nbits) {
+  const std::uint64_t m = static_cast<std::uint64_t>(1) << (nbits - 1);
+  for (std::uint64_t q = m; q > 1; q >>= 1) { // inverse undo
+    const std::uint64_t p = q - 1;
+    for (int i = 0; i < ndim; i++) {
+      if (x[i] & q) {
+        x[0] ^= p; // invert
+      } else {     // exchange
+        const std::uint64_t t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+  for (int i = 1; i < ndim; i++) // Gray encode
+    x[i] ^= x[i - 1];
+  std::uint64_t t = 0;
+  for (std::uint64_t q = m; q > 1; q >>= 1)
+    if (x[ndim - 1] & q) t ^= q - 1;
+  for (int i = 0; i < ndim; i++)
+    x[i] ^= t;
+}
+
+} // namespace
+
+std::size_t LogicalLocationHash::operator()(const LogicalLocation &loc) const {
+  const std::uint64_t key = SpreadBits3(static_cast<std::uint64_t>(loc.lx1)) |
+                            (SpreadBits3(static_cast<std::uint64_t>(loc.lx2)) << 1) |
+                            (SpreadBits3(static_cast<std::uint64_t>(loc.lx3)) << 2);
+  return static_cast<std::size_t>(key ^ (static_cast<std::uint64_t>(loc.level) << 58));
+}
 
 //----------------------------------------------------------------------------------------
 //! \fn MeshBlockTree::MeshBlockTree()
@@ -50,6 +104,7 @@ MeshBlockTree::MeshBlockTree(Mesh *pmesh) : pleaf_(nullptr), gid_(-1) {
   loc_.lx2 = 0;
   loc_.lx3 = 0;
   loc_.level = 0;
+  nodes_[loc_] = this;
 }
 
 //----------------------------------------------------------------------------------------
@@ -62,6 +117,7 @@ MeshBlockTree::MeshBlockTree(MeshBlockTree *parent, int ox1, int ox2, int ox3)
   loc_.lx2 = (parent->loc_.lx2 << 1) + ox2;
   loc_.lx3 = (parent->loc_.lx3 << 1) + ox3;
   loc_.level = parent->loc_.level + 1;
+  nodes_[loc_] = this;
 }
 
 //----------------------------------------------------------------------------------------
@@ -74,6 +130,13 @@ MeshBlockTree::~MeshBlockTree() {
       delete pleaf_[i];
     delete[] pleaf_;
   }
+  auto it = nodes_.find(loc_);
+  if (it != nodes_.end() && it->second == this) nodes_.erase(it);
+}
+
+MeshBlockTree *MeshBlockTree::Lookup_(const LogicalLocation &loc) {
+  auto it = nodes_.find(loc);
+  return (it == nodes_.end()) ? nullptr : it->second;
 }
 
 //----------------------------------------------------------------------------------------
@@ -296,7 +359,11 @@ void MeshBlockTree::Derefine(int &ndel) {
     }
   }
 
-  gid_ = pleaf_[0]->gid_; // now this is a leaf; inherit the first leaf's GID
+  // now this is a leaf; inherit the GID of the first leaf in the list, which is not
+  // necessarily leaf 0 with the Hilbert ordering
+  gid_ = pleaf_[0]->gid_;
+  for (int n = 1; n < nleaf_; n++)
+    gid_ = std::min(gid_, pleaf_[n]->gid_);
   for (int n = 0; n < nleaf_; n++)
     delete pleaf_[n];
   delete[] pleaf_;
@@ -325,7 +392,8 @@ void MeshBlockTree::CountMeshBlock(int &count) {
 //----------------------------------------------------------------------------------------
 //! \fn void MeshBlockTree::GetMeshBlockList(LogicalLocation *list,
 //                                           int *pglist, int& count)
-//  \brief creates the Location list sorted by Z-ordering
+//  \brief creates the Location list sorted by Z-ordering, or along the Hilbert curve
+//         with <loadbalancing>/ordering = hilbert
 
 void MeshBlockTree::GetMeshBlockList(LogicalLocation *list, int *pglist, int &count) {
   if (loc_.level == 0) count = 0;
@@ -336,13 +404,52 @@ void MeshBlockTree::GetMeshBlockList(LogicalLocation *list, int *pglist, int &co
     gid_ = count;
     count++;
   } else {
+    int order[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    if (pmesh_->hilbert_ordering_ && pmesh_->ndim > 1) {
+      // every subtree covers a contiguous piece of the curve, so ordering the leaves of
+      // each node orders all blocks. The curve is that of the finest possible level, so
+      // that (de)refinement does not change the order of the other blocks, which
+      // Mesh::RedistributeAndRefineMeshBlocks() relies on.
+      const int ndim = pmesh_->ndim, nbits = pmesh_->max_level;
+      std::sort(order, order + nleaf_, [this, ndim, nbits](int a, int b) {
+        if (pleaf_[a] == nullptr || pleaf_[b] == nullptr)
+          return pleaf_[a] != nullptr && pleaf_[b] == nullptr;
+        return HilbertLess(pleaf_[a]->loc_, pleaf_[b]->loc_, ndim, nbits);
+      });
+    }
     for (int n = 0; n < nleaf_; n++) {
-      if (pleaf_[n] != nullptr) pleaf_[n]->GetMeshBlockList(list, pglist, count);
+      MeshBlockTree *leaf = pleaf_[order[n]];
+      if (leaf != nullptr) leaf->GetMeshBlockList(list, pglist, count);
     }
   }
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn bool MeshBlockTree::HilbertLess(const LogicalLocation &a,
+//                                      const LogicalLocation &b, int ndim, int nbits)
+//  \brief compare two blocks by the Hilbert index of their first cell at level nbits
+
+bool MeshBlockTree::HilbertLess(const LogicalLocation &a, const LogicalLocation &b,
+                                int ndim, int nbits) {
+  if (nbits < 1) return false;
+  std::uint64_t xa[3] = {static_cast<std::uint64_t>(a.lx1) << (nbits - a.level),
+                         static_cast<std::uint64_t>(a.lx2) << (nbits - a.level),
+                         static_cast<std::uint64_t>(a.lx3) << (nbits - a.level)};
+  std::uint64_t xb[3] = {static_cast<std::uint64_t>(b.lx1) << (nbits - b.level),
+                         static_cast<std::uint64_t>(b.lx2) << (nbits - b.level),
+                         static_cast<std::uint64_t>(b.lx3) << (nbits - b.level)};
+  HilbertTranspose(xa, ndim, nbits);
+  HilbertTranspose(xb, ndim, nbits);
+  for (int bit = nbits - 1; bit >= 0; bit--) {
+    for (int d = 0; d < ndim; d++) {
+      const std::uint64_t ba = (xa[d] >> bit) & 1, bb = (xb[d] >> bit) & 1;
+      if (ba != bb) return ba < bb;
+    }
+  }
+  return false;
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn MeshBlockTree* MeshBlockTree::FindNeighbor(LogicalLocation myloc,
 //                                    int ox1, int ox2, int ox3, bool amrflag)
@@ -357,7 +464,6 @@ MeshBlockTree *MeshBlockTree::FindNeighbor(LogicalLocation myloc, int ox1, int o
   std::int64_t lx, ly, lz;
   int ll;
   int ox, oy, oz;
-  MeshBlockTree *bt = proot_;
   lx = myloc.lx1, ly = myloc.lx2, lz = myloc.lx3, ll = myloc.level;
 
   lx += ox1;
@@ -405,29 +511,19 @@ MeshBlockTree *MeshBlockTree::FindNeighbor(LogicalLocation myloc, int ox1, int o
   }
   if (ll < 1) return proot_; // single grid; return root
 
-  for (int level = 0; level < ll; level++) {
-    if (bt->pleaf_ == nullptr) { // leaf
-      if (level == ll - 1) {
-        return bt;
-      } else {
-        msg << "### FATAL ERROR in FindNeighbor" << std::endl
-            << "Neighbor search failed. The Block Tree is broken." << std::endl;
-        ATHENA_ERROR(msg);
-        return nullptr;
-      }
-    }
-    // find a leaf in the next level
-    int sh = ll - level - 1;
-    ox = ((lx >> sh) & 1LL) == 1LL;
-    oy = ((ly >> sh) & 1LL) == 1LL;
-    oz = ((lz >> sh) & 1LL) == 1LL;
-    bt = bt->GetLeaf(ox, oy, oz);
-    if (bt == nullptr) {
+  LogicalLocation nloc;
+  nloc.lx1 = lx, nloc.lx2 = ly, nloc.lx3 = lz, nloc.level = ll;
+  MeshBlockTree *bt = Lookup_(nloc);
+  if (bt == nullptr) { // no node on the same level: it must be a coarser leaf
+    nloc.lx1 >>= 1, nloc.lx2 >>= 1, nloc.lx3 >>= 1, nloc.level--;
+    bt = Lookup_(nloc);
+    if (bt == nullptr || bt->pleaf_ != nullptr) {
       msg << "### FATAL ERROR in FindNeighbor" << std::endl
           << "Neighbor search failed. The Block Tree is broken." << std::endl;
       ATHENA_ERROR(msg);
       return nullptr;
     }
+    return bt;
   }
   if (bt->pleaf_ == nullptr) // leaf on the same level
     return bt;
@@ -448,18 +544,11 @@ MeshBlockTree *MeshBlockTree::FindNeighbor(LogicalLocation myloc, int ox1, int o
 
 //----------------------------------------------------------------------------------------
 //! \fn MeshBlockTree* MeshBlockTree::FindMeshBlock(LogicalLocation tloc)
-//  \brief find MeshBlock with LogicalLocation tloc and return a pointer
+//  \brief find MeshBlock with LogicalLocation tloc and return a pointer, or nullptr if
+//         the tree has no node at tloc
 
 MeshBlockTree *MeshBlockTree::FindMeshBlock(LogicalLocation tloc) {
-  if (tloc.level == loc_.level) return this;
-  // get leaf indexes
-  int sh = tloc.level - loc_.level - 1;
-  int mx = (((tloc.lx1 >> sh) & 1LL) == 1LL);
-  int my = (((tloc.lx2 >> sh) & 1LL) == 1LL);
-  int mz = (((tloc.lx3 >> sh) & 1LL) == 1LL);
-  int n = mx + (my << 1) + (mz << 2);
-  if (pleaf_[n] == nullptr) return nullptr;
-  return pleaf_[n]->FindMeshBlock(tloc);
+  return Lookup_(tloc);
 }
 
 } // namespace parthenon
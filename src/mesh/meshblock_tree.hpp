@@ -20,6 +20,9 @@
 //  \brief defines the LogicalLocation structure and MeshBlockTree class
 //======================================================================================
 
+#include <cstddef>
+#include <unordered_map>
+
 #include "athena.hpp"
 #include "bvals/bvals.hpp"
 
@@ -27,9 +30,26 @@ namespace parthenon {
 
 class Mesh;
 
+//--------------------------------------------------------------------------------------
+//! \struct LogicalLocationHash
+//  \brief hash of a LogicalLocation: the Morton key of the low 21 bits of the indices,
+//  mixed with the level
+
+struct LogicalLocationHash {
+  std::size_t operator()(const LogicalLocation &loc) const;
+};
+
+struct LogicalLocationEqual {
+  bool operator()(const LogicalLocation &a, const LogicalLocation &b) const {
+    return a.level == b.level && a.lx1 == b.lx1 && a.lx2 == b.lx2 && a.lx3 == b.lx3;
+  }
+};
+
 //--------------------------------------------------------------------------------------
 //! \class MeshBlockTree
-//  \brief Objects are nodes in an AMR MeshBlock tree structure
+//  \brief Objects are nodes in an AMR MeshBlock tree structure. Every node of the tree
+//  is also registered in a hash map by its LogicalLocation, so that FindNeighbor() and
+//  FindMeshBlock() are lookups instead of descents from the root.
 
 class MeshBlockTree {
   friend class Mesh;
@@ -58,6 +78,11 @@ class MeshBlockTree {
   MeshBlockTree *FindNeighbor(LogicalLocation myloc, int ox1, int ox2, int ox3,
                               bool amrflag = false);
 
+  // true if the first cell of block a on level nbits comes before that of block b along
+  // the Hilbert curve of that level (nbits must not be smaller than the levels of a, b)
+  static bool HilbertLess(const LogicalLocation &a, const LogicalLocation &b, int ndim,
+                          int nbits);
+
  private:
   // data
   MeshBlockTree **pleaf_;
@@ -66,6 +91,12 @@ class MeshBlockTree {
 
   static MeshBlockTree *proot_;
   static int nleaf_;
+  // all nodes of the tree (leaves and internal nodes), by location
+  static std::unordered_map<LogicalLocation, MeshBlockTree *, LogicalLocationHash,
+                            LogicalLocationEqual>
+      nodes_;
+
+  static MeshBlockTree *Lookup_(const LogicalLocation &loc);
 };
 
 } // namespace parthenon
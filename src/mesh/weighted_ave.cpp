@@ -15,136 +15,265 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 //! \file weighted_ave.cpp
-//  \brief
+//  \brief weighted sums U = a*U + b*U1 + c*U2 of the arrays of a block
+
+#include <algorithm>
 
 #include "athena.hpp"
+#include "interface/container.hpp"
+#include "interface/container_iterator.hpp"
+#include "interface/metadata.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
 
-//----------------------------------------------------------------------------------------
-//! \fn  void WeightedAve::WeightedAve
-//  \brief Compute weighted average of ParArrayNDs (including cell-averaged U in time
-//         integrator step)
+namespace {
 
-void MeshBlock::WeightedAve(ParArrayND<Real> &u_out, ParArrayND<Real> &u_in1,
-                            ParArrayND<Real> &u_in2, const Real wght[3]) {
-  // consider every possible simplified form of weighted sum operator:
-  // U = a*U + b*U1 + c*U2
+// every simplified form of the weighted sum operator U = a*U + b*U1 + c*U2.  The form
+// is chosen once on the host, so the kernels carry no branches on the weights.
+enum class AvePattern {
+  none,         // a == 1, b == 0, c == 0
+  accumulate1,  // a == 1, b != 0, c == 0
+  accumulate2,  // a == 1,         c != 0
+  copy1,        // a == 0, b == 1, c == 0
+  assign1,      // a == 0, b != 1, c == 0
+  assign2,      // a == 0,         c != 0
+  scale,        // a != 0, b == 0, c == 0
+  combine1,     // a != 0, b != 0, c == 0
+  combine2      // a != 0,         c != 0
+};
 
-  // assuming all 3x arrays are of the same size (or at least u_out is equal or larger
-  // than each input array) in each array dimension, and full range is desired:
-  // nx4*(3D real MeshBlock cells)
-  const int nu = u_out.GetDim(4) - 1;
-
-  // u_in2 may be an unallocated ParArrayND if using a 2S time integrator
+AvePattern SelectAvePattern(const Real wght[3]) {
+  // u_in2 may be an unallocated ParArrayND if using a 2S time integrator, so it is only
+  // read by the patterns with c != 0
   if (wght[0] == 1.0) {
-    if (wght[2] != 0.0) {
-      for (int n = 0; n <= nu; ++n) {
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              u_out(n, k, j, i) +=
-                  wght[1] * u_in1(n, k, j, i) + wght[2] * u_in2(n, k, j, i);
-            }
-          }
-        }
-      }
-    } else { // do not dereference u_in2
-      if (wght[1] != 0.0) {
-        for (int n = 0; n <= nu; ++n) {
-          for (int k = ks; k <= ke; ++k) {
-            for (int j = js; j <= je; ++j) {
-#pragma omp simd
-              for (int i = is; i <= ie; ++i) {
-                u_out(n, k, j, i) += wght[1] * u_in1(n, k, j, i);
-              }
-            }
-          }
-        }
-      }
-    }
+    if (wght[2] != 0.0) return AvePattern::accumulate2;
+    return (wght[1] != 0.0) ? AvePattern::accumulate1 : AvePattern::none;
   } else if (wght[0] == 0.0) {
-    if (wght[2] != 0.0) {
-      for (int n = 0; n <= nu; ++n) {
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              u_out(n, k, j, i) =
-                  wght[1] * u_in1(n, k, j, i) + wght[2] * u_in2(n, k, j, i);
-            }
-          }
-        }
-      }
-    } else if (wght[1] == 1.0) {
-      // just deep copy
-      for (int n = 0; n <= nu; ++n) {
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              u_out(n, k, j, i) = u_in1(n, k, j, i);
-            }
-          }
-        }
-      }
-    } else {
-      for (int n = 0; n <= nu; ++n) {
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              u_out(n, k, j, i) = wght[1] * u_in1(n, k, j, i);
-            }
-          }
-        }
-      }
-    }
-  } else {
-    if (wght[2] != 0.0) {
-      for (int n = 0; n <= nu; ++n) {
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              u_out(n, k, j, i) = wght[0] * u_out(n, k, j, i) +
-                                  wght[1] * u_in1(n, k, j, i) +
-                                  wght[2] * u_in2(n, k, j, i);
-            }
-          }
-        }
+    if (wght[2] != 0.0) return AvePattern::assign2;
+    return (wght[1] == 1.0) ? AvePattern::copy1 : AvePattern::assign1;
+  }
+  if (wght[2] != 0.0) return AvePattern::combine2;
+  return (wght[1] != 0.0) ? AvePattern::combine1 : AvePattern::scale;
+}
+
+struct AveWeights {
+  Real a, b, c;
+};
+
+// the per-element update for each pattern; Arr is a ParArrayND or a Kokkos view and Idx
+// the (n,k,j,i) or (k,j,i) index
+template <AvePattern P>
+struct WeightedSum;
+
+template <>
+struct WeightedSum<AvePattern::accumulate1> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) += w.b * in1(idx...);
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::accumulate2> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) += w.b * in1(idx...) + w.c * in2(idx...);
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::copy1> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) = in1(idx...);
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::assign1> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) = w.b * in1(idx...);
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::assign2> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) = w.b * in1(idx...) + w.c * in2(idx...);
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::scale> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) *= w.a;
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::combine1> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) = w.a * out(idx...) + w.b * in1(idx...);
+  }
+};
+
+template <>
+struct WeightedSum<AvePattern::combine2> {
+  template <typename Arr, typename... Idx>
+  KOKKOS_FORCEINLINE_FUNCTION static void Apply(const Arr &out, const Arr &in1,
+                                                const Arr &in2, const AveWeights &w,
+                                                const Idx... idx) {
+    out(idx...) = w.a * out(idx...) + w.b * in1(idx...) + w.c * in2(idx...);
+  }
+};
+
+// all components of the cell-centered array in one launch
+template <AvePattern P>
+struct CellAve {
+  static void Launch(MeshBlock *pmb, const ParArrayND<Real> &u_out,
+                     const ParArrayND<Real> &u_in1, const ParArrayND<Real> &u_in2,
+                     const AveWeights w) {
+    // assuming all 3x arrays are of the same size (or at least u_out is equal or larger
+    // than each input array) in each array dimension, and full range is desired:
+    // nx4*(3D real MeshBlock cells)
+    const int nu = u_out.GetDim(4) - 1;
+    pmb->par_for(
+        "WeightedAveCell", 0, nu, pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+          WeightedSum<P>::Apply(u_out, u_in1, u_in2, w, n, k, j, i);
+        });
+  }
+};
+
+// the components of up to kAveBatch variables of a container per launch, passed to the
+// kernel by value so that no table of views has to be copied to the device first
+constexpr int kAveBatch = 8;
+struct AveBatch {
+  int nvar;
+  Kokkos::Array<ParArray4D<Real>, kAveBatch> out, in1, in2;
+};
+
+template <AvePattern P>
+struct ContainerAve {
+  static void Launch(MeshBlock *pmb, Container<Real> &c_out, Container<Real> &c_in1,
+                     Container<Real> &c_in2, const AveWeights w) {
+    ContainerIterator<Real> out_iter(c_out, {Metadata::Independent});
+    ContainerIterator<Real> in1_iter(c_in1, {Metadata::Independent});
+    ContainerIterator<Real> in2_iter(c_in2, {Metadata::Independent});
+    const int nvars = out_iter.vars.size();
+    for (int first = 0; first < nvars; first += kAveBatch) {
+      AveBatch batch;
+      batch.nvar = std::min(kAveBatch, nvars - first);
+      for (int v = 0; v < batch.nvar; v++) {
+        batch.out[v] = out_iter.vars[first + v]->data.Get<4>();
+        batch.in1[v] = in1_iter.vars[first + v]->data.Get<4>();
+        batch.in2[v] = in2_iter.vars[first + v]->data.Get<4>();
       }
-    } else { // do not dereference u_in2
-      if (wght[1] != 0.0) {
-        for (int n = 0; n <= nu; ++n) {
-          for (int k = ks; k <= ke; ++k) {
-            for (int j = js; j <= je; ++j) {
-#pragma omp simd
-              for (int i = is; i <= ie; ++i) {
-                u_out(n, k, j, i) =
-                    wght[0] * u_out(n, k, j, i) + wght[1] * u_in1(n, k, j, i);
-              }
-            }
-          }
-        }
-      } else { // do not dereference u_in1
-        for (int n = 0; n <= nu; ++n) {
-          for (int k = ks; k <= ke; ++k) {
-            for (int j = js; j <= je; ++j) {
-#pragma omp simd
-              for (int i = is; i <= ie; ++i) {
-                u_out(n, k, j, i) *= wght[0];
+      pmb->par_for(
+          "WeightedAveContainer", pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+          KOKKOS_LAMBDA(const int k, const int j, const int i) {
+            for (int v = 0; v < batch.nvar; v++) {
+              for (int n = 0; n < batch.out[v].extent_int(0); n++) {
+                WeightedSum<P>::Apply(batch.out[v], batch.in1[v], batch.in2[v], w, n, k,
+                                      j, i);
               }
             }
-          }
-        }
-      }
+          });
     }
   }
-  return;
+};
+
+// all three face components in one launch over the union of their index ranges; only
+// the final longitudinal face in each direction needs a separate bound
+template <AvePattern P>
+struct FaceAve {
+  static void Launch(MeshBlock *pmb, const FaceField &b_out, const FaceField &b_in1,
+                     const FaceField &b_in2, const AveWeights w) {
+    const int ie = pmb->ie, je = pmb->je, ke = pmb->ke;
+    pmb->par_for(
+        "WeightedAveFace", pmb->ks, ke + 1, pmb->js, je + 1, pmb->is, ie + 1,
+        KOKKOS_LAMBDA(const int k, const int j, const int i) {
+          if (k <= ke && j <= je) {
+            WeightedSum<P>::Apply(b_out.x1f, b_in1.x1f, b_in2.x1f, w, k, j, i);
+          }
+          if (k <= ke && i <= ie) {
+            WeightedSum<P>::Apply(b_out.x2f, b_in1.x2f, b_in2.x2f, w, k, j, i);
+          }
+          if (j <= je && i <= ie) {
+            WeightedSum<P>::Apply(b_out.x3f, b_in1.x3f, b_in2.x3f, w, k, j, i);
+          }
+        });
+  }
+};
+
+// launch the kernel specialized for the pattern of the weights; F is CellAve,
+// ContainerAve or FaceAve
+template <template <AvePattern> class F, typename T>
+void DispatchWeightedAve(MeshBlock *pmb, T &out, T &in1, T &in2, const Real wght[3]) {
+  const AveWeights w{wght[0], wght[1], wght[2]};
+  switch (SelectAvePattern(wght)) {
+  case AvePattern::none:
+    return;
+  case AvePattern::accumulate1:
+    return F<AvePattern::accumulate1>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::accumulate2:
+    return F<AvePattern::accumulate2>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::copy1:
+    return F<AvePattern::copy1>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::assign1:
+    return F<AvePattern::assign1>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::assign2:
+    return F<AvePattern::assign2>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::scale:
+    return F<AvePattern::scale>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::combine1:
+    return F<AvePattern::combine1>::Launch(pmb, out, in1, in2, w);
+  case AvePattern::combine2:
+    return F<AvePattern::combine2>::Launch(pmb, out, in1, in2, w);
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn  void WeightedAve::WeightedAve
+//  \brief Compute weighted average of ParArrayNDs (including cell-averaged U in time
+//         integrator step)
+
+void MeshBlock::WeightedAve(ParArrayND<Real> &u_out, ParArrayND<Real> &u_in1,
+                            ParArrayND<Real> &u_in2, const Real wght[3]) {
+  DispatchWeightedAve<CellAve>(this, u_out, u_in1, u_in2, wght);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn  void MeshBlock::WeightedAve
+//  \brief Compute the weighted average of all independent variables of the containers,
+//         batched into as few launches as possible
+
+void MeshBlock::WeightedAve(Container<Real> &c_out, Container<Real> &c_in1,
+                            Container<Real> &c_in2, const Real wght[3]) {
+  DispatchWeightedAve<ContainerAve>(this, c_out, c_in1, c_in2, wght);
 }
 
 //----------------------------------------------------------------------------------------
@@ -153,263 +282,7 @@ void MeshBlock::WeightedAve(ParArrayND<Real> &u_out, ParArrayND<Real> &u_in1,
 
 void MeshBlock::WeightedAve(FaceField &b_out, FaceField &b_in1, FaceField &b_in2,
                             const Real wght[3]) {
-  int jl = js;
-  int ju = je + 1;
-
-  // Note: these loops can be combined now that they avoid curl terms
-  // Only need to separately account for the final longitudinal face in each loop limit
-  if (wght[0] == 1.0) {
-    if (wght[2] != 0.0) {
-      //---- B1
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie + 1; ++i) {
-            b_out.x1f(k, j, i) +=
-                wght[1] * b_in1.x1f(k, j, i) + wght[2] * b_in2.x1f(k, j, i);
-          }
-        }
-      }
-      //---- B2
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x2f(k, j, i) +=
-                wght[1] * b_in1.x2f(k, j, i) + wght[2] * b_in2.x2f(k, j, i);
-          }
-        }
-      }
-      //---- B3
-      for (int k = ks; k <= ke + 1; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x3f(k, j, i) +=
-                wght[1] * b_in1.x3f(k, j, i) + wght[2] * b_in2.x3f(k, j, i);
-          }
-        }
-      }
-    } else { // do not dereference u_in2
-      if (wght[1] != 0.0) {
-        //---- B1
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie + 1; ++i) {
-              b_out.x1f(k, j, i) += wght[1] * b_in1.x1f(k, j, i);
-            }
-          }
-        }
-        //---- B2
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              b_out.x2f(k, j, i) += wght[1] * b_in1.x2f(k, j, i);
-            }
-          }
-        }
-        //---- B3
-        for (int k = ks; k <= ke + 1; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              b_out.x3f(k, j, i) += wght[1] * b_in1.x3f(k, j, i);
-            }
-          }
-        }
-      }
-    }
-  } else if (wght[0] == 0.0) {
-    if (wght[2] != 0.0) {
-      //---- B1
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie + 1; ++i) {
-            b_out.x1f(k, j, i) =
-                wght[1] * b_in1.x1f(k, j, i) + wght[2] * b_in2.x1f(k, j, i);
-          }
-        }
-      }
-      //---- B2
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x2f(k, j, i) =
-                wght[1] * b_in1.x2f(k, j, i) + wght[2] * b_in2.x2f(k, j, i);
-          }
-        }
-      }
-      //---- B3
-      for (int k = ks; k <= ke + 1; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x3f(k, j, i) =
-                wght[1] * b_in1.x3f(k, j, i) + wght[2] * b_in2.x3f(k, j, i);
-          }
-        }
-      }
-    } else if (wght[1] == 1.0) {
-      // just deep copy
-      //---- B1
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie + 1; ++i) {
-            b_out.x1f(k, j, i) = b_in1.x1f(k, j, i);
-          }
-        }
-      }
-      //---- B2
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x2f(k, j, i) = b_in1.x2f(k, j, i);
-          }
-        }
-      }
-      //---- B3
-      for (int k = ks; k <= ke + 1; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x3f(k, j, i) = b_in1.x3f(k, j, i);
-          }
-        }
-      }
-    } else {
-      //---- B1
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie + 1; ++i) {
-            b_out.x1f(k, j, i) = wght[1] * b_in1.x1f(k, j, i);
-          }
-        }
-      }
-      //---- B2
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x2f(k, j, i) = wght[1] * b_in1.x2f(k, j, i);
-          }
-        }
-      }
-      //---- B3
-      for (int k = ks; k <= ke + 1; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x3f(k, j, i) = wght[1] * b_in1.x3f(k, j, i);
-          }
-        }
-      }
-    }
-  } else {
-    if (wght[2] != 0.0) {
-      //---- B1
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie + 1; ++i) {
-            b_out.x1f(k, j, i) = wght[0] * b_out.x1f(k, j, i) +
-                                 wght[1] * b_in1.x1f(k, j, i) +
-                                 wght[2] * b_in2.x1f(k, j, i);
-          }
-        }
-      }
-      //---- B2
-      for (int k = ks; k <= ke; ++k) {
-        for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x2f(k, j, i) = wght[0] * b_out.x2f(k, j, i) +
-                                 wght[1] * b_in1.x2f(k, j, i) +
-                                 wght[2] * b_in2.x2f(k, j, i);
-          }
-        }
-      }
-      //---- B3
-      for (int k = ks; k <= ke + 1; ++k) {
-        for (int j = js; j <= je; ++j) {
-#pragma omp simd
-          for (int i = is; i <= ie; ++i) {
-            b_out.x3f(k, j, i) = wght[0] * b_out.x3f(k, j, i) +
-                                 wght[1] * b_in1.x3f(k, j, i) +
-                                 wght[2] * b_in2.x3f(k, j, i);
-          }
-        }
-      }
-    } else { // do not dereference u_in2
-      if (wght[1] != 0.0) {
-        //---- B1
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie + 1; ++i) {
-              b_out.x1f(k, j, i) =
-                  wght[0] * b_out.x1f(k, j, i) + wght[1] * b_in1.x1f(k, j, i);
-            }
-          }
-        }
-        //---- B2
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              b_out.x2f(k, j, i) =
-                  wght[0] * b_out.x2f(k, j, i) + wght[1] * b_in1.x2f(k, j, i);
-            }
-          }
-        }
-        //---- B3
-        for (int k = ks; k <= ke + 1; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              b_out.x3f(k, j, i) =
-                  wght[0] * b_out.x3f(k, j, i) + wght[1] * b_in1.x3f(k, j, i);
-            }
-          }
-        }
-      } else { // do not dereference u_in1
-        //---- B1
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie + 1; ++i) {
-              b_out.x1f(k, j, i) *= wght[0];
-            }
-          }
-        }
-        //---- B2
-        for (int k = ks; k <= ke; ++k) {
-          for (int j = jl; j <= ju; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              b_out.x2f(k, j, i) *= wght[0];
-            }
-          }
-        }
-        //---- B3
-        for (int k = ks; k <= ke + 1; ++k) {
-          for (int j = js; j <= je; ++j) {
-#pragma omp simd
-            for (int i = is; i <= ie; ++i) {
-              b_out.x3f(k, j, i) *= wght[0];
-            }
-          }
-        }
-      }
-    }
-  }
-  return;
+  DispatchWeightedAve<FaceAve>(this, b_out, b_in1, b_in2, wght);
 }
 
 } // namespace parthenon
@@ -0,0 +1,218 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file adios2.cpp
+//  \brief writes the graphics variables through ADIOS2, one step per output.
+//  The engine is chosen with <output>/engine: BP5 (default) writes a .bp file, SST
+//  streams each step to a reader, e.g. a separate analysis job, without touching the
+//  file system.  The variables are laid out like those of ATHDF5Output: every array
+//  indexed by block has the block as its slowest index, and the blocks of rank r follow
+//  those of the ranks before it.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "athena.hpp"
+#include "coordinates/coordinates.hpp"
+#include "globals.hpp"
+#include "interface/container_iterator.hpp"
+#include "mesh/mesh.hpp"
+#include "outputs/outputs.hpp"
+#include "parameter_input.hpp"
+
+#ifdef ENABLE_ADIOS2
+
+namespace parthenon {
+
+namespace {
+
+// puts rows [start, start + count) of the slowest index of a global array of the given
+// shape, defining the variable in the first step and updating its shape in later ones,
+// as the number of blocks changes with refinement
+template <typename T>
+void PutRows(adios2::IO &io, adios2::Engine &engine, const std::string &name,
+             const adios2::Dims &shape, const std::size_t start, const std::size_t count,
+             const std::vector<T> &data) {
+  adios2::Dims lstart(shape.size(), 0), lcount(shape);
+  lstart[0] = start;
+  lcount[0] = count;
+  adios2::Variable<T> var = io.InquireVariable<T>(name);
+  if (!var) {
+    var = io.DefineVariable<T>(name, shape, lstart, lcount);
+  } else {
+    var.SetShape(shape);
+    var.SetSelection({lstart, lcount});
+  }
+  if (count > 0) engine.Put(var, data.data());
+}
+
+template <typename T>
+void PutValue(adios2::IO &io, adios2::Engine &engine, const std::string &name,
+              const T &value) {
+  adios2::Variable<T> var = io.InquireVariable<T>(name);
+  if (!var) var = io.DefineVariable<T>(name);
+  if (Globals::my_rank == 0) engine.Put(var, value);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+// ADIOS2Output constructor: opens the engine on all ranks, which an SST writer only
+// returns from once its readers have connected (see the SST parameters of ADIOS2)
+
+ADIOS2Output::ADIOS2Output(OutputParameters oparams) : OutputType(oparams) {
+#ifdef MPI_PARALLEL
+  adios_ = std::make_unique<adios2::ADIOS>(MPI_COMM_WORLD);
+#else
+  adios_ = std::make_unique<adios2::ADIOS>();
+#endif
+  io_ = adios_->DeclareIO(output_params.block_name);
+  io_.SetEngine(output_params.adios2_engine);
+  if (!output_params.adios2_parameters.empty()) {
+    io_.SetParameters(output_params.adios2_parameters);
+  }
+  const std::string name =
+      output_params.file_basename + "." + output_params.file_id + ".bp";
+  // a restarted run appends its steps to those of the run it continues
+  engine_ = io_.Open(name, output_params.file_number > 0 ? adios2::Mode::Append
+                                                         : adios2::Mode::Write);
+}
+
+ADIOS2Output::~ADIOS2Output() {
+  if (engine_) engine_.Close();
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void ADIOS2Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag)
+//  \brief Copies the coordinates and the graphics variables of the blocks in the output
+//         to the host and puts them as one step
+
+void ADIOS2Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
+  // blocks in the output region, numbered across ranks in rank order
+  std::vector<MeshBlock *> blocks;
+  for (MeshBlock *pmb = pm->pblock; pmb != nullptr; pmb = pmb->next) {
+    if (BlockInOutput(pmb)) blocks.push_back(pmb);
+  }
+  unsigned long long nblocks = blocks.size(), block_start = 0, nbtotal = nblocks;
+#ifdef MPI_PARALLEL
+  MPI_Exscan(&nblocks, &block_start, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+  if (Globals::my_rank == 0) block_start = 0;
+  MPI_Allreduce(MPI_IN_PLACE, &nbtotal, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+                MPI_COMM_WORLD);
+#endif
+
+  // advance output parameters
+  output_params.file_number++;
+  output_params.next_time += output_params.dt;
+  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+
+  engine_.BeginStep();
+  PutValue(io_, engine_, "Time", static_cast<double>(pm->time));
+  PutValue(io_, engine_, "NCycle", pm->ncycle);
+  PutValue(io_, engine_, "NumDims", pm->ndim);
+  // a rank without blocks in the output only takes part in the step
+  if (nblocks == 0) {
+    engine_.EndStep();
+    return;
+  }
+
+  MeshBlock *pmb = blocks[0];
+  out_is = pmb->is;
+  out_ie = pmb->ie;
+  out_js = pmb->js;
+  out_je = pmb->je;
+  out_ks = pmb->ks;
+  out_ke = pmb->ke;
+  if (output_params.include_ghost_zones) {
+    out_is -= NGHOST;
+    out_ie += NGHOST;
+    if (out_js != out_je) {
+      out_js -= NGHOST;
+      out_je += NGHOST;
+    }
+    if (out_ks != out_ke) {
+      out_ks -= NGHOST;
+      out_ke += NGHOST;
+    }
+  }
+  const int stride = output_params.stride;
+  const int nx1 = (out_ie - out_is) / stride + 1;
+  const int nx2 = (out_je - out_js) / stride + 1;
+  const int nx3 = (out_ke - out_ks) / stride + 1;
+  const std::size_t n1 = nx1, n2 = nx2, n3 = nx3; // as ADIOS2 dimensions
+
+  // logical locations and coordinates
+  lx123_.resize(3 * nblocks);
+  level_.resize(nblocks);
+  x_.resize(nblocks * (n1 + 1));
+  y_.resize(nblocks * (n2 + 1));
+  z_.resize(nblocks * (n3 + 1));
+  for (std::size_t b = 0; b < nblocks; b++) {
+    const LogicalLocation &loc = blocks[b]->loc;
+    lx123_[3 * b] = loc.lx1;
+    lx123_[3 * b + 1] = loc.lx2;
+    lx123_[3 * b + 2] = loc.lx3;
+    level_[b] = loc.level - pm->GetRootLevel();
+    auto &pco = blocks[b]->pcoord;
+    for (int i = 0; i <= nx1; i++)
+      x_[b * (n1 + 1) + i] = pco->x1f(std::min(out_is + i * stride, out_ie + 1));
+    for (int j = 0; j <= nx2; j++)
+      y_[b * (n2 + 1) + j] = pco->x2f(std::min(out_js + j * stride, out_je + 1));
+    for (int k = 0; k <= nx3; k++)
+      z_[b * (n3 + 1) + k] = pco->x3f(std::min(out_ks + k * stride, out_ke + 1));
+  }
+  PutRows(io_, engine_, "Blocks/loc.lx123", {nbtotal, 3}, block_start, nblocks, lx123_);
+  PutRows(io_, engine_, "Blocks/loc.level", {nbtotal}, block_start, nblocks, level_);
+  PutRows(io_, engine_, "Locations/x", {nbtotal, n1 + 1}, block_start, nblocks, x_);
+  PutRows(io_, engine_, "Locations/y", {nbtotal, n2 + 1}, block_start, nblocks, y_);
+  PutRows(io_, engine_, "Locations/z", {nbtotal, n3 + 1}, block_start, nblocks, z_);
+
+  // graphics variables, as (block, k, j, i, component); every block holds the same
+  // variables in the same order
+  ContainerIterator<Real> ci(pmb->real_containers.Get(), {Metadata::Graphics});
+  const std::size_t nvars = ci.vars.size();
+  data_.resize(nvars);
+  for (std::size_t n = 0; n < nvars; n++) {
+    const int vlen = ci.vars[n]->GetDim(4);
+    const std::size_t nv = vlen;
+    std::vector<Real> &data = data_[n];
+    data.resize(nblocks * n3 * n2 * n1 * nv);
+    for (std::size_t b = 0; b < nblocks; b++) {
+      ContainerIterator<Real> cib(blocks[b]->real_containers.Get(), {Metadata::Graphics});
+      const auto &h = cib.vars[n]->GetHostData();
+      std::size_t index = b * n3 * n2 * n1 * nv;
+      for (int k = out_ks; k <= out_ke; k += stride) {
+        for (int j = out_js; j <= out_je; j += stride) {
+          for (int i = out_is; i <= out_ie; i += stride) {
+            for (int l = 0; l < vlen; l++, index++) {
+              data[index] = h(l, k, j, i);
+            }
+          }
+        }
+      }
+    }
+    PutRows(io_, engine_, ci.vars[n]->label(), {nbtotal, n3, n2, n1, nv}, block_start,
+            nblocks, data);
+  }
+  // the deferred puts read the buffers here
+  engine_.EndStep();
+}
+
+} // namespace parthenon
+
+#endif // ENABLE_ADIOS2
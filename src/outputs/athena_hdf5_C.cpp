@@ -15,10 +15,21 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <future>
 #include <iomanip>
+#include <iostream>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "parthenon_mpi.hpp"
 
@@ -37,7 +48,12 @@
 #include <hdf5.h>
 
 #define PREDINT32 H5T_NATIVE_INT32
-#define PREDFLOAT64 H5T_NATIVE_DOUBLE
+// the floating point data, which is written in the precision of Real
+#if SINGLE_PRECISION_ENABLED
+#define PREDREAL H5T_NATIVE_FLOAT
+#else
+#define PREDREAL H5T_NATIVE_DOUBLE
+#endif
 
 namespace parthenon {
 
@@ -58,17 +74,16 @@ static std::string stringXdmfArrayRef(const std::string &prefix,
   return mystr;
 }
 
-static void writeXdmfArrayRef(std::ofstream &fid, const std::string &prefix,
+static void writeXdmfArrayRef(std::ostream &fid, const std::string &prefix,
                               const std::string &hdfPath, const std::string &label,
                               const hsize_t *dims, const int &ndims,
                               const std::string &theType, const int &precision) {
-  fid << stringXdmfArrayRef(prefix, hdfPath, label, dims, ndims, theType, precision)
-      << std::flush;
+  fid << stringXdmfArrayRef(prefix, hdfPath, label, dims, ndims, theType, precision);
 }
 
-static void writeXdmfSlabVariableRef(std::ofstream &fid, std::string &name,
-                                     std::string &hdfFile, int iblock, const int &vlen,
-                                     int &ndims, hsize_t *dims,
+static void writeXdmfSlabVariableRef(std::ostream &fid, const std::string &name,
+                                     const std::string &hdfPath, int iblock,
+                                     const int &vlen, int &ndims, hsize_t *dims,
                                      const std::string &dims321) {
   // writes a slab reference to file
 
@@ -78,21 +93,26 @@ static void writeXdmfSlabVariableRef(std::ofstream &fid, std::string &name,
     fid << R"( AttributeType="Vector")"
         << R"( Dimensions=")" << dims321 << " " << vlen << R"(")";
   }
-  fid << ">" << std::endl;
+  fid << ">" << '\n';
   fid << prefix << "  "
       << R"(<DataItem ItemType="HyperSlab" Dimensions=")" << dims321 << " " << vlen
-      << R"(">)" << std::endl;
+      << R"(">)" << '\n';
   fid << prefix << "    "
       << R"(<DataItem Dimensions="3 5" NumberType="Int" Format="XML">)" << iblock
-      << " 0 0 0 0 1 1 1 1 1 1 " << dims321 << " " << vlen << "</DataItem>" << std::endl;
+      << " 0 0 0 0 1 1 1 1 1 1 " << dims321 << " " << vlen << "</DataItem>" << '\n';
 
-  writeXdmfArrayRef(fid, prefix + "    ", hdfFile + ":/", name, dims, ndims, "Float", 8);
+  writeXdmfArrayRef(fid, prefix + "    ", hdfPath, name, dims, ndims, "Float",
+                    sizeof(Real));
   fid << prefix << "  "
-      << "</DataItem>" << std::endl;
-  fid << prefix << "</Attribute>" << std::endl;
+      << "</DataItem>" << '\n';
+  fid << prefix << "</Attribute>" << '\n';
   return;
 }
 
+// cells of a block along a direction with n cells on the given level of the pyramid,
+// where each level halves the cells of the one below in the directions of the mesh
+static int LevelCells(const int n, const int level) { return (n > 1 ? n >> level : 1); }
+
 static herr_t writeH5AI32(const char *name, const int *pData, hid_t &file,
                           const hid_t &dSpace, const hid_t &dSet) {
   // write an attribute to file
@@ -104,137 +124,291 @@ static herr_t writeH5AI32(const char *name, const int *pData, hid_t &file,
   return status;
 }
 
-static herr_t writeH5AF64(const char *name, const Real *pData, hid_t &file,
-                          const hid_t &dSpace, const hid_t &dSet) {
+static herr_t writeH5AReal(const char *name, const Real *pData, hid_t &file,
+                           const hid_t &dSpace, const hid_t &dSet) {
   // write an attribute to file
   herr_t status; // assumption that multiple errors are stacked in calls.
   hid_t attribute;
-  attribute = H5Acreate(dSet, name, PREDFLOAT64, dSpace, H5P_DEFAULT, H5P_DEFAULT);
-  status = H5Awrite(attribute, PREDFLOAT64, pData);
+  attribute = H5Acreate(dSet, name, PREDREAL, dSpace, H5P_DEFAULT, H5P_DEFAULT);
+  status = H5Awrite(attribute, PREDREAL, pData);
   status = H5Aclose(attribute);
   return status;
 }
 
-void ATHDF5Output::genXDMF(std::string hdfFile, Mesh *pm) {
-  // using round robin generation.
-  // must switch to MPIIO at some point
+//----------------------------------------------------------------------------------------
+//! \struct ATHDF5Output::Snapshot
+//  \brief host copy of everything needed to write one output file, so that the file can
+//         be written while the simulation moves on
+
+struct ATHDF5Output::Snapshot {
+  std::string filename;
+  std::string series_filename; // time series of the XDMF files of the output
+  bool new_series;             // the first dump of the output starts the series anew
+  std::uint64_t mesh_generation;
+  std::shared_ptr<XdmfTemplate> xdmf;
+  Real time;
+  int ncycle, ndim, nbtotal, max_level, include_ghost;
+  std::vector<int> blocks_per_pe;
+  int nx1, nx2, nx3; // sizes of MeshBlocks in the output
+  hsize_t num_blocks_local, block_start;
+  std::vector<Real> x, y, z;
+  std::vector<std::string> names;
+  std::vector<int> vlens;
+  std::vector<std::vector<Real>> data;
+  // zero-copy path: per variable, the arrays of this rank's blocks, written in place
+  // through a memory dataspace selecting the interior.  Empty when data is used.
+  std::vector<std::vector<const Real *>> views;
+  hsize_t view_dims[3], view_start[3];
+  // dataset layout and filter options
+  bool chunking;
+  std::string compression;
+  int compression_level;
+  Real error_bound;
+  // MPI-IO tuning
+  hsize_t sieve_buf_size, alignment_threshold, alignment;
+  std::vector<std::pair<std::string, std::string>> mpi_info_hints;
+  // coarse levels of the blocks, by level - 1: coordinates and, per variable, the data
+  int pyramid_levels;
+  std::vector<std::vector<Real>> level_x, level_y, level_z;
+  std::vector<std::vector<std::vector<Real>>> level_data;
+};
+
+namespace {
+// Asynchronous dumps are chained so that each waits for the previous one: HDF5 is never
+// entered from two threads at once and files are completed in order.  Only the main
+// thread touches this queue.
+std::deque<std::shared_future<void>> pending_writes;
+#ifdef MPI_PARALLEL
+// background collective IO must not share a communicator with the main thread
+MPI_Comm async_comm = MPI_COMM_NULL;
+#endif
+
+// averages the children of each cell of coarse, r3 x r2 x r1 cells of fine starting at
+// (ok, oj, oi), on the execution space of the block
+void RestrictLevel(MeshBlock *pmb, const ParArray4D<Real> &fine, const int ok,
+                   const int oj, const int oi, const ParArray4D<Real> &coarse,
+                   const int r3, const int r2, const int r1) {
+  const Real w = 1.0 / (r3 * r2 * r1);
+  pmb->par_for(
+      "ATHDF5Output::RestrictLevel", 0, coarse.extent_int(0) - 1, 0,
+      coarse.extent_int(1) - 1, 0, coarse.extent_int(2) - 1, 0, coarse.extent_int(3) - 1,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        Real sum = 0.0;
+        for (int dk = 0; dk < r3; dk++) {
+          for (int dj = 0; dj < r2; dj++) {
+            for (int di = 0; di < r1; di++) {
+              sum += fine(n, ok + r3 * k + dk, oj + r2 * j + dj, oi + r1 * i + di);
+            }
+          }
+        }
+        coarse(n, k, j, i) = w * sum;
+      });
+}
+
+bool AsyncWritesSupported() {
+#ifdef MPI_PARALLEL
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided != MPI_THREAD_MULTIPLE) return false;
+  if (async_comm == MPI_COMM_NULL) MPI_Comm_dup(MPI_COMM_WORLD, &async_comm);
+#endif
+  return true;
+}
+} // namespace
 
+//----------------------------------------------------------------------------------------
+//! \struct ATHDF5Output::XdmfTemplate
+//  \brief the XDMF description of the blocks and variables of one mesh. It is built on
+//  rank 0 when the mesh, the variables or the layout of the output change and written
+//  again by every dump of the same mesh, with markers standing in for the name of the
+//  HDF5 file, the time and the cycle of the dump.
+
+struct ATHDF5Output::XdmfTemplate {
+  static constexpr char kFile = '\x01', kTime = '\x02', kCycle = '\x03';
+  std::string key; // what text was built for
+  std::string text;
+};
+
+namespace {
+// the temporal collection of the XDMF files of an output, up to its closing tags
+const char kSeriesHeader[] = R"(<?xml version="1.0" ?>
+<!DOCTYPE Xdmf SYSTEM "Xdmf.dtd">
+<Xdmf xmlns:xi="http://www.w3.org/2001/XInclude" Version="3.0">
+  <Domain>
+    <Grid Name="TimeSeries" GridType="Collection" CollectionType="Temporal">
+)";
+const char kSeriesTrailer[] = "    </Grid>\n  </Domain>\n</Xdmf>\n";
+
+// appends the leaf grid of the XDMF file of one dump to the time series, so the series
+// grows by one line per dump instead of being rewritten
+void AppendToSeries(const std::string &series, const std::string &xdmf_file,
+                    const bool new_series) {
+  const std::string entry = R"(      <xi:include href=")" + xdmf_file +
+                            R"(" xpointer="xpointer(//Xdmf/Domain/Grid[1])"/>)" + '\n';
+  const std::string trailer(kSeriesTrailer);
+  if (!new_series) {
+    std::fstream fid(series, std::ios::in | std::ios::out | std::ios::binary);
+    if (fid) {
+      fid.seekg(0, std::ios::end);
+      const std::streamoff size = fid.tellg();
+      std::string tail(trailer.size(), '\0');
+      if (size >= static_cast<std::streamoff>(tail.size())) {
+        fid.seekg(size - tail.size());
+        fid.read(&tail[0], tail.size());
+      }
+      // a series left by a previous run continues, unless it was cut short
+      if (fid && tail == trailer) {
+        fid.seekp(size - tail.size());
+        fid << entry << trailer;
+        return;
+      }
+    }
+  }
+  std::ofstream fid(series, std::ofstream::trunc);
+  fid << kSeriesHeader << entry << trailer;
+}
+} // namespace
+
+void ATHDF5Output::genXDMF(const Snapshot &snap) {
   // only rank 0 writes XDMF
   if (Globals::my_rank != 0) {
     return;
   }
+  XdmfTemplate &tmpl = *snap.xdmf;
+  std::ostringstream key;
+  key << snap.mesh_generation << " " << snap.nbtotal << " " << snap.nx1 << " " << snap.nx2
+      << " " << snap.nx3 << " " << snap.pyramid_levels;
+  for (int n = 0; n < static_cast<int>(snap.names.size()); n++) {
+    key << " " << snap.names[n] << ":" << snap.vlens[n];
+  }
+  if (key.str() != tmpl.key) {
+    tmpl.key = key.str();
+    std::ostringstream xdmf;
+    const std::string hdfFile(1, XdmfTemplate::kFile);
+    hsize_t dims[5] = {0, 0, 0, 0, 0};
+
+    // Write header
+    xdmf << R"(<?xml version="1.0" ?>)" << '\n';
+    xdmf << R"(<!DOCTYPE Xdmf SYSTEM "Xdmf.dtd">)" << '\n';
+    xdmf << R"(<Xdmf Version="3.0">)" << '\n';
+    xdmf << "  <Domain>" << '\n';
+
+    // one collection of blocks for the leaf data ("Mesh") and one for each coarse level
+    // ("Level1", ...), whose datasets are in the group of the same name
+    for (int level = 0; level <= snap.pyramid_levels; level++) {
+      const std::string gridName =
+          (level == 0 ? "Mesh" : "Level" + std::to_string(level));
+      const std::string hdfPath = hdfFile + (level == 0 ? ":/" : ":/" + gridName + "/");
+      const int nx1 = LevelCells(snap.nx1, level), nx2 = LevelCells(snap.nx2, level),
+                nx3 = LevelCells(snap.nx3, level);
+      xdmf << R"(  <Grid Name=")" << gridName << R"(" GridType="Collection">)" << '\n';
+      xdmf << R"(    <Time Value=")" << XdmfTemplate::kTime << R"("/>)" << '\n';
+      xdmf << R"(    <Information Name="Cycle" Value=")" << XdmfTemplate::kCycle
+           << R"("/>)" << '\n';
+
+      std::string blockTopology =
+          R"(      <Topology Type="3DRectMesh" NumberOfElements=")" +
+          std::to_string(nx3 + 1) + " " + std::to_string(nx2 + 1) + " " +
+          std::to_string(nx1 + 1) + R"("/>)" + '\n';
+      const std::string slabPreDim =
+          R"(        <DataItem ItemType="HyperSlab" Dimensions=")";
+      const std::string slabPreBlock2D =
+          R"("><DataItem Dimensions="3 2" NumberType="Int" Format="XML">)";
+      const std::string slabTrailer = "</DataItem>";
+
+      // Now write Grid for each block
+      dims[0] = snap.nbtotal;
+      std::string dims321 =
+          std::to_string(nx3) + " " + std::to_string(nx2) + " " + std::to_string(nx1);
+
+      int ndims = 5;
+
+      for (int ib = 0; ib < snap.nbtotal; ib++) {
+        xdmf << "    <Grid GridType=\"Uniform\" Name=\"" << ib << "\">" << '\n';
+        xdmf << blockTopology;
+        xdmf << R"(      <Geometry Type="VXVYVZ">)" << '\n';
+        xdmf << slabPreDim << nx1 + 1 << slabPreBlock2D << ib << " 0 1 1 1 " << nx1 + 1
+             << slabTrailer << '\n';
+
+        dims[1] = nx1 + 1;
+        writeXdmfArrayRef(xdmf, "          ", hdfPath + "Locations/", "x", dims, 2,
+                          "Float", sizeof(Real));
+        xdmf << "</DataItem>" << '\n';
+
+        xdmf << slabPreDim << nx2 + 1 << slabPreBlock2D << ib << " 0 1 1 1 " << nx2 + 1
+             << slabTrailer << '\n';
+
+        dims[1] = nx2 + 1;
+        writeXdmfArrayRef(xdmf, "          ", hdfPath + "Locations/", "y", dims, 2,
+                          "Float", sizeof(Real));
+        xdmf << "</DataItem>" << '\n';
+
+        xdmf << slabPreDim << nx3 + 1 << slabPreBlock2D << ib << " 0 1 1 1 " << nx3 + 1
+             << slabTrailer << '\n';
+
+        dims[1] = nx3 + 1;
+        writeXdmfArrayRef(xdmf, "          ", hdfPath + "Locations/", "z", dims, 2,
+                          "Float", sizeof(Real));
+        xdmf << "</DataItem>" << '\n';
+
+        xdmf << "      </Geometry>" << '\n';
+
+        // write graphics variables
+        dims[1] = nx3;
+        dims[2] = nx2;
+        dims[3] = nx1;
+        dims[4] = 1;
+        for (int n = 0; n < static_cast<int>(snap.names.size()); n++) {
+          const int vlen = snap.vlens[n];
+          dims[4] = vlen;
+          const std::string &name = snap.names[n];
+          writeXdmfSlabVariableRef(xdmf, name, hdfPath, ib, vlen, ndims, dims, dims321);
+        }
+        xdmf << "      </Grid>" << '\n';
+      }
+      xdmf << "    </Grid>" << '\n';
+    }
+    xdmf << "  </Domain>" << '\n';
+    xdmf << "</Xdmf>" << '\n';
+    tmpl.text = xdmf.str();
+  }
+
+  // the template with the markers filled in, in as few writes as there are markers
+  std::ostringstream time, cycle;
+  time << snap.time;
+  cycle << snap.ncycle;
+  const std::string &hdfFile = snap.filename;
   std::string filename_aux = hdfFile + ".xdmf";
-  std::ofstream xdmf;
-  MeshBlock *pmb;
-  hsize_t dims[5] = {0, 0, 0, 0, 0};
-
-  pmb = pm->pblock;
-
-  // open file
-  xdmf = std::ofstream(filename_aux.c_str(), std::ofstream::trunc);
-
-  // Write header
-  xdmf << R"(<?xml version="1.0" ?>)" << std::endl;
-  xdmf << R"(<!DOCTYPE Xdmf SYSTEM "Xdmf.dtd">)" << std::endl;
-  xdmf << R"(<Xdmf Version="3.0">)" << std::endl;
-  xdmf << "  <Domain>" << std::endl;
-  xdmf << R"(  <Grid Name="Mesh" GridType="Collection">)" << std::endl;
-  xdmf << R"(    <Time Value=")" << pm->time << R"("/>)" << std::endl;
-  xdmf << R"(    <Information Name="Cycle" Value=")" << pm->ncycle << R"("/>)"
-       << std::endl;
-
-  std::string blockTopology = R"(      <Topology Type="3DRectMesh" NumberOfElements=")" +
-                              std::to_string(nx3 + 1) + " " + std::to_string(nx2 + 1) +
-                              " " + std::to_string(nx1 + 1) + R"("/>)" + '\n';
-  const std::string slabPreDim = R"(        <DataItem ItemType="HyperSlab" Dimensions=")";
-  const std::string slabPreBlock2D =
-      R"("><DataItem Dimensions="3 2" NumberType="Int" Format="XML">)";
-  const std::string slabTrailer = "</DataItem>";
-
-  // Now write Grid for each block
-  pmb = pm->pblock;
-  dims[0] = pm->nbtotal;
-  std::string dims321 =
-      std::to_string(nx3) + " " + std::to_string(nx2) + " " + std::to_string(nx1);
-
-  int ndims = 5;
-
-  // same set of variables for all grids so use only one container
-  auto ciX = ContainerIterator<Real>(pmb->real_containers.Get(), {Metadata::Graphics});
-  for (int ib = 0; ib < pm->nbtotal; ib++) {
-    xdmf << "    <Grid GridType=\"Uniform\" Name=\"" << ib << "\">" << std::endl;
-    xdmf << blockTopology;
-    xdmf << R"(      <Geometry Type="VXVYVZ">)" << std::endl;
-    xdmf << slabPreDim << nx1 + 1 << slabPreBlock2D << ib << " 0 1 1 1 " << nx1 + 1
-         << slabTrailer << std::endl;
-
-    dims[1] = nx1 + 1;
-    writeXdmfArrayRef(xdmf, "          ", hdfFile + ":/Locations/", "x", dims, 2, "Float",
-                      8);
-    xdmf << "</DataItem>" << std::endl;
-
-    xdmf << slabPreDim << nx2 + 1 << slabPreBlock2D << ib << " 0 1 1 1 " << nx2 + 1
-         << slabTrailer << std::endl;
-
-    dims[1] = nx2 + 1;
-    writeXdmfArrayRef(xdmf, "          ", hdfFile + ":/Locations/", "y", dims, 2, "Float",
-                      8);
-    xdmf << "</DataItem>" << std::endl;
-
-    xdmf << slabPreDim << nx3 + 1 << slabPreBlock2D << ib << " 0 1 1 1 " << nx3 + 1
-         << slabTrailer << std::endl;
-
-    dims[1] = nx3 + 1;
-    writeXdmfArrayRef(xdmf, "          ", hdfFile + ":/Locations/", "z", dims, 2, "Float",
-                      8);
-    xdmf << "</DataItem>" << std::endl;
-
-    xdmf << "      </Geometry>" << std::endl;
-
-    // write graphics variables
-    dims[1] = nx3;
-    dims[2] = nx2;
-    dims[3] = nx1;
-    dims[4] = 1;
-    for (auto &v : ciX.vars) {
-      const int vlen = v->GetDim(4);
-      dims[4] = vlen;
-      std::string name = v->label();
-      writeXdmfSlabVariableRef(xdmf, name, hdfFile, ib, vlen, ndims, dims, dims321);
+  std::ofstream xdmf(filename_aux.c_str(), std::ofstream::trunc);
+  const char markers[] = {XdmfTemplate::kFile, XdmfTemplate::kTime, XdmfTemplate::kCycle,
+                          '\0'};
+  const std::string &text = tmpl.text;
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    const std::size_t next = std::min(text.find_first_of(markers, pos), text.size());
+    xdmf.write(text.data() + pos, next - pos);
+    if (next == text.size()) break;
+    if (text[next] == XdmfTemplate::kFile) {
+      xdmf << hdfFile;
+    } else if (text[next] == XdmfTemplate::kTime) {
+      xdmf << time.str();
+    } else {
+      xdmf << cycle.str();
     }
-    xdmf << "      </Grid>" << std::endl;
+    pos = next + 1;
   }
-  xdmf << "    </Grid>" << std::endl;
-  xdmf << "  </Domain>" << std::endl;
-  xdmf << "</Xdmf>" << std::endl;
   xdmf.close();
 
+  AppendToSeries(snap.series_filename, filename_aux, snap.new_series);
   return;
 }
 
-// loads a variable
-#define LOADVARIABLE(dst, pmb, var, out_is, out_ie, out_js, out_je, out_ks, out_ke)      \
-  {                                                                                      \
-    int index = 0;                                                                       \
-    while (pmb != nullptr) {                                                             \
-      for (int k = out_ks; k <= out_ke; k++) {                                           \
-        for (int j = out_js; j <= out_je; j++) {                                         \
-          for (int i = out_is; i <= out_ie; i++) {                                       \
-            tmpData[index] = var(k, j, i);                                               \
-            index++;                                                                     \
-          }                                                                              \
-        }                                                                                \
-      }                                                                                  \
-      pmb = pmb->next;                                                                   \
-    }                                                                                    \
-  }
-
 #define WRITEH5SLAB2(name, pData, theLocation, Starts, Counts, lDSpace, gDSpace, plist)  \
   {                                                                                      \
-    hid_t gDSet = H5Dcreate(theLocation, name, H5T_NATIVE_DOUBLE, gDSpace, H5P_DEFAULT,  \
+    hid_t gDSet = H5Dcreate(theLocation, name, PREDREAL, gDSpace, H5P_DEFAULT,           \
                             H5P_DEFAULT, H5P_DEFAULT);                                   \
     H5Sselect_hyperslab(gDSpace, H5S_SELECT_SET, Starts, NULL, Counts, NULL);            \
-    H5Dwrite(gDSet, H5T_NATIVE_DOUBLE, lDSpace, gDSpace, plist, pData);                  \
+    H5Dwrite(gDSet, PREDREAL, lDSpace, gDSpace, plist, pData);                           \
     H5Dclose(gDSet);                                                                     \
   }
 #define WRITEH5SLAB(name, pData, theLocation, localStart, localCount, globalCount,       \
@@ -248,17 +422,152 @@ void ATHDF5Output::genXDMF(std::string hdfFile, Mesh *pm) {
     H5Sclose(lDSpace);                                                                   \
   }
 
+//----------------------------------------------------------------------------------------
+//! \fn hid_t ATHDF5Output::CreateVariable(const Snapshot &snap, int n, hid_t file,
+//                                         hid_t gDSpace)
+//  \brief Creates the dataset of variable n.  Chunked datasets hold one MeshBlock per
+//         chunk, so every chunk is written by exactly one rank in a collective write,
+//         which is what parallel HDF5 requires for filtered datasets.
+hid_t ATHDF5Output::CreateVariable(const Snapshot &snap, int n, hid_t file,
+                                   hid_t gDSpace) {
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  if (snap.chunking || snap.compression != "none") {
+    hsize_t chunk[5] = {1, static_cast<hsize_t>(snap.nx3), static_cast<hsize_t>(snap.nx2),
+                        static_cast<hsize_t>(snap.nx1),
+                        static_cast<hsize_t>(snap.vlens[n])};
+    H5Pset_chunk(dcpl, 5, chunk);
+    // every chunk is written in full
+    H5Pset_fill_time(dcpl, H5D_FILL_TIME_NEVER);
+  }
+  if (snap.compression == "deflate") {
+    H5Pset_shuffle(dcpl);
+    H5Pset_deflate(dcpl, snap.compression_level);
+  } else if (snap.compression == "szip") {
+    H5Pset_szip(dcpl, H5_SZIP_NN_OPTION_MASK, 16);
+  } else if (snap.compression == "zfp") {
+    // fixed-accuracy mode of the H5Z-ZFP plugin; the absolute error bound is passed as
+    // a double packed into cd_values[2..3]
+    unsigned int cd_values[4] = {H5Z_ZFP_MODE_ACCURACY, 0, 0, 0};
+    const double accuracy = snap.error_bound;
+    std::memcpy(&cd_values[2], &accuracy, sizeof(double));
+    H5Pset_filter(dcpl, H5Z_FILTER_ZFP, H5Z_FLAG_MANDATORY, 4, cd_values);
+  }
+  hid_t gDSet = H5Dcreate(file, snap.names[n].c_str(), PREDREAL, gDSpace,
+                          H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  H5Pclose(dcpl);
+  return gDSet;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void ATHDF5Output::WriteInPlace(const Snapshot &snap, int n, hid_t file,
+//                                      hid_t gDSpace, hid_t plist)
+//  \brief Writes scalar variable n block by block straight from the block arrays.  The
+//         writes are collective, so ranks with fewer blocks take part with empty
+//         selections.
+void ATHDF5Output::WriteInPlace(const Snapshot &snap, int n, hid_t file, hid_t gDSpace,
+                                hid_t plist) {
+  const int max_blocks =
+      *std::max_element(snap.blocks_per_pe.begin(), snap.blocks_per_pe.end());
+  hsize_t start[5] = {0, 0, 0, 0, 0};
+  hsize_t count[5] = {1, static_cast<hsize_t>(snap.nx3), static_cast<hsize_t>(snap.nx2),
+                      static_cast<hsize_t>(snap.nx1), 1};
+  hid_t mDSpace = H5Screate_simple(3, snap.view_dims, NULL);
+  hid_t gDSet = CreateVariable(snap, n, file, gDSpace);
+  for (int b = 0; b < max_blocks; b++) {
+    const Real *pData = &snap.time; // never read through an empty selection
+    if (b < snap.num_blocks_local) {
+      start[0] = snap.block_start + b;
+      H5Sselect_hyperslab(gDSpace, H5S_SELECT_SET, start, NULL, count, NULL);
+      H5Sselect_hyperslab(mDSpace, H5S_SELECT_SET, snap.view_start, NULL, &count[1],
+                          NULL);
+      pData = snap.views[n][b];
+    } else {
+      H5Sselect_none(gDSpace);
+      H5Sselect_none(mDSpace);
+    }
+    H5Dwrite(gDSet, PREDREAL, mDSpace, gDSpace, plist, pData);
+  }
+  H5Dclose(gDSet);
+  H5Sclose(mDSpace);
+}
+
 //----------------------------------------------------------------------------------------
 //! \fn void ATHDF5Output:::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag)
 //  \brief Cycles over all MeshBlocks and writes OutputData in the Athena++ HDF5 format,
-//         one file per output using parallel IO.
+//         one file per output using parallel IO.  With <output>/async the data are
+//         staged on the host and the file is written by a background thread.
 void ATHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
-  // writes all graphics variables to hdf file
-  // HDF5 structures
-  // Also writes companion xdmf file
+  if (output_params.async_write && !AsyncWritesSupported()) {
+    if (Globals::my_rank == 0) {
+      std::cout << "### Warning in ATHDF5Output::WriteOutputFile" << std::endl
+                << "Asynchronous output requires MPI_THREAD_MULTIPLE. Output block '"
+                << output_params.block_name << "' is written synchronously." << std::endl;
+    }
+    output_params.async_write = false;
+  }
+
+  std::shared_ptr<Snapshot> snap = Stage(pm);
+
+  if (output_params.async_write) {
+    // cap the number of staged dumps held in memory
+    const std::size_t max_in_flight = std::max(output_params.max_in_flight, 1);
+    while (pending_writes.size() >= max_in_flight) {
+      pending_writes.front().get();
+      pending_writes.pop_front();
+    }
+    std::shared_future<void> previous;
+    if (!pending_writes.empty()) previous = pending_writes.back();
+    auto write = [snap, previous]() mutable {
+      if (previous.valid()) previous.wait();
+      Write(*snap, true);
+      snap.reset(); // hands the buffers back to Stage()
+    };
+    pending_writes.push_back(std::async(std::launch::async, write).share());
+  } else {
+    WaitForPendingWrites();
+    Write(*snap, false);
+  }
+
+  // advance output parameters
+  output_params.file_number++;
+  output_params.next_time += output_params.dt;
+  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+  return;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void ATHDF5Output::WaitForPendingWrites()
+//  \brief Blocks until all asynchronous dumps have been written.  Must be called before
+//         any other HDF5 use on the main thread and before MPI is finalized.
+void ATHDF5Output::WaitForPendingWrites() {
+  while (!pending_writes.empty()) {
+    std::shared_future<void> f = pending_writes.front();
+    pending_writes.pop_front();
+    f.get();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn std::shared_ptr<Snapshot> ATHDF5Output::Stage(Mesh *pm)
+//  \brief Copies the coordinates and all graphics variables of this rank's MeshBlocks
+//         into host buffers.
+std::shared_ptr<ATHDF5Output::Snapshot> ATHDF5Output::Stage(Mesh *pm) {
+  // reuse a snapshot whose buffers are no longer being written, so that the staging
+  // buffers are only allocated when the mesh grows
+  std::shared_ptr<Snapshot> snap;
+  for (auto &s : snapshots_) {
+    if (s.use_count() == 1) {
+      snap = s;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      break;
+    }
+  }
+  if (snap == nullptr) {
+    snap = std::make_shared<Snapshot>();
+    snapshots_.push_back(snap);
+  }
   MeshBlock *pmb = pm->pblock;
-  int max_blocks_global = pm->nbtotal;
-  int num_blocks_local = 0;
 
   // shooting a blank just for getting the variable names
   out_is = pmb->is;
@@ -280,36 +589,228 @@ void ATHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
     }
   }
 
-  while (pmb != nullptr) {
-    num_blocks_local++;
-    pmb = pmb->next;
-  }
-  pmb = pm->pblock;
-  // set output size
-  nx1 = pmb->block_size.nx1;
-  nx2 = pmb->block_size.nx2;
-  nx3 = pmb->block_size.nx3;
-  if (output_params.include_ghost_zones) {
-    nx1 += 2 * NGHOST;
-    if (nx2 > 1) nx2 += 2 * NGHOST;
-    if (nx3 > 1) nx3 += 2 * NGHOST;
-  }
+  // set output size; with a stride every stride-th cell is written, and each output
+  // cell spans stride cells (fewer for the last one)
+  const int stride = output_params.stride;
+  const int nx1 = (out_ie - out_is) / stride + 1;
+  const int nx2 = (out_je - out_js) / stride + 1;
+  const int nx3 = (out_ke - out_ks) / stride + 1;
+  snap->nx1 = nx1;
+  snap->nx2 = nx2;
+  snap->nx3 = nx3;
 
-  // open HDF5 file
   // Define output filename
-  filename = std::string(output_params.file_basename);
-  filename.append(".");
-  filename.append(output_params.file_id);
-  filename.append(".");
+  snap->filename = std::string(output_params.file_basename);
+  snap->filename.append(".");
+  snap->filename.append(output_params.file_id);
+  snap->filename.append(".");
   std::stringstream file_number;
   file_number << std::setw(5) << std::setfill('0') << output_params.file_number;
-  filename.append(file_number.str());
-  filename.append(".athdf");
+  snap->filename.append(file_number.str());
+  snap->filename.append(".athdf");
+  snap->series_filename = std::string(output_params.file_basename) + "." +
+                          output_params.file_id + ".xdmf";
+  snap->new_series = (output_params.file_number == 0);
+  snap->mesh_generation = pm->mesh_generation;
+  if (xdmf_ == nullptr) xdmf_ = std::make_shared<XdmfTemplate>();
+  snap->xdmf = xdmf_;
+
+  snap->time = pm->time;
+  snap->ncycle = pm->ncycle;
+  snap->ndim = pm->ndim;
+  snap->max_level = pm->current_level - pm->root_level;
+  snap->include_ghost = (output_params.include_ghost_zones ? 1 : 0);
+  snap->chunking = output_params.chunking;
+  snap->compression = output_params.compression;
+  snap->compression_level = output_params.compression_level;
+  snap->error_bound = output_params.error_bound;
+  snap->sieve_buf_size = output_params.sieve_buf_size;
+  snap->alignment_threshold = output_params.alignment_threshold;
+  snap->alignment = output_params.alignment;
+  snap->mpi_info_hints = output_params.mpi_info_hints;
+  snap->pyramid_levels = output_params.pyramid_levels;
+
+  // blocks in the output region; the others are not copied at all
+  std::vector<MeshBlock *> blocks;
+  for (pmb = pm->pblock; pmb != nullptr; pmb = pmb->next) {
+    if (BlockInOutput(pmb)) blocks.push_back(pmb);
+  }
+  int nblocks = blocks.size();
+  snap->blocks_per_pe.resize(Globals::nranks);
+#ifdef MPI_PARALLEL
+  MPI_Allgather(&nblocks, 1, MPI_INT, snap->blocks_per_pe.data(), 1, MPI_INT,
+                MPI_COMM_WORLD);
+#else
+  snap->blocks_per_pe[0] = nblocks;
+#endif
+  snap->nbtotal = 0;
+  for (int n : snap->blocks_per_pe) {
+    snap->nbtotal += n;
+  }
+  snap->num_blocks_local = nblocks;
+  snap->block_start = 0;
+  for (int i = 0; i < Globals::my_rank; i++) {
+    snap->block_start += snap->blocks_per_pe[i];
+  }
+
+  // mesh coordinates
+  snap->x.resize(snap->num_blocks_local * (nx1 + 1));
+  snap->y.resize(snap->num_blocks_local * (nx2 + 1));
+  snap->z.resize(snap->num_blocks_local * (nx3 + 1));
+  for (int b = 0; b < nblocks; b++) {
+    auto &pco = blocks[b]->pcoord;
+    for (int i = 0; i <= nx1; i++)
+      snap->x[b * (nx1 + 1) + i] = pco->x1f(std::min(out_is + i * stride, out_ie + 1));
+    for (int j = 0; j <= nx2; j++)
+      snap->y[b * (nx2 + 1) + j] = pco->x2f(std::min(out_js + j * stride, out_je + 1));
+    for (int k = 0; k <= nx3; k++)
+      snap->z[b * (nx3 + 1) + k] = pco->x3f(std::min(out_ks + k * stride, out_ke + 1));
+  }
+
+  // Scalar variables can be written straight from the block arrays when those are host
+  // accessible, no ghost zones or subsampling are requested and the write happens before
+  // the blocks change again.  Everything else is copied into one host buffer per
+  // variable.
+  const bool zero_copy =
+      output_params.zero_copy && !output_params.include_ghost_zones &&
+      !output_params.async_write && stride == 1 &&
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                 device_view_t<Real>::memory_space>::accessible;
+  if (zero_copy) Kokkos::fence();
+  snap->view_dims[0] = pm->pblock->ncells3;
+  snap->view_dims[1] = pm->pblock->ncells2;
+  snap->view_dims[2] = pm->pblock->ncells1;
+  snap->view_start[0] = out_ks;
+  snap->view_start[1] = out_js;
+  snap->view_start[2] = out_is;
+
+  // graphics variables
+  auto ciX =
+      ContainerIterator<Real>(pm->pblock->real_containers.Get(), {Metadata::Graphics});
+  const hsize_t varSize = nx3 * nx2 * nx1;
+  const int nvars = ciX.vars.size();
+  snap->names.resize(nvars);
+  snap->vlens.resize(nvars);
+  snap->data.resize(nvars);
+  snap->views.resize(nvars);
+  for (int n = 0; n < nvars; n++) { // for each variable we write
+    const std::string vWriteName = ciX.vars[n]->label();
+    const int vlen = ciX.vars[n]->GetDim(4);
+    // data is only a copy of a variable stored component innermost, which GetHostData
+    // refreshes
+    const bool in_place = (zero_copy && vlen == 1 &&
+                           !ciX.vars[n]->IsSet(Metadata::ComponentInnermost));
+    snap->names[n] = vWriteName;
+    snap->vlens[n] = vlen;
+    snap->data[n].resize(in_place ? 0 : snap->num_blocks_local * varSize * vlen);
+    snap->views[n].resize(in_place ? snap->num_blocks_local : 0);
+    std::vector<Real> &tmpData = snap->data[n];
+
+    for (int b = 0; b < nblocks; b++) { // for every block in the output
+      auto ci =
+          ContainerIterator<Real>(blocks[b]->real_containers.Get(), {Metadata::Graphics});
+      for (auto &v : ci.vars) {
+        std::string name = v->label();
+        if (name.compare(vWriteName) != 0) {
+          // skip, not interested in this variable
+          continue;
+        }
+        if (in_place) {
+          snap->views[n][b] = v->data.Get().data();
+          continue;
+        }
+        const auto &h = v->GetHostData();
+        hsize_t index = b * varSize * vlen;
+        for (int k = out_ks; k <= out_ke; k += stride) {
+          for (int j = out_js; j <= out_je; j += stride) {
+            for (int i = out_is; i <= out_ie; i += stride) {
+              for (int l = 0; l < vlen; l++, index++) {
+                tmpData[index] = h(l, k, j, i);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // the pyramid: coarse versions of every block, each level restricted from the one
+  // below on the device. The faces of a level are every 2^level-th face of the block.
+  const int nlevel = snap->pyramid_levels;
+  snap->level_x.resize(nlevel);
+  snap->level_y.resize(nlevel);
+  snap->level_z.resize(nlevel);
+  snap->level_data.resize(nlevel);
+  const int r2 = (nx2 > 1 ? 2 : 1), r3 = (nx3 > 1 ? 2 : 1);
+  for (int l = 1; l <= nlevel; l++) {
+    const int n1 = LevelCells(nx1, l), n2 = LevelCells(nx2, l), n3 = LevelCells(nx3, l);
+    const int s2 = (nx2 > 1 ? l : 0), s3 = (nx3 > 1 ? l : 0);
+    snap->level_x[l - 1].resize(nblocks * (n1 + 1));
+    snap->level_y[l - 1].resize(nblocks * (n2 + 1));
+    snap->level_z[l - 1].resize(nblocks * (n3 + 1));
+    for (int b = 0; b < nblocks; b++) {
+      for (int i = 0; i <= n1; i++)
+        snap->level_x[l - 1][b * (n1 + 1) + i] = snap->x[b * (nx1 + 1) + (i << l)];
+      for (int j = 0; j <= n2; j++)
+        snap->level_y[l - 1][b * (n2 + 1) + j] = snap->y[b * (nx2 + 1) + (j << s2)];
+      for (int k = 0; k <= n3; k++)
+        snap->level_z[l - 1][b * (n3 + 1) + k] = snap->z[b * (nx3 + 1) + (k << s3)];
+    }
+    snap->level_data[l - 1].resize(nvars);
+  }
+  for (int n = 0; n < nvars && nlevel > 0; n++) {
+    const int vlen = snap->vlens[n];
+    std::vector<ParArray4D<Real>> coarse(nlevel);
+    std::vector<typename ParArray4D<Real>::HostMirror> coarse_h(nlevel);
+    for (int l = 1; l <= nlevel; l++) {
+      coarse[l - 1] = ParArray4D<Real>("ATHDF5Output pyramid", vlen, LevelCells(nx3, l),
+                                       LevelCells(nx2, l), LevelCells(nx1, l));
+      coarse_h[l - 1] = Kokkos::create_mirror_view(coarse[l - 1]);
+      snap->level_data[l - 1][n].resize(nblocks * coarse[l - 1].size());
+    }
+    for (int b = 0; b < nblocks; b++) {
+      pmb = blocks[b];
+      ContainerIterator<Real> ci(pmb->real_containers.Get(), {Metadata::Graphics});
+      RestrictLevel(pmb, ci.vars[n]->data.Get<4>(), pmb->ks, pmb->js, pmb->is, coarse[0],
+                    r3, r2, 2);
+      for (int l = 2; l <= nlevel; l++) {
+        RestrictLevel(pmb, coarse[l - 2], 0, 0, 0, coarse[l - 1], r3, r2, 2);
+      }
+      for (int l = 1; l <= nlevel; l++) {
+        auto &h = coarse_h[l - 1];
+        Kokkos::deep_copy(h, coarse[l - 1]);
+        // (block, k, j, i, component) as the leaf data
+        std::size_t index = b * h.size();
+        for (int k = 0; k < h.extent_int(1); k++) {
+          for (int j = 0; j < h.extent_int(2); j++) {
+            for (int i = 0; i < h.extent_int(3); i++) {
+              for (int v = 0; v < vlen; v++, index++) {
+                snap->level_data[l - 1][n][index] = h(v, k, j, i);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return snap;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void ATHDF5Output::Write(const Snapshot &snap, bool async)
+//  \brief Writes a staged dump to disk.  Only touches the snapshot, so it may run on a
+//         background thread.
+void ATHDF5Output::Write(const Snapshot &snap, bool async) {
+  // writes all graphics variables to hdf file
+  // HDF5 structures
+  // Also writes companion xdmf file
+  const int nx1 = snap.nx1, nx2 = snap.nx2, nx3 = snap.nx3;
 
   hid_t file;
   hid_t acc_file = H5P_DEFAULT;
 
 #ifdef MPI_PARALLEL
+  MPI_Comm comm = (async ? async_comm : MPI_COMM_WORLD);
   /* set the file access template for parallel IO access */
   acc_file = H5Pcreate(H5P_FILE_ACCESS);
 
@@ -328,21 +829,20 @@ void ATHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
   int ierr;
   MPI_Status stat;
   ierr = MPI_Info_create(&FILE_INFO_TEMPLATE);
-  ierr = H5Pset_sieve_buf_size(acc_file, 262144);
-  ierr = H5Pset_alignment(acc_file, 524288, 262144);
+  ierr = H5Pset_sieve_buf_size(acc_file, snap.sieve_buf_size);
+  ierr = H5Pset_alignment(acc_file, snap.alignment_threshold, snap.alignment);
 
-  ierr = MPI_Info_set(FILE_INFO_TEMPLATE, "access_style", "write_once");
-  ierr = MPI_Info_set(FILE_INFO_TEMPLATE, "collective_buffering", "true");
-  ierr = MPI_Info_set(FILE_INFO_TEMPLATE, "cb_block_size", "1048576");
-  ierr = MPI_Info_set(FILE_INFO_TEMPLATE, "cb_buffer_size", "4194304");
+  // hints from the <output> block, e.g. collective buffering and Lustre striping
+  for (auto &hint : snap.mpi_info_hints) {
+    ierr = MPI_Info_set(FILE_INFO_TEMPLATE, hint.first.c_str(), hint.second.c_str());
+  }
 
   /* tell the HDF5 library that we want to use MPI-IO to do the writing */
-  ierr = H5Pset_fapl_mpio(acc_file, MPI_COMM_WORLD, FILE_INFO_TEMPLATE);
-  ierr = H5Pset_fapl_mpio(acc_file, MPI_COMM_WORLD, MPI_INFO_NULL);
+  ierr = H5Pset_fapl_mpio(acc_file, comm, FILE_INFO_TEMPLATE);
 #endif
 
   // now open the file
-  file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, acc_file);
+  file = H5Fcreate(snap.filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, acc_file);
 
   // write timestep relevant attributes
   hid_t localDSpace, myDSet;
@@ -354,24 +854,23 @@ void ATHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
   myDSet = H5Dcreate(file, "/Timestep", PREDINT32, localDSpace, H5P_DEFAULT, H5P_DEFAULT,
                      H5P_DEFAULT);
 
-  int max_level = pm->current_level - pm->root_level;
-  status = writeH5AI32("NCycle", &pm->ncycle, file, localDSpace, myDSet);
-  status = writeH5AF64("Time", &pm->time, file, localDSpace, myDSet);
-  status = writeH5AI32("NumDims", &pm->ndim, file, localDSpace, myDSet);
-  status = writeH5AI32("NumMeshBlocks", &pm->nbtotal, file, localDSpace, myDSet);
-  status = writeH5AI32("MaxLevel", &max_level, file, localDSpace, myDSet);
+  status = writeH5AI32("NCycle", &snap.ncycle, file, localDSpace, myDSet);
+  status = writeH5AReal("Time", &snap.time, file, localDSpace, myDSet);
+  status = writeH5AI32("NumDims", &snap.ndim, file, localDSpace, myDSet);
+  status = writeH5AI32("NumMeshBlocks", &snap.nbtotal, file, localDSpace, myDSet);
+  status = writeH5AI32("MaxLevel", &snap.max_level, file, localDSpace, myDSet);
   // write whether we include ghost cells or not
-  int iTmp = (output_params.include_ghost_zones ? 1 : 0);
-  status = writeH5AI32("IncludesGhost", &iTmp, file, localDSpace, myDSet);
+  status = writeH5AI32("IncludesGhost", &snap.include_ghost, file, localDSpace, myDSet);
   // write number of ghost cells in simulation
-  iTmp = NGHOST;
+  int iTmp = NGHOST;
   status = writeH5AI32("NGhost", &iTmp, file, localDSpace, myDSet);
 
   // close scalar space
   status = H5Sclose(localDSpace);
-  hsize_t nPE = Globals::nranks;
+  hsize_t nPE = snap.blocks_per_pe.size();
   localDSpace = H5Screate_simple(1, &nPE, NULL);
-  status = writeH5AI32("BlocksPerPE", pm->nblist, file, localDSpace, myDSet);
+  status =
+      writeH5AI32("BlocksPerPE", snap.blocks_per_pe.data(), file, localDSpace, myDSet);
   status = H5Sclose(localDSpace);
 
   // open vector space
@@ -386,155 +885,102 @@ void ATHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
   status = H5Sclose(localDSpace);
   status = H5Dclose(myDSet);
 
-  // allocate space for largest size variable
-  auto ciX =
-      ContainerIterator<Real>(pm->pblock->real_containers.Get(), {Metadata::Graphics});
-  size_t maxV = 3;
-  hsize_t sumDim4AllVars = 0;
-  for (auto &v : ciX.vars) {
-    const size_t vlen = v->GetDim(4);
-    sumDim4AllVars += vlen;
-    maxV = (maxV < vlen ? vlen : maxV);
-  }
-
-  Real *tmpData = new Real[(nx1 + 1) * (nx2 + 1) * (nx3 + 1) * maxV * num_blocks_local];
-  for (int i = 0; i < (nx1 + 1) * (nx2 + 1) * (nx3 + 1) * maxV * num_blocks_local; i++)
-    tmpData[i] = -1.25;
-
   // Write mesh coordinates to file
   hsize_t local_start[5], global_count[5], local_count[5];
   hid_t gLocations;
 
-  local_start[0] = 0;
+  // set starting poing in hyperslab for our blocks and
+  // number of blocks on our PE
+  local_start[0] = snap.block_start;
   local_start[1] = 0;
   local_start[2] = 0;
   local_start[3] = 0;
   local_start[4] = 0;
-  for (int i = 0; i < Globals::my_rank; i++) {
-    local_start[0] += pm->nblist[i];
-  }
   hid_t property_list = H5Pcreate(H5P_DATASET_XFER);
 #ifdef MPI_PARALLEL
   H5Pset_dxpl_mpio(property_list, H5FD_MPIO_COLLECTIVE);
 #endif
 
-  // set starting poing in hyperslab for our blocks and
-  // number of blocks on our PE
-
   // open locations tab
   gLocations = H5Gcreate(file, "/Locations", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 
   // write X coordinates
-  local_count[0] = num_blocks_local;
-  global_count[0] = max_blocks_global;
+  local_count[0] = snap.num_blocks_local;
+  global_count[0] = snap.nbtotal;
 
-  pmb = pm->pblock;
-  LOADVARIABLE(tmpData, pmb, pmb->pcoord->x1f, out_is, out_ie + 1, 0, 0, 0, 0);
   local_count[1] = global_count[1] = nx1 + 1;
-  WRITEH5SLAB("x", tmpData, gLocations, local_start, local_count, global_count,
+  WRITEH5SLAB("x", snap.x.data(), gLocations, local_start, local_count, global_count,
               property_list);
 
   // write Y coordinates
-  pmb = pm->pblock;
-  LOADVARIABLE(tmpData, pmb, pmb->pcoord->x2f, out_js, out_je + 1, 0, 0, 0, 0);
   local_count[1] = global_count[1] = nx2 + 1;
-  WRITEH5SLAB("y", tmpData, gLocations, local_start, local_count, global_count,
+  WRITEH5SLAB("y", snap.y.data(), gLocations, local_start, local_count, global_count,
               property_list);
 
   // write Z coordinates
-  pmb = pm->pblock;
-  LOADVARIABLE(tmpData, pmb, pmb->pcoord->x3f, out_ks, out_ke + 1, 0, 0, 0, 0);
   local_count[1] = global_count[1] = nx3 + 1;
-  WRITEH5SLAB("z", tmpData, gLocations, local_start, local_count, global_count,
+  WRITEH5SLAB("z", snap.z.data(), gLocations, local_start, local_count, global_count,
               property_list);
 
   // close locations tab
   H5Gclose(gLocations);
 
   // write variables
-  // create persistent spaces
-  local_count[1] = nx3;
-  local_count[2] = nx2;
-  local_count[3] = nx1;
-  local_count[4] = 1;
-
-  global_count[1] = nx3;
-  global_count[2] = nx2;
-  global_count[3] = nx1;
-  global_count[4] = 1;
-
-  hid_t local_DSpace = H5Screate_simple(5, local_count, NULL);
-  hid_t global_DSpace = H5Screate_simple(5, global_count, NULL);
-
-  // while we could do this as n variables and load all variables for
-  // a block at one time, this is memory-expensive.  I think it is
-  // well worth the multiple iterations through the blocks to load up
-  // one variable at a time.  Besides most of the time will be spent
-  // writing the HDF5 file to disk anyway...
-  // If I'm wrong about this, we can always rewrite this later.
-  // Sriram
-
-  const hsize_t varSize = nx3 * nx2 * nx1;
-
-  // this is a stupidly complicated multi-pass through the variable
-  // list, but again will revisit when the time comes to redo
-  for (auto &vwrite : ciX.vars) { // for each variable we write
-    const std::string vWriteName = vwrite->label();
-    hid_t vLocalSpace, vGlobalSpace;
-    pmb = pm->pblock;
-    const hsize_t vlen = vwrite->GetDim(4);
-    local_count[4] = global_count[4] = vlen;
-
-    if (vlen == 1) {
-      vLocalSpace = local_DSpace;
-      vGlobalSpace = global_DSpace;
+  local_count[1] = global_count[1] = nx3;
+  local_count[2] = global_count[2] = nx2;
+  local_count[3] = global_count[3] = nx1;
+
+  // for each variable we write
+  for (int n = 0; n < static_cast<int>(snap.names.size()); n++) {
+    local_count[4] = global_count[4] = snap.vlens[n];
+    hid_t vLocalSpace = H5Screate_simple(5, local_count, NULL);
+    hid_t vGlobalSpace = H5Screate_simple(5, global_count, NULL);
+    if (snap.views[n].empty()) {
+      // write dataset to file
+      hid_t gDSet = CreateVariable(snap, n, file, vGlobalSpace);
+      H5Sselect_hyperslab(vGlobalSpace, H5S_SELECT_SET, local_start, NULL, local_count,
+                          NULL);
+      H5Dwrite(gDSet, PREDREAL, vLocalSpace, vGlobalSpace, property_list,
+               snap.data[n].data());
+      H5Dclose(gDSet);
     } else {
-      vLocalSpace = H5Screate_simple(5, local_count, NULL);
-      vGlobalSpace = H5Screate_simple(5, global_count, NULL);
+      WriteInPlace(snap, n, file, vGlobalSpace, property_list);
     }
+    H5Sclose(vLocalSpace);
+    H5Sclose(vGlobalSpace);
+  }
 
-    while (pmb != nullptr) { // for every block
-      auto ci = ContainerIterator<Real>(pmb->real_containers.Get(), {Metadata::Graphics});
-      for (auto &v : ci.vars) {
-        std::string name = v->label();
-        if (name.compare(vWriteName) != 0) {
-          // skip, not interested in this variable
-          continue;
-        }
-        hsize_t index = pmb->lid * varSize * vlen;
-        if (vlen == 1) {
-          for (int k = out_ks; k <= out_ke; k++) {
-            for (int j = out_js; j <= out_je; j++) {
-              for (int i = out_is; i <= out_ie; i++, index++) {
-                tmpData[index] = (*v)(k, j, i);
-              }
-            }
-          }
-        } else { // shuffle and use new dataspace
-          for (int k = out_ks; k <= out_ke; k++) {
-            for (int j = out_js; j <= out_je; j++) {
-              for (int i = out_is; i <= out_ie; i++) {
-                for (int l = 0; l < vlen; l++, index++) {
-                  tmpData[index] = (*v)(l, k, j, i);
-                }
-              }
-            }
-          }
-        }
-      }
-      pmb = pmb->next;
-    }
-    // write dataset to file
-    WRITEH5SLAB2(vWriteName.c_str(), tmpData, file, local_start, local_count, vLocalSpace,
-                 vGlobalSpace, property_list);
-    if (vlen > 1) {
+  // coarse levels of the pyramid, each in its group with its own /Locations layout
+  for (int l = 1; l <= snap.pyramid_levels; l++) {
+    const std::string group = "/Level" + std::to_string(l);
+    hid_t gLevel = H5Gcreate(file, group.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t gLevelLocations =
+        H5Gcreate(gLevel, "Locations", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    local_count[1] = global_count[1] = LevelCells(nx1, l) + 1;
+    WRITEH5SLAB("x", snap.level_x[l - 1].data(), gLevelLocations, local_start,
+                local_count, global_count, property_list);
+    local_count[1] = global_count[1] = LevelCells(nx2, l) + 1;
+    WRITEH5SLAB("y", snap.level_y[l - 1].data(), gLevelLocations, local_start,
+                local_count, global_count, property_list);
+    local_count[1] = global_count[1] = LevelCells(nx3, l) + 1;
+    WRITEH5SLAB("z", snap.level_z[l - 1].data(), gLevelLocations, local_start,
+                local_count, global_count, property_list);
+    H5Gclose(gLevelLocations);
+
+    local_count[1] = global_count[1] = LevelCells(nx3, l);
+    local_count[2] = global_count[2] = LevelCells(nx2, l);
+    local_count[3] = global_count[3] = LevelCells(nx1, l);
+    for (int n = 0; n < static_cast<int>(snap.names.size()); n++) {
+      local_count[4] = global_count[4] = snap.vlens[n];
+      hid_t vLocalSpace = H5Screate_simple(5, local_count, NULL);
+      hid_t vGlobalSpace = H5Screate_simple(5, global_count, NULL);
+      WRITEH5SLAB2(snap.names[n].c_str(), snap.level_data[l - 1][n].data(), gLevel,
+                   local_start, local_count, vLocalSpace, vGlobalSpace, property_list);
       H5Sclose(vLocalSpace);
       H5Sclose(vGlobalSpace);
     }
+    H5Gclose(gLevel);
   }
-  // close data spaces
-  H5Sclose(local_DSpace);
-  H5Sclose(global_DSpace);
 
 #ifdef MPI_PARALLEL
   /* release the file access template */
@@ -546,14 +992,7 @@ void ATHDF5Output::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
   H5Fclose(file);
 
   // generate XDMF companion file
-  (void)genXDMF(filename, pm);
-
-  // advance output parameters
-  output_params.file_number++;
-  output_params.next_time += output_params.dt;
-  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
-  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
-  return;
+  (void)genXDMF(snap);
 }
 
 } // namespace parthenon
@@ -18,7 +18,20 @@
 //  \brief writes output data as a formatted table.  Should not be used to output large
 //  3D data sets as this format is very slow and memory intensive.  Most useful for 1D
 //  slices and/or sums.  Writes one file per Meshblock.
+//
+//  With <output>/tab_format = binary, each rank instead writes its blocks to one file,
+//  "file_basename" + ".rank" + rank + "." + "file_id" + "." + XXXXX + ".tab.bin".  The
+//  file starts with two text lines:
+//    # Parthenon binary table: time=<time> cycle=<cycle> variables=<variable>
+//    # columns: <name> <name> ...
+//  followed by one record per block of native binary values:
+//    int32 gid, nx1, nx2, nx3
+//    double x1v[nx1], x2v[nx2], x3v[nx3]
+//    double column[nx3][nx2][nx1] for each of the columns
+//  The second line is missing if the rank wrote no block.  tabBinaryExample.py reads
+//  these files.
 
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <iomanip>
@@ -26,9 +39,11 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "athena.hpp"
 #include "coordinates/coordinates.hpp"
+#include "globals.hpp"
 #include "mesh/mesh.hpp"
 #include "outputs/outputs.hpp"
 
@@ -42,8 +57,35 @@ namespace parthenon {
 void FormattedTableOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
   MeshBlock *pmb = pm->pblock;
 
+  // with tab_format = binary, one file for all blocks of this rank
+  FILE *pbinary = nullptr;
+  std::vector<double> values;
+  if (output_params.tab_format == "binary") {
+    char number[6];
+    std::snprintf(number, sizeof(number), "%05d", output_params.file_number);
+    std::string fname = output_params.file_basename + ".rank" +
+                        std::to_string(Globals::my_rank) + "." + output_params.file_id +
+                        "." + number + ".tab.bin";
+    if ((pbinary = std::fopen(fname.c_str(), "wb")) == nullptr) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in function [FormattedTableOutput::WriteOutputFile]"
+          << std::endl
+          << "Output file '" << fname << "' could not be opened" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+    std::fprintf(pbinary, "# Parthenon binary table: time=%.17g cycle=%d variables=%s\n",
+                 pm->time, pm->ncycle, output_params.variable.c_str());
+  }
+  bool columns_written = false;
+
   // Loop over MeshBlocks
   while (pmb != nullptr) {
+    // skip blocks outside the output region before loading any data
+    if (!BlockInOutput(pmb)) {
+      pmb = pmb->next;
+      continue;
+    }
+
     // set start/end array indices depending on whether ghost zones are included
     out_is = pmb->is;
     out_ie = pmb->ie;
@@ -73,6 +115,52 @@ void FormattedTableOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool f
       continue;
     } // skip if slice was out of range
 
+    if (pbinary != nullptr) {
+      if (!columns_written) {
+        // the data nodes, and so the columns, are the same for all blocks
+        std::fprintf(pbinary, "# columns:");
+        for (OutputData *pdata = pfirst_data_; pdata != nullptr; pdata = pdata->pnext) {
+          const int ncomp = pdata->data.GetDim(4);
+          for (int n = 1; n <= ncomp; ++n) {
+            if (ncomp == 1) {
+              std::fprintf(pbinary, " %s", pdata->name.c_str());
+            } else {
+              std::fprintf(pbinary, " %s%d", pdata->name.c_str(), n);
+            }
+          }
+        }
+        std::fprintf(pbinary, "\n");
+        columns_written = true;
+      }
+      // every stride-th cell with a stride
+      const int s = output_params.stride;
+      const std::int32_t dims[4] = {pmb->gid, (out_ie - out_is) / s + 1,
+                                    (out_je - out_js) / s + 1, (out_ke - out_ks) / s + 1};
+      std::fwrite(dims, sizeof(std::int32_t), 4, pbinary);
+      values.clear();
+      for (int i = out_is; i <= out_ie; i += s)
+        values.push_back(pmb->pcoord->x1v(i));
+      for (int j = out_js; j <= out_je; j += s)
+        values.push_back(pmb->pcoord->x2v(j));
+      for (int k = out_ks; k <= out_ke; k += s)
+        values.push_back(pmb->pcoord->x3v(k));
+      for (OutputData *pdata = pfirst_data_; pdata != nullptr; pdata = pdata->pnext) {
+        for (int n = 0; n < pdata->data.GetDim(4); ++n) {
+          for (int k = out_ks; k <= out_ke; k += s) {
+            for (int j = out_js; j <= out_je; j += s) {
+              for (int i = out_is; i <= out_ie; i += s) {
+                values.push_back(pdata->data(n, k, j, i));
+              }
+            }
+          }
+        }
+      }
+      std::fwrite(values.data(), sizeof(double), values.size(), pbinary);
+      ClearOutputData(); // required when LoadOutputData() is used.
+      pmb = pmb->next;
+      continue;
+    }
+
     // create filename: "file_basename"+ "."+"blockid"+"."+"file_id"+"."+XXXXX+".tab",
     // where XXXXX = 5-digit file_number
     std::string fname;
@@ -124,10 +212,11 @@ void FormattedTableOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool f
     }
     std::fprintf(pfile, "\n"); // terminate line
 
-    // loop over all cells in data arrays
-    for (int k = out_ks; k <= out_ke; ++k) {
-      for (int j = out_js; j <= out_je; ++j) {
-        for (int i = out_is; i <= out_ie; ++i) {
+    // loop over all cells in data arrays, every stride-th cell with a stride
+    const int s = output_params.stride;
+    for (int k = out_ks; k <= out_ke; k += s) {
+      for (int j = out_js; j <= out_je; j += s) {
+        for (int i = out_is; i <= out_ie; i += s) {
           // write x1, x2, x3 indices and coordinates on start of new line
           if (out_is != out_ie) {
             std::fprintf(pfile, "%04d", i);
@@ -160,6 +249,7 @@ void FormattedTableOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool f
     ClearOutputData(); // required when LoadOutputData() is used.
     pmb = pmb->next;
   } // end loop over MeshBlocks
+  if (pbinary != nullptr) std::fclose(pbinary);
 
   // increment counters
   output_params.file_number++;
@@ -18,6 +18,7 @@
 //  \brief writes history output data, volume-averaged quantities that are output
 //         frequently in time to trace their history.
 
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <iomanip>
@@ -27,13 +28,17 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "athena.hpp"
 #include "coordinates/coordinates.hpp"
 #include "globals.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "outputs/outputs.hpp"
 #include "parthenon_arrays.hpp"
+#include "utils/batched_reduction.hpp"
 
 // NEW_OUTPUT_TYPES:
 
@@ -42,17 +47,59 @@
 
 namespace parthenon {
 
+namespace {
+// reduces component n of q over the interior cells of all blocks in one kernel launch.
+// Sums are volume weighted and accumulated in double precision.  Only the scalar result
+// is copied back to the host.
+AccumReal ReduceOnDevice(const MeshBlockPack<Real> &q, const int n,
+                    const ParArray1D<DeviceCoordinates> &coords, const MeshBlock *pmb,
+                    const UserHistoryOperation op) {
+  const int nb = q.GetNBlocks() - 1;
+  const int ks = pmb->ks, ke = pmb->ke, js = pmb->js, je = pmb->je;
+  const int is = pmb->is, ie = pmb->ie;
+  AccumReal result = 0.0;
+  switch (op) {
+  case UserHistoryOperation::sum:
+    par_reduce(
+        "HistorySum", DevSpace(), 0, nb, ks, ke, js, je, is, ie,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i,
+                      AccumReal &lsum) {
+          lsum += q(b, n, k, j, i) * coords(b).Volume(k, j, i);
+        },
+        Kokkos::Sum<AccumReal>(result));
+    break;
+  case UserHistoryOperation::max:
+    par_reduce(
+        "HistoryMax", DevSpace(), 0, nb, ks, ke, js, je, is, ie,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i,
+                      AccumReal &lmax) {
+          lmax = (q(b, n, k, j, i) > lmax ? q(b, n, k, j, i) : lmax);
+        },
+        Kokkos::Max<AccumReal>(result));
+    break;
+  case UserHistoryOperation::min:
+    par_reduce(
+        "HistoryMin", DevSpace(), 0, nb, ks, ke, js, je, is, ie,
+        KOKKOS_LAMBDA(const int b, const int k, const int j, const int i,
+                      AccumReal &lmin) {
+          lmin = (q(b, n, k, j, i) < lmin ? q(b, n, k, j, i) : lmin);
+        },
+        Kokkos::Min<AccumReal>(result));
+    break;
+  }
+  return result;
+}
+} // namespace
+
 //----------------------------------------------------------------------------------------
 //! \fn void OutputType::HistoryFile()
 //  \brief Writes a history file
 
 void HistoryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
-  MeshBlock *pmb = pm->pblock;
   Real real_max = std::numeric_limits<Real>::max();
   Real real_min = std::numeric_limits<Real>::min();
-  ParArrayND<Real> vol("vol", pmb->ncells1);
   const int nhistory_output = NHISTORY_VARS + pm->nuser_history_output_;
-  std::unique_ptr<Real[]> hst_data(new Real[nhistory_output]);
+  std::unique_ptr<AccumReal[]> hst_data(new AccumReal[nhistory_output]);
   // initialize built-in variable sums to 0.0
   for (int n = 0; n < NHISTORY_VARS; ++n)
     hst_data[n] = 0.0;
@@ -71,29 +118,39 @@ void HistoryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
     }
   }
 
-  // Loop over MeshBlocks
-  while (pmb != nullptr) {
-    // Sum history variables over cells.  Note ghost cells are never included in sums
-    for (int k = pmb->ks; k <= pmb->ke; ++k) {
-      for (int j = pmb->js; j <= pmb->je; ++j) {
-        pmb->pcoord->CellVolume(k, j, pmb->is, pmb->ie, vol);
-        for (int i = pmb->is; i <= pmb->ie; ++i) {
-          // NEW_OUTPUT_TYPES:
-
-          hst_data[0] += 0.0;
-          hst_data[1] += 0.0;
-          hst_data[2] += 0.0;
-          hst_data[3] += 0.0;
-          // + partitioned KE by coordinate direction:
-          hst_data[4] += 0.0;
-          hst_data[5] += 0.0;
-          hst_data[6] += 0.0;
-        }
-      }
+  // NEW_OUTPUT_TYPES: built-in history variables are volume integrals over all cells,
+  // reduced on the device with ReduceOnDevice() and stored in hst_data[0..6] (mass,
+  // momenta and the KE partitioned by coordinate direction).  Note ghost cells are never
+  // included in sums.  None are computed yet.
+
+  // user-defined history outputs reduced on the device, one kernel per quantity over all
+  // MeshBlocks of this rank
+  ParArray1D<DeviceCoordinates> coords;
+  for (int n = 0; n < pm->nuser_history_output_; n++) {
+    if (pm->user_history_vars_[n].empty()) continue;
+    if (coords.extent(0) == 0) {
+      coords = PackCoordinatesOnMesh(pm);
     }
+    auto q = PackVariablesOnMesh(pm, "base",
+                                 std::vector<std::string>{pm->user_history_vars_[n]});
+    const int component = pm->user_history_components_[n];
+    if (component < 0 || component >= q.GetNVars()) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in function [HistoryOutput::WriteOutputFile]" << std::endl
+          << "History output '" << pm->user_history_output_names_[n]
+          << "' requests component " << component << " of variable '"
+          << pm->user_history_vars_[n] << "', which has " << q.GetNVars() << std::endl;
+      ATHENA_ERROR(msg);
+    }
+    hst_data[NHISTORY_VARS + n] =
+        ReduceOnDevice(q, component, coords, pm->pblock, pm->user_history_ops_[n]);
+  }
+
+  // Loop over MeshBlocks for the user-defined history functions evaluated on the host
+  for (MeshBlock *pmb : pm->block_list) {
     for (int n = 0; n < pm->nuser_history_output_; n++) { // user-defined history outputs
       if (pm->user_history_func_[n] != nullptr) {
-        Real usr_val = pm->user_history_func_[n](pmb, n);
+        AccumReal usr_val = pm->user_history_func_[n](pmb, n);
         switch (pm->user_history_ops_[n]) {
         case UserHistoryOperation::sum:
           // TODO(felker): this should automatically volume-weight the sum, like the
@@ -110,87 +167,55 @@ void HistoryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
         }
       }
     }
-    pmb = pmb->next;
   } // end loop over MeshBlocks
 
-#ifdef MPI_PARALLEL
-  // sum built-in/predefined hst_data[] over all ranks
-  if (Globals::my_rank == 0) {
-    MPI_Reduce(MPI_IN_PLACE, hst_data.get(), NHISTORY_VARS, MPI_ATHENA_REAL, MPI_SUM, 0,
-               MPI_COMM_WORLD);
-  } else {
-    MPI_Reduce(hst_data.get(), hst_data.get(), NHISTORY_VARS, MPI_ATHENA_REAL, MPI_SUM, 0,
-               MPI_COMM_WORLD);
-  }
-  // apply separate chosen operations to each user-defined history output
+  // reduce all columns over all ranks in one collective, each with its own operation,
+  // while the time step reduction of the mesh completes
+  BatchedReduction reduction;
+  for (int n = 0; n < NHISTORY_VARS; n++)
+    reduction.Add(hst_data[n], ReductionOp::sum);
   for (int n = 0; n < pm->nuser_history_output_; n++) {
-    Real *usr_hst_data = hst_data.get() + NHISTORY_VARS + n;
-    MPI_Op usr_op;
-    switch (pm->user_history_ops_[n]) {
-    case UserHistoryOperation::sum:
-      usr_op = MPI_SUM;
-      break;
-    case UserHistoryOperation::max:
-      usr_op = MPI_MAX;
-      break;
-    case UserHistoryOperation::min:
-      usr_op = MPI_MIN;
-      break;
-    }
-    if (Globals::my_rank == 0) {
-      MPI_Reduce(MPI_IN_PLACE, usr_hst_data, 1, MPI_ATHENA_REAL, usr_op, 0,
-                 MPI_COMM_WORLD);
-    } else {
-      MPI_Reduce(usr_hst_data, usr_hst_data, 1, MPI_ATHENA_REAL, usr_op, 0,
-                 MPI_COMM_WORLD);
-    }
+    ReductionOp op = ReductionOp::sum;
+    if (pm->user_history_ops_[n] == UserHistoryOperation::max) op = ReductionOp::max;
+    if (pm->user_history_ops_[n] == UserHistoryOperation::min) op = ReductionOp::min;
+    reduction.Add(hst_data[NHISTORY_VARS + n], op);
   }
-#endif
+  reduction.Start();
+  pm->FinishNewTimeStep(); // the file records the new time step
+  reduction.Wait();
+  for (int n = 0; n < nhistory_output; n++)
+    hst_data[n] = reduction.Get(n);
 
-  // only the master rank writes the file
-  // create filename: "file_basename" + ".hst".  There is no file number.
+  // only the master rank keeps the rows and writes them to the file
   if (Globals::my_rank == 0) {
-    std::string fname;
-    fname.assign(output_params.file_basename);
-    fname.append(".hst");
-
-    // open file for output
-    FILE *pfile;
-    std::stringstream msg;
-    if ((pfile = std::fopen(fname.c_str(), "a")) == nullptr) {
-      msg << "### FATAL ERROR in function [OutputType::HistoryFile]" << std::endl
-          << "Output file '" << fname << "' could not be opened";
-      ATHENA_ERROR(msg);
-    }
-
-    // If this is the first output, write header
+    // If this is the first output, the file starts with a header
     if (output_params.file_number == 0) {
       // NEW_OUTPUT_TYPES:
-
-      int iout = 1;
-      std::fprintf(pfile, "# Athena++ history data\n"); // descriptor is first line
-      std::fprintf(pfile, "# [%d]=time     ", iout++);
-      std::fprintf(pfile, "[%d]=dt       ", iout++);
-      std::fprintf(pfile, "[%d]=mass     ", iout++);
-      std::fprintf(pfile, "[%d]=1-mom    ", iout++);
-      std::fprintf(pfile, "[%d]=2-mom    ", iout++);
-      std::fprintf(pfile, "[%d]=3-mom    ", iout++);
-      std::fprintf(pfile, "[%d]=1-KE     ", iout++);
-      std::fprintf(pfile, "[%d]=2-KE     ", iout++);
-      std::fprintf(pfile, "[%d]=3-KE     ", iout++);
+      std::vector<std::string> columns = {"time",  "dt",   "mass", "1-mom", "2-mom",
+                                          "3-mom", "1-KE", "2-KE", "3-KE"};
+      const int nbuiltin = columns.size();
       for (int n = 0; n < pm->nuser_history_output_; n++)
-        std::fprintf(pfile, "[%d]=%-8s", iout++,
-                     pm->user_history_output_names_[n].c_str());
-      std::fprintf(pfile, "\n"); // terminate line
+        columns.push_back(pm->user_history_output_names_[n]);
+      header_ = "# Athena++ history data\n# "; // descriptor is first line
+      char column[64];
+      for (int n = 0; n < columns.size(); n++) {
+        std::snprintf(column, sizeof(column), n < nbuiltin ? "[%d]=%-8s " : "[%d]=%-8s",
+                      n + 1, columns[n].c_str());
+        header_ += column;
+      }
+      header_ += "\n"; // terminate line
     }
 
-    // write history variables
-    std::fprintf(pfile, output_params.data_format.c_str(), pm->time);
-    std::fprintf(pfile, output_params.data_format.c_str(), pm->dt);
+    ncolumns_ = 2 + nhistory_output;
+    rows_.push_back(pm->time);
+    rows_.push_back(pm->dt);
     for (int n = 0; n < nhistory_output; ++n)
-      std::fprintf(pfile, output_params.data_format.c_str(), hst_data[n]);
-    std::fprintf(pfile, "\n"); // terminate line
-    std::fclose(pfile);
+      rows_.push_back(hst_data[n]);
+    if (rows_.size() >= ncolumns_ * output_params.buffer_samples ||
+        static_cast<std::int64_t>(rows_.size() * sizeof(double)) >=
+            output_params.buffer_bytes) {
+      Flush();
+    }
   }
 
   // increment counters, clean up
@@ -201,4 +226,40 @@ void HistoryOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn void HistoryOutput::Flush()
+//  \brief Appends the buffered rows to "file_basename" + ".hst", one formatted line per
+//  row, or with hst_format = binary to "file_basename" + ".hst.bin" as raw doubles
+
+void HistoryOutput::Flush() {
+  if (rows_.empty() && header_.empty()) return;
+  const bool binary = (output_params.hst_format == "binary");
+  std::string fname;
+  fname.assign(output_params.file_basename);
+  fname.append(binary ? ".hst.bin" : ".hst");
+
+  // open file for output
+  FILE *pfile;
+  std::stringstream msg;
+  if ((pfile = std::fopen(fname.c_str(), binary ? "ab" : "a")) == nullptr) {
+    msg << "### FATAL ERROR in function [HistoryOutput::Flush]" << std::endl
+        << "Output file '" << fname << "' could not be opened";
+    ATHENA_ERROR(msg);
+  }
+  std::fputs(header_.c_str(), pfile);
+  header_.clear();
+
+  // write history variables
+  if (binary) {
+    std::fwrite(rows_.data(), sizeof(double), rows_.size(), pfile);
+  } else {
+    for (std::size_t n = 0; n < rows_.size(); n++) {
+      std::fprintf(pfile, output_params.data_format.c_str(), rows_[n]);
+      if ((n + 1) % ncolumns_ == 0) std::fprintf(pfile, "\n"); // terminate line
+    }
+  }
+  std::fclose(pfile);
+  rows_.clear();
+}
+
 } // namespace parthenon
@@ -0,0 +1,335 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file initial_data.cpp
+//  \brief maps the variables of an .athdf file written by ATHDF5Output onto the blocks
+//  of the current mesh.  The file has no logical locations, so the blocks of the file
+//  are matched to those of the mesh by the coordinates of their cell faces in
+//  /Locations, which every rank reads in full.  Each rank then selects, for every block
+//  of the file that overlaps one of its blocks, the box of cells covering all of these
+//  overlaps, and reads the union of its boxes with one collective read per variable.
+//  Each cell of the mesh is set to the average of the cells of the file it overlaps,
+//  weighted by the overlapping volume, which restricts finer data conservatively and
+//  prolongs coarser data as piecewise constant.
+
+#include "outputs/initial_data.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "athena.hpp"
+#include "coordinates/coordinates.hpp"
+#include "interface/metadata.hpp"
+#include "interface/state_descriptor.hpp"
+#include "interface/variable.hpp"
+#include "mesh/mesh.hpp"
+
+#ifdef HDF5OUTPUT
+#include <hdf5.h>
+#endif
+
+namespace parthenon {
+
+#ifdef HDF5OUTPUT
+
+namespace {
+
+// the overlap of a cell t of a block of the mesh with a cell s of a block of the file
+// along one direction, as the fraction w of cell t it covers
+struct Overlap {
+  int t, s;
+  double w;
+};
+
+// the overlaps of the cells between the increasing faces tf[0..tn] with those between
+// the increasing faces sf[0..sn]
+std::vector<Overlap> Overlaps(const double *tf, const int tn, const double *sf,
+                              const int sn) {
+  std::vector<Overlap> overlaps;
+  int t = 0, s = 0;
+  while (t < tn && s < sn) {
+    const double dx = tf[t + 1] - tf[t];
+    const double len = std::min(tf[t + 1], sf[s + 1]) - std::max(tf[t], sf[s]);
+    // cells that only share a face, up to round-off, do not overlap
+    if (len > 1.0e-12 * dx) overlaps.push_back({t, s, len / dx});
+    if (tf[t + 1] < sf[s + 1]) {
+      t++;
+    } else {
+      s++;
+    }
+  }
+  return overlaps;
+}
+
+// a block of the mesh and a block of the file that overlap, with the overlaps of their
+// cells in each direction
+struct BlockOverlap {
+  MeshBlock *pmb;
+  int source;
+  std::vector<Overlap> overlaps[3];
+};
+
+// the cells [lo, hi) of a block of the file that a rank reads, at offset in its buffer,
+// with the cells ordered with x1 fastest
+struct Box {
+  int lo[3], hi[3];
+  std::size_t offset;
+  std::size_t Size() const {
+    return static_cast<std::size_t>(hi[0] - lo[0]) * (hi[1] - lo[1]) * (hi[2] - lo[2]);
+  }
+};
+
+void ReadIntAttr(hid_t dset, const char *name, int *data) {
+  hid_t attr = H5Aopen(dset, name, H5P_DEFAULT);
+  H5Aread(attr, H5T_NATIVE_INT, data);
+  H5Aclose(attr);
+}
+
+// the components of the graphics cell variables of the packages, which every rank knows
+// whether it has blocks or not
+std::map<std::string, int> GraphicsVariables(Mesh *pm) {
+  std::map<std::string, int> vars;
+  for (auto const &pkg : pm->packages) {
+    for (auto const &field : pkg.second->AllFields()) {
+      const Metadata &m = field.second;
+      if (m.IsSet(Metadata::Graphics) && m.Where() == Metadata::Cell &&
+          !m.IsSet(Metadata::Sparse)) {
+        vars[field.first] = m.Shape().empty() ? 1 : m.Shape()[0];
+      }
+    }
+  }
+  return vars;
+}
+
+} // namespace
+
+void ReadInitialData(Mesh *pm, const std::string &filename,
+                     const std::vector<std::string> &variables) {
+  std::stringstream msg;
+  hid_t acc_file = H5Pcreate(H5P_FILE_ACCESS);
+#ifdef MPI_PARALLEL
+  H5Pset_fapl_mpio(acc_file, MPI_COMM_WORLD, MPI_INFO_NULL);
+#endif
+  hid_t fh = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, acc_file);
+  H5Pclose(acc_file);
+  if (fh < 0) {
+    msg << "### FATAL ERROR in ReadInitialData" << std::endl
+        << "Could not open initial data file " << filename << std::endl;
+    ATHENA_ERROR(msg);
+  }
+
+  int nbtotal, ndim, include_ghost, size[3];
+  hid_t info = H5Dopen(fh, "/Timestep", H5P_DEFAULT);
+  ReadIntAttr(info, "NumMeshBlocks", &nbtotal);
+  ReadIntAttr(info, "NumDims", &ndim);
+  ReadIntAttr(info, "IncludesGhost", &include_ghost);
+  ReadIntAttr(info, "MeshBlockSize", size);
+  H5Dclose(info);
+  if (ndim != pm->ndim || include_ghost != 0) {
+    msg << "### FATAL ERROR in ReadInitialData" << std::endl
+        << "Initial data file " << filename << " must hold a " << pm->ndim
+        << "D mesh written without ghost_zones" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+
+  hid_t xfer = H5Pcreate(H5P_DATASET_XFER);
+#ifdef MPI_PARALLEL
+  H5Pset_dxpl_mpio(xfer, H5FD_MPIO_COLLECTIVE);
+#endif
+
+  // the cell faces of all blocks of the file, as (block, face) in each direction
+  std::vector<double> faces[3];
+  const char *locations[3] = {"/Locations/x", "/Locations/y", "/Locations/z"};
+  for (int d = 0; d < 3; d++) {
+    faces[d].resize(static_cast<std::size_t>(nbtotal) * (size[d] + 1));
+    hid_t dset = H5Dopen(fh, locations[d], H5P_DEFAULT);
+    H5Dread(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, xfer, faces[d].data());
+    H5Dclose(dset);
+  }
+
+  // the overlapping blocks, grouped by the block of the mesh, and the box read from
+  // each block of the file, ordered as in the file
+  std::vector<BlockOverlap> overlaps;
+  std::map<int, Box> boxes;
+  std::vector<double> tf[3];
+  for (MeshBlock *pmb : pm->block_list) {
+    const int nx[3] = {pmb->block_size.nx1, pmb->block_size.nx2, pmb->block_size.nx3};
+    for (int d = 0; d < 3; d++)
+      tf[d].resize(nx[d] + 1);
+    for (int t = 0; t <= nx[0]; t++)
+      tf[0][t] = pmb->pcoord->x1f(pmb->is + t);
+    for (int t = 0; t <= nx[1]; t++)
+      tf[1][t] = pmb->pcoord->x2f(pmb->js + t);
+    for (int t = 0; t <= nx[2]; t++)
+      tf[2][t] = pmb->pcoord->x3f(pmb->ks + t);
+
+    for (int s = 0; s < nbtotal; s++) {
+      BlockOverlap overlap{pmb, s};
+      bool overlapping = true;
+      for (int d = 0; d < 3 && overlapping; d++) {
+        const double *sf = &faces[d][static_cast<std::size_t>(s) * (size[d] + 1)];
+        if (d >= ndim) {
+          // the single cell of a direction the mesh does not have
+          overlap.overlaps[d] = {{0, 0, 1.0}};
+        } else if (tf[d][nx[d]] > sf[0] && sf[size[d]] > tf[d][0]) {
+          overlap.overlaps[d] = Overlaps(tf[d].data(), nx[d], sf, size[d]);
+        }
+        overlapping = !overlap.overlaps[d].empty();
+      }
+      if (!overlapping) continue;
+      auto it = boxes.find(s);
+      if (it == boxes.end()) {
+        it = boxes.emplace(s, Box{{INT_MAX, INT_MAX, INT_MAX}, {0, 0, 0}, 0}).first;
+      }
+      for (int d = 0; d < 3; d++) {
+        for (const Overlap &o : overlap.overlaps[d]) {
+          it->second.lo[d] = std::min(it->second.lo[d], o.s);
+          it->second.hi[d] = std::max(it->second.hi[d], o.s + 1);
+        }
+      }
+      overlaps.push_back(std::move(overlap));
+    }
+  }
+  std::size_t ncells = 0;
+  for (auto &box : boxes) {
+    box.second.offset = ncells;
+    ncells += box.second.Size();
+  }
+
+  const std::map<std::string, int> graphics = GraphicsVariables(pm);
+  std::vector<std::string> names(variables);
+  if (names.empty()) {
+    for (auto const &v : graphics) {
+      if (H5Lexists(fh, v.first.c_str(), H5P_DEFAULT) > 0) names.push_back(v.first);
+    }
+  }
+
+  // the problem generator may have set the variables on the device
+  CellVariable<Real>::MarkAllDeviceModified();
+  const hid_t real_type =
+      std::is_same<Real, float>::value ? H5T_NATIVE_FLOAT : H5T_NATIVE_DOUBLE;
+  std::vector<Real> data;
+  std::vector<double> sum, weight;
+  for (const std::string &name : names) {
+    if (H5Lexists(fh, name.c_str(), H5P_DEFAULT) <= 0 ||
+        graphics.count(name) == 0) {
+      msg << "### FATAL ERROR in ReadInitialData" << std::endl
+          << "Variable " << name << " is not both in initial data file " << filename
+          << " and on the mesh" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+    hid_t dset = H5Dopen(fh, name.c_str(), H5P_DEFAULT);
+    hid_t gspace = H5Dget_space(dset);
+    hsize_t gdims[5];
+    H5Sget_simple_extent_dims(gspace, gdims, NULL);
+    const int vlen = gdims[4];
+    if (vlen != graphics.at(name)) {
+      msg << "### FATAL ERROR in ReadInitialData" << std::endl
+          << "Variable " << name << " in initial data file " << filename
+          << " has " << vlen << " components" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+
+    // HDF5 reads the union of the boxes in the order of the file, i.e., by block and
+    // then k, j, i and component, which is the order of the boxes in data
+    hsize_t mcount = std::max<std::size_t>(ncells * vlen, 1);
+    data.resize(mcount);
+    hid_t mspace = H5Screate_simple(1, &mcount, NULL);
+    H5Sselect_none(gspace);
+    if (ncells == 0) H5Sselect_none(mspace);
+    for (const auto &b : boxes) {
+      const Box &box = b.second;
+      hsize_t start[5] = {static_cast<hsize_t>(b.first), static_cast<hsize_t>(box.lo[2]),
+                          static_cast<hsize_t>(box.lo[1]),
+                          static_cast<hsize_t>(box.lo[0]), 0};
+      hsize_t count[5] = {1, static_cast<hsize_t>(box.hi[2] - box.lo[2]),
+                          static_cast<hsize_t>(box.hi[1] - box.lo[1]),
+                          static_cast<hsize_t>(box.hi[0] - box.lo[0]), gdims[4]};
+      H5Sselect_hyperslab(gspace, H5S_SELECT_OR, start, NULL, count, NULL);
+    }
+    H5Dread(dset, real_type, mspace, gspace, xfer, data.data());
+    H5Sclose(mspace);
+    H5Sclose(gspace);
+    H5Dclose(dset);
+
+    for (std::size_t p = 0; p < overlaps.size();) {
+      MeshBlock *pmb = overlaps[p].pmb;
+      const int n1 = pmb->block_size.nx1, n2 = pmb->block_size.nx2;
+      const std::size_t nt = static_cast<std::size_t>(pmb->block_size.nx3) * n2 * n1;
+      sum.assign(nt * vlen, 0.0);
+      weight.assign(nt, 0.0);
+      for (; p < overlaps.size() && overlaps[p].pmb == pmb; p++) {
+        const BlockOverlap &overlap = overlaps[p];
+        const Box &box = boxes.at(overlap.source);
+        const int ni = box.hi[0] - box.lo[0], nj = box.hi[1] - box.lo[1];
+        for (const Overlap &ok : overlap.overlaps[2]) {
+          for (const Overlap &oj : overlap.overlaps[1]) {
+            for (const Overlap &oi : overlap.overlaps[0]) {
+              const double w = ok.w * oj.w * oi.w;
+              const std::size_t t =
+                  (static_cast<std::size_t>(ok.t) * n2 + oj.t) * n1 + oi.t;
+              const std::size_t s =
+                  box.offset +
+                  (static_cast<std::size_t>(ok.s - box.lo[2]) * nj + oj.s - box.lo[1]) *
+                      ni +
+                  oi.s - box.lo[0];
+              weight[t] += w;
+              for (int l = 0; l < vlen; l++) {
+                sum[t * vlen + l] += w * data[s * vlen + l];
+              }
+            }
+          }
+        }
+      }
+
+      CellVariable<Real> &v = pmb->real_containers.Get().Get(name);
+      auto &h = v.GetHostData();
+      std::size_t t = 0;
+      for (int k = pmb->ks; k <= pmb->ke; k++) {
+        for (int j = pmb->js; j <= pmb->je; j++) {
+          for (int i = pmb->is; i <= pmb->ie; i++, t++) {
+            if (weight[t] <= 0.0) continue;
+            for (int l = 0; l < vlen; l++) {
+              h(l, k, j, i) = sum[t * vlen + l] / weight[t];
+            }
+          }
+        }
+      }
+      v.MarkHostModified();
+      v.SyncToDevice();
+    }
+  }
+
+  H5Pclose(xfer);
+  H5Fclose(fh);
+}
+
+#else // HDF5OUTPUT
+
+void ReadInitialData(Mesh *pm, const std::string &filename,
+                     const std::vector<std::string> &variables) {
+  throw std::runtime_error(std::string(__func__) + " requires HDF5 output support");
+}
+
+#endif // HDF5OUTPUT
+
+} // namespace parthenon
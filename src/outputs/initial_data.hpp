@@ -0,0 +1,40 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_INITIAL_DATA_HPP_
+#define OUTPUTS_INITIAL_DATA_HPP_
+//! \file initial_data.hpp
+//  \brief sets the initial conditions from an HDF5 output (.athdf) of another run
+
+#include <string>
+#include <vector>
+
+namespace parthenon {
+
+class Mesh;
+
+//----------------------------------------------------------------------------------------
+//! \fn void ReadInitialData(Mesh *pm, const std::string &filename,
+//                           const std::vector<std::string> &variables)
+//  \brief overwrites the variables of all blocks of pm with the conservative average of
+//  the cells of the file that overlap their cells, so the file may come from a mesh
+//  with a different decomposition or refinement. Each rank reads only the cells that
+//  overlap its blocks, with one collective read per variable. Without variables, all
+//  graphics variables of the blocks that are in the file are read. Cells outside of
+//  the blocks of the file keep their values. Collective; requires HDF5 output support.
+
+void ReadInitialData(Mesh *pm, const std::string &filename,
+                     const std::vector<std::string> &variables);
+
+} // namespace parthenon
+
+#endif // OUTPUTS_INITIAL_DATA_HPP_
@@ -0,0 +1,32 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file insitu_analysis.cpp
+//  \brief driver side of the in-situ analysis plugins
+
+#include "outputs/insitu_analysis.hpp"
+
+#include "mesh/mesh.hpp"
+
+namespace parthenon {
+
+void InSituAnalysis::ExecuteIfDue(Mesh *pm) {
+  if (interval_ <= 0 || pm->ncycle % interval_ != 0) return;
+  if (!pack_valid_ || pack_generation_ != pm->mesh_generation) {
+    pack_ = PackVariablesOnMesh(pm, "base", variables_);
+    pack_generation_ = pm->mesh_generation;
+    pack_valid_ = true;
+  }
+  Execute(pm, pack_);
+}
+
+} // namespace parthenon
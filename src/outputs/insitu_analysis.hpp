@@ -0,0 +1,63 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_INSITU_ANALYSIS_HPP_
+#define OUTPUTS_INSITU_ANALYSIS_HPP_
+//! \file insitu_analysis.hpp
+//  \brief interface of in-situ analysis plugins, which get device views of the state
+//         instead of reading it back from disk dumps
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+#include "interface/meshblock_pack.hpp"
+
+namespace parthenon {
+
+class Mesh;
+
+//----------------------------------------------------------------------------------------
+//! \class InSituAnalysis
+//  \brief Base class of in-situ analysis plugins, e.g. adaptors to Catalyst or Ascent.
+//  Plugins are enrolled with Mesh::EnrollInSituAnalysis() and called by the evolution
+//  driver every interval cycles with a MeshBlockPack of the requested variables in the
+//  "base" container of all MeshBlocks of the rank. The pack refers to the device arrays
+//  of the blocks, so nothing is copied; it is valid until the next call.
+
+class InSituAnalysis {
+ public:
+  InSituAnalysis(const std::vector<std::string> &variables, const int interval)
+      : variables_(variables), interval_(interval) {}
+  virtual ~InSituAnalysis() = default;
+
+  // q holds all components of the variables, in the order they were requested
+  virtual void Execute(Mesh *pm, const MeshBlockPack<Real> &q) = 0;
+
+  const std::vector<std::string> &GetVariables() const { return variables_; }
+  int GetInterval() const { return interval_; }
+  // runs the analysis if the current cycle is due; called by the driver
+  void ExecuteIfDue(Mesh *pm);
+
+ private:
+  std::vector<std::string> variables_;
+  int interval_;
+  // the pack is rebuilt only when the blocks of the rank changed
+  MeshBlockPack<Real> pack_;
+  std::uint64_t pack_generation_ = 0;
+  bool pack_valid_ = false;
+};
+
+} // namespace parthenon
+
+#endif // OUTPUTS_INSITU_ANALYSIS_HPP_
@@ -59,16 +59,9 @@
 // OutputData node as an HDF5 "variable" inside an existing HDF5 "dataset" (cell-centered
 // vs. face-centered data).
 
-// - restart.cpp, RestartOutput::WriteOutputFile(): memcpy array of quantity to pdata
-// pointer and increment the pointer. pdata points to an allocated region of memory whose
-// "datasize" is inferred from MeshBlock::GetBlockSizeInBytes(), ---->
-
-// - mesh/meshblock.cpp, MeshBlock::GetBlockSizeInBytes(): increment std::size_t size by
-// the size of the new quantity's array(s)
-
-// - mesh/meshblock.cpp, MeshBlock restart constructor: memcpy quantity (IN THE SAME ORDER
-// AS THE VARIABLES ARE WRITTEN IN restart.cpp) from the loaded .rst file to the
-// MeshBlock's appropriate physics member object
+// - restart.cpp, RestartOutput::WriteOutputFile(): nothing to do for cell-centered
+// variables flagged Metadata::Independent, which are written automatically and read back
+// by the Mesh restart constructor in mesh/mesh.cpp
 
 // - history.cpp, HistoryOutput::WriteOutputFile() (3x places): 1) modify NHISTORY_VARS
 // macro so that the size of data_sum[] can accommodate the new physics, when active.
@@ -88,20 +81,27 @@
 
 #include "outputs/outputs.hpp"
 
+#include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "athena.hpp"
 #include "coordinates/coordinates.hpp"
+#include "interface/container.hpp"
+#include "interface/variable.hpp"
 #include "mesh/mesh.hpp"
 #include "parameter_input.hpp"
 #include "parthenon_arrays.hpp"
+#include "utils/profiling.hpp"
 
 namespace parthenon {
 
@@ -216,6 +216,44 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin) {
           ATHENA_ERROR(msg);
         }
 
+        // read region of interest.  Blocks not intersecting it are skipped entirely.
+        op.region = pm->mesh_size;
+        for (auto &bound : std::vector<std::pair<std::string, Real *>>{
+                 {"x1min", &op.region.x1min},
+                 {"x1max", &op.region.x1max},
+                 {"x2min", &op.region.x2min},
+                 {"x2max", &op.region.x2max},
+                 {"x3min", &op.region.x3min},
+                 {"x3max", &op.region.x3max}}) {
+          if (pin->DoesParameterExist(op.block_name, "region_" + bound.first)) {
+            *bound.second = pin->GetReal(op.block_name, "region_" + bound.first);
+            op.output_region = true;
+          }
+        }
+        if (op.region.x1min > op.region.x1max || op.region.x2min > op.region.x2max ||
+            op.region.x3min > op.region.x3max ||
+            op.region.x1min > pm->mesh_size.x1max ||
+            op.region.x1max < pm->mesh_size.x1min ||
+            op.region.x2min > pm->mesh_size.x2max ||
+            op.region.x2max < pm->mesh_size.x2min ||
+            op.region.x3min > pm->mesh_size.x3max ||
+            op.region.x3max < pm->mesh_size.x3min) {
+          msg << "### FATAL ERROR in Outputs constructor" << std::endl
+              << "Output region in output block '" << op.block_name
+              << "' is empty or out of range of Mesh" << std::endl;
+          ATHENA_ERROR(msg);
+        }
+
+        // read subsampling options: a single refinement level and/or every Nth cell
+        op.output_level = pin->GetOrAddInteger(op.block_name, "level", -1);
+        op.stride = pin->GetOrAddInteger(op.block_name, "stride", 1);
+        if (op.stride < 1) {
+          msg << "### FATAL ERROR in Outputs constructor" << std::endl
+              << "stride=" << op.stride << " in output block '" << op.block_name
+              << "' must be positive" << std::endl;
+          ATHENA_ERROR(msg);
+        }
+
         // read ghost cell option
         op.include_ghost_zones =
             pin->GetOrAddBoolean(op.block_name, "ghost_zones", false);
@@ -233,24 +271,133 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin) {
         // Construct new OutputType according to file format
         // NEW_OUTPUT_TYPES: Add block to construct new types here
         if (op.file_type.compare("hst") == 0) {
+          op.hst_format = pin->GetOrAddString(op.block_name, "hst_format", "text");
+          if (op.hst_format != "text" && op.hst_format != "binary") {
+            msg << "### FATAL ERROR in Outputs constructor" << std::endl
+                << "Unknown hst_format '" << op.hst_format << "' in output block '"
+                << op.block_name << "'" << std::endl;
+            ATHENA_ERROR(msg);
+          }
+          op.buffer_samples = pin->GetOrAddInteger(op.block_name, "buffer_samples", 1);
+          op.buffer_bytes = pin->GetOrAddInteger(op.block_name, "buffer_bytes", 1048576);
           pnew_type = new HistoryOutput(op);
           num_hst_outputs++;
         } else if (op.file_type.compare("tab") == 0) {
+          op.tab_format = pin->GetOrAddString(op.block_name, "tab_format", "text");
+          if (op.tab_format != "text" && op.tab_format != "binary") {
+            msg << "### FATAL ERROR in Outputs constructor" << std::endl
+                << "Unknown tab_format '" << op.tab_format << "' in output block '"
+                << op.block_name << "'" << std::endl;
+            ATHENA_ERROR(msg);
+          }
           pnew_type = new FormattedTableOutput(op);
         } else if (op.file_type.compare("vtk") == 0) {
+          op.vtk_format = pin->GetOrAddString(op.block_name, "vtk_format", "legacy");
+          if (op.vtk_format != "legacy" && op.vtk_format != "pvtu") {
+            msg << "### FATAL ERROR in Outputs constructor" << std::endl
+                << "Unknown vtk_format '" << op.vtk_format << "' in output block '"
+                << op.block_name << "'" << std::endl;
+            ATHENA_ERROR(msg);
+          }
           pnew_type = new VTKOutput(op);
         } else if (op.file_type.compare("rst") == 0) {
+          if (pin->DoesParameterExist(op.block_name, "stage_dir")) {
+            op.stage_dir = pin->GetString(op.block_name, "stage_dir");
+          }
+          op.full_interval = pin->GetOrAddInteger(op.block_name, "full_interval", 1);
+          op.delta_tolerance = pin->GetOrAddReal(op.block_name, "delta_tolerance", 0.0);
           pnew_type = new RestartOutput(op);
           num_rst_outputs++;
         } else if (op.file_type.compare("ath5") == 0 ||
                    op.file_type.compare("hdf5") == 0) {
 #ifdef HDF5OUTPUT
+          op.async_write = pin->GetOrAddBoolean(op.block_name, "async", false);
+          op.max_in_flight = pin->GetOrAddInteger(op.block_name, "max_in_flight", 2);
+          op.zero_copy = pin->GetOrAddBoolean(op.block_name, "zero_copy", false);
+          op.pyramid_levels = pin->GetOrAddInteger(op.block_name, "pyramid_levels", 0);
+          if (op.pyramid_levels > 0) {
+            // every level halves the interior cells of the blocks
+            const std::array<int, 3> bs = pm->GetBlockCells();
+            const int nx = 1 << op.pyramid_levels;
+            if (op.include_ghost_zones || op.stride > 1 || bs[0] % nx != 0 ||
+                (bs[1] > 1 && bs[1] % nx != 0) || (bs[2] > 1 && bs[2] % nx != 0)) {
+              msg << "### FATAL ERROR in Outputs constructor" << std::endl
+                  << "pyramid_levels=" << op.pyramid_levels << " in output block '"
+                  << op.block_name << "' requires blocks with a multiple of " << nx
+                  << " cells in each direction and no ghost_zones or stride"
+                  << std::endl;
+              ATHENA_ERROR(msg);
+            }
+          }
+          op.chunking = pin->GetOrAddBoolean(op.block_name, "chunking", op.chunking);
+          op.compression =
+              pin->GetOrAddString(op.block_name, "compression", op.compression);
+          op.compression_level = pin->GetOrAddInteger(op.block_name, "compression_level",
+                                                      op.compression_level);
+          op.error_bound =
+              pin->GetOrAddReal(op.block_name, "error_bound", op.error_bound);
+          op.sieve_buf_size =
+              pin->GetOrAddInteger(op.block_name, "sieve_buf_size", op.sieve_buf_size);
+          op.alignment_threshold = pin->GetOrAddInteger(
+              op.block_name, "alignment_threshold", op.alignment_threshold);
+          op.alignment = pin->GetOrAddInteger(op.block_name, "alignment", op.alignment);
+          // MPI_Info hints; those without a default are only passed on when given
+          for (auto &hint : std::vector<std::pair<std::string, std::string>>{
+                   {"access_style", "write_once"},
+                   {"collective_buffering", "true"},
+                   {"cb_block_size", "1048576"},
+                   {"cb_buffer_size", "4194304"},
+                   {"cb_nodes", ""},
+                   {"romio_cb_write", ""},
+                   {"romio_ds_write", ""},
+                   {"striping_factor", ""},
+                   {"striping_unit", ""}}) {
+            if (!hint.second.empty()) {
+              hint.second = pin->GetOrAddString(op.block_name, hint.first, hint.second);
+            } else if (pin->DoesParameterExist(op.block_name, hint.first)) {
+              hint.second = pin->GetString(op.block_name, hint.first);
+            }
+            if (!hint.second.empty()) op.mpi_info_hints.push_back(hint);
+          }
+          H5Z_filter_t filter = H5Z_FILTER_NONE;
+          if (op.compression == "deflate") {
+            filter = H5Z_FILTER_DEFLATE;
+          } else if (op.compression == "szip") {
+            filter = H5Z_FILTER_SZIP;
+          } else if (op.compression == "zfp") {
+            filter = H5Z_FILTER_ZFP;
+          } else if (op.compression != "none") {
+            msg << "### FATAL ERROR in Outputs constructor" << std::endl
+                << "Unknown compression '" << op.compression << "' in output block '"
+                << op.block_name << "'" << std::endl;
+            ATHENA_ERROR(msg);
+          }
+          if (filter != H5Z_FILTER_NONE && H5Zfilter_avail(filter) <= 0) {
+            msg << "### FATAL ERROR in Outputs constructor" << std::endl
+                << "HDF5 filter for compression '" << op.compression
+                << "' is not available (output block '" << op.block_name << "')"
+                << std::endl;
+            ATHENA_ERROR(msg);
+          }
           pnew_type = new ATHDF5Output(op);
 #else
           msg << "### FATAL ERROR in Outputs constructor" << std::endl
               << "Executable not configured for HDF5 outputs, but HDF5 file format "
               << "is requested in output block '" << op.block_name << "'" << std::endl;
           ATHENA_ERROR(msg);
+#endif
+        } else if (op.file_type.compare("adios2") == 0) {
+#ifdef ENABLE_ADIOS2
+          op.adios2_engine = pin->GetOrAddString(op.block_name, "engine", "BP5");
+          if (pin->DoesParameterExist(op.block_name, "engine_parameters")) {
+            op.adios2_parameters = pin->GetString(op.block_name, "engine_parameters");
+          }
+          pnew_type = new ADIOS2Output(op);
+#else
+          msg << "### FATAL ERROR in Outputs constructor" << std::endl
+              << "Executable not configured for ADIOS2 outputs, but ADIOS2 file format "
+              << "is requested in output block '" << op.block_name << "'" << std::endl;
+          ATHENA_ERROR(msg);
 #endif
         } else {
           msg << "### FATAL ERROR in Outputs constructor" << std::endl
@@ -315,10 +462,15 @@ Outputs::Outputs(Mesh *pm, ParameterInput *pin) {
 // destructor - iterates through singly linked list of OutputTypes and deletes nodes
 
 Outputs::~Outputs() {
+#ifdef HDF5OUTPUT
+  ATHDF5Output::WaitForPendingWrites();
+#endif
+  RestartOutput::WaitForPendingCopies();
   OutputType *ptype = pfirst_type_;
   while (ptype != nullptr) {
     OutputType *ptype_old = ptype;
     ptype = ptype->pnext_type;
+    ptype_old->Flush();
     delete ptype_old;
   }
 }
@@ -393,19 +545,114 @@ void OutputType::ClearOutputData() {
 //  \brief scans through singly linked list of OutputTypes and makes any outputs needed.
 
 void Outputs::MakeOutputs(Mesh *pm, ParameterInput *pin, bool wtflag) {
-  bool first = true;
+  // the outputs of one call share the host copies of the variables. The copy-out tasks
+  // of the last stage made them already if they ran on all blocks and the mesh did not
+  // change since.
+  bool copied_out = (copy_generation_ == pm->mesh_generation);
+  for (MeshBlock *pmb : pm->block_list) {
+    copied_out = copied_out && (pmb->output_copy_cycle == pm->ncycle);
+  }
+  if (!copied_out) CellVariable<Real>::MarkAllDeviceModified();
+  bool first = true, restart_written = false;
   OutputType *ptype = pfirst_type_;
   while (ptype != nullptr) {
     if ((pm->time == pm->start_time) || (pm->time >= ptype->output_params.next_time) ||
         (pm->time >= pm->tlim) || (wtflag && ptype->output_params.file_type == "rst")) {
-      if (first && ptype->output_params.file_type != "hst") {
-        pm->ApplyUserWorkBeforeOutput(pin);
+      if (first && ptype->output_params.file_type != "hst" && !copied_out) {
+        for (MeshBlock *pmb : pm->block_list) {
+          // the copy-out task already did this for the blocks it handled
+          if (pmb->output_copy_cycle != pm->ncycle) pmb->UserWorkBeforeOutput(pin);
+          pmb->real_containers.Get().on_demand_current = false;
+        }
+        CellVariable<Real>::MarkAllDeviceModified();
         first = false;
       }
+      FillDerivedVariables::FillOnDemand(pm);
+      ProfilingRegion region("OutputType::WriteOutputFile " +
+                             ptype->output_params.block_name);
       ptype->WriteOutputFile(pm, pin, wtflag);
+      if (ptype->output_params.file_type == "rst") restart_written = true;
     }
     ptype = ptype->pnext_type; // move to next OutputType node in signly linked list
   }
+  // a run restarted from this file continues the buffered outputs where they stop now
+  if (restart_written) {
+    for (ptype = pfirst_type_; ptype != nullptr; ptype = ptype->pnext_type)
+      ptype->Flush();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn TaskID Outputs::AddOutputTasks(TaskList &tl, TaskID dep, MeshBlock *pmb,
+//                                     ParameterInput *pin)
+//  \brief adds the copy-out task of pmb to tl, see outputs.hpp
+
+TaskID Outputs::AddOutputTasks(TaskList &tl, TaskID dep, MeshBlock *pmb,
+                               ParameterInput *pin) {
+  // the task lists are built before the step, so this is the generation they run in
+  copy_generation_ = pmb->pmy_mesh->mesh_generation;
+  return tl.AddTask<BlockTask>(
+      TaskName("CopyOutputData"),
+      [this, pin](MeshBlock *pmb) { return CopyOutputData(pmb, pin); }, dep, pmb);
+}
+
+TaskStatus Outputs::CopyOutputData(MeshBlock *pmb, ParameterInput *pin) {
+  Mesh *pm = pmb->pmy_mesh;
+  // the driver advances the time after the step, and makes the outputs at the final
+  // time only after the loop
+  const AccumReal time = pm->time + pm->dt;
+  if (time >= pm->tlim || !OutputDataDue(pm, time)) return TaskStatus::complete;
+
+  pmb->UserWorkBeforeOutput(pin);
+  Container<Real> &rc = pmb->real_containers.Get();
+  rc.on_demand_current = false;
+  FillDerivedVariables::FillOnDemand(rc);
+  // all variables, since MakeOutputs does not mark any host copy stale then
+  auto copy = [](const std::shared_ptr<CellVariable<Real>> &v) {
+    v->MarkDeviceModified();
+    v->GetHostData();
+  };
+  for (auto &v : rc.GetCellVariableVector()) {
+    copy(v);
+  }
+  for (auto &sv : rc.GetSparseVector()) {
+    for (auto &v : sv->GetVector()) {
+      copy(v);
+    }
+  }
+  pmb->output_copy_cycle = pm->ncycle + 1;
+  return TaskStatus::complete;
+}
+
+bool Outputs::OutputDataDue(Mesh *pm, const AccumReal time) const {
+  for (OutputType *ptype = pfirst_type_; ptype != nullptr; ptype = ptype->pnext_type) {
+    if (ptype->output_params.file_type == "hst") continue;
+    if (time >= ptype->output_params.next_time || time >= pm->tlim) return true;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn bool OutputType::BlockInOutput(MeshBlock *pmb) const
+//  \brief returns false if the MeshBlock lies outside the output region or is not on the
+//  requested output level, in which case it is skipped before any data is copied
+
+bool OutputType::BlockInOutput(MeshBlock *pmb) const {
+  if (output_params.output_level >= 0 &&
+      pmb->loc.level - pmb->pmy_mesh->GetRootLevel() != output_params.output_level) {
+    return false;
+  }
+  if (!output_params.output_region) return true;
+  // a region without extent in some direction (e.g. a plane) selects the blocks
+  // containing it, otherwise blocks only touching the region are excluded
+  auto overlaps = [](Real bmin, Real bmax, Real rmin, Real rmax) {
+    return (rmin == rmax) ? (bmin <= rmin && rmin <= bmax) : (bmax > rmin && bmin < rmax);
+  };
+  const RegionSize &r = output_params.region;
+  const RegionSize &b = pmb->block_size;
+  return overlaps(b.x1min, b.x1max, r.x1min, r.x1max) &&
+         overlaps(b.x2min, b.x2max, r.x2min, r.x2max) &&
+         overlaps(b.x3min, b.x3max, r.x3min, r.x3max);
 }
 
 //----------------------------------------------------------------------------------------
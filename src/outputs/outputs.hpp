@@ -19,16 +19,34 @@
 //! \file outputs.hpp
 //  \brief provides classes to handle ALL types of data output
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "athena.hpp"
 #include "io_wrapper.hpp"
 #include "parthenon_arrays.hpp"
+#include "task_list/tasks.hpp"
+
+#ifdef HDF5OUTPUT
+#include <hdf5.h>
+
+// registered HDF5 filter id and fixed-accuracy mode of the H5Z-ZFP plugin
+#define H5Z_FILTER_ZFP 32013
+#define H5Z_ZFP_MODE_ACCURACY 3
+#endif
+
+#ifdef ENABLE_ADIOS2
+#include <adios2.h>
+#endif
 
 namespace parthenon {
 
 // forward declarations
 class Mesh;
+class MeshBlock;
 class ParameterInput;
 class Coordinates;
 
@@ -44,11 +62,43 @@ struct OutputParameters {
   std::string variable;
   std::string file_type;
   std::string data_format;
-  Real next_time, dt;
+  AccumReal next_time, dt; // compared with Mesh::time, so kept in its precision
   int file_number;
   bool output_slicex1, output_slicex2, output_slicex3;
   bool output_sumx1, output_sumx2, output_sumx3;
   bool include_ghost_zones, cartesian_vector;
+  bool async_write;  // write from a background thread (HDF5 only)
+  int max_in_flight; // maximum number of staged asynchronous dumps
+  bool zero_copy;    // write scalar variables straight from the block arrays
+  int pyramid_levels; // coarse levels of every block written in addition (HDF5 only)
+  // restart files are written here, e.g. to a burst buffer, and then copied to the run
+  // directory in the background; empty to write to the run directory
+  std::string stage_dir;
+  // every full_interval-th restart file holds all blocks, the ones in between only those
+  // changed by more than delta_tolerance since they were last written
+  int full_interval;
+  Real delta_tolerance;
+  std::string vtk_format;  // legacy (one file per block) or pvtu (one file per rank)
+  std::string tab_format;  // text (one file per block) or binary (one file per rank)
+  // history rows are kept until buffer_samples of them or buffer_bytes are buffered and
+  // then appended as text (.hst) or binary (.hst.bin) according to hst_format
+  std::string hst_format;
+  int buffer_samples;
+  std::int64_t buffer_bytes;
+  // ADIOS2 engine (BP5, SST, ...) and its parameters as "key=value, key=value"
+  std::string adios2_engine, adios2_parameters;
+  bool chunking;           // one MeshBlock per HDF5 chunk
+  std::string compression; // HDF5 filter: none, deflate, szip or zfp
+  int compression_level;   // deflate level
+  Real error_bound;        // absolute error bound of lossy filters
+  // MPI-IO tuning of HDF5 outputs
+  int sieve_buf_size, alignment_threshold, alignment;
+  std::vector<std::pair<std::string, std::string>> mpi_info_hints;
+  // region of interest and subsampling: MeshBlocks outside the region or not on
+  // output_level (if >= 0) are skipped, and every stride-th cell is written
+  bool output_region;
+  RegionSize region;
+  int output_level, stride;
   int islice, jslice, kslice;
   Real x1_slice, x2_slice, x3_slice;
   // TODO(felker): some of the parameters in this class are not initialized in constructor
@@ -56,7 +106,13 @@ struct OutputParameters {
       : block_number(0), next_time(0.0), dt(0.0), file_number(0), output_slicex1(false),
         output_slicex2(false), output_slicex3(false), output_sumx1(false),
         output_sumx2(false), output_sumx3(false), include_ghost_zones(false),
-        cartesian_vector(false), islice(0), jslice(0), kslice(0) {}
+        cartesian_vector(false), async_write(false), max_in_flight(2),
+        zero_copy(false), pyramid_levels(0), full_interval(1), delta_tolerance(0.0),
+        vtk_format("legacy"), tab_format("text"), hst_format("text"), buffer_samples(1),
+        buffer_bytes(1048576), chunking(false), compression("none"), compression_level(1),
+        error_bound(1.0e-6), sieve_buf_size(262144), alignment_threshold(524288),
+        alignment(262144), output_region(false), region(), output_level(-1), stride(1),
+        islice(0), jslice(0), kslice(0) {}
 };
 
 //----------------------------------------------------------------------------------------
@@ -103,6 +159,7 @@ class OutputType {
   void AppendOutputDataNode(OutputData *pdata);
   void ReplaceOutputDataNode(OutputData *pold, OutputData *pnew);
   void ClearOutputData();
+  bool BlockInOutput(MeshBlock *pmb) const;
   bool TransformOutputData(MeshBlock *pmb);
   bool SliceOutputData(MeshBlock *pmb, int dim);
   void SumOutputData(MeshBlock *pmb, int dim);
@@ -111,6 +168,8 @@ class OutputType {
   // following pure virtual function must be implemented in all derived classes
   virtual void WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) = 0;
   virtual void WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) { return; }
+  // writes out data an output type buffers between calls
+  virtual void Flush() {}
 
  protected:
   int num_vars_; // number of variables in output
@@ -127,6 +186,14 @@ class HistoryOutput : public OutputType {
  public:
   explicit HistoryOutput(OutputParameters oparams) : OutputType(oparams) {}
   void WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) override;
+  void Flush() override;
+
+ private:
+  // on rank 0, the rows (time, dt, history variables) sampled since the last flush and
+  // the header of the file until it is written
+  std::vector<double> rows_;
+  std::size_t ncolumns_ = 0;
+  std::string header_;
 };
 
 //----------------------------------------------------------------------------------------
@@ -148,6 +215,12 @@ class VTKOutput : public OutputType {
   explicit VTKOutput(OutputParameters oparams) : OutputType(oparams) {}
   void WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) override;
   void WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) override;
+
+ private:
+  void SetOutputRange(MeshBlock *pmb);
+  void WriteUnstructured(Mesh *pm);
+
+  std::vector<float> buffer_; // reused conversion buffer of the legacy format
 };
 
 //----------------------------------------------------------------------------------------
@@ -158,6 +231,8 @@ class RestartOutput : public OutputType {
  public:
   explicit RestartOutput(OutputParameters oparams) : OutputType(oparams) {}
   void WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) override;
+  // blocks until the staged restart files have been copied to the run directory
+  static void WaitForPendingCopies();
 };
 
 #ifdef HDF5OUTPUT
@@ -170,15 +245,51 @@ class ATHDF5Output : public OutputType {
   // Function declarations
   explicit ATHDF5Output(OutputParameters oparams) : OutputType(oparams) {}
   void WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) override;
-  void genXDMF(std::string hdfFile, Mesh *pm);
+  // blocks until all asynchronous dumps of all HDF5 outputs are on disk
+  static void WaitForPendingWrites();
 
  private:
+  struct Snapshot;     // host copy of one dump
+  struct XdmfTemplate; // XDMF text of the blocks of the current mesh
+
+  std::shared_ptr<Snapshot> Stage(Mesh *pm);
+  static void Write(const Snapshot &snap, bool async);
+  static hid_t CreateVariable(const Snapshot &snap, int n, hid_t file, hid_t gDSpace);
+  static void WriteInPlace(const Snapshot &snap, int n, hid_t file, hid_t gDSpace,
+                           hid_t plist);
+  static void genXDMF(const Snapshot &snap);
+
+  // staging buffers, reused across dumps once their write has completed
+  std::vector<std::shared_ptr<Snapshot>> snapshots_;
+  // shared with the snapshots, so that the writes, which run one at a time, reuse it
+  std::shared_ptr<XdmfTemplate> xdmf_;
+
   // Parameters
   static const int max_name_length = 128; // maximum length of names excluding \0
+};
+#endif
+
+#ifdef ENABLE_ADIOS2
+//----------------------------------------------------------------------------------------
+//! \class ADIOS2Output
+//  \brief derived OutputType class writing the graphics variables through ADIOS2, to BP
+//  files or streamed to another job with SST, one step per output
 
-  // Metadata
-  std::string filename; // name of athdf file
-  int nx1, nx2, nx3;    // sizes of MeshBlocks
+class ADIOS2Output : public OutputType {
+ public:
+  explicit ADIOS2Output(OutputParameters oparams);
+  ~ADIOS2Output() override;
+  void WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) override;
+
+ private:
+  std::unique_ptr<adios2::ADIOS> adios_;
+  adios2::IO io_;
+  adios2::Engine engine_;
+  // host copies of one step, which the engine reads at the end of the step
+  std::vector<std::int64_t> lx123_;
+  std::vector<int> level_;
+  std::vector<Real> x_, y_, z_;
+  std::vector<std::vector<Real>> data_;
 };
 #endif
 
@@ -194,10 +305,23 @@ class Outputs {
   ~Outputs();
 
   void MakeOutputs(Mesh *pm, ParameterInput *pin, bool wtflag = false);
+  // Adds the copy-out of the output data of pmb to its task list of the last stage of a
+  // cycle, after dep: if outputs are due at the end of the cycle, the task applies
+  // UserWorkBeforeOutput, fills the derived variables and copies the variables of the
+  // block to their host copies, overlapping the work of the other blocks. MakeOutputs
+  // then writes from these copies, unless the mesh changed in between. Returns the id
+  // of the task, which the following tasks of the block need not depend on.
+  TaskID AddOutputTasks(TaskList &tl, TaskID dep, MeshBlock *pmb, ParameterInput *pin);
 
  private:
+  TaskStatus CopyOutputData(MeshBlock *pmb, ParameterInput *pin);
+  // whether an output other than a history is due at time
+  bool OutputDataDue(Mesh *pm, const AccumReal time) const;
+
   OutputType *pfirst_type_; // ptr to head OutputType node in singly linked list
   // (not storing a reference to the tail node)
+  // the mesh generation the copy-out tasks were added in
+  std::uint64_t copy_generation_ = 0;
 };
 
 } // namespace parthenon
@@ -15,19 +15,46 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 //! \file restart.cpp
-//  \brief writes restart files
+//  \brief writes restart files with parallel HDF5 and reads them back
+//
+//  Restart files use the layout of ATHDF5Output: every dataset indexed by block has the
+//  global block id as its slowest index and variables are stored as
+//  (block, k, j, i, component) over the block interior.  Mesh metadata are attributes of
+//  the /Info dataset, the logical locations are under /Blocks and the parameter input
+//  is stored verbatim in /Input so a run can be restarted from the file alone.
+//
+//  With <output>/full_interval = N > 1 only every N-th file holds all blocks.  The files
+//  in between are incremental: their variables only hold the blocks whose checksum
+//  changed since they were last written, and /Blocks/source gives the number of the file
+//  and the row that hold the data of each block, which is the manifest used on restart.
+//
+//  With <output>/stage_dir the file is written to that directory, e.g. a burst buffer,
+//  and rank 0 copies it to the run directory in the background, so a checkpoint taken
+//  shortly before the wall time limit is complete once the fast write returns.
 
+#include "outputs/restart.hpp"
+
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
 
 #include "athena.hpp"
+#include "coordinates/coordinates.hpp"
 #include "globals.hpp"
+#include "interface/container_iterator.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
 #include "outputs/outputs.hpp"
 #include "parameter_input.hpp"
@@ -35,12 +62,561 @@
 
 namespace parthenon {
 
+namespace {
+// copy of the last staged restart file to the run directory, only used on rank 0
+std::future<void> pending_copy;
+
+// copies via a temporary name, so an interrupted copy never looks like a restart file
+void CopyToRunDir(const std::string &staged, const std::string &filename) {
+  const std::string partial = filename + ".part";
+  bool ok;
+  {
+    std::ifstream in(staged, std::ios::binary);
+    std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+    out.flush();
+    ok = in.good() && out.good();
+  }
+  if (!ok || std::rename(partial.c_str(), filename.c_str()) != 0) {
+    std::cout << "### Warning in RestartOutput" << std::endl
+              << "Failed to copy " << staged << " to " << filename
+              << ", restart from the staged file" << std::endl;
+  }
+}
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn void RestartOutput::WaitForPendingCopies()
+//  \brief Blocks until the last staged restart file has been copied to the run directory
+
+void RestartOutput::WaitForPendingCopies() {
+  if (pending_copy.valid()) pending_copy.get();
+}
+
+#ifdef HDF5OUTPUT
+
+namespace {
+
+hid_t H5RealType() {
+  return std::is_same<Real, float>::value ? H5T_NATIVE_FLOAT : H5T_NATIVE_DOUBLE;
+}
+
+hid_t CollectiveTransfer() {
+  hid_t xfer = H5Pcreate(H5P_DATASET_XFER);
+#ifdef MPI_PARALLEL
+  H5Pset_dxpl_mpio(xfer, H5FD_MPIO_COLLECTIVE);
+#endif
+  return xfer;
+}
+
+hid_t ParallelAccess() {
+  hid_t acc_file = H5Pcreate(H5P_FILE_ACCESS);
+#ifdef MPI_PARALLEL
+  H5Pset_fapl_mpio(acc_file, MPI_COMM_WORLD, MPI_INFO_NULL);
+#endif
+  return acc_file;
+}
+
+void WriteAttr(hid_t dset, const char *name, hid_t type, const void *data, hsize_t n) {
+  hid_t space = (n == 1 ? H5Screate(H5S_SCALAR) : H5Screate_simple(1, &n, NULL));
+  hid_t attr = H5Acreate(dset, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr, type, data);
+  H5Aclose(attr);
+  H5Sclose(space);
+}
+
+// creates a dataset of dimensions gdims and collectively writes the rows
+// [start, start + count) of its slowest index from data; ranks with count == 0 take part
+// in the collective call without selecting anything
+void WriteRows(hid_t loc, const char *name, hid_t type, int ndims, const hsize_t *gdims,
+               hsize_t start, hsize_t count, const void *data, hid_t xfer) {
+  hsize_t lstart[5] = {start, 0, 0, 0, 0};
+  hsize_t lcount[5];
+  for (int d = 0; d < ndims; d++)
+    lcount[d] = gdims[d];
+  lcount[0] = count;
+  hid_t gspace = H5Screate_simple(ndims, gdims, NULL);
+  hid_t lspace = H5Screate_simple(ndims, lcount, NULL);
+  hid_t dset = H5Dcreate(loc, name, type, gspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (count > 0) {
+    H5Sselect_hyperslab(gspace, H5S_SELECT_SET, lstart, NULL, lcount, NULL);
+  } else {
+    H5Sselect_none(gspace);
+    H5Sselect_none(lspace);
+  }
+  H5Dwrite(dset, type, lspace, gspace, xfer, data);
+  H5Dclose(dset);
+  H5Sclose(lspace);
+  H5Sclose(gspace);
+}
+
+// reads rows of a variable dataset of one file into data, which holds nblocks blocks:
+// the first of each pair is the row in the dataset, the second the block in data.
+// Collective; ranks without rows take part with an empty selection.
+void ReadRows(hid_t fh, const std::string &filename, const std::string &name,
+              const std::vector<std::pair<hsize_t, hsize_t>> &rows, const int nblocks,
+              std::vector<Real> &data, int &vlen) {
+  hid_t dset = H5Dopen(fh, name.c_str(), H5P_DEFAULT);
+  if (dset < 0) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in RestartReader" << std::endl
+        << "Variable " << name << " not found in restart file " << filename << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  hid_t gspace = H5Dget_space(dset);
+  hsize_t count[5];
+  H5Sget_simple_extent_dims(gspace, count, NULL);
+  vlen = count[4];
+  count[0] = nblocks;
+  data.resize(count[0] * count[1] * count[2] * count[3] * count[4]);
+
+  hid_t lspace = H5Screate_simple(5, count, NULL);
+  H5Sselect_none(gspace);
+  H5Sselect_none(lspace);
+  // one hyperslab per run of rows that are consecutive in both the file and data
+  hsize_t gstart[5] = {0, 0, 0, 0, 0}, lstart[5] = {0, 0, 0, 0, 0};
+  for (std::size_t r = 0; r < rows.size();) {
+    std::size_t e = r + 1;
+    while (e < rows.size() && rows[e].first == rows[e - 1].first + 1 &&
+           rows[e].second == rows[e - 1].second + 1) {
+      e++;
+    }
+    gstart[0] = rows[r].first;
+    lstart[0] = rows[r].second;
+    count[0] = e - r;
+    H5Sselect_hyperslab(gspace, H5S_SELECT_OR, gstart, NULL, count, NULL);
+    H5Sselect_hyperslab(lspace, H5S_SELECT_OR, lstart, NULL, count, NULL);
+    r = e;
+  }
+  hid_t xfer = CollectiveTransfer();
+  H5Dread(dset, H5RealType(), lspace, gspace, xfer, data.data());
+  H5Pclose(xfer);
+  H5Sclose(lspace);
+  H5Sclose(gspace);
+  H5Dclose(dset);
+}
+
+// the finalizer of splitmix64
+KOKKOS_INLINE_FUNCTION std::uint64_t Mix(std::uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// checksum of the interior of the independent variables of a block, reduced on the
+// device.  With a tolerance the values are binned first, so the checksum only stays the
+// same while every value is in the bin it was in, i.e., changed by less than tolerance.
+std::uint64_t BlockChecksum(MeshBlock *pmb, const Real tolerance) {
+  ContainerIterator<Real> ci(pmb->real_containers.Get(), {Metadata::Independent});
+  const double inv_tol = (tolerance > 0.0 ? 1.0 / tolerance : 0.0);
+  std::uint64_t checksum = 0;
+  for (auto &v : ci.vars) {
+    auto q = v->data;
+    const int nv5 = v->GetDim(5), nv4 = v->GetDim(4);
+    const int nv = v->GetDim(6) * nv5 * nv4;
+    std::uint64_t sum = 0;
+    pmb->par_reduce(
+        "RestartOutput::BlockChecksum", 0, nv - 1, pmb->ks, pmb->ke, pmb->js, pmb->je,
+        pmb->is, pmb->ie,
+        KOKKOS_LAMBDA(const int n, const int k, const int j, const int i,
+                      std::uint64_t &lsum) {
+          const double x = q(n / (nv5 * nv4), (n / nv4) % nv5, n % nv4, k, j, i);
+          std::uint64_t bits;
+          if (inv_tol > 0.0) {
+            const double y = x * inv_tol;
+            std::int64_t bin = static_cast<std::int64_t>(y);
+            bin -= (y < bin); // rounds down
+            bits = static_cast<std::uint64_t>(bin);
+          } else {
+            union {
+              double d;
+              std::uint64_t u;
+            } pun;
+            pun.d = x;
+            bits = pun.u;
+          }
+          // depends on the position, so values trading places change the sum
+          const std::uint64_t cell = (static_cast<std::uint64_t>(n) << 48) |
+                                     (static_cast<std::uint64_t>(k) << 32) |
+                                     (static_cast<std::uint64_t>(j) << 16) |
+                                     static_cast<std::uint64_t>(i);
+          lsum += Mix(bits ^ Mix(cell));
+        },
+        Kokkos::Sum<std::uint64_t>(sum));
+    checksum = Mix(checksum ^ sum);
+  }
+  return checksum;
+}
+
+} // namespace
+
 //----------------------------------------------------------------------------------------
 //! \fn void RestartOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag)
-//  \brief Cycles over all MeshBlocks and writes data to a single restart file.
+//  \brief Writes all Metadata::Independent variables of all MeshBlocks to a single
+//         restart file using collective parallel IO.
+
+void RestartOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool force_write) {
+  // HDF5 may not be entered while asynchronous dumps are being written
+  ATHDF5Output::WaitForPendingWrites();
+  // the file records the new time step
+  pm->FinishNewTimeStep();
+
+  MeshBlock *pmb = pm->pblock;
+  const int nx1 = pmb->block_size.nx1;
+  const int nx2 = pmb->block_size.nx2;
+  const int nx3 = pmb->block_size.nx3;
+  const hsize_t nbtotal = pm->nbtotal;
+  const hsize_t nblocal = pm->nblist[Globals::my_rank];
+  const hsize_t gid_start = pm->nslist[Globals::my_rank];
+
+  // Define output filename
+  std::string filename = std::string(output_params.file_basename);
+  filename.append(".");
+  filename.append(output_params.file_id);
+  filename.append(".");
+  std::stringstream file_number;
+  file_number << std::setw(5) << std::setfill('0') << output_params.file_number;
+  filename.append(file_number.str());
+  filename.append(".rhdf");
+  const int this_file = output_params.file_number;
+  const std::string path = (output_params.stage_dir.empty()
+                                ? filename
+                                : output_params.stage_dir + "/" + filename);
+
+  // advance the output parameters first so the stored input restarts with the next dump
+  output_params.file_number++;
+  output_params.next_time += output_params.dt;
+  pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
+  pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
+
+  // the blocks written to this file: all of them unless it is incremental, in which case
+  // only those changed since they were last written
+  const bool incremental = output_params.full_interval > 1;
+  const bool full = !incremental || this_file % output_params.full_interval == 0;
+  std::vector<MeshBlock *> written;
+  for (pmb = pm->pblock; pmb != nullptr; pmb = pmb->next) {
+    bool write = true;
+    if (incremental) {
+      const std::uint64_t checksum = BlockChecksum(pmb, output_params.delta_tolerance);
+      write = full || pmb->restart_file < 0 || checksum != pmb->restart_checksum;
+      // an unwritten block keeps the checksum of its data in the file
+      if (write) pmb->restart_checksum = checksum;
+    }
+    if (write) written.push_back(pmb);
+  }
+  // the written blocks of all ranks form the rows of the variables, in rank order
+  unsigned long long nwritten = written.size(), row_start = 0, nrows = nwritten;
+#ifdef MPI_PARALLEL
+  MPI_Exscan(&nwritten, &row_start, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+  if (Globals::my_rank == 0) row_start = 0;
+  MPI_Allreduce(MPI_IN_PLACE, &nrows, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+                MPI_COMM_WORLD);
+#endif
+  for (std::size_t w = 0; w < written.size(); w++) {
+    written[w]->restart_file = this_file;
+    written[w]->restart_row = row_start + w;
+  }
+
+  hid_t acc_file = ParallelAccess();
+  hid_t file = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, acc_file);
+  H5Pclose(acc_file);
+  hid_t xfer = CollectiveTransfer();
+
+  // mesh metadata, written identically by all ranks
+  hid_t scalar = H5Screate(H5S_SCALAR);
+  hid_t info = H5Dcreate(file, "/Info", H5T_NATIVE_INT, scalar, H5P_DEFAULT, H5P_DEFAULT,
+                         H5P_DEFAULT);
+  H5Sclose(scalar);
+  int nbtotal_int = pm->nbtotal;
+  int nghost = NGHOST;
+  int meshblock_size[3] = {nx1, nx2, nx3};
+  int rootgrid_size[3] = {pm->mesh_size.nx1, pm->mesh_size.nx2, pm->mesh_size.nx3};
+  WriteAttr(info, "NCycle", H5T_NATIVE_INT, &pm->ncycle, 1);
+  WriteAttr(info, "Time", H5T_NATIVE_DOUBLE, &pm->time, 1);
+  WriteAttr(info, "dt", H5RealType(), &pm->dt, 1);
+  WriteAttr(info, "NumDims", H5T_NATIVE_INT, &pm->ndim, 1);
+  WriteAttr(info, "NumMeshBlocks", H5T_NATIVE_INT, &nbtotal_int, 1);
+  WriteAttr(info, "RootLevel", H5T_NATIVE_INT, &pm->root_level, 1);
+  WriteAttr(info, "NGhost", H5T_NATIVE_INT, &nghost, 1);
+  WriteAttr(info, "MeshBlockSize", H5T_NATIVE_INT, meshblock_size, 3);
+  WriteAttr(info, "RootGridSize", H5T_NATIVE_INT, rootgrid_size, 3);
+  WriteAttr(info, "BlocksPerPE", H5T_NATIVE_INT, pm->nblist, Globals::nranks);
+  H5Dclose(info);
+
+  // parameter input, written by rank 0 only
+  std::stringstream ost;
+  pin->ParameterDump(ost);
+  const std::string input = ost.str();
+  hsize_t input_size = input.size();
+  WriteRows(file, "/Input", H5T_NATIVE_CHAR, 1, &input_size, 0,
+            (Globals::my_rank == 0 ? input_size : 0), input.data(), xfer);
+
+  // logical locations and coordinates of the blocks on this rank
+  std::vector<std::int64_t> lx123(3 * nblocal);
+  std::vector<int> level(nblocal);
+  std::vector<Real> x1f(nblocal * (nx1 + 1)), x2f(nblocal * (nx2 + 1)),
+      x3f(nblocal * (nx3 + 1));
+  for (pmb = pm->pblock; pmb != nullptr; pmb = pmb->next) {
+    const int b = pmb->lid;
+    lx123[3 * b] = pmb->loc.lx1;
+    lx123[3 * b + 1] = pmb->loc.lx2;
+    lx123[3 * b + 2] = pmb->loc.lx3;
+    level[b] = pmb->loc.level;
+    for (int i = 0; i <= nx1; i++)
+      x1f[b * (nx1 + 1) + i] = pmb->pcoord->x1f(pmb->is + i);
+    for (int j = 0; j <= nx2; j++)
+      x2f[b * (nx2 + 1) + j] = pmb->pcoord->x2f(pmb->js + j);
+    for (int k = 0; k <= nx3; k++)
+      x3f[b * (nx3 + 1) + k] = pmb->pcoord->x3f(pmb->ks + k);
+  }
+
+  hid_t gBlocks = H5Gcreate(file, "/Blocks", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  hsize_t gdims[5] = {nbtotal, 3, 0, 0, 0};
+  WriteRows(gBlocks, "loc.lx123", H5T_NATIVE_INT64, 2, gdims, gid_start, nblocal,
+            lx123.data(), xfer);
+  WriteRows(gBlocks, "loc.level", H5T_NATIVE_INT, 1, gdims, gid_start, nblocal,
+            level.data(), xfer);
+  if (!full) {
+    std::vector<int> source(2 * nblocal);
+    for (pmb = pm->pblock; pmb != nullptr; pmb = pmb->next) {
+      source[2 * pmb->lid] = pmb->restart_file;
+      source[2 * pmb->lid + 1] = pmb->restart_row;
+    }
+    gdims[1] = 2;
+    WriteRows(gBlocks, "source", H5T_NATIVE_INT, 2, gdims, gid_start, nblocal,
+              source.data(), xfer);
+  }
+  H5Gclose(gBlocks);
+
+  hid_t gLocations = H5Gcreate(file, "/Locations", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  gdims[1] = nx1 + 1;
+  WriteRows(gLocations, "x", H5RealType(), 2, gdims, gid_start, nblocal, x1f.data(),
+            xfer);
+  gdims[1] = nx2 + 1;
+  WriteRows(gLocations, "y", H5RealType(), 2, gdims, gid_start, nblocal, x2f.data(),
+            xfer);
+  gdims[1] = nx3 + 1;
+  WriteRows(gLocations, "z", H5RealType(), 2, gdims, gid_start, nblocal, x3f.data(),
+            xfer);
+  H5Gclose(gLocations);
+
+  // independent variables, one dataset each.  Every block holds the same variables in
+  // the same order, so the first block provides the list.
+  ContainerIterator<Real> ci(pm->pblock->real_containers.Get(), {Metadata::Independent});
+  const auto &vars = ci.vars;
+  std::vector<Real> tmpData;
+  // cells of a block, in 64 bits as the offsets of the blocks overflow int on large ranks
+  const std::int64_t block_cells = static_cast<std::int64_t>(nx3) * nx2 * nx1;
+  for (int n = 0; n < static_cast<int>(vars.size()); n++) {
+    const std::string name = vars[n]->label();
+    const int nv6 = vars[n]->GetDim(6), nv5 = vars[n]->GetDim(5);
+    const int nv4 = vars[n]->GetDim(4);
+    const hsize_t vlen = nv6 * nv5 * nv4;
+    tmpData.resize(nwritten * block_cells * vlen);
+
+    for (std::size_t w = 0; w < written.size(); w++) {
+      pmb = written[w];
+      ContainerIterator<Real> cib(pmb->real_containers.Get(), {Metadata::Independent});
+      auto &v = cib.vars[n];
+      const auto &h = v->GetHostData();
+      std::int64_t index = static_cast<std::int64_t>(w) * block_cells * vlen;
+      for (int k = pmb->ks; k <= pmb->ke; k++) {
+        for (int j = pmb->js; j <= pmb->je; j++) {
+          for (int i = pmb->is; i <= pmb->ie; i++) {
+            for (int l6 = 0; l6 < nv6; l6++) {
+              for (int l5 = 0; l5 < nv5; l5++) {
+                for (int l4 = 0; l4 < nv4; l4++, index++) {
+                  tmpData[index] = h(l6, l5, l4, k, j, i);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+
+    hsize_t vdims[5] = {nrows, static_cast<hsize_t>(nx3), static_cast<hsize_t>(nx2),
+                        static_cast<hsize_t>(nx1), vlen};
+    WriteRows(file, name.c_str(), H5RealType(), 5, vdims, row_start, nwritten,
+              tmpData.data(), xfer);
+  }
+
+  H5Pclose(xfer);
+  H5Fclose(file);
+
+  // closing the file is collective, so it is complete once rank 0 gets here. Copies run
+  // one at a time; a staged file is kept for restarts (see ParthenonManager).
+  if (!output_params.stage_dir.empty() && Globals::my_rank == 0) {
+    WaitForPendingCopies();
+    pending_copy = std::async(std::launch::async, CopyToRunDir, path, filename);
+  }
+  return;
+}
+
+//----------------------------------------------------------------------------------------
+// RestartReader constructor: opens the file for collective reads on all ranks
+
+RestartReader::RestartReader(const char *filename) : filename_(filename) {
+  hid_t acc_file = ParallelAccess();
+  fh_ = H5Fopen(filename, H5F_ACC_RDONLY, acc_file);
+  H5Pclose(acc_file);
+  if (fh_ < 0) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in RestartReader" << std::endl
+        << "Unable to open restart file " << filename_ << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  info_ = H5Dopen(fh_, "/Info", H5P_DEFAULT);
+
+  // an incremental file refers to the files holding the blocks it does not contain,
+  // which are opened on all ranks for the collective reads
+  if (H5Lexists(fh_, "/Blocks/source", H5P_DEFAULT) > 0) {
+    source_.resize(2 * GetAttrInt("NumMeshBlocks"));
+    hid_t xfer = CollectiveTransfer();
+    hid_t dset = H5Dopen(fh_, "/Blocks/source", H5P_DEFAULT);
+    H5Dread(dset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, xfer, source_.data());
+    H5Dclose(dset);
+    H5Pclose(xfer);
+    for (std::size_t b = 0; b < source_.size(); b += 2) {
+      sources_[source_[b]] = -1;
+    }
+    for (auto &f : sources_) {
+      const std::string name = SourceFilename(f.first);
+      acc_file = ParallelAccess();
+      f.second = H5Fopen(name.c_str(), H5F_ACC_RDONLY, acc_file);
+      H5Pclose(acc_file);
+      if (f.second < 0) {
+        std::stringstream msg;
+        msg << "### FATAL ERROR in RestartReader" << std::endl
+            << "Unable to open restart file " << name << " referred to by "
+            << filename_ << std::endl;
+        ATHENA_ERROR(msg);
+      }
+    }
+  }
+}
+
+RestartReader::~RestartReader() {
+  for (auto &f : sources_) {
+    H5Fclose(f.second);
+  }
+  H5Dclose(info_);
+  H5Fclose(fh_);
+}
+
+// the name of restart file file_number of the same output as this file
+std::string RestartReader::SourceFilename(const int file_number) const {
+  const std::size_t ext = filename_.rfind(".rhdf");
+  if (ext == std::string::npos || ext < 5) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in RestartReader" << std::endl
+        << "Incremental restart file " << filename_
+        << " must keep its name to find the files it refers to" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  std::stringstream name;
+  name << filename_.substr(0, ext - 5) << std::setw(5) << std::setfill('0')
+       << file_number << ".rhdf";
+  return name.str();
+}
+
+std::string RestartReader::GetInputString() {
+  hid_t dset = H5Dopen(fh_, "/Input", H5P_DEFAULT);
+  hid_t space = H5Dget_space(dset);
+  hsize_t n;
+  H5Sget_simple_extent_dims(space, &n, NULL);
+  std::string input(n, '\0');
+  hid_t xfer = CollectiveTransfer();
+  H5Dread(dset, H5T_NATIVE_CHAR, H5S_ALL, H5S_ALL, xfer, &input[0]);
+  H5Pclose(xfer);
+  H5Sclose(space);
+  H5Dclose(dset);
+  return input;
+}
+
+int RestartReader::GetAttrInt(const char *name) {
+  int val;
+  hid_t attr = H5Aopen(info_, name, H5P_DEFAULT);
+  H5Aread(attr, H5T_NATIVE_INT, &val);
+  H5Aclose(attr);
+  return val;
+}
+
+AccumReal RestartReader::GetAttrReal(const char *name) {
+  // HDF5 converts attributes written in single precision
+  AccumReal val;
+  hid_t attr = H5Aopen(info_, name, H5P_DEFAULT);
+  H5Aread(attr, H5T_NATIVE_DOUBLE, &val);
+  H5Aclose(attr);
+  return val;
+}
+
+std::vector<int> RestartReader::GetAttrIntArray(const char *name) {
+  hid_t attr = H5Aopen(info_, name, H5P_DEFAULT);
+  hid_t space = H5Aget_space(attr);
+  std::vector<int> val(H5Sget_simple_extent_npoints(space));
+  H5Aread(attr, H5T_NATIVE_INT, val.data());
+  H5Sclose(space);
+  H5Aclose(attr);
+  return val;
+}
+
+void RestartReader::ReadLocations(std::vector<std::int64_t> &lx123,
+                                  std::vector<int> &level) {
+  const int nbtotal = GetAttrInt("NumMeshBlocks");
+  lx123.resize(3 * nbtotal);
+  level.resize(nbtotal);
+  hid_t xfer = CollectiveTransfer();
+  hid_t dset = H5Dopen(fh_, "/Blocks/loc.lx123", H5P_DEFAULT);
+  H5Dread(dset, H5T_NATIVE_INT64, H5S_ALL, H5S_ALL, xfer, lx123.data());
+  H5Dclose(dset);
+  dset = H5Dopen(fh_, "/Blocks/loc.level", H5P_DEFAULT);
+  H5Dread(dset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, xfer, level.data());
+  H5Dclose(dset);
+  H5Pclose(xfer);
+}
+
+void RestartReader::ReadBlocks(const std::string &name, int gid_start, int nblocks,
+                               std::vector<Real> &data, int &vlen) {
+  std::vector<std::pair<hsize_t, hsize_t>> rows;
+  if (source_.empty()) {
+    for (int b = 0; b < nblocks; b++) {
+      rows.emplace_back(gid_start + b, b);
+    }
+    ReadRows(fh_, filename_, name, rows, nblocks, data, vlen);
+    return;
+  }
+  // all ranks go through the files referred to in the same order
+  for (auto &f : sources_) {
+    rows.clear();
+    for (int b = 0; b < nblocks; b++) {
+      const int gid = gid_start + b;
+      if (source_[2 * gid] == f.first) rows.emplace_back(source_[2 * gid + 1], b);
+    }
+    ReadRows(f.second, SourceFilename(f.first), name, rows, nblocks, data, vlen);
+  }
+}
+
+#else // HDF5OUTPUT
 
 void RestartOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool force_write) {
-  throw std::runtime_error(std::string(__func__) + " is not implemented");
+  throw std::runtime_error(std::string(__func__) + " requires HDF5 output support");
 }
 
+RestartReader::RestartReader(const char *filename) : filename_(filename) {
+  throw std::runtime_error("Restarting requires HDF5 output support");
+}
+
+RestartReader::~RestartReader() {}
+std::string RestartReader::GetInputString() { return std::string(); }
+int RestartReader::GetAttrInt(const char *name) { return 0; }
+AccumReal RestartReader::GetAttrReal(const char *name) { return 0.0; }
+std::vector<int> RestartReader::GetAttrIntArray(const char *name) { return {}; }
+void RestartReader::ReadLocations(std::vector<std::int64_t> &lx123,
+                                  std::vector<int> &level) {}
+void RestartReader::ReadBlocks(const std::string &name, int gid_start, int nblocks,
+                               std::vector<Real> &data, int &vlen) {}
+
+#endif // HDF5OUTPUT
+
 } // namespace parthenon
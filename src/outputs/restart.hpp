@@ -0,0 +1,79 @@
+//========================================================================================
+// Athena++ astrophysical MHD code
+// Copyright(C) 2014 James M. Stone <jmstone@princeton.edu> and other code contributors
+// Licensed under the 3-clause BSD License, see LICENSE file for details
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef OUTPUTS_RESTART_HPP_
+#define OUTPUTS_RESTART_HPP_
+//! \file restart.hpp
+//  \brief reader for the parallel HDF5 restart files written by RestartOutput
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+
+#ifdef HDF5OUTPUT
+#include <hdf5.h>
+#endif
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \class RestartReader
+//  \brief opens a restart file on all ranks.  Mesh-wide metadata is read in full, while
+//  block data is read one variable at a time for a contiguous range of global block ids
+//  through a hyperslab selection, so each rank only touches its own blocks.  The blocks
+//  missing from an incremental file are read from the earlier files it refers to.
+
+class RestartReader {
+ public:
+  explicit RestartReader(const char *filename);
+  ~RestartReader();
+
+  // parameter input (as written by ParameterInput::ParameterDump) stored in the file
+  std::string GetInputString();
+
+  // scalar and small array attributes of the /Info dataset
+  int GetAttrInt(const char *name);
+  AccumReal GetAttrReal(const char *name);
+  std::vector<int> GetAttrIntArray(const char *name);
+
+  // logical locations of all blocks in the file, ordered by global id
+  void ReadLocations(std::vector<std::int64_t> &lx123, std::vector<int> &level);
+
+  // reads blocks [gid_start, gid_start + nblocks) of a variable dataset, laid out as
+  // (block, k, j, i, component) with the component count returned in vlen
+  void ReadBlocks(const std::string &name, int gid_start, int nblocks,
+                  std::vector<Real> &data, int &vlen);
+
+ private:
+  const std::string filename_;
+#ifdef HDF5OUTPUT
+  hid_t fh_;
+  hid_t info_;
+  // for incremental files, the file number and row holding each block by global id,
+  // and the files referred to by their number
+  std::vector<int> source_;
+  std::map<int, hid_t> sources_;
+
+  std::string SourceFilename(const int file_number) const;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // OUTPUTS_RESTART_HPP_
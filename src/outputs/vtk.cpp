@@ -15,21 +15,28 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 //! \file vtk.cpp
-//  \brief writes output data in (legacy) vtk format.
-//  Data is written in RECTILINEAR_GRID geometry, in BINARY format, and in FLOAT type
-//  Writes one file per MeshBlock.
+//  \brief writes output data in vtk format.
+//  With vtk_format = legacy (default) data is written in (legacy) RECTILINEAR_GRID
+//  geometry, in BINARY format, and in FLOAT type, one file per MeshBlock.  With
+//  vtk_format = pvtu every rank writes the cells of all of its MeshBlocks into a single
+//  XML UnstructuredGrid (.vtu) file, and rank 0 writes a .pvtu file tying them together.
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "athena.hpp"
 #include "coordinates/coordinates.hpp"
+#include "globals.hpp"
 #include "interface/container_iterator.hpp"
 #include "mesh/mesh.hpp"
 #include "outputs/outputs.hpp"
@@ -50,19 +57,55 @@ int IsBigEndian() {
 }
 
 namespace {
-inline void Swap4Bytes(void *vdat) {
-  char tmp, *dat = static_cast<char *>(vdat);
-  tmp = dat[0];
-  dat[0] = dat[3];
-  dat[3] = tmp;
-  tmp = dat[1];
-  dat[1] = dat[2];
-  dat[2] = tmp;
+// Byte-swaps a buffer of 32-bit words in place.  Works on whole words with shifts so
+// that the loop vectorizes.
+void Swap4Bytes(float *data, const std::size_t n) {
+#pragma omp simd
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint32_t w;
+    std::memcpy(&w, &data[i], sizeof(w));
+    w = (w >> 24) | ((w >> 8) & 0x0000ff00u) | ((w << 8) & 0x00ff0000u) | (w << 24);
+    std::memcpy(&data[i], &w, sizeof(w));
+  }
+}
+
+// writes one appended raw data array of the XML formats: a 64-bit byte count followed by
+// the data
+template <typename T>
+void WriteAppended(std::ofstream &os, const std::vector<T> &data) {
+  const std::uint64_t nbytes = data.size() * sizeof(T);
+  os.write(reinterpret_cast<const char *>(&nbytes), sizeof(nbytes));
+  os.write(reinterpret_cast<const char *>(data.data()), nbytes);
 }
 } // namespace
 
 //----------------------------------------------------------------------------------------
-//! \fn void VTKOutput:::WriteOutputFile(Mesh *pm)
+//! \fn void VTKOutput::SetOutputRange(MeshBlock *pmb)
+//  \brief sets start/end array indices depending on whether ghost zones are included
+
+void VTKOutput::SetOutputRange(MeshBlock *pmb) {
+  out_is = pmb->is;
+  out_ie = pmb->ie;
+  out_js = pmb->js;
+  out_je = pmb->je;
+  out_ks = pmb->ks;
+  out_ke = pmb->ke;
+  if (output_params.include_ghost_zones) {
+    out_is -= NGHOST;
+    out_ie += NGHOST;
+    if (out_js != out_je) {
+      out_js -= NGHOST;
+      out_je += NGHOST;
+    }
+    if (out_ks != out_ke) {
+      out_ks -= NGHOST;
+      out_ke += NGHOST;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void VTKOutput:::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag)
 //  \brief Cycles over all MeshBlocks and writes OutputData in (legacy) vtk format, one
 //         MeshBlock per file
 
@@ -72,28 +115,12 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
 
   // Loop over MeshBlocks
   while (pmb != nullptr) {
-    // set start/end array indices depending on whether ghost zones are included
-    out_is = pmb->is;
-    out_ie = pmb->ie;
-    out_js = pmb->js;
-    out_je = pmb->je;
-    out_ks = pmb->ks;
-    out_ke = pmb->ke;
-    if (output_params.include_ghost_zones) {
-      out_is -= NGHOST;
-      out_ie += NGHOST;
-      if (out_js != out_je) {
-        out_js -= NGHOST;
-        out_je += NGHOST;
-      }
-      if (out_ks != out_ke) {
-        out_ks -= NGHOST;
-        out_ke += NGHOST;
-      }
+    if (!BlockInOutput(pmb)) {
+      pmb = pmb->next;
+      continue;
     }
+    SetOutputRange(pmb);
 
-    // build doubly linked list of OutputData nodes (setting data ptrs to appropriate
-    // quantity on MeshBlock for each node), then slice/sum as needed
     // create filename: "file_basename"+ "."+"blockid"+"."+"file_id"+"."+XXXXX+".vtk",
     // where XXXXX = 5-digit file_number
     std::string fname;
@@ -132,10 +159,11 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
     //  3. File format
     std::fprintf(pfile, "BINARY\n");
 
-    //  4. Dataset structure
-    int ncells1 = out_ie - out_is + 1;
-    int ncells2 = out_je - out_js + 1;
-    int ncells3 = out_ke - out_ks + 1;
+    //  4. Dataset structure.  With a stride every stride-th cell is written.
+    const int s = output_params.stride;
+    int ncells1 = (out_ie - out_is) / s + 1;
+    int ncells2 = (out_je - out_js) / s + 1;
+    int ncells3 = (out_ke - out_ks) / s + 1;
 
     int ncoord1 = ncells1;
     if (ncells1 > 1) ncoord1++;
@@ -144,10 +172,10 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
     int ncoord3 = ncells3;
     if (ncells3 > 1) ncoord3++;
 
-    float *data;
-    int ndata = std::max(ncoord1, ncoord2);
-    ndata = std::max(ndata, ncoord3);
-    data = new float[3 * ndata + 1];
+    // the conversion buffer is kept between blocks and dumps
+    const std::size_t ncells = ncells1 * ncells2 * ncells3;
+    buffer_.resize(std::max<std::size_t>({ncoord1, ncoord2, ncoord3, ncells}));
+    float *data = buffer_.data();
 
     // Specify the type of data, dimensions, and coordinates.  If N>1, then write N+1
     // cell faces as binary floats.  If N=1, then write 1 cell center position.
@@ -159,14 +187,12 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
     if (ncells1 == 1) {
       data[0] = static_cast<float>(pmb->pcoord->x1v(out_is));
     } else {
-      for (int i = out_is; i <= out_ie + 1; ++i) {
-        data[i - out_is] = static_cast<float>(pmb->pcoord->x1f(i));
+      for (int i = 0; i < ncoord1; ++i) {
+        data[i] =
+            static_cast<float>(pmb->pcoord->x1f(std::min(out_is + i * s, out_ie + 1)));
       }
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord1; ++i)
-        Swap4Bytes(&data[i]);
-    }
+    if (!big_end) Swap4Bytes(data, ncoord1);
     std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord1), pfile);
 
     // write x2-coordinates as binary float in big endian order
@@ -174,14 +200,12 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
     if (ncells2 == 1) {
       data[0] = static_cast<float>(pmb->pcoord->x2v(out_js));
     } else {
-      for (int j = out_js; j <= out_je + 1; ++j) {
-        data[j - out_js] = static_cast<float>(pmb->pcoord->x2f(j));
+      for (int j = 0; j < ncoord2; ++j) {
+        data[j] =
+            static_cast<float>(pmb->pcoord->x2f(std::min(out_js + j * s, out_je + 1)));
       }
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord2; ++i)
-        Swap4Bytes(&data[i]);
-    }
+    if (!big_end) Swap4Bytes(data, ncoord2);
     std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord2), pfile);
 
     // write x3-coordinates as binary float in big endian order
@@ -189,48 +213,44 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
     if (ncells3 == 1) {
       data[0] = static_cast<float>(pmb->pcoord->x3v(out_ks));
     } else {
-      for (int k = out_ks; k <= out_ke + 1; ++k) {
-        data[k - out_ks] = static_cast<float>(pmb->pcoord->x3f(k));
+      for (int k = 0; k < ncoord3; ++k) {
+        data[k] =
+            static_cast<float>(pmb->pcoord->x3f(std::min(out_ks + k * s, out_ke + 1)));
       }
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord3; ++i)
-        Swap4Bytes(&data[i]);
-    }
+    if (!big_end) Swap4Bytes(data, ncoord3);
     std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord3), pfile);
 
-    //  5. Data.  An arbitrary number of scalars and vectors can be written (every node
-    //  in the OutputData doubly linked lists), all in binary floats format
+    //  5. Data.  An arbitrary number of scalars can be written, one per component of
+    //  every graphics variable, all in binary floats format
 
     std::fprintf(pfile, "\nCELL_DATA %d", ncells1 * ncells2 * ncells3);
     // reset container iterator to point to current block data
     auto ci = ContainerIterator<Real>(pmb->real_containers.Get(), {Metadata::Graphics});
     for (auto &v : ci.vars) {
-      if (!data) {
-        std::cout << "____________________SKIPPPING:" << v->label() << std::endl;
-        continue;
-      }
-      std::fprintf(pfile, "\nLOOKUP_TABLE default\n");
-      for (int k = out_ks; k <= out_ke; k++) {
-        for (int j = out_js; j <= out_je; j++) {
-          int index = 0;
-          for (int i = out_is; i <= out_ie; i++, index++) {
-            data[(i - out_is) + index] = (*v)(k, j, i);
-          }
-
-          // write data in big endian order
-          if (!big_end) {
-            for (int i = 0; i < (ncells1); ++i)
-              Swap4Bytes(&data[i]);
+      const auto &h = v->GetHostData();
+      const int vlen = v->GetDim(4);
+      for (int n = 0; n < vlen; n++) {
+        std::string name = v->label();
+        if (vlen > 1) name += "_" + std::to_string(n);
+        std::fprintf(pfile, "\nSCALARS %s float\n", name.c_str());
+        std::fprintf(pfile, "LOOKUP_TABLE default\n");
+        std::size_t index = 0;
+        for (int k = out_ks; k <= out_ke; k += s) {
+          for (int j = out_js; j <= out_je; j += s) {
+            for (int i = out_is; i <= out_ie; i += s, index++) {
+              data[index] = static_cast<float>(h(n, k, j, i));
+            }
           }
-          std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncells1), pfile);
         }
+        // write data in big endian order
+        if (!big_end) Swap4Bytes(data, ncells);
+        std::fwrite(data, sizeof(float), ncells, pfile);
       }
     }
 
-    // don't forget to close the output file and clean up ptrs to data in OutputData
+    // don't forget to close the output file
     std::fclose(pfile);
-    delete[] data;
     pmb = pmb->next;
   } // end loop over MeshBlocks
 
@@ -242,191 +262,217 @@ void VTKOutput::WriteContainer(Mesh *pm, ParameterInput *pin, bool flag) {
 
   return;
 }
-void VTKOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
-  MeshBlock *pmb = pm->pblock;
-  int big_end = IsBigEndian(); // =1 on big endian machine
-  WriteContainer(pm, pin, flag);
-  return;
-  // Loop over MeshBlocks
-  while (pmb != nullptr) {
-    // set start/end array indices depending on whether ghost zones are included
-    out_is = pmb->is;
-    out_ie = pmb->ie;
-    out_js = pmb->js;
-    out_je = pmb->je;
-    out_ks = pmb->ks;
-    out_ke = pmb->ke;
-    if (output_params.include_ghost_zones) {
-      out_is -= NGHOST;
-      out_ie += NGHOST;
-      if (out_js != out_je) {
-        out_js -= NGHOST;
-        out_je += NGHOST;
-      }
-      if (out_ks != out_ke) {
-        out_ks -= NGHOST;
-        out_ke += NGHOST;
-      }
-    }
-
-    // build doubly linked list of OutputData nodes (setting data ptrs to appropriate
-    // quantity on MeshBlock for each node), then slice/sum as needed
-    LoadOutputData(pmb);
-    if (!TransformOutputData(pmb)) {
-      ClearOutputData(); // required when LoadOutputData() is used.
-      pmb = pmb->next;
-      continue;
-    } // skip if slice was out of range
-
-    // create filename: "file_basename"+ "."+"blockid"+"."+"file_id"+"."+XXXXX+".vtk",
-    // where XXXXX = 5-digit file_number
-    std::string fname;
-    char number[6];
-    std::snprintf(number, sizeof(number), "%05d", output_params.file_number);
-    char blockid[12];
-    std::snprintf(blockid, sizeof(blockid), "block%d", pmb->gid);
-
-    fname.assign(output_params.file_basename);
-    fname.append(".");
-    fname.append(blockid);
-    fname.append(".");
-    fname.append(output_params.file_id);
-    fname.append(".");
-    fname.append(number);
-    fname.append(".vtk");
-
-    // open file for output
-    FILE *pfile;
-    std::stringstream msg;
-    if ((pfile = std::fopen(fname.c_str(), "w")) == nullptr) {
-      msg << "### FATAL ERROR in function [VTKOutput::WriteOutputFile]" << std::endl
-          << "Output file '" << fname << "' could not be opened" << std::endl;
-      ATHENA_ERROR(msg);
-    }
-
-    // There are five basic parts to the VTK "legacy" file format.
-    //  1. Write file version and identifier
-    std::fprintf(pfile, "# vtk DataFile Version 2.0\n");
-
-    //  2. Header
-    std::fprintf(pfile, "# Athena++ data at time=%e", pm->time);
-    std::fprintf(pfile, "  cycle=%d", pmb->pmy_mesh->ncycle);
-    std::fprintf(pfile, "  variables=%s \n", output_params.variable.c_str());
 
-    //  3. File format
-    std::fprintf(pfile, "BINARY\n");
-
-    //  4. Dataset structure
-    int ncells1 = out_ie - out_is + 1;
-    int ncells2 = out_je - out_js + 1;
-    int ncells3 = out_ke - out_ks + 1;
-
-    int ncoord1 = ncells1;
-    if (ncells1 > 1) ncoord1++;
-    int ncoord2 = ncells2;
-    if (ncells2 > 1) ncoord2++;
-    int ncoord3 = ncells3;
-    if (ncells3 > 1) ncoord3++;
-
-    float *data;
-    int ndata = std::max(ncoord1, ncoord2);
-    ndata = std::max(ndata, ncoord3);
-    data = new float[3 * ndata];
-
-    // Specify the type of data, dimensions, and coordinates.  If N>1, then write N+1
-    // cell faces as binary floats.  If N=1, then write 1 cell center position.
-    std::fprintf(pfile, "DATASET RECTILINEAR_GRID\n");
-    std::fprintf(pfile, "DIMENSIONS %d %d %d\n", ncoord1, ncoord2, ncoord3);
-
-    // write x1-coordinates as binary float in big endian order
-    std::fprintf(pfile, "X_COORDINATES %d float\n", ncoord1);
-    if (ncells1 == 1) {
-      data[0] = static_cast<float>(pmb->pcoord->x1v(out_is));
-    } else {
-      for (int i = out_is; i <= out_ie + 1; ++i) {
-        data[i - out_is] = static_cast<float>(pmb->pcoord->x1f(i));
-      }
-    }
-    if (!big_end) {
-      for (int i = 0; i < ncoord1; ++i)
-        Swap4Bytes(&data[i]);
-    }
-    std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord1), pfile);
-
-    // write x2-coordinates as binary float in big endian order
-    std::fprintf(pfile, "\nY_COORDINATES %d float\n", ncoord2);
-    if (ncells2 == 1) {
-      data[0] = static_cast<float>(pmb->pcoord->x2v(out_js));
-    } else {
-      for (int j = out_js; j <= out_je + 1; ++j) {
-        data[j - out_js] = static_cast<float>(pmb->pcoord->x2f(j));
+//----------------------------------------------------------------------------------------
+//! \fn void VTKOutput::WriteUnstructured(Mesh *pm)
+//  \brief Writes the cells of all MeshBlocks of this rank into one XML UnstructuredGrid
+//         file with appended raw data in native byte order, so no conversion is needed.
+//         Rank 0 also writes the .pvtu file listing the pieces of all ranks.
+
+void VTKOutput::WriteUnstructured(Mesh *pm) {
+  std::stringstream msg;
+  char number[6];
+  std::snprintf(number, sizeof(number), "%05d", output_params.file_number);
+  const std::string base =
+      output_params.file_basename + "." + output_params.file_id + "." + number;
+  const std::string byte_order = (IsBigEndian() ? "BigEndian" : "LittleEndian");
+
+  // all blocks share the same shape; with a stride every stride-th cell is written
+  SetOutputRange(pm->pblock);
+  const int s = output_params.stride;
+  const int ncells1 = (out_ie - out_is) / s + 1;
+  const int ncells2 = (out_je - out_js) / s + 1;
+  const int ncells3 = (out_ke - out_ks) / s + 1;
+  const int d1 = (ncells1 > 1), d2 = (ncells2 > 1), d3 = (ncells3 > 1);
+  const int ncoord1 = ncells1 + d1, ncoord2 = ncells2 + d2, ncoord3 = ncells3 + d3;
+  // VTK_VERTEX, VTK_LINE, VTK_PIXEL or VTK_VOXEL: axis aligned with lexicographically
+  // ordered vertices
+  const std::uint8_t cell_types[4] = {1, 3, 8, 11};
+  const std::uint8_t cell_type = cell_types[d1 + d2 + d3];
+  const int nvert = 1 << (d1 + d2 + d3);
+
+  // blocks in the output region; the others are not copied at all
+  std::vector<MeshBlock *> blocks;
+  for (MeshBlock *pmb = pm->pblock; pmb != nullptr; pmb = pmb->next) {
+    if (BlockInOutput(pmb)) blocks.push_back(pmb);
+  }
+  const int nblocks = blocks.size();
+  const std::int64_t npoints = static_cast<std::int64_t>(nblocks) * ncoord1 * ncoord2 *
+                               ncoord3;
+  const std::int64_t ncells = static_cast<std::int64_t>(nblocks) * ncells1 * ncells2 *
+                              ncells3;
+
+  // geometry
+  std::vector<float> points;
+  std::vector<std::int64_t> connectivity, offsets;
+  std::vector<std::uint8_t> types(ncells, cell_type);
+  points.reserve(3 * npoints);
+  connectivity.reserve(nvert * ncells);
+  offsets.reserve(ncells);
+  std::int64_t point_offset = 0;
+  for (MeshBlock *pmb : blocks) {
+    auto &pco = pmb->pcoord;
+    for (int k = 0; k < ncoord3; k++) {
+      const float x3 = (d3 ? pco->x3f(std::min(out_ks + k * s, out_ke + 1))
+                           : pco->x3v(out_ks));
+      for (int j = 0; j < ncoord2; j++) {
+        const float x2 = (d2 ? pco->x2f(std::min(out_js + j * s, out_je + 1))
+                             : pco->x2v(out_js));
+        for (int i = 0; i < ncoord1; i++) {
+          points.push_back(d1 ? pco->x1f(std::min(out_is + i * s, out_ie + 1))
+                              : pco->x1v(out_is));
+          points.push_back(x2);
+          points.push_back(x3);
+        }
       }
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord2; ++i)
-        Swap4Bytes(&data[i]);
-    }
-    std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord2), pfile);
-
-    // write x3-coordinates as binary float in big endian order
-    std::fprintf(pfile, "\nZ_COORDINATES %d float\n", ncoord3);
-    if (ncells3 == 1) {
-      data[0] = static_cast<float>(pmb->pcoord->x3v(out_ks));
-    } else {
-      for (int k = out_ks; k <= out_ke + 1; ++k) {
-        data[k - out_ks] = static_cast<float>(pmb->pcoord->x3f(k));
+    for (int k = 0; k < ncells3; k++) {
+      for (int j = 0; j < ncells2; j++) {
+        for (int i = 0; i < ncells1; i++) {
+          for (int dk = 0; dk <= d3; dk++) {
+            for (int dj = 0; dj <= d2; dj++) {
+              for (int di = 0; di <= d1; di++) {
+                connectivity.push_back(point_offset + (i + di) +
+                                       ncoord1 * ((j + dj) + ncoord2 * (k + dk)));
+              }
+            }
+          }
+          offsets.push_back(connectivity.size());
+        }
       }
     }
-    if (!big_end) {
-      for (int i = 0; i < ncoord3; ++i)
-        Swap4Bytes(&data[i]);
-    }
-    std::fwrite(data, sizeof(float), static_cast<std::size_t>(ncoord3), pfile);
-
-    //  5. Data.  An arbitrary number of scalars and vectors can be written (every node
-    //  in the OutputData doubly linked lists), all in binary floats format
-    std::fprintf(pfile, "\nCELL_DATA %d", ncells1 * ncells2 * ncells3);
-
-    OutputData *pdata = pfirst_data_;
-    while (pdata != nullptr) {
-      // write data type (SCALARS or VECTORS) and name
-      std::fprintf(pfile, "\n%s %s float\n", pdata->type.c_str(), pdata->name.c_str());
-
-      int nvar = pdata->data.GetDim(4);
-      if (nvar == 1) std::fprintf(pfile, "LOOKUP_TABLE default\n");
-      for (int k = out_ks; k <= out_ke; ++k) {
-        for (int j = out_js; j <= out_je; ++j) {
-          for (int i = out_is; i <= out_ie; ++i) {
-            for (int n = 0; n < nvar; ++n) {
-              data[nvar * (i - out_is) + n] = static_cast<float>(pdata->data(n, k, j, i));
+    point_offset += ncoord1 * ncoord2 * ncoord3;
+  }
+
+  // cell data, one array per graphics variable
+  ContainerIterator<Real> ciX(pm->pblock->real_containers.Get(), {Metadata::Graphics});
+  const int nvars = ciX.vars.size();
+  std::vector<std::string> names(nvars);
+  std::vector<int> vlens(nvars);
+  std::vector<std::vector<float>> celldata(nvars);
+  for (int n = 0; n < nvars; n++) {
+    names[n] = ciX.vars[n]->label();
+    vlens[n] = ciX.vars[n]->GetDim(4);
+    celldata[n].reserve(ncells * vlens[n]);
+  }
+  for (MeshBlock *pmb : blocks) {
+    ContainerIterator<Real> ci(pmb->real_containers.Get(), {Metadata::Graphics});
+    for (int n = 0; n < nvars; n++) {
+      const auto &h = ci.vars[n]->GetHostData();
+      for (int k = out_ks; k <= out_ke; k += s) {
+        for (int j = out_js; j <= out_je; j += s) {
+          for (int i = out_is; i <= out_ie; i += s) {
+            for (int l = 0; l < vlens[n]; l++) {
+              celldata[n].push_back(static_cast<float>(h(l, k, j, i)));
             }
           }
-
-          // write data in big endian order
-          if (!big_end) {
-            for (int i = 0; i < (nvar * ncells1); ++i)
-              Swap4Bytes(&data[i]);
-          }
-          std::fwrite(data, sizeof(float), static_cast<std::size_t>(nvar * ncells1),
-                      pfile);
         }
       }
-      pdata = pdata->pnext;
     }
-    // don't forget to close the output file and clean up ptrs to data in OutputData
-    std::fclose(pfile);
-    ClearOutputData(); // required when LoadOutputData() is used.
-    delete[] data;
-    pmb = pmb->next;
-  } // end loop over MeshBlocks
+  }
+
+  // XML header with the offsets of all arrays in the appended section
+  std::uint64_t offset = 0;
+  auto appended = [&offset](std::uint64_t nbytes) {
+    std::string attr = R"( format="appended" offset=")" + std::to_string(offset) + R"(")";
+    offset += sizeof(std::uint64_t) + nbytes;
+    return attr;
+  };
+  std::stringstream xml;
+  xml << R"(<?xml version="1.0"?>)" << std::endl;
+  xml << R"(<VTKFile type="UnstructuredGrid" version="1.0" byte_order=")" << byte_order
+      << R"(" header_type="UInt64">)" << std::endl;
+  xml << "  <UnstructuredGrid>" << std::endl;
+  xml << "    <FieldData>" << std::endl;
+  xml << R"(      <DataArray type="Float64" Name="TimeValue" NumberOfTuples="1")"
+      << R"( format="ascii">)" << std::setprecision(17) << pm->time << "</DataArray>"
+      << std::endl;
+  xml << "    </FieldData>" << std::endl;
+  xml << R"(    <Piece NumberOfPoints=")" << npoints << R"(" NumberOfCells=")" << ncells
+      << R"(">)" << std::endl;
+  xml << "      <Points>" << std::endl;
+  xml << R"(        <DataArray type="Float32" NumberOfComponents="3")"
+      << appended(points.size() * sizeof(float)) << "/>" << std::endl;
+  xml << "      </Points>" << std::endl;
+  xml << "      <Cells>" << std::endl;
+  xml << R"(        <DataArray type="Int64" Name="connectivity")"
+      << appended(connectivity.size() * sizeof(std::int64_t)) << "/>" << std::endl;
+  xml << R"(        <DataArray type="Int64" Name="offsets")"
+      << appended(offsets.size() * sizeof(std::int64_t)) << "/>" << std::endl;
+  xml << R"(        <DataArray type="UInt8" Name="types")" << appended(types.size())
+      << "/>" << std::endl;
+  xml << "      </Cells>" << std::endl;
+  xml << "      <CellData>" << std::endl;
+  for (int n = 0; n < nvars; n++) {
+    xml << R"(        <DataArray type="Float32" Name=")" << names[n]
+        << R"(" NumberOfComponents=")" << vlens[n] << R"(")"
+        << appended(celldata[n].size() * sizeof(float)) << "/>" << std::endl;
+  }
+  xml << "      </CellData>" << std::endl;
+  xml << "    </Piece>" << std::endl;
+  xml << "  </UnstructuredGrid>" << std::endl;
+  xml << R"(  <AppendedData encoding="raw">)" << std::endl << "_";
+
+  const std::string piece = base + ".rank" + std::to_string(Globals::my_rank) + ".vtu";
+  std::ofstream os(piece, std::ios::binary | std::ios::trunc);
+  if (!os) {
+    msg << "### FATAL ERROR in function [VTKOutput::WriteUnstructured]" << std::endl
+        << "Output file '" << piece << "' could not be opened" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  os << xml.str();
+  WriteAppended(os, points);
+  WriteAppended(os, connectivity);
+  WriteAppended(os, offsets);
+  WriteAppended(os, types);
+  for (int n = 0; n < nvars; n++)
+    WriteAppended(os, celldata[n]);
+  os << std::endl << "  </AppendedData>" << std::endl << "</VTKFile>" << std::endl;
+  os.close();
+
+  // parallel master file
+  if (Globals::my_rank == 0) {
+    std::ofstream pos(base + ".pvtu", std::ios::trunc);
+    pos << R"(<?xml version="1.0"?>)" << std::endl;
+    pos << R"(<VTKFile type="PUnstructuredGrid" version="1.0" byte_order=")" << byte_order
+        << R"(" header_type="UInt64">)" << std::endl;
+    pos << R"(  <PUnstructuredGrid GhostLevel="0">)" << std::endl;
+    pos << "    <PPoints>" << std::endl;
+    pos << R"(      <PDataArray type="Float32" NumberOfComponents="3"/>)" << std::endl;
+    pos << "    </PPoints>" << std::endl;
+    pos << "    <PCellData>" << std::endl;
+    for (int n = 0; n < nvars; n++) {
+      pos << R"(      <PDataArray type="Float32" Name=")" << names[n]
+          << R"(" NumberOfComponents=")" << vlens[n] << R"("/>)" << std::endl;
+    }
+    pos << "    </PCellData>" << std::endl;
+    for (int r = 0; r < Globals::nranks; r++) {
+      // pieces are referenced relative to the .pvtu file
+      std::string source = base + ".rank" + std::to_string(r) + ".vtu";
+      source = source.substr(source.find_last_of('/') + 1);
+      pos << R"(    <Piece Source=")" << source << R"("/>)" << std::endl;
+    }
+    pos << "  </PUnstructuredGrid>" << std::endl;
+    pos << "</VTKFile>" << std::endl;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void VTKOutput:::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag)
+//  \brief Writes the vtk output in the format selected by <output>/vtk_format
+
+void VTKOutput::WriteOutputFile(Mesh *pm, ParameterInput *pin, bool flag) {
+  if (output_params.vtk_format != "pvtu") {
+    WriteContainer(pm, pin, flag);
+    return;
+  }
+  WriteUnstructured(pm);
 
   // increment counters
   output_params.file_number++;
   output_params.next_time += output_params.dt;
   pin->SetInteger(output_params.block_name, "file_number", output_params.file_number);
   pin->SetReal(output_params.block_name, "next_time", output_params.next_time);
-
-  return;
 }
 
 } // namespace parthenon
@@ -63,14 +63,14 @@ namespace parthenon {
 //----------------------------------------------------------------------------------------
 // ParameterInput constructor
 
-ParameterInput::ParameterInput() : pfirst_block{}, last_filename_{} {
+ParameterInput::ParameterInput() : pfirst_block{}, last_filename_{}, plast_block_{} {
 #ifdef OPENMP_PARALLEL
   omp_init_lock(&lock_);
 #endif
 }
 
 ParameterInput::ParameterInput(std::string input_filename)
-    : pfirst_block{}, last_filename_{} {
+    : pfirst_block{}, last_filename_{}, plast_block_{} {
 #ifdef OPENMP_PARALLEL
   omp_init_lock(&lock_);
 #endif
@@ -114,7 +114,8 @@ InputBlock::~InputBlock() {
 
 //  Input block names are allocated and stored in a singly linked list of InputBlocks.
 //  Within each InputBlock the names, values, and comments of each parameter are allocated
-//  and stored in a singly linked list of InputLines.
+//  and stored in a singly linked list of InputLines. Both lists keep the order of the
+//  input for ParameterDump and are indexed by name in hash maps for the lookups.
 
 void ParameterInput::LoadFromStream(std::istream &is) {
   std::string line, block_name, param_name, param_value, param_comment;
@@ -226,16 +227,8 @@ void ParameterInput::LoadFromFile(IOWrapper &input) {
 //  \brief find or add specified InputBlock.  Returns pointer to block.
 
 InputBlock *ParameterInput::FindOrAddBlock(std::string name) {
-  InputBlock *pib, *plast;
-  plast = pfirst_block;
-  pib = pfirst_block;
-
-  // Search singly linked list of InputBlocks to see if name exists, return if found.
-  while (pib != nullptr) {
-    if (name.compare(pib->block_name) == 0) return pib;
-    plast = pib;
-    pib = pib->pnext;
-  }
+  InputBlock *pib = GetPtrToBlock(name);
+  if (pib != nullptr) return pib;
 
   // Create new block in list if not found above
   pib = new InputBlock;
@@ -247,8 +240,10 @@ InputBlock *ParameterInput::FindOrAddBlock(std::string name) {
   if (pfirst_block == nullptr) {
     pfirst_block = pib;
   } else {
-    plast->pnext = pib; // link new node into list
+    plast_block_->pnext = pib; // link new node into list
   }
+  plast_block_ = pib;
+  block_index_[name] = pib;
 
   return pib;
 }
@@ -300,20 +295,12 @@ void ParameterInput::ParseLine(InputBlock *pib, std::string line, std::string &n
 
 void ParameterInput::AddParameter(InputBlock *pb, std::string name, std::string value,
                                   std::string comment) {
-  InputLine *pl, *plast;
-  // Search singly linked list of InputLines to see if name exists.  This also sets *plast
-  // to point to the tail node (but not storing a pointer to the tail node in InputBlock)
-  pl = pb->pline;
-  plast = pb->pline;
-  while (pl != nullptr) {
-    if (name.compare(pl->param_name) == 0) { // param name already exists
-      pl->param_value.assign(value);         // replace existing param value
-      pl->param_comment.assign(comment);     // replace exisiting param comment
-      if (value.length() > pb->max_len_parvalue) pb->max_len_parvalue = value.length();
-      return;
-    }
-    plast = pl;
-    pl = pl->pnext;
+  InputLine *pl = pb->GetPtrToLine(name);
+  if (pl != nullptr) {                 // param name already exists
+    pl->SetValue(value);               // replace existing param value
+    pl->param_comment.assign(comment); // replace exisiting param comment
+    if (value.length() > pb->max_len_parvalue) pb->max_len_parvalue = value.length();
+    return;
   }
 
   // Create new node in singly linked list if name does not already exist
@@ -329,10 +316,12 @@ void ParameterInput::AddParameter(InputBlock *pb, std::string name, std::string
     pb->max_len_parname = name.length();
     pb->max_len_parvalue = value.length();
   } else {
-    plast->pnext = pl; // link new node into list
+    pb->plast_line_->pnext = pl; // link new node into list
     if (name.length() > pb->max_len_parname) pb->max_len_parname = name.length();
     if (value.length() > pb->max_len_parvalue) pb->max_len_parvalue = value.length();
   }
+  pb->plast_line_ = pl;
+  pb->line_index_[name] = pl;
 
   return;
 }
@@ -379,22 +368,19 @@ void ParameterInput::ModifyFromCmdline(int argc, char *argv[]) {
           << "' on command line not found";
       ATHENA_ERROR(msg);
     }
-    pl->param_value.assign(value); // replace existing value
+    pl->SetValue(value); // replace existing value
 
     if (value.length() > pb->max_len_parvalue) pb->max_len_parvalue = value.length();
   }
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn InputBlock* ParameterInput::GetPtrToBlock(std::string name)
+//! \fn InputBlock* ParameterInput::GetPtrToBlock(const std::string &name) const
 //  \brief return pointer to specified InputBlock if it exists
 
-InputBlock *ParameterInput::GetPtrToBlock(std::string name) {
-  InputBlock *pb;
-  for (pb = pfirst_block; pb != nullptr; pb = pb->pnext) {
-    if (name.compare(pb->block_name) == 0) return pb;
-  }
-  return nullptr;
+InputBlock *ParameterInput::GetPtrToBlock(const std::string &name) const {
+  auto it = block_index_.find(name);
+  return (it == block_index_.end()) ? nullptr : it->second;
 }
 
 //----------------------------------------------------------------------------------------
@@ -448,11 +434,9 @@ int ParameterInput::GetInteger(std::string block, std::string name) {
     ATHENA_ERROR(msg);
   }
 
-  std::string val = pl->param_value;
+  int val = pl->GetInteger();
   Unlock();
-
-  // Convert string to integer and return value
-  return atoi(val.c_str());
+  return val;
 }
 
 //----------------------------------------------------------------------------------------
@@ -483,11 +467,9 @@ Real ParameterInput::GetReal(std::string block, std::string name) {
     ATHENA_ERROR(msg);
   }
 
-  std::string val = pl->param_value;
+  Real val = pl->GetReal();
   Unlock();
-
-  // Convert string to real and return value
-  return static_cast<Real>(atof(val.c_str()));
+  return val;
 }
 
 //----------------------------------------------------------------------------------------
@@ -518,22 +500,9 @@ bool ParameterInput::GetBoolean(std::string block, std::string name) {
     ATHENA_ERROR(msg);
   }
 
-  std::string val = pl->param_value;
+  bool val = pl->GetBoolean();
   Unlock();
-
-  // check is string contains integers 0 or 1 (instead of true or false) and return
-  if (val.compare(0, 1, "0") == 0 || val.compare(0, 1, "1") == 0) {
-    return static_cast<bool>(atoi(val.c_str()));
-  }
-
-  // convert string to all lower case
-  std::transform(val.begin(), val.end(), val.begin(), ::tolower);
-  // Convert string to bool and return value
-  bool b;
-  std::istringstream is(val);
-  is >> std::boolalpha >> b;
-
-  return (b);
+  return val;
 }
 
 //----------------------------------------------------------------------------------------
@@ -587,8 +556,7 @@ int ParameterInput::GetOrAddInteger(std::string block, std::string name, int def
   if (DoesParameterExist(block, name)) {
     pb = GetPtrToBlock(block);
     pl = pb->GetPtrToLine(name);
-    std::string val = pl->param_value;
-    ret = atoi(val.c_str());
+    ret = pl->GetInteger();
   } else {
     pb = FindOrAddBlock(block);
     ss_value << def_value;
@@ -615,8 +583,7 @@ Real ParameterInput::GetOrAddReal(std::string block, std::string name, Real def_
   if (DoesParameterExist(block, name)) {
     pb = GetPtrToBlock(block);
     pl = pb->GetPtrToLine(name);
-    std::string val = pl->param_value;
-    ret = static_cast<Real>(atof(val.c_str()));
+    ret = pl->GetReal();
   } else {
     pb = FindOrAddBlock(block);
     ss_value << def_value;
@@ -644,14 +611,7 @@ bool ParameterInput::GetOrAddBoolean(std::string block, std::string name,
   if (DoesParameterExist(block, name)) {
     pb = GetPtrToBlock(block);
     pl = pb->GetPtrToLine(name);
-    std::string val = pl->param_value;
-    if (val.compare(0, 1, "0") == 0 || val.compare(0, 1, "1") == 0) {
-      ret = static_cast<bool>(atoi(val.c_str()));
-    } else {
-      std::transform(val.begin(), val.end(), val.begin(), ::tolower);
-      std::istringstream is(val);
-      is >> std::boolalpha >> ret;
-    }
+    ret = pl->GetBoolean();
   } else {
     pb = FindOrAddBlock(block);
     ss_value << def_value;
@@ -772,7 +732,7 @@ void ParameterInput::RollbackNextTime() {
             << "Parameter name 'next_time' not found in block '" << pb->block_name << "'";
         ATHENA_ERROR(msg);
       }
-      next_time = static_cast<Real>(atof(pl->param_value.c_str()));
+      next_time = pl->GetReal();
       pl = pb->GetPtrToLine("dt");
       if (pl == nullptr) {
         msg << "### FATAL ERROR in function [ParameterInput::RollbackNextTime]"
@@ -780,7 +740,7 @@ void ParameterInput::RollbackNextTime() {
             << "Parameter name 'dt' not found in block '" << pb->block_name << "'";
         ATHENA_ERROR(msg);
       }
-      next_time -= static_cast<Real>(atof(pl->param_value.c_str()));
+      next_time -= pl->GetReal();
       msg << next_time;
       // AddParameter(pb, "next_time", msg.str().c_str(), "# Updated during run time");
       SetReal(pb->block_name, "next_time", next_time);
@@ -809,7 +769,7 @@ void ParameterInput::ForwardNextTime(Real mesh_time) {
         // This is a freshly added output
         fresh = true;
       } else {
-        next_time = static_cast<Real>(atof(pl->param_value.c_str()));
+        next_time = pl->GetReal();
       }
       pl = pb->GetPtrToLine("dt");
       if (pl == nullptr) {
@@ -818,7 +778,7 @@ void ParameterInput::ForwardNextTime(Real mesh_time) {
             << "Parameter name 'dt' not found in block '" << pb->block_name << "'";
         ATHENA_ERROR(msg);
       }
-      dt0 = static_cast<Real>(atof(pl->param_value.c_str()));
+      dt0 = pl->GetReal();
       dt = dt0 * static_cast<int>((mesh_time - next_time) / dt0) + dt0;
       if (dt > 0) {
         next_time += dt;
@@ -866,14 +826,66 @@ void ParameterInput::ParameterDump(std::ostream &os) {
 }
 
 //----------------------------------------------------------------------------------------
-//! \fn InputLine* InputBlock::GetPtrToLine(std::string name)
+//! \fn InputLine* InputBlock::GetPtrToLine(const std::string &name) const
 //  \brief return pointer to InputLine containing specified parameter if it exists
 
-InputLine *InputBlock::GetPtrToLine(std::string name) {
-  for (InputLine *pl = pline; pl != nullptr; pl = pl->pnext) {
-    if (name.compare(pl->param_name) == 0) return pl;
+InputLine *InputBlock::GetPtrToLine(const std::string &name) const {
+  auto it = line_index_.find(name);
+  return (it == line_index_.end()) ? nullptr : it->second;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void InputLine::SetValue(const std::string &value)
+//  \brief replace the value string and drop the values parsed from the old one
+
+void InputLine::SetValue(const std::string &value) {
+  param_value.assign(value);
+  has_integer_ = has_real_ = has_boolean_ = false;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn int InputLine::GetInteger()
+//  \brief returns the value as integer, parsing the string only on the first call
+
+int InputLine::GetInteger() {
+  if (!has_integer_) {
+    integer_value_ = atoi(param_value.c_str());
+    has_integer_ = true;
+  }
+  return integer_value_;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn Real InputLine::GetReal()
+//  \brief returns the value as Real, parsing the string only on the first call
+
+Real InputLine::GetReal() {
+  if (!has_real_) {
+    real_value_ = static_cast<Real>(atof(param_value.c_str()));
+    has_real_ = true;
+  }
+  return real_value_;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn bool InputLine::GetBoolean()
+//  \brief returns the value as bool, parsing the string only on the first call
+
+bool InputLine::GetBoolean() {
+  if (!has_boolean_) {
+    std::string val = param_value;
+    // check is string contains integers 0 or 1 (instead of true or false)
+    if (val.compare(0, 1, "0") == 0 || val.compare(0, 1, "1") == 0) {
+      boolean_value_ = static_cast<bool>(atoi(val.c_str()));
+    } else {
+      // convert string to all lower case
+      std::transform(val.begin(), val.end(), val.begin(), ::tolower);
+      std::istringstream is(val);
+      is >> std::boolalpha >> boolean_value_;
+    }
+    has_boolean_ = true;
   }
-  return nullptr;
+  return boolean_value_;
 }
 
 //----------------------------------------------------------------------------------------
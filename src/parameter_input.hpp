@@ -25,6 +25,7 @@
 #include <cstddef>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 
 #include "athena.hpp"
 #include "defs.hpp"
@@ -45,6 +46,20 @@ struct InputLine {
   std::string param_value; // value of the parameter is stored as a string!
   std::string param_comment;
   InputLine *pnext; // pointer to the next node in this nested singly linked list
+
+  // replace the value, which also drops the values parsed from the previous one
+  void SetValue(const std::string &value);
+
+  // the value converted to the type, parsed on first use and cached
+  int GetInteger();
+  Real GetReal();
+  bool GetBoolean();
+
+ private:
+  bool has_integer_ = false, has_real_ = false, has_boolean_ = false;
+  int integer_value_;
+  Real real_value_;
+  bool boolean_value_;
 };
 
 //----------------------------------------------------------------------------------------
@@ -63,10 +78,16 @@ class InputBlock {
   InputBlock *pnext; // pointer to the next node in InputBlock singly linked list
 
   InputLine *pline; // pointer to head node in nested singly linked list (in this block)
-  // (not storing a reference to the tail node)
 
   // functions
-  InputLine *GetPtrToLine(std::string name);
+  InputLine *GetPtrToLine(const std::string &name) const;
+
+ private:
+  friend class ParameterInput;
+
+  InputLine *plast_line_ = nullptr; // tail node of the InputLine list
+  // the nodes of the InputLine list by parameter name
+  std::unordered_map<std::string, InputLine *> line_index_;
 };
 
 //----------------------------------------------------------------------------------------
@@ -83,7 +104,6 @@ class ParameterInput {
 
   // data
   InputBlock *pfirst_block; // pointer to head node in singly linked list of InputBlock
-  // (not storing a reference to the tail node)
 
   // functions
   void LoadFromStream(std::istream &is);
@@ -109,9 +129,12 @@ class ParameterInput {
 
  private:
   std::string last_filename_; // last input file opened, to prevent duplicate reads
+  InputBlock *plast_block_;   // tail node of the InputBlock list
+  // the nodes of the InputBlock list by block name
+  std::unordered_map<std::string, InputBlock *> block_index_;
 
   InputBlock *FindOrAddBlock(std::string name);
-  InputBlock *GetPtrToBlock(std::string name);
+  InputBlock *GetPtrToBlock(const std::string &name) const;
   void ParseLine(InputBlock *pib, std::string line, std::string &name, std::string &value,
                  std::string &comment);
   void AddParameter(InputBlock *pib, std::string name, std::string value,
@@ -119,6 +119,9 @@ class ParArrayNDGeneric {
   // function to get the label
   std::string label() const { return d6d_.label(); }
 
+  // number of arrays sharing the underlying allocation
+  int use_count() const { return d6d_.use_count(); }
+
   // functions to get array dimensions
   KOKKOS_INLINE_FUNCTION int GetDim(const int i) const {
     assert(0 < i && i <= 6 && "ParArrayNDGenerics are max 6D");
@@ -13,13 +13,25 @@
 
 #include "parthenon_manager.hpp"
 
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <utility>
 
 #include <Kokkos_Core.hpp>
 
 #include "driver/driver.hpp"
 #include "interface/update.hpp"
+#include "mesh/block_size_calibration.hpp"
+#include "outputs/io_wrapper.hpp"
+#include "outputs/restart.hpp"
 #include "refinement/refinement.hpp"
+#include "utils/loop_pattern_tuner.hpp"
+#include "utils/phase_timer.hpp"
+#include "utils/task_timer.hpp"
 
 namespace parthenon {
 
@@ -41,7 +53,10 @@ ParthenonStatus ParthenonManager::ParthenonInit(int argc, char *argv[]) {
     return ParthenonStatus::error;
   }
 #else  // no OpenMP
-  if (MPI_SUCCESS != MPI_Init(&argc, &argv)) {
+  // the MPI progress thread (<mesh>/progress_thread) needs MPI_THREAD_MULTIPLE, which
+  // the Mesh checks for when the option is set
+  int mpiprv;
+  if (MPI_SUCCESS != MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &mpiprv)) {
     std::cout << "### FATAL ERROR in ParthenonInit" << std::endl
               << "MPI Initialization failed." << std::endl;
     return ParthenonStatus::error;
@@ -81,8 +96,21 @@ ParthenonStatus ParthenonManager::ParthenonInit(int argc, char *argv[]) {
   SignalHandler::SignalHandlerInit();
   if (Globals::my_rank == 0 && arg.wtlim > 0) SignalHandler::SetWallTimeAlarm(arg.wtlim);
 
-  // Populate the ParameterInput object
-  if (arg.input_filename != nullptr) {
+  // Populate the ParameterInput object.  On restarts the parameters stored in the
+  // restart file are loaded first and may be overridden by an input file.
+  std::unique_ptr<RestartReader> restart;
+  if (Restart()) {
+    restart = std::make_unique<RestartReader>(RestartFilename().c_str());
+    pinput = std::make_unique<ParameterInput>();
+    std::istringstream is(restart->GetInputString());
+    pinput->LoadFromStream(is);
+    if (arg.input_filename != nullptr) {
+      IOWrapper infile;
+      infile.Open(arg.input_filename, IOWrapper::FileMode::read);
+      pinput->LoadFromFile(infile);
+      infile.Close();
+    }
+  } else if (arg.input_filename != nullptr) {
     pinput = std::make_unique<ParameterInput>(arg.input_filename);
   }
   pinput->ModifyFromCmdline(argc, argv);
@@ -94,12 +122,17 @@ ParthenonStatus ParthenonManager::ParthenonInit(int argc, char *argv[]) {
   // always add the Refinement package
   packages["ParthenonRefinement"] = Refinement::Initialize(pinput.get());
 
-  // TODO(jdolence): Deal with restarts
-  // if (arg.res_flag == 0) {
-  pmesh = std::make_unique<Mesh>(pinput.get(), properties, packages, arg.mesh_flag);
-  //} else {
-  //  pmesh = std::make_unique<Mesh>(pinput.get(), )
-  //}
+  if (Restart()) {
+    pmesh = std::make_unique<Mesh>(pinput.get(), *restart, properties, packages,
+                                   arg.mesh_flag);
+    restart.reset();
+  } else {
+    // with <meshblock>/calibrate, times the candidate block sizes and keeps the fastest
+    if (arg.mesh_flag == 0) {
+      BlockSizeCalibration::Calibrate(pinput.get(), properties, packages);
+    }
+    pmesh = std::make_unique<Mesh>(pinput.get(), properties, packages, arg.mesh_flag);
+  }
 
   // add root_level to all max_level
   for (auto const &ph : packages) {
@@ -113,6 +146,11 @@ ParthenonStatus ParthenonManager::ParthenonInit(int argc, char *argv[]) {
   pmesh->Initialize(Restart(), pinput.get());
 
   ChangeRunDir(arg.prundir);
+  // after changing the run directory, which holds the file of loop pattern choices
+  LoopPatternTuner::Get().Initialize(pinput.get());
+  TaskTimer::Get().Enable(pinput->GetOrAddBoolean("profiling", "task_timers", false));
+  PhaseTimer::Get().Enable(pinput->GetOrAddBoolean("profiling", "scaling_report", false));
+  memory_report_ = pinput->GetOrAddBoolean("profiling", "memory_report", false);
   pouts = std::make_unique<Outputs>(pmesh.get(), pinput.get());
 
   if (!Restart()) pouts->MakeOutputs(pmesh.get(), pinput.get());
@@ -120,12 +158,34 @@ ParthenonStatus ParthenonManager::ParthenonInit(int argc, char *argv[]) {
   return ParthenonStatus::ok;
 }
 
+std::string ParthenonManager::RestartFilename() {
+  std::string filename(arg.restart_filename);
+  if (arg.stage_dir == nullptr) return filename;
+  // a copy left on the burst buffer by the previous job is faster to read. Rank 0
+  // decides, so all ranks open the same file.
+  const std::size_t slash = filename.find_last_of('/');
+  const std::string staged = std::string(arg.stage_dir) + "/" +
+                             (slash == std::string::npos ? filename
+                                                         : filename.substr(slash + 1));
+  int found = (Globals::my_rank == 0 && std::ifstream(staged).good());
+#ifdef MPI_PARALLEL
+  MPI_Bcast(&found, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+  if (found && Globals::my_rank == 0) {
+    std::cout << "Restarting from the staged copy " << staged << std::endl;
+  }
+  return found ? staged : filename;
+}
+
 void ParthenonManager::PreDriver() {
+  // collective, printed on rank 0
+  if (memory_report_) pmesh->AccountMemory().Report(std::cout, "Memory after setup");
   if (Globals::my_rank == 0) {
     std::cout << std::endl << "Setup complete, entering main loop...\n" << std::endl;
   }
 
   tstart_ = clock();
+  PhaseTimer::Get().Start();
 #ifdef OPENMP_PARALLEL
   omp_start_time_ = omp_get_wtime();
 #endif
@@ -134,7 +194,11 @@ void ParthenonManager::PreDriver() {
 void ParthenonManager::PostDriver(DriverStatus driver_status) {
   if (Globals::my_rank == 0) SignalHandler::CancelWallTimeAlarm();
 
-  pouts->MakeOutputs(pmesh.get(), pinput.get());
+  {
+    // a run stopped early always writes a restart file, even between scheduled dumps
+    PhaseScope io(Phase::io);
+    pouts->MakeOutputs(pmesh.get(), pinput.get(), driver_status == DriverStatus::timeout);
+  }
 
   // Print diagnostic messages related to the end of the simulation
   if (Globals::my_rank == 0) {
@@ -166,8 +230,7 @@ void ParthenonManager::PostDriver(DriverStatus driver_status) {
     double cpu_time = (tstop > tstart_ ? static_cast<double>(tstop - tstart_) : 1.0) /
                       static_cast<double>(CLOCKS_PER_SEC);
     std::uint64_t zonecycles =
-        pmesh->mbcnt *
-        static_cast<std::uint64_t>(pmesh->pblock->GetNumberOfMeshBlockCells());
+        pmesh->mbcnt * static_cast<std::uint64_t>(pmesh->GetNumberOfMeshBlockCells());
     double zc_cpus = static_cast<double>(zonecycles) / cpu_time;
 
     std::cout << std::endl << "zone-cycles = " << zonecycles << std::endl;
@@ -179,10 +242,18 @@ void ParthenonManager::PostDriver(DriverStatus driver_status) {
     std::cout << "zone-cycles/omp_wsecond = " << zc_omps << std::endl;
 #endif
   }
+  // collective, printed on rank 0
+  TaskTimer::Get().Report(std::cout);
+  const std::uint64_t ncells = pmesh->GetNumberOfMeshBlockCells();
+  PhaseTimer::Get().Report(std::cout, pmesh->mbcnt * ncells, pmesh->ncycle);
+  if (memory_report_) pmesh->AccountMemory().Report(std::cout, "Memory at the end");
 }
 
 ParthenonStatus ParthenonManager::ParthenonFinalize() {
+  // finishes any asynchronous output before MPI is shut down
+  pouts.reset();
   pmesh.reset();
+  if (Globals::my_rank == 0) LoopPatternTuner::Get().Save();
   Kokkos::finalize();
 #ifdef MPI_PARALLEL
   MPI_Finalize();
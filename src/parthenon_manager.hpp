@@ -15,6 +15,7 @@
 #define PARTHENON_MANAGER_HPP_
 
 #include <memory>
+#include <string>
 
 #include "argument_parser.hpp"
 #include "driver/driver.hpp"
@@ -47,8 +48,12 @@ class ParthenonManager {
   std::unique_ptr<Outputs> pouts;
 
  private:
+  // the restart file given with -r, or its copy in the directory given with -s
+  std::string RestartFilename();
+
   ArgParse arg;
   clock_t tstart_;
+  bool memory_report_ = false; // <profiling>/memory_report
 #ifdef OPENMP_PARALLEL
   double omp_start_time_;
 #endif
@@ -0,0 +1,267 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef RECONSTRUCT_BLOCK_RECONSTRUCTION_HPP_
+#define RECONSTRUCT_BLOCK_RECONSTRUCTION_HPP_
+//! \file block_reconstruction.hpp
+//  \brief device kernels reconstructing all components of a MeshBlockPack in one launch,
+//         the block-level counterparts of the pencil functions of class Reconstruction
+
+#include <algorithm>
+#include <cmath>
+
+#include "athena.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+namespace BlockReconstruction {
+
+// The limiters turn the cell averages q(-stencil), ..., q(stencil) around a cell into
+// the states qm at its lower and qp at its upper face. Only uniform grid spacing in the
+// reconstruction direction is supported (Reconstruction::uniform[dir]), which makes
+// the interpolation coefficients of the pencil functions constants.
+
+//----------------------------------------------------------------------------------------
+//! \struct DonorCell
+//  \brief first order, the cell average on both faces
+
+struct DonorCell {
+  static constexpr int stencil = 0;
+  template <typename Stencil>
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Stencil &q, Real &qm, Real &qp) {
+    qm = q(0);
+    qp = q(0);
+  }
+};
+
+//----------------------------------------------------------------------------------------
+//! \struct PiecewiseLinear
+//  \brief van Leer limited slopes, as Reconstruction::PiecewiseLinearX*
+
+struct PiecewiseLinear {
+  static constexpr int stencil = 1;
+  template <typename Stencil>
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Stencil &q, Real &qm, Real &qp) {
+    const Real dql = q(0) - q(-1);
+    const Real dqr = q(1) - q(0);
+    const Real dq2 = dql * dqr;
+    const Real dqm = (dq2 <= 0.0) ? 0.0 : 2.0 * dq2 / (dql + dqr);
+    qm = q(0) - 0.5 * dqm;
+    qp = q(0) + 0.5 * dqm;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+//! \struct PiecewiseParabolic
+//  \brief fourth-order PPM with Colella-Sekora limiting, as the uniform-grid branch of
+//  Reconstruction::PiecewiseParabolicX*
+
+struct PiecewiseParabolic {
+  static constexpr int stencil = 2;
+  template <typename Stencil>
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Stencil &q, Real &qm, Real &qp) {
+    // CS08 constant used in second derivative limiter, >1 , independent of h
+    const Real C2 = 1.25;
+    const Real q_im2 = q(-2), q_im1 = q(-1), q_i = q(0), q_ip1 = q(1), q_ip2 = q(2);
+
+    // Step 1. interface averages at i-1/2 and i+1/2 (CW eq 1.6)
+    const Real qa0 = q_i - q_im1, qb0 = q_ip1 - q_i;
+    const Real dd_im1 = 0.5 * qa0 + 0.5 * (q_im1 - q_im2);
+    const Real dd = 0.5 * qb0 + 0.5 * qa0;
+    const Real dd_ip1 = 0.5 * (q_ip2 - q_ip1) + 0.5 * qb0;
+    Real dph = (0.5 * q_im1 + 0.5 * q_i) + (dd_im1 / 6.0 - dd / 6.0);
+    Real dph_ip1 = (0.5 * q_i + 0.5 * q_ip1) + (dd / 6.0 - dd_ip1 / 6.0);
+
+    // Step 2. limit the interpolated interface states (CD 4.3.1)
+    const Real d2qc_im1 = q_im2 + q_i - 2.0 * q_im1;
+    const Real d2qc = q_im1 + q_ip1 - 2.0 * q_i; // (CD eq 85a) (no 1/2)
+    const Real d2qc_ip1 = q_i + q_ip2 - 2.0 * q_ip1;
+    dph = LimitFace(q_im1, q_i, dph, d2qc_im1, d2qc, C2);
+    dph_ip1 = LimitFace(q_i, q_ip1, dph_ip1, d2qc, d2qc_ip1, C2);
+    const Real d2qf = 6.0 * (dph + dph_ip1 - 2.0 * q_i); // a6 coefficient * -2
+
+    // Step 3. cell-centered difference stencils (MC section 2.4.1)
+    qm = dph;
+    qp = dph_ip1;
+    const Real dqf_minus = q_i - qm;
+    const Real dqf_plus = qp - q_i;
+
+    // Step 4. CS limiters on the parabolic interpolant
+    const Real qa_tmp = dqf_minus * dqf_plus;
+    const Real qb_tmp = (q_ip1 - q_i) * (q_i - q_im1);
+    Real qe = 0.0;
+    if (SIGN(d2qc_im1) == SIGN(d2qc) && SIGN(d2qc_im1) == SIGN(d2qc_ip1) &&
+        SIGN(d2qc_im1) == SIGN(d2qf)) {
+      // Extrema is smooth (CS eq 22)
+      qe = SIGN(d2qf) *
+           std::min(std::min(C2 * std::abs(d2qc_im1), C2 * std::abs(d2qc)),
+                    std::min(C2 * std::abs(d2qc_ip1), std::abs(d2qf)));
+    }
+    // Check if 2nd derivative is close to roundoff error
+    const Real qa = std::max(std::abs(q_im1), std::abs(q_im2));
+    const Real qb = std::max(std::max(std::abs(q_i), std::abs(q_ip1)), std::abs(q_ip2));
+    Real rho = 0.0;
+    if (std::abs(d2qf) > (1.0e-12) * std::max(qa, qb)) {
+      // Limiter is not sensitive to roundoff. Use limited ratio (MC eq 27)
+      rho = qe / d2qf;
+    }
+    if (qa_tmp <= 0.0 || qb_tmp <= 0.0) {
+      // Local extrema, limit if relative change in limited 2nd deriv is > roundoff
+      if (rho <= (1.0 - (1.0e-12))) {
+        qm = q_i - rho * dqf_minus; // (CS eq 23)
+        qp = q_i + rho * dqf_plus;
+      }
+    } else {
+      // Overshoot i-1/2,R / i,(-) state
+      if (std::abs(dqf_minus) >= 2.0 * std::abs(dqf_plus)) qm = q_i - 2.0 * dqf_plus;
+      // Overshoot i+1/2,L / i,(+) state
+      if (std::abs(dqf_plus) >= 2.0 * std::abs(dqf_minus)) qp = q_i + 2.0 * dqf_minus;
+    }
+  }
+
+ private:
+  // smooth extrema preserving limit of the interface average dph between the cell
+  // averages ql and qr, given the second derivatives d2l and d2r in those cells
+  KOKKOS_FORCEINLINE_FUNCTION
+  static Real LimitFace(const Real ql, const Real qr, const Real dph, const Real d2l,
+                        const Real d2r, const Real C2) {
+    // KGF: add the off-centered quantities first to preserve FP symmetry
+    const Real qa = 3.0 * (ql + qr - 2.0 * dph); // (CD eq 85b)
+    Real qd = 0.0;
+    if (SIGN(qa) == SIGN(d2l) && SIGN(qa) == SIGN(d2r)) {
+      qd = SIGN(qa) *
+           std::min(C2 * std::abs(d2l), std::min(C2 * std::abs(d2r), std::abs(qa)));
+    }
+    // Local extrema detected at the face (CD eq 84a, 84b)
+    if ((dph - ql) * (qr - dph) < 0.0) return 0.5 * (ql + qr) - qd / 6.0;
+    return dph;
+  }
+};
+
+//----------------------------------------------------------------------------------------
+//! \struct WENO5
+//  \brief fifth-order WENO with the smoothness indicators and weights of Jiang & Shu
+//  (1996). Face() gives the upper face state of the middle cell of five, the lower
+//  face is the upper one of the mirrored stencil.
+
+struct WENO5 {
+  static constexpr int stencil = 2;
+  template <typename Stencil>
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Stencil &q, Real &qm, Real &qp) {
+    qm = Face<false>(q(2), q(1), q(0), q(-1), q(-2));
+    qp = Face<false>(q(-2), q(-1), q(0), q(1), q(2));
+  }
+
+  // with z, the weights of WENO-Z (Borges et al. 2008, Castro et al. 2011), which keep
+  // fifth order at critical points and are less dissipative
+  template <bool z>
+  KOKKOS_FORCEINLINE_FUNCTION static Real Face(const Real q_im2, const Real q_im1,
+                                               const Real q_i, const Real q_ip1,
+                                               const Real q_ip2) {
+    // candidate third-order interpolants of the three substencils
+    const Real f0 = (2.0 * q_im2 - 7.0 * q_im1 + 11.0 * q_i) / 6.0;
+    const Real f1 = (-q_im1 + 5.0 * q_i + 2.0 * q_ip1) / 6.0;
+    const Real f2 = (2.0 * q_i + 5.0 * q_ip1 - q_ip2) / 6.0;
+    // smoothness indicators
+    const Real b0 = (13.0 / 12.0) * SQR(q_im2 - 2.0 * q_im1 + q_i) +
+                    0.25 * SQR(q_im2 - 4.0 * q_im1 + 3.0 * q_i);
+    const Real b1 =
+        (13.0 / 12.0) * SQR(q_im1 - 2.0 * q_i + q_ip1) + 0.25 * SQR(q_im1 - q_ip1);
+    const Real b2 = (13.0 / 12.0) * SQR(q_i - 2.0 * q_ip1 + q_ip2) +
+                    0.25 * SQR(3.0 * q_i - 4.0 * q_ip1 + q_ip2);
+    Real a0, a1, a2;
+    if (z) {
+      const Real eps = 1.0e-40;
+      const Real tau5 = std::abs(b0 - b2);
+      a0 = 0.1 * (1.0 + SQR(tau5 / (b0 + eps)));
+      a1 = 0.6 * (1.0 + SQR(tau5 / (b1 + eps)));
+      a2 = 0.3 * (1.0 + SQR(tau5 / (b2 + eps)));
+    } else {
+      const Real eps = 1.0e-6;
+      a0 = 0.1 / SQR(b0 + eps);
+      a1 = 0.6 / SQR(b1 + eps);
+      a2 = 0.3 / SQR(b2 + eps);
+    }
+    return (a0 * f0 + a1 * f1 + a2 * f2) / (a0 + a1 + a2);
+  }
+};
+
+//----------------------------------------------------------------------------------------
+//! \struct WENOZ
+//  \brief fifth-order WENO-Z, WENO5 with the weights of Borges et al.
+
+struct WENOZ {
+  static constexpr int stencil = 2;
+  template <typename Stencil>
+  KOKKOS_FORCEINLINE_FUNCTION static void Faces(const Stencil &q, Real &qm, Real &qp) {
+    qm = WENO5::Face<true>(q(2), q(1), q(0), q(-1), q(-2));
+    qp = WENO5::Face<true>(q(-2), q(-1), q(0), q(1), q(2));
+  }
+};
+
+// the cell averages around cell i of a pencil staged in team scratch memory, row
+// o + stencil of the pencil holding the cells shifted by o in the reconstruction
+// direction
+template <int stencil>
+struct PencilStencil {
+  KOKKOS_FORCEINLINE_FUNCTION Real operator()(const int o) const {
+    return pencil(o + stencil, i);
+  }
+  const ScratchPad2D<Real> &pencil;
+  const int i;
+};
+
+//----------------------------------------------------------------------------------------
+//! \fn void Reconstruct()
+//  \brief For every cell (b, n, k, j, i) with k in [ks,ke], j in [js,je], i in [is,ie],
+//  set the left state ql on its upper face and the right state qr on its lower face in
+//  direction DIR, indexed like the fluxes (face i-1/2 of cell i has index i). So the
+//  cell range has to extend one cell below the first face that is needed.  Each team
+//  reconstructs one (b, n, k, j) pencil from a copy of the stencil in scratch memory.
+
+template <int DIR, typename Limiter>
+void Reconstruct(const MeshBlockPack<Real> &q, const MeshBlockPack<Real> &ql,
+                 const MeshBlockPack<Real> &qr, const int is, const int ie, const int js,
+                 const int je, const int ks, const int ke) {
+  constexpr int stencil = Limiter::stencil;
+  constexpr int nrow = 2 * stencil + 1;
+  constexpr int di = (DIR == X1DIR), dj = (DIR == X2DIR), dk = (DIR == X3DIR);
+  const int ni = ie - is + 1;
+  const int nvar = q.GetNVars();
+  const size_t scratch_size = ScratchPad2D<Real>::shmem_size(nrow, ni);
+  par_for_outer(
+      "BlockReconstruction::Reconstruct", DevSpace(), scratch_size, 0, 0,
+      q.GetNBlocks() - 1, 0, nvar - 1, ks, ke, js, je,
+      KOKKOS_LAMBDA(member_type team_member, const int b, const int n, const int k,
+                    const int j) {
+        ScratchPad2D<Real> pencil(team_member.team_scratch(0), nrow, ni);
+        par_for_inner(team_member, 0, nrow * ni - 1, [&](const int m) {
+          const int o = m / ni - stencil;
+          const int i = m % ni + is;
+          pencil(m / ni, i - is) = q(b, n, k + dk * o, j + dj * o, i + di * o);
+        });
+        team_member.team_barrier();
+
+        par_for_inner(team_member, is, ie, [&](const int i) {
+          Real qm, qp;
+          Limiter::Faces(PencilStencil<stencil>{pencil, i - is}, qm, qp);
+          qr(b, n, k, j, i) = qm;
+          ql(b, n, k + dk, j + dj, i + di) = qp;
+        });
+      });
+}
+
+} // namespace BlockReconstruction
+} // namespace parthenon
+
+#endif // RECONSTRUCT_BLOCK_RECONSTRUCTION_HPP_
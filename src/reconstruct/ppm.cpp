@@ -41,6 +41,72 @@
 
 namespace parthenon {
 
+namespace {
+
+// PPM interpolation coefficients of one direction (CW eq 1.6, 1.7). On a nonuniform
+// mesh they are read from the sliced arrays of Reconstruction, on a uniform one they
+// are the same constants in every cell, which the compiler folds into the loop.
+template <bool uniform>
+struct PPMCoefficients {
+  PPMCoefficients(const ParArrayND<Real> &c1, const ParArrayND<Real> &c2,
+                  const ParArrayND<Real> &c3, const ParArrayND<Real> &c4,
+                  const ParArrayND<Real> &c5, const ParArrayND<Real> &c6)
+      : c1_(c1), c2_(c2), c3_(c3), c4_(c4), c5_(c5), c6_(c6) {}
+  Real c1(const int l) const { return c1_(l); }
+  Real c2(const int l) const { return c2_(l); }
+  Real c3(const int l) const { return c3_(l); }
+  Real c4(const int l) const { return c4_(l); }
+  Real c5(const int l) const { return c5_(l); }
+  Real c6(const int l) const { return c6_(l); }
+  const ParArrayND<Real> &c1_, &c2_, &c3_, &c4_, &c5_, &c6_;
+};
+
+template <>
+struct PPMCoefficients<true> {
+  static constexpr Real c1(const int l) { return 0.5; }
+  static constexpr Real c2(const int l) { return 0.5; }
+  static constexpr Real c3(const int l) { return 0.5; }
+  static constexpr Real c4(const int l) { return 0.5; }
+  static constexpr Real c5(const int l) { return 1.0 / 6.0; }
+  static constexpr Real c6(const int l) { return -1.0 / 6.0; }
+};
+
+//----------------------------------------------------------------------------------------
+//! \fn void InterfaceAverages()
+//  \brief Step 1 of PPM: interface averages <a>_{-1/2} and <a>_{+1/2} of component n of
+//  the cached pencil q_m2, ..., q_p2 over [il,iu]. The coefficients are taken at l = i
+//  in x1 (di = 1, m = 0) and at l = m, the j or k of the pencil, in x2 and x3 (di = 0).
+
+template <bool uniform>
+void InterfaceAverages(const PPMCoefficients<uniform> &c, const int di, const int m,
+                       const int n, const int il, const int iu,
+                       const ParArrayND<Real> &q_m2, const ParArrayND<Real> &q_m1,
+                       const ParArrayND<Real> &q_0, const ParArrayND<Real> &q_p1,
+                       const ParArrayND<Real> &q_p2, ParArrayND<Real> &dd_m1,
+                       ParArrayND<Real> &dd, ParArrayND<Real> &dd_p1,
+                       ParArrayND<Real> &dph, ParArrayND<Real> &dph_p1) {
+  // Compute average slope in -1, 0, +1 zones
+#pragma omp simd simdlen(SIMD_WIDTH)
+  for (int i = il; i <= iu; ++i) {
+    const int l = di * i + m;
+    // nonuniform or uniform Cartesian-like coord reconstruction from volume averages:
+    Real qa = (q_0(n, i) - q_m1(n, i));
+    Real qb = (q_p1(n, i) - q_0(n, i));
+    dd_m1(i) = c.c1(l - 1) * qa + c.c2(l - 1) * (q_m1(n, i) - q_m2(n, i));
+    dd(i) = c.c1(l) * qb + c.c2(l) * qa;
+    dd_p1(i) = c.c1(l + 1) * (q_p2(n, i) - q_p1(n, i)) + c.c2(l + 1) * qb;
+
+    // Approximate interface average at -1/2 and +1/2 using PPM (CW eq 1.6)
+    // KGF: group the biased stencil quantities to preserve FP symmetry
+    dph(i) = (c.c3(l) * q_m1(n, i) + c.c4(l) * q_0(n, i)) +
+             (c.c5(l) * dd_m1(i) + c.c6(l) * dd(i));
+    dph_p1(i) = (c.c3(l + 1) * q_0(n, i) + c.c4(l + 1) * q_p1(n, i)) +
+                (c.c5(l + 1) * dd(i) + c.c6(l + 1) * dd_p1(i));
+  }
+}
+
+} // namespace
+
 //----------------------------------------------------------------------------------------
 //! \fn Reconstruction::PiecewiseParabolicX1()
 //  \brief Returns L/R interface values in X1-dir constructed using fourth-order PPM and
@@ -87,22 +153,13 @@ void Reconstruction::PiecewiseParabolicX1(const int k, const int j, const int il
   //--- Step 1. --------------------------------------------------------------------------
   // Reconstruct interface averages <a>_{i-1/2} and <a>_{i+1/2}
   for (int n = 0; n <= nu; ++n) {
-    // Compute average slope in i-1, i, i+1 zones
-#pragma omp simd simdlen(SIMD_WIDTH)
-    for (int i = il; i <= iu; ++i) {
-      // nonuniform or uniform Cartesian-like coord reconstruction from volume averages:
-      Real qa = (q_i(n, i) - q_im1(n, i));
-      Real qb = (q_ip1(n, i) - q_i(n, i));
-      dd_im1(i) = c1i(i - 1) * qa + c2i(i - 1) * (q_im1(n, i) - q_im2(n, i));
-      dd(i) = c1i(i) * qb + c2i(i) * qa;
-      dd_ip1(i) = c1i(i + 1) * (q_ip2(n, i) - q_ip1(n, i)) + c2i(i + 1) * qb;
-
-      // Approximate interface average at i-1/2 and i+1/2 using PPM (CW eq 1.6)
-      // KGF: group the biased stencil quantities to preserve FP symmetry
-      dph(i) = (c3i(i) * q_im1(n, i) + c4i(i) * q_i(n, i)) +
-               (c5i(i) * dd_im1(i) + c6i(i) * dd(i));
-      dph_ip1(i) = (c3i(i + 1) * q_i(n, i) + c4i(i + 1) * q_ip1(n, i)) +
-                   (c5i(i + 1) * dd(i) + c6i(i + 1) * dd_ip1(i));
+    if (uniform[X1DIR]) {
+      InterfaceAverages(PPMCoefficients<true>(), 1, 0, n, il, iu, q_im2, q_im1, q_i,
+                        q_ip1, q_ip2, dd_im1, dd, dd_ip1, dph, dph_ip1);
+    } else {
+      InterfaceAverages(PPMCoefficients<false>(c1i, c2i, c3i, c4i, c5i, c6i), 1, 0, n,
+                        il, iu, q_im2, q_im1, q_i, q_ip1, q_ip2, dd_im1, dd, dd_ip1, dph,
+                        dph_ip1);
     }
 
     //--- Step 2a. -----------------------------------------------------------------------
@@ -332,22 +389,13 @@ void Reconstruction::PiecewiseParabolicX2(const int k, const int j, const int il
   //--- Step 1. ------------------------------------------------------------------------
   // Reconstruct interface averages <a>_{j-1/2} and <a>_{j+1/2}
   for (int n = 0; n <= nu; ++n) {
-    // Compute average slope in j-1, j, j+1 zones
-#pragma omp simd simdlen(SIMD_WIDTH)
-    for (int i = il; i <= iu; ++i) {
-      // nonuniform or uniform Cartesian-like coord reconstruction from volume averages:
-      Real qa = (q_j(n, i) - q_jm1(n, i));
-      Real qb = (q_jp1(n, i) - q_j(n, i));
-      dd_jm1(i) = c1j(j - 1) * qa + c2j(j - 1) * (q_jm1(n, i) - q_jm2(n, i));
-      dd(i) = c1j(j) * qb + c2j(j) * qa;
-      dd_jp1(i) = c1j(j + 1) * (q_jp2(n, i) - q_jp1(n, i)) + c2j(j + 1) * qb;
-
-      // Approximate interface average at j-1/2 and j+1/2 using PPM (CW eq 1.6)
-      // KGF: group the biased stencil quantities to preserve FP symmetry
-      dph(i) = (c3j(j) * q_jm1(n, i) + c4j(j) * q_j(n, i)) +
-               (c5j(j) * dd_jm1(i) + c6j(j) * dd(i));
-      dph_jp1(i) = (c3j(j + 1) * q_j(n, i) + c4j(j + 1) * q_jp1(n, i)) +
-                   (c5j(j + 1) * dd(i) + c6j(j + 1) * dd_jp1(i));
+    if (uniform[X2DIR]) {
+      InterfaceAverages(PPMCoefficients<true>(), 0, j, n, il, iu, q_jm2, q_jm1, q_j,
+                        q_jp1, q_jp2, dd_jm1, dd, dd_jp1, dph, dph_jp1);
+    } else {
+      InterfaceAverages(PPMCoefficients<false>(c1j, c2j, c3j, c4j, c5j, c6j), 0, j, n,
+                        il, iu, q_jm2, q_jm1, q_j, q_jp1, q_jp2, dd_jm1, dd, dd_jp1, dph,
+                        dph_jp1);
     }
 
     //--- Step 2a. ---------------------------------------------------------------------
@@ -576,22 +624,13 @@ void Reconstruction::PiecewiseParabolicX3(const int k, const int j, const int il
   //--- Step 1. -------------------------------------------------------------------------
   // Reconstruct interface averages <a>_{k-1/2} and <a>_{k+1/2}
   for (int n = 0; n <= nu; ++n) {
-    // Compute average slope in k-1, k, k+1 zones
-#pragma omp simd simdlen(SIMD_WIDTH)
-    for (int i = il; i <= iu; ++i) {
-      // nonuniform or uniform Cartesian-like coord reconstruction from volume averages:
-      Real qa = (q_k(n, i) - q_km1(n, i));
-      Real qb = (q_kp1(n, i) - q_k(n, i));
-      dd_km1(i) = c1k(k - 1) * qa + c2k(k - 1) * (q_km1(n, i) - q_km2(n, i));
-      dd(i) = c1k(k) * qb + c2k(k) * qa;
-      dd_kp1(i) = c1k(k + 1) * (q_kp2(n, i) - q_kp1(n, i)) + c2k(k + 1) * qb;
-
-      // Approximate interface average at k-1/2 and k+1/2 using PPM (CW eq 1.6)
-      // KGF: group the biased stencil quantities to preserve FP symmetry
-      dph(i) = (c3k(k) * q_km1(n, i) + c4k(k) * q_k(n, i)) +
-               (c5k(k) * dd_km1(i) + c6k(k) * dd(i));
-      dph_kp1(i) = (c3k(k + 1) * q_k(n, i) + c4k(k + 1) * q_kp1(n, i)) +
-                   (c5k(k + 1) * dd(i) + c6k(k + 1) * dd_kp1(i));
+    if (uniform[X3DIR]) {
+      InterfaceAverages(PPMCoefficients<true>(), 0, k, n, il, iu, q_km2, q_km1, q_k,
+                        q_kp1, q_kp2, dd_km1, dd, dd_kp1, dph, dph_kp1);
+    } else {
+      InterfaceAverages(PPMCoefficients<false>(c1k, c2k, c3k, c4k, c5k, c6k), 0, k, n,
+                        il, iu, q_km2, q_km1, q_k, q_kp1, q_kp2, dd_km1, dd, dd_kp1, dph,
+                        dph_kp1);
     }
 
     //--- Step 2a. -----------------------------------------------------------------------
@@ -41,7 +41,7 @@ void DoolittleLUPSolve(Real **lu, int *pivot, Real *b, int n, Real *x);
 } // anonymous namespace
 
 Reconstruction::Reconstruction(MeshBlock *pmb, ParameterInput *pin)
-    : characteristic_projection{false}, uniform{true, true, true},
+    : characteristic_projection{false}, weno_z{false}, uniform{true, true, true},
       // read fourth-order solver switches
       correct_ic{pin->GetOrAddBoolean("time", "correct_ic", false)},
       correct_err{pin->GetOrAddBoolean("time", "correct_err", false)}, pmy_block_{pmb} {
@@ -66,6 +66,9 @@ Reconstruction::Reconstruction(MeshBlock *pmb, ParameterInput *pin)
   } else if ((input_recon == "4") || (input_recon == "4c")) {
     xorder = 4;
     if (input_recon == "4c") characteristic_projection = true;
+  } else if ((input_recon == "5") || (input_recon == "5z")) {
+    xorder = 5;
+    if (input_recon == "5z") weno_z = true;
   } else {
     std::stringstream msg;
     msg << "### FATAL ERROR in Reconstruction constructor" << std::endl
@@ -89,6 +92,27 @@ Reconstruction::Reconstruction(MeshBlock *pmb, ParameterInput *pin)
     }
   }
 
+  // WENO5 uses the weights for uniform spacing and a five cell stencil
+  if (xorder == 5) {
+    if (pmb->block_size.x1rat != 1.0 || pmb->block_size.x2rat != 1.0 ||
+        pmb->block_size.x3rat != 1.0) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in Reconstruction constructor" << std::endl
+          << "xorder=" << input_recon << " (WENO5) reconstruction requires a uniform "
+          << "(x1rat=x2rat=x3rat=1.0) mesh" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+    int req_nghost = 3;
+    if (NGHOST < req_nghost) {
+      std::stringstream msg;
+      msg << "### FATAL ERROR in Reconstruction constructor" << std::endl
+          << "xorder=" << input_recon
+          << " (WENO5) reconstruction selected, but nghost=" << NGHOST << std::endl
+          << "Reconfigure with --nghost=XXX with XXX > " << req_nghost - 1 << std::endl;
+      ATHENA_ERROR(msg);
+    }
+  }
+
   // perform checks of fourth-order solver configuration restrictions:
   if (xorder == 4) {
     // Uniform, Cartesian mesh with square cells (dx1f=dx2f=dx3f)
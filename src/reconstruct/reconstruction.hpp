@@ -41,6 +41,7 @@ class Reconstruction {
   // switches for reconstruction method variants:
   int xorder; // roughly the formal order of accuracy of overall reconstruction method
   bool characteristic_projection;
+  bool weno_z; // xorder=5 uses the WENO-Z instead of the Jiang & Shu weights
   bool uniform[3];
   // (Cartesian reconstruction formulas are used for x3 azimuthal coordinate in both
   // cylindrical and spherical-polar coordinates)
@@ -135,6 +136,15 @@ class Reconstruction {
                             const ParArrayND<Real> &q, ParArrayND<Real> &ql,
                             ParArrayND<Real> &qr);
 
+  void WENO5X1(const int k, const int j, const int il, const int iu,
+               const ParArrayND<Real> &q, ParArrayND<Real> &ql, ParArrayND<Real> &qr);
+
+  void WENO5X2(const int k, const int j, const int il, const int iu,
+               const ParArrayND<Real> &q, ParArrayND<Real> &ql, ParArrayND<Real> &qr);
+
+  void WENO5X3(const int k, const int j, const int il, const int iu,
+               const ParArrayND<Real> &q, ParArrayND<Real> &ql, ParArrayND<Real> &qr);
+
  private:
   MeshBlock *pmy_block_; // ptr to MeshBlock containing this Reconstruction
 
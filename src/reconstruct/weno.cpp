@@ -0,0 +1,111 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file weno.cpp
+//  \brief fifth-order WENO reconstruction (Jiang & Shu or WENO-Z weights) for uniform
+//  meshes. Operates on the entire nx4 range of a single ParArrayND<Real> input (no MHD).
+
+// REFERENCES:
+// (JS) G.-S. Jiang & C.-W. Shu, "Efficient implementation of weighted ENO schemes", JCP,
+// 126, 202 (1996)
+//
+// (Borges) R. Borges, M. Carmona, B. Costa, W.S. Don, "An improved weighted essentially
+// non-oscillatory scheme for hyperbolic conservation laws", JCP, 227, 3191 (2008)
+//========================================================================================
+
+#include "reconstruct/block_reconstruction.hpp"
+#include "reconstruct/reconstruction.hpp"
+
+namespace parthenon {
+
+namespace {
+
+// reconstruct the pencil of cells (k, j, il..iu) in the direction (dk, dj, di), setting
+// qm to the lower and qp to the upper face state of each cell
+template <bool z>
+void WENO5Pencil(const int k, const int j, const int il, const int iu, const int dk,
+                 const int dj, const int di, const ParArrayND<Real> &q,
+                 ParArrayND<Real> &qm, ParArrayND<Real> &qp) {
+  using BlockReconstruction::WENO5;
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+#pragma omp simd simdlen(SIMD_WIDTH)
+    for (int i = il; i <= iu; ++i) {
+      const Real q_im2 = q(n, k - 2 * dk, j - 2 * dj, i - 2 * di);
+      const Real q_im1 = q(n, k - dk, j - dj, i - di);
+      const Real q_i = q(n, k, j, i);
+      const Real q_ip1 = q(n, k + dk, j + dj, i + di);
+      const Real q_ip2 = q(n, k + 2 * dk, j + 2 * dj, i + 2 * di);
+      qm(n, i) = WENO5::Face<z>(q_ip2, q_ip1, q_i, q_im1, q_im2);
+      qp(n, i) = WENO5::Face<z>(q_im2, q_im1, q_i, q_ip1, q_ip2);
+    }
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn Reconstruction::WENO5X1()
+//  \brief reconstruct L/R surfaces of the i-th cells
+
+void Reconstruction::WENO5X1(const int k, const int j, const int il, const int iu,
+                             const ParArrayND<Real> &q, ParArrayND<Real> &ql,
+                             ParArrayND<Real> &qr) {
+  // set work arrays to shallow copies of scratch arrays
+  ParArrayND<Real> &qm = scr1_ni_, &qp = scr2_ni_;
+  if (weno_z) {
+    WENO5Pencil<true>(k, j, il, iu, 0, 0, 1, q, qm, qp);
+  } else {
+    WENO5Pencil<false>(k, j, il, iu, 0, 0, 1, q, qm, qp);
+  }
+  // compute ql_(i+1/2) and qr_(i-1/2)
+  const int nu = q.GetDim(4) - 1;
+  for (int n = 0; n <= nu; ++n) {
+#pragma omp simd
+    for (int i = il; i <= iu; ++i) {
+      ql(n, i + 1) = qp(n, i);
+      qr(n, i) = qm(n, i);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn Reconstruction::WENO5X2()
+//  \brief reconstruct L/R surfaces of the j-th cells
+
+void Reconstruction::WENO5X2(const int k, const int j, const int il, const int iu,
+                             const ParArrayND<Real> &q, ParArrayND<Real> &ql,
+                             ParArrayND<Real> &qr) {
+  // ql_(j+1/2) and qr_(j-1/2)
+  if (weno_z) {
+    WENO5Pencil<true>(k, j, il, iu, 0, 1, 0, q, qr, ql);
+  } else {
+    WENO5Pencil<false>(k, j, il, iu, 0, 1, 0, q, qr, ql);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn Reconstruction::WENO5X3()
+//  \brief reconstruct L/R surfaces of the k-th cells
+
+void Reconstruction::WENO5X3(const int k, const int j, const int il, const int iu,
+                             const ParArrayND<Real> &q, ParArrayND<Real> &ql,
+                             ParArrayND<Real> &qr) {
+  // ql_(k+1/2) and qr_(k-1/2)
+  if (weno_z) {
+    WENO5Pencil<true>(k, j, il, iu, 1, 0, 0, q, qr, ql);
+  } else {
+    WENO5Pencil<false>(k, j, il, iu, 1, 0, 0, q, qr, ql);
+  }
+}
+
+} // namespace parthenon
@@ -12,10 +12,15 @@
 //========================================================================================
 #include "refinement/amr_criteria.hpp"
 
+#include <limits>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "interface/container.hpp"
+#include "interface/meshblock_pack.hpp"
 #include "interface/variable.hpp"
+#include "mesh/mesh.hpp"
 #include "parameter_input.hpp"
 #include "refinement/refinement.hpp"
 
@@ -26,18 +31,31 @@ std::shared_ptr<AMRCriteria> AMRCriteria::MakeAMRCriteria(std::string &criteria,
                                                           std::string &block_name) {
   if (criteria == "derivative_order_1")
     return std::make_shared<AMRFirstDerivative>(pin, block_name);
+  if (criteria == "derivative_order_2")
+    return std::make_shared<AMRSecondDerivative>(pin, block_name);
+  if (criteria == "gradient") return std::make_shared<AMRGradient>(pin, block_name);
+  if (criteria == "minmax") return std::make_shared<AMRMinMax>(pin, block_name);
   throw std::invalid_argument("\n  Invalid selection for refinment method in " +
                               block_name + ": " + criteria);
 }
 
-AMRFirstDerivative::AMRFirstDerivative(ParameterInput *pin, std::string &block_name) {
+std::vector<AmrTag> AMRCriteria::operator()(Mesh *pmesh) {
+  std::vector<AmrTag> tags;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    tags.push_back((*this)(pmb->real_containers.Get()));
+  }
+  return tags;
+}
+
+AMRCriteria::AMRCriteria(ParameterInput *pin, std::string &block_name,
+                         const Real refine_default, const Real derefine_default) {
   field = pin->GetOrAddString(block_name, "field", "NO FIELD WAS SET");
   if (field == "NO FIELD WAS SET") {
     std::cerr << "Error in " << block_name << ": no field set" << std::endl;
     exit(1);
   }
-  refine_criteria = pin->GetOrAddReal(block_name, "refine_tol", 0.5);
-  derefine_criteria = pin->GetOrAddReal(block_name, "derefine_tol", 0.05);
+  refine_criteria = pin->GetOrAddReal(block_name, "refine_tol", refine_default);
+  derefine_criteria = pin->GetOrAddReal(block_name, "derefine_tol", derefine_default);
   int global_max_level = pin->GetOrAddInteger("mesh", "numlevel", 1);
   max_level = pin->GetOrAddInteger(block_name, "max_level", global_max_level);
   if (max_level > global_max_level) {
@@ -52,9 +70,72 @@ AMRFirstDerivative::AMRFirstDerivative(ParameterInput *pin, std::string &block_n
   }
 }
 
+AMRFirstDerivative::AMRFirstDerivative(ParameterInput *pin, std::string &block_name)
+    : AMRCriteria(pin, block_name) {}
+
 AmrTag AMRFirstDerivative::operator()(Container<Real> &rc) {
   CellVariable<Real> &q = rc.Get(field);
   return Refinement::FirstDerivative(q, refine_criteria, derefine_criteria);
 }
 
+std::vector<AmrTag> AMRFirstDerivative::operator()(Mesh *pmesh) {
+  auto q = PackVariablesOnMesh(pmesh, "base", std::vector<std::string>{field});
+  return Refinement::FirstDerivative(q, refine_criteria, derefine_criteria);
+}
+
+// Lohner's estimator is bounded by one, so the tolerances are not those of the others
+AMRSecondDerivative::AMRSecondDerivative(ParameterInput *pin, std::string &block_name)
+    : AMRCriteria(pin, block_name, 0.8, 0.2) {
+  filter = pin->GetOrAddReal(block_name, "filter", 0.01);
+}
+
+AmrTag AMRSecondDerivative::operator()(Container<Real> &rc) {
+  CellVariable<Real> &q = rc.Get(field);
+  return Refinement::SecondDerivative(q, refine_criteria, derefine_criteria, filter);
+}
+
+std::vector<AmrTag> AMRSecondDerivative::operator()(Mesh *pmesh) {
+  auto q = PackVariablesOnMesh(pmesh, "base", std::vector<std::string>{field});
+  return Refinement::SecondDerivative(q, refine_criteria, derefine_criteria, filter);
+}
+
+AMRGradient::AMRGradient(ParameterInput *pin, std::string &block_name)
+    : AMRCriteria(pin, block_name) {}
+
+AmrTag AMRGradient::operator()(Container<Real> &rc) {
+  CellVariable<Real> &q = rc.Get(field);
+  return Refinement::Gradient(q, refine_criteria, derefine_criteria);
+}
+
+std::vector<AmrTag> AMRGradient::operator()(Mesh *pmesh) {
+  auto q = PackVariablesOnMesh(pmesh, "base", std::vector<std::string>{field});
+  return Refinement::Gradient(q, refine_criteria, derefine_criteria);
+}
+
+AMRMinMax::AMRMinMax(ParameterInput *pin, std::string &block_name)
+    : AMRCriteria(pin, block_name) {}
+
+AMRMinMax::AMRMinMax(const std::string &field_name, const Real refine_tol,
+                     const Real derefine_tol, const int max_lev) {
+  field = field_name;
+  refine_criteria = refine_tol;
+  derefine_criteria = derefine_tol;
+  max_level = max_lev;
+}
+
+AmrTag AMRMinMax::operator()(Container<Real> &rc) {
+  Real qmin = std::numeric_limits<Real>::max();
+  Real qmax = std::numeric_limits<Real>::lowest();
+  MeshBlock *pmb = rc.pmy_block;
+  if (pmb->pmr == nullptr || !pmb->pmr->GetFusedExtrema(field, qmin, qmax))
+    Refinement::MinMax(pmb, rc.Get(field), qmin, qmax);
+  return Tag(qmin, qmax);
+}
+
+AmrTag AMRMinMax::Tag(const Real qmin, const Real qmax) const {
+  if (qmax > refine_criteria && qmin < derefine_criteria) return AmrTag::refine;
+  if (qmax < derefine_criteria) return AmrTag::derefine;
+  return AmrTag::same;
+}
+
 } // namespace parthenon
@@ -15,18 +15,26 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "athena.hpp"
 #include "interface/container.hpp"
 
 namespace parthenon {
 
+class Mesh;
 class ParameterInput;
 
 struct AMRCriteria {
   AMRCriteria() = default;
+  // reads field, refine_tol, derefine_tol and max_level from the input block
+  AMRCriteria(ParameterInput *pin, std::string &block_name,
+              const Real refine_default = 0.5, const Real derefine_default = 0.05);
   virtual ~AMRCriteria() {}
   virtual AmrTag operator()(Container<Real> &rc) = 0;
+  // tags for all blocks of the rank, in the order of the Mesh::pblock list.  By default
+  // this calls the per-block version on each block.
+  virtual std::vector<AmrTag> operator()(Mesh *pmesh);
   std::string field;
   Real refine_criteria, derefine_criteria;
   int max_level;
@@ -37,6 +45,33 @@ struct AMRCriteria {
 struct AMRFirstDerivative : public AMRCriteria {
   AMRFirstDerivative(ParameterInput *pin, std::string &block_name);
   AmrTag operator()(Container<Real> &rc);
+  std::vector<AmrTag> operator()(Mesh *pmesh);
+};
+
+struct AMRSecondDerivative : public AMRCriteria {
+  AMRSecondDerivative(ParameterInput *pin, std::string &block_name);
+  AmrTag operator()(Container<Real> &rc);
+  std::vector<AmrTag> operator()(Mesh *pmesh);
+  Real filter;
+};
+
+struct AMRGradient : public AMRCriteria {
+  AMRGradient(ParameterInput *pin, std::string &block_name);
+  AmrTag operator()(Container<Real> &rc);
+  std::vector<AmrTag> operator()(Mesh *pmesh);
+};
+
+// refines blocks that hold both values above refine_tol and below derefine_tol, i.e. a
+// front of the field, and derefines blocks whose values all stay below derefine_tol.
+// Needs only the min and max of component 0 over the interior of the block, which the
+// update kernels of the last stage reduce on the fly when asked to (see
+// Update::StageUpdateInRegions), so the tagging makes no pass over the data then.
+struct AMRMinMax : public AMRCriteria {
+  AMRMinMax(ParameterInput *pin, std::string &block_name);
+  AMRMinMax(const std::string &field_name, const Real refine_tol,
+            const Real derefine_tol, const int max_lev);
+  AmrTag operator()(Container<Real> &rc);
+  AmrTag Tag(const Real qmin, const Real qmax) const;
 };
 
 } // namespace parthenon
@@ -14,18 +14,216 @@
 #include "refinement/refinement.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <exception>
+#include <limits>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "interface/state_descriptor.hpp"
+#include "interface/update.hpp"
+#include "kokkos_abstraction.hpp"
 #include "mesh/mesh.hpp"
+#include "mesh/mesh_refinement.hpp"
 #include "parameter_input.hpp"
 #include "refinement/amr_criteria.hpp"
 
 namespace parthenon {
 namespace Refinement {
 
+namespace {
+
+// The criteria are a maximum over the block of an estimator evaluated with a three
+// point stencil in every active direction.  Each estimator has a member
+//   template <int NDIM, typename V> Real Estimate(const V &q, k, j, i)
+// for NDIM active directions, so that the kernels are compiled for each dimensionality
+// without checks of the active directions in the loop body.
+
+// largest relative first difference
+struct FirstDifferenceEstimator {
+  template <int NDIM, typename V>
+  KOKKOS_INLINE_FUNCTION Real Estimate(const V &q, const int k, const int j,
+                                       const int i) const {
+    const Real scale = std::abs(q(k, j, i)) + TINY_NUMBER;
+    Real maxd = 0.5 * std::abs((q(k, j, i + 1) - q(k, j, i - 1))) / scale;
+    if (NDIM >= 2) {
+      const Real d = 0.5 * std::abs((q(k, j + 1, i) - q(k, j - 1, i))) / scale;
+      maxd = (d > maxd ? d : maxd);
+    }
+    if (NDIM >= 3) {
+      const Real d = 0.5 * std::abs((q(k + 1, j, i) - q(k - 1, j, i))) / scale;
+      maxd = (d > maxd ? d : maxd);
+    }
+    return maxd;
+  }
+};
+
+// Lohner's estimator: the second difference normalized by the sum of the first
+// differences plus a filter on the magnitude, which keeps small wiggles from refining
+struct SecondDifferenceEstimator {
+  Real filter;
+  KOKKOS_INLINE_FUNCTION void Add(const Real qm, const Real q0, const Real qp, Real &num,
+                                  Real &den) const {
+    const Real d2 = qp - 2.0 * q0 + qm;
+    const Real d1 = std::abs(qp - q0) + std::abs(q0 - qm) +
+                    filter * (std::abs(qp) + 2.0 * std::abs(q0) + std::abs(qm));
+    num += d2 * d2;
+    den += d1 * d1;
+  }
+  template <int NDIM, typename V>
+  KOKKOS_INLINE_FUNCTION Real Estimate(const V &q, const int k, const int j,
+                                       const int i) const {
+    Real num = 0.0, den = 0.0;
+    Add(q(k, j, i - 1), q(k, j, i), q(k, j, i + 1), num, den);
+    if (NDIM >= 2) Add(q(k, j - 1, i), q(k, j, i), q(k, j + 1, i), num, den);
+    if (NDIM >= 3) Add(q(k - 1, j, i), q(k, j, i), q(k + 1, j, i), num, den);
+    return std::sqrt(num / (den + TINY_NUMBER));
+  }
+};
+
+// magnitude of the gradient (per cell width) relative to the value
+struct GradientEstimator {
+  template <int NDIM, typename V>
+  KOKKOS_INLINE_FUNCTION Real Estimate(const V &q, const int k, const int j,
+                                       const int i) const {
+    Real d = q(k, j, i + 1) - q(k, j, i - 1);
+    Real g2 = d * d;
+    if (NDIM >= 2) {
+      d = q(k, j + 1, i) - q(k, j - 1, i);
+      g2 += d * d;
+    }
+    if (NDIM >= 3) {
+      d = q(k + 1, j, i) - q(k - 1, j, i);
+      g2 += d * d;
+    }
+    return 0.5 * std::sqrt(g2) / (std::abs(q(k, j, i)) + TINY_NUMBER);
+  }
+};
+
+KOKKOS_INLINE_FUNCTION AmrTag TagFromMax(const Real maxd, const Real refine_criteria,
+                                         const Real derefine_criteria) {
+  if (maxd > refine_criteria) return AmrTag::refine;
+  if (maxd < derefine_criteria) return AmrTag::derefine;
+  return AmrTag::same;
+}
+
+// the cells skipping one layer on each side of the active directions
+void InteriorBounds(const int dim1, const int dim2, const int dim3, int &kl, int &ku,
+                    int &jl, int &ju, int &il, int &iu) {
+  kl = 0, ku = 0, jl = 0, ju = 0, il = 0, iu = 0;
+  if (dim3 > 1) {
+    kl = 1;
+    ku = dim3 - 2;
+  }
+  if (dim2 > 1) {
+    jl = 1;
+    ju = dim2 - 2;
+  }
+  if (dim1 > 1) {
+    il = 1;
+    iu = dim1 - 2;
+  }
+}
+
+// number of active directions of arrays with the given extents
+int ActiveDims(const int dim2, const int dim3) {
+  return (dim3 > 1) ? 3 : ((dim2 > 1) ? 2 : 1);
+}
+
+// maximum of the estimator over the interior of a single block
+template <int NDIM, typename Estimator>
+Real MaxOverBlock(const std::string &name, const ParArrayND<Real> &q,
+                  const Estimator &estimate) {
+  int kl, ku, jl, ju, il, iu;
+  InteriorBounds(q.GetDim(1), q.GetDim(2), q.GetDim(3), kl, ku, jl, ju, il, iu);
+  Real maxd = 0.0;
+  par_reduce(
+      name, DevSpace(), kl, ku, jl, ju, il, iu,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lmaxd) {
+        const Real d = estimate.template Estimate<NDIM>(q, k, j, i);
+        lmaxd = (d > lmaxd ? d : lmaxd);
+      },
+      Kokkos::Max<Real>(maxd));
+  return maxd;
+}
+
+// tag a single block by the maximum of the estimator over the block
+template <typename Estimator>
+AmrTag TagBlock(const std::string &name, const ParArrayND<Real> &q,
+                const Estimator &estimate, const Real refine_criteria,
+                const Real derefine_criteria) {
+  Real maxd;
+  switch (ActiveDims(q.GetDim(2), q.GetDim(3))) {
+  case 1:
+    maxd = MaxOverBlock<1>(name, q, estimate);
+    break;
+  case 2:
+    maxd = MaxOverBlock<2>(name, q, estimate);
+    break;
+  default:
+    maxd = MaxOverBlock<3>(name, q, estimate);
+  }
+  return TagFromMax(maxd, refine_criteria, derefine_criteria);
+}
+
+// tag every block of a pack in one launch, with one team per block
+template <int NDIM, typename Estimator>
+void TagPackBlocks(const std::string &name, const MeshBlockPack<Real> &q,
+                   const Estimator &estimate, const Real refine_criteria,
+                   const Real derefine_criteria, const ParArray1D<AmrTag> &tags) {
+  const int nblocks = q.GetNBlocks();
+  int kl, ku, jl, ju, il, iu;
+  InteriorBounds(q.GetDim(1), q.GetDim(2), q.GetDim(3), kl, ku, jl, ju, il, iu);
+  const int ni = iu + 1 - il, nj = ju + 1 - jl, nk = ku + 1 - kl;
+  Kokkos::parallel_for(
+      name, team_policy(DevSpace(), nblocks, Kokkos::AUTO),
+      KOKKOS_LAMBDA(member_type team_member) {
+        const int b = team_member.league_rank();
+        const ParArray3D<Real> &qb = q(b, 0);
+        Real maxd = 0.0;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange<>(team_member, nk * nj * ni),
+            [&](const int idx, Real &lmaxd) {
+              const int k = kl + idx / (nj * ni);
+              const int j = jl + (idx / ni) % nj;
+              const int i = il + idx % ni;
+              const Real d = estimate.template Estimate<NDIM>(qb, k, j, i);
+              lmaxd = (d > lmaxd ? d : lmaxd);
+            },
+            Kokkos::Max<Real>(maxd));
+        Kokkos::single(Kokkos::PerTeam(team_member), [&]() {
+          tags(b) = TagFromMax(maxd, refine_criteria, derefine_criteria);
+        });
+      });
+}
+
+// tag every block of a pack.  Only the tags go back to the host.
+template <typename Estimator>
+std::vector<AmrTag> TagPack(const std::string &name, const MeshBlockPack<Real> &q,
+                            const Estimator &estimate, const Real refine_criteria,
+                            const Real derefine_criteria) {
+  const int nblocks = q.GetNBlocks();
+  if (nblocks == 0) return std::vector<AmrTag>();
+  ParArray1D<AmrTag> tags(name + " tags", nblocks);
+  switch (ActiveDims(q.GetDim(2), q.GetDim(3))) {
+  case 1:
+    TagPackBlocks<1>(name, q, estimate, refine_criteria, derefine_criteria, tags);
+    break;
+  case 2:
+    TagPackBlocks<2>(name, q, estimate, refine_criteria, derefine_criteria, tags);
+    break;
+  default:
+    TagPackBlocks<3>(name, q, estimate, refine_criteria, derefine_criteria, tags);
+  }
+  auto tags_h = Kokkos::create_mirror_view(tags);
+  Kokkos::deep_copy(tags_h, tags);
+  return std::vector<AmrTag>(tags_h.data(), tags_h.data() + nblocks);
+}
+
+} // namespace
+
 std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin) {
   auto ref = std::make_shared<StateDescriptor>("Refinement");
 
@@ -56,6 +254,7 @@ AmrTag CheckAllRefinement(Container<Real> &rc) {
   //       tagged as "derefine" must be left alone (or possibly refined?) because of
   //       neighboring blocks.  Similarly for "do nothing"
   MeshBlock *pmb = rc.pmy_block;
+  FillDerivedVariables::FillOnDemand(rc);
   // delta_level holds the max over all criteria.  default to derefining.
   AmrTag delta_level = AmrTag::derefine;
   for (auto &pkg : pmb->packages) {
@@ -88,47 +287,112 @@ AmrTag CheckAllRefinement(Container<Real> &rc) {
   return delta_level;
 }
 
-AmrTag FirstDerivative(CellVariable<Real> &q, const Real refine_criteria,
-                       const Real derefine_criteria) {
-  Real maxd = 0.0;
-  const int dim1 = q.GetDim(1);
-  const int dim2 = q.GetDim(2);
-  const int dim3 = q.GetDim(3);
-  int kl = 0, ku = 0, jl = 0, ju = 0, il = 0, iu = 0;
-  if (dim3 > 1) {
-    kl = 1;
-    ku = dim3 - 2;
-  }
-  if (dim2 > 1) {
-    jl = 1;
-    ju = dim2 - 2;
-  }
-  if (dim1 > 1) {
-    il = 1;
-    iu = dim1 - 2;
+//----------------------------------------------------------------------------------------
+//! \fn void CheckAllRefinement(Mesh *pmesh)
+//  \brief same as the per-block version for all blocks of the rank, but with the
+//  registered AMRCriteria evaluated on all blocks at once. Sets the refinement flags.
+
+void CheckAllRefinement(Mesh *pmesh) {
+  std::vector<MeshBlock *> blocks;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    blocks.push_back(pmb);
   }
-  for (int k = kl; k <= ku; k++) {
-    for (int j = jl; j <= ju; j++) {
-      for (int i = il; i <= iu; i++) {
-        Real scale = std::abs(q(k, j, i));
-        Real d =
-            0.5 * std::abs((q(k, j, i + 1) - q(k, j, i - 1))) / (scale + TINY_NUMBER);
-        maxd = (d > maxd ? d : maxd);
-        if (dim2 > 1) {
-          d = 0.5 * std::abs((q(k, j + 1, i) - q(k, j - 1, i))) / (scale + TINY_NUMBER);
-          maxd = (d > maxd ? d : maxd);
-        }
-        if (dim3 > 1) {
-          d = 0.5 * std::abs((q(k + 1, j, i) - q(k - 1, j, i))) / (scale + TINY_NUMBER);
-          maxd = (d > maxd ? d : maxd);
+  const int nblocks = blocks.size();
+  FillDerivedVariables::FillOnDemand(pmesh);
+  // delta_level holds the max over all criteria.  default to derefining.
+  std::vector<AmrTag> delta_level(nblocks, AmrTag::derefine);
+  for (auto &pkg : pmesh->packages) {
+    auto &desc = pkg.second;
+    if (desc->CheckRefinement != nullptr) {
+      for (int b = 0; b < nblocks; b++) {
+        if (delta_level[b] == AmrTag::refine) continue;
+        Container<Real> &rc = blocks[b]->real_containers.Get();
+        delta_level[b] = std::max(delta_level[b], desc->CheckRefinement(rc));
+      }
+    }
+    for (auto &amr : desc->amr_criteria) {
+      std::vector<AmrTag> tags = (*amr)(pmesh);
+      for (int b = 0; b < nblocks; b++) {
+        AmrTag temp_delta = tags[b];
+        if ((temp_delta == AmrTag::refine) && blocks[b]->loc.level >= amr->max_level) {
+          // don't refine if we're at the max level
+          temp_delta = AmrTag::same;
         }
+        delta_level[b] = std::max(delta_level[b], temp_delta);
       }
     }
   }
+  for (int b = 0; b < nblocks; b++) {
+    blocks[b]->pmr->SetRefinement(delta_level[b]);
+  }
+}
 
-  if (maxd > refine_criteria) return AmrTag::refine;
-  if (maxd < derefine_criteria) return AmrTag::derefine;
-  return AmrTag::same;
+AmrTag FirstDerivative(CellVariable<Real> &q, const Real refine_criteria,
+                       const Real derefine_criteria) {
+  return TagBlock("FirstDerivative", q.ContiguousData(), FirstDifferenceEstimator(),
+                  refine_criteria, derefine_criteria);
+}
+
+std::vector<AmrTag> FirstDerivative(const MeshBlockPack<Real> &q,
+                                    const Real refine_criteria,
+                                    const Real derefine_criteria) {
+  return TagPack("FirstDerivativeOnMesh", q, FirstDifferenceEstimator(), refine_criteria,
+                 derefine_criteria);
+}
+
+AmrTag SecondDerivative(CellVariable<Real> &q, const Real refine_criteria,
+                        const Real derefine_criteria, const Real filter) {
+  return TagBlock("SecondDerivative", q.ContiguousData(),
+                  SecondDifferenceEstimator{filter}, refine_criteria, derefine_criteria);
+}
+
+std::vector<AmrTag> SecondDerivative(const MeshBlockPack<Real> &q,
+                                     const Real refine_criteria,
+                                     const Real derefine_criteria, const Real filter) {
+  return TagPack("SecondDerivativeOnMesh", q, SecondDifferenceEstimator{filter},
+                 refine_criteria, derefine_criteria);
+}
+
+AmrTag Gradient(CellVariable<Real> &q, const Real refine_criteria,
+                const Real derefine_criteria) {
+  return TagBlock("Gradient", q.ContiguousData(), GradientEstimator(), refine_criteria,
+                  derefine_criteria);
+}
+
+std::vector<AmrTag> Gradient(const MeshBlockPack<Real> &q, const Real refine_criteria,
+                             const Real derefine_criteria) {
+  return TagPack("GradientOnMesh", q, GradientEstimator(), refine_criteria,
+                 derefine_criteria);
+}
+
+void MinMax(MeshBlock *pmb, CellVariable<Real> &q, Real &qmin, Real &qmax) {
+  ParArray3D<Real> v = q.ContiguousData().Get<3>();
+  Kokkos::MinMaxScalar<Real> result;
+  result.min_val = std::numeric_limits<Real>::max();
+  result.max_val = std::numeric_limits<Real>::lowest();
+  pmb->par_reduce(
+      "MinMax", pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int k, const int j, const int i,
+                    Kokkos::MinMaxScalar<Real> &lmm) {
+        const Real x = v(k, j, i);
+        lmm.min_val = (x < lmm.min_val ? x : lmm.min_val);
+        lmm.max_val = (x > lmm.max_val ? x : lmm.max_val);
+      },
+      Kokkos::MinMax<Real>(result));
+  qmin = result.min_val;
+  qmax = result.max_val;
+}
+
+bool HasFusedCriterion(MeshBlock *pmb, const std::string &field) {
+  // only an adaptive mesh tags its blocks and consumes the slots of the extrema
+  if (pmb->pmr == nullptr || !pmb->pmy_mesh->adaptive) return false;
+  for (auto &pkg : pmb->packages) {
+    for (auto &amr : pkg.second->amr_criteria) {
+      auto minmax = std::dynamic_pointer_cast<AMRMinMax>(amr);
+      if (minmax != nullptr && minmax->field == field) return true;
+    }
+  }
+  return false;
 }
 
 } // namespace Refinement
@@ -16,14 +16,18 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "athena.hpp"
 #include "interface/container.hpp"
+#include "interface/meshblock_pack.hpp"
 #include "interface/state_descriptor.hpp"
 #include "interface/variable.hpp"
 
 namespace parthenon {
 
+class Mesh;
+class MeshBlock;
 class ParameterInput;
 
 namespace Refinement {
@@ -31,9 +35,36 @@ namespace Refinement {
 std::shared_ptr<StateDescriptor> Initialize(ParameterInput *pin);
 
 AmrTag CheckAllRefinement(Container<Real> &rc);
+// tag every block of the mesh, each registered criterion is evaluated for all blocks of
+// the rank at once
+void CheckAllRefinement(Mesh *pmesh);
 
 AmrTag FirstDerivative(CellVariable<Real> &q, const Real refine_criteria,
                        const Real derefine_criteria);
+// the same for the first component of each block of a pack, in one kernel launch
+std::vector<AmrTag> FirstDerivative(const MeshBlockPack<Real> &q,
+                                    const Real refine_criteria,
+                                    const Real derefine_criteria);
+
+// Lohner's normalized second derivative, filter damps the response to small ripples
+AmrTag SecondDerivative(CellVariable<Real> &q, const Real refine_criteria,
+                        const Real derefine_criteria, const Real filter);
+std::vector<AmrTag> SecondDerivative(const MeshBlockPack<Real> &q,
+                                     const Real refine_criteria,
+                                     const Real derefine_criteria, const Real filter);
+
+// magnitude of the gradient relative to the value, |grad q| dx / |q|
+AmrTag Gradient(CellVariable<Real> &q, const Real refine_criteria,
+                const Real derefine_criteria);
+std::vector<AmrTag> Gradient(const MeshBlockPack<Real> &q, const Real refine_criteria,
+                             const Real derefine_criteria);
+
+// min and max of component 0 of q over the interior of the block
+void MinMax(MeshBlock *pmb, CellVariable<Real> &q, Real &qmin, Real &qmax);
+// true if the mesh is adaptive and an AMRMinMax criterion of a package of the block
+// refers to field, so that the update kernels of the last stage reduce its extrema for
+// the tagging
+bool HasFusedCriterion(MeshBlock *pmb, const std::string &field);
 
 } // namespace Refinement
 
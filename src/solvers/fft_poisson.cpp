@@ -0,0 +1,376 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file fft_poisson.cpp
+//  \brief direct solver for the periodic Poisson equation with distributed FFTs
+
+#include "solvers/fft_poisson.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_FFTW
+#include <fftw3.h>
+#endif
+
+#include "parthenon_mpi.hpp"
+
+#include "globals.hpp"
+#include "mesh/mesh.hpp"
+#include "utils/profiling.hpp"
+
+namespace parthenon {
+
+#ifdef ENABLE_FFTW
+
+namespace {
+
+using Box = FFTPoissonSolver::Box;
+using Layout = FFTPoissonSolver::Layout;
+using Complex = std::complex<double>;
+
+// calls f(index in a, index in b) for the cells common to the boxes a and b, in the
+// order of the cells
+template <typename F>
+void ForCommonCells(const Box &a, const Box &b, const F &f) {
+  int lo[3], hi[3];
+  for (int d = 0; d < 3; d++) {
+    lo[d] = std::max(a.lo[d], b.lo[d]);
+    hi[d] = std::min(a.hi[d], b.hi[d]);
+    if (lo[d] >= hi[d]) return;
+  }
+  const int an1 = a.hi[0] - a.lo[0], an2 = a.hi[1] - a.lo[1];
+  const int bn1 = b.hi[0] - b.lo[0], bn2 = b.hi[1] - b.lo[1];
+  for (int k = lo[2]; k < hi[2]; k++) {
+    for (int j = lo[1]; j < hi[1]; j++) {
+      std::size_t ia = a.offset + (static_cast<std::size_t>(k - a.lo[2]) * an2 +
+                                   (j - a.lo[1])) * an1 + (lo[0] - a.lo[0]);
+      std::size_t ib = b.offset + (static_cast<std::size_t>(k - b.lo[2]) * bn2 +
+                                   (j - b.lo[1])) * bn1 + (lo[0] - b.lo[0]);
+      for (int i = lo[0]; i < hi[0]; i++)
+        f(ia++, ib++);
+    }
+  }
+}
+
+// moves the cells from the boxes of src to those of dst. Sender and receiver both visit
+// the pairs of boxes in the order of the layouts, so the messages need no headers.
+void Redistribute(const Layout &src, const Complex *sdata, const Layout &dst,
+                  Complex *ddata) {
+  const int nranks = Globals::nranks, me = Globals::my_rank;
+  std::vector<std::vector<const Box *>> src_of(nranks), dst_of(nranks);
+  for (auto &b : src)
+    src_of[b.rank].push_back(&b);
+  for (auto &b : dst)
+    dst_of[b.rank].push_back(&b);
+
+  std::vector<Complex> sbuf, rbuf;
+  std::vector<int> scount(nranks), sdisp(nranks), rcount(nranks), rdisp(nranks);
+  for (int r = 0; r < nranks; r++) {
+    sdisp[r] = 2 * sbuf.size();
+    for (auto s : src_of[me]) {
+      for (auto d : dst_of[r])
+        ForCommonCells(*s, *d, [&](std::size_t is, std::size_t) {
+          sbuf.push_back(sdata[is]);
+        });
+    }
+    scount[r] = 2 * sbuf.size() - sdisp[r];
+  }
+  std::size_t nrecv = 0;
+  for (int r = 0; r < nranks; r++) {
+    rdisp[r] = 2 * nrecv;
+    for (auto s : src_of[r]) {
+      for (auto d : dst_of[me])
+        ForCommonCells(*s, *d, [&](std::size_t, std::size_t) { nrecv++; });
+    }
+    rcount[r] = 2 * nrecv - rdisp[r];
+  }
+#ifdef MPI_PARALLEL
+  rbuf.resize(nrecv);
+  MPI_Alltoallv(sbuf.data(), scount.data(), sdisp.data(), MPI_DOUBLE, rbuf.data(),
+                rcount.data(), rdisp.data(), MPI_DOUBLE, MPI_COMM_WORLD);
+#else
+  rbuf.swap(sbuf);
+#endif
+  std::size_t p = 0;
+  for (int r = 0; r < nranks; r++) {
+    for (auto s : src_of[r]) {
+      for (auto d : dst_of[me])
+        ForCommonCells(*s, *d,
+                       [&](std::size_t, std::size_t id) { ddata[id] = rbuf[p++]; });
+    }
+  }
+}
+
+// the pencils along direction d: the first of the other directions is split into pa
+// parts and the second into pb, with pa * pb = nranks
+Layout PencilLayout(const int n[3], const int d) {
+  const int nranks = Globals::nranks;
+  const int a = (d == 0) ? 1 : 0, b = (d == 2) ? 1 : 2;
+  int pa, pb;
+  if (n[a] == 1) {
+    pa = 1;
+  } else if (n[b] == 1) {
+    pa = nranks;
+  } else {
+    pa = 1;
+    for (int p = 1; p * p <= nranks; p++) {
+      if (nranks % p == 0) pa = p;
+    }
+  }
+  pb = nranks / pa;
+  Layout pencils(nranks);
+  for (int r = 0; r < nranks; r++) {
+    Box &box = pencils[r];
+    box.rank = r;
+    box.offset = 0;
+    const int ra = r % pa, rb = r / pa;
+    box.lo[d] = 0;
+    box.hi[d] = n[d];
+    box.lo[a] = static_cast<std::int64_t>(ra) * n[a] / pa;
+    box.hi[a] = static_cast<std::int64_t>(ra + 1) * n[a] / pa;
+    box.lo[b] = static_cast<std::int64_t>(rb) * n[b] / pb;
+    box.hi[b] = static_cast<std::int64_t>(rb + 1) * n[b] / pb;
+  }
+  return pencils;
+}
+
+// the FFT along direction d of all rows of a box, in place
+fftw_plan PlanRows(const Box &box, const int d, Complex *data, const int sign) {
+  const int n1 = box.hi[0] - box.lo[0], n2 = box.hi[1] - box.lo[1];
+  const int n3 = box.hi[2] - box.lo[2];
+  fftw_iodim dim, loops[2];
+  int nloop;
+  if (d == 0) {
+    dim = {n1, 1, 1};
+    loops[0] = {n2 * n3, n1, n1};
+    nloop = 1;
+  } else if (d == 1) {
+    dim = {n2, n1, n1};
+    loops[0] = {n3, n1 * n2, n1 * n2};
+    loops[1] = {n1, 1, 1};
+    nloop = 2;
+  } else {
+    dim = {n3, n1 * n2, n1 * n2};
+    loops[0] = {n1 * n2, 1, 1};
+    nloop = 1;
+  }
+  auto p = reinterpret_cast<fftw_complex *>(data);
+  return fftw_plan_guru_dft(1, &dim, nloop, loops, p, p, sign, FFTW_ESTIMATE);
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn FFTPoissonSolver::FFTPoissonSolver(Mesh *pm, const std::string &solution,
+//                                         const std::string &rhs)
+//  \brief sets up the pencils and the plans of their FFTs
+
+FFTPoissonSolver::FFTPoissonSolver(Mesh *pm, const std::string &solution,
+                                   const std::string &rhs)
+    : pmy_mesh_(pm), solution_(solution), rhs_(rhs), generation_(0) {
+  std::stringstream msg;
+  for (int f = 0; f < 2 * pm->ndim; f++) {
+    if (pm->mesh_bcs[f] != BoundaryFlag::periodic) {
+      msg << "### FATAL ERROR in FFTPoissonSolver" << std::endl
+          << "The mesh must be periodic in all directions" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+  }
+  for (int d = 0; d < 3; d++) {
+    if (!pm->use_uniform_meshgen_fn_[d]) {
+      msg << "### FATAL ERROR in FFTPoissonSolver" << std::endl
+          << "The mesh must have uniform cell spacing" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+  }
+  const RegionSize &ms = pm->mesh_size;
+  ncells_[0] = ms.nx1;
+  ncells_[1] = ms.nx2;
+  ncells_[2] = ms.nx3;
+  dx_[0] = (ms.x1max - ms.x1min) / ms.nx1;
+  dx_[1] = (ms.x2max - ms.x2min) / ms.nx2;
+  dx_[2] = (ms.x3max - ms.x3min) / ms.nx3;
+  for (int d = 0; d < pm->ndim; d++)
+    dirs_.push_back(d);
+
+  for (int d = 0; d < 3; d++) {
+    pencil_data_[d] = nullptr;
+    forward_[d] = backward_[d] = nullptr;
+  }
+  for (int d : dirs_) {
+    pencils_[d] = PencilLayout(ncells_, d);
+    const Box &box = pencils_[d][Globals::my_rank];
+    if (box.Size() == 0) continue;
+    pencil_data_[d] =
+        reinterpret_cast<Complex *>(fftw_malloc(sizeof(fftw_complex) * box.Size()));
+    forward_[d] = PlanRows(box, d, pencil_data_[d], FFTW_FORWARD);
+    backward_[d] = PlanRows(box, d, pencil_data_[d], FFTW_BACKWARD);
+  }
+}
+
+FFTPoissonSolver::~FFTPoissonSolver() {
+  for (int d = 0; d < 3; d++) {
+    if (forward_[d] != nullptr) fftw_destroy_plan(forward_[d]);
+    if (backward_[d] != nullptr) fftw_destroy_plan(backward_[d]);
+    if (pencil_data_[d] != nullptr) fftw_free(pencil_data_[d]);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void FFTPoissonSolver::Setup_()
+//  \brief the boxes of the blocks, from their logical locations and ranks
+
+void FFTPoissonSolver::Setup_() {
+  Mesh *pm = pmy_mesh_;
+  if (pm->nbtotal != pm->nrbx1 * pm->nrbx2 * pm->nrbx3) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in FFTPoissonSolver" << std::endl
+        << "The mesh must not be refined" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  const RegionSize &bs = pm->pblock->block_size;
+  const int nx[3] = {bs.nx1, bs.nx2, bs.nx3};
+  blocks_.resize(pm->nbtotal);
+  std::vector<std::size_t> offset(Globals::nranks, 0);
+  for (int gid = 0; gid < pm->nbtotal; gid++) {
+    Box &box = blocks_[gid];
+    const LogicalLocation &loc = pm->loclist[gid];
+    const std::int64_t lx[3] = {loc.lx1, loc.lx2, loc.lx3};
+    box.rank = pm->ranklist[gid];
+    for (int d = 0; d < 3; d++) {
+      box.lo[d] = lx[d] * nx[d];
+      box.hi[d] = box.lo[d] + nx[d];
+    }
+    box.offset = offset[box.rank];
+    offset[box.rank] += box.Size();
+  }
+  block_data_.resize(offset[Globals::my_rank]);
+  generation_ = pm->mesh_generation;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void FFTPoissonSolver::Transform_(const int d, const int sign)
+//  \brief the FFTs along direction d of the pencils of this rank
+
+void FFTPoissonSolver::Transform_(const int d, const int sign) {
+  fftw_plan plan = (sign == FFTW_FORWARD) ? forward_[d] : backward_[d];
+  if (plan != nullptr) fftw_execute(plan);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void FFTPoissonSolver::Solve()
+//  \brief transforms the right-hand side, divides by the eigenvalues of the discrete
+//  laplacian and transforms back
+
+void FFTPoissonSolver::Solve() {
+  ProfilingRegion region("FFTPoissonSolver::Solve");
+  Mesh *pm = pmy_mesh_;
+  if (blocks_.empty() || generation_ != pm->mesh_generation) Setup_();
+  const int nbs = pm->nslist[Globals::my_rank];
+
+  for (auto &pmb : pm->block_list) {
+    auto f = pmb->real_containers.Get().Get(rhs_).data.Get<4>();
+    auto f_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), f);
+    Complex *data = &block_data_[blocks_[nbs + pmb->lid].offset];
+    for (int k = pmb->ks; k <= pmb->ke; k++) {
+      for (int j = pmb->js; j <= pmb->je; j++) {
+        for (int i = pmb->is; i <= pmb->ie; i++)
+          *data++ = Complex(f_h(0, k, j, i), 0.0);
+      }
+    }
+  }
+
+  const int nd = dirs_.size();
+  Redistribute(blocks_, block_data_.data(), pencils_[dirs_[0]], pencil_data_[dirs_[0]]);
+  Transform_(dirs_[0], FFTW_FORWARD);
+  for (int m = 1; m < nd; m++) {
+    Redistribute(pencils_[dirs_[m - 1]], pencil_data_[dirs_[m - 1]], pencils_[dirs_[m]],
+                 pencil_data_[dirs_[m]]);
+    Transform_(dirs_[m], FFTW_FORWARD);
+  }
+
+  // the eigenvalues of the discrete laplacian are the sums over the directions of
+  // (2 cos(2 pi k_d / n_d) - 2) / dx_d^2, the mean (k = 0) of the solution is zero, and
+  // the transforms are not normalized
+  const int dl = dirs_[nd - 1];
+  const Box &box = pencils_[dl][Globals::my_rank];
+  const double norm = 1.0 / (static_cast<double>(ncells_[0]) * ncells_[1] * ncells_[2]);
+  const double pi = std::acos(-1.0);
+  std::vector<double> eig[3];
+  for (int d = 0; d < 3; d++) {
+    for (int k = box.lo[d]; k < box.hi[d]; k++) {
+      const double dx2 = static_cast<double>(dx_[d]) * dx_[d];
+      const double c = std::cos(2.0 * pi * k / ncells_[d]);
+      eig[d].push_back(ncells_[d] > 1 ? (2.0 * c - 2.0) / dx2 : 0.0);
+    }
+  }
+  if (box.Size() > 0) {
+    Complex *data = pencil_data_[dl];
+    for (int k = 0; k < box.hi[2] - box.lo[2]; k++) {
+      for (int j = 0; j < box.hi[1] - box.lo[1]; j++) {
+        for (int i = 0; i < box.hi[0] - box.lo[0]; i++) {
+          const double lambda = eig[0][i] + eig[1][j] + eig[2][k];
+          const bool mean = (box.lo[0] + i == 0) && (box.lo[1] + j == 0) &&
+                            (box.lo[2] + k == 0);
+          *data = mean ? Complex(0.0, 0.0) : *data * (norm / lambda);
+          data++;
+        }
+      }
+    }
+  }
+
+  for (int m = nd - 1; m > 0; m--) {
+    Transform_(dirs_[m], FFTW_BACKWARD);
+    Redistribute(pencils_[dirs_[m]], pencil_data_[dirs_[m]], pencils_[dirs_[m - 1]],
+                 pencil_data_[dirs_[m - 1]]);
+  }
+  Transform_(dirs_[0], FFTW_BACKWARD);
+  Redistribute(pencils_[dirs_[0]], pencil_data_[dirs_[0]], blocks_, block_data_.data());
+
+  for (auto &pmb : pm->block_list) {
+    auto u = pmb->real_containers.Get().Get(solution_).data.Get<4>();
+    auto u_h = Kokkos::create_mirror_view(u);
+    Kokkos::deep_copy(u_h, u);
+    const Complex *data = &block_data_[blocks_[nbs + pmb->lid].offset];
+    for (int k = pmb->ks; k <= pmb->ke; k++) {
+      for (int j = pmb->js; j <= pmb->je; j++) {
+        for (int i = pmb->is; i <= pmb->ie; i++)
+          u_h(0, k, j, i) = (data++)->real();
+      }
+    }
+    Kokkos::deep_copy(u, u_h);
+  }
+}
+
+#else // ENABLE_FFTW
+
+FFTPoissonSolver::FFTPoissonSolver(Mesh *pm, const std::string &solution,
+                                   const std::string &rhs)
+    : pmy_mesh_(pm), solution_(solution), rhs_(rhs), generation_(0) {
+  std::stringstream msg;
+  msg << "### FATAL ERROR in FFTPoissonSolver" << std::endl
+      << "Parthenon was built without FFTW, rerun CMake with -DENABLE_FFTW=On"
+      << std::endl;
+  ATHENA_ERROR(msg);
+}
+
+FFTPoissonSolver::~FFTPoissonSolver() {}
+
+void FFTPoissonSolver::Solve() {}
+
+#endif // ENABLE_FFTW
+
+} // namespace parthenon
@@ -0,0 +1,82 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef SOLVERS_FFT_POISSON_HPP_
+#define SOLVERS_FFT_POISSON_HPP_
+//! \file fft_poisson.hpp
+//  \brief direct solver for the periodic Poisson equation with distributed FFTs
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+
+struct fftw_plan_s;
+
+namespace parthenon {
+
+class Mesh;
+
+//----------------------------------------------------------------------------------------
+//! \class FFTPoissonSolver
+//  \brief solves laplacian(u) = f, discretized with the same second-order stencil as
+//  MultigridSolver, for the cell-centered variables u (solution) and f (rhs) of a
+//  periodic mesh without refinement. The cells are moved from the blocks into pencils,
+//  rows of cells spanning the mesh in one direction that are split over the ranks in
+//  the other two, for the FFT along each direction in turn, and back. Which cells go
+//  where follows from the logical locations and ranks of the blocks, which all ranks
+//  know, so every move is a single MPI_Alltoallv. Requires a build with -DENABLE_FFTW=On.
+
+class FFTPoissonSolver {
+ public:
+  FFTPoissonSolver(Mesh *pm, const std::string &solution, const std::string &rhs);
+  ~FFTPoissonSolver();
+  FFTPoissonSolver(const FFTPoissonSolver &) = delete;
+  FFTPoissonSolver &operator=(const FFTPoissonSolver &) = delete;
+
+  void Solve();
+
+  // a box of cells [lo, hi) of the mesh owned by a rank, at offset in its local array,
+  // where the cells are ordered with x1 fastest
+  struct Box {
+    int rank;
+    int lo[3], hi[3];
+    std::size_t offset;
+    std::size_t Size() const {
+      return static_cast<std::size_t>(hi[0] - lo[0]) * (hi[1] - lo[1]) * (hi[2] - lo[2]);
+    }
+  };
+  using Layout = std::vector<Box>;
+
+ private:
+  void Setup_();
+  void Transform_(const int d, const int sign);
+
+  Mesh *pmy_mesh_;
+  std::string solution_, rhs_;
+  int ncells_[3];
+  Real dx_[3];
+  std::vector<int> dirs_; // the directions of the mesh
+  std::uint64_t generation_;
+  Layout blocks_;
+  Layout pencils_[3];
+  std::vector<std::complex<double>> block_data_;
+  std::complex<double> *pencil_data_[3];
+  fftw_plan_s *forward_[3], *backward_[3];
+};
+
+} // namespace parthenon
+
+#endif // SOLVERS_FFT_POISSON_HPP_
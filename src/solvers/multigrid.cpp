@@ -0,0 +1,643 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file multigrid.cpp
+//  \brief geometric multigrid solver for the Poisson and Helmholtz equations
+
+#include "solvers/multigrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "bvals/bvals.hpp"
+#include "globals.hpp"
+#include "mesh/mesh.hpp"
+#include "parameter_input.hpp"
+#include "utils/profiling.hpp"
+
+namespace parthenon {
+
+namespace {
+
+// the cells of a level in direction d
+int Cells(const MultigridGrid &g, const int level, const int d) {
+  return g.gh[d] ? (g.n[d] >> level) : 1;
+}
+
+// the index ranges of the last interior (ghost = false) or the ghost (ghost = true)
+// layer of cells at a face of a level
+struct Plane {
+  int s[3], e[3];
+  int Size() const { return (e[0] - s[0] + 1) * (e[1] - s[1] + 1) * (e[2] - s[2] + 1); }
+};
+
+Plane FacePlane(const MultigridGrid &g, const int level, const int face,
+                const bool ghost) {
+  Plane p;
+  for (int d = 0; d < 3; d++) {
+    p.s[d] = g.gh[d];
+    p.e[d] = g.gh[d] + Cells(g, level, d) - 1;
+  }
+  const int d = face / 2;
+  if (face % 2 == 0) {
+    p.s[d] = p.e[d] = ghost ? 0 : g.gh[d];
+  } else {
+    p.s[d] = p.e[d] = ghost ? g.gh[d] + Cells(g, level, d) : p.e[d];
+  }
+  return p;
+}
+
+// copies the interior layer of g at a face into the ghost layer of its neighbor, which
+// has the same size
+void CopyFace(MultigridGrid &g, MultigridGrid &nb, const int level, const int face) {
+  const Plane src = FacePlane(g, level, face, false);
+  const Plane dst = FacePlane(nb, level, face ^ 1, true);
+  const int o1 = dst.s[0] - src.s[0], o2 = dst.s[1] - src.s[1], o3 = dst.s[2] - src.s[2];
+  auto u = g.u[level], v = nb.u[level];
+  par_for(
+      "Multigrid::CopyFace", g.exec_space, src.s[2], src.e[2], src.s[1], src.e[1],
+      src.s[0], src.e[0], KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        v(k + o3, j + o2, i + o1) = u(k, j, i);
+      });
+}
+
+// u = 0 on a face of the mesh
+void SetDirichletFace(MultigridGrid &g, const int level, const int face) {
+  const Plane src = FacePlane(g, level, face, false);
+  const Plane dst = FacePlane(g, level, face, true);
+  const int o1 = dst.s[0] - src.s[0], o2 = dst.s[1] - src.s[1], o3 = dst.s[2] - src.s[2];
+  auto u = g.u[level];
+  par_for(
+      "Multigrid::SetDirichletFace", g.exec_space, src.s[2], src.e[2], src.s[1],
+      src.e[1], src.s[0], src.e[0], KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        u(k + o3, j + o2, i + o1) = -u(k, j, i);
+      });
+}
+
+#ifdef MPI_PARALLEL
+void PackFace(MultigridGrid &g, const int level, const int face) {
+  const Plane p = FacePlane(g, level, face, false);
+  const int n1 = p.e[0] - p.s[0] + 1, n2 = p.e[1] - p.s[1] + 1;
+  const int s1 = p.s[0], s2 = p.s[1], s3 = p.s[2];
+  auto u = g.u[level];
+  auto buf = g.send[face][level];
+  par_for(
+      "Multigrid::PackFace", g.exec_space, p.s[2], p.e[2], p.s[1], p.e[1], p.s[0],
+      p.e[0], KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        buf(((k - s3) * n2 + j - s2) * n1 + i - s1) = u(k, j, i);
+      });
+}
+
+void UnpackFace(MultigridGrid &g, const int level, const int face) {
+  const Plane p = FacePlane(g, level, face, true);
+  const int n1 = p.e[0] - p.s[0] + 1, n2 = p.e[1] - p.s[1] + 1;
+  const int s1 = p.s[0], s2 = p.s[1], s3 = p.s[2];
+  auto u = g.u[level];
+  auto buf = g.recv[face][level];
+  par_for(
+      "Multigrid::UnpackFace", g.exec_space, p.s[2], p.e[2], p.s[1], p.e[1], p.s[0],
+      p.e[0], KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        u(k, j, i) = buf(((k - s3) * n2 + j - s2) * n1 + i - s1);
+      });
+}
+#endif // MPI_PARALLEL
+
+// fills the ghost cells of the solution on a level of the grids from their neighbors
+void ExchangeGhosts(Mesh *pm, std::vector<MultigridGrid *> &grids, const int level) {
+  // the kernels of the blocks run on their own streams
+  Kokkos::fence();
+#ifdef MPI_PARALLEL
+  MPI_Comm comm = pm->GetMPIComm(Mesh::multigrid_phys_id);
+  std::vector<MPI_Request> recv_req, send_req;
+  for (auto pg : grids) {
+    for (int f = 0; f < 6; f++) {
+      if (pg->local[f] != nullptr || pg->rank[f] < 0) continue;
+      recv_req.emplace_back();
+      MPI_Irecv(pg->recv[f][level].data(), pg->recv[f][level].size(), MPI_ATHENA_REAL,
+                pg->rank[f], pg->lid * 8 + f, comm, &recv_req.back());
+    }
+  }
+#endif
+  for (auto pg : grids) {
+    for (int f = 0; f < 6; f++) {
+      if (!pg->gh[f / 2]) continue;
+      if (pg->local[f] != nullptr) {
+        CopyFace(*pg, *pg->local[f], level, f);
+      } else if (pg->rank[f] < 0) {
+        SetDirichletFace(*pg, level, f);
+#ifdef MPI_PARALLEL
+      } else {
+        PackFace(*pg, level, f);
+        pg->exec_space.fence();
+        send_req.emplace_back();
+        MPI_Isend(pg->send[f][level].data(), pg->send[f][level].size(), MPI_ATHENA_REAL,
+                  pg->rank[f], pg->nlid[f] * 8 + (f ^ 1), comm, &send_req.back());
+#endif
+      }
+    }
+  }
+#ifdef MPI_PARALLEL
+  MPI_Waitall(recv_req.size(), recv_req.data(), MPI_STATUSES_IGNORE);
+  for (auto pg : grids) {
+    for (int f = 0; f < 6; f++) {
+      if (pg->local[f] == nullptr && pg->rank[f] >= 0) UnpackFace(*pg, level, f);
+    }
+  }
+  MPI_Waitall(send_req.size(), send_req.data(), MPI_STATUSES_IGNORE);
+#endif
+  // the ghost cells of a grid may have been written on the stream of its neighbor
+  Kokkos::fence();
+}
+
+// the weights of the neighbors in the discrete laplacian, zero in unused directions
+void Weights(const MultigridGrid &g, const int level, Real w[3]) {
+  for (int d = 0; d < 3; d++) {
+    const Real dx = g.dx[d] * (1 << level);
+    w[d] = g.gh[d] / (dx * dx);
+  }
+}
+
+// one half-sweep of red-black Gauss-Seidel, updating the cells of one color
+void SmoothColor(MultigridGrid &g, const int level, const int color, const Real shift) {
+  Real w[3];
+  Weights(g, level, w);
+  const Real w1 = w[0], w2 = w[1], w3 = w[2];
+  const Real diag = 2.0 * (w1 + w2 + w3) + shift;
+  const int o1 = g.gh[0], o2 = g.gh[1], o3 = g.gh[2];
+  // the color of a cell is the parity of its global index
+  int base = color;
+  for (int d = 0; d < 3; d++)
+    base += static_cast<int>((g.lx[d] * Cells(g, level, d)) % 2);
+  base = base % 2;
+  auto u = g.u[level], f = g.f[level];
+  par_for(
+      "Multigrid::Smooth", g.exec_space, o3, o3 + Cells(g, level, 2) - 1, o2,
+      o2 + Cells(g, level, 1) - 1, o1, o1 + Cells(g, level, 0) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        if ((i + j + k + base) % 2 != 0) return;
+        u(k, j, i) = (w1 * (u(k, j, i + o1) + u(k, j, i - o1)) +
+                      w2 * (u(k, j + o2, i) + u(k, j - o2, i)) +
+                      w3 * (u(k + o3, j, i) + u(k - o3, j, i)) - f(k, j, i)) /
+                     diag;
+      });
+}
+
+// r = f - laplacian(u) + shift * u, the ghost cells of u must be set
+void Residual(MultigridGrid &g, const int level, const Real shift) {
+  Real w[3];
+  Weights(g, level, w);
+  const Real w1 = w[0], w2 = w[1], w3 = w[2];
+  const int o1 = g.gh[0], o2 = g.gh[1], o3 = g.gh[2];
+  auto u = g.u[level], f = g.f[level], r = g.r[level];
+  par_for(
+      "Multigrid::Residual", g.exec_space, o3, o3 + Cells(g, level, 2) - 1, o2,
+      o2 + Cells(g, level, 1) - 1, o1, o1 + Cells(g, level, 0) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        const Real uc = u(k, j, i);
+        r(k, j, i) = f(k, j, i) - (w1 * (u(k, j, i + o1) - 2.0 * uc + u(k, j, i - o1)) +
+                                   w2 * (u(k, j + o2, i) - 2.0 * uc + u(k, j - o2, i)) +
+                                   w3 * (u(k + o3, j, i) - 2.0 * uc + u(k - o3, j, i)) -
+                                   shift * uc);
+      });
+}
+
+// the right-hand side of the next coarser level is the average of the residual over
+// the children of each cell, and its solution (the correction) starts at zero
+void Restrict(MultigridGrid &g, const int level) {
+  const int o1 = g.gh[0], o2 = g.gh[1], o3 = g.gh[2];
+  const Real norm = 1.0 / ((1 + o1) * (1 + o2) * (1 + o3));
+  auto r = g.r[level], fc = g.f[level + 1];
+  par_for(
+      "Multigrid::Restrict", g.exec_space, o3, o3 + Cells(g, level + 1, 2) - 1, o2,
+      o2 + Cells(g, level + 1, 1) - 1, o1, o1 + Cells(g, level + 1, 0) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        const int fk = o3 + 2 * (k - o3), fj = o2 + 2 * (j - o2), fi = o1 + 2 * (i - o1);
+        Real sum = 0.0;
+        for (int dk = 0; dk <= o3; dk++) {
+          for (int dj = 0; dj <= o2; dj++) {
+            for (int di = 0; di <= o1; di++)
+              sum += r(fk + dk, fj + dj, fi + di);
+          }
+        }
+        fc(k, j, i) = norm * sum;
+      });
+  Kokkos::deep_copy(g.exec_space, g.u[level + 1], 0.0);
+}
+
+// adds the linear interpolation of the correction on the next coarser level, whose
+// ghost cells must be set, to the solution
+void ProlongateAdd(MultigridGrid &g, const int level) {
+  const int o1 = g.gh[0], o2 = g.gh[1], o3 = g.gh[2];
+  auto u = g.u[level], uc = g.u[level + 1];
+  par_for(
+      "Multigrid::Prolongate", g.exec_space, o3, o3 + Cells(g, level, 2) - 1, o2,
+      o2 + Cells(g, level, 1) - 1, o1, o1 + Cells(g, level, 0) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        const int ck = o3 + (k - o3) / 2, cj = o2 + (j - o2) / 2, ci = o1 + (i - o1) / 2;
+        // the children are a quarter of the coarse cell off its center
+        const Real s1 = ((i - o1) % 2) ? 0.125 : -0.125;
+        const Real s2 = ((j - o2) % 2) ? 0.125 : -0.125;
+        const Real s3 = ((k - o3) % 2) ? 0.125 : -0.125;
+        u(k, j, i) += uc(ck, cj, ci) +
+                      s1 * (uc(ck, cj, ci + o1) - uc(ck, cj, ci - o1)) +
+                      s2 * (uc(ck, cj + o2, ci) - uc(ck, cj - o2, ci)) +
+                      s3 * (uc(ck + o3, cj, ci) - uc(ck - o3, cj, ci));
+      });
+}
+
+// the sum of a over the interior cells of a level
+Real Sum(MultigridGrid &g, const ParArray3D<Real> &a, const int level,
+         const bool square) {
+  const int o1 = g.gh[0], o2 = g.gh[1], o3 = g.gh[2];
+  Real sum = 0.0;
+  par_reduce(
+      "Multigrid::Sum", g.exec_space, o3, o3 + Cells(g, level, 2) - 1, o2,
+      o2 + Cells(g, level, 1) - 1, o1, o1 + Cells(g, level, 0) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &s) {
+        s += square ? a(k, j, i) * a(k, j, i) : a(k, j, i);
+      },
+      Kokkos::Sum<Real>(sum));
+  return sum;
+}
+
+void AddConstant(MultigridGrid &g, ParArray3D<Real> &a, const int level, const Real c) {
+  const int o1 = g.gh[0], o2 = g.gh[1], o3 = g.gh[2];
+  par_for(
+      "Multigrid::AddConstant", g.exec_space, o3, o3 + Cells(g, level, 2) - 1, o2,
+      o2 + Cells(g, level, 1) - 1, o1, o1 + Cells(g, level, 0) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) { a(k, j, i) += c; });
+}
+
+// copies between the interior of a level 0 array and that of a block variable
+void CopyVariable(MultigridGrid &g, ParArray3D<Real> &a, const std::string &name,
+                  const bool to_variable) {
+  MeshBlock *pmb = g.pmb;
+  auto var = pmb->real_containers.Get().Get(name).data.Get<4>();
+  const int o1 = g.gh[0] - pmb->is, o2 = g.gh[1] - pmb->js, o3 = g.gh[2] - pmb->ks;
+  pmb->par_for(
+      "Multigrid::CopyVariable", pmb->ks, pmb->ke, pmb->js, pmb->je, pmb->is, pmb->ie,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        if (to_variable) {
+          var(0, k, j, i) = a(k + o3, j + o2, i + o1);
+        } else {
+          a(k + o3, j + o2, i + o1) = var(0, k, j, i);
+        }
+      });
+}
+
+Real GlobalSum(Real sum) {
+#ifdef MPI_PARALLEL
+  MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_ATHENA_REAL, MPI_SUM, MPI_COMM_WORLD);
+#endif
+  return sum;
+}
+
+void AllocateLevels(MultigridGrid &g) {
+  for (int l = 0; l < g.nlevel; l++) {
+    const int n1 = Cells(g, l, 0) + 2 * g.gh[0], n2 = Cells(g, l, 1) + 2 * g.gh[1];
+    const int n3 = Cells(g, l, 2) + 2 * g.gh[2];
+    g.u.emplace_back("Multigrid u", n3, n2, n1);
+    g.f.emplace_back("Multigrid f", n3, n2, n1);
+    g.r.emplace_back("Multigrid r", n3, n2, n1);
+  }
+  for (int f = 0; f < 6; f++) {
+    if (g.local[f] != nullptr || g.rank[f] < 0) continue;
+    for (int l = 0; l < g.nlevel; l++) {
+      const int size = FacePlane(g, l, f, false).Size();
+      g.send[f].emplace_back("Multigrid send", size);
+      g.recv[f].emplace_back("Multigrid recv", size);
+    }
+  }
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------------------
+//! \fn MultigridSolver::MultigridSolver(Mesh *pm, ParameterInput *pin,
+//        const std::string &solution, const std::string &rhs, const Real shift)
+//  \brief reads the options of the <multigrid> block
+
+MultigridSolver::MultigridSolver(Mesh *pm, ParameterInput *pin,
+                                 const std::string &solution, const std::string &rhs,
+                                 const Real shift)
+    : pmy_mesh_(pm), solution_(solution), rhs_(rhs), shift_(shift), residual_(0.0),
+      singular_(false), generation_(0) {
+  max_iterations_ = pin->GetOrAddInteger("multigrid", "max_iterations", 50);
+  num_smooth_ = pin->GetOrAddInteger("multigrid", "num_smooth", 2);
+  tolerance_ = pin->GetOrAddReal("multigrid", "tolerance", 1.0e-10);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MultigridSolver::Setup_()
+//  \brief builds the levels of the blocks of this rank and of the root grid
+
+void MultigridSolver::Setup_() {
+  Mesh *pm = pmy_mesh_;
+  std::stringstream msg;
+  const int level = pm->loclist[0].level;
+  for (int n = 1; n < pm->nbtotal; n++) {
+    if (pm->loclist[n].level != level) {
+      msg << "### FATAL ERROR in MultigridSolver" << std::endl
+          << "All MeshBlocks must be on the same level" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+  }
+  for (int d = 0; d < 3; d++) {
+    if (!pm->use_uniform_meshgen_fn_[d]) {
+      msg << "### FATAL ERROR in MultigridSolver" << std::endl
+          << "The mesh must have uniform cell spacing" << std::endl;
+      ATHENA_ERROR(msg);
+    }
+  }
+  const RegionSize &bs = pm->pblock->block_size;
+  const int nx[3] = {bs.nx1, bs.nx2, bs.nx3};
+  const int ndim = pm->ndim;
+  int nlevel = 1;
+  while ((1 << (nlevel - 1)) < nx[0])
+    nlevel++;
+  for (int d = 0; d < ndim; d++) {
+    if (nx[d] != nx[0] || nx[0] != (1 << (nlevel - 1))) {
+      msg << "### FATAL ERROR in MultigridSolver" << std::endl
+          << "The MeshBlocks must have the same power of two of cells in each direction"
+          << std::endl;
+      ATHENA_ERROR(msg);
+    }
+  }
+
+  const RegionSize &ms = pm->mesh_size;
+  const Real mmin[3] = {ms.x1min, ms.x2min, ms.x3min};
+  const Real mmax[3] = {ms.x1max, ms.x2max, ms.x3max};
+  singular_ = (shift_ == 0.0);
+  for (int f = 0; f < 2 * ndim; f++)
+    singular_ = singular_ && (pm->mesh_bcs[f] == BoundaryFlag::periodic);
+
+  blocks_.clear();
+  blocks_.resize(pm->block_list.size());
+  pblocks_.clear();
+  for (auto &pmb : pm->block_list) {
+    MultigridGrid &g = blocks_[pmb->lid];
+    g.pmb = pmb;
+    g.exec_space = pmb->exec_space;
+    g.lid = pmb->lid;
+    g.nlevel = nlevel;
+    const Real bmin[3] = {pmb->block_size.x1min, pmb->block_size.x2min,
+                          pmb->block_size.x3min};
+    const Real bmax[3] = {pmb->block_size.x1max, pmb->block_size.x2max,
+                          pmb->block_size.x3max};
+    const std::int64_t lx[3] = {pmb->loc.lx1, pmb->loc.lx2, pmb->loc.lx3};
+    for (int d = 0; d < 3; d++) {
+      g.gh[d] = (d < ndim);
+      g.n[d] = g.gh[d] ? nx[d] : 1;
+      g.dx[d] = g.gh[d] ? (bmax[d] - bmin[d]) / nx[d] : 1.0;
+      g.lx[d] = lx[d];
+    }
+    for (int f = 0; f < 6; f++) {
+      g.local[f] = nullptr;
+      g.rank[f] = -1;
+      g.nlid[f] = -1;
+    }
+    for (int n = 0; n < pmb->pbval->nneighbor; n++) {
+      const NeighborBlock &nb = pmb->pbval->neighbor[n];
+      if (nb.ni.type != NeighborConnect::face) continue;
+      const int f = (nb.ni.ox1 != 0) ? (nb.ni.ox1 > 0)
+                                     : ((nb.ni.ox2 != 0) ? 2 + (nb.ni.ox2 > 0)
+                                                         : 4 + (nb.ni.ox3 > 0));
+      g.rank[f] = nb.snb.rank;
+      g.nlid[f] = nb.snb.lid;
+      if (nb.snb.rank == Globals::my_rank) g.local[f] = &blocks_[nb.snb.lid];
+    }
+    AllocateLevels(g);
+    pblocks_.push_back(&g);
+  }
+
+  // the root grid has one cell per block
+  root_ = MultigridGrid();
+  root_.pmb = nullptr;
+  root_.exec_space = DevSpace();
+  root_.lid = 0;
+  const int nrbx[3] = {pm->nrbx1, pm->nrbx2, pm->nrbx3};
+  for (int d = 0; d < 3; d++) {
+    root_.gh[d] = (d < ndim);
+    root_.n[d] = root_.gh[d] ? (nrbx[d] << (level - pm->root_level)) : 1;
+    root_.dx[d] = root_.gh[d] ? (mmax[d] - mmin[d]) / root_.n[d] : 1.0;
+    root_.lx[d] = 0;
+  }
+  // coarsened as long as the cells of every direction are even
+  root_.nlevel = 1;
+  bool even = true;
+  while (even) {
+    for (int d = 0; d < ndim; d++)
+      even = even && (Cells(root_, root_.nlevel - 1, d) % 2 == 0);
+    if (even) root_.nlevel++;
+  }
+  for (int f = 0; f < 6; f++) {
+    const bool periodic = (pm->mesh_bcs[f] == BoundaryFlag::periodic);
+    root_.local[f] = periodic ? &root_ : nullptr;
+    root_.rank[f] = periodic ? Globals::my_rank : -1;
+    root_.nlid[f] = 0;
+  }
+  AllocateLevels(root_);
+  proot_ = {&root_};
+  generation_ = pm->mesh_generation;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MultigridSolver::Smooth_(std::vector<MultigridGrid *> &grids,
+//                                    const int level, const int nsweep)
+//  \brief red-black Gauss-Seidel sweeps on a level of the grids
+
+void MultigridSolver::Smooth_(std::vector<MultigridGrid *> &grids, const int level,
+                              const int nsweep) {
+  for (int s = 0; s < nsweep; s++) {
+    for (int color = 0; color < 2; color++) {
+      ExchangeGhosts(pmy_mesh_, grids, level);
+      for (auto pg : grids)
+        SmoothColor(*pg, level, color, shift_);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MultigridSolver::GatherToRoot_()
+//  \brief the coarsest level of the blocks becomes the finest level of the root grid on
+//  every rank
+
+void MultigridSolver::GatherToRoot_() {
+  Mesh *pm = pmy_mesh_;
+  const int nl = pblocks_.empty() ? 0 : pblocks_[0]->nlevel - 1;
+  std::vector<Real> fu(2 * pm->nbtotal);
+  const int nbs = pm->nslist[Globals::my_rank];
+  for (auto pg : pblocks_) {
+    const int gid = nbs + pg->lid;
+    auto f0 = Kokkos::subview(pg->f[nl], pg->gh[2], pg->gh[1], pg->gh[0]);
+    auto u0 = Kokkos::subview(pg->u[nl], pg->gh[2], pg->gh[1], pg->gh[0]);
+    Kokkos::deep_copy(fu[2 * gid], f0);
+    Kokkos::deep_copy(fu[2 * gid + 1], u0);
+  }
+#ifdef MPI_PARALLEL
+  std::vector<int> counts(Globals::nranks), displs(Globals::nranks);
+  for (int r = 0; r < Globals::nranks; r++) {
+    counts[r] = 2 * pm->nblist[r];
+    displs[r] = 2 * pm->nslist[r];
+  }
+  MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, fu.data(), counts.data(),
+                 displs.data(), MPI_ATHENA_REAL, MPI_COMM_WORLD);
+#endif
+  auto f_h = Kokkos::create_mirror_view(root_.f[0]);
+  auto u_h = Kokkos::create_mirror_view(root_.u[0]);
+  Kokkos::deep_copy(f_h, 0.0);
+  Kokkos::deep_copy(u_h, 0.0);
+  for (int gid = 0; gid < pm->nbtotal; gid++) {
+    const LogicalLocation &loc = pm->loclist[gid];
+    const int k = root_.gh[2] + loc.lx3, j = root_.gh[1] + loc.lx2;
+    const int i = root_.gh[0] + loc.lx1;
+    f_h(k, j, i) = fu[2 * gid];
+    u_h(k, j, i) = fu[2 * gid + 1];
+  }
+  Kokkos::deep_copy(root_.f[0], f_h);
+  Kokkos::deep_copy(root_.u[0], u_h);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MultigridSolver::ScatterFromRoot_()
+//  \brief sets the coarsest level of the blocks from the finest level of the root grid
+
+void MultigridSolver::ScatterFromRoot_() {
+  auto u_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), root_.u[0]);
+  for (auto pg : pblocks_) {
+    const int nl = pg->nlevel - 1;
+    const LogicalLocation &loc = pg->pmb->loc;
+    const Real val =
+        u_h(root_.gh[2] + loc.lx3, root_.gh[1] + loc.lx2, root_.gh[0] + loc.lx1);
+    Kokkos::deep_copy(Kokkos::subview(pg->u[nl], pg->gh[2], pg->gh[1], pg->gh[0]), val);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void MultigridSolver::VCycle_()
+//  \brief one V-cycle through the levels of the blocks and of the root grid
+
+void MultigridSolver::VCycle_() {
+  const int nb = blocks_.empty() ? 1 : blocks_[0].nlevel;
+  for (int l = 0; l < nb - 1; l++) {
+    Smooth_(pblocks_, l, num_smooth_);
+    ExchangeGhosts(pmy_mesh_, pblocks_, l);
+    for (auto pg : pblocks_) {
+      Residual(*pg, l, shift_);
+      Restrict(*pg, l);
+    }
+  }
+
+  GatherToRoot_();
+  const int nr = root_.nlevel;
+  for (int l = 0; l < nr - 1; l++) {
+    Smooth_(proot_, l, num_smooth_);
+    ExchangeGhosts(pmy_mesh_, proot_, l);
+    Residual(root_, l, shift_);
+    Restrict(root_, l);
+  }
+  // the coarsest level is small enough to be solved by the smoother alone
+  int nmax = 1;
+  for (int d = 0; d < 3; d++)
+    nmax = std::max(nmax, Cells(root_, nr - 1, d));
+  Smooth_(proot_, nr - 1, 2 * nmax * nmax + num_smooth_);
+  for (int l = nr - 2; l >= 0; l--) {
+    ExchangeGhosts(pmy_mesh_, proot_, l + 1);
+    ProlongateAdd(root_, l);
+    Smooth_(proot_, l, num_smooth_);
+  }
+  ScatterFromRoot_();
+
+  for (int l = nb - 2; l >= 0; l--) {
+    ExchangeGhosts(pmy_mesh_, pblocks_, l + 1);
+    for (auto pg : pblocks_)
+      ProlongateAdd(*pg, l);
+    Smooth_(pblocks_, l, num_smooth_);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn Real MultigridSolver::ResidualNorm_(const int level)
+//  \brief the L2 norm of the residual of the solution of the blocks on level 0
+
+Real MultigridSolver::ResidualNorm_(const int level) {
+  ExchangeGhosts(pmy_mesh_, pblocks_, level);
+  Real sum = 0.0;
+  for (auto pg : pblocks_) {
+    Residual(*pg, level, shift_);
+    sum += Sum(*pg, pg->r[level], level, true);
+  }
+  return std::sqrt(GlobalSum(sum));
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn int MultigridSolver::Solve()
+//  \brief V-cycles until the residual is below the tolerance
+
+int MultigridSolver::Solve() {
+  ProfilingRegion region("MultigridSolver::Solve");
+  if (blocks_.empty() || generation_ != pmy_mesh_->mesh_generation) Setup_();
+
+  std::int64_t ncells = 0;
+  Real fsum = 0.0;
+  for (auto pg : pblocks_) {
+    CopyVariable(*pg, pg->f[0], rhs_, false);
+    CopyVariable(*pg, pg->u[0], solution_, false);
+    ncells += pg->n[0] * pg->n[1] * pg->n[2];
+    if (singular_) fsum += Sum(*pg, pg->f[0], 0, false);
+  }
+  if (singular_) {
+    // only the part of the right-hand side with zero mean has a solution
+#ifdef MPI_PARALLEL
+    MPI_Allreduce(MPI_IN_PLACE, &ncells, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+#endif
+    const Real fmean = GlobalSum(fsum) / ncells;
+    for (auto pg : pblocks_)
+      AddConstant(*pg, pg->f[0], 0, -fmean);
+  }
+  Real fnorm = 0.0;
+  for (auto pg : pblocks_)
+    fnorm += Sum(*pg, pg->f[0], 0, true);
+  fnorm = std::sqrt(GlobalSum(fnorm));
+
+  int niter = 0;
+  residual_ = (fnorm > 0.0) ? ResidualNorm_(0) / fnorm : 0.0;
+  while (fnorm > 0.0 && residual_ > tolerance_ && niter < max_iterations_) {
+    VCycle_();
+    niter++;
+    residual_ = ResidualNorm_(0) / fnorm;
+  }
+  if (fnorm == 0.0) {
+    for (auto pg : pblocks_)
+      Kokkos::deep_copy(pg->exec_space, pg->u[0], 0.0);
+  }
+
+  Real usum = 0.0;
+  if (singular_) {
+    for (auto pg : pblocks_)
+      usum += Sum(*pg, pg->u[0], 0, false);
+    usum = GlobalSum(usum) / ncells;
+  }
+  for (auto pg : pblocks_) {
+    if (singular_) AddConstant(*pg, pg->u[0], 0, -usum);
+    CopyVariable(*pg, pg->u[0], solution_, true);
+  }
+  return niter;
+}
+
+} // namespace parthenon
@@ -0,0 +1,99 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef SOLVERS_MULTIGRID_HPP_
+#define SOLVERS_MULTIGRID_HPP_
+//! \file multigrid.hpp
+//  \brief geometric multigrid solver for the Poisson and Helmholtz equations
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+class Mesh;
+class MeshBlock;
+class ParameterInput;
+
+//----------------------------------------------------------------------------------------
+//! \struct MultigridGrid
+//  \brief the levels of one grid of the hierarchy, a MeshBlock or the root grid. Level 0
+//  is the finest, each coarser level halves the cells in every direction of the mesh.
+//  The arrays hold one layer of ghost cells in those directions.
+
+struct MultigridGrid {
+  MeshBlock *pmb; // nullptr for the root grid
+  DevSpace exec_space;
+  int lid, nlevel;
+  int n[3];            // cells on level 0, 1 in the unused directions
+  int gh[3];           // ghost cells on each side, 1 in the directions of the mesh
+  Real dx[3];          // the cell size on level 0
+  std::int64_t lx[3];  // position of the grid in units of its extent, for the coloring
+  std::vector<ParArray3D<Real>> u, f, r; // solution, right-hand side and residual
+  // the neighbor across each face (x1 inner, x1 outer, x2 inner, ...): a grid of this
+  // rank, a block (nlid) of another rank, or none (rank = -1) at a non-periodic face
+  MultigridGrid *local[6];
+  int rank[6], nlid[6];
+  std::vector<BufArray1D<Real>> send[6], recv[6]; // per level, for other ranks
+};
+
+//----------------------------------------------------------------------------------------
+//! \class MultigridSolver
+//  \brief solves laplacian(u) - shift * u = f for the cell-centered variables u
+//  (solution) and f (rhs) of all blocks with V-cycles. Within the blocks, the levels are
+//  coarsened down to one cell per block; these cells form the finest level of the root
+//  grid, which every rank holds and coarsens further. Each level is smoothed with
+//  red-black Gauss-Seidel sweeps on the device, exchanging the ghost cells with the
+//  face neighbors of the blocks before each half-sweep. Faces of the mesh that are not
+//  periodic are Dirichlet boundaries with u = 0. All blocks must be on the same level,
+//  with the same power of two of cells in each direction, on a uniform Cartesian mesh.
+
+class MultigridSolver {
+ public:
+  MultigridSolver(Mesh *pm, ParameterInput *pin, const std::string &solution,
+                  const std::string &rhs, const Real shift = 0.0);
+
+  // improves the current solution until the residual is below the tolerance and
+  // returns the number of V-cycles
+  int Solve();
+  // the L2 norm of the residual relative to that of the right-hand side after Solve()
+  Real GetResidual() const { return residual_; }
+
+ private:
+  void Setup_();
+  void VCycle_();
+  void Smooth_(std::vector<MultigridGrid *> &grids, const int level, const int nsweep);
+  Real ResidualNorm_(const int level);
+  void GatherToRoot_();
+  void ScatterFromRoot_();
+
+  Mesh *pmy_mesh_;
+  std::string solution_, rhs_;
+  Real shift_;
+  int max_iterations_, num_smooth_;
+  Real tolerance_, residual_;
+  // the system is singular (periodic in all directions without shift), so the mean of
+  // the right-hand side is removed and that of the solution is zero
+  bool singular_;
+  std::uint64_t generation_;
+  std::vector<MultigridGrid> blocks_; // by lid
+  MultigridGrid root_;
+  std::vector<MultigridGrid *> pblocks_, proot_;
+};
+
+} // namespace parthenon
+
+#endif // SOLVERS_MULTIGRID_HPP_
@@ -15,140 +15,125 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 //! \file tasks.cpp
-//  \brief implementation of the TaskID class
+//  \brief implementation of the TaskID and TaskList classes
 
 #include "task_list/tasks.hpp"
 
-#include <algorithm>
 #include <bitset>
+#include <chrono>
 #include <string>
 #include <utility>
+#include <vector>
 
-namespace parthenon {
+#include <Kokkos_Core.hpp>
 
-// TaskID constructor. Default id = 0.
-TaskID::TaskID(int id) { Set(id); }
+#include "utils/profiling.hpp"
+#include "utils/task_timer.hpp"
 
-void TaskID::Set(int id) {
-  if (id < 0) throw std::invalid_argument("TaskID requires integer arguments >= 0");
-  if (id == 0) {
-    bitblocks.resize(1);
-    return;
-  }
-  id--;
-  const int n_myblocks = id / BITBLOCK + 1;
-  // grow if necessary.  never shrink
-  if (n_myblocks > bitblocks.size()) bitblocks.resize(n_myblocks);
-  bitblocks[n_myblocks - 1].set(id % BITBLOCK);
-}
+namespace parthenon {
 
-void TaskID::clear() {
-  for (auto &bset : bitblocks) {
-    bset.reset();
-  }
+namespace {
+// runs a task in a profiling region of its name, timing it if the task timers are enabled
+TaskStatus Execute(BaseTask &task) {
+  ProfilingRegion region(task.GetName().empty() ? "(unnamed)" : task.GetName().c_str());
+  auto &timer = TaskTimer::Get();
+  if (!timer.Enabled()) return task();
+  const auto start = std::chrono::steady_clock::now();
+  const TaskStatus status = task();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  timer.Add(task.GetName(), elapsed.count());
+  return status;
 }
+} // namespace
 
-bool TaskID::CheckDependencies(const TaskID &rhs) const {
-  const int n_myblocks = bitblocks.size();
-  const int n_srcblocks = rhs.bitblocks.size();
-  if (n_myblocks == n_srcblocks) {
-    for (int i = 0; i < n_myblocks; i++) {
-      if ((bitblocks[i] & rhs.bitblocks[i]) != rhs.bitblocks[i]) return false;
-    }
-  } else if (n_myblocks > n_srcblocks) {
-    for (int i = 0; i < n_srcblocks; i++) {
-      if ((bitblocks[i] & rhs.bitblocks[i]) != rhs.bitblocks[i]) return false;
-    }
-  } else {
-    for (int i = 0; i < n_myblocks; i++) {
-      if ((bitblocks[i] & rhs.bitblocks[i]) != rhs.bitblocks[i]) return false;
-    }
-    for (int i = n_myblocks; i < n_srcblocks; i++) {
-      if (rhs.bitblocks[i].any()) return false;
-    }
+std::string TaskID::to_string() const {
+  std::string bs;
+  for (int i = NumBlocks() - 1; i >= 0; i--) {
+    bs += std::bitset<BITBLOCK>(GetBlock(i)).to_string();
   }
-  return true;
+  return bs;
 }
 
-void TaskID::SetFinished(const TaskID &rhs) {
-  const int n_myblocks = bitblocks.size();
-  const int n_srcblocks = rhs.bitblocks.size();
-  if (n_myblocks == n_srcblocks) {
-    for (int i = 0; i < n_myblocks; i++) {
-      bitblocks[i] ^= rhs.bitblocks[i];
-    }
-  } else if (n_myblocks > n_srcblocks) {
-    for (int i = 0; i < n_srcblocks; i++) {
-      bitblocks[i] ^= rhs.bitblocks[i];
-    }
-  } else {
-    for (int i = 0; i < n_myblocks; i++) {
-      bitblocks[i] ^= rhs.bitblocks[i];
-    }
-    for (int i = n_myblocks; i < n_srcblocks; i++) {
-      bitblocks.push_back(rhs.bitblocks[i]);
-    }
+//----------------------------------------------------------------------------------------
+//! \fn void TaskList::BuildGraph()
+//  \brief find the successors and count the dependencies of every task
+
+void TaskList::BuildGraph() {
+  const int ntasks = _task_list.size();
+  _successors.assign(ntasks, std::vector<int>());
+  _ndeps.assign(ntasks, 0);
+  for (int t = 0; t < ntasks; t++) {
+    const TaskID dep = _task_list[t]->GetDependency();
+    TaskID found;
+    for (int u = 0; u < ntasks; u++) {
+      const TaskID uid = _task_list[u]->GetID();
+      if (u == t || !dep.CheckDependencies(uid)) continue;
+      found = found | uid;
+      _successors[u].push_back(t);
+      _ndeps[t]++;
+    }
+    // a dependency on a task that is not in this list can never be met
+    if (!(found == dep)) _ndeps[t]++;
   }
+  _graph_built = true;
+  ResetPending();
 }
 
-bool TaskID::operator==(const TaskID &rhs) const {
-  const int n_myblocks = bitblocks.size();
-  const int n_srcblocks = rhs.bitblocks.size();
-  if (n_myblocks == n_srcblocks) {
-    for (int i = 0; i < n_myblocks; i++) {
-      if (bitblocks[i] != rhs.bitblocks[i]) return false;
-    }
-  } else if (n_myblocks > n_srcblocks) {
-    for (int i = 0; i < n_srcblocks; i++) {
-      if (bitblocks[i] != rhs.bitblocks[i]) return false;
-    }
-    for (int i = n_srcblocks; i < n_myblocks; i++) {
-      if (bitblocks[i].any()) return false;
-    }
-  } else {
-    for (int i = 0; i < n_myblocks; i++) {
-      if (bitblocks[i] != rhs.bitblocks[i]) return false;
-    }
-    for (int i = n_myblocks; i < n_srcblocks; i++) {
-      if (rhs.bitblocks[i].any()) return false;
+//----------------------------------------------------------------------------------------
+//! \fn void TaskList::ResetPending()
+//  \brief count the unfinished dependencies of every task and collect the ready tasks
+
+void TaskList::ResetPending() {
+  const int ntasks = _task_list.size();
+  _npending = _ndeps;
+  for (int u = 0; u < ntasks; u++) {
+    if (!_task_list[u]->IsComplete()) continue;
+    for (const int s : _successors[u]) {
+      _npending[s]--;
     }
   }
-  return true;
+  _ready.clear();
+  for (int t = 0; t < ntasks; t++) {
+    if (!_task_list[t]->IsComplete() && _npending[t] == 0) _ready.insert(t);
+  }
 }
 
-TaskID TaskID::operator|(const TaskID &rhs) const {
-  TaskID res;
-  const int n_myblocks = bitblocks.size();
-  const int n_srcblocks = rhs.bitblocks.size();
-  res.bitblocks.resize(std::max(n_myblocks, n_srcblocks));
-  if (n_myblocks == n_srcblocks) {
-    for (int i = 0; i < n_myblocks; i++) {
-      res.bitblocks[i] = bitblocks[i] | rhs.bitblocks[i];
-    }
-  } else if (n_myblocks > n_srcblocks) {
-    for (int i = 0; i < n_srcblocks; i++) {
-      res.bitblocks[i] = bitblocks[i] | rhs.bitblocks[i];
-    }
-    for (int i = n_srcblocks; i < n_myblocks; i++) {
-      res.bitblocks[i] = bitblocks[i];
-    }
-  } else {
-    for (int i = 0; i < n_myblocks; i++) {
-      res.bitblocks[i] = bitblocks[i] | rhs.bitblocks[i];
-    }
-    for (int i = n_myblocks; i < n_srcblocks; i++) {
-      res.bitblocks[i] = rhs.bitblocks[i];
-    }
+void TaskList::Restart() {
+  for (auto &task : _task_list) {
+    task->SetIncomplete();
   }
-  return res;
+  _nremaining = _task_list.size();
+  _tasks_completed.clear();
+  if (_graph_built) ResetPending();
 }
 
-std::string TaskID::to_string() {
-  std::string bs;
-  for (int i = bitblocks.size() - 1; i >= 0; i--) {
-    bs += bitblocks[i].to_string();
+//----------------------------------------------------------------------------------------
+//! \fn TaskListStatus TaskList::DoAvailable()
+//  \brief run every task whose dependencies are met, including tasks that become ready
+//  during this call
+
+TaskListStatus TaskList::DoAvailable() {
+  if (!_graph_built) BuildGraph();
+  auto it = _ready.begin();
+  while (it != _ready.end()) {
+    const int t = *it;
+    auto &task = _task_list[t];
+    TaskStatus status = Execute(*task);
+    if (status == TaskStatus::complete) {
+      task->SetComplete();
+      MarkTaskComplete(task->GetID());
+      _nremaining--;
+      for (const int s : _successors[t]) {
+        if (--_npending[s] == 0) _ready.insert(s);
+      }
+      // successors were added after t, so they are visited later in this sweep
+      it = _ready.erase(it);
+    } else {
+      ++it;
+    }
   }
-  return bs;
+  if (IsComplete()) return TaskListStatus::complete;
+  return TaskListStatus::running;
 }
 
 } // namespace parthenon
@@ -14,11 +14,13 @@
 #ifndef TASK_LIST_TASKS_HPP_
 #define TASK_LIST_TASKS_HPP_
 
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <iostream>
-#include <list>
 #include <memory>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -44,12 +46,16 @@ using BlockStageNamesIntegratorTaskFunc =
 //----------------------------------------------------------------------------------------
 //! \class TaskID
 //  \brief generalization of bit fields for Task IDs, status, and dependencies.
+//  The first TASKID_INLINE_BLOCKS * BITBLOCK ids live in a fixed array, so copying and
+//  combining the ids of typical task lists never allocates. Only lists with more tasks
+//  spill the remaining blocks to the heap.
 
-#define BITBLOCK 16
+#define BITBLOCK 64
+#define TASKID_INLINE_BLOCKS 2
 
 class TaskID {
  public:
-  TaskID() { Set(0); }
+  TaskID() : bitblocks() {}
   explicit TaskID(int id);
 
   void Set(int id);
@@ -58,12 +64,81 @@ class TaskID {
   void SetFinished(const TaskID &rhs);
   bool operator==(const TaskID &rhs) const;
   TaskID operator|(const TaskID &rhs) const;
-  std::string to_string();
+  std::string to_string() const;
 
  private:
-  std::vector<std::bitset<BITBLOCK>> bitblocks;
+  using Block = std::uint64_t;
+  static constexpr int ninline = TASKID_INLINE_BLOCKS;
+
+  int NumBlocks() const { return ninline + static_cast<int>(overflow.size()); }
+  Block GetBlock(const int i) const {
+    if (i < ninline) return bitblocks[i];
+    return (i < NumBlocks()) ? overflow[i - ninline] : 0;
+  }
+  Block &BlockRef(const int i) {
+    if (i < ninline) return bitblocks[i];
+    if (i >= NumBlocks()) overflow.resize(i - ninline + 1, 0);
+    return overflow[i - ninline];
+  }
+
+  std::array<Block, ninline> bitblocks;
+  std::vector<Block> overflow; // blocks beyond the inline ones, empty for most lists
 };
 
+inline TaskID::TaskID(int id) : bitblocks() { Set(id); }
+
+inline void TaskID::Set(int id) {
+  if (id < 0) throw std::invalid_argument("TaskID requires integer arguments >= 0");
+  if (id == 0) return;
+  id--;
+  BlockRef(id / BITBLOCK) |= Block(1) << (id % BITBLOCK);
+}
+
+inline void TaskID::clear() {
+  bitblocks.fill(0);
+  overflow.clear();
+}
+
+inline bool TaskID::CheckDependencies(const TaskID &rhs) const {
+  for (int i = 0; i < ninline; i++) {
+    if ((bitblocks[i] & rhs.bitblocks[i]) != rhs.bitblocks[i]) return false;
+  }
+  for (int i = ninline; i < rhs.NumBlocks(); i++) {
+    if ((GetBlock(i) & rhs.GetBlock(i)) != rhs.GetBlock(i)) return false;
+  }
+  return true;
+}
+
+inline void TaskID::SetFinished(const TaskID &rhs) {
+  for (int i = 0; i < ninline; i++) {
+    bitblocks[i] ^= rhs.bitblocks[i];
+  }
+  for (int i = ninline; i < rhs.NumBlocks(); i++) {
+    BlockRef(i) ^= rhs.GetBlock(i);
+  }
+}
+
+inline bool TaskID::operator==(const TaskID &rhs) const {
+  if (bitblocks != rhs.bitblocks) return false;
+  const int nblocks = std::max(NumBlocks(), rhs.NumBlocks());
+  for (int i = ninline; i < nblocks; i++) {
+    if (GetBlock(i) != rhs.GetBlock(i)) return false;
+  }
+  return true;
+}
+
+inline TaskID TaskID::operator|(const TaskID &rhs) const {
+  TaskID res;
+  for (int i = 0; i < ninline; i++) {
+    res.bitblocks[i] = bitblocks[i] | rhs.bitblocks[i];
+  }
+  const int nblocks = std::max(NumBlocks(), rhs.NumBlocks());
+  for (int i = ninline; i < nblocks; i++) {
+    res.BlockRef(i) = GetBlock(i) | rhs.GetBlock(i);
+  }
+  return res;
+}
+
 class BaseTask {
  public:
   BaseTask(TaskID id, TaskID dep) : _myid(id), _dep(dep) {}
@@ -71,12 +146,23 @@ class BaseTask {
   virtual TaskStatus operator()() = 0;
   TaskID GetID() { return _myid; }
   TaskID GetDependency() { return _dep; }
+  const std::string &GetName() const { return _name; }
+  void SetName(const std::string &name) { _name = name; }
   void SetComplete() { _complete = true; }
+  void SetIncomplete() { _complete = false; }
   bool IsComplete() { return _complete; }
 
  protected:
   TaskID _myid, _dep;
   bool lb_time, _complete = false;
+  // the task is timed under this name, see TaskTimer
+  std::string _name;
+};
+
+// optional first argument of TaskList::AddTask, naming the task for the task timers
+struct TaskName {
+  explicit TaskName(const std::string &name) : name(name) {}
+  std::string name;
 };
 
 class SimpleTask : public BaseTask {
@@ -144,15 +230,26 @@ class BlockStageNamesIntegratorTask : public BaseTask {
   Integrator *_int;
 };
 
+// The tasks of a TaskList form a dependency graph that is built the first time the list
+// is executed. Each task keeps a count of its unfinished dependencies, and completing a
+// task only decrements the counts of its successors. Tasks whose dependencies are met
+// wait in an ordered ready set, which also holds tasks that returned incomplete, so each
+// call of DoAvailable() runs them in the order in which they were added.
 class TaskList {
  public:
-  bool IsComplete() { return _task_list.empty(); }
-  int Size() { return _task_list.size(); }
+  bool IsComplete() { return _nremaining == 0; }
+  int Size() { return _nremaining; }
   void Reset() {
     _tasks_added = 0;
+    _nremaining = 0;
     _task_list.clear();
     _dependencies.clear();
     _tasks_completed.clear();
+    _successors.clear();
+    _ndeps.clear();
+    _npending.clear();
+    _ready.clear();
+    _graph_built = false;
   }
   bool IsReady() {
     for (auto &l : _dependencies) {
@@ -163,49 +260,32 @@ class TaskList {
     return true;
   }
   void MarkTaskComplete(TaskID id) { _tasks_completed.SetFinished(id); }
-  void ClearComplete() {
-    auto task = _task_list.begin();
-    while (task != _task_list.end()) {
-      if ((*task)->IsComplete()) {
-        task = _task_list.erase(task);
-      } else {
-        ++task;
-      }
-    }
-  }
-  TaskListStatus DoAvailable() {
-    for (auto &task : _task_list) {
-      auto dep = task->GetDependency();
-      if (_tasks_completed.CheckDependencies(dep)) {
-        /*std::cerr << "Task dependency met:" << std::endl
-                  << dep.to_string() << std::endl
-                  << _tasks_completed.to_string() << std::endl
-                  << task->GetID().to_string() << std::endl << std::endl;*/
-        TaskStatus status = (*task)();
-        if (status == TaskStatus::complete) {
-          task->SetComplete();
-          MarkTaskComplete(task->GetID());
-          /*std::cerr << "Task complete:" << std::endl
-                    << task->GetID().to_string() << std::endl
-                    << _tasks_completed.to_string() << std::endl << std::endl;*/
-        }
-      }
-    }
-    ClearComplete();
-    if (IsComplete()) return TaskListStatus::complete;
-    return TaskListStatus::running;
-  }
+  // the block whose load-balancing cost the execution time of this list is charged to
+  void SetMeshBlock(MeshBlock *pmb) { _pmb = pmb; }
+  MeshBlock *GetMeshBlock() const { return _pmb; }
+  TaskListStatus DoAvailable();
+  // mark all tasks incomplete so that the list can be executed again
+  void Restart();
   template <typename T, class... Args>
   TaskID AddTask(Args... args) {
     TaskID id(_tasks_added + 1);
     _task_list.push_back(std::make_unique<T>(id, std::forward<Args>(args)...));
     _tasks_added++;
+    _nremaining++;
+    _graph_built = false;
+    return id;
+  }
+  template <typename T, class... Args>
+  TaskID AddTask(const TaskName &name, Args... args) {
+    TaskID id = AddTask<T>(std::forward<Args>(args)...);
+    _task_list.back()->SetName(name.name);
     return id;
   }
   void Print() {
     int i = 0;
     std::cout << "TaskList::Print():" << std::endl;
     for (auto &t : _task_list) {
+      if (t->IsComplete()) continue;
       std::cout << "  " << i << "  " << t->GetID().to_string() << "  "
                 << t->GetDependency().to_string() << std::endl;
       i++;
@@ -213,10 +293,22 @@ class TaskList {
   }
 
  protected:
-  std::list<std::unique_ptr<BaseTask>> _task_list;
+  void BuildGraph();
+  void ResetPending();
+
+  std::vector<std::unique_ptr<BaseTask>> _task_list;
   int _tasks_added = 0;
+  int _nremaining = 0;
   std::vector<TaskList *> _dependencies;
   TaskID _tasks_completed;
+  MeshBlock *_pmb = nullptr;
+
+  // graph: successors, number of dependencies, and number of unfinished dependencies of
+  // each task
+  bool _graph_built = false;
+  std::vector<std::vector<int>> _successors;
+  std::vector<int> _ndeps, _npending;
+  std::set<int> _ready;
 };
 
 } // namespace parthenon
@@ -0,0 +1,128 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_ARRAY_POOL_HPP_
+#define UTILS_ARRAY_POOL_HPP_
+//! \file array_pool.hpp
+//  \brief free lists of device arrays, so that the arrays of destroyed MeshBlocks can be
+//         handed to new ones instead of going back to the device allocator
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parthenon_arrays.hpp"
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \class ArrayPool
+//  \brief one free list per array shape. Arrays are returned by Release() when their
+//  owner goes away and taken again by Get(), which zeroes them so that they look freshly
+//  allocated. The arrays of stage containers (ContainerCollection::Add, enabled with
+//  <mesh>/pool_stage_arrays) and all other block arrays (<mesh>/pool_block_arrays) are
+//  pooled separately but share the free lists. Disabled, Get() just allocates.
+
+template <typename T>
+class ArrayPool {
+ public:
+  using Shape = std::array<int, 6>; // nx6, ..., nx1
+
+  static ArrayPool &Instance() {
+    static ArrayPool pool;
+    return pool;
+  }
+
+  bool Enabled(const bool stage = false) const {
+    return stage ? stage_enabled_ : enabled_;
+  }
+  void Enable(const bool enabled, const bool stage_enabled = false) {
+    enabled_ = enabled;
+    stage_enabled_ = stage_enabled;
+    if (!enabled_ && !stage_enabled_) Clear();
+  }
+  // must be called before Kokkos is finalized
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.clear();
+    held_bytes_ = 0;
+  }
+
+  ParArrayND<T> Get(const std::string &label, const Shape &shape,
+                    const bool stage = false) {
+    if (Enabled(stage)) {
+      // blocks may be constructed on several threads
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = free_.find(shape);
+      if (it != free_.end() && !it->second.empty()) {
+        ParArrayND<T> arr = std::move(it->second.back());
+        it->second.pop_back();
+        held_bytes_ -= Bytes(shape);
+        reused_++;
+        Kokkos::deep_copy(arr.Get(), T(0));
+        return arr;
+      }
+      allocated_++;
+    }
+    return ParArrayND<T>(label, shape[0], shape[1], shape[2], shape[3], shape[4],
+                         shape[5]);
+  }
+
+  // keep arr for reuse if its caller holds the last reference to it
+  void Release(ParArrayND<T> &arr, const bool stage = false) {
+    if (!Enabled(stage) || arr.use_count() != 1) return;
+    Shape shape = {{arr.GetDim(6), arr.GetDim(5), arr.GetDim(4), arr.GetDim(3),
+                    arr.GetDim(2), arr.GetDim(1)}};
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_[shape].push_back(std::move(arr));
+    held_bytes_ += Bytes(shape);
+    arr = ParArrayND<T>();
+  }
+
+  // memory held in the free lists, and how many pooled requests were served from them
+  // or had to allocate since the start of the run
+  std::size_t HeldBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return held_bytes_;
+  }
+  std::size_t NumReused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reused_;
+  }
+  std::size_t NumAllocated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocated_;
+  }
+
+ private:
+  ArrayPool() : enabled_(false), stage_enabled_(false) {}
+
+  static std::size_t Bytes(const Shape &shape) {
+    std::size_t n = sizeof(T);
+    for (const int nx : shape)
+      n *= nx;
+    return n;
+  }
+
+  bool enabled_, stage_enabled_;
+  std::map<Shape, std::vector<ParArrayND<T>>> free_;
+  std::size_t held_bytes_ = 0, reused_ = 0, allocated_ = 0;
+  mutable std::mutex mutex_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_ARRAY_POOL_HPP_
@@ -0,0 +1,104 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file batched_reduction.cpp
+//  \brief implementation of the BatchedReduction class
+
+#include "utils/batched_reduction.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace parthenon {
+
+namespace {
+#ifdef MPI_PARALLEL
+// combines (value, op) pairs entry by entry, applying the op stored with each entry
+void CombinePairs(void *invec, void *inoutvec, int *len, MPI_Datatype *datatype) {
+  const AccumReal *in = static_cast<const AccumReal *>(invec);
+  AccumReal *inout = static_cast<AccumReal *>(inoutvec);
+  for (int n = 0; n < 2 * (*len); n += 2) {
+    switch (static_cast<ReductionOp>(static_cast<int>(in[n + 1]))) {
+    case ReductionOp::sum:
+      inout[n] += in[n];
+      break;
+    case ReductionOp::max:
+      inout[n] = std::max(inout[n], in[n]);
+      break;
+    case ReductionOp::min:
+      inout[n] = std::min(inout[n], in[n]);
+      break;
+    }
+  }
+}
+
+// the pair datatype and the op are created once, on first use
+void GetPairTypeAndOp(MPI_Datatype &pair_type, MPI_Op &op) {
+  static MPI_Datatype type = MPI_DATATYPE_NULL;
+  static MPI_Op combine = MPI_OP_NULL;
+  if (type == MPI_DATATYPE_NULL) {
+    MPI_Type_contiguous(2, MPI_ATHENA_ACCUM_REAL, &type);
+    MPI_Type_commit(&type);
+    MPI_Op_create(&CombinePairs, 1, &combine);
+  }
+  pair_type = type;
+  op = combine;
+}
+#endif
+} // namespace
+
+BatchedReduction::~BatchedReduction() { Wait(); }
+
+int BatchedReduction::Add(const AccumReal value, const ReductionOp op) {
+  if (in_flight_) {
+    throw std::runtime_error("BatchedReduction::Add: a reduction is in flight");
+  }
+  buffer_.push_back(value);
+  buffer_.push_back(static_cast<AccumReal>(static_cast<int>(op)));
+  return Size() - 1;
+}
+
+void BatchedReduction::Start() {
+  if (in_flight_) {
+    throw std::runtime_error("BatchedReduction::Start: a reduction is in flight");
+  }
+  in_flight_ = true;
+#ifdef MPI_PARALLEL
+  MPI_Datatype pair_type;
+  MPI_Op op;
+  GetPairTypeAndOp(pair_type, op);
+  MPI_Iallreduce(MPI_IN_PLACE, buffer_.data(), Size(), pair_type, op, MPI_COMM_WORLD,
+                 &request_);
+#endif
+}
+
+void BatchedReduction::Wait() {
+  if (!in_flight_) return;
+#ifdef MPI_PARALLEL
+  MPI_Wait(&request_, MPI_STATUS_IGNORE);
+#endif
+  in_flight_ = false;
+  complete_ = true;
+  results_.swap(buffer_);
+  buffer_.clear();
+}
+
+AccumReal BatchedReduction::Get(const int i) const {
+  if (!complete_ || i < 0 || 2 * i >= static_cast<int>(results_.size())) {
+    throw std::out_of_range("BatchedReduction::Get: no result for entry " +
+                            std::to_string(i));
+  }
+  return results_[2 * i];
+}
+
+} // namespace parthenon
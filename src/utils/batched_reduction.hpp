@@ -0,0 +1,70 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_BATCHED_REDUCTION_HPP_
+#define UTILS_BATCHED_REDUCTION_HPP_
+//! \file batched_reduction.hpp
+//  \brief scalars from several subsystems reduced over all ranks in one nonblocking
+//         collective
+
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "basic_types.hpp"
+
+namespace parthenon {
+
+enum class ReductionOp { sum, max, min };
+
+//----------------------------------------------------------------------------------------
+//! \class BatchedReduction
+//  \brief Collects rank-local scalars, each with its own operation, and combines all of
+//  them in a single MPI_Iallreduce with a custom MPI_Op. The collective runs between
+//  Start() and Wait(), so its latency can be hidden behind other work. An Add() after
+//  Wait() begins a new batch, while the results of the completed one stay readable until
+//  the new batch completes in turn. The values are reduced in double precision, also in
+//  single precision builds.
+
+class BatchedReduction {
+ public:
+  BatchedReduction() = default;
+  ~BatchedReduction();
+  BatchedReduction(const BatchedReduction &) = delete;
+  BatchedReduction &operator=(const BatchedReduction &) = delete;
+
+  // adds a rank-local value to the batch and returns its index
+  int Add(const AccumReal value, const ReductionOp op);
+  // starts the reduction of everything added since the last batch
+  void Start();
+  // completes the reduction started last; does nothing if none is in flight
+  void Wait();
+  bool InFlight() const { return in_flight_; }
+  // entries of the batch being added to or in flight
+  int Size() const { return buffer_.size() / 2; }
+  // result of entry i of the last completed batch
+  AccumReal Get(const int i) const;
+
+ private:
+  // (value, op) pairs, so that the MPI_Op knows how to combine each entry
+  std::vector<AccumReal> buffer_;
+  // the pairs of the last completed batch
+  std::vector<AccumReal> results_;
+  bool in_flight_ = false, complete_ = false;
+#ifdef MPI_PARALLEL
+  MPI_Request request_ = MPI_REQUEST_NULL;
+#endif
+};
+
+} // namespace parthenon
+
+#endif // UTILS_BATCHED_REDUCTION_HPP_
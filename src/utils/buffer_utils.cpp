@@ -20,6 +20,7 @@
 #include "utils/buffer_utils.hpp"
 
 #include "athena.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
@@ -100,6 +101,150 @@ void UnpackData(T *buf, ParArrayND<T> &dst, int si, int ei, int sj, int ej, int
   return;
 }
 
+//----------------------------------------------------------------------------------------
+//! \fn template <typename T> void PackData(ParArrayND<T> &src, BufArray1D<T> &buf,
+//                     int sn, int en, int si, int ei, int sj, int ej, int sk, int ek,
+//                     int &offset, DevSpace exec_space)
+//  \brief pack a 4D ParArrayND into a one-dimensional device buffer
+
+template <typename T>
+void PackData(ParArrayND<T> &src, BufArray1D<T> &buf, int sn, int en, int si, int ei,
+              int sj, int ej, int sk, int ek, int &offset, DevSpace exec_space) {
+  const int ni = ei + 1 - si;
+  const int nj = ej + 1 - sj;
+  const int nk = ek + 1 - sk;
+  const int nn = en + 1 - sn;
+  if (ni <= 0 || nj <= 0 || nk <= 0 || nn <= 0) return;
+  const int p0 = offset;
+  par_for(
+      "PackData 4D", exec_space, sn, en, sk, ek, sj, ej, si, ei,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        buf(p0 + i - si + ni * (j - sj + nj * (k - sk + nk * (n - sn)))) =
+            src(n, k, j, i);
+      });
+  offset += nn * nk * nj * ni;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn template <typename T> void PackData(ParArrayND<T> &src, BufArray1D<T> &buf,
+//                     int si, int ei, int sj, int ej, int sk, int ek, int &offset,
+//                     DevSpace exec_space)
+//  \brief pack a 3D ParArrayND into a one-dimensional device buffer
+
+template <typename T>
+void PackData(ParArrayND<T> &src, BufArray1D<T> &buf, int si, int ei, int sj, int ej,
+              int sk, int ek, int &offset, DevSpace exec_space) {
+  const int ni = ei + 1 - si;
+  const int nj = ej + 1 - sj;
+  const int nk = ek + 1 - sk;
+  if (ni <= 0 || nj <= 0 || nk <= 0) return;
+  const int p0 = offset;
+  par_for(
+      "PackData 3D", exec_space, sk, ek, sj, ej, si, ei,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        buf(p0 + i - si + ni * (j - sj + nj * (k - sk))) = src(k, j, i);
+      });
+  offset += nk * nj * ni;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn template <typename T> void UnpackData(BufArray1D<T> &buf, ParArrayND<T> &dst,
+//                       int sn, int en, int si, int ei, int sj, int ej, int sk, int ek,
+//                       int &offset, DevSpace exec_space)
+//  \brief unpack a one-dimensional device buffer into a 4D ParArrayND
+
+template <typename T>
+void UnpackData(BufArray1D<T> &buf, ParArrayND<T> &dst, int sn, int en, int si, int ei,
+                int sj, int ej, int sk, int ek, int &offset, DevSpace exec_space) {
+  const int ni = ei + 1 - si;
+  const int nj = ej + 1 - sj;
+  const int nk = ek + 1 - sk;
+  const int nn = en + 1 - sn;
+  if (ni <= 0 || nj <= 0 || nk <= 0 || nn <= 0) return;
+  const int p0 = offset;
+  par_for(
+      "UnpackData 4D", exec_space, sn, en, sk, ek, sj, ej, si, ei,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        dst(n, k, j, i) =
+            buf(p0 + i - si + ni * (j - sj + nj * (k - sk + nk * (n - sn))));
+      });
+  offset += nn * nk * nj * ni;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn template <typename T> void UnpackData(BufArray1D<T> &buf, ParArrayND<T> &dst,
+//                       int si, int ei, int sj, int ej, int sk, int ek, int &offset,
+//                       DevSpace exec_space)
+//  \brief unpack a one-dimensional device buffer into a 3D ParArrayND
+
+template <typename T>
+void UnpackData(BufArray1D<T> &buf, ParArrayND<T> &dst, int si, int ei, int sj, int ej,
+                int sk, int ek, int &offset, DevSpace exec_space) {
+  const int ni = ei + 1 - si;
+  const int nj = ej + 1 - sj;
+  const int nk = ek + 1 - sk;
+  if (ni <= 0 || nj <= 0 || nk <= 0) return;
+  const int p0 = offset;
+  par_for(
+      "UnpackData 3D", exec_space, sk, ek, sj, ej, si, ei,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        dst(k, j, i) = buf(p0 + i - si + ni * (j - sj + nj * (k - sk)));
+      });
+  offset += nk * nj * ni;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn template <typename T> void PackDataSingle(ParArrayND<T> &src,
+//                     BufArray1D<T> &buf, int sn, int en, int si, int ei, int sj, int ej,
+//                     int sk, int ek, int &offset, DevSpace exec_space)
+//  \brief pack a 4D ParArrayND into a one-dimensional device buffer as floats
+
+template <typename T>
+void PackDataSingle(ParArrayND<T> &src, BufArray1D<T> &buf, int sn, int en, int si,
+                    int ei, int sj, int ej, int sk, int ek, int &offset,
+                    DevSpace exec_space) {
+  const int ni = ei + 1 - si;
+  const int nj = ej + 1 - sj;
+  const int nk = ek + 1 - sk;
+  const int nn = en + 1 - sn;
+  if (ni <= 0 || nj <= 0 || nk <= 0 || nn <= 0) return;
+  const int p0 = offset;
+  float *fbuf = reinterpret_cast<float *>(buf.data());
+  par_for(
+      "PackDataSingle 4D", exec_space, sn, en, sk, ek, sj, ej, si, ei,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        fbuf[p0 + i - si + ni * (j - sj + nj * (k - sk + nk * (n - sn)))] =
+            static_cast<float>(src(n, k, j, i));
+      });
+  offset += nn * nk * nj * ni;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn template <typename T> void UnpackDataSingle(BufArray1D<T> &buf,
+//                       ParArrayND<T> &dst, int sn, int en, int si, int ei, int sj,
+//                       int ej, int sk, int ek, int &offset, DevSpace exec_space)
+//  \brief unpack a one-dimensional device buffer of floats into a 4D ParArrayND
+
+template <typename T>
+void UnpackDataSingle(BufArray1D<T> &buf, ParArrayND<T> &dst, int sn, int en, int si,
+                      int ei, int sj, int ej, int sk, int ek, int &offset,
+                      DevSpace exec_space) {
+  const int ni = ei + 1 - si;
+  const int nj = ej + 1 - sj;
+  const int nk = ek + 1 - sk;
+  const int nn = en + 1 - sn;
+  if (ni <= 0 || nj <= 0 || nk <= 0 || nn <= 0) return;
+  const int p0 = offset;
+  const float *fbuf = reinterpret_cast<const float *>(buf.data());
+  par_for(
+      "UnpackDataSingle 4D", exec_space, sn, en, sk, ek, sj, ej, si, ei,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+        const int p = p0 + i - si + ni * (j - sj + nj * (k - sk + nk * (n - sn)));
+        dst(n, k, j, i) = static_cast<T>(fbuf[p]);
+      });
+  offset += nn * nk * nj * ni;
+}
+
 // provide explicit instantiation definitions (C++03) to allow the template definitions to
 // exist outside of header file (non-inline), but still provide the requisite instances
 // for other TUs during linking time (~13x files include "buffer_utils.hpp")
@@ -115,5 +260,20 @@ template void PackData<Real>(ParArrayND<Real> &, Real *, int, int, int, int, int
 template void PackData<Real>(ParArrayND<Real> &, Real *, int, int, int, int, int, int,
                              int &);
 
+template void UnpackData<Real>(BufArray1D<Real> &, ParArrayND<Real> &, int, int, int, int,
+                               int, int, int, int, int &, DevSpace);
+template void UnpackData<Real>(BufArray1D<Real> &, ParArrayND<Real> &, int, int, int, int,
+                               int, int, int &, DevSpace);
+
+template void PackData<Real>(ParArrayND<Real> &, BufArray1D<Real> &, int, int, int, int,
+                             int, int, int, int, int &, DevSpace);
+template void PackData<Real>(ParArrayND<Real> &, BufArray1D<Real> &, int, int, int, int,
+                             int, int, int &, DevSpace);
+
+template void PackDataSingle<Real>(ParArrayND<Real> &, BufArray1D<Real> &, int, int, int,
+                                   int, int, int, int, int, int &, DevSpace);
+template void UnpackDataSingle<Real>(BufArray1D<Real> &, ParArrayND<Real> &, int, int,
+                                     int, int, int, int, int, int, int &, DevSpace);
+
 } // namespace BufferUtility
 } // namespace parthenon
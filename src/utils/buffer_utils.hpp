@@ -20,6 +20,7 @@
 //  \brief prototypes of utility functions to pack/unpack buffers
 
 #include "athena.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
@@ -43,6 +44,42 @@ template <typename T>
 void UnpackData(T *buf, ParArrayND<T> &dst, int si, int ei, int sj, int ej, int sk,
                 int ek, int &offset);
 
+// Device-side overloads: buffers are BufArray1D views and the loops are dispatched with
+// par_for on the given execution space. The buffer index of each cell is computed in
+// closed form, so offset is only advanced on the host once the kernel is launched.
+// 4D
+template <typename T>
+void PackData(ParArrayND<T> &src, BufArray1D<T> &buf, int sn, int en, int si, int ei,
+              int sj, int ej, int sk, int ek, int &offset, DevSpace exec_space);
+// 3D
+template <typename T>
+void PackData(ParArrayND<T> &src, BufArray1D<T> &buf, int si, int ei, int sj, int ej,
+              int sk, int ek, int &offset, DevSpace exec_space);
+// 4D
+template <typename T>
+void UnpackData(BufArray1D<T> &buf, ParArrayND<T> &dst, int sn, int en, int si, int ei,
+                int sj, int ej, int sk, int ek, int &offset, DevSpace exec_space);
+// 3D
+template <typename T>
+void UnpackData(BufArray1D<T> &buf, ParArrayND<T> &dst, int si, int ei, int sj, int ej,
+                int sk, int ek, int &offset, DevSpace exec_space);
+
+// 4D variants that store the values as float in the leading part of the buffer, halving
+// the size of the message at reduced precision; offset counts floats. SingleBufferLength
+// converts such a count into the number of T the buffer has to hold.
+template <typename T>
+void PackDataSingle(ParArrayND<T> &src, BufArray1D<T> &buf, int sn, int en, int si,
+                    int ei, int sj, int ej, int sk, int ek, int &offset,
+                    DevSpace exec_space);
+template <typename T>
+void UnpackDataSingle(BufArray1D<T> &buf, ParArrayND<T> &dst, int sn, int en, int si,
+                      int ei, int sj, int ej, int sk, int ek, int &offset,
+                      DevSpace exec_space);
+template <typename T>
+constexpr int SingleBufferLength(const int n) {
+  return static_cast<int>((n * sizeof(float) + sizeof(T) - 1) / sizeof(T));
+}
+
 } // namespace BufferUtility
 } // namespace parthenon
 
@@ -20,6 +20,11 @@
 
 #include "utils/gl_quadrature.hpp"
 
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
 #include "athena.hpp"
 
 namespace parthenon {
@@ -1317,6 +1322,8 @@ static const Quadrature gl_coeff[65] = {
     {abscissa_n60, weight_n60}, {abscissa_n61, weight_n61}, {abscissa_n62, weight_n62},
     {abscissa_n63, weight_n63}, {abscissa_n64, weight_n64},
 };
+static_assert(sizeof(gl_coeff) / sizeof(gl_coeff[0]) == max_order + 1,
+              "gl_coeff holds the rules of n = 0, ..., max_order");
 
 // 1D f(x1)
 Real integrate(const int n, Real (*f)(Real), Real x1l, Real x1u) {
@@ -1454,5 +1461,32 @@ Real integrate(const int n, Real (*f)(Real, Real, Real), Real x1l, Real x1u, Rea
   return m1 * m2 * m3 * sum;
 }
 
+void Nodes(const int n, std::vector<Real> &abscissa, std::vector<Real> &weight) {
+  if (n < 2 || n > max_order) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in GaussLegendre::Nodes" << std::endl
+        << "Gauss-Legendre rules have 2 to " << max_order << " nodes, not " << n
+        << std::endl;
+    ATHENA_ERROR(msg);
+  }
+  // unfold the stored half of the symmetric coefficients
+  const int nelements = (n + 1) / 2;
+  std::vector<std::pair<Real, Real>> nodes;
+  nodes.reserve(n);
+  for (int i = 0; i < nelements; i++) {
+    const Real x1 = gl_coeff[n].abscissa[i];
+    const Real w1 = gl_coeff[n].weight[i];
+    nodes.emplace_back(-x1, w1);
+    if (!(n % 2 && i == 0)) nodes.emplace_back(x1, w1); // odd order: x1=0.0 only once
+  }
+  std::sort(nodes.begin(), nodes.end());
+  abscissa.resize(n);
+  weight.resize(n);
+  for (int i = 0; i < n; i++) {
+    abscissa[i] = nodes[i].first;
+    weight[i] = nodes[i].second;
+  }
+}
+
 } // namespace GaussLegendre
 } // namespace parthenon
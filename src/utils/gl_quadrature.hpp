@@ -22,13 +22,14 @@
 
 // TODO(felker): add other Gaussian quadratures, or alternative approaches for computing
 // the initial condition that outperform GL quadrature for a discontinuous function
+#include <vector>
+
 #include "athena.hpp"
+#include "kokkos_abstraction.hpp"
 
 namespace parthenon {
 namespace GaussLegendre {
 
-// TODO(felker): for more complicate f(), use functors/lambdas/pass ParArrayND to both fn
-
 // 1D f(x1)
 Real integrate(const int n, Real (*f)(Real), Real x1l, Real x1u);
 
@@ -40,6 +41,217 @@ Real integrate(const int n, Real (*f)(Real, Real), Real x1l, Real x1u, Real x2l,
 Real integrate(const int n, Real (*f)(Real, Real, Real), Real x1l, Real x1u, Real x2l,
                Real x2u, Real x3l, Real x3u);
 
+// the largest n of the tabulated rules
+constexpr int max_order = 64;
+
+// all n abscissae on [-1, 1] in ascending order and their weights, e.g. to copy them to
+// the device for quadratures inside kernels; 2 <= n <= max_order
+void Nodes(const int n, std::vector<Real> &abscissa, std::vector<Real> &weight);
+
+//----------------------------------------------------------------------------------------
+// Rules with a compile-time number of nodes N, 1 <= N <= 8, for host and device code.
+// Unlike integrate(n, f, ...) above, which calls f through a function pointer for one
+// node at a time, the loops over the nodes unroll and f, e.g. a lambda, is inlined.
+
+// the abscissae on [-1, 1] in ascending order and the weights of the N-point rule
+template <int N>
+struct Rule;
+
+template <>
+struct Rule<1> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        0.0,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        2.0,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<2> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.5773502691896257645091, 0.5773502691896257645091,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        1.0000000000000000000000, 1.0000000000000000000000,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<3> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.7745966692414833770359, 0.0000000000000000000000, 0.7745966692414833770359,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        0.5555555555555555555556, 0.8888888888888888888889, 0.5555555555555555555556,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<4> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.8611363115940525752239, -0.3399810435848562648027, 0.3399810435848562648027,
+        0.8611363115940525752239,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        0.3478548451374538573731, 0.6521451548625461426269, 0.6521451548625461426269,
+        0.3478548451374538573731,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<5> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.9061798459386639927976, -0.5384693101056830910363, 0.0000000000000000000000,
+        0.5384693101056830910363, 0.9061798459386639927976,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        0.2369268850561890875143, 0.4786286704993664680413, 0.5688888888888888888889,
+        0.4786286704993664680413, 0.2369268850561890875143,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<6> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.9324695142031520278123, -0.6612093864662645136614, -0.2386191860831969086305,
+        0.2386191860831969086305, 0.6612093864662645136614, 0.9324695142031520278123,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        0.1713244923791703450403, 0.3607615730481386075698, 0.4679139345726910473899,
+        0.4679139345726910473899, 0.3607615730481386075698, 0.1713244923791703450403,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<7> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.9491079123427585245262, -0.7415311855993944398639, -0.4058451513773971669066,
+        0.0000000000000000000000, 0.4058451513773971669066, 0.7415311855993944398639,
+        0.9491079123427585245262,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        0.1294849661688696932706, 0.2797053914892766679015, 0.3818300505051189449504,
+        0.4179591836734693877551, 0.3818300505051189449504, 0.2797053914892766679015,
+        0.1294849661688696932706,
+    };
+    return w[i];
+  }
+};
+
+template <>
+struct Rule<8> {
+  KOKKOS_INLINE_FUNCTION static Real Abscissa(const int i) {
+    constexpr Real x[] = {
+        -0.9602898564975362316836, -0.7966664774136267395916, -0.5255324099163289858177,
+        -0.1834346424956498049395, 0.1834346424956498049395, 0.5255324099163289858177,
+        0.7966664774136267395916, 0.9602898564975362316836,
+    };
+    return x[i];
+  }
+  KOKKOS_INLINE_FUNCTION static Real Weight(const int i) {
+    constexpr Real w[] = {
+        0.1012285362903762591525, 0.2223810344533744705444, 0.3137066458778872873380,
+        0.3626837833783619829652, 0.3626837833783619829652, 0.3137066458778872873380,
+        0.2223810344533744705444, 0.1012285362903762591525,
+    };
+    return w[i];
+  }
+};
+
+// the integral of f(x1) over [x1l, x1u] with the N-point rule
+template <int N, typename F>
+KOKKOS_INLINE_FUNCTION Real integrate(const F &f, const Real x1l, const Real x1u) {
+  const Real m1 = 0.5 * (x1u - x1l), b1 = 0.5 * (x1u + x1l);
+  Real sum = 0.0;
+  for (int i = 0; i < N; i++)
+    sum += Rule<N>::Weight(i) * f(m1 * Rule<N>::Abscissa(i) + b1);
+  return m1 * sum;
+}
+
+// the integral of f(x1, x2) over [x1l, x1u] x [x2l, x2u] with the N-point rule in each
+// direction
+template <int N, typename F>
+KOKKOS_INLINE_FUNCTION Real integrate(const F &f, const Real x1l, const Real x1u,
+                                      const Real x2l, const Real x2u) {
+  const Real m1 = 0.5 * (x1u - x1l), b1 = 0.5 * (x1u + x1l);
+  const Real m2 = 0.5 * (x2u - x2l), b2 = 0.5 * (x2u + x2l);
+  Real sum = 0.0;
+  for (int j = 0; j < N; j++) {
+    const Real x2 = m2 * Rule<N>::Abscissa(j) + b2;
+    Real sum1 = 0.0;
+    for (int i = 0; i < N; i++)
+      sum1 += Rule<N>::Weight(i) * f(m1 * Rule<N>::Abscissa(i) + b1, x2);
+    sum += Rule<N>::Weight(j) * sum1;
+  }
+  return m1 * m2 * sum;
+}
+
+// the integral of f(x1, x2, x3) over [x1l, x1u] x [x2l, x2u] x [x3l, x3u] with the
+// N-point rule in each direction
+template <int N, typename F>
+KOKKOS_INLINE_FUNCTION Real integrate(const F &f, const Real x1l, const Real x1u,
+                                      const Real x2l, const Real x2u, const Real x3l,
+                                      const Real x3u) {
+  const Real m1 = 0.5 * (x1u - x1l), b1 = 0.5 * (x1u + x1l);
+  const Real m2 = 0.5 * (x2u - x2l), b2 = 0.5 * (x2u + x2l);
+  const Real m3 = 0.5 * (x3u - x3l), b3 = 0.5 * (x3u + x3l);
+  Real sum = 0.0;
+  for (int k = 0; k < N; k++) {
+    const Real x3 = m3 * Rule<N>::Abscissa(k) + b3;
+    Real sum2 = 0.0;
+    for (int j = 0; j < N; j++) {
+      const Real x2 = m2 * Rule<N>::Abscissa(j) + b2;
+      Real sum1 = 0.0;
+      for (int i = 0; i < N; i++)
+        sum1 += Rule<N>::Weight(i) * f(m1 * Rule<N>::Abscissa(i) + b1, x2, x3);
+      sum2 += Rule<N>::Weight(j) * sum1;
+    }
+    sum += Rule<N>::Weight(k) * sum2;
+  }
+  return m1 * m2 * m3 * sum;
+}
+
 } // namespace GaussLegendre
 } // namespace parthenon
 
@@ -15,15 +15,14 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 //! \file interp_table.cpp
-//  \brief implements functions in class InterpTable2D an intpolated lookup table
+//  \brief implements functions in classes InterpTable2D and InterpTable3D, intpolated
+//  lookup tables
 
-#include <cmath>
-#include <stdexcept>
+#include "utils/interp_table.hpp"
 
 #include "athena.hpp"
-#include "coordinates/coordinates.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
-#include "utils/interp_table.hpp"
 
 namespace parthenon {
 
@@ -71,36 +70,107 @@ void InterpTable2D::GetSize(int &nvar, int &nx2, int &nx1) {
   nx1 = nx1_;
 }
 
+DeviceInterpTable2D InterpTable2D::GetDeviceTable() const {
+  return DeviceInterpTable2D(data.Get<3>(), x2min_, x2norm_, x1min_, x1norm_);
+}
+
 // Bilinear interpolation
 Real InterpTable2D::interpolate(int var, Real x2, Real x1) {
-  Real x, y, xrl, yrl, out;
-  x = (x2 - x2min_) * x2norm_;
-  y = (x1 - x1min_) * x1norm_;
-  int xil = static_cast<int>(x); // lower x index
-  int yil = static_cast<int>(y); // lower y index
-  int nx = nx2_;
-  int ny = nx1_;
-  // if off table, do linear extrapolation
-  if (xil < 0) { // below xmin
-    xil = 0;
-  } else if (xil >= nx - 1) { // above xmax
-    xil = nx - 2;
-  }
-  xrl = 1 + xil - x; // x residual
-
-  if (yil < 0) { // below ymin
-    yil = 0;
-  } else if (yil >= ny - 1) { // above ymax
-    yil = ny - 2;
-  }
-  yrl = 1 + yil - y; // y residual
-
-  // Sample from the 4 nearest data points and weight appropriately
-  // data is an attribute of the eos class
-  out = xrl * yrl * data(var, xil, yil) + xrl * (1 - yrl) * data(var, xil, yil + 1) +
-        (1 - xrl) * yrl * data(var, xil + 1, yil) +
-        (1 - xrl) * (1 - yrl) * data(var, xil + 1, yil + 1);
-  return out;
+  return GetDeviceTable().Interpolate(var, x2, x1);
+}
+
+void InterpTable2D::InterpolateAll(const int var, const ParArrayND<Real> &x2,
+                                   const ParArrayND<Real> &x1,
+                                   ParArrayND<Real> out) const {
+  const DeviceInterpTable2D table = GetDeviceTable();
+  par_for(
+      "InterpTable2D::InterpolateAll", DevSpace(), 0, out.GetDim(3) - 1, 0,
+      out.GetDim(2) - 1, 0, out.GetDim(1) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        out(k, j, i) = table.Interpolate(var, x2(k, j, i), x1(k, j, i));
+      });
+}
+
+// A contructor that setts the size of the table with number of variables nvar
+// and dimensions nx3 x nx2 x nx1 (interpolated dimensions)
+InterpTable3D::InterpTable3D(const int nvar, const int nx3, const int nx2,
+                             const int nx1) {
+  SetSize(nvar, nx3, nx2, nx1);
+}
+
+// Set size of table
+void InterpTable3D::SetSize(const int nvar, const int nx3, const int nx2, const int nx1) {
+  nvar_ = nvar; // number of variables/tables
+  nx3_ = nx3;   // slowest indexing dimension
+  nx2_ = nx2;
+  nx1_ = nx1; // fastest indexing dimension
+  data = ParArrayND<Real>(PARARRAY_TEMP, nvar, nx3, nx2, nx1);
+}
+
+// Set the corrdinate limits for x1
+void InterpTable3D::SetX1lim(Real x1min, Real x1max) {
+  x1min_ = x1min;
+  x1max_ = x1max;
+  x1norm_ = (nx1_ - 1) / (x1max - x1min);
+}
+
+// Set the corrdinate limits for x2
+void InterpTable3D::SetX2lim(Real x2min, Real x2max) {
+  x2min_ = x2min;
+  x2max_ = x2max;
+  x2norm_ = (nx2_ - 1) / (x2max - x2min);
+}
+
+// Set the corrdinate limits for x3
+void InterpTable3D::SetX3lim(Real x3min, Real x3max) {
+  x3min_ = x3min;
+  x3max_ = x3max;
+  x3norm_ = (nx3_ - 1) / (x3max - x3min);
+}
+
+void InterpTable3D::GetX1lim(Real &x1min, Real &x1max) {
+  x1min = x1min_;
+  x1max = x1max_;
+}
+
+void InterpTable3D::GetX2lim(Real &x2min, Real &x2max) {
+  x2min = x2min_;
+  x2max = x2max_;
+}
+
+void InterpTable3D::GetX3lim(Real &x3min, Real &x3max) {
+  x3min = x3min_;
+  x3max = x3max_;
+}
+
+void InterpTable3D::GetSize(int &nvar, int &nx3, int &nx2, int &nx1) {
+  nvar = nvar_;
+  nx3 = nx3_;
+  nx2 = nx2_;
+  nx1 = nx1_;
+}
+
+DeviceInterpTable3D InterpTable3D::GetDeviceTable() const {
+  return DeviceInterpTable3D(data.Get<4>(), x3min_, x3norm_, x2min_, x2norm_, x1min_,
+                             x1norm_);
+}
+
+// Trilinear interpolation
+Real InterpTable3D::interpolate(int var, Real x3, Real x2, Real x1) {
+  return GetDeviceTable().Interpolate(var, x3, x2, x1);
+}
+
+void InterpTable3D::InterpolateAll(const int var, const ParArrayND<Real> &x3,
+                                   const ParArrayND<Real> &x2,
+                                   const ParArrayND<Real> &x1,
+                                   ParArrayND<Real> out) const {
+  const DeviceInterpTable3D table = GetDeviceTable();
+  par_for(
+      "InterpTable3D::InterpolateAll", DevSpace(), 0, out.GetDim(3) - 1, 0,
+      out.GetDim(2) - 1, 0, out.GetDim(1) - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        out(k, j, i) = table.Interpolate(var, x3(k, j, i), x2(k, j, i), x1(k, j, i));
+      });
 }
 
 } // namespace parthenon
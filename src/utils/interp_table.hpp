@@ -18,20 +18,108 @@
 #define UTILS_INTERP_TABLE_HPP_
 
 //! \file interp_table.hpp
-//  \brief defines class InterpTable2D
-//  Contains functions that implement an intpolated lookup table
+//  \brief defines classes InterpTable2D and InterpTable3D
+//  Contains functions that implement intpolated lookup tables. The tables live in device
+//  memory; GetDeviceTable() returns a copy that can be looked up inside kernels and
+//  InterpolateAll() looks up every cell of a block in one launch.
 
 #include "athena.hpp"
+#include "kokkos_abstraction.hpp"
 #include "parthenon_arrays.hpp"
 
 namespace parthenon {
 
+namespace interp_table_impl {
+// Lower index and weight of the lower point in one direction. Points off the table use
+// the first or last interval, i.e., are linearly extrapolated.
+KOKKOS_FORCEINLINE_FUNCTION
+void Locate(const Real x, const Real xmin, const Real xnorm, const int nx, int &il,
+            Real &wl) {
+  const Real xi = (x - xmin) * xnorm;
+  il = static_cast<int>(xi);
+  if (il < 0) { // below xmin
+    il = 0;
+  } else if (il >= nx - 1) { // above xmax
+    il = nx - 2;
+  }
+  wl = 1 + il - xi;
+}
+} // namespace interp_table_impl
+
+// The table values are read through the RandomAccess memory trait, which on CUDA goes
+// through the texture cache. The x1 direction is contiguous, so each lookup reads pairs
+// of neighboring values.
+using InterpTableView3D = Kokkos::View<const Real ***, LayoutWrapper, DevSpace,
+                                       Kokkos::MemoryTraits<Kokkos::RandomAccess>>;
+using InterpTableView4D = Kokkos::View<const Real ****, LayoutWrapper, DevSpace,
+                                       Kokkos::MemoryTraits<Kokkos::RandomAccess>>;
+
+// read-only view of an InterpTable2D that kernels capture by value
+class DeviceInterpTable2D {
+ public:
+  DeviceInterpTable2D() = default;
+  DeviceInterpTable2D(const InterpTableView3D &data, const Real x2min, const Real x2norm,
+                      const Real x1min, const Real x1norm)
+      : data_(data), x2min_(x2min), x2norm_(x2norm), x1min_(x1min), x1norm_(x1norm) {}
+
+  // bilinear interpolation of variable var
+  KOKKOS_INLINE_FUNCTION
+  Real Interpolate(const int var, const Real x2, const Real x1) const {
+    int j, i;
+    Real wj, wi;
+    interp_table_impl::Locate(x2, x2min_, x2norm_, data_.extent_int(1), j, wj);
+    interp_table_impl::Locate(x1, x1min_, x1norm_, data_.extent_int(2), i, wi);
+    return wj * (wi * data_(var, j, i) + (1 - wi) * data_(var, j, i + 1)) +
+           (1 - wj) * (wi * data_(var, j + 1, i) + (1 - wi) * data_(var, j + 1, i + 1));
+  }
+
+ private:
+  InterpTableView3D data_;
+  Real x2min_, x2norm_, x1min_, x1norm_;
+};
+
+// read-only view of an InterpTable3D that kernels capture by value
+class DeviceInterpTable3D {
+ public:
+  DeviceInterpTable3D() = default;
+  DeviceInterpTable3D(const InterpTableView4D &data, const Real x3min, const Real x3norm,
+                      const Real x2min, const Real x2norm, const Real x1min,
+                      const Real x1norm)
+      : data_(data), x3min_(x3min), x3norm_(x3norm), x2min_(x2min), x2norm_(x2norm),
+        x1min_(x1min), x1norm_(x1norm) {}
+
+  // trilinear interpolation of variable var
+  KOKKOS_INLINE_FUNCTION
+  Real Interpolate(const int var, const Real x3, const Real x2, const Real x1) const {
+    int k, j, i;
+    Real wk, wj, wi;
+    interp_table_impl::Locate(x3, x3min_, x3norm_, data_.extent_int(1), k, wk);
+    interp_table_impl::Locate(x2, x2min_, x2norm_, data_.extent_int(2), j, wj);
+    interp_table_impl::Locate(x1, x1min_, x1norm_, data_.extent_int(3), i, wi);
+    Real out = 0.0;
+    for (int dk = 0; dk < 2; dk++) {
+      const Real w3 = (dk ? 1 - wk : wk);
+      const Real lo =
+          wi * data_(var, k + dk, j, i) + (1 - wi) * data_(var, k + dk, j, i + 1);
+      const Real hi =
+          wi * data_(var, k + dk, j + 1, i) + (1 - wi) * data_(var, k + dk, j + 1, i + 1);
+      out += w3 * (wj * lo + (1 - wj) * hi);
+    }
+    return out;
+  }
+
+ private:
+  InterpTableView4D data_;
+  Real x3min_, x3norm_, x2min_, x2norm_, x1min_, x1norm_;
+};
+
 class InterpTable2D {
  public:
   InterpTable2D() = default;
   InterpTable2D(const int nvar, const int nx2, const int nx1);
 
   void SetSize(const int nvar, const int nx2, const int nx1);
+  // single lookup on the host, requires data in host accessible memory
   Real interpolate(int nvar, Real x2, Real x1);
   int nvar();
   ParArrayND<Real> data;
@@ -41,16 +129,64 @@ class InterpTable2D {
   void GetX2lim(Real &x2min, Real &x2max);
   void GetSize(int &nvar, int &nx2, int &nx1);
 
+  // for lookups in kernels, valid until SetSize or the limits are changed
+  DeviceInterpTable2D GetDeviceTable() const;
+  // out(k, j, i) = interpolate(var, x2(k, j, i), x1(k, j, i)) for all elements of the
+  // 3D arrays (e.g., all cells of a block) in a single launch
+  void InterpolateAll(const int var, const ParArrayND<Real> &x2,
+                      const ParArrayND<Real> &x1, ParArrayND<Real> out) const;
+
+ private:
+  int nvar_;
+  int nx1_;
+  int nx2_;
+  Real x1min_;
+  Real x1max_;
+  Real x1norm_;
+  Real x2min_;
+  Real x2max_;
+  Real x2norm_;
+};
+
+class InterpTable3D {
+ public:
+  InterpTable3D() = default;
+  InterpTable3D(const int nvar, const int nx3, const int nx2, const int nx1);
+
+  void SetSize(const int nvar, const int nx3, const int nx2, const int nx1);
+  // single lookup on the host, requires data in host accessible memory
+  Real interpolate(int nvar, Real x3, Real x2, Real x1);
+  ParArrayND<Real> data;
+  void SetX1lim(Real x1min, Real x1max);
+  void SetX2lim(Real x2min, Real x2max);
+  void SetX3lim(Real x3min, Real x3max);
+  void GetX1lim(Real &x1min, Real &x1max);
+  void GetX2lim(Real &x2min, Real &x2max);
+  void GetX3lim(Real &x3min, Real &x3max);
+  void GetSize(int &nvar, int &nx3, int &nx2, int &nx1);
+
+  // for lookups in kernels, valid until SetSize or the limits are changed
+  DeviceInterpTable3D GetDeviceTable() const;
+  // out(k, j, i) = interpolate(var, x3(k, j, i), x2(k, j, i), x1(k, j, i)) for all
+  // elements of the 3D arrays in a single launch
+  void InterpolateAll(const int var, const ParArrayND<Real> &x3,
+                      const ParArrayND<Real> &x2, const ParArrayND<Real> &x1,
+                      ParArrayND<Real> out) const;
+
  private:
   int nvar_;
   int nx1_;
   int nx2_;
+  int nx3_;
   Real x1min_;
   Real x1max_;
   Real x1norm_;
   Real x2min_;
   Real x2max_;
   Real x2norm_;
+  Real x3min_;
+  Real x3max_;
+  Real x3norm_;
 };
 
 } // namespace parthenon
@@ -0,0 +1,100 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file kernel_graph.cpp
+//  \brief the CUDA stream capture behind KernelGraph
+
+#include "utils/kernel_graph.hpp"
+
+#include <sstream>
+
+#if defined(KOKKOS_ENABLE_CUDA) && !defined(KOKKOS_ENABLE_CUDA_UVM)
+#include <cuda_runtime_api.h>
+#define PARTHENON_KERNEL_GRAPHS
+#endif
+
+#include "athena.hpp"
+
+namespace parthenon {
+
+bool KernelGraph::enabled_ = false;
+
+namespace {
+#ifdef PARTHENON_KERNEL_GRAPHS
+void CheckCuda(const cudaError_t err, const char *call) {
+  if (err != cudaSuccess) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in KernelGraph" << std::endl
+        << call << " failed: " << cudaGetErrorString(err) << std::endl;
+    ATHENA_ERROR(msg);
+  }
+}
+#endif
+} // namespace
+
+KernelGraph::~KernelGraph() {
+  Reset();
+  if (own_capture_space_) SpaceInstance<DevSpace>::destroy(capture_space_);
+}
+
+bool KernelGraph::Capturable_(const DevSpace &space) {
+#ifdef PARTHENON_KERNEL_GRAPHS
+  return space.cuda_stream() != nullptr;
+#else
+  return false;
+#endif
+}
+
+const DevSpace &KernelGraph::CaptureSpace_() {
+  if (!own_capture_space_) {
+    capture_space_ = SpaceInstance<DevSpace>::create();
+    own_capture_space_ = true;
+  }
+  return capture_space_;
+}
+
+void KernelGraph::BeginCapture_(const DevSpace &space) {
+#ifdef PARTHENON_KERNEL_GRAPHS
+  // thread local, so that the other threads of the mesh may fence meanwhile
+  CheckCuda(cudaStreamBeginCapture(space.cuda_stream(), cudaStreamCaptureModeThreadLocal),
+            "cudaStreamBeginCapture");
+#endif
+}
+
+void KernelGraph::EndCapture_(const DevSpace &space) {
+#ifdef PARTHENON_KERNEL_GRAPHS
+  cudaGraph_t graph;
+  CheckCuda(cudaStreamEndCapture(space.cuda_stream(), &graph), "cudaStreamEndCapture");
+  cudaGraphExec_t exec;
+  CheckCuda(cudaGraphInstantiate(&exec, graph, nullptr, nullptr, 0),
+            "cudaGraphInstantiate");
+  CheckCuda(cudaGraphDestroy(graph), "cudaGraphDestroy");
+  exec_ = exec;
+#endif
+}
+
+void KernelGraph::Launch_(const DevSpace &space) {
+#ifdef PARTHENON_KERNEL_GRAPHS
+  CheckCuda(cudaGraphLaunch(static_cast<cudaGraphExec_t>(exec_), space.cuda_stream()),
+            "cudaGraphLaunch");
+#endif
+}
+
+void KernelGraph::Reset() {
+#ifdef PARTHENON_KERNEL_GRAPHS
+  if (exec_ != nullptr) cudaGraphExecDestroy(static_cast<cudaGraphExec_t>(exec_));
+#endif
+  exec_ = nullptr;
+  signature_.clear();
+}
+
+} // namespace parthenon
@@ -0,0 +1,90 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_KERNEL_GRAPH_HPP_
+#define UTILS_KERNEL_GRAPH_HPP_
+//! \file kernel_graph.hpp
+//  \brief recording of a sequence of kernels as a CUDA graph that is replayed with a
+//  single launch
+
+#include <cstdint>
+#include <vector>
+
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \class KernelGraph
+//  \brief Run(space, signature, f) calls f(space), which launches a fixed sequence of
+//  kernels on the execution space instance it is given. With <mesh>/kernel_graphs in
+//  CUDA builds, the first call captures the kernels in a CUDA graph instead, and later
+//  calls with the same signature launch the graph on space, which costs about one kernel
+//  launch for the whole sequence. The kernels of a graph keep the arguments they were
+//  captured with, so the signature has to contain everything their arguments depend on
+//  that may change before the graphs of a block (MeshBlock::kernel_graphs) are dropped,
+//  in a regrid or when its stage containers are purged, e.g. the pointers of arrays that
+//  are reallocated. A different signature captures the graph again.
+//
+//  The capture runs on an instance owned by the graph, as other blocks on other threads
+//  may share space. While f is captured it must not fence (as the autotuning of
+//  RUNTIME_LOOP does), allocate, copy to or from the host, or launch on any instance but
+//  the one it is given. Without CUDA, in UVM builds and for blocks on the default
+//  instance (see <mesh>/num_exec_space_instances), f(space) is simply called.
+
+class KernelGraph {
+ public:
+  KernelGraph() = default;
+  ~KernelGraph();
+  KernelGraph(const KernelGraph &) = delete;
+  KernelGraph &operator=(const KernelGraph &) = delete;
+
+  static void Enable(const bool enable) { enabled_ = enable; }
+  static bool Enabled() { return enabled_; }
+
+  template <typename F>
+  void Run(const DevSpace &space, const std::vector<std::uintptr_t> &signature,
+           const F &f) {
+    if (!enabled_ || !Capturable_(space)) {
+      f(space);
+      return;
+    }
+    if (exec_ == nullptr || signature != signature_) {
+      Reset();
+      const DevSpace &capture = CaptureSpace_();
+      BeginCapture_(capture);
+      f(capture);
+      EndCapture_(capture);
+      signature_ = signature;
+    }
+    Launch_(space);
+  }
+  // drop the graph, the next Run() captures it again
+  void Reset();
+
+ private:
+  static bool Capturable_(const DevSpace &space);
+  const DevSpace &CaptureSpace_();
+  void BeginCapture_(const DevSpace &space);
+  void EndCapture_(const DevSpace &space);
+  void Launch_(const DevSpace &space);
+
+  static bool enabled_;
+  std::vector<std::uintptr_t> signature_;
+  void *exec_ = nullptr; // the instantiated graph, a cudaGraphExec_t
+  DevSpace capture_space_;
+  bool own_capture_space_ = false; // capture_space_ was created by CaptureSpace_()
+};
+
+} // namespace parthenon
+
+#endif // UTILS_KERNEL_GRAPH_HPP_
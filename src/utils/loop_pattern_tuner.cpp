@@ -0,0 +1,200 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file loop_pattern_tuner.cpp
+//  \brief implementation of the LoopPatternTuner class
+
+#include "utils/loop_pattern_tuner.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+#include "parameter_input.hpp"
+
+namespace parthenon {
+
+LoopPatternTuner &LoopPatternTuner::Get() {
+  static LoopPatternTuner tuner;
+  return tuner;
+}
+
+LoopPatternTuner::LoopPatternTuner() : default_pattern_(Available().front()) {}
+
+//----------------------------------------------------------------------------------------
+//! \fn const std::vector<LoopPattern> &LoopPatternTuner::Available()
+//  \brief The patterns a kernel may run with, the preferred one first. Plain SIMD loops
+//  run on the host and the TPTVR pattern does not map onto GPU threads, so neither is
+//  available with CUDA, HIP or SYCL.
+
+const std::vector<LoopPattern> &LoopPatternTuner::Available() {
+#ifdef PARTHENON_GPU_BACKEND
+  static const std::vector<LoopPattern> patterns = {
+      LoopPattern::flatrange, LoopPattern::mdrange, LoopPattern::tpttr,
+      LoopPattern::tpttrtvr};
+#else
+  static const std::vector<LoopPattern> patterns = {
+      LoopPattern::simdfor, LoopPattern::flatrange, LoopPattern::mdrange,
+      LoopPattern::tpttr,   LoopPattern::tptvr,     LoopPattern::tpttrtvr};
+#endif
+  return patterns;
+}
+
+LoopPattern LoopPatternTuner::FromString(const std::string &str) {
+  for (auto pattern : {LoopPattern::flatrange, LoopPattern::mdrange, LoopPattern::tpttr,
+                       LoopPattern::tptvr, LoopPattern::tpttrtvr, LoopPattern::simdfor}) {
+    if (str == ToString(pattern)) {
+      const auto &available = Available();
+      if (std::find(available.begin(), available.end(), pattern) == available.end()) {
+        std::stringstream msg;
+        msg << "### FATAL ERROR in function [LoopPatternTuner::FromString]" << std::endl
+            << "Loop pattern '" << str << "' is not available with this backend"
+            << std::endl;
+        ATHENA_ERROR(msg);
+      }
+      return pattern;
+    }
+  }
+  std::stringstream msg;
+  msg << "### FATAL ERROR in function [LoopPatternTuner::FromString]" << std::endl
+      << "Unknown loop pattern '" << str << "', valid choices are flatrange, mdrange, "
+      << "tpttr, tptvr, tpttrtvr and simdfor" << std::endl;
+  ATHENA_ERROR(msg);
+  return LoopPattern::flatrange;
+}
+
+std::string LoopPatternTuner::ToString(const LoopPattern pattern) {
+  switch (pattern) {
+  case LoopPattern::flatrange:
+    return "flatrange";
+  case LoopPattern::mdrange:
+    return "mdrange";
+  case LoopPattern::tpttr:
+    return "tpttr";
+  case LoopPattern::tptvr:
+    return "tptvr";
+  case LoopPattern::tpttrtvr:
+    return "tpttrtvr";
+  case LoopPattern::simdfor:
+    return "simdfor";
+  }
+  return "undefined";
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void LoopPatternTuner::Initialize(ParameterInput *pin)
+//  \brief Reads the default pattern and the autotuning settings. The choices file holds
+//  one kernel per line, its pattern followed by its name (which may contain spaces).
+
+void LoopPatternTuner::Initialize(ParameterInput *pin) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  default_pattern_ = FromString(pin->GetOrAddString("loop_pattern", "default",
+                                                    ToString(Available().front())));
+  autotune_ = pin->GetOrAddBoolean("loop_pattern", "autotune", false);
+  trials_ = pin->GetOrAddInteger("loop_pattern", "autotune_trials", 3);
+  file_ = pin->GetOrAddString("loop_pattern", "file", "loop_patterns.txt");
+  if (trials_ < 1) {
+    std::stringstream msg;
+    msg << "### FATAL ERROR in function [LoopPatternTuner::Initialize]" << std::endl
+        << "<loop_pattern>/autotune_trials must be at least 1" << std::endl;
+    ATHENA_ERROR(msg);
+  }
+
+  // kernels launched before this point have been using the previous default
+  for (auto &kernel : kernels_) {
+    if (!kernel.second.fixed) kernel.second = Kernel{default_pattern_};
+  }
+
+  std::ifstream choices(file_);
+  std::string line;
+  while (std::getline(choices, line)) {
+    std::istringstream is(line);
+    std::string pattern, name;
+    if (!(is >> pattern)) continue;
+    std::getline(is >> std::ws, name);
+    Kernel &kernel = kernels_[name];
+    kernel.pattern = FromString(pattern);
+    kernel.fixed = true;
+  }
+}
+
+LoopPatternTuner::Kernel &LoopPatternTuner::Find(const std::string &name) {
+  auto it = kernels_.find(name);
+  if (it == kernels_.end()) it = kernels_.emplace(name, Kernel{default_pattern_}).first;
+  return it->second;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn LoopPattern LoopPatternTuner::Choose(const std::string &name, bool &timed)
+//  \brief While a kernel is tuned, its launches go round robin through the available
+//  patterns. The first round warms up each pattern and is not timed.
+
+LoopPattern LoopPatternTuner::Choose(const std::string &name, bool &timed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Kernel &kernel = Find(name);
+  timed = false;
+  if (!autotune_ || kernel.fixed) return kernel.pattern;
+
+  const auto &available = Available();
+  const int npatterns = available.size();
+  // the last trials may still be in flight on other threads
+  if (kernel.launches >= (trials_ + 1) * npatterns) return kernel.pattern;
+  if (kernel.seconds.empty()) kernel.seconds.resize(npatterns, 0.0);
+  timed = kernel.launches >= npatterns;
+  return available[kernel.launches++ % npatterns];
+}
+
+void LoopPatternTuner::Record(const std::string &name, const LoopPattern pattern,
+                              const double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Kernel &kernel = Find(name);
+  // trials of a kernel that has been reset by Initialize() are dropped
+  if (kernel.fixed || kernel.seconds.empty()) return;
+
+  const auto &available = Available();
+  const int npatterns = available.size();
+  kernel.seconds[std::find(available.begin(), available.end(), pattern) -
+                 available.begin()] += seconds;
+  if (++kernel.recorded == trials_ * npatterns) {
+    const int best =
+        std::min_element(kernel.seconds.begin(), kernel.seconds.end()) -
+        kernel.seconds.begin();
+    kernel.pattern = available[best];
+    kernel.fixed = true;
+  }
+}
+
+void LoopPatternTuner::Set(const std::string &name, const LoopPattern pattern) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Kernel &kernel = Find(name);
+  kernel.pattern = pattern;
+  kernel.fixed = true;
+}
+
+void LoopPatternTuner::Save() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!autotune_ || file_.empty()) return;
+  std::ofstream choices(file_);
+  for (const auto &kernel : kernels_) {
+    if (kernel.second.fixed) {
+      choices << ToString(kernel.second.pattern) << " " << kernel.first << std::endl;
+    }
+  }
+}
+
+} // namespace parthenon
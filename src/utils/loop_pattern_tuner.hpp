@@ -0,0 +1,82 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_LOOP_PATTERN_TUNER_HPP_
+#define UTILS_LOOP_PATTERN_TUNER_HPP_
+//! \file loop_pattern_tuner.hpp
+//  \brief runtime choice of the loop pattern used by the default par_for wrappers
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace parthenon {
+
+class ParameterInput;
+
+enum class LoopPattern { flatrange, mdrange, tpttr, tptvr, tpttrtvr, simdfor };
+
+//----------------------------------------------------------------------------------------
+//! \class LoopPatternTuner
+//  \brief Chooses the loop pattern of every named kernel launched with
+//  loop_pattern_runtime_tag, which is the default pattern of RUNTIME_LOOP builds. A
+//  kernel uses the pattern listed for it in the choices file, and otherwise the default
+//  pattern of the <loop_pattern> input block. In autotune mode, a kernel without a
+//  choice instead cycles through all patterns available on the backend during its first
+//  launches, timing each, and keeps the fastest. The choices made this way are written
+//  to the choices file at the end of the run, so that later runs start from them.
+
+class LoopPatternTuner {
+ public:
+  static LoopPatternTuner &Get();
+
+  // reads the <loop_pattern> input block and the choices file, if it exists
+  void Initialize(ParameterInput *pin);
+  // pattern for the next launch of kernel name; timed is set if the launch is an
+  // autotuning trial whose duration has to be reported with Record()
+  LoopPattern Choose(const std::string &name, bool &timed);
+  void Record(const std::string &name, const LoopPattern pattern, const double seconds);
+  // fixes the pattern of kernel name, ending any autotuning of it
+  void Set(const std::string &name, const LoopPattern pattern);
+  // writes the choices for all kernels tuned in this run (and those read at startup)
+  void Save() const;
+
+  // patterns that are valid for the device execution space
+  static const std::vector<LoopPattern> &Available();
+  static LoopPattern FromString(const std::string &str);
+  static std::string ToString(const LoopPattern pattern);
+
+ private:
+  LoopPatternTuner();
+
+  struct Kernel {
+    LoopPattern pattern;
+    bool fixed = false;
+    int launches = 0, recorded = 0;
+    // accumulated time of the trials of each available pattern
+    std::vector<double> seconds;
+  };
+  Kernel &Find(const std::string &name);
+
+  LoopPattern default_pattern_;
+  bool autotune_ = false;
+  // timed launches per pattern, after one untimed warmup launch of each
+  int trials_ = 3;
+  std::string file_;
+  std::map<std::string, Kernel> kernels_;
+  mutable std::mutex mutex_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_LOOP_PATTERN_TUNER_HPP_
@@ -0,0 +1,164 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file memory_usage.cpp
+//  \brief queries of the operating system and the CUDA runtime for the memory in use,
+//  and the reduction of the accounting of parthenon's arrays
+
+#include "utils/memory_usage.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <Kokkos_Core.hpp>
+
+#ifdef KOKKOS_ENABLE_CUDA
+#include <cuda_runtime_api.h>
+#elif defined(KOKKOS_ENABLE_HIP)
+#include <hip/hip_runtime_api.h>
+#endif
+
+#include "parthenon_mpi.hpp"
+
+#include "globals.hpp"
+
+namespace parthenon {
+namespace MemoryUsage {
+
+std::size_t HostCurrent() {
+  // the second entry of statm is the number of resident pages (Linux only)
+  std::ifstream statm("/proc/self/statm");
+  std::size_t size = 0, resident = 0;
+  if (!(statm >> size >> resident)) return 0;
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::size_t HostPeak() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+  // kilobytes on Linux
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+std::size_t DeviceCurrent() {
+#ifdef KOKKOS_ENABLE_CUDA
+  std::size_t free = 0, total = 0;
+  if (cudaMemGetInfo(&free, &total) != cudaSuccess) return 0;
+  return total - free;
+#elif defined(KOKKOS_ENABLE_HIP)
+  std::size_t free = 0, total = 0;
+  if (hipMemGetInfo(&free, &total) != hipSuccess) return 0;
+  return total - free;
+#else
+  return 0;
+#endif
+}
+
+void Accounting::Add(const std::string &label, const std::string &kind, const Space space,
+                     const void *ptr, const std::size_t bytes) {
+  if (ptr == nullptr || bytes == 0 || !seen_.insert(ptr).second) return;
+  bytes_[Key(label, kind)][static_cast<int>(space)] += bytes;
+}
+
+std::size_t Accounting::Total(const Space space) const {
+  std::size_t total = 0;
+  for (const auto &e : bytes_)
+    total += e.second[static_cast<int>(space)];
+  return total;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void Accounting::Report(std::ostream &os, const std::string &title) const
+//  \brief As TaskTimer::Report, the ranks first agree on the union of their entries, then
+//  reduce the bytes of each. A rank without an entry contributes zero bytes to it.
+
+void Accounting::Report(std::ostream &os, const std::string &title) const {
+  std::vector<Key> keys;
+  for (const auto &e : bytes_)
+    keys.push_back(e.first);
+
+#ifdef MPI_PARALLEL
+  // labels and kinds hold no newlines, so each key is "label\nkind\n"
+  std::string local;
+  for (const auto &key : keys)
+    local += key.first + '\n' + key.second + '\n';
+  int len = local.size();
+  std::vector<int> lens(Globals::nranks), displs(Globals::nranks, 0);
+  MPI_Allgather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, MPI_COMM_WORLD);
+  for (int n = 1; n < Globals::nranks; n++)
+    displs[n] = displs[n - 1] + lens[n - 1];
+  std::string all(displs.back() + lens.back(), '\0');
+  MPI_Allgatherv(local.data(), len, MPI_CHAR, &all[0], lens.data(), displs.data(),
+                 MPI_CHAR, MPI_COMM_WORLD);
+  std::istringstream is(all);
+  std::string label, kind;
+  while (std::getline(is, label) && std::getline(is, kind))
+    keys.emplace_back(label, kind);
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+#endif
+
+  // host and device bytes of every key, then the totals of the rank
+  const int nkeys = keys.size();
+  std::vector<unsigned long long> sum, most;
+  for (const auto &key : keys) {
+    auto it = bytes_.find(key);
+    const Bytes bytes = (it == bytes_.end()) ? Bytes{{0, 0}} : it->second;
+    sum.push_back(bytes[0]);
+    sum.push_back(bytes[1]);
+  }
+  sum.push_back(Total(Space::host));
+  sum.push_back(Total(Space::device));
+  most = sum;
+#ifdef MPI_PARALLEL
+  MPI_Allreduce(MPI_IN_PLACE, sum.data(), sum.size(), MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+                MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, most.data(), most.size(), MPI_UNSIGNED_LONG_LONG, MPI_MAX,
+                MPI_COMM_WORLD);
+#endif
+  if (Globals::my_rank != 0) return;
+
+  int width = 6;
+  for (const auto &key : keys)
+    width = std::max<int>(width, key.first.size() + 2);
+  const double mib = 1024.0 * 1024.0;
+  auto row = [&](const std::string &label, const std::string &kind, const int n) {
+    os << std::left << std::setw(width) << label << std::setw(12) << kind << std::right
+       << std::setw(14) << sum[2 * n] / mib << std::setw(14) << most[2 * n] / mib
+       << std::setw(14) << sum[2 * n + 1] / mib << std::setw(14) << most[2 * n + 1] / mib
+       << std::endl;
+  };
+  os << std::endl
+     << title << " on " << Globals::nranks << " ranks, in MiB" << std::endl
+     << std::left << std::setw(width) << "label" << std::setw(12) << "kind" << std::right
+     << std::setw(14) << "host total" << std::setw(14) << "host max_rank"
+     << std::setw(14) << "device total" << std::setw(14) << "device max_rank"
+     << std::endl;
+  os << std::fixed << std::setprecision(3);
+  for (int n = 0; n < nkeys; n++)
+    row(keys[n].first, keys[n].second, n);
+  row("total", "", nkeys);
+  os << std::defaultfloat;
+}
+
+} // namespace MemoryUsage
+} // namespace parthenon
@@ -0,0 +1,102 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_MEMORY_USAGE_HPP_
+#define UTILS_MEMORY_USAGE_HPP_
+//! \file memory_usage.hpp
+//  \brief memory used by this process on the host and the device, and the accounting of
+//  the arrays allocated by parthenon
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <Kokkos_Core.hpp>
+
+namespace parthenon {
+namespace MemoryUsage {
+
+// resident set size of this process in bytes, 0 where it cannot be queried
+std::size_t HostCurrent();
+// high-water mark of the resident set size of this process in bytes, 0 where unknown
+std::size_t HostPeak();
+// memory in use on the device of this rank in bytes (with CUDA, by all processes sharing
+// the device), 0 if the device has no memory of its own
+std::size_t DeviceCurrent();
+
+enum class Space { host = 0, device = 1 };
+
+// pinned host memory, e.g. of the communication buffers with HOST_COMM_BUFFERS, counts as
+// host memory; everything else not in HostSpace as device memory
+template <typename MemSpace>
+struct IsHostSpace : std::is_same<MemSpace, Kokkos::HostSpace> {};
+#ifdef KOKKOS_ENABLE_CUDA
+template <>
+struct IsHostSpace<Kokkos::CudaHostPinnedSpace> : std::true_type {};
+#endif
+#ifdef KOKKOS_ENABLE_HIP
+template <>
+struct IsHostSpace<Kokkos::Experimental::HIPHostPinnedSpace> : std::true_type {};
+#endif
+#ifdef KOKKOS_ENABLE_SYCL
+template <>
+struct IsHostSpace<Kokkos::Experimental::SYCLHostUSMSpace> : std::true_type {};
+#endif
+
+//----------------------------------------------------------------------------------------
+//! \class Accounting
+//  \brief Bytes of the arrays allocated by parthenon, by the label of the variable (or
+//  another owner, e.g. "(array pool)"), the kind of array ("data", "stage data",
+//  "strided", "flux", "coarse", "comm", "host copy", ...) and the memory space. An
+//  allocation is counted once however often it is added, so arrays shared between the
+//  copies of a variable in the stage containers, or between a variable and its boundary
+//  object, count once.
+//  Filled by MeshBlock::AccountMemory and Mesh::AccountMemory; Report() reduces it over
+//  all ranks.
+
+class Accounting {
+ public:
+  using Key = std::pair<std::string, std::string>; // (label, kind)
+  using Bytes = std::array<std::size_t, 2>;        // indexed by Space
+
+  void Add(const std::string &label, const std::string &kind, const Space space,
+           const void *ptr, const std::size_t bytes);
+  // any Kokkos::View; a view of another view adds the part it spans
+  template <typename View>
+  void AddView(const std::string &label, const std::string &kind, const View &v) {
+    using MemSpace = typename View::memory_space;
+    Add(label, kind, IsHostSpace<MemSpace>::value ? Space::host : Space::device,
+        v.data(), v.span() * sizeof(typename View::value_type));
+  }
+
+  const std::map<Key, Bytes> &Entries() const { return bytes_; }
+  std::size_t Total(const Space space) const;
+  std::size_t Total() const { return Total(Space::host) + Total(Space::device); }
+
+  // collective over all ranks: writes the sum over ranks and the largest value of a
+  // rank of every entry on rank 0
+  void Report(std::ostream &os, const std::string &title) const;
+
+ private:
+  std::map<Key, Bytes> bytes_;
+  std::set<const void *> seen_;
+};
+
+} // namespace MemoryUsage
+} // namespace parthenon
+
+#endif // UTILS_MEMORY_USAGE_HPP_
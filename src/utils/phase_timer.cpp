@@ -0,0 +1,95 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file phase_timer.cpp
+//  \brief implementation of the PhaseTimer class
+
+#include "utils/phase_timer.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+#include <Kokkos_Core.hpp>
+
+#include "parthenon_mpi.hpp"
+
+#include "globals.hpp"
+
+namespace parthenon {
+
+PhaseTimer &PhaseTimer::Get() {
+  static PhaseTimer timer;
+  return timer;
+}
+
+void PhaseTimer::Start() {
+  start_ = std::chrono::steady_clock::now();
+  seconds_.fill(0.0);
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void PhaseTimer::Report(std::ostream &os, const std::uint64_t zonecycles,
+//                              const int ncycles)
+//  \brief The throughput is based on the wall time of the slowest rank, which is the
+//  time of the run. zonecycles counts the cells of all ranks.
+
+void PhaseTimer::Report(std::ostream &os, const std::uint64_t zonecycles,
+                        const int ncycles) {
+  if (!enabled_) return;
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+  // the wall time, the phases, and the remainder of the wall time
+  const int n = kNumPhases + 2;
+  double local[n];
+  local[0] = elapsed.count();
+  double accounted = 0.0;
+  for (int p = 0; p < kNumPhases; p++) {
+    local[p + 1] = seconds_[p];
+    accounted += seconds_[p];
+  }
+  local[n - 1] = std::max(0.0, local[0] - accounted);
+  double tmin[n], tsum[n], tmax[n];
+  std::copy(local, local + n, tmin);
+  std::copy(local, local + n, tsum);
+  std::copy(local, local + n, tmax);
+#ifdef MPI_PARALLEL
+  MPI_Allreduce(MPI_IN_PLACE, tmin, n, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, tsum, n, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, tmax, n, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+  if (Globals::my_rank != 0) return;
+
+  const double wall = std::max(tmax[0], 1.0e-30);
+  const double zcs = static_cast<double>(zonecycles) / wall;
+  os << std::endl
+     << "Scaling report over " << ncycles << " cycles on " << Globals::nranks
+     << " ranks (" << Kokkos::DefaultExecutionSpace::name() << ")" << std::endl
+     << "zone-cycles = " << zonecycles << std::endl
+     << "wall time = " << wall << std::endl
+     << "zone-cycles/wall_second = " << zcs << std::endl
+     << "zone-cycles/wall_second/rank = " << zcs / Globals::nranks << std::endl;
+
+  const std::string names[n] = {"wall", "compute", "communication", "amr", "io", "other"};
+  os << std::left << std::setw(16) << "phase" << std::right << std::setw(12) << "min"
+     << std::setw(12) << "avg" << std::setw(12) << "max" << std::setw(10) << "% wall"
+     << std::endl;
+  for (int p = 1; p < n; p++) {
+    const double avg = tsum[p] / Globals::nranks;
+    os << std::left << std::setw(16) << names[p] << std::right << std::scientific
+       << std::setprecision(3) << std::setw(12) << tmin[p] << std::setw(12) << avg
+       << std::setw(12) << tmax[p] << std::fixed << std::setprecision(1) << std::setw(10)
+       << 100.0 * avg / wall << std::endl;
+  }
+  os << std::defaultfloat << std::setprecision(6);
+}
+
+} // namespace parthenon
@@ -0,0 +1,92 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_PHASE_TIMER_HPP_
+#define UTILS_PHASE_TIMER_HPP_
+//! \file phase_timer.hpp
+//  \brief throughput of a run and the split of its wall-clock time into phases
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace parthenon {
+
+// compute:       task list passes in which a task completed
+// communication: task list passes that only polled for messages, and the time step
+//                reduction
+// amr:           refinement, derefinement and load balancing
+// io:            outputs and in-situ analyses
+enum class Phase { compute, communication, amr, io };
+constexpr int kNumPhases = 4;
+
+//----------------------------------------------------------------------------------------
+//! \class PhaseTimer
+//  \brief Splits the wall-clock time of the main loop into the phases above, the
+//  remainder (e.g. threads that found no task list to work on) being reported as
+//  other. Report() gives the zone-cycles per wall second of the whole run and per rank
+//  (i.e. per device on GPU builds) together with the min/avg/max over ranks of each
+//  phase, which is what weak and strong scaling studies need. Enabled with
+//  <profiling>/scaling_report.
+
+class PhaseTimer {
+ public:
+  static PhaseTimer &Get();
+
+  void Enable(const bool enable) { enabled_ = enable; }
+  bool Enabled() const { return enabled_; }
+  // starts the wall clock of the run and clears the phases
+  void Start();
+  // called from the thread that drives the main loop
+  void Add(const Phase phase, const double seconds) {
+    seconds_[static_cast<int>(phase)] += seconds;
+  }
+  // collective over all ranks, written on rank 0
+  void Report(std::ostream &os, const std::uint64_t zonecycles, const int ncycles);
+
+ private:
+  PhaseTimer() = default;
+
+  bool enabled_ = false;
+  std::chrono::steady_clock::time_point start_;
+  std::array<double, kNumPhases> seconds_{};
+};
+
+//----------------------------------------------------------------------------------------
+//! \class PhaseScope
+//  \brief adds the wall-clock time of its lifetime to a phase, if the timer is enabled
+
+class PhaseScope {
+ public:
+  explicit PhaseScope(const Phase phase)
+      : phase_(phase), enabled_(PhaseTimer::Get().Enabled()) {
+    if (enabled_) start_ = std::chrono::steady_clock::now();
+  }
+  ~PhaseScope() {
+    if (!enabled_) return;
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_;
+    PhaseTimer::Get().Add(phase_, elapsed.count());
+  }
+  PhaseScope(const PhaseScope &) = delete;
+  PhaseScope &operator=(const PhaseScope &) = delete;
+
+ private:
+  const Phase phase_;
+  const bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_PHASE_TIMER_HPP_
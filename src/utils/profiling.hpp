@@ -0,0 +1,64 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_PROFILING_HPP_
+#define UTILS_PROFILING_HPP_
+//! \file profiling.hpp
+//  \brief named regions for profiling tools
+
+#include <string>
+
+#include <Kokkos_Core.hpp>
+
+#include "defs.hpp"
+
+#ifdef ENABLE_CALIPER
+#include <caliper/cali.h>
+#endif
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \class ProfilingRegion
+//  \brief Marks its lifetime as a region of the given name for Kokkos Tools, so that the
+//  region appears in the timelines of e.g. the nvtx (Nsight Systems) and VTune
+//  connectors. In builds with ENABLE_CALIPER the region is also annotated for Caliper,
+//  which can aggregate the time spent in each region. Without a tool loaded a region
+//  costs a few branches and no allocation.
+
+class ProfilingRegion {
+ public:
+  // the name is not copied, it has to outlive the region
+  explicit ProfilingRegion(const char *name) : name_(name) {
+    if (Kokkos::Profiling::profileLibraryLoaded()) Kokkos::Profiling::pushRegion(name_);
+#ifdef ENABLE_CALIPER
+    cali_begin_region(name_);
+#endif
+  }
+  explicit ProfilingRegion(const std::string &name) : ProfilingRegion(name.c_str()) {}
+  explicit ProfilingRegion(std::string &&name) = delete;
+  ~ProfilingRegion() {
+#ifdef ENABLE_CALIPER
+    cali_end_region(name_);
+#endif
+    if (Kokkos::Profiling::profileLibraryLoaded()) Kokkos::Profiling::popRegion();
+  }
+  ProfilingRegion(const ProfilingRegion &) = delete;
+  ProfilingRegion &operator=(const ProfilingRegion &) = delete;
+
+ private:
+  const char *name_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_PROFILING_HPP_
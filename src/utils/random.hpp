@@ -0,0 +1,121 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_RANDOM_HPP_
+#define UTILS_RANDOM_HPP_
+//! \file random.hpp
+//  \brief counter-based random numbers for host and device code. Each number is a
+//  function of a key and a counter only (Philox4x32-10 of Salmon et al. 2011, "Parallel
+//  random numbers: as easy as 1, 2, 3"), so a kernel draws the numbers of a cell from
+//  its own stream without any generator state shared between threads, and the numbers
+//  do not depend on the order of the draws or on the decomposition of the mesh.
+
+#include <cmath>
+#include <cstdint>
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+
+namespace parthenon {
+
+namespace Random {
+
+// 32 x 32 -> 64 bit product, split into its high and low words
+KOKKOS_FORCEINLINE_FUNCTION void MulHiLo(const std::uint32_t a, const std::uint32_t b,
+                                         std::uint32_t &hi, std::uint32_t &lo) {
+  const std::uint64_t product = static_cast<std::uint64_t>(a) * b;
+  hi = static_cast<std::uint32_t>(product >> 32);
+  lo = static_cast<std::uint32_t>(product);
+}
+
+// the Philox4x32-10 bijection: replaces the 128-bit counter ctr by its image under the
+// 64-bit key
+KOKKOS_INLINE_FUNCTION void Philox4x32(std::uint32_t ctr[4], const std::uint32_t key[2]) {
+  std::uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < 10; round++) {
+    if (round > 0) {
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+    std::uint32_t hi0, lo0, hi1, lo1;
+    MulHiLo(0xD2511F53u, ctr[0], hi0, lo0);
+    MulHiLo(0xCD9E8D57u, ctr[2], hi1, lo1);
+    const std::uint32_t c1 = ctr[1], c3 = ctr[3];
+    ctr[0] = hi1 ^ c1 ^ k0;
+    ctr[1] = lo1;
+    ctr[2] = hi0 ^ c3 ^ k1;
+    ctr[3] = lo0;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//! \class Stream
+//  \brief the random numbers of one stream, e.g. those of a cell in a cycle, keyed by
+//  (seed, gid, cell, cycle). Uniform(n) and Normal(n) are the n-th numbers of the stream
+//  and may be asked for in any order; Next...() draw them in sequence. A stream is
+//  cheap to construct inside a kernel:
+//
+//    pmb->par_for("Forcing", kb.s, kb.e, jb.s, jb.e, ib.s, ib.e,
+//        KOKKOS_LAMBDA(const int k, const int j, const int i) {
+//          Random::Stream rng(seed, gid, (k * nj + j) * ni + i, ncycle);
+//          v(k, j, i) += amplitude * rng.NextNormal();
+//        });
+//
+//  The block id gid changes when the mesh is refined or derefined. Streams that must not
+//  change with the mesh are keyed by the global index of the cell instead, e.g. from the
+//  logical location of the block, split over gid and cell.
+
+class Stream {
+ public:
+  KOKKOS_INLINE_FUNCTION Stream(const std::uint64_t seed, const std::uint32_t gid,
+                                const std::uint32_t cell, const std::uint32_t cycle)
+      : key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+        gid_(gid), cell_(cell), cycle_(cycle), next_(0) {}
+
+  // uniform in [0, 1) with 53 random bits; numbers 2m and 2m + 1 come from the same
+  // block of the generator
+  KOKKOS_INLINE_FUNCTION double Uniform(const std::uint32_t n) const {
+    std::uint32_t ctr[4] = {gid_, cell_, cycle_, n >> 1};
+    Philox4x32(ctr, key_);
+    const int w = 2 * (n & 1);
+    const std::uint64_t bits =
+        (static_cast<std::uint64_t>(ctr[w]) << 32 | ctr[w + 1]) >> 11;
+    return static_cast<double>(bits) * (1.0 / 9007199254740992.0); // 2^-53
+  }
+
+  // standard normal, by the Box-Muller transform of uniform numbers 2n and 2n + 1
+  KOKKOS_INLINE_FUNCTION double Normal(const std::uint32_t n) const {
+    const double u1 = 1.0 - Uniform(2 * n); // in (0, 1], so the logarithm is finite
+    const double u2 = Uniform(2 * n + 1);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+  }
+
+  KOKKOS_INLINE_FUNCTION double NextUniform() { return Uniform(next_++); }
+  // normal numbers take the place of two uniform ones in the sequence
+  KOKKOS_INLINE_FUNCTION double NextNormal() {
+    next_ = (next_ + 1) & ~1u;
+    const double r = Normal(next_ >> 1);
+    next_ += 2;
+    return r;
+  }
+
+ private:
+  std::uint32_t key_[2];
+  std::uint32_t gid_, cell_, cycle_;
+  std::uint32_t next_;
+};
+
+} // namespace Random
+
+} // namespace parthenon
+
+#endif // UTILS_RANDOM_HPP_
@@ -0,0 +1,129 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+//! \file task_timer.cpp
+//  \brief implementation of the TaskTimer class
+
+#include "utils/task_timer.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parthenon_mpi.hpp"
+
+#include "globals.hpp"
+
+namespace parthenon {
+
+TaskTimer &TaskTimer::Get() {
+  static TaskTimer timer;
+  return timer;
+}
+
+void TaskTimer::Add(const std::string &name, const double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry &entry = entries_[name.empty() ? "(unnamed)" : name];
+  entry.cycle += seconds;
+  entry.calls++;
+}
+
+void TaskTimer::EndCycle() {
+  if (!enabled_) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &e : entries_) {
+    Entry &entry = e.second;
+    entry.total += entry.cycle;
+    entry.max_cycle = std::max(entry.max_cycle, entry.cycle);
+    entry.cycle = 0.0;
+  }
+  ncycles_++;
+}
+
+//----------------------------------------------------------------------------------------
+//! \fn void TaskTimer::Report(std::ostream &os)
+//  \brief The ranks first agree on the union of their task names, then reduce the times
+//  of each task. A rank that never ran a task contributes zero time to it.
+
+void TaskTimer::Report(std::ostream &os) {
+  if (!enabled_) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::set<std::string> names;
+  for (const auto &e : entries_)
+    names.insert(e.first);
+
+#ifdef MPI_PARALLEL
+  std::string local;
+  for (const auto &name : names)
+    local += name + '\n';
+  int len = local.size();
+  std::vector<int> lens(Globals::nranks), displs(Globals::nranks, 0);
+  MPI_Allgather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, MPI_COMM_WORLD);
+  for (int n = 1; n < Globals::nranks; n++)
+    displs[n] = displs[n - 1] + lens[n - 1];
+  std::string all(displs.back() + lens.back(), '\0');
+  MPI_Allgatherv(local.data(), len, MPI_CHAR, &all[0], lens.data(), displs.data(),
+                 MPI_CHAR, MPI_COMM_WORLD);
+  std::istringstream is(all);
+  std::string name;
+  while (std::getline(is, name))
+    names.insert(name);
+#endif
+
+  const int nnames = names.size();
+  std::vector<double> tmin, tsum, tmax, cmax;
+  std::vector<long> calls;
+  for (const auto &name : names) {
+    auto it = entries_.find(name);
+    const Entry entry = (it == entries_.end()) ? Entry() : it->second;
+    tmin.push_back(entry.total);
+    tsum.push_back(entry.total);
+    tmax.push_back(entry.total);
+    cmax.push_back(entry.max_cycle);
+    calls.push_back(entry.calls);
+  }
+#ifdef MPI_PARALLEL
+  MPI_Allreduce(MPI_IN_PLACE, tmin.data(), nnames, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, tsum.data(), nnames, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, tmax.data(), nnames, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, cmax.data(), nnames, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, calls.data(), nnames, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+#endif
+  if (Globals::my_rank != 0 || nnames == 0) return;
+
+  int width = 4;
+  for (const auto &name : names)
+    width = std::max<int>(width, name.size() + 2);
+  const int ncycles = std::max(ncycles_, 1);
+  os << std::endl
+     << "Task timers over " << ncycles_ << " cycles and " << Globals::nranks
+     << " ranks, in seconds per rank" << std::endl
+     << std::left << std::setw(width) << "task" << std::right << std::setw(12) << "calls"
+     << std::setw(12) << "min" << std::setw(12) << "avg" << std::setw(12) << "max"
+     << std::setw(12) << "avg/cycle" << std::setw(12) << "max cycle" << std::endl;
+  os << std::scientific << std::setprecision(3);
+  int n = 0;
+  for (const auto &name : names) {
+    const double avg = tsum[n] / Globals::nranks;
+    os << std::left << std::setw(width) << name << std::right << std::setw(12)
+       << calls[n] << std::setw(12) << tmin[n] << std::setw(12) << avg << std::setw(12)
+       << tmax[n] << std::setw(12) << avg / ncycles << std::setw(12) << cmax[n]
+       << std::endl;
+    n++;
+  }
+  os << std::defaultfloat;
+}
+
+} // namespace parthenon
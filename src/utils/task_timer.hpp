@@ -0,0 +1,63 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef UTILS_TASK_TIMER_HPP_
+#define UTILS_TASK_TIMER_HPP_
+//! \file task_timer.hpp
+//  \brief wall-clock time spent in each named task, summarized at the end of a run
+
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace parthenon {
+
+//----------------------------------------------------------------------------------------
+//! \class TaskTimer
+//  \brief Accumulates the wall-clock time of every execution of a task under the name it
+//  was given when it was added to its TaskList. Executions that return incomplete, e.g.
+//  while waiting for messages, count as well, so the totals show where the time of a
+//  step goes. Times are kept per rank and cycle; Report() reduces them over all ranks.
+//  Enabled with <profiling>/task_timers.
+
+class TaskTimer {
+ public:
+  static TaskTimer &Get();
+
+  void Enable(const bool enable) { enabled_ = enable; }
+  bool Enabled() const { return enabled_; }
+  // adds one execution of the task name; called concurrently by the task threads
+  void Add(const std::string &name, const double seconds);
+  // closes the current cycle
+  void EndCycle();
+  // collective over all ranks: writes the min/avg/max over ranks of the time in each
+  // task on rank 0
+  void Report(std::ostream &os);
+
+ private:
+  TaskTimer() = default;
+
+  struct Entry {
+    double total = 0.0, cycle = 0.0, max_cycle = 0.0;
+    long calls = 0;
+  };
+
+  bool enabled_ = false;
+  int ncycles_ = 0;
+  std::map<std::string, Entry> entries_;
+  std::mutex mutex_;
+};
+
+} // namespace parthenon
+
+#endif // UTILS_TASK_TIMER_HPP_
@@ -20,12 +20,10 @@
 //  \brief prototypes of functions and class definitions for utils/*.cpp files
 
 #include <csignal>
-#include <cstdint>
 
 namespace parthenon {
 
 void ChangeRunDir(const char *pdir);
-double ran2(std::int64_t *idum);
 void ShowConfig();
 
 //----------------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+#=========================================================================================
+# (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+#
+# This program was produced under U.S. Government contract 89233218CNA000001 for Los
+# Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+# for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+# in the program are reserved by Triad National Security, LLC, and the U.S. Department
+# of Energy/National Nuclear Security Administration. The Government is granted for
+# itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+# license in this material to reproduce, prepare derivative works, distribute copies to
+# the public, perform publicly and display publicly, and to permit others to do so.
+#=========================================================================================
+
+from __future__ import print_function
+
+import argparse
+import numpy as np
+
+def readTabBinary(filename):
+    """ reads a file written with <output>/tab_format = binary (one file per rank)
+
+    Returns a dict with the time, cycle and variables of the output, the column names,
+    and a list of blocks, each a dict with the gid, the cell centers x1v, x2v and x3v,
+    and one array of shape (nx3, nx2, nx1) per column.
+    """
+    with open(filename, 'rb') as f:
+        header = f.readline().decode().split(':', 1)[1].split()
+        info = dict(item.split('=', 1) for item in header)
+        line = f.readline().decode()
+        columns = line.split(':', 1)[1].split() if line else []
+        data = f.read()
+
+    blocks = []
+    pos = 0
+    while pos < len(data):
+        gid, nx1, nx2, nx3 = np.frombuffer(data, dtype=np.int32, count=4, offset=pos)
+        pos += 4 * 4
+        ncells = nx1 * nx2 * nx3
+        count = nx1 + nx2 + nx3 + len(columns) * ncells
+        values = np.frombuffer(data, dtype=np.float64, count=count, offset=pos)
+        pos += 8 * count
+        block = {'gid': int(gid),
+                 'x1v': values[:nx1],
+                 'x2v': values[nx1:nx1 + nx2],
+                 'x3v': values[nx1 + nx2:nx1 + nx2 + nx3]}
+        offset = nx1 + nx2 + nx3
+        for name in columns:
+            block[name] = values[offset:offset + ncells].reshape(nx3, nx2, nx1)
+            offset += ncells
+        blocks.append(block)
+
+    return {'time': float(info['time']), 'cycle': int(info['cycle']),
+            'variables': info.get('variables', ''), 'columns': columns,
+            'blocks': blocks}
+
+def processArgs():
+    parser = argparse.ArgumentParser(description="""
+    prints a summary of binary table files, e.g. out.rank0.out1.00000.tab.bin
+    """)
+    parser.add_argument('files', nargs='+')
+    return parser.parse_args()
+
+if __name__ == "__main__":
+    for filename in processArgs().files:
+        table = readTabBinary(filename)
+        print('%s: time=%g cycle=%d, %d blocks' % (filename, table['time'],
+                                                   table['cycle'], len(table['blocks'])))
+        for name in table['columns']:
+            values = np.concatenate([b[name].ravel() for b in table['blocks']])
+            print('  %20s: min=%12.5e max=%12.5e' % (name, values.min(), values.max()))
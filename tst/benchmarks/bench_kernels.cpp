@@ -0,0 +1,138 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "kokkos_abstraction.hpp"
+#include "parthenon_arrays.hpp"
+#include "utils/buffer_utils.hpp"
+
+using parthenon::BufArray1D;
+using parthenon::DevSpace;
+using parthenon::ParArray3D;
+using parthenon::ParArrayND;
+using parthenon::Real;
+
+namespace {
+
+// edge lengths of the cubic blocks the kernels are timed on
+const std::vector<int> kBlockSizes = {16, 32, 64, 128};
+
+std::string Cube(const int n) {
+  return std::to_string(n) + "^3";
+}
+
+// A streaming kernel that reads one and writes another array, so that the loop patterns
+// are compared at the memory bandwidth they reach. Kept a free function as some device
+// compilers reject a device lambda inside the host lambda of a BENCHMARK.
+template <class T>
+void Scale(T loop_pattern, DevSpace exec_space, ParArray3D<Real> a, ParArray3D<Real> b,
+           const int n) {
+  parthenon::par_for(
+      loop_pattern, "benchmark par_for", exec_space, 0, n - 1, 0, n - 1, 0, n - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        b(k, j, i) = 2.0 * a(k, j, i) + 1.0;
+      });
+  exec_space.fence();
+}
+
+template <class T>
+void BenchmarkPattern(T loop_pattern, const std::string &name) {
+  DevSpace exec_space;
+  for (const int n : kBlockSizes) {
+    ParArray3D<Real> a("a", n, n, n), b("b", n, n, n);
+    BENCHMARK("par_for " + name + " " + Cube(n)) {
+      Scale(loop_pattern, exec_space, a, b, n);
+    };
+  }
+}
+
+// Scale with the nested TeamThreadRange and ThreadVectorRange of the TPTTRTVR pattern
+// at a given vector length, the team size chosen by Kokkos
+void ScaleVectorLength(DevSpace exec_space, ParArray3D<Real> a, ParArray3D<Real> b,
+                       const int n, const int vector_length) {
+  Kokkos::parallel_for(
+      "benchmark vector length",
+      parthenon::team_policy(exec_space, n, Kokkos::AUTO, vector_length),
+      KOKKOS_LAMBDA(parthenon::member_type team_member) {
+        const int k = team_member.league_rank();
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange<>(team_member, 0, n), [&](const int j) {
+              Kokkos::parallel_for(
+                  Kokkos::ThreadVectorRange<>(team_member, 0, n),
+                  [&](const int i) { b(k, j, i) = 2.0 * a(k, j, i) + 1.0; });
+            });
+      });
+  exec_space.fence();
+}
+
+} // namespace
+
+TEST_CASE("par_for loop patterns", "[benchmark][par_for]") {
+  BenchmarkPattern(parthenon::loop_pattern_flatrange_tag, "flatrange");
+  BenchmarkPattern(parthenon::loop_pattern_mdrange_tag, "mdrange");
+  BenchmarkPattern(parthenon::loop_pattern_tpttr_tag, "tpttr");
+  BenchmarkPattern(parthenon::loop_pattern_tpttrtvr_tag, "tpttrtvr");
+#ifndef PARTHENON_GPU_BACKEND
+  BenchmarkPattern(parthenon::loop_pattern_tptvr_tag, "tptvr");
+  BenchmarkPattern(parthenon::loop_pattern_simdfor_tag, "simdfor");
+#endif
+}
+
+// the timings PAR_VECTOR_LENGTH is chosen from, e.g. on a new GPU
+TEST_CASE("TeamPolicy vector lengths", "[benchmark][par_for]") {
+  DevSpace exec_space;
+  const int max_length = std::min(64, parthenon::team_policy::vector_length_max());
+  for (const int n : kBlockSizes) {
+    ParArray3D<Real> a("a", n, n, n), b("b", n, n, n);
+    for (int v = 1; v <= max_length; v *= 2) {
+      BENCHMARK("tpttrtvr vector_length " + std::to_string(v) + " " + Cube(n)) {
+        ScaleVectorLength(exec_space, a, b, n, v);
+      };
+    }
+  }
+}
+
+TEST_CASE("Packing of boundary buffers", "[benchmark][BufferUtility][PackData]") {
+  // the five conserved variables of hydrodynamics
+  const int nvar = 5;
+  DevSpace exec_space;
+  for (const int n : kBlockSizes) {
+    const int nc = n + 2 * NGHOST;
+    ParArrayND<Real> src("src", nvar, nc, nc, nc);
+    BufArray1D<Real> buf("buf", nvar * NGHOST * n * n);
+    // the interior cells next to the inner x1 face are strided in memory, those next to
+    // the inner x3 face are contiguous in each row
+    BENCHMARK("PackData x1 face " + Cube(n)) {
+      int offset = 0;
+      parthenon::BufferUtility::PackData(src, buf, 0, nvar - 1, NGHOST, 2 * NGHOST - 1,
+                                         NGHOST, n + NGHOST - 1, NGHOST, n + NGHOST - 1,
+                                         offset, exec_space);
+      exec_space.fence();
+      return offset;
+    };
+    BENCHMARK("PackData x3 face " + Cube(n)) {
+      int offset = 0;
+      parthenon::BufferUtility::PackData(src, buf, 0, nvar - 1, NGHOST, n + NGHOST - 1,
+                                         NGHOST, n + NGHOST - 1, NGHOST, 2 * NGHOST - 1,
+                                         offset, exec_space);
+      exec_space.fence();
+      return offset;
+    };
+  }
+}
@@ -0,0 +1,148 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "basic_types.hpp"
+#include "interface/container.hpp"
+#include "interface/metadata.hpp"
+#include "interface/properties_interface.hpp"
+#include "interface/state_descriptor.hpp"
+#include "interface/update.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/meshblock_tree.hpp"
+#include "parameter_input.hpp"
+
+using parthenon::Container;
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::MeshBlockTree;
+using parthenon::Metadata;
+using parthenon::Packages_t;
+using parthenon::ParameterInput;
+using parthenon::Properties_t;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+namespace {
+
+// The mesh always has kMeshSize^3 cells, so that the work of a benchmark is the same for
+// all block sizes and the cost of smaller blocks shows directly.
+const int kMeshSize = 64;
+const std::vector<int> kBlockSizes = {8, 16, 32, 64};
+// the five conserved variables of hydrodynamics
+const int kNumVars = 5;
+
+// a periodic 3D mesh cut into blocks of nb^3 cells, each holding one independent
+// variable in the containers "base", "dUdt" and "u1" of a two stage integrator
+std::unique_ptr<Mesh> MakeMesh(ParameterInput *pin, const int nb) {
+  for (const std::string dir : {"1", "2", "3"}) {
+    pin->SetInteger("mesh", "nx" + dir, kMeshSize);
+    pin->SetReal("mesh", "x" + dir + "min", 0.0);
+    pin->SetReal("mesh", "x" + dir + "max", 1.0);
+    pin->SetString("mesh", "ix" + dir + "_bc", "periodic");
+    pin->SetString("mesh", "ox" + dir + "_bc", "periodic");
+    pin->SetInteger("meshblock", "nx" + dir, nb);
+  }
+  pin->SetReal("time", "tlim", 1.0);
+
+  auto pkg = std::make_shared<StateDescriptor>("Benchmark");
+  Metadata m({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
+             std::vector<int>({kNumVars}));
+  pkg->AddField("u", m);
+  Packages_t packages;
+  packages["Benchmark"] = pkg;
+  Properties_t properties;
+
+  auto pmesh = std::make_unique<Mesh>(pin, properties, packages);
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    Container<Real> &base = pmb->real_containers.Get();
+    pmb->real_containers.Add("dUdt", base);
+    pmb->real_containers.Add("u1", base);
+  }
+  return pmesh;
+}
+
+std::string Blocks(const int nb) {
+  return " " + std::to_string(nb) + "^3 blocks";
+}
+
+} // namespace
+
+TEST_CASE("Update kernels of the blocks",
+          "[benchmark][FluxDivergence][UpdateContainer][AverageContainers]") {
+  for (const int nb : kBlockSizes) {
+    ParameterInput pin;
+    auto pmesh = MakeMesh(&pin, nb);
+    // the first call allocates the fluxes, which is not part of the timing
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      parthenon::Update::FluxDivergence(pmb->real_containers.Get(),
+                                        pmb->real_containers.Get("dUdt"));
+    }
+    Kokkos::fence();
+
+    // every block launches on its own execution space, hence the global fences
+    BENCHMARK("FluxDivergence" + Blocks(nb)) {
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        parthenon::Update::FluxDivergence(pmb->real_containers.Get(),
+                                          pmb->real_containers.Get("dUdt"));
+      }
+      Kokkos::fence();
+    };
+    BENCHMARK("UpdateContainer" + Blocks(nb)) {
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        parthenon::Update::UpdateContainer(pmb->real_containers.Get(),
+                                           pmb->real_containers.Get("dUdt"), 0.1,
+                                           pmb->real_containers.Get("u1"));
+      }
+      Kokkos::fence();
+    };
+    BENCHMARK("AverageContainers" + Blocks(nb)) {
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        parthenon::Update::AverageContainers(pmb->real_containers.Get("u1"),
+                                             pmb->real_containers.Get(), 0.5);
+      }
+      Kokkos::fence();
+    };
+  }
+}
+
+TEST_CASE("Neighbor search in the block tree",
+          "[benchmark][MeshBlockTree][FindNeighbor]") {
+  for (const int nb : kBlockSizes) {
+    ParameterInput pin;
+    auto pmesh = MakeMesh(&pin, nb);
+    MeshBlockTree &tree = pmesh->GetTree();
+    // the 26 neighbors of every block, as searched when the neighbor lists are rebuilt
+    BENCHMARK("FindNeighbor" + Blocks(nb)) {
+      int nfound = 0;
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        for (int ox3 = -1; ox3 <= 1; ox3++) {
+          for (int ox2 = -1; ox2 <= 1; ox2++) {
+            for (int ox1 = -1; ox1 <= 1; ox1++) {
+              if (ox1 == 0 && ox2 == 0 && ox3 == 0) continue;
+              if (tree.FindNeighbor(pmb->loc, ox1, ox2, ox3) != nullptr) nfound++;
+            }
+          }
+        }
+      }
+      return nfound;
+    };
+  }
+}
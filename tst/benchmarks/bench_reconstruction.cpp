@@ -0,0 +1,79 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
+#include "reconstruct/block_reconstruction.hpp"
+
+using parthenon::MeshBlockPack;
+using parthenon::ParArray2D;
+using parthenon::ParArray3D;
+using parthenon::Real;
+using parthenon::X1DIR;
+namespace BlockReconstruction = parthenon::BlockReconstruction;
+
+namespace {
+
+// one smooth component of n^3 cells on each of nblocks blocks, zero if not smooth
+MeshBlockPack<Real> MakePack(const int nblocks, const int n, const bool smooth) {
+  ParArray2D<ParArray3D<Real>> views("views", nblocks, 1);
+  auto views_h = Kokkos::create_mirror_view(views);
+  for (int b = 0; b < nblocks; b++) {
+    views_h(b, 0) = ParArray3D<Real>("q", n, n, n);
+    if (!smooth) continue;
+    auto q_h = Kokkos::create_mirror_view(views_h(b, 0));
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+          q_h(k, j, i) = std::sin(0.1 * i) * std::cos(0.2 * j) + 0.01 * k + b;
+    Kokkos::deep_copy(views_h(b, 0), q_h);
+  }
+  Kokkos::deep_copy(views, views_h);
+  return MeshBlockPack<Real>(views, {{n, n, n}});
+}
+
+} // namespace
+
+TEST_CASE("Block reconstruction throughput", "[benchmark][BlockReconstruction]") {
+  // four blocks of 32^3 cells with three ghost cells on either side
+  const int nblocks = 4, N = 38, is = 2, ie = N - 3;
+  auto q = MakePack(nblocks, N, true);
+  auto ql = MakePack(nblocks, N, false);
+  auto qr = MakePack(nblocks, N, false);
+
+  BENCHMARK("PLM") {
+    BlockReconstruction::Reconstruct<X1DIR, BlockReconstruction::PiecewiseLinear>(
+        q, ql, qr, is, ie, is, ie, is, ie);
+    Kokkos::fence();
+  };
+  BENCHMARK("PPM") {
+    BlockReconstruction::Reconstruct<X1DIR, BlockReconstruction::PiecewiseParabolic>(
+        q, ql, qr, is, ie, is, ie, is, ie);
+    Kokkos::fence();
+  };
+  BENCHMARK("WENO5") {
+    BlockReconstruction::Reconstruct<X1DIR, BlockReconstruction::WENO5>(
+        q, ql, qr, is, ie, is, ie, is, ie);
+    Kokkos::fence();
+  };
+  BENCHMARK("WENOZ") {
+    BlockReconstruction::Reconstruct<X1DIR, BlockReconstruction::WENOZ>(
+        q, ql, qr, is, ie, is, ie, is, ie);
+    Kokkos::fence();
+  };
+}
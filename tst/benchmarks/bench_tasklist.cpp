@@ -0,0 +1,45 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "task_list/tasks.hpp"
+
+using parthenon::SimpleTask;
+using parthenon::TaskID;
+using parthenon::TaskList;
+using parthenon::TaskListStatus;
+using parthenon::TaskStatus;
+
+TEST_CASE("Execution of a TaskList", "[benchmark][TaskList][DoAvailable]") {
+  // empty tasks, so that only the bookkeeping of the list is timed
+  auto nothing = []() { return TaskStatus::complete; };
+  // four independent chains of tasks, e.g. the stages of four variables of a block
+  const int nchains = 4;
+  for (const int ntasks : {16, 64, 256}) {
+    TaskList tl;
+    std::vector<TaskID> last(nchains, TaskID(0));
+    for (int n = 0; n < ntasks; n++) {
+      last[n % nchains] = tl.AddTask<SimpleTask>(nothing, last[n % nchains]);
+    }
+    // the first execution builds the dependency graph
+    tl.DoAvailable();
+    BENCHMARK("DoAvailable " + std::to_string(ntasks) + " tasks") {
+      tl.Restart();
+      return tl.DoAvailable() == TaskListStatus::complete;
+    };
+  }
+}
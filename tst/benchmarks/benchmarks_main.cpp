@@ -0,0 +1,44 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#define CATCH_CONFIG_RUNNER
+
+#include <catch2/catch.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include "globals.hpp"
+#include "parthenon_mpi.hpp"
+
+// Like the main of the unit tests, but the benchmarks build whole Meshes, which need MPI
+// (in MPI builds) and the rank globals. They are meant to be run on a single rank.
+int main(int argc, char *argv[]) {
+  int result;
+#ifdef MPI_PARALLEL
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &parthenon::Globals::my_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &parthenon::Globals::nranks);
+#else
+  parthenon::Globals::my_rank = 0;
+  parthenon::Globals::nranks = 1;
+#endif
+  Kokkos::initialize(argc, argv);
+
+  { result = Catch::Session().run(argc, argv); }
+
+  Kokkos::finalize();
+#ifdef MPI_PARALLEL
+  MPI_Finalize();
+#endif
+  return result;
+}
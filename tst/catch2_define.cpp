@@ -17,9 +17,22 @@
 
 #include <Kokkos_Core.hpp>
 
+#include "globals.hpp"
+#include "parthenon_mpi.hpp"
+
 int main(int argc, char *argv[]) {
   // global setup...
   int result;
+  // some tests build whole Meshes, which need MPI (in MPI builds) and the rank globals;
+  // they are meant to be run on a single rank
+#ifdef MPI_PARALLEL
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &parthenon::Globals::my_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &parthenon::Globals::nranks);
+#else
+  parthenon::Globals::my_rank = 0;
+  parthenon::Globals::nranks = 1;
+#endif
   Kokkos::initialize(argc, argv);
 
   {
@@ -29,5 +42,8 @@ int main(int argc, char *argv[]) {
   }
 
   Kokkos::finalize();
+#ifdef MPI_PARALLEL
+  MPI_Finalize();
+#endif
   return result;
 }
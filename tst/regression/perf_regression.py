@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+#=========================================================================================
+# (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+#
+# This program was produced under U.S. Government contract 89233218CNA000001 for Los
+# Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+# for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+# in the program are reserved by Triad National Security, LLC, and the U.S. Department
+# of Energy/National Nuclear Security Administration. The Government is granted for
+# itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+# license in this material to reproduce, prepare derivative works, distribute copies to
+# the public, perform publicly and display publicly, and to permit others to do so.
+#=========================================================================================
+
+""" Runs an example at a fixed size and compares its throughput, phase and task timings
+against a stored baseline of the same machine.
+
+The run reads the scaling report (<profiling>/scaling_report) and the task timers
+(<profiling>/task_timers) from the output of the example. Of several repeats, the best
+value of each metric is kept, which filters out most of the noise of a shared machine.
+The test fails if the zone-cycles per wall second drop by more than the tolerance, or if
+a phase or task takes longer than the tolerance allows plus a floor in seconds, which
+keeps short timings from failing on noise. Without a baseline for the machine the test
+is skipped (exit code 77); --update records the measurement as the new baseline.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import re
+import shlex
+import socket
+import subprocess
+import sys
+
+SKIP_RETURN_CODE = 77
+
+def parseReport(text):
+    """ returns the metrics of one run from its standard output """
+    metrics = {'phases': {}, 'tasks': {}}
+    match = re.search(r'^zone-cycles/wall_second = (\S+)$', text, re.M)
+    if match is None:
+        raise RuntimeError('no scaling report in the output, is '
+                           '<profiling>/scaling_report set?')
+    metrics['zone-cycles/wall_second'] = float(match.group(1))
+    if metrics['zone-cycles/wall_second'] <= 0.0:
+        raise RuntimeError('the run reports no zone-cycles, does the example evolve '
+                           'the mesh with a driver?')
+
+    section = None
+    for line in text.splitlines():
+        if line.startswith('phase ') and line.split()[-2:] == ['%', 'wall']:
+            section = 'phases'
+        elif line.startswith('task ') and 'avg/cycle' in line:
+            section = 'tasks'
+        elif not line.strip():
+            section = None
+        elif section == 'phases' and len(line.split()) == 5:
+            # name min avg max %wall
+            name, _, avg, _, _ = line.split()
+            metrics['phases'][name] = float(avg)
+        elif section == 'tasks' and len(line.rsplit(None, 6)) == 7:
+            # name calls min avg max avg/cycle max-cycle; names may hold spaces
+            fields = line.rsplit(None, 6)
+            metrics['tasks'][fields[0].strip()] = float(fields[3])
+        else:
+            section = None
+    return metrics
+
+def runOnce(args, overrides):
+    command = shlex.split(args.mpiexec) if args.mpiexec else []
+    command += [args.exe, '-i', os.path.abspath(args.input)] + overrides
+    result = subprocess.run(command, cwd=args.workdir, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        print(result.stdout)
+        raise RuntimeError('%s exited with %d' % (' '.join(command), result.returncode))
+    return parseReport(result.stdout)
+
+def best(runs):
+    """ the highest throughput and the shortest timings over the runs """
+    merged = {'zone-cycles/wall_second':
+              max(r['zone-cycles/wall_second'] for r in runs)}
+    for kind in ('phases', 'tasks'):
+        names = set().union(*(r[kind] for r in runs))
+        merged[kind] = {n: min(r[kind].get(n, float('inf')) for r in runs)
+                        for n in names}
+    return merged
+
+def compare(baseline, measured, tolerance, floor):
+    """ prints the comparison and returns the number of regressions """
+    failures = 0
+    row = '%-40s %12s %12s %8s  %s'
+    print(row % ('metric', 'baseline', 'measured', 'ratio', ''))
+
+    base_zcs = baseline['zone-cycles/wall_second']
+    zcs = measured['zone-cycles/wall_second']
+    slow = zcs < (1.0 - tolerance) * base_zcs
+    failures += slow
+    ratio = '%.3f' % (zcs / base_zcs) if base_zcs > 0.0 else '-'
+    print(row % ('zone-cycles/wall_second', '%.4e' % base_zcs, '%.4e' % zcs, ratio,
+                 'SLOWER' if slow else ''))
+
+    for kind in ('phases', 'tasks'):
+        for name in sorted(baseline.get(kind, {})):
+            base = baseline[kind][name]
+            if name not in measured[kind]:
+                print(row % (kind[:-1] + ' ' + name, '%.3e' % base, '-', '-', 'MISSING'))
+                continue
+            value = measured[kind][name]
+            slow = value > (1.0 + tolerance) * base + floor
+            failures += slow
+            ratio = '%.3f' % (value / base) if base > 0.0 else '-'
+            print(row % (kind[:-1] + ' ' + name, '%.3e' % base, '%.3e' % value, ratio,
+                         'SLOWER' if slow else ''))
+    return failures
+
+def processArgs():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('--name', required=True, help='name of the test in the baselines')
+    parser.add_argument('--exe', required=True, help='the example executable')
+    parser.add_argument('--input', required=True, help='the input deck of the test')
+    parser.add_argument('--baselines', required=True, help='JSON file of the baselines')
+    parser.add_argument('--machine', default='',
+                        help='key of the machine in the baselines (default: host name)')
+    parser.add_argument('--tolerance', type=float, default=0.1,
+                        help='allowed relative slowdown (default: 0.1)')
+    parser.add_argument('--floor', type=float, default=0.05,
+                        help='allowed absolute slowdown of timings in s (default: 0.05)')
+    parser.add_argument('--repeats', type=int, default=3,
+                        help='number of runs, of which the best is kept (default: 3)')
+    parser.add_argument('--mpiexec', default='',
+                        help='MPI launcher with its arguments, e.g. "mpiexec -n 4"')
+    parser.add_argument('--workdir', default='.', help='directory to run in')
+    parser.add_argument('--update', action='store_true',
+                        help='record the measurement as the baseline of the machine')
+    parser.add_argument('overrides', nargs='*', help='input overrides, e.g. time/nlim=50')
+    return parser.parse_args()
+
+if __name__ == "__main__":
+    args = processArgs()
+    machine = args.machine or socket.gethostname()
+    if not os.path.isdir(args.workdir):
+        os.makedirs(args.workdir)
+
+    baselines = {}
+    if os.path.exists(args.baselines):
+        with open(args.baselines) as f:
+            baselines = json.load(f)
+    baseline = baselines.get(machine, {}).get(args.name)
+    if baseline is None and not args.update:
+        print('No baseline of %s for machine %s in %s; record one with '
+              '"make update_perf_baselines"' % (args.name, machine, args.baselines))
+        sys.exit(SKIP_RETURN_CODE)
+
+    measured = best([runOnce(args, args.overrides) for _ in range(args.repeats)])
+
+    if args.update:
+        baselines.setdefault(machine, {})[args.name] = measured
+        with open(args.baselines, 'w') as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('Recorded the baseline of %s for machine %s' % (args.name, machine))
+        sys.exit(0)
+
+    print('%s on %s, tolerance %g, floor %g s, best of %d runs' %
+          (args.name, machine, args.tolerance, args.floor, args.repeats))
+    failures = compare(baseline, measured, args.tolerance, args.floor)
+    if failures:
+        print('%d metrics regressed' % failures)
+        sys.exit(1)
@@ -19,17 +19,21 @@
 
 #include <iostream>
 #include <random>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include <catch2/catch.hpp>
 
 #include "kokkos_abstraction.hpp"
+#include "parameter_input.hpp"
 
 using parthenon::DevSpace;
 using parthenon::ParArray1D;
 using parthenon::ParArray2D;
 using parthenon::ParArray3D;
 using parthenon::ParArray4D;
+using parthenon::ParArray5D;
 using Real = double;
 
 template <class T>
@@ -204,6 +208,51 @@ bool test_wrapper_4d(T loop_pattern, DevSpace exec_space) {
   return all_same;
 }
 
+template <class T>
+bool test_wrapper_5d(T loop_pattern, DevSpace exec_space) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_real_distribution<Real> dis(-1.0, 1.0);
+
+  const int N = 16;
+  ParArray5D<Real> arr_dev("device", N, N, N, N, N);
+  auto arr_host_orig = Kokkos::create_mirror(arr_dev);
+  auto arr_host_mod = Kokkos::create_mirror(arr_dev);
+
+  for (int b = 0; b < N; b++)
+    for (int n = 0; n < N; n++)
+      for (int k = 0; k < N; k++)
+        for (int j = 0; j < N; j++)
+          for (int i = 0; i < N; i++)
+            arr_host_orig(b, n, k, j, i) = dis(gen);
+
+  Kokkos::deep_copy(arr_dev, arr_host_orig);
+
+  parthenon::par_for(
+      loop_pattern, "unit test 5D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1, 0, N - 1,
+      0, N - 1,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        arr_dev(b, n, k, j, i) +=
+            static_cast<Real>(i + N * (j + N * (k + N * (n + N * b))));
+      });
+
+  Kokkos::deep_copy(arr_host_mod, arr_dev);
+
+  bool all_same = true;
+  for (int b = 0; b < N; b++)
+    for (int n = 0; n < N; n++)
+      for (int k = 0; k < N; k++)
+        for (int j = 0; j < N; j++)
+          for (int i = 0; i < N; i++)
+            if (arr_host_orig(b, n, k, j, i) +
+                    static_cast<Real>(i + N * (j + N * (k + N * (n + N * b)))) !=
+                arr_host_mod(b, n, k, j, i)) {
+              all_same = false;
+            }
+
+  return all_same;
+}
+
 TEST_CASE("par_for loops", "[wrapper]") {
   auto default_exec_space = DevSpace();
 
@@ -230,7 +279,7 @@ TEST_CASE("par_for loops", "[wrapper]") {
     REQUIRE(test_wrapper_3d(parthenon::loop_pattern_tpttr_tag, default_exec_space) ==
             true);
 
-#ifndef KOKKOS_ENABLE_CUDA
+#ifndef PARTHENON_GPU_BACKEND
     REQUIRE(test_wrapper_3d(parthenon::loop_pattern_tptvr_tag, default_exec_space) ==
             true);
 
@@ -252,7 +301,7 @@ TEST_CASE("par_for loops", "[wrapper]") {
     REQUIRE(test_wrapper_4d(parthenon::loop_pattern_tpttr_tag, default_exec_space) ==
             true);
 
-#ifndef KOKKOS_ENABLE_CUDA
+#ifndef PARTHENON_GPU_BACKEND
     REQUIRE(test_wrapper_4d(parthenon::loop_pattern_tptvr_tag, default_exec_space) ==
             true);
 
@@ -260,6 +309,288 @@ TEST_CASE("par_for loops", "[wrapper]") {
             true);
 #endif
   }
+
+  SECTION("5D loops") {
+    REQUIRE(test_wrapper_5d(parthenon::loop_pattern_flatrange_tag, default_exec_space) ==
+            true);
+
+    REQUIRE(test_wrapper_5d(parthenon::loop_pattern_mdrange_tag, default_exec_space) ==
+            true);
+
+    REQUIRE(test_wrapper_5d(parthenon::loop_pattern_tpttrtvr_tag, default_exec_space) ==
+            true);
+
+    REQUIRE(test_wrapper_5d(parthenon::loop_pattern_tpttr_tag, default_exec_space) ==
+            true);
+
+#ifndef PARTHENON_GPU_BACKEND
+    REQUIRE(test_wrapper_5d(parthenon::loop_pattern_tptvr_tag, default_exec_space) ==
+            true);
+
+    REQUIRE(test_wrapper_5d(parthenon::loop_pattern_simdfor_tag, default_exec_space) ==
+            true);
+#endif
+  }
+}
+
+// the reductions sum and maximize the linear cell index, which are exact in double
+template <class T>
+bool test_reduce_1d(T loop_pattern, DevSpace exec_space) {
+  const int N = 32;
+  Real sum = 0.0, max = 0.0;
+  parthenon::par_reduce(
+      loop_pattern, "unit test reduce 1D", exec_space, 0, N - 1,
+      KOKKOS_LAMBDA(const int i, Real &lsum) { lsum += static_cast<Real>(i); },
+      Kokkos::Sum<Real>(sum));
+  parthenon::par_reduce(
+      loop_pattern, "unit test max 1D", exec_space, 0, N - 1,
+      KOKKOS_LAMBDA(const int i, Real &lmax) {
+        lmax = (static_cast<Real>(i) > lmax ? static_cast<Real>(i) : lmax);
+      },
+      Kokkos::Max<Real>(max));
+  return sum == N * (N - 1) / 2 && max == N - 1;
+}
+
+template <class T>
+bool test_reduce_2d(T loop_pattern, DevSpace exec_space) {
+  const int N = 32;
+  const Real ncells = N * N;
+  Real sum = 0.0, max = 0.0;
+  parthenon::par_reduce(
+      loop_pattern, "unit test reduce 2D", exec_space, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int j, const int i, Real &lsum) {
+        lsum += static_cast<Real>(i + N * j);
+      },
+      Kokkos::Sum<Real>(sum));
+  parthenon::par_reduce(
+      loop_pattern, "unit test max 2D", exec_space, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int j, const int i, Real &lmax) {
+        const Real v = static_cast<Real>(i + N * j);
+        lmax = (v > lmax ? v : lmax);
+      },
+      Kokkos::Max<Real>(max));
+  return sum == ncells * (ncells - 1) / 2 && max == ncells - 1;
+}
+
+template <class T>
+bool test_reduce_3d(T loop_pattern, DevSpace exec_space) {
+  const int N = 32;
+  const Real ncells = N * N * N;
+  Real sum = 0.0, max = 0.0;
+  parthenon::par_reduce(
+      loop_pattern, "unit test reduce 3D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lsum) {
+        lsum += static_cast<Real>(i + N * (j + N * k));
+      },
+      Kokkos::Sum<Real>(sum));
+  parthenon::par_reduce(
+      loop_pattern, "unit test max 3D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lmax) {
+        const Real v = static_cast<Real>(i + N * (j + N * k));
+        lmax = (v > lmax ? v : lmax);
+      },
+      Kokkos::Max<Real>(max));
+  return sum == ncells * (ncells - 1) / 2 && max == ncells - 1;
+}
+
+template <class T>
+bool test_reduce_4d(T loop_pattern, DevSpace exec_space) {
+  const int N = 16;
+  const Real ncells = N * N * N * N;
+  Real sum = 0.0, max = 0.0;
+  parthenon::par_reduce(
+      loop_pattern, "unit test reduce 4D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1, 0,
+      N - 1,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i, Real &lsum) {
+        lsum += static_cast<Real>(i + N * (j + N * (k + N * n)));
+      },
+      Kokkos::Sum<Real>(sum));
+  parthenon::par_reduce(
+      loop_pattern, "unit test max 4D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1, 0,
+      N - 1,
+      KOKKOS_LAMBDA(const int n, const int k, const int j, const int i, Real &lmax) {
+        const Real v = static_cast<Real>(i + N * (j + N * (k + N * n)));
+        lmax = (v > lmax ? v : lmax);
+      },
+      Kokkos::Max<Real>(max));
+  return sum == ncells * (ncells - 1) / 2 && max == ncells - 1;
+}
+
+template <class T>
+bool test_reduce_5d(T loop_pattern, DevSpace exec_space) {
+  const int N = 8;
+  const Real ncells = N * N * N * N * N;
+  Real sum = 0.0, max = 0.0;
+  parthenon::par_reduce(
+      loop_pattern, "unit test reduce 5D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1, 0,
+      N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i,
+                    Real &lsum) {
+        lsum += static_cast<Real>(i + N * (j + N * (k + N * (n + N * b))));
+      },
+      Kokkos::Sum<Real>(sum));
+  parthenon::par_reduce(
+      loop_pattern, "unit test max 5D", exec_space, 0, N - 1, 0, N - 1, 0, N - 1, 0,
+      N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i,
+                    Real &lmax) {
+        const Real v = static_cast<Real>(i + N * (j + N * (k + N * (n + N * b))));
+        lmax = (v > lmax ? v : lmax);
+      },
+      Kokkos::Max<Real>(max));
+  return sum == ncells * (ncells - 1) / 2 && max == ncells - 1;
+}
+
+TEST_CASE("par_reduce loops", "[wrapper]") {
+  auto default_exec_space = DevSpace();
+
+  SECTION("1D and 2D reductions") {
+    REQUIRE(test_reduce_1d(parthenon::loop_pattern_mdrange_tag, default_exec_space));
+    REQUIRE(test_reduce_2d(parthenon::loop_pattern_mdrange_tag, default_exec_space));
+  }
+
+  SECTION("3D reductions") {
+    REQUIRE(test_reduce_3d(parthenon::loop_pattern_flatrange_tag, default_exec_space));
+    REQUIRE(test_reduce_3d(parthenon::loop_pattern_mdrange_tag, default_exec_space));
+    REQUIRE(test_reduce_3d(parthenon::loop_pattern_tpttrtvr_tag, default_exec_space));
+    REQUIRE(test_reduce_3d(parthenon::loop_pattern_tpttr_tag, default_exec_space));
+#ifndef PARTHENON_GPU_BACKEND
+    REQUIRE(test_reduce_3d(parthenon::loop_pattern_tptvr_tag, default_exec_space));
+    REQUIRE(test_reduce_3d(parthenon::loop_pattern_simdfor_tag, default_exec_space));
+#endif
+  }
+
+  SECTION("4D reductions") {
+    REQUIRE(test_reduce_4d(parthenon::loop_pattern_flatrange_tag, default_exec_space));
+    REQUIRE(test_reduce_4d(parthenon::loop_pattern_mdrange_tag, default_exec_space));
+    REQUIRE(test_reduce_4d(parthenon::loop_pattern_tpttrtvr_tag, default_exec_space));
+    REQUIRE(test_reduce_4d(parthenon::loop_pattern_tpttr_tag, default_exec_space));
+#ifndef PARTHENON_GPU_BACKEND
+    REQUIRE(test_reduce_4d(parthenon::loop_pattern_tptvr_tag, default_exec_space));
+    REQUIRE(test_reduce_4d(parthenon::loop_pattern_simdfor_tag, default_exec_space));
+#endif
+  }
+
+  SECTION("5D reductions") {
+    REQUIRE(test_reduce_5d(parthenon::loop_pattern_flatrange_tag, default_exec_space));
+    REQUIRE(test_reduce_5d(parthenon::loop_pattern_mdrange_tag, default_exec_space));
+    REQUIRE(test_reduce_5d(parthenon::loop_pattern_tpttrtvr_tag, default_exec_space));
+    REQUIRE(test_reduce_5d(parthenon::loop_pattern_tpttr_tag, default_exec_space));
+#ifndef PARTHENON_GPU_BACKEND
+    REQUIRE(test_reduce_5d(parthenon::loop_pattern_tptvr_tag, default_exec_space));
+    REQUIRE(test_reduce_5d(parthenon::loop_pattern_simdfor_tag, default_exec_space));
+#endif
+  }
+}
+
+TEST_CASE("par_scan loops", "[wrapper]") {
+  const int N = 16;
+  ParArray3D<int> offsets("offsets", N, N, N);
+  // exclusive prefix sum of one per cell, which is the linear index of the cell
+  parthenon::par_scan<int>(
+      "unit test scan 3D", DevSpace(), 0, N - 1, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i, int &partial,
+                    const bool final) {
+        if (final) offsets(k, j, i) = partial;
+        partial += 1;
+      });
+  auto offsets_h = Kokkos::create_mirror_view(offsets);
+  Kokkos::deep_copy(offsets_h, offsets);
+
+  bool all_same = true;
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 0; i < N; i++)
+        if (offsets_h(k, j, i) != i + N * (j + N * k)) all_same = false;
+  REQUIRE(all_same);
+}
+
+TEST_CASE("par_for_outer loops", "[wrapper]") {
+  const int N = 16;
+  ParArray3D<Real> arr_in("arr_in", N, N, N);
+  ParArray3D<Real> arr_out("arr_out", N, N, N);
+  auto arr_in_h = Kokkos::create_mirror_view(arr_in);
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<Real> distribution(0., 1.);
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 0; i < N; i++)
+        arr_in_h(k, j, i) = distribution(generator);
+  Kokkos::deep_copy(arr_in, arr_in_h);
+
+  // stage each pencil in scratch memory and use it for a three-point stencil
+  const size_t scratch_size = parthenon::ScratchPad1D<Real>::shmem_size(N);
+  parthenon::par_for_outer(
+      "unit test outer 2D", DevSpace(), scratch_size, 0, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(parthenon::member_type team_member, const int k, const int j) {
+        parthenon::ScratchPad1D<Real> pencil(team_member.team_scratch(0), N);
+        parthenon::par_for_inner(team_member, 0, N - 1,
+                                 [&](const int i) { pencil(i) = arr_in(k, j, i); });
+        team_member.team_barrier();
+        parthenon::par_for_inner(team_member, 1, N - 2, [&](const int i) {
+          arr_out(k, j, i) = pencil(i - 1) + pencil(i) + pencil(i + 1);
+        });
+      });
+  auto arr_out_h = Kokkos::create_mirror_view(arr_out);
+  Kokkos::deep_copy(arr_out_h, arr_out);
+
+  bool all_same = true;
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 1; i < N - 1; i++)
+        if (arr_out_h(k, j, i) !=
+            arr_in_h(k, j, i - 1) + arr_in_h(k, j, i) + arr_in_h(k, j, i + 1))
+          all_same = false;
+  REQUIRE(all_same);
+}
+
+bool test_runtime_pattern(const std::string &name) {
+  const int N = 16;
+  ParArray3D<Real> arr("arr", N, N, N);
+  parthenon::par_for(
+      parthenon::loop_pattern_runtime_tag, name, DevSpace(), 0, N - 1, 0, N - 1, 0, N - 1,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) {
+        arr(k, j, i) = i + N * (j + N * k);
+      });
+  auto arr_h = Kokkos::create_mirror_view(arr);
+  Kokkos::deep_copy(arr_h, arr);
+
+  bool all_same = true;
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 0; i < N; i++)
+        if (arr_h(k, j, i) != i + N * (j + N * k)) all_same = false;
+  return all_same;
+}
+
+TEST_CASE("par_for with the loop pattern chosen at runtime", "[wrapper]") {
+  using parthenon::LoopPattern;
+  using parthenon::LoopPatternTuner;
+  auto &tuner = LoopPatternTuner::Get();
+
+  SECTION("fixed pattern") {
+    tuner.Set("unit test runtime fixed", LoopPattern::mdrange);
+    REQUIRE(test_runtime_pattern("unit test runtime fixed"));
+    bool timed;
+    REQUIRE(tuner.Choose("unit test runtime fixed", timed) == LoopPattern::mdrange);
+    REQUIRE(!timed);
+  }
+
+  SECTION("autotuned pattern") {
+    parthenon::ParameterInput pin;
+    std::istringstream is("<loop_pattern>\nautotune = true\nautotune_trials = 2\n");
+    pin.LoadFromStream(is);
+    tuner.Initialize(&pin);
+    // one warmup and two timed launches of every available pattern
+    const int nlaunches = 3 * LoopPatternTuner::Available().size();
+    bool all_same = true;
+    for (int n = 0; n < nlaunches; n++)
+      all_same = test_runtime_pattern("unit test runtime tuned") && all_same;
+    REQUIRE(all_same);
+    bool timed;
+    tuner.Choose("unit test runtime tuned", timed);
+    REQUIRE(!timed);
+  }
 }
 
 struct LargeNShortTBufferPack {
@@ -0,0 +1,103 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+#ifndef TST_UNIT_MESH_FIXTURE_HPP_
+#define TST_UNIT_MESH_FIXTURE_HPP_
+//! \file mesh_fixture.hpp
+//  \brief small Meshes for the unit tests that need whole blocks and their neighbors
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic_types.hpp"
+#include "interface/container.hpp"
+#include "interface/metadata.hpp"
+#include "interface/properties_interface.hpp"
+#include "interface/state_descriptor.hpp"
+#include "mesh/mesh.hpp"
+#include "parameter_input.hpp"
+
+namespace mesh_fixture {
+
+using parthenon::Container;
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::Metadata;
+using parthenon::Packages_t;
+using parthenon::ParameterInput;
+using parthenon::Properties_t;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+// a mesh of nx cells per side on the unit square (ndim = 2) or cube (ndim = 3), cut into
+// blocks of nb cells per side, with the boundary condition bc on all faces
+inline void SetMeshParameters(ParameterInput *pin, const int ndim, const int nx,
+                              const int nb, const std::string &bc = "periodic") {
+  for (int d = 1; d <= 3; d++) {
+    const std::string dir = std::to_string(d);
+    pin->SetReal("mesh", "x" + dir + "min", 0.0);
+    pin->SetReal("mesh", "x" + dir + "max", 1.0);
+    if (d <= ndim) {
+      pin->SetInteger("mesh", "nx" + dir, nx);
+      pin->SetInteger("meshblock", "nx" + dir, nb);
+      pin->SetString("mesh", "ix" + dir + "_bc", bc);
+      pin->SetString("mesh", "ox" + dir + "_bc", bc);
+    } else {
+      pin->SetInteger("mesh", "nx" + dir, 1);
+      pin->SetInteger("meshblock", "nx" + dir, 1);
+    }
+  }
+  pin->SetReal("time", "tlim", 1.0);
+}
+
+// one package with the independent cell variable name of nvar components, which is
+// exchanged with the neighbors
+inline Packages_t Packages(const std::string &name = "q", const int nvar = 1) {
+  auto pkg = std::make_shared<StateDescriptor>("Test");
+  Metadata m({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
+             std::vector<int>({nvar}));
+  pkg->AddField(name, m);
+  Packages_t packages;
+  packages["Test"] = pkg;
+  return packages;
+}
+
+// builds the mesh and sets it up as the driver would, which includes a first exchange
+// of the (zero) initial data
+inline std::unique_ptr<Mesh> MakeMesh(ParameterInput *pin, Packages_t &packages) {
+  Properties_t properties;
+  auto pmesh = std::make_unique<Mesh>(pin, properties, packages);
+  pmesh->Initialize(0, pin);
+  return pmesh;
+}
+
+// one boundary exchange of the base containers of all blocks, done on this thread
+inline void Exchange(Mesh *pmesh) {
+  using parthenon::BoundaryCommSubset;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    pmb->real_containers.Get().StartReceiving(BoundaryCommSubset::all);
+  }
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    pmb->real_containers.Get().SendBoundaryBuffers();
+  }
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    pmb->real_containers.Get().ReceiveAndSetBoundariesWithWait();
+  }
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    pmb->real_containers.Get().ClearBoundary(BoundaryCommSubset::all);
+  }
+}
+
+} // namespace mesh_fixture
+
+#endif // TST_UNIT_MESH_FIXTURE_HPP_
@@ -0,0 +1,63 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "interface/container.hpp"
+#include "interface/container_collection.hpp"
+#include "interface/metadata.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/array_pool.hpp"
+
+using parthenon::ArrayPool;
+using parthenon::ContainerCollection;
+using parthenon::Metadata;
+using parthenon::Real;
+
+TEST_CASE("Stage containers recycle their arrays", "[ArrayPool]") {
+  auto &pool = ArrayPool<Real>::Instance();
+  pool.Enable(false, true);
+  GIVEN("A collection whose base container has two variables") {
+    ContainerCollection<Real> collection;
+    auto &base = collection.Get();
+    base.Add("a", Metadata({Metadata::Independent}), std::vector<int>{8, 8, 8});
+    base.Add("b", Metadata({Metadata::OneCopy}), std::vector<int>{8, 8, 8});
+    const std::size_t bytes = 8 * 8 * 8 * sizeof(Real);
+
+    WHEN("a stage container is added and purged again") {
+      const std::size_t reused = pool.NumReused();
+      collection.Add("stage", base);
+      REQUIRE(pool.NumReused() == reused);
+      Kokkos::deep_copy(collection.Get("stage").Get("a").data.Get(), 1.0);
+      collection.PurgeNonBase();
+      THEN("the pool holds the array of the stage copy only") {
+        REQUIRE(pool.HeldBytes() == bytes);
+      }
+      THEN("the next stage container gets the array back, zeroed") {
+        collection.Add("stage", base);
+        REQUIRE(pool.NumReused() == reused + 1);
+        REQUIRE(pool.HeldBytes() == 0);
+        auto &data = collection.Get("stage").Get("a").data;
+        auto data_h = data.GetHostMirror();
+        data_h.DeepCopy(data);
+        REQUIRE(data_h(0, 0, 0) == 0.0);
+      }
+    }
+  }
+  // the pooled arrays have to go before Kokkos is finalized
+  pool.Enable(false, false);
+  REQUIRE(pool.HeldBytes() == 0);
+}
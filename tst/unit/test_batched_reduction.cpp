@@ -0,0 +1,64 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include "utils/batched_reduction.hpp"
+
+using parthenon::BatchedReduction;
+using parthenon::Real;
+using parthenon::ReductionOp;
+
+TEST_CASE("BatchedReduction on a single rank", "[BatchedReduction]") {
+  GIVEN("A batch of scalars with different operations") {
+    BatchedReduction reduction;
+    const int isum = reduction.Add(1.5, ReductionOp::sum);
+    const int imax = reduction.Add(-2.0, ReductionOp::max);
+    const int imin = reduction.Add(3.0, ReductionOp::min);
+    REQUIRE(isum == 0);
+    REQUIRE(imax == 1);
+    REQUIRE(imin == 2);
+    REQUIRE(reduction.Size() == 3);
+
+    WHEN("results are read before the reduction completed") {
+      THEN("Get throws") { REQUIRE_THROWS_AS(reduction.Get(isum), std::out_of_range); }
+    }
+
+    WHEN("the reduction is started") {
+      reduction.Start();
+      REQUIRE(reduction.InFlight());
+      THEN("nothing can be added until it completes") {
+        REQUIRE_THROWS_AS(reduction.Add(1.0, ReductionOp::sum), std::runtime_error);
+      }
+      reduction.Wait();
+      THEN("every entry holds the value of the only rank") {
+        REQUIRE(!reduction.InFlight());
+        REQUIRE(reduction.Get(isum) == 1.5);
+        REQUIRE(reduction.Get(imax) == -2.0);
+        REQUIRE(reduction.Get(imin) == 3.0);
+        REQUIRE_THROWS_AS(reduction.Get(3), std::out_of_range);
+      }
+      THEN("the next Add begins a new batch and keeps the results until it completes") {
+        REQUIRE(reduction.Add(4.0, ReductionOp::sum) == 0);
+        REQUIRE(reduction.Size() == 1);
+        REQUIRE(reduction.Get(imin) == 3.0);
+        reduction.Start();
+        reduction.Wait();
+        REQUIRE(reduction.Get(0) == 4.0);
+        REQUIRE_THROWS_AS(reduction.Get(1), std::out_of_range);
+      }
+    }
+  }
+}
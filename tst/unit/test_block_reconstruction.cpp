@@ -0,0 +1,152 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+#include <functional>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
+#include "reconstruct/block_reconstruction.hpp"
+
+using parthenon::MeshBlockPack;
+using parthenon::ParArray2D;
+using parthenon::ParArray3D;
+using parthenon::Real;
+using parthenon::X1DIR;
+using parthenon::X2DIR;
+namespace BlockReconstruction = parthenon::BlockReconstruction;
+
+namespace {
+
+constexpr Real kPi = 3.14159265358979323846;
+
+// one component of shape (nk, nj, ni) on each block, set to f(b, k, j, i) if given
+MeshBlockPack<Real> MakePack(const int nblocks, const int nk, const int nj, const int ni,
+                             const std::function<Real(int, int, int, int)> &f = {}) {
+  ParArray2D<ParArray3D<Real>> views("views", nblocks, 1);
+  auto views_h = Kokkos::create_mirror_view(views);
+  for (int b = 0; b < nblocks; b++) {
+    views_h(b, 0) = ParArray3D<Real>("q", nk, nj, ni);
+    if (!f) continue;
+    auto q_h = Kokkos::create_mirror_view(views_h(b, 0));
+    for (int k = 0; k < nk; k++)
+      for (int j = 0; j < nj; j++)
+        for (int i = 0; i < ni; i++)
+          q_h(k, j, i) = f(b, k, j, i);
+    Kokkos::deep_copy(views_h(b, 0), q_h);
+  }
+  Kokkos::deep_copy(views, views_h);
+  return MeshBlockPack<Real>(views, {{ni, nj, nk}});
+}
+
+// largest deviation of both face states from the exact face values of data linear in
+// x2, on the faces lo, ..., hi in x2
+template <typename Limiter>
+Real MaxLinearFaceError(const int nblocks, const int N, const int lo, const int hi) {
+  auto q = MakePack(nblocks, N, N, N, [](int b, int k, int j, int i) {
+    return 1.0 + b + 0.5 * j; // different on every block
+  });
+  auto ql = MakePack(nblocks, N, N, N);
+  auto qr = MakePack(nblocks, N, N, N);
+  BlockReconstruction::Reconstruct<X2DIR, Limiter>(q, ql, qr, 2, N - 3, lo - 1, hi, 2,
+                                                    N - 3);
+  Real err = 0.0;
+  Kokkos::parallel_reduce(
+      "face error",
+      Kokkos::MDRangePolicy<Kokkos::Rank<4>>(parthenon::DevSpace(), {0, 2, lo, 2},
+                                             {nblocks, N - 2, hi + 1, N - 2}),
+      KOKKOS_LAMBDA(const int b, const int k, const int j, const int i, Real &e) {
+        const Real exact = 1.0 + b + 0.5 * (j - 0.5);
+        e = std::max(e, std::max(std::abs(ql(b, 0, k, j, i) - exact),
+                                 std::abs(qr(b, 0, k, j, i) - exact)));
+      },
+      Kokkos::Max<Real>(err));
+  return err;
+}
+
+// largest error of the face states of sin(2 pi x) on [0, 1], given as cell averages on
+// n cells plus three ghost cells on either side
+template <typename Limiter>
+Real MaxSineFaceError(const int n) {
+  const int ng = 3, ni = n + 2 * ng;
+  const Real dx = 1.0 / n;
+  auto q = MakePack(1, 1, 1, ni, [=](int b, int k, int j, int i) {
+    const Real xl = (i - ng) * dx;
+    const Real xr = xl + dx;
+    return (std::cos(2.0 * kPi * xl) - std::cos(2.0 * kPi * xr)) / (2.0 * kPi * dx);
+  });
+  auto ql = MakePack(1, 1, 1, ni);
+  auto qr = MakePack(1, 1, 1, ni);
+  BlockReconstruction::Reconstruct<X1DIR, Limiter>(q, ql, qr, ng - 1, ng + n, 0, 0, 0,
+                                                    0);
+  Real err = 0.0;
+  Kokkos::parallel_reduce(
+      "face error", Kokkos::RangePolicy<>(parthenon::DevSpace(), ng, ng + n + 1),
+      KOKKOS_LAMBDA(const int i, Real &e) {
+        const Real exact = std::sin(2.0 * kPi * (i - ng) * dx);
+        e = std::max(e, std::max(std::abs(ql(0, 0, 0, 0, i) - exact),
+                                 std::abs(qr(0, 0, 0, 0, i) - exact)));
+      },
+      Kokkos::Max<Real>(err));
+  return err;
+}
+
+} // namespace
+
+TEST_CASE("Block reconstruction is exact for linear data", "[BlockReconstruction]") {
+  GIVEN("Three blocks of data linear in x2") {
+    const int nblocks = 3, N = 10;
+    WHEN("they are reconstructed with PLM") {
+      THEN("both states on every face equal the face value") {
+        REQUIRE(MaxLinearFaceError<BlockReconstruction::PiecewiseLinear>(
+                    nblocks, N, 2, N - 3) < 1.0e-12);
+      }
+    }
+    WHEN("they are reconstructed with PPM") {
+      THEN("both states on every face equal the face value") {
+        REQUIRE(MaxLinearFaceError<BlockReconstruction::PiecewiseParabolic>(
+                    nblocks, N, 3, N - 4) < 1.0e-12);
+      }
+    }
+    WHEN("they are reconstructed with WENO5 and WENO-Z") {
+      THEN("both states on every face equal the face value") {
+        REQUIRE(MaxLinearFaceError<BlockReconstruction::WENO5>(nblocks, N, 3, N - 4) <
+                1.0e-12);
+        REQUIRE(MaxLinearFaceError<BlockReconstruction::WENOZ>(nblocks, N, 3, N - 4) <
+                1.0e-12);
+      }
+    }
+  }
+}
+
+TEST_CASE("WENO reconstruction converges at high order", "[BlockReconstruction]") {
+  GIVEN("The cell averages of a sine wave on 32 and 64 cells") {
+    WHEN("they are reconstructed with WENO-Z") {
+      const Real err32 = MaxSineFaceError<BlockReconstruction::WENOZ>(32);
+      const Real err64 = MaxSineFaceError<BlockReconstruction::WENOZ>(64);
+      THEN("doubling the resolution reduces the error by more than 2^4") {
+        REQUIRE(err32 / err64 > 16.0);
+      }
+    }
+    WHEN("they are reconstructed with WENO5") {
+      const Real err32 = MaxSineFaceError<BlockReconstruction::WENO5>(32);
+      const Real err64 = MaxSineFaceError<BlockReconstruction::WENO5>(64);
+      THEN("the error falls faster than at second order despite the extrema") {
+        REQUIRE(err32 / err64 > 6.0);
+      }
+    }
+  }
+}
@@ -0,0 +1,55 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <array>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "globals.hpp"
+#include "mesh/block_size_calibration.hpp"
+#include "parameter_input.hpp"
+
+using parthenon::ParameterInput;
+using Size = std::array<int, 3>;
+
+TEST_CASE("Candidate block sizes divide the mesh", "[BlockSizeCalibration]") {
+  // the candidates leave out sizes that give fewer blocks than ranks
+  if (parthenon::Globals::nranks > 1) return;
+
+  GIVEN("A 2D mesh of 64x32 cells with 16x16 blocks") {
+    ParameterInput pin;
+    pin.SetInteger("mesh", "nx1", 64);
+    pin.SetInteger("mesh", "nx2", 32);
+    pin.SetInteger("meshblock", "nx1", 16);
+    pin.SetInteger("meshblock", "nx2", 16);
+
+    WHEN("the default edges are tried") {
+      const std::vector<Size> sizes = parthenon::BlockSizeCalibration::Candidates(&pin);
+      THEN("the cubes are clipped to the mesh and the given size is not repeated") {
+        const std::vector<Size> expected = {
+            {{8, 8, 1}}, {{16, 16, 1}}, {{32, 32, 1}}, {{64, 32, 1}}};
+        REQUIRE(sizes == expected);
+      }
+    }
+
+    WHEN("the edges include sizes that do not fit") {
+      pin.SetString("meshblock", "calibrate_sizes", "2,24,32,");
+      const std::vector<Size> sizes = parthenon::BlockSizeCalibration::Candidates(&pin);
+      THEN("edges below 4 cells and sizes not dividing the mesh are left out") {
+        const std::vector<Size> expected = {{{32, 32, 1}}, {{16, 16, 1}}};
+        REQUIRE(sizes == expected);
+      }
+    }
+  }
+}
@@ -0,0 +1,77 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::Container;
+using parthenon::Metadata;
+using parthenon::Packages_t;
+using parthenon::ParameterInput;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+TEST_CASE("Independent variables of a block share one slab", "[Container][Slab]") {
+  GIVEN("A slab block with two independent variables and a derived one") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 8, 8);
+    pin.SetBoolean("mesh", "slab_block_data", true);
+    auto pkg = std::make_shared<StateDescriptor>("Test");
+    Metadata one({Metadata::Cell, Metadata::Independent, Metadata::FillGhost});
+    Metadata three({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
+                   std::vector<int>({3}));
+    Metadata derived({Metadata::Cell, Metadata::Derived, Metadata::OneCopy});
+    pkg->AddField("a", one);
+    pkg->AddField("b", three);
+    pkg->AddField("c", derived);
+    Packages_t packages;
+    packages["Test"] = pkg;
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    Container<Real> &rc = pmesh->pblock->real_containers.Get();
+    auto &a = rc.Get("a").data;
+    auto &b = rc.Get("b").data;
+    auto &c = rc.Get("c").data;
+    auto slab = rc.GetSlab();
+
+    THEN("the slab holds exactly the independent variables, without overlap") {
+      REQUIRE(slab.GetSize() == a.GetSize() + b.GetSize());
+      const Real *begin = slab.Get().data(), *end = begin + slab.GetSize();
+      auto inside = [&](const Real *p) { return p >= begin && p < end; };
+      REQUIRE(inside(a.Get().data()));
+      REQUIRE(inside(b.Get().data()));
+      REQUIRE_FALSE(inside(c.Get().data()));
+      const Real *pa = a.Get().data(), *pb = b.Get().data();
+      REQUIRE((pa + a.GetSize() <= pb || pb + b.GetSize() <= pa));
+    }
+
+    WHEN("the variables are written") {
+      Kokkos::deep_copy(a.Get(), 1.0);
+      Kokkos::deep_copy(b.Get(), 2.0);
+      THEN("the slab holds their values") {
+        auto slab_h = slab.GetHostMirror();
+        slab_h.DeepCopy(slab);
+        Real sum = 0.0;
+        for (int n = 0; n < slab.GetSize(); n++) {
+          sum += slab_h(n);
+        }
+        REQUIRE(sum == Approx(a.GetSize() + 2.0 * b.GetSize()));
+      }
+    }
+  }
+}
@@ -0,0 +1,211 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "bvals/boundary_conditions.hpp"
+#include "bvals/user_boundary_condition.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::BoundaryFace;
+using parthenon::BoundaryFlag;
+using parthenon::DeviceBoundaryCondition;
+using parthenon::DeviceCoordinates;
+using parthenon::InflowBoundary;
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::Metadata;
+using parthenon::Packages_t;
+using parthenon::ParArray1D;
+using parthenon::ParameterInput;
+using parthenon::Properties_t;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+namespace {
+
+// the number of ghost cells of the x1 faces of the blocks with the given flag that differ
+// from value, counting the interior rows only
+int WrongX1Ghosts(Mesh *pmesh, const BoundaryFace face, const Real value) {
+  int nwrong = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    if (pmb->boundary_flag[face] != BoundaryFlag::user) continue;
+    auto &q = pmb->real_containers.Get().Get("q").data;
+    auto q_h = q.GetHostMirror();
+    q_h.DeepCopy(q);
+    const int il = (face == BoundaryFace::inner_x1) ? 0 : pmb->ie + 1;
+    const int iu = (face == BoundaryFace::inner_x1) ? pmb->is - 1 : q.GetDim(1) - 1;
+    for (int j = pmb->js; j <= pmb->je; j++) {
+      for (int i = il; i <= iu; i++) {
+        if (q_h(0, j, i) != value) nwrong++;
+      }
+    }
+  }
+  return nwrong;
+}
+
+// zeroes the variable, ghost cells included, so that only the boundary conditions set
+// the ghost cells checked afterwards
+void Clear(Mesh *pmesh) {
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    Kokkos::deep_copy(pmb->real_containers.Get().Get("q").data.Get(), 0.0);
+  }
+}
+
+// the interior value of component l of the vector v in cell (j, i) of a block
+Real Interior(const int l, const int j, const int i) {
+  return 1.0 + l + 10 * i + 100 * j;
+}
+
+// one package with the two component vector v
+Packages_t VectorPackages() {
+  auto pkg = std::make_shared<StateDescriptor>("Test");
+  Metadata m({Metadata::Cell, Metadata::Independent, Metadata::FillGhost,
+              Metadata::Vector},
+             std::vector<int>({2}));
+  pkg->AddField("v", m);
+  Packages_t packages;
+  packages["Test"] = pkg;
+  return packages;
+}
+
+// sets the interior of v and clears its ghost cells
+void SetInterior(Mesh *pmesh) {
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &v = pmb->real_containers.Get().Get("v").data;
+    auto v_h = v.GetHostMirror();
+    for (int l = 0; l < 2; l++) {
+      for (int j = 0; j < v.GetDim(2); j++) {
+        for (int i = 0; i < v.GetDim(1); i++) {
+          const bool interior =
+              (i >= pmb->is && i <= pmb->ie && j >= pmb->js && j <= pmb->je);
+          v_h(l, 0, j, i) = interior ? Interior(l, j, i) : 0.0;
+        }
+      }
+    }
+    v.DeepCopy(v_h);
+  }
+}
+
+// the ghost cells of the x1 faces, interior rows only, that are not the mirror image of
+// the interior with a flipped normal component on a reflecting face or a copy of the
+// last interior cell on an outflow face
+int WrongPhysicalGhosts(Mesh *pmesh) {
+  int nwrong = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &v = pmb->real_containers.Get().Get("v").data;
+    auto v_h = v.GetHostMirror();
+    v_h.DeepCopy(v);
+    for (int l = 0; l < 2; l++) {
+      for (int j = pmb->js; j <= pmb->je; j++) {
+        for (int g = 0; g < pmb->is; g++) {
+          if (pmb->boundary_flag[BoundaryFace::inner_x1] == BoundaryFlag::reflect) {
+            const Real sign = (l == 0) ? -1.0 : 1.0;
+            if (v_h(l, 0, j, pmb->is - 1 - g) != sign * Interior(l, j, pmb->is + g)) {
+              nwrong++;
+            }
+          }
+          if (pmb->boundary_flag[BoundaryFace::outer_x1] == BoundaryFlag::outflow) {
+            if (v_h(l, 0, j, pmb->ie + 1 + g) != Interior(l, j, pmb->ie)) nwrong++;
+          }
+        }
+      }
+    }
+  }
+  return nwrong;
+}
+
+} // namespace
+
+TEST_CASE("Reflecting and outflow faces fill the ghost cells", "[BoundaryConditions]") {
+  GIVEN("A 2D mesh with a reflecting inner and an outflow outer x1 face") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    pin.SetString("mesh", "ix1_bc", "reflecting");
+    pin.SetString("mesh", "ox1_bc", "outflow");
+    auto packages = VectorPackages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+
+    WHEN("the boundary conditions are applied block by block") {
+      SetInterior(pmesh.get());
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        parthenon::ApplyBoundaryConditions(pmb->real_containers.Get());
+      }
+      Kokkos::fence();
+      THEN("the x1 ghost cells mirror or copy the interior") {
+        REQUIRE(WrongPhysicalGhosts(pmesh.get()) == 0);
+      }
+    }
+    WHEN("they are applied to all blocks at once, twice to reuse the cached flags") {
+      for (int n = 0; n < 2; n++) {
+        SetInterior(pmesh.get());
+        parthenon::ApplyBoundaryConditionsOnMesh(pmesh.get(), "base");
+        Kokkos::fence();
+        REQUIRE(WrongPhysicalGhosts(pmesh.get()) == 0);
+      }
+      THEN("the flags are built once for the container") {
+        REQUIRE(pmesh->bc_arrays.size() == 1);
+      }
+    }
+  }
+}
+
+TEST_CASE("User boundary conditions are enrolled as functors or objects",
+          "[BoundaryConditions]") {
+  GIVEN("A 2D mesh with user x1 faces") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8, "user");
+    pin.SetString("mesh", "ix2_bc", "outflow");
+    pin.SetString("mesh", "ox2_bc", "outflow");
+    auto packages = mesh_fixture::Packages();
+    Properties_t properties;
+    auto pmesh = std::make_unique<Mesh>(&pin, properties, packages);
+
+    WHEN("a device functor is enrolled on one face and a boundary object on the other") {
+      pmesh->EnrollBoundaryCondition(
+          BoundaryFace::inner_x1,
+          KOKKOS_LAMBDA(const DeviceCoordinates &coords, const Real time, const int n,
+                        const int k, const int j, const int i,
+                        const Real q_bnd) { return 1.0; });
+      ParArray1D<Real> inflow("inflow", 1);
+      Kokkos::deep_copy(inflow, 2.0);
+      pmesh->EnrollBoundaryCondition(
+          BoundaryFace::outer_x1,
+          std::make_shared<DeviceBoundaryCondition<InflowBoundary>>(
+              InflowBoundary(inflow)));
+      pmesh->Initialize(0, &pin);
+
+      THEN("both fill the ghost cells of their face") {
+        Clear(pmesh.get());
+        for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+          parthenon::ApplyBoundaryConditions(pmb->real_containers.Get());
+        }
+        Kokkos::fence();
+        REQUIRE(WrongX1Ghosts(pmesh.get(), BoundaryFace::inner_x1, 1.0) == 0);
+        REQUIRE(WrongX1Ghosts(pmesh.get(), BoundaryFace::outer_x1, 2.0) == 0);
+      }
+      AND_THEN("so do they for all blocks at once") {
+        Clear(pmesh.get());
+        parthenon::ApplyBoundaryConditionsOnMesh(pmesh.get(), "base");
+        Kokkos::fence();
+        REQUIRE(WrongX1Ghosts(pmesh.get(), BoundaryFace::inner_x1, 1.0) == 0);
+        REQUIRE(WrongX1Ghosts(pmesh.get(), BoundaryFace::outer_x1, 2.0) == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,77 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "mesh_fixture.hpp"
+
+using parthenon::MeshBlock;
+using parthenon::ParameterInput;
+using parthenon::Real;
+
+TEST_CASE("Blocks on the same rank fill each other's ghost zones", "[BoundaryValues]") {
+  const int nx = 16, nb = 8;
+  // the value of a cell is its index on the mesh, wrapped around the periodic boundaries
+  auto value = [nx, nb](const MeshBlock *pmb, const int i, const int j) {
+    const int gi = (static_cast<int>(pmb->loc.lx1) * nb + i - pmb->is + nx) % nx;
+    const int gj = (static_cast<int>(pmb->loc.lx2) * nb + j - pmb->js + nx) % nx;
+    return static_cast<Real>(gi + nx * gj);
+  };
+
+  for (const int ninstances : {1, 2}) {
+    GIVEN("Four blocks of a periodic 2D mesh on " + std::to_string(ninstances) +
+          " execution space instances") {
+      ParameterInput pin;
+      mesh_fixture::SetMeshParameters(&pin, 2, nx, nb);
+      pin.SetInteger("mesh", "num_exec_space_instances", ninstances);
+      auto packages = mesh_fixture::Packages();
+      auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+      REQUIRE(pmesh->nbtotal == 4);
+
+      // interior cells take their value, ghost cells a value that is never sent
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        auto &q = pmb->real_containers.Get().Get("q").data;
+        auto q_h = q.GetHostMirror();
+        for (int j = 0; j < q.GetDim(2); j++) {
+          for (int i = 0; i < q.GetDim(1); i++) {
+            const bool interior =
+                (i >= pmb->is && i <= pmb->ie && j >= pmb->js && j <= pmb->je);
+            q_h(0, j, i) = interior ? value(pmb, i, j) : -1.0;
+          }
+        }
+        q.DeepCopy(q_h);
+      }
+
+      WHEN("the blocks exchange their boundaries") {
+        mesh_fixture::Exchange(pmesh.get());
+
+        THEN("every ghost cell, corners included, holds the value of its neighbor") {
+          int nwrong = 0;
+          for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+            auto &q = pmb->real_containers.Get().Get("q").data;
+            auto q_h = q.GetHostMirror();
+            q_h.DeepCopy(q);
+            for (int j = 0; j < q.GetDim(2); j++) {
+              for (int i = 0; i < q.GetDim(1); i++) {
+                if (q_h(0, j, i) != value(pmb, i, j)) nwrong++;
+              }
+            }
+          }
+          REQUIRE(nwrong == 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,148 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "mesh_fixture.hpp"
+
+using parthenon::BoundaryCommSubset;
+using parthenon::CellVariable;
+using parthenon::MeshBlock;
+using parthenon::Metadata;
+using parthenon::Packages_t;
+using parthenon::ParameterInput;
+using parthenon::Real;
+
+TEST_CASE("Variables stored component innermost exchange and output their values",
+          "[ComponentInnermost]") {
+  const int nx = 16, nb = 8, ncomp = 5;
+  // the value of component n of a cell is its index on the mesh, wrapped around the
+  // periodic boundaries, plus 1000 n
+  auto value = [nx, nb](const MeshBlock *pmb, const int n, const int i, const int j) {
+    const int gi = (static_cast<int>(pmb->loc.lx1) * nb + i - pmb->is + nx) % nx;
+    const int gj = (static_cast<int>(pmb->loc.lx2) * nb + j - pmb->js + nx) % nx;
+    return static_cast<Real>(gi + nx * gj + 1000 * n);
+  };
+  auto interior = [](const MeshBlock *pmb, const int i, const int j) {
+    return i >= pmb->is && i <= pmb->ie && j >= pmb->js && j <= pmb->je;
+  };
+
+  GIVEN("Four blocks of a periodic 2D mesh with a derived variable of five components") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, nx, nb);
+    Packages_t packages = mesh_fixture::Packages();
+    Metadata m({Metadata::Cell, Metadata::Derived, Metadata::FillGhost,
+                Metadata::ComponentInnermost},
+               std::vector<int>({ncomp}));
+    packages["Test"]->AddField("c", m);
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    REQUIRE(pmesh->nbtotal == 4);
+
+    THEN("the components of a cell are adjacent in strided, and data is a copy") {
+      CellVariable<Real> &c = pmesh->pblock->real_containers.Get().Get("c");
+      auto s = c.strided.Get();
+      REQUIRE(c.strided.GetDim(4) == ncomp);
+      REQUIRE(c.strided.GetDim(1) == c.data.GetDim(1));
+      REQUIRE(s.stride(2) == 1);
+      REQUIRE(s.stride(5) == ncomp);
+      REQUIRE(s.stride(4) == ncomp * c.GetDim(1));
+      REQUIRE(c.data.Get().data() != s.data());
+    }
+
+    // interior cells of strided take their value, ghost cells a value that is never sent
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      auto &c = pmb->real_containers.Get().Get("c").strided;
+      auto c_h = c.GetHostMirror();
+      for (int n = 0; n < ncomp; n++) {
+        for (int j = 0; j < c.GetDim(2); j++) {
+          for (int i = 0; i < c.GetDim(1); i++) {
+            c_h(n, 0, j, i) = interior(pmb, i, j) ? value(pmb, n, i, j) : -1.0;
+          }
+        }
+      }
+      c.DeepCopy(c_h);
+    }
+
+    WHEN("the blocks exchange their boundaries and change their interior meanwhile") {
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        pmb->real_containers.Get().StartReceiving(BoundaryCommSubset::all);
+      }
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        pmb->real_containers.Get().SendBoundaryBuffers();
+      }
+      // as an interior update overlapping the communication would
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        auto c = pmb->real_containers.Get().Get("c").strided.Get<4>();
+        pmb->par_for(
+            "negate interior", 0, ncomp - 1, 0, 0, pmb->js, pmb->je, pmb->is, pmb->ie,
+            KOKKOS_LAMBDA(const int n, const int k, const int j, const int i) {
+              c(n, k, j, i) = -c(n, k, j, i);
+            });
+      }
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        pmb->real_containers.Get().ReceiveAndSetBoundariesWithWait();
+      }
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        pmb->real_containers.Get().ClearBoundary(BoundaryCommSubset::all);
+      }
+
+      THEN("the ghost cells of strided hold the sent values and the interior the new") {
+        int nwrong = 0;
+        for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+          auto &c = pmb->real_containers.Get().Get("c").strided;
+          auto c_h = c.GetHostMirror();
+          c_h.DeepCopy(c);
+          for (int n = 0; n < ncomp; n++) {
+            for (int j = 0; j < c.GetDim(2); j++) {
+              for (int i = 0; i < c.GetDim(1); i++) {
+                const Real sign = interior(pmb, i, j) ? -1.0 : 1.0;
+                if (c_h(n, 0, j, i) != sign * value(pmb, n, i, j)) nwrong++;
+              }
+            }
+          }
+        }
+        REQUIRE(nwrong == 0);
+      }
+    }
+
+    WHEN("the host copy of the variable is requested") {
+      int nwrong = 0;
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        CellVariable<Real> &c = pmb->real_containers.Get().Get("c");
+        c.MarkDeviceModified();
+        auto &c_h = c.GetHostData();
+        for (int n = 0; n < ncomp; n++) {
+          for (int j = pmb->js; j <= pmb->je; j++) {
+            for (int i = pmb->is; i <= pmb->ie; i++) {
+              if (c_h(n, 0, j, i) != value(pmb, n, i, j)) nwrong++;
+            }
+          }
+        }
+      }
+      THEN("it holds the values of strided") { REQUIRE(nwrong == 0); }
+    }
+
+    WHEN("an independent variable asks for the layout") {
+      Metadata independent(
+          {Metadata::Cell, Metadata::Independent, Metadata::ComponentInnermost});
+      THEN("it is refused") {
+        REQUIRE_THROWS_AS(pmesh->pblock->real_containers.Get().Add("d", independent),
+                          std::invalid_argument);
+      }
+    }
+  }
+}
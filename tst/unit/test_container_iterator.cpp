@@ -105,7 +105,7 @@ TEST_CASE("Can pull variables from containers based on Metadata", "[ContainerIte
     WHEN("we set Independent variables to one") {
       // set "Independent" variables to one
       ContainerIterator<Real> ci(rc, {Metadata::Independent});
-      CellVariableVector<Real> &civ = ci.vars;
+      const CellVariableVector<Real> &civ = ci.vars;
       for (int n = 0; n < civ.size(); n++) {
         ParArrayND<Real> v = civ[n]->data;
         par_for(
@@ -120,7 +120,7 @@ TEST_CASE("Can pull variables from containers based on Metadata", "[ContainerIte
         using policy4D = Kokkos::MDRangePolicy<Kokkos::Rank<4>>;
         Real total = 0.0;
         ContainerIterator<Real> ci(rc, {Metadata::Independent});
-        CellVariableVector<Real> &civ = ci.vars;
+        const CellVariableVector<Real> &civ = ci.vars;
         for (int n = 0; n < civ.size(); n++) {
           Real sum = 1.0;
           ParArrayND<Real> v = civ[n]->data;
@@ -135,5 +135,31 @@ TEST_CASE("Can pull variables from containers based on Metadata", "[ContainerIte
         REQUIRE(std::abs(total - 20480.0) < 1.e-14);
       }
     }
+
+    WHEN("we resolve a variable name to a handle") {
+      const int h = rc.Index("v3");
+      THEN("the handle refers to the same variable as the name") {
+        REQUIRE(h == 2);
+        REQUIRE(&rc.Get(h) == &rc.Get("v3"));
+        REQUIRE(rc.Index("not_a_variable") == -1);
+      }
+    }
+
+    WHEN("we iterate over the same flags twice") {
+      ContainerIterator<Real> ci1(rc, {Metadata::Independent});
+      ContainerIterator<Real> ci2(rc, {Metadata::Independent});
+      THEN("both iterators share the list cached by the container") {
+        REQUIRE(ci1.vars.size() == 3);
+        REQUIRE(&ci1.vars == &ci2.vars);
+      }
+      AND_WHEN("another variable is added") {
+        rc.Add("v7", m_in, scalar_block_size);
+        THEN("a new iterator sees it") {
+          ContainerIterator<Real> ci3(rc, {Metadata::Independent});
+          REQUIRE(ci3.vars.size() == 4);
+          REQUIRE(ci3.vars.back()->label() == "v7");
+        }
+      }
+    }
   }
 }
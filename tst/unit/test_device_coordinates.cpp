@@ -0,0 +1,85 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "coordinates/device_coordinates.hpp"
+#include "kokkos_abstraction.hpp"
+
+using parthenon::DevSpace;
+using parthenon::DeviceCoordinates;
+using parthenon::ParArray1D;
+using parthenon::Real;
+
+namespace {
+// sum of the cell volumes and of the x1 cell centers of an n^3 block, evaluated on the
+// device
+void SumOnDevice(const DeviceCoordinates &c, const int n, Real &volume, Real &x1v) {
+  Kokkos::parallel_reduce(
+      "volume", Kokkos::MDRangePolicy<Kokkos::Rank<3>>(DevSpace(), {0, 0, 0}, {n, n, n}),
+      KOKKOS_LAMBDA(const int k, const int j, const int i, Real &lsum) {
+        lsum += c.Volume(k, j, i);
+      },
+      volume);
+  Kokkos::parallel_reduce(
+      "x1v", Kokkos::RangePolicy<>(DevSpace(), 0, n),
+      KOKKOS_LAMBDA(const int i, Real &lsum) { lsum += c.X1v(i); }, x1v);
+}
+} // namespace
+
+TEST_CASE("DeviceCoordinates of uniform and stretched blocks", "[DeviceCoordinates]") {
+  const int n = 4;
+  GIVEN("A uniform block covering [0,1] x [0,2] x [0,4]") {
+    const int start[3] = {0, 0, 0};
+    const Real xmin[3] = {0.0, 0.0, 0.0};
+    const Real dx[3] = {0.25, 0.5, 1.0};
+    DeviceCoordinates c(start, xmin, dx);
+    REQUIRE(c.IsUniform());
+    REQUIRE(c.X1f(2) == Approx(0.5));
+    REQUIRE(c.X3v(1) == Approx(1.5));
+    REQUIRE(c.Area1(0, 0, 0) == Approx(0.5));
+    THEN("the cell volumes sum to the block volume on the device") {
+      Real volume, x1v;
+      SumOnDevice(c, n, volume, x1v);
+      REQUIRE(volume == Approx(8.0));
+      REQUIRE(x1v == Approx(2.0));
+    }
+  }
+
+  GIVEN("A stretched block with the same extent") {
+    // x1 faces at 0, 0.1, 0.3, 0.6, 1.0; uniform in x2 and x3
+    const Real x1[n + 1] = {0.0, 0.1, 0.3, 0.6, 1.0};
+    ParArray1D<Real> xf[3], dxf[3];
+    for (int d = 0; d < 3; d++) {
+      xf[d] = ParArray1D<Real>("xf", n + 1);
+      dxf[d] = ParArray1D<Real>("dxf", n);
+      auto xf_h = Kokkos::create_mirror_view(xf[d]);
+      auto dxf_h = Kokkos::create_mirror_view(dxf[d]);
+      for (int i = 0; i <= n; i++)
+        xf_h(i) = (d == 0 ? x1[i] : i * (d == 1 ? 0.5 : 1.0));
+      for (int i = 0; i < n; i++)
+        dxf_h(i) = xf_h(i + 1) - xf_h(i);
+      Kokkos::deep_copy(xf[d], xf_h);
+      Kokkos::deep_copy(dxf[d], dxf_h);
+    }
+    DeviceCoordinates c(xf[0], xf[1], xf[2], dxf[0], dxf[1], dxf[2]);
+    REQUIRE(!c.IsUniform());
+    THEN("the cell volumes sum to the block volume on the device") {
+      Real volume, x1v;
+      SumOnDevice(c, n, volume, x1v);
+      REQUIRE(volume == Approx(8.0));
+      REQUIRE(x1v == Approx(0.05 + 0.2 + 0.45 + 0.8));
+    }
+  }
+}
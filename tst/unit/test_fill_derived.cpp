@@ -0,0 +1,79 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "interface/update.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::Container;
+using parthenon::Metadata;
+using parthenon::ParameterInput;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+namespace {
+
+int nfills = 0;
+void CountFill(Container<Real> &rc) { nfills++; }
+
+// a package with the derived variable d and a FillDerived that counts its calls
+std::shared_ptr<StateDescriptor> DerivedPackage(const bool on_demand) {
+  auto pkg = std::make_shared<StateDescriptor>("Derived");
+  std::vector<parthenon::MetadataFlag> flags = {Metadata::Cell, Metadata::Derived,
+                                                 Metadata::OneCopy};
+  if (on_demand) flags.push_back(Metadata::OnDemand);
+  Metadata m(flags);
+  pkg->AddField("d", m);
+  pkg->FillDerived = CountFill;
+  return pkg;
+}
+
+} // namespace
+
+TEST_CASE("Derived variables flagged OnDemand are filled when read",
+          "[FillDerived][OnDemand]") {
+  parthenon::FillDerivedVariables::SetFillDerivedFunctions(nullptr, nullptr);
+  for (const bool on_demand : {true, false}) {
+    GIVEN(std::string("A package whose derived variable is ") +
+          (on_demand ? "" : "not ") + "flagged OnDemand") {
+      ParameterInput pin;
+      mesh_fixture::SetMeshParameters(&pin, 2, 8, 8);
+      auto packages = mesh_fixture::Packages();
+      packages["Derived"] = DerivedPackage(on_demand);
+      REQUIRE(packages["Derived"]->FillDerivedOnDemand() == on_demand);
+      REQUIRE_FALSE(packages["Test"]->FillDerivedOnDemand());
+      auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+      Container<Real> &rc = pmesh->pblock->real_containers.Get();
+
+      WHEN("a stage fills the derived variables and two consumers read them") {
+        nfills = 0;
+        parthenon::FillDerivedVariables::FillDerived(rc);
+        parthenon::FillDerivedVariables::FillOnDemand(rc);
+        parthenon::FillDerivedVariables::FillOnDemand(rc);
+        THEN("the package is filled once, by the stage or by the first consumer") {
+          REQUIRE(nfills == 1);
+        }
+        AND_WHEN("the next stage fills them and a consumer reads them") {
+          parthenon::FillDerivedVariables::FillDerived(rc);
+          parthenon::FillDerivedVariables::FillOnDemand(rc);
+          THEN("the package is filled once more") { REQUIRE(nfills == 2); }
+        }
+      }
+    }
+  }
+}
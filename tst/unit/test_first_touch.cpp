@@ -0,0 +1,63 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+#include "kokkos_abstraction.hpp"
+#include "mesh/mesh_refinement.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::Container;
+using parthenon::DevSpace;
+using parthenon::MeshBlock;
+using parthenon::ParameterInput;
+using parthenon::Real;
+
+// <mesh>/numa_first_touch only acts when the blocks run on the host
+TEST_CASE("First touch moves the data of new containers", "[MeshBlock][FirstTouch]") {
+  if (!std::is_same<DevSpace, Kokkos::DefaultHostExecutionSpace>::value) return;
+
+  GIVEN("A statically refined mesh with first touch") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    pin.SetString("mesh", "refinement", "static");
+    pin.SetBoolean("mesh", "numa_first_touch", true);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    MeshBlock *pmb = pmesh->pblock;
+    REQUIRE(pmb->pmr != nullptr);
+    Container<Real> &base = pmb->real_containers.Get();
+    pmb->real_containers.Add("u1", base);
+
+    WHEN("the data is first touched") {
+      pmb->FirstTouchData();
+      THEN("the arrays enrolled in the refinement are those of the variables") {
+        REQUIRE(base.GetSlab().GetSize() > 0);
+        REQUIRE(pmb->pmr->GetCellArray(0).Get().data() ==
+                base.Get("q").data.Get().data());
+      }
+
+      AND_WHEN("the stage container is purged and added again") {
+        pmb->real_containers.PurgeNonBase();
+        pmb->real_containers.Add("u1", base);
+        REQUIRE(pmb->real_containers.Get("u1").GetSlab().GetSize() == 0);
+        pmb->FirstTouchData();
+        THEN("the new container is moved as well") {
+          REQUIRE(pmb->real_containers.Get("u1").GetSlab().GetSize() > 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,102 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "utils/gl_quadrature.hpp"
+
+using parthenon::Real;
+
+TEST_CASE("Gauss-Legendre nodes", "[GaussLegendre]") {
+  for (const int n : {2, 3, 4, 5, 8, 9, 16}) {
+    GIVEN("The " + std::to_string(n) + "-point rule") {
+      std::vector<Real> x, w;
+      parthenon::GaussLegendre::Nodes(n, x, w);
+      REQUIRE(x.size() == static_cast<std::size_t>(n));
+      REQUIRE(w.size() == static_cast<std::size_t>(n));
+      THEN("the abscissae are ascending, symmetric and inside [-1, 1]") {
+        for (int i = 0; i < n; i++) {
+          REQUIRE(std::abs(x[i]) < 1.0);
+          REQUIRE(x[i] == Approx(-x[n - 1 - i]).margin(1.0e-14));
+          REQUIRE(w[i] == Approx(w[n - 1 - i]));
+          if (i > 0) REQUIRE(x[i] > x[i - 1]);
+        }
+      }
+      THEN("polynomials up to degree 2n - 1 are integrated exactly") {
+        for (int p = 0; p < 2 * n; p++) {
+          Real sum = 0.0;
+          for (int i = 0; i < n; i++) {
+            sum += w[i] * std::pow(x[i], p);
+          }
+          const Real exact = (p % 2 ? 0.0 : 2.0 / (p + 1));
+          REQUIRE(sum == Approx(exact).margin(1.0e-12));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Gauss-Legendre nodes outside the tables", "[GaussLegendre]") {
+  std::vector<Real> x, w;
+  const int max_order = parthenon::GaussLegendre::max_order;
+  REQUIRE_NOTHROW(parthenon::GaussLegendre::Nodes(max_order, x, w));
+  REQUIRE_THROWS_AS(parthenon::GaussLegendre::Nodes(1, x, w), std::runtime_error);
+  REQUIRE_THROWS_AS(parthenon::GaussLegendre::Nodes(max_order + 1, x, w),
+                    std::runtime_error);
+}
+
+template <int N>
+void CheckRule() {
+  std::vector<Real> x, w;
+  parthenon::GaussLegendre::Nodes(N, x, w);
+  using Rule = parthenon::GaussLegendre::Rule<N>;
+  for (int i = 0; i < N; i++) {
+    REQUIRE(Rule::Abscissa(i) == Approx(x[i]).margin(1.0e-14));
+    REQUIRE(Rule::Weight(i) == Approx(w[i]));
+  }
+  // x^a y^b z^c with a, b, c < 2N over [0, 1] x [-1, 2] x [1, 3] is integrated exactly
+  const int p = 2 * N - 1;
+  auto f = [p](const Real x1, const Real x2, const Real x3) {
+    return std::pow(x1, p) * std::pow(x2, p - 1) * std::pow(x3, p);
+  };
+  const Real exact = (1.0 / (p + 1)) * (std::pow(2.0, p) - std::pow(-1.0, p)) / p *
+                     (std::pow(3.0, p + 1) - 1.0) / (p + 1);
+  REQUIRE(parthenon::GaussLegendre::integrate<N>(f, 0.0, 1.0, -1.0, 2.0, 1.0, 3.0) ==
+          Approx(exact).epsilon(1.0e-12));
+}
+
+TEST_CASE("Gauss-Legendre rules with a compile-time number of nodes", "[GaussLegendre]") {
+  GIVEN("The 1-point rule") {
+    THEN("it is the midpoint rule") {
+      auto f = [](const Real x1) { return 3.0 * x1 + 1.0; };
+      REQUIRE(parthenon::GaussLegendre::integrate<1>(f, 1.0, 3.0) == Approx(14.0));
+    }
+  }
+  GIVEN("The 2- to 8-point rules") {
+    THEN("they match the node tables and integrate polynomials exactly") {
+      CheckRule<2>();
+      CheckRule<3>();
+      CheckRule<4>();
+      CheckRule<5>();
+      CheckRule<6>();
+      CheckRule<7>();
+      CheckRule<8>();
+    }
+  }
+}
@@ -0,0 +1,58 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <array>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "interface/metadata.hpp"
+#include "interface/variable.hpp"
+#include "kokkos_abstraction.hpp"
+
+using parthenon::CellVariable;
+using parthenon::Metadata;
+using parthenon::Real;
+
+TEST_CASE("Host copies of variables are synced on demand", "[CellVariable]") {
+  GIVEN("A variable set on the device") {
+    CellVariable<Real> v("v", std::array<int, 6>{4, 4, 4, 1, 1, 1},
+                         Metadata({Metadata::Independent}));
+    Kokkos::deep_copy(v.data.Get(), 1.0);
+    CellVariable<Real>::MarkAllDeviceModified();
+    REQUIRE(v.GetHostData()(0, 1, 2) == 1.0);
+
+    WHEN("the device data changes") {
+      Kokkos::deep_copy(v.data.Get(), 2.0);
+      THEN("the host copy is only updated once the variable is marked modified") {
+        // host and device share the data unless they are different memory spaces
+        const bool mirrored = (v.GetHostData().Get().data() != v.data.Get().data());
+        REQUIRE(v.GetHostData()(0, 1, 2) == (mirrored ? 1.0 : 2.0));
+        v.MarkDeviceModified();
+        REQUIRE(v.GetHostData()(0, 1, 2) == 2.0);
+      }
+    }
+    WHEN("the host copy is written and synced back") {
+      auto &h = v.GetHostData();
+      h(0, 1, 2) = 3.0;
+      v.MarkHostModified();
+      v.SyncToDevice();
+      THEN("the device data has the value") {
+        auto check = v.data.GetHostMirror();
+        check.DeepCopy(v.data);
+        REQUIRE(check(0, 1, 2) == 3.0);
+        REQUIRE(check(0, 1, 1) == 1.0);
+      }
+    }
+  }
+}
@@ -0,0 +1,135 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+#include "parthenon_arrays.hpp"
+#include "utils/interp_table.hpp"
+
+using parthenon::DevSpace;
+using parthenon::InterpTable2D;
+using parthenon::InterpTable3D;
+using parthenon::ParArrayND;
+using parthenon::Real;
+
+namespace {
+// linear in each coordinate, so that the multilinear lookups reproduce it exactly, both
+// on and off the table
+KOKKOS_INLINE_FUNCTION Real F(const int var, const Real x3, const Real x2,
+                              const Real x1) {
+  return 1.0 + 2.0 * x1 - 3.0 * x2 + 0.5 * x3 + var * x1 * x2 * (1.0 + x3);
+}
+} // namespace
+
+TEST_CASE("Batched and device lookups in interpolation tables", "[InterpTable]") {
+  const int n = 8;
+  ParArrayND<Real> x3("x3", n, n, n), x2("x2", n, n, n), x1("x1", n, n, n);
+  ParArrayND<Real> out("out", n, n, n);
+  auto x3_h = x3.GetHostMirror(), x2_h = x2.GetHostMirror(), x1_h = x1.GetHostMirror();
+  // the last layers of points are off the tables
+  for (int k = 0; k < n; k++) {
+    for (int j = 0; j < n; j++) {
+      for (int i = 0; i < n; i++) {
+        x3_h(k, j, i) = -1.0 + 0.3 * k;
+        x2_h(k, j, i) = 0.1 + 0.37 * j;
+        x1_h(k, j, i) = -0.95 + 0.41 * i;
+      }
+    }
+  }
+  x3.DeepCopy(x3_h);
+  x2.DeepCopy(x2_h);
+  x1.DeepCopy(x1_h);
+  auto out_h = out.GetHostMirror();
+
+  GIVEN("A 2D table with two variables on [0, 2] x [-1, 1.5]") {
+    const int nx2 = 5, nx1 = 6;
+    InterpTable2D table(2, nx2, nx1);
+    table.SetX2lim(0.0, 2.0);
+    table.SetX1lim(-1.0, 1.5);
+    auto data_h = table.data.GetHostMirror();
+    for (int v = 0; v < 2; v++) {
+      for (int j = 0; j < nx2; j++) {
+        for (int i = 0; i < nx1; i++) {
+          data_h(v, j, i) = F(v, 0.0, 2.0 * j / (nx2 - 1), -1.0 + 2.5 * i / (nx1 - 1));
+        }
+      }
+    }
+    table.data.DeepCopy(data_h);
+    for (int v = 0; v < 2; v++) {
+      THEN("InterpolateAll of variable " + std::to_string(v) + " is bilinear") {
+        table.InterpolateAll(v, x2, x1, out);
+        out_h.DeepCopy(out);
+        for (int k = 0; k < n; k++) {
+          for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+              REQUIRE(out_h(k, j, i) == Approx(F(v, 0.0, x2_h(k, j, i), x1_h(k, j, i))));
+            }
+          }
+        }
+      }
+    }
+    THEN("the device table can be looked up in a kernel") {
+      const auto dtable = table.GetDeviceTable();
+      Real sum = 0.0;
+      Kokkos::parallel_reduce(
+          "InterpTable2D lookups", Kokkos::RangePolicy<>(DevSpace(), 0, n),
+          KOKKOS_LAMBDA(const int i, Real &lsum) {
+            lsum += dtable.Interpolate(1, 0.25 * i, 0.0);
+          },
+          sum);
+      Real expected = 0.0;
+      for (int i = 0; i < n; i++) {
+        expected += F(1, 0.0, 0.25 * i, 0.0);
+      }
+      REQUIRE(sum == Approx(expected));
+    }
+  }
+
+  GIVEN("A 3D table with two variables on [-1, 1] x [0, 2] x [-1, 1.5]") {
+    const int nx3 = 4, nx2 = 5, nx1 = 6;
+    InterpTable3D table(2, nx3, nx2, nx1);
+    table.SetX3lim(-1.0, 1.0);
+    table.SetX2lim(0.0, 2.0);
+    table.SetX1lim(-1.0, 1.5);
+    auto data_h = table.data.GetHostMirror();
+    for (int v = 0; v < 2; v++) {
+      for (int k = 0; k < nx3; k++) {
+        for (int j = 0; j < nx2; j++) {
+          for (int i = 0; i < nx1; i++) {
+            data_h(v, k, j, i) = F(v, -1.0 + 2.0 * k / (nx3 - 1), 2.0 * j / (nx2 - 1),
+                                   -1.0 + 2.5 * i / (nx1 - 1));
+          }
+        }
+      }
+    }
+    table.data.DeepCopy(data_h);
+    for (int v = 0; v < 2; v++) {
+      THEN("InterpolateAll of variable " + std::to_string(v) + " is trilinear") {
+        table.InterpolateAll(v, x3, x2, x1, out);
+        out_h.DeepCopy(out);
+        for (int k = 0; k < n; k++) {
+          for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+              REQUIRE(out_h(k, j, i) ==
+                      Approx(F(v, x3_h(k, j, i), x2_h(k, j, i), x1_h(k, j, i))));
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,126 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "interface/update.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+#include "utils/kernel_graph.hpp"
+
+using parthenon::Container;
+using parthenon::DevSpace;
+using parthenon::KernelGraph;
+using parthenon::MeshBlock;
+using parthenon::ParameterInput;
+using parthenon::ParArray1D;
+using parthenon::Real;
+using parthenon::SpaceInstance;
+
+TEST_CASE("KernelGraph runs its kernels on the given instance", "[KernelGraph]") {
+  const int n = 16;
+  ParArray1D<Real> a("a", n);
+  DevSpace space = SpaceInstance<DevSpace>::create();
+
+  for (const bool enabled : {false, true}) {
+    KernelGraph::Enable(enabled);
+    KernelGraph graph;
+    int ncalls = 0;
+    // the sequence adds its step to every element of a
+    auto add = [&](const Real step) {
+      const std::vector<std::uintptr_t> signature = {
+          reinterpret_cast<std::uintptr_t>(a.data())};
+      graph.Run(space, signature, [&](const DevSpace &on) {
+        ncalls++;
+        parthenon::par_for(
+            "KernelGraph test", on, 0, n - 1,
+            KOKKOS_LAMBDA(const int i) { a(i) += step; });
+      });
+    };
+    Kokkos::deep_copy(a, 0.0);
+    add(1.0);
+    add(1.0);
+    add(1.0);
+    space.fence();
+
+    auto a_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), a);
+    int nwrong = 0;
+    for (int i = 0; i < n; i++) {
+      if (a_h(i) != 3.0) nwrong++;
+    }
+    REQUIRE(nwrong == 0);
+    // replayed graphs do not call the function again
+    REQUIRE(ncalls >= 1);
+    REQUIRE(ncalls <= 3);
+    if (!enabled) REQUIRE(ncalls == 3);
+  }
+  KernelGraph::Enable(false);
+  SpaceInstance<DevSpace>::destroy(space);
+}
+
+TEST_CASE("FluxDivergenceInRegions keeps a graph per pair of containers",
+          "[KernelGraph][FluxDivergence]") {
+  GIVEN("A block with two stage containers") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    pin.SetInteger("mesh", "num_exec_space_instances", 2);
+    pin.SetBoolean("mesh", "kernel_graphs", true);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    MeshBlock *pmb = pmesh->pblock;
+    Container<Real> &base = pmb->real_containers.Get();
+    pmb->real_containers.Add("u1", base);
+    pmb->real_containers.Add("dUdt", base);
+    Container<Real> &u1 = pmb->real_containers.Get("u1");
+    Container<Real> &dudt = pmb->real_containers.Get("dUdt");
+    const std::vector<parthenon::Update::CellRegion> regions = {
+        parthenon::Update::InteriorRegion(pmb, 0)};
+
+    WHEN("the divergence of both stages is taken twice") {
+      for (int n = 0; n < 2; n++) {
+        parthenon::Update::FluxDivergenceInRegions(base, dudt, regions);
+        parthenon::Update::FluxDivergenceInRegions(u1, dudt, regions);
+      }
+      pmb->exec_space.fence();
+      THEN("each stage has a graph of its own") {
+        REQUIRE(pmb->kernel_graphs.size() == 2);
+        // keyed by the names of the containers
+        auto graph = pmb->kernel_graphs.begin();
+        REQUIRE(graph->first.find("FluxDivergence base dUdt ") == 0);
+        REQUIRE(std::next(graph)->first.find("FluxDivergence u1 dUdt ") == 0);
+      }
+
+      AND_WHEN("the stage containers are purged and added again") {
+        pmb->real_containers.PurgeNonBase();
+        REQUIRE(pmb->kernel_graphs.empty());
+        pmb->real_containers.Add("u1", base);
+        pmb->real_containers.Add("dUdt", base);
+        for (int n = 0; n < 2; n++) {
+          parthenon::Update::FluxDivergenceInRegions(
+              base, pmb->real_containers.Get("dUdt"), regions);
+          parthenon::Update::FluxDivergenceInRegions(
+              pmb->real_containers.Get("u1"), pmb->real_containers.Get("dUdt"), regions);
+        }
+        pmb->exec_space.fence();
+        THEN("the stages get their graphs back under the same names") {
+          REQUIRE(pmb->kernel_graphs.size() == 2);
+        }
+      }
+    }
+  }
+  KernelGraph::Enable(false);
+}
@@ -0,0 +1,67 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <array>
+#include <string>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "interface/metadata.hpp"
+#include "interface/variable.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/memory_usage.hpp"
+
+using parthenon::CellVariable;
+using parthenon::Metadata;
+using parthenon::Real;
+using parthenon::MemoryUsage::Accounting;
+using parthenon::MemoryUsage::Space;
+
+TEST_CASE("Memory accounting counts every allocation once", "[MemoryUsage]") {
+  GIVEN("A host array and an accounting") {
+    Kokkos::View<Real *, Kokkos::HostSpace> a("a", 10);
+    Accounting acc;
+    WHEN("the array is added twice, once as a part of itself") {
+      acc.AddView("a", "data", a);
+      acc.AddView("a", "data", Kokkos::subview(a, std::make_pair(0, 5)));
+      THEN("it counts once as host memory") {
+        REQUIRE(acc.Total(Space::host) == 10 * sizeof(Real));
+        REQUIRE(acc.Total(Space::device) == 0);
+        REQUIRE(acc.Entries().size() == 1);
+      }
+    }
+    WHEN("an empty array is added") {
+      acc.AddView("b", "data", Kokkos::View<Real *, Kokkos::HostSpace>());
+      THEN("there is no entry") { REQUIRE(acc.Entries().empty()); }
+    }
+  }
+
+  GIVEN("A variable with a host copy") {
+    CellVariable<Real> v("v", std::array<int, 6>{4, 4, 4, 1, 1, 1},
+                         Metadata({Metadata::Independent}));
+    CellVariable<Real>::MarkAllDeviceModified();
+    v.GetHostData();
+    Accounting acc;
+    v.AccountMemory(acc);
+    THEN("data is counted, and the host copy if it is not data itself") {
+      const std::size_t bytes = 64 * sizeof(Real);
+      REQUIRE(acc.Entries().at({"v", "data"})[0] + acc.Entries().at({"v", "data"})[1] ==
+              bytes);
+      const bool mirrored = (v.GetHostData().Get().data() != v.data.Get().data());
+      REQUIRE(acc.Entries().count({"v", "host copy"}) == (mirrored ? 1 : 0));
+      REQUIRE(acc.Total() == (mirrored ? 2 : 1) * bytes);
+    }
+  }
+}
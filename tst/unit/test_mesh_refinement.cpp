@@ -0,0 +1,196 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "mesh/mesh_refinement.hpp"
+#include "mesh_fixture.hpp"
+#include "refinement/amr_criteria.hpp"
+#include "refinement/refinement.hpp"
+#include "utils/array_pool.hpp"
+
+using parthenon::AmrTag;
+using parthenon::AMRMinMax;
+using parthenon::ArrayPool;
+using parthenon::Container;
+using parthenon::LogicalLocation;
+using parthenon::MeshBlock;
+using parthenon::ParameterInput;
+using parthenon::Real;
+
+TEST_CASE("Coarse arrays on demand are shared with and released from all containers",
+          "[MeshRefinement][ArrayPool]") {
+  auto &pool = ArrayPool<Real>::Instance();
+  GIVEN("A statically refined mesh of one level with coarse arrays on demand") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    pin.SetString("mesh", "refinement", "static");
+    pin.SetBoolean("mesh", "coarse_buffers_on_demand", true);
+    pin.SetBoolean("mesh", "pool_block_arrays", true);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    MeshBlock *pmb = pmesh->pblock;
+    REQUIRE(pmb->pmr != nullptr);
+    Container<Real> &base = pmb->real_containers.Get();
+
+    THEN("no block, having no neighbor on another level, holds them") {
+      for (MeshBlock *p = pmb; p != nullptr; p = p->next) {
+        REQUIRE(p->pmr->GetCoarseCellArray(0).GetSize() == 0);
+      }
+    }
+
+    WHEN("they are allocated with a stage container present") {
+      pmb->real_containers.Add("u1", base);
+      auto &copy = pmb->real_containers.Get("u1").Get("q");
+      pmb->pmr->SetCoarseArrays(true);
+      const auto &coarse = pmb->pmr->GetCoarseCellArray(0);
+      THEN("the variable, its stage copy and the refinement use the same array") {
+        REQUIRE(coarse.GetSize() > 0);
+        REQUIRE(base.Get("q").coarse_s.Get().data() == coarse.Get().data());
+        REQUIRE(copy.coarse_s.Get().data() == coarse.Get().data());
+      }
+
+      AND_WHEN("they are released again") {
+        const std::size_t held = pool.HeldBytes();
+        pmb->pmr->SetCoarseArrays(false);
+        THEN("no container holds them and the pool has them back") {
+          REQUIRE(pmb->pmr->GetCoarseCellArray(0).GetSize() == 0);
+          REQUIRE(base.Get("q").coarse_s.GetSize() == 0);
+          REQUIRE(copy.coarse_s.GetSize() == 0);
+          REQUIRE(pool.HeldBytes() > held);
+        }
+      }
+    }
+  }
+  // the pooled arrays have to go before Kokkos is finalized
+  pool.Enable(false, false);
+}
+
+TEST_CASE("AMRMinMax tags from the extrema of its field", "[AMRMinMax]") {
+  AMRMinMax minmax("q", 0.3, 0.03, 1);
+  REQUIRE(minmax.Tag(0.0, 0.5) == AmrTag::refine);
+  REQUIRE(minmax.Tag(0.0, 0.01) == AmrTag::derefine);
+  REQUIRE(minmax.Tag(0.1, 0.2) == AmrTag::same);
+  // a block that is nowhere below the derefinement threshold is left alone
+  REQUIRE(minmax.Tag(0.1, 0.5) == AmrTag::same);
+}
+
+TEST_CASE("MinMax finds the extrema of data of either sign", "[AMRMinMax]") {
+  GIVEN("A 2D mesh") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    MeshBlock *pmb = pmesh->pblock;
+    auto &q = pmb->real_containers.Get().Get("q");
+
+    for (const Real sign : {-1.0, 1.0}) {
+      WHEN("the interior only holds values of sign " + std::to_string(sign)) {
+        auto q_h = q.data.GetHostMirror();
+        for (int j = pmb->js; j <= pmb->je; j++) {
+          for (int i = pmb->is; i <= pmb->ie; i++) {
+            q_h(0, j, i) = sign * (2.0 + i + j);
+          }
+        }
+        q.data.DeepCopy(q_h);
+        Real qmin, qmax;
+        parthenon::Refinement::MinMax(pmb, q, qmin, qmax);
+        THEN("the extrema are those of the interior") {
+          const Real lo = 2.0 + pmb->is + pmb->js, hi = 2.0 + pmb->ie + pmb->je;
+          REQUIRE(qmin == (sign > 0 ? lo : -hi));
+          REQUIRE(qmax == (sign > 0 ? hi : -lo));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("The fused extrema of a field are combined and cleared by the tag",
+          "[MeshRefinement][AMRMinMax]") {
+  for (const std::string refinement : {"static", "adaptive"}) {
+    GIVEN("A " + refinement + " mesh with an AMRMinMax criterion on q") {
+      ParameterInput pin;
+      mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+      pin.SetString("mesh", "refinement", refinement);
+      pin.SetInteger("mesh", "numlevel", 2);
+      auto packages = mesh_fixture::Packages();
+      packages["Test"]->amr_criteria.push_back(
+          std::make_shared<AMRMinMax>("q", 0.3, 0.03, 1));
+      auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+      MeshBlock *pmb = pmesh->pblock;
+      REQUIRE(pmb->pmr != nullptr);
+
+      THEN("only the adaptive mesh has the update kernels reduce the extrema") {
+        REQUIRE(parthenon::Refinement::HasFusedCriterion(pmb, "q") ==
+                (refinement == "adaptive"));
+      }
+
+      WHEN("two regions reduce their extrema into slots") {
+        Real qmin, qmax;
+        REQUIRE(!pmb->pmr->GetFusedExtrema("q", qmin, qmax));
+        const Real values[2][2] = {{-1.0, 2.0}, {0.5, 3.0}};
+        for (int n = 0; n < 2; n++) {
+          auto slot = pmb->pmr->AddFusedExtrema("q");
+          auto slot_h = Kokkos::create_mirror_view(slot);
+          slot_h().min_val = values[n][0];
+          slot_h().max_val = values[n][1];
+          Kokkos::deep_copy(slot, slot_h);
+        }
+        THEN("they are combined until the next tag is set") {
+          REQUIRE(pmb->pmr->GetFusedExtrema("q", qmin, qmax));
+          REQUIRE(qmin == -1.0);
+          REQUIRE(qmax == 3.0);
+          REQUIRE(!pmb->pmr->GetFusedExtrema("other", qmin, qmax));
+          pmb->pmr->SetRefinement(AmrTag::same);
+          REQUIRE(!pmb->pmr->GetFusedExtrema("q", qmin, qmax));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("The refinement buffer counts blocks at the finer level",
+          "[MeshRefinement][RefineBuffer]") {
+  for (const std::string bc : {"periodic", "outflow"}) {
+    GIVEN("A 2D mesh of 4x4 root blocks with " + bc + " boundaries and a buffer of 1") {
+      ParameterInput pin;
+      mesh_fixture::SetMeshParameters(&pin, 2, 32, 8, bc);
+      pin.SetInteger("mesh", "refine_buffer", 1);
+      auto packages = mesh_fixture::Packages();
+      auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+      const int root = pmesh->GetRootLevel();
+      auto within = [&](const LogicalLocation &a, const LogicalLocation &b) {
+        return pmesh->WithinRefineBuffer(a, b, std::max(a.level, b.level));
+      };
+
+      THEN("adjacent blocks, corners included, are within it and farther ones not") {
+        REQUIRE(within({0, 0, 0, root}, {1, 0, 0, root}));
+        REQUIRE(within({0, 0, 0, root}, {1, 1, 0, root}));
+        REQUIRE_FALSE(within({0, 0, 0, root}, {2, 0, 0, root}));
+        REQUIRE_FALSE(within({0, 0, 0, root}, {1, 2, 0, root}));
+      }
+      THEN("a finer block is within it of the coarse block next to it") {
+        // the right half of root block (0, 0), at the next level
+        REQUIRE(within({1, 0, 0, root + 1}, {1, 0, 0, root}));
+        REQUIRE_FALSE(within({0, 0, 0, root + 1}, {1, 0, 0, root}));
+      }
+      THEN("the distance wraps around periodic boundaries only") {
+        REQUIRE(within({0, 0, 0, root}, {3, 0, 0, root}) == (bc == "periodic"));
+      }
+    }
+  }
+}
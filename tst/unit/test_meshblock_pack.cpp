@@ -0,0 +1,188 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+#include "refinement/refinement.hpp"
+
+using parthenon::AmrTag;
+using parthenon::DevSpace;
+using parthenon::MeshBlock;
+using parthenon::MeshBlockPack;
+using parthenon::ParArray2D;
+using parthenon::ParArray3D;
+using parthenon::ParameterInput;
+using parthenon::Real;
+
+TEST_CASE("MeshBlockPack indexes the arrays of all blocks", "[MeshBlockPack]") {
+  GIVEN("Two components on each of three blocks") {
+    const int nblocks = 3, nvar = 2, N = 4;
+    ParArray2D<ParArray3D<Real>> views("views", nblocks, nvar);
+    auto views_h = Kokkos::create_mirror_view(views);
+    for (int b = 0; b < nblocks; b++) {
+      for (int n = 0; n < nvar; n++) {
+        views_h(b, n) = ParArray3D<Real>("component", N, N, N);
+      }
+    }
+    Kokkos::deep_copy(views, views_h);
+    MeshBlockPack<Real> pack(views, {{N, N, N}});
+
+    REQUIRE(pack.GetNBlocks() == nblocks);
+    REQUIRE(pack.GetNVars() == nvar);
+    REQUIRE(pack.GetDim(1) == N);
+
+    WHEN("the pack is filled by a single 5D loop") {
+      parthenon::par_for(
+          "fill pack", DevSpace(), 0, nblocks - 1, 0, nvar - 1, 0, N - 1, 0, N - 1, 0,
+          N - 1,
+          KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+            pack(b, n, k, j, i) =
+                static_cast<Real>(i + N * (j + N * (k + N * (n + nvar * b))));
+          });
+
+      THEN("every array of every block holds its own values") {
+        int nwrong = 0;
+        for (int b = 0; b < nblocks; b++) {
+          for (int n = 0; n < nvar; n++) {
+            auto arr_h = Kokkos::create_mirror_view(views_h(b, n));
+            Kokkos::deep_copy(arr_h, views_h(b, n));
+            for (int k = 0; k < N; k++)
+              for (int j = 0; j < N; j++)
+                for (int i = 0; i < N; i++)
+                  if (arr_h(k, j, i) !=
+                      static_cast<Real>(i + N * (j + N * (k + N * (n + nvar * b)))))
+                    nwrong++;
+          }
+        }
+        REQUIRE(nwrong == 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("Refinement criteria tag all blocks of a MeshBlockPack", "[MeshBlockPack]") {
+  GIVEN("A constant, a smooth and a discontinuous block") {
+    const int nblocks = 3, N = 8;
+    ParArray2D<ParArray3D<Real>> views("views", nblocks, 1);
+    auto views_h = Kokkos::create_mirror_view(views);
+    for (int b = 0; b < nblocks; b++) {
+      views_h(b, 0) = ParArray3D<Real>("q", N, N, N);
+      auto q_h = Kokkos::create_mirror_view(views_h(b, 0));
+      for (int k = 0; k < N; k++)
+        for (int j = 0; j < N; j++)
+          for (int i = 0; i < N; i++)
+            q_h(k, j, i) = (b == 0) ? 1.0 : (b == 1) ? 1.0 + 0.01 * i : (i < N / 2) + 1.0;
+      Kokkos::deep_copy(views_h(b, 0), q_h);
+    }
+    Kokkos::deep_copy(views, views_h);
+    MeshBlockPack<Real> pack(views, {{N, N, N}});
+
+    WHEN("they are tagged by the first derivative criterion") {
+      auto tags = parthenon::Refinement::FirstDerivative(pack, 0.1, 0.001);
+      THEN("each block gets its own tag") {
+        REQUIRE(tags.size() == nblocks);
+        REQUIRE(tags[0] == AmrTag::derefine);
+        REQUIRE(tags[1] == AmrTag::same);
+        REQUIRE(tags[2] == AmrTag::refine);
+      }
+    }
+
+    WHEN("they are tagged by the second derivative criterion") {
+      auto tags = parthenon::Refinement::SecondDerivative(pack, 0.8, 0.2, 0.01);
+      THEN("only the discontinuity refines, the linear block derefines") {
+        REQUIRE(tags.size() == nblocks);
+        REQUIRE(tags[0] == AmrTag::derefine);
+        REQUIRE(tags[1] == AmrTag::derefine);
+        REQUIRE(tags[2] == AmrTag::refine);
+      }
+    }
+
+    WHEN("they are tagged by the gradient criterion") {
+      auto tags = parthenon::Refinement::Gradient(pack, 0.1, 0.001);
+      THEN("each block gets its own tag") {
+        REQUIRE(tags[0] == AmrTag::derefine);
+        REQUIRE(tags[1] == AmrTag::same);
+        REQUIRE(tags[2] == AmrTag::refine);
+      }
+    }
+  }
+}
+
+namespace {
+
+// sets every cell of q on every block to value through the pack
+void FillThroughPack(parthenon::Mesh *pmesh, const Real value) {
+  auto pack =
+      parthenon::PackVariablesOnMesh(pmesh, "base", std::vector<std::string>{"q"});
+  parthenon::par_for(
+      "fill mesh pack", DevSpace(), 0, pack.GetNBlocks() - 1, 0, pack.GetNVars() - 1, 0,
+      pack.GetDim(3) - 1, 0, pack.GetDim(2) - 1, 0, pack.GetDim(1) - 1,
+      KOKKOS_LAMBDA(const int b, const int n, const int k, const int j, const int i) {
+        pack(b, n, k, j, i) = value;
+      });
+  Kokkos::fence();
+}
+
+// the cells of q on all blocks that do not hold value
+int WrongCells(parthenon::Mesh *pmesh, const Real value) {
+  int nwrong = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &q = pmb->real_containers.Get().Get("q").data;
+    auto q_h = q.GetHostMirror();
+    q_h.DeepCopy(q);
+    for (int j = 0; j < q.GetDim(2); j++) {
+      for (int i = 0; i < q.GetDim(1); i++) {
+        if (q_h(0, j, i) != value) nwrong++;
+      }
+    }
+  }
+  return nwrong;
+}
+
+} // namespace
+
+TEST_CASE("Packs of the mesh are cached until their arrays change", "[MeshBlockPack]") {
+  GIVEN("A 2D mesh of four blocks") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+
+    WHEN("the same variable is packed twice") {
+      FillThroughPack(pmesh.get(), 1.0);
+      FillThroughPack(pmesh.get(), 2.0);
+      THEN("the pack is built once and reaches the variables") {
+        REQUIRE(pmesh->pack_cache.size() == 1);
+        REQUIRE(WrongCells(pmesh.get(), 2.0) == 0);
+      }
+
+      AND_WHEN("the variables move into a slab") {
+        for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+          pmb->real_containers.Get().AllocateSlab();
+        }
+        FillThroughPack(pmesh.get(), 3.0);
+        THEN("the pack is rebuilt for the new arrays") {
+          REQUIRE(pmesh->pack_cache.size() == 1);
+          REQUIRE(WrongCells(pmesh.get(), 3.0) == 0);
+        }
+      }
+    }
+  }
+}
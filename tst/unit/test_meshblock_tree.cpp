@@ -0,0 +1,121 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "mesh/meshblock_tree.hpp"
+
+using parthenon::LogicalLocation;
+using parthenon::MeshBlockTree;
+
+namespace {
+
+// all blocks of a uniform level, sorted along the Hilbert curve
+std::vector<LogicalLocation> SortedLevel(const int ndim, const int level) {
+  const std::int64_t n = 1LL << level;
+  std::vector<LogicalLocation> locs;
+  for (std::int64_t k = 0; k < (ndim > 2 ? n : 1); k++) {
+    for (std::int64_t j = 0; j < n; j++) {
+      for (std::int64_t i = 0; i < n; i++) {
+        LogicalLocation loc;
+        loc.lx1 = i, loc.lx2 = j, loc.lx3 = k, loc.level = level;
+        locs.push_back(loc);
+      }
+    }
+  }
+  std::sort(locs.begin(), locs.end(),
+            [ndim, level](const LogicalLocation &a, const LogicalLocation &b) {
+              return MeshBlockTree::HilbertLess(a, b, ndim, level);
+            });
+  return locs;
+}
+
+bool FaceNeighbors(const LogicalLocation &a, const LogicalLocation &b) {
+  return std::abs(a.lx1 - b.lx1) + std::abs(a.lx2 - b.lx2) + std::abs(a.lx3 - b.lx3) == 1;
+}
+
+} // namespace
+
+TEST_CASE("Hilbert ordering of MeshBlocks", "[MeshBlockTree][HilbertLess]") {
+  for (int ndim = 2; ndim <= 3; ndim++) {
+    GIVEN("All blocks of a uniform level in " + std::to_string(ndim) + "D") {
+      const int level = 4;
+      auto locs = SortedLevel(ndim, level);
+      THEN("consecutive blocks share a face") {
+        int nadjacent = 0;
+        for (int n = 1; n < static_cast<int>(locs.size()); n++) {
+          if (FaceNeighbors(locs[n - 1], locs[n])) nadjacent++;
+        }
+        REQUIRE(nadjacent == static_cast<int>(locs.size()) - 1);
+      }
+      THEN("the blocks under each coarser block are contiguous") {
+        for (int n = 0; n < static_cast<int>(locs.size()); n += (1 << ndim)) {
+          for (int m = n + 1; m < n + (1 << ndim); m++) {
+            REQUIRE((locs[m].lx1 >> 1) == (locs[n].lx1 >> 1));
+            REQUIRE((locs[m].lx2 >> 1) == (locs[n].lx2 >> 1));
+            REQUIRE((locs[m].lx3 >> 1) == (locs[n].lx3 >> 1));
+          }
+        }
+      }
+      THEN("a coarser block sorts between the neighbors of the fine blocks it covers") {
+        const int nchild = 1 << ndim;
+        LogicalLocation coarse = locs[nchild];
+        coarse.lx1 >>= 1, coarse.lx2 >>= 1, coarse.lx3 >>= 1, coarse.level--;
+        REQUIRE(MeshBlockTree::HilbertLess(locs[nchild - 1], coarse, ndim, level));
+        REQUIRE(!MeshBlockTree::HilbertLess(coarse, locs[nchild], ndim, level));
+        REQUIRE(MeshBlockTree::HilbertLess(coarse, locs[2 * nchild], ndim, level));
+      }
+    }
+  }
+}
+
+TEST_CASE("Hashing of logical locations", "[MeshBlockTree][LogicalLocationHash]") {
+  GIVEN("All blocks of a uniform level in 3D") {
+    const int level = 5;
+    const std::int64_t n = 1LL << level;
+    parthenon::LogicalLocationHash hash;
+    THEN("the hashes of the blocks are distinct and follow the Morton order") {
+      std::vector<std::size_t> keys;
+      for (std::int64_t k = 0; k < n; k++) {
+        for (std::int64_t j = 0; j < n; j++) {
+          for (std::int64_t i = 0; i < n; i++) {
+            LogicalLocation loc;
+            loc.lx1 = i, loc.lx2 = j, loc.lx3 = k, loc.level = level;
+            keys.push_back(hash(loc));
+          }
+        }
+      }
+      std::sort(keys.begin(), keys.end());
+      REQUIRE(std::unique(keys.begin(), keys.end()) == keys.end());
+      // the low bits of the key interleave those of lx1, lx2 and lx3
+      LogicalLocation a, b;
+      a.lx1 = 1, a.lx2 = 0, a.lx3 = 1, a.level = level;
+      b.lx1 = 0, b.lx2 = 1, b.lx3 = 0, b.level = level;
+      REQUIRE((hash(a) ^ hash(b)) == 7);
+    }
+    THEN("the same indices on different levels hash differently") {
+      LogicalLocation a, b;
+      a.lx1 = b.lx1 = 3, a.lx2 = b.lx2 = 1, a.lx3 = b.lx3 = 2;
+      a.level = level, b.level = level + 1;
+      REQUIRE(hash(a) != hash(b));
+    }
+  }
+}
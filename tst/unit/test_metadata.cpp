@@ -11,6 +11,9 @@
 // the public, perform publicly and display publicly, and to permit others to do so.
 //========================================================================================
 
+#include <string>
+#include <vector>
+
 #include <catch2/catch.hpp>
 
 #include "interface/metadata.hpp"
@@ -94,3 +97,35 @@ TEST_CASE("A Metadata struct is created", "[Metadata]") {
             Metadata({Metadata::Cell, Metadata::Derived, Metadata::OneCopy}));
   }
 }
+
+TEST_CASE("Metadata flags are matched against a mask", "[Metadata]") {
+  using parthenon::MetadataFlagMask;
+
+  GIVEN("A Metadata struct with built-in flags") {
+    Metadata m({Metadata::Cell, Metadata::FillGhost});
+
+    REQUIRE(m.AnyFlagsSet(MetadataFlagMask({Metadata::Face, Metadata::FillGhost})));
+    REQUIRE(!m.AnyFlagsSet(MetadataFlagMask({Metadata::Face, Metadata::Sparse})));
+    REQUIRE(!m.AnyFlagsSet(MetadataFlagMask()));
+  }
+
+  GIVEN("More user flags than fit into the inline words") {
+    std::vector<parthenon::MetadataFlag> flags;
+    for (int i = 0; i < 200; i++) {
+      flags.push_back(Metadata::AllocateNewFlag("MaskTestFlag" + std::to_string(i)));
+    }
+    auto const last = flags.back();
+    REQUIRE(last.InternalFlagValue() >= 128);
+
+    Metadata m({Metadata::Cell, last});
+    REQUIRE(m.IsSet(last));
+    REQUIRE(!m.IsSet(flags.front()));
+    REQUIRE(m.AnyFlagsSet(MetadataFlagMask({flags.front(), last})));
+    REQUIRE(!m.AnyFlagsSet(MetadataFlagMask({flags.front(), Metadata::Face})));
+    REQUIRE(static_cast<int>(m.MaskAsString().size()) == last.InternalFlagValue() + 1);
+
+    // unsetting the overflow flag makes it equal to a Metadata that never had it
+    m.Unset(last);
+    REQUIRE(m == Metadata({Metadata::Cell}));
+  }
+}
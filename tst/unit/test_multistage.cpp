@@ -0,0 +1,181 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "driver/multistage.hpp"
+#include "interface/update.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::Container;
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::MultiStageDriver;
+using parthenon::ParameterInput;
+using parthenon::ParArrayND;
+using parthenon::Real;
+using parthenon::StageWeights;
+using parthenon::TaskListStatus;
+
+namespace {
+
+// the integrator tables of MultiStageDriver without a task list
+class IntegratorDriver : public MultiStageDriver {
+ public:
+  IntegratorDriver(ParameterInput *pin, Mesh *pm) : MultiStageDriver(pin, pm, nullptr) {}
+  TaskListStatus Step() { return TaskListStatus::complete; }
+};
+
+// the rate of du/dt = -c u^2 in cell i, so that the cells differ in stiffness
+KOKKOS_INLINE_FUNCTION Real Rate(const int i) { return 1.0 + 0.1 * i; }
+
+// integrates du/dt = -c u^2 from u = 1 at t = 0 to t = 1 in nsteps steps on the cells of
+// the block, with one Update::LowStorageUpdate per stage as in the advection example,
+// and returns the largest error against u = 1 / (1 + c t). The equation is nonlinear,
+// so the error also depends on the order conditions a linear one does not see.
+Real IntegrationError(MeshBlock *pmb, const MultiStageDriver &driver, const int nsteps) {
+  const auto *integrator = driver.integrator;
+  Container<Real> &s1 = pmb->real_containers.Get(driver.register_name[0]);
+  Container<Real> &s2 = (integrator->nregisters > 1)
+                            ? pmb->real_containers.Get(driver.register_name[1])
+                            : s1;
+  Container<Real> &s3 = (integrator->nregisters > 2)
+                            ? pmb->real_containers.Get(driver.register_name[2])
+                            : s1;
+  Container<Real> &dudt = pmb->real_containers.Get("dUdt");
+  ParArrayND<Real> u = s1.Get("q").data;
+  ParArrayND<Real> du = dudt.Get("q").data;
+  const int is = pmb->is, ie = pmb->ie, js = pmb->js, je = pmb->je;
+
+  pmb->par_for(
+      "initial state", 0, 0, js, je, is, ie,
+      KOKKOS_LAMBDA(const int k, const int j, const int i) { u(k, j, i) = 1.0; });
+  const Real dt = 1.0 / nsteps;
+  for (int step = 0; step < nsteps; step++) {
+    for (int stage = 1; stage <= integrator->nstages; stage++) {
+      pmb->par_for(
+          "du/dt", 0, 0, js, je, is, ie,
+          KOKKOS_LAMBDA(const int k, const int j, const int i) {
+            du(k, j, i) = -Rate(i) * u(k, j, i) * u(k, j, i);
+          });
+      const StageWeights &w = integrator->stage_wghts[stage - 1];
+      parthenon::Update::LowStorageUpdate(s1, s2, s3, dudt, w.delta, w.gam1, w.gam2,
+                                          w.gam3, w.beta * dt, stage == 1);
+    }
+  }
+
+  auto u_h = u.GetHostMirror();
+  u_h.DeepCopy(u);
+  Real error = 0.0;
+  for (int j = js; j <= je; j++) {
+    for (int i = is; i <= ie; i++) {
+      error = std::max(error, std::abs(u_h(0, j, i) - 1.0 / (1.0 + Rate(i))));
+    }
+  }
+  return error;
+}
+
+} // namespace
+
+TEST_CASE("The multistage integrators converge at their design order", "[MultiStage]") {
+  GIVEN("The integrators of MultiStageDriver with their order and number of registers") {
+    const std::vector<std::tuple<std::string, int, int>> schemes = {
+        std::make_tuple("rk1", 1, 1), std::make_tuple("rk2", 2, 2),
+        std::make_tuple("rk3", 3, 2), std::make_tuple("rk4", 4, 2),
+        std::make_tuple("ssprk5_4", 4, 3)};
+
+    WHEN("each integrates du/dt = -c u^2 on a block with 16 and with 32 steps") {
+      std::vector<int> nregisters;
+      std::vector<Real> coarse, fine;
+      for (const auto &scheme : schemes) {
+        ParameterInput pin;
+        mesh_fixture::SetMeshParameters(&pin, 2, 8, 8);
+        pin.SetString("time", "integrator", std::get<0>(scheme));
+        auto packages = mesh_fixture::Packages();
+        auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+        IntegratorDriver driver(&pin, pmesh.get());
+        MeshBlock *pmb = pmesh->pblock;
+        Container<Real> &base = pmb->real_containers.Get();
+        pmb->real_containers.Add("dUdt", base);
+        for (int i = 1; i < driver.integrator->nregisters; i++) {
+          pmb->real_containers.Add(driver.register_name[i], base);
+        }
+        nregisters.push_back(static_cast<int>(driver.register_name.size()));
+        coarse.push_back(IntegrationError(pmb, driver, 16));
+        fine.push_back(IntegrationError(pmb, driver, 32));
+      }
+
+      THEN("halving the step divides the error by 2^order, with the expected registers") {
+        for (int n = 0; n < static_cast<int>(schemes.size()); n++) {
+          INFO(std::get<0>(schemes[n]) << ": errors " << coarse[n] << " and " << fine[n]);
+          REQUIRE(nregisters[n] == std::get<2>(schemes[n]));
+          REQUIRE(fine[n] > 0.0);
+          REQUIRE(std::log2(coarse[n] / fine[n]) ==
+                  Approx(std::get<1>(schemes[n])).margin(0.25));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("The integrators know the times and weights of their stages", "[MultiStage]") {
+  GIVEN("The integrators of MultiStageDriver") {
+    for (const std::string name : {"rk1", "rk2", "rk3", "rk4", "ssprk5_4"}) {
+      ParameterInput pin;
+      mesh_fixture::SetMeshParameters(&pin, 2, 8, 8);
+      pin.SetString("time", "integrator", name);
+      auto packages = mesh_fixture::Packages();
+      auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+      IntegratorDriver driver(&pin, pmesh.get());
+      const auto *integrator = driver.integrator;
+
+      THEN(name + " starts at the start of the step and its weights add up to one") {
+        REQUIRE(static_cast<int>(integrator->stage_time.size()) == integrator->nstages);
+        REQUIRE(static_cast<int>(integrator->flux_wghts.size()) == integrator->nstages);
+        REQUIRE(integrator->stage_time[0] == 0.0);
+        Real sum = 0.0;
+        for (const Real b : integrator->flux_wghts) {
+          sum += b;
+        }
+        REQUIRE(sum == Approx(1.0).epsilon(1.0e-12));
+      }
+    }
+
+    WHEN("the tables of rk2 and rk3 are compared with their Butcher tableaux") {
+      THEN("the times and weights are those of Heun's method and SSPRK(3,3)") {
+        ParameterInput pin;
+        mesh_fixture::SetMeshParameters(&pin, 2, 8, 8);
+        auto packages = mesh_fixture::Packages();
+        auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+        IntegratorDriver rk2(&pin, pmesh.get());
+        REQUIRE(rk2.integrator->stage_time[1] == Approx(1.0));
+        REQUIRE(rk2.integrator->flux_wghts[0] == Approx(0.5));
+        REQUIRE(rk2.integrator->flux_wghts[1] == Approx(0.5));
+
+        pin.SetString("time", "integrator", "rk3");
+        IntegratorDriver rk3(&pin, pmesh.get());
+        REQUIRE(rk3.integrator->stage_time[1] == Approx(1.0));
+        REQUIRE(rk3.integrator->stage_time[2] == Approx(0.5));
+        REQUIRE(rk3.integrator->flux_wghts[0] == Approx(1.0 / 6.0));
+        REQUIRE(rk3.integrator->flux_wghts[1] == Approx(1.0 / 6.0));
+        REQUIRE(rk3.integrator->flux_wghts[2] == Approx(2.0 / 3.0));
+      }
+    }
+  }
+}
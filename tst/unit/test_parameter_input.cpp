@@ -0,0 +1,74 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <sstream>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "parameter_input.hpp"
+
+using parthenon::ParameterInput;
+
+TEST_CASE("Parameters are looked up by name and parsed once", "[ParameterInput]") {
+  GIVEN("Parameters in two blocks") {
+    ParameterInput pin;
+    pin.SetInteger("mesh", "nx1", 64);
+    pin.SetReal("time", "tlim", 0.5);
+    pin.SetBoolean("mesh", "adaptive", true);
+    pin.SetString("mesh", "refinement", "static");
+
+    THEN("each is read as the type it was set as") {
+      REQUIRE(pin.GetInteger("mesh", "nx1") == 64);
+      REQUIRE(pin.GetReal("time", "tlim") == Approx(0.5));
+      REQUIRE(pin.GetBoolean("mesh", "adaptive"));
+      REQUIRE(pin.GetString("mesh", "refinement") == "static");
+      REQUIRE(pin.GetOrAddInteger("mesh", "nx1", 8) == 64);
+      REQUIRE(pin.GetOrAddInteger("mesh", "nx2", 8) == 8);
+      REQUIRE(pin.DoesParameterExist("mesh", "nx2"));
+      REQUIRE_FALSE(pin.DoesParameterExist("mesh", "nx3"));
+      REQUIRE_FALSE(pin.DoesBlockExist("output1"));
+    }
+
+    WHEN("a value that was read is replaced") {
+      REQUIRE(pin.GetInteger("mesh", "nx1") == 64);
+      REQUIRE(pin.GetReal("mesh", "nx1") == Approx(64.0));
+      pin.SetString("mesh", "nx1", "128");
+      THEN("the cached values of all types are dropped") {
+        REQUIRE(pin.GetInteger("mesh", "nx1") == 128);
+        REQUIRE(pin.GetReal("mesh", "nx1") == Approx(128.0));
+      }
+    }
+
+    WHEN("a value that was read is changed on the command line") {
+      REQUIRE(pin.GetReal("time", "tlim") == Approx(0.5));
+      char prog[] = "parthenon", arg[] = "time/tlim=2.5";
+      char *argv[] = {prog, arg};
+      pin.ModifyFromCmdline(2, argv);
+      THEN("the new value is read") {
+        REQUIRE(pin.GetReal("time", "tlim") == Approx(2.5));
+      }
+    }
+
+    WHEN("the parameters are dumped") {
+      std::ostringstream dump;
+      pin.ParameterDump(dump);
+      const std::string s = dump.str();
+      THEN("blocks and parameters appear in the order they were added") {
+        REQUIRE(s.find("<mesh>") < s.find("<time>"));
+        REQUIRE(s.find("nx1") < s.find("adaptive"));
+        REQUIRE(s.find("adaptive") < s.find("refinement"));
+      }
+    }
+  }
+}
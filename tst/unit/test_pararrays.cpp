@@ -21,6 +21,7 @@
 #include <iostream>
 #include <random>
 #include <string>
+#include <type_traits>
 
 #include <catch2/catch.hpp>
 
@@ -247,6 +248,39 @@ TEST_CASE("ParArrayND", "[ParArrayND][Kokkos]") {
   }
 }
 
+TEST_CASE("Get returns contiguous views of the requested rank", "[ParArrayND][Kokkos]") {
+  GIVEN("A 4D ParArrayND") {
+    ParArrayND<Real> a("a", 2, N, N, N);
+    auto v3 = a.Get<3>();
+    using view3_t = decltype(v3);
+    // the same type as ParArray3D, so kernels index three strides rather than six
+    static_assert(view3_t::rank == 3, "Get<3>() must return a rank 3 view");
+    static_assert(std::is_same<view3_t::array_layout, Kokkos::LayoutRight>::value,
+                  "Get<3>() must not return a strided view");
+    ParArray3D<Real> p3 = v3;
+    parthenon::ParArray4D<Real> p4 = a.Get<4>();
+    THEN("they alias the first slice of the array") {
+      REQUIRE(p3.data() == a.Get().data());
+      REQUIRE(p3.extent_int(0) == N);
+      REQUIRE(p4.extent_int(0) == 2);
+      parthenon::par_for(
+          "fill", DevSpace(), 0, N - 1, 0, N - 1, 0, N - 1,
+          KOKKOS_LAMBDA(const int k, const int j, const int i) {
+            p3(k, j, i) = k + j + i;
+            p4(1, k, j, i) = -1.0;
+          });
+      int errors = 1; // != 0
+      Kokkos::parallel_reduce(
+          policy3d({0, 0, 0}, {N, N, N}),
+          KOKKOS_LAMBDA(const int k, const int j, const int i, int &update) {
+            update += (a(0, k, j, i) == k + j + i && a(1, k, j, i) == -1.0) ? 0 : 1;
+          },
+          errors);
+      REQUIRE(errors == 0);
+    }
+  }
+}
+
 TEST_CASE("ParArrayND with LayoutLeft", "[ParArrayND][Kokkos][LayoutLeft]") {
   GIVEN("A ParArrayND with some dimensions") {
     constexpr int N1 = 2;
@@ -321,7 +355,7 @@ TEST_CASE("Time simple stencil operations", "[ParArrayND][performance]") {
   //   profile_wrapper_3d(parthenon::loop_pattern_tpttrtvr_tag);
   // }
 
-#ifndef KOKKOS_ENABLE_CUDA
+#ifndef PARTHENON_GPU_BACKEND
   // SECTION("tptvr") {
   //   std::cout << "tptvr range:" << std::endl;
   //   profile_wrapper_3d(parthenon::loop_pattern_tptvr_tag);
@@ -331,7 +365,7 @@ TEST_CASE("Time simple stencil operations", "[ParArrayND][performance]") {
     std::cout << "simd range:" << std::endl;
     profile_wrapper_3d(parthenon::loop_pattern_simdfor_tag);
   }
-#endif // !KOKKOS_ENABLE_CUDA
+#endif // !PARTHENON_GPU_BACKEND
 }
 // clang-format on
 
@@ -0,0 +1,144 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "mesh_fixture.hpp"
+#include "solvers/fft_poisson.hpp"
+#include "solvers/multigrid.hpp"
+
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::Metadata;
+using parthenon::MultigridSolver;
+using parthenon::Packages_t;
+using parthenon::ParameterInput;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+namespace {
+
+const Real kTwoPi = 2.0 * std::acos(-1.0);
+
+Packages_t PoissonPackages() {
+  auto pkg = std::make_shared<StateDescriptor>("Poisson");
+  const Metadata m({Metadata::Cell, Metadata::Independent});
+  for (const std::string name : {"f", "u", "u_fft"}) {
+    pkg->AddField(name, m);
+  }
+  Packages_t packages;
+  packages["Poisson"] = pkg;
+  return packages;
+}
+
+// visits the interior cells of all blocks of the rank with the host copy of the variable
+// name and the position of the cell center
+template <typename F>
+void ForAllCells(Mesh *pmesh, const std::string &name, const bool write, const F &f) {
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &q = pmb->real_containers.Get().Get(name).data;
+    auto q_h = q.GetHostMirror();
+    q_h.DeepCopy(q);
+    const auto &bs = pmb->block_size;
+    const Real dx = (bs.x1max - bs.x1min) / bs.nx1;
+    const Real dy = (bs.x2max - bs.x2min) / bs.nx2;
+    for (int j = pmb->js; j <= pmb->je; j++) {
+      for (int i = pmb->is; i <= pmb->ie; i++) {
+        f(q_h(0, j, i), bs.x1min + (i - pmb->is + 0.5) * dx,
+          bs.x2min + (j - pmb->js + 0.5) * dy);
+      }
+    }
+    if (write) q.DeepCopy(q_h);
+  }
+}
+
+// the right-hand side of the analytic solution u = sin(2 pi x) sin(2 pi y) on the
+// periodic unit square, which has zero mean
+void SetSource(Mesh *pmesh) {
+  ForAllCells(pmesh, "f", true, [](Real &f, const Real x, const Real y) {
+    f = -2.0 * kTwoPi * kTwoPi * std::sin(kTwoPi * x) * std::sin(kTwoPi * y);
+  });
+}
+
+Real MaxError(Mesh *pmesh, const std::string &name) {
+  Real error = 0.0;
+  ForAllCells(pmesh, name, false, [&error](Real &u, const Real x, const Real y) {
+    error = std::max(error, std::abs(u - std::sin(kTwoPi * x) * std::sin(kTwoPi * y)));
+  });
+  return error;
+}
+
+Real MultigridError(const int nx) {
+  ParameterInput pin;
+  mesh_fixture::SetMeshParameters(&pin, 2, nx, nx / 2);
+  pin.SetReal("multigrid", "tolerance", 1.0e-10);
+  pin.SetInteger("multigrid", "max_iterations", 100);
+  auto packages = PoissonPackages();
+  auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+  SetSource(pmesh.get());
+  MultigridSolver solver(pmesh.get(), &pin, "u", "f");
+  solver.Solve();
+  REQUIRE(solver.GetResidual() < 1.0e-10);
+  return MaxError(pmesh.get(), "u");
+}
+
+} // namespace
+
+TEST_CASE("Multigrid converges to an analytic solution at second order",
+          "[Multigrid]") {
+  const Real coarse = MultigridError(16);
+  const Real fine = MultigridError(32);
+  REQUIRE(coarse < 0.05);
+  // the error of the second-order stencil drops by 4 when the cells are halved
+  REQUIRE(coarse / fine > 3.5);
+  REQUIRE(coarse / fine < 4.5);
+}
+
+#ifdef ENABLE_FFTW
+TEST_CASE("The FFT and multigrid solvers agree on a periodic mesh",
+          "[Multigrid][FFTPoisson]") {
+  ParameterInput pin;
+  mesh_fixture::SetMeshParameters(&pin, 2, 32, 16);
+  pin.SetReal("multigrid", "tolerance", 1.0e-10);
+  pin.SetInteger("multigrid", "max_iterations", 100);
+  auto packages = PoissonPackages();
+  auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+  SetSource(pmesh.get());
+
+  MultigridSolver multigrid(pmesh.get(), &pin, "u", "f");
+  multigrid.Solve();
+  parthenon::FFTPoissonSolver fft(pmesh.get(), "u_fft", "f");
+  fft.Solve();
+
+  // both discretize with the same stencil, so they differ by the multigrid residual only
+  std::vector<Real> u;
+  ForAllCells(pmesh.get(), "u", false,
+              [&u](Real &v, const Real x, const Real y) { u.push_back(v); });
+  Real difference = 0.0;
+  int n = 0;
+  ForAllCells(pmesh.get(), "u_fft", false,
+              [&](Real &v, const Real x, const Real y) {
+                difference = std::max(difference, std::abs(v - u[n++]));
+              });
+  REQUIRE(difference < 1.0e-8);
+  REQUIRE(MaxError(pmesh.get(), "u_fft") < 0.02);
+}
+#endif // ENABLE_FFTW
@@ -0,0 +1,89 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cstdint>
+
+#include <catch2/catch.hpp>
+
+#include "athena.hpp"
+#include "kokkos_abstraction.hpp"
+#include "utils/random.hpp"
+
+using parthenon::DevSpace;
+using parthenon::ParArray1D;
+using parthenon::Random::Stream;
+
+TEST_CASE("Philox4x32-10 known answers", "[Random]") {
+  // the known-answer vectors of the Random123 library
+  std::uint32_t ctr[4] = {0, 0, 0, 0};
+  const std::uint32_t key[2] = {0, 0};
+  parthenon::Random::Philox4x32(ctr, key);
+  REQUIRE(ctr[0] == 0x6627e8d5u);
+  REQUIRE(ctr[1] == 0xe169c58du);
+  REQUIRE(ctr[2] == 0xbc57ac4cu);
+  REQUIRE(ctr[3] == 0x9b00dbd8u);
+
+  std::uint32_t ctr_pi[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+  const std::uint32_t key_pi[2] = {0xa4093822u, 0x299f31d0u};
+  parthenon::Random::Philox4x32(ctr_pi, key_pi);
+  REQUIRE(ctr_pi[0] == 0xd16cfe09u);
+  REQUIRE(ctr_pi[1] == 0x94fdccebu);
+  REQUIRE(ctr_pi[2] == 0x5001e420u);
+  REQUIRE(ctr_pi[3] == 0x24126ea1u);
+}
+
+TEST_CASE("Counter-based random streams", "[Random]") {
+  GIVEN("A stream") {
+    Stream rng(12345, 7, 42, 3);
+    THEN("the numbers are a function of their index only") {
+      const double u5 = rng.Uniform(5);
+      for (int n = 0; n < 5; n++)
+        rng.NextUniform();
+      REQUIRE(rng.NextUniform() == u5);
+      REQUIRE(Stream(12345, 7, 42, 3).Uniform(5) == u5);
+    }
+    THEN("streams with other keys differ") {
+      REQUIRE(Stream(12345, 7, 43, 3).Uniform(0) != rng.Uniform(0));
+      REQUIRE(Stream(12345, 7, 42, 4).Uniform(0) != rng.Uniform(0));
+      REQUIRE(Stream(12346, 7, 42, 3).Uniform(0) != rng.Uniform(0));
+    }
+    THEN("uniform numbers are in [0, 1) with mean 1/2 and normal ones have variance 1") {
+      const int n = 100000;
+      double sum = 0.0, sum2 = 0.0;
+      for (int i = 0; i < n; i++) {
+        const double u = rng.Uniform(i);
+        REQUIRE(u >= 0.0);
+        REQUIRE(u < 1.0);
+        sum += u;
+        const double g = rng.Normal(i);
+        sum2 += g * g;
+      }
+      REQUIRE(sum / n == Approx(0.5).margin(0.01));
+      REQUIRE(sum2 / n == Approx(1.0).margin(0.02));
+    }
+  }
+
+  GIVEN("Streams per cell drawn in a kernel") {
+    const int n = 1000;
+    ParArray1D<double> u("u", n);
+    parthenon::par_for(
+        "Random streams", DevSpace(), 0, n - 1,
+        KOKKOS_LAMBDA(const int i) { u(i) = Stream(99, 1, i, 0).NextUniform(); });
+    auto u_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), u);
+    THEN("they match the streams drawn on the host") {
+      for (int i = 0; i < n; i++) {
+        REQUIRE(u_h(i) == Stream(99, 1, i, 0).Uniform(0));
+      }
+    }
+  }
+}
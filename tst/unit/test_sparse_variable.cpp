@@ -0,0 +1,85 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <array>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "interface/metadata.hpp"
+#include "interface/sparse_variable.hpp"
+#include "kokkos_abstraction.hpp"
+
+using parthenon::DevSpace;
+using parthenon::Metadata;
+using parthenon::par_for;
+using parthenon::par_reduce;
+using parthenon::ParArrayND;
+using parthenon::Real;
+using parthenon::SparseVariable;
+
+TEST_CASE("Sparse ids map to the dense components", "[SparseVariable]") {
+  GIVEN("A sparse variable with ids 7, 2 and 11") {
+    std::array<int, 6> dims{{4, 3, 2, 1, 1, 1}};
+    SparseVariable<Real> sv("s", Metadata({Metadata::Cell, Metadata::Sparse}), dims);
+    for (int id : {7, 2, 11}) {
+      sv.Add(id);
+      Kokkos::deep_copy(sv.Get(id).data.Get(), static_cast<Real>(id));
+    }
+    THEN("the ids are found in the order they were added") {
+      REQUIRE(sv.GetIndex(7) == 0);
+      REQUIRE(sv.GetIndex(2) == 1);
+      REQUIRE(sv.GetIndex(11) == 2);
+      REQUIRE(sv.GetIndex(3) == -1);
+      REQUIRE(sv.GetIndex(12) == -1);
+      REQUIRE_THROWS_AS(sv.Add(2), std::invalid_argument);
+      REQUIRE_THROWS_AS(sv.Add(-1), std::invalid_argument);
+    }
+    THEN("the pack reads each id in a kernel") {
+      auto pack = sv.GetPack();
+      REQUIRE(pack.GetNComponents() == 3);
+      int nwrong = 0;
+      par_reduce(
+          "SparsePack test", DevSpace(), 0, 12, 0, 1, 0, 2, 0, 3,
+          KOKKOS_LAMBDA(const int id, const int k, const int j, const int i, int &n) {
+            const int s = pack.GetSlot(id);
+            if (s >= 0 && pack(id, k, j, i) != static_cast<Real>(id)) n++;
+            if ((s >= 0) != (id == 2 || id == 7 || id == 11)) n++;
+          },
+          Kokkos::Sum<int>(nwrong));
+      REQUIRE(nwrong == 0);
+    }
+    THEN("the pack follows the components into a slab") {
+      sv.GetPack();
+      const int size = sv.Get(7).data.GetSize();
+      ParArrayND<Real> slab("slab", 3 * size);
+      for (int id : {7, 2, 11}) {
+        sv.Get(id).MoveToSlab(slab, size * sv.GetIndex(id));
+      }
+      auto pack = sv.GetPack();
+      par_for(
+          "SparsePack slab test", DevSpace(), 0, 12, 0, 1, 0, 2, 0, 3,
+          KOKKOS_LAMBDA(const int id, const int k, const int j, const int i) {
+            if (pack.GetSlot(id) >= 0) pack(id, k, j, i) = -1.0;
+          });
+      auto slab_h = slab.GetHostMirror();
+      slab_h.DeepCopy(slab);
+      int nwrong = 0;
+      for (int n = 0; n < 3 * size; n++) {
+        if (slab_h(n) != -1.0) nwrong++;
+      }
+      REQUIRE(nwrong == 0);
+    }
+  }
+}
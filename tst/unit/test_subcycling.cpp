@@ -0,0 +1,230 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "bvals/bvals.hpp"
+#include "driver/multistage.hpp"
+#include "interface/update.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::BlockTask;
+using parthenon::Container;
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::MultiStageBlockTaskDriver;
+using parthenon::ParameterInput;
+using parthenon::ParArrayND;
+using parthenon::Real;
+using parthenon::StageWeights;
+using parthenon::TaskID;
+using parthenon::TaskList;
+using parthenon::TaskName;
+using parthenon::TaskStatus;
+
+namespace {
+
+// first order upwind advection of q with velocity 1 in x1, counting the steps the
+// blocks of each level take
+class UpwindDriver : public MultiStageBlockTaskDriver {
+ public:
+  UpwindDriver(ParameterInput *pin, Mesh *pm)
+      : MultiStageBlockTaskDriver(pin, pm, nullptr) {}
+  std::map<int, int> nsteps;
+
+  TaskList MakeTaskList(MeshBlock *pmb, int stage) {
+    using C = Container<Real>;
+    Container<Real> &base = pmb->real_containers.Get();
+    if (stage == 1) {
+      nsteps[pmb->loc.level]++;
+      pmb->real_containers.Add("dUdt", base);
+      for (int i = 1; i < integrator->nregisters; i++) {
+        pmb->real_containers.Add(register_name[i], base);
+      }
+    }
+    TaskList tl;
+    TaskID none(0);
+    auto AddTask = [&tl, pmb](const std::string &name, TaskStatus (*func)(C &),
+                              TaskID dep) {
+      return tl.AddTask<BlockTask>(
+          TaskName(name),
+          [func](MeshBlock *pmb) { return func(pmb->real_containers.Get()); }, dep,
+          pmb);
+    };
+
+    auto start_recv = AddTask("StartReceiving", C::StartReceivingTask, none);
+    auto flux = tl.AddTask<BlockTask>(
+        TaskName("CalculateFluxes"),
+        [](MeshBlock *pmb) {
+          auto &q = pmb->real_containers.Get().Get("q");
+          ParArrayND<Real> u = q.data, f1 = q.GetFlux(parthenon::X1DIR),
+                           f2 = q.GetFlux(parthenon::X2DIR);
+          pmb->par_for(
+              "upwind fluxes", 0, 0, pmb->js, pmb->je + 1, pmb->is, pmb->ie + 1,
+              KOKKOS_LAMBDA(const int k, const int j, const int i) {
+                f1(0, k, j, i) = u(0, k, j, i - 1);
+                f2(0, k, j, i) = 0.0;
+              });
+          return TaskStatus::complete;
+        },
+        none, pmb);
+    auto send_flux = AddTask("SendFluxCorrection", C::SendFluxCorrectionTask, flux);
+    auto recv_flux =
+        AddTask("ReceiveFluxCorrection", C::ReceiveFluxCorrectionTask, flux | start_recv);
+    auto update = tl.AddTask<BlockTask>(
+        TaskName("Update"),
+        [stage, this](MeshBlock *pmb) {
+          Container<Real> &s1 = pmb->real_containers.Get();
+          Container<Real> &s2 = (integrator->nregisters > 1)
+                                    ? pmb->real_containers.Get(register_name[1])
+                                    : s1;
+          Container<Real> &dudt = pmb->real_containers.Get("dUdt");
+          parthenon::Update::FluxDivergence(s1, dudt);
+          const StageWeights &w = integrator->stage_wghts[stage - 1];
+          parthenon::Update::LowStorageUpdate(
+              s1, s2, s1, dudt, w.delta, w.gam1, w.gam2, w.gam3,
+              w.beta * pmesh->LevelDt(pmb->loc.level), stage == 1);
+          return TaskStatus::complete;
+        },
+        recv_flux | send_flux, pmb);
+    auto send = AddTask("SendBoundaryBuffers", C::SendBoundaryBuffersTask, update);
+    auto recv = AddTask("ReceiveBoundaryBuffers", C::ReceiveBoundaryBuffersTask, send);
+    auto set = AddTask("SetBoundaries", C::SetBoundariesTask, recv);
+    AddTask("ClearBoundary", C::ClearBoundaryTask, set);
+    tl.AddTask<BlockTask>(
+        TaskName("ProlongateBoundaries"),
+        [](MeshBlock *pmb) {
+          pmb->pbval->ProlongateBoundaries(0.0, 0.0);
+          return TaskStatus::complete;
+        },
+        set, pmb);
+    return tl;
+  }
+};
+
+// sets q to f(x1, x2) on the interior of all blocks and fills their ghost cells
+template <typename F>
+void Fill(Mesh *pmesh, const F &f) {
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &q = pmb->real_containers.Get().Get("q").data;
+    auto q_h = q.GetHostMirror();
+    const auto &bs = pmb->block_size;
+    const Real dx1 = (bs.x1max - bs.x1min) / bs.nx1, dx2 = (bs.x2max - bs.x2min) / bs.nx2;
+    for (int j = pmb->js; j <= pmb->je; j++) {
+      for (int i = pmb->is; i <= pmb->ie; i++) {
+        q_h(0, 0, j, i) =
+            f(bs.x1min + (i - pmb->is + 0.5) * dx1, bs.x2min + (j - pmb->js + 0.5) * dx2);
+      }
+    }
+    q.DeepCopy(q_h);
+  }
+  mesh_fixture::Exchange(pmesh);
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    pmb->pbval->ProlongateBoundaries(0.0, 0.0);
+  }
+}
+
+// the integral of q over the mesh and the largest deviation of q from value
+void Integrate(Mesh *pmesh, const Real value, Real &total, Real &deviation) {
+  Kokkos::fence();
+  total = 0.0, deviation = 0.0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &q = pmb->real_containers.Get().Get("q").data;
+    auto q_h = q.GetHostMirror();
+    q_h.DeepCopy(q);
+    const auto &bs = pmb->block_size;
+    const Real dv = (bs.x1max - bs.x1min) / bs.nx1 * (bs.x2max - bs.x2min) / bs.nx2;
+    for (int j = pmb->js; j <= pmb->je; j++) {
+      for (int i = pmb->is; i <= pmb->ie; i++) {
+        total += q_h(0, 0, j, i) * dv;
+        deviation = std::max(deviation, std::abs(q_h(0, 0, j, i) - value));
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Subcycled levels step with their own time step and conserve", "[Subcycling]") {
+  GIVEN("A periodic 2D mesh with a refined region in the middle and subcycling") {
+    ParameterInput pin;
+    const int nx = 32;
+    mesh_fixture::SetMeshParameters(&pin, 2, nx, 8);
+    pin.SetString("mesh", "refinement", "static");
+    pin.SetInteger("mesh", "numlevel", 2);
+    pin.SetReal("refinement1", "x1min", 0.4);
+    pin.SetReal("refinement1", "x1max", 0.6);
+    pin.SetReal("refinement1", "x2min", 0.4);
+    pin.SetReal("refinement1", "x2max", 0.6);
+    pin.SetInteger("refinement1", "level", 1);
+    pin.SetBoolean("time", "subcycling", true);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    const int root = pmesh->GetRootLevel();
+    REQUIRE(pmesh->subcycling);
+    REQUIRE(pmesh->GetCurrentLevel() == root + 1);
+    UpwindDriver driver(&pin, pmesh.get());
+    // a Courant number of 0.5 on both levels
+    pmesh->dt = 0.5 / nx;
+    REQUIRE(pmesh->LevelDt(root + 1) == 0.5 * pmesh->dt);
+
+    const int ncycles = 8;
+    WHEN("a bump is advected through the refined region") {
+      Fill(pmesh.get(), [](const Real x1, const Real x2) {
+        const Real r2 = (x1 - 0.3) * (x1 - 0.3) + (x2 - 0.5) * (x2 - 0.5);
+        return 1.0 + std::exp(-50.0 * r2);
+      });
+      Real total0, total, deviation;
+      Integrate(pmesh.get(), 0.0, total0, deviation);
+      for (int n = 0; n < ncycles; n++) {
+        driver.Step();
+      }
+      Integrate(pmesh.get(), 0.0, total, deviation);
+
+      THEN("the integral is conserved and the fine blocks take twice the steps") {
+        REQUIRE(total == Approx(total0).epsilon(1.0e-13));
+        int nroot = 0, nfine = 0;
+        for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+          (pmb->loc.level == root ? nroot : nfine)++;
+        }
+        REQUIRE(nfine > 0);
+        REQUIRE(driver.nsteps[root] == ncycles * nroot);
+        REQUIRE(driver.nsteps[root + 1] == 2 * ncycles * nfine);
+      }
+    }
+
+    WHEN("a constant state is advected") {
+      Fill(pmesh.get(), [](const Real, const Real) { return 2.0; });
+      for (int n = 0; n < ncycles; n++) {
+        driver.Step();
+      }
+      Real total, deviation;
+      Integrate(pmesh.get(), 2.0, total, deviation);
+      THEN("it stays constant on both levels") { REQUIRE(deviation < 1.0e-13); }
+    }
+
+    WHEN("the driver is asked to keep its task lists") {
+      pin.SetBoolean("time", "persistent_task_lists", true);
+      THEN("it refuses") {
+        REQUIRE_THROWS_AS(UpwindDriver(&pin, pmesh.get()), std::invalid_argument);
+      }
+    }
+  }
+}
@@ -0,0 +1,168 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "basic_types.hpp"
+#include "bvals/bvals_swarm.hpp"
+#include "interface/metadata.hpp"
+#include "interface/state_descriptor.hpp"
+#include "interface/swarm.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::DevSpace;
+using parthenon::MeshBlock;
+using parthenon::Metadata;
+using parthenon::par_for;
+using parthenon::par_reduce;
+using parthenon::ParameterInput;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+using parthenon::Swarm;
+
+TEST_CASE("Swarms are registered by packages", "[Swarm]") {
+  StateDescriptor pkg("test");
+  pkg.AddSwarm("tracers", Metadata());
+  pkg.AddSwarmValue("weight", "tracers", Metadata());
+  pkg.AddSwarmValue("id", "tracers", Metadata({Metadata::Integer}));
+  REQUIRE(pkg.AllSwarms().size() == 1);
+  REQUIRE(pkg.AllSwarmValues("tracers").size() == 2);
+  REQUIRE_THROWS_AS(pkg.AddSwarm("tracers", Metadata()), std::invalid_argument);
+  REQUIRE_THROWS_AS(pkg.AddSwarmValue("x", "tracers", Metadata()), std::invalid_argument);
+  REQUIRE_THROWS_AS(pkg.AddSwarmValue("w", "none", Metadata()), std::invalid_argument);
+}
+
+TEST_CASE("Particles are added, removed and moved between swarms", "[Swarm]") {
+  GIVEN("A swarm of 10 particles with x = slot and id = 100 + slot") {
+    Swarm swarm("tracers", Metadata());
+    swarm.Add("id", Metadata({Metadata::Integer}));
+    const int first = swarm.AddEmptyParticles(10);
+    REQUIRE(first == 0);
+    REQUIRE(swarm.GetNumActive() == 10);
+    REQUIRE(swarm.GetCapacity() >= 10);
+    auto x = swarm.GetReal("x");
+    auto id = swarm.GetInteger("id");
+    par_for(
+        "Swarm test", DevSpace(), 0, 9, KOKKOS_LAMBDA(const int p) {
+          x(p) = p;
+          id(p) = 100 + p;
+        });
+    REQUIRE(swarm.RealNames() == std::vector<std::string>({"x", "y", "z"}));
+    REQUIRE_THROWS_AS(swarm.GetReal("id"), std::invalid_argument);
+
+    WHEN("the odd particles are popped") {
+      auto marked = swarm.GetMarked();
+      par_for(
+          "Swarm test", DevSpace(), 0, 9,
+          KOKKOS_LAMBDA(const int p) { marked(p) = p % 2; });
+      std::vector<Real> reals;
+      std::vector<int> ints;
+      const int n = swarm.PopMarked(reals, ints);
+      THEN("their records are returned and the others stay in order") {
+        REQUIRE(n == 5);
+        REQUIRE(swarm.GetNumActive() == 5);
+        for (int p = 0; p < 5; p++) {
+          REQUIRE(reals[3 * p] == 2 * p + 1);
+          REQUIRE(ints[p] == 101 + 2 * p);
+        }
+        auto xk = swarm.GetReal("x");
+        auto idk = swarm.GetInteger("id");
+        int nwrong = 0;
+        par_reduce(
+            "Swarm test", DevSpace(), 0, 4,
+            KOKKOS_LAMBDA(const int p, int &nw) {
+              nw += (xk(p) != 2 * p) + (idk(p) != 100 + 2 * p);
+            },
+            Kokkos::Sum<int>(nwrong));
+        REQUIRE(nwrong == 0);
+      }
+      THEN("another swarm takes them") {
+        Swarm other("tracers", Metadata());
+        other.Add("id", Metadata({Metadata::Integer}));
+        other.Insert(reals.data(), ints.data(), n);
+        REQUIRE(other.GetNumActive() == 5);
+        auto xo = other.GetReal("x");
+        auto ido = other.GetInteger("id");
+        int nwrong = 0;
+        par_reduce(
+            "Swarm test", DevSpace(), 0, 4,
+            KOKKOS_LAMBDA(const int p, int &nw) {
+              nw += (xo(p) != 2 * p + 1) + (ido(p) != 101 + 2 * p);
+            },
+            Kokkos::Sum<int>(nwrong));
+        REQUIRE(nwrong == 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("Particles migrate to the block containing them", "[Swarm][SwarmBoundaries]") {
+  GIVEN("A periodic 1D mesh of two blocks with a swarm of tracers") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 1, 16, 8);
+    auto packages = mesh_fixture::Packages();
+    packages["Test"]->AddSwarm("tracers", Metadata());
+    packages["Test"]->AddSwarmValue("id", "tracers", Metadata({Metadata::Integer}));
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    REQUIRE(pmesh->nbtotal == 2);
+
+    // block 0 covers [0, 0.5) and block 1 [0.5, 1). Of the particles of block 0, id 0
+    // stays, id 1 moves to its neighbor and id 2 beyond the half width of a neighbor,
+    // where the destination is found with Mesh::LocateBlock. Id 3 leaves block 1
+    // through the periodic face and re-enters block 0.
+    const std::vector<std::vector<Real>> x = {{0.25, 0.6, 0.8}, {1.1}};
+    const std::vector<std::vector<int>> ids = {{0, 1, 2}, {3}};
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      Swarm &swarm = *pmb->swarms.at("tracers");
+      const int n = x[pmb->gid].size();
+      swarm.AddEmptyParticles(n);
+      auto x_h = Kokkos::create_mirror_view(swarm.GetReal("x"));
+      auto id_h = Kokkos::create_mirror_view(swarm.GetInteger("id"));
+      for (int p = 0; p < n; p++) {
+        x_h(p) = x[pmb->gid][p];
+        id_h(p) = ids[pmb->gid][p];
+      }
+      Kokkos::deep_copy(swarm.GetReal("x"), x_h);
+      Kokkos::deep_copy(swarm.GetInteger("id"), id_h);
+    }
+
+    WHEN("the particles are exchanged") {
+      parthenon::SwarmBoundaries::Exchange(pmesh.get(), "tracers");
+      THEN("every block holds the particles inside it") {
+        const std::vector<std::vector<int>> expected = {{0, 3}, {1, 2}};
+        for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+          Swarm &swarm = *pmb->swarms.at("tracers");
+          const int n = swarm.GetNumActive();
+          auto x_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(),
+                                                         swarm.GetReal("x"));
+          auto id_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(),
+                                                          swarm.GetInteger("id"));
+          std::vector<int> found;
+          for (int p = 0; p < n; p++) {
+            REQUIRE(x_h(p) >= pmb->block_size.x1min);
+            REQUIRE(x_h(p) < pmb->block_size.x1max);
+            found.push_back(id_h(p));
+          }
+          std::sort(found.begin(), found.end());
+          REQUIRE(found == expected[pmb->gid]);
+        }
+      }
+    }
+  }
+}
@@ -16,6 +16,7 @@
 //========================================================================================
 
 #include <string>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -48,5 +49,45 @@ TEST_CASE("Just check everything", "[CheckDependencies][SetFinished][equal][or]"
     WHEN("a negative number is passed") {
       REQUIRE_THROWS_AS(a.Set(-1), std::invalid_argument);
     }
+
+    WHEN("an id beyond the inline blocks is used") {
+      TaskID big(TASKID_INLINE_BLOCKS * BITBLOCK + 3);
+      TaskID abig = (a | big);
+      REQUIRE(abig.CheckDependencies(big) == true);
+      REQUIRE(ac.CheckDependencies(big) == false);
+      REQUIRE((abig == a) == false);
+      REQUIRE((a == abig) == false);
+      TaskID done;
+      done.SetFinished(abig);
+      REQUIRE(done == abig);
+    }
+  }
+}
+
+TEST_CASE("TaskID operations on the polling path", "[TaskID][benchmark]") {
+  // the ids and dependencies of a list with 32 tasks, each depending on its predecessor
+  std::vector<TaskID> ids, deps;
+  TaskID none(0);
+  for (int i = 1; i <= 32; i++) {
+    ids.emplace_back(i);
+    deps.push_back(i == 1 ? none : ids[i - 2]);
   }
+
+  BENCHMARK("CheckDependencies") {
+    int nready = 0;
+    TaskID completed;
+    for (int i = 0; i < 32; i++) {
+      if (completed.CheckDependencies(deps[i])) nready++;
+      completed.SetFinished(ids[i]);
+    }
+    return nready;
+  };
+
+  BENCHMARK("operator|") {
+    TaskID all;
+    for (const auto &id : ids) {
+      all = all | id;
+    }
+    return all == ids[0];
+  };
 }
@@ -0,0 +1,107 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "task_list/tasks.hpp"
+#include "utils/task_timer.hpp"
+
+using parthenon::SimpleTask;
+using parthenon::TaskID;
+using parthenon::TaskList;
+using parthenon::TaskListStatus;
+using parthenon::TaskName;
+using parthenon::TaskStatus;
+
+TEST_CASE("TaskList executes tasks in dependency order", "[TaskList][DoAvailable]") {
+  GIVEN("A diamond of tasks and a task that has to be retried") {
+    TaskList tl;
+    std::vector<int> order;
+    int attempts = 0;
+    TaskID none(0);
+    auto Record = [&order](int n) {
+      return [&order, n]() {
+        order.push_back(n);
+        return TaskStatus::complete;
+      };
+    };
+    auto a = tl.AddTask<SimpleTask>(Record(1), none);
+    auto b = tl.AddTask<SimpleTask>(
+        [&attempts, &order]() {
+          if (++attempts < 3) return TaskStatus::incomplete;
+          order.push_back(2);
+          return TaskStatus::complete;
+        },
+        a);
+    auto c = tl.AddTask<SimpleTask>(Record(3), a);
+    tl.AddTask<SimpleTask>(Record(4), b | c);
+
+    THEN("Ready tasks run in the order they were added, within the same call") {
+      REQUIRE(tl.DoAvailable() == TaskListStatus::running);
+      REQUIRE(order == std::vector<int>{1, 3});
+      REQUIRE(tl.Size() == 2);
+      AND_THEN("an incomplete task is retried until it completes") {
+        REQUIRE(tl.DoAvailable() == TaskListStatus::running);
+        REQUIRE(tl.DoAvailable() == TaskListStatus::complete);
+        REQUIRE(attempts == 3);
+        REQUIRE(order == std::vector<int>{1, 3, 2, 4});
+        REQUIRE(tl.IsComplete());
+      }
+    }
+  }
+
+  GIVEN("A task that depends on a task that is not in the list") {
+    TaskList tl;
+    bool ran = false;
+    tl.AddTask<SimpleTask>(
+        [&ran]() {
+          ran = true;
+          return TaskStatus::complete;
+        },
+        TaskID(5));
+    THEN("It never runs") {
+      REQUIRE(tl.DoAvailable() == TaskListStatus::running);
+      REQUIRE(tl.DoAvailable() == TaskListStatus::running);
+      REQUIRE(ran == false);
+    }
+  }
+}
+
+TEST_CASE("Named tasks run like unnamed ones", "[TaskList][TaskTimer]") {
+  GIVEN("A named and an unnamed task with the task timers enabled") {
+    auto &timer = parthenon::TaskTimer::Get();
+    timer.Enable(true);
+    TaskList tl;
+    std::vector<int> order;
+    TaskID none(0);
+    auto a = tl.AddTask<SimpleTask>(TaskName("first"),
+                                    [&order]() {
+                                      order.push_back(1);
+                                      return TaskStatus::complete;
+                                    },
+                                    none);
+    tl.AddTask<SimpleTask>(
+        [&order]() {
+          order.push_back(2);
+          return TaskStatus::complete;
+        },
+        a);
+    THEN("Both run in dependency order") {
+      REQUIRE(tl.DoAvailable() == TaskListStatus::complete);
+      REQUIRE(order == std::vector<int>{1, 2});
+    }
+    timer.Enable(false);
+  }
+}
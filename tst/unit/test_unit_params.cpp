@@ -19,6 +19,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <Kokkos_Core.hpp>
+
 #include "interface/params.hpp"
 
 using parthenon::Params;
@@ -77,3 +79,40 @@ TEST_CASE("when hasKey is called", "[hasKey]") {
     }
   }
 }
+
+TEST_CASE("Handles to parameters are used", "[Add,GetHandle,DeviceValues]") {
+  GIVEN("A key added with Add") {
+    Params params;
+    auto handle = params.Add("test_key", -2.0);
+    REQUIRE(handle.IsValid());
+    REQUIRE(*handle == Approx(-2.0));
+    REQUIRE(handle.DeviceIndex() == -1);
+
+    WHEN("a handle is looked up by key") {
+      auto other = params.GetHandle<double>("test_key");
+      REQUIRE(&*other == &*handle);
+      REQUIRE_THROWS_AS(params.GetHandle<int>("test_key"), std::invalid_argument);
+    }
+  }
+
+  GIVEN("Scalar keys mirrored to the device") {
+    Params params;
+    params.Add("host_only", std::string("value"));
+    auto a = params.AddMirrored("a", 3);
+    auto b = params.AddMirrored("b", 0.5);
+    REQUIRE(a.DeviceIndex() == 0);
+    REQUIRE(b.DeviceIndex() == 1);
+    REQUIRE(params.GetHandle<double>("b").DeviceIndex() == 1);
+
+    auto values = params.DeviceValues();
+    parthenon::Real sum = 0.0;
+    const int ia = a.DeviceIndex(), ib = b.DeviceIndex();
+    Kokkos::parallel_reduce(
+        "sum mirrored params", 1,
+        KOKKOS_LAMBDA(const int, parthenon::Real &lsum) {
+          lsum += values(ia) + values(ib);
+        },
+        sum);
+    REQUIRE(sum == Approx(3.5));
+  }
+}
@@ -0,0 +1,132 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "coordinates/device_coordinates.hpp"
+#include "interface/meshblock_pack.hpp"
+#include "interface/update.hpp"
+#include "interface/update_timestep.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::DeviceCoordinates;
+using parthenon::Mesh;
+using parthenon::MeshBlock;
+using parthenon::MeshBlockPack;
+using parthenon::ParameterInput;
+using parthenon::Real;
+
+namespace {
+
+// a time step that depends on the state, so that it differs from cell to cell and from
+// block to block
+struct StateTimestep {
+  KOKKOS_INLINE_FUNCTION Real operator()(const MeshBlockPack<Real> &q,
+                                         const DeviceCoordinates &coords, const int b,
+                                         const int k, const int j, const int i) const {
+    const Real u = q(b, 0, k, j, i);
+    return coords.Dx1f(i) / (1.0 + u * u);
+  }
+};
+
+// sets q of the container name on block b to f(b, j, i), ghost cells included
+template <typename F>
+void Fill(Mesh *pmesh, const std::string &name, const F &f) {
+  int b = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next, b++) {
+    auto &q = pmb->real_containers.Get(name).Get("q").data;
+    auto q_h = q.GetHostMirror();
+    for (int j = 0; j < q.GetDim(2); j++) {
+      for (int i = 0; i < q.GetDim(1); i++) {
+        q_h(0, j, i) = f(b, j, i);
+      }
+    }
+    q.DeepCopy(q_h);
+  }
+}
+
+// the interior cells in which q of the containers name1 and name2 differ
+int DifferentCells(Mesh *pmesh, const std::string &name1, const std::string &name2) {
+  int ndiff = 0;
+  for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+    auto &q1 = pmb->real_containers.Get(name1).Get("q").data;
+    auto &q2 = pmb->real_containers.Get(name2).Get("q").data;
+    auto q1_h = q1.GetHostMirror();
+    auto q2_h = q2.GetHostMirror();
+    q1_h.DeepCopy(q1);
+    q2_h.DeepCopy(q2);
+    for (int j = pmb->js; j <= pmb->je; j++) {
+      for (int i = pmb->is; i <= pmb->ie; i++) {
+        if (std::abs(q1_h(0, j, i) - q2_h(0, j, i)) > 1.0e-14) ndiff++;
+      }
+    }
+  }
+  return ndiff;
+}
+
+} // namespace
+
+TEST_CASE("The fused stage update and time step estimate match the separate ones",
+          "[Update]") {
+  GIVEN("A 2D mesh of four blocks with a state, a second register and a dU/dt") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 16, 8);
+    auto packages = mesh_fixture::Packages();
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+      auto &base = pmb->real_containers.Get();
+      for (const std::string name : {"u1", "dUdt", "separate", "fused"}) {
+        pmb->real_containers.Add(name, base);
+      }
+    }
+    Fill(pmesh.get(), "base",
+         [](const int b, const int j, const int i) { return 0.1 * i + 0.01 * j + b; });
+    Fill(pmesh.get(), "u1",
+         [](const int b, const int j, const int i) { return 0.5 - 0.02 * i * b; });
+    Fill(pmesh.get(), "dUdt",
+         [](const int b, const int j, const int i) { return 0.3 * j - 0.1 * b; });
+    const Real wgt0 = 0.25, wgt1 = 0.75, dt = 0.1;
+
+    WHEN("the update of the last stage is followed by the time step estimate") {
+      parthenon::Update::StageUpdate(pmesh.get(), "base", "u1", "dUdt", wgt0, wgt1, dt,
+                                     "separate");
+      parthenon::Update::EstimateTimestep(pmesh.get(), "separate", StateTimestep());
+      std::vector<Real> separate_dt;
+      for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next) {
+        separate_dt.push_back(pmb->GetBlockTimestep());
+        pmb->SetBlockTimestep(0.0);
+      }
+
+      AND_WHEN("the same update estimates the time steps in its own launch") {
+        parthenon::Update::StageUpdateAndEstimateTimestep(
+            pmesh.get(), "base", "u1", "dUdt", wgt0, wgt1, dt, "fused", StateTimestep());
+
+        THEN("the new states and the time steps of all blocks are the same") {
+          REQUIRE(DifferentCells(pmesh.get(), "separate", "fused") == 0);
+          int b = 0;
+          for (MeshBlock *pmb = pmesh->pblock; pmb != nullptr; pmb = pmb->next, b++) {
+            REQUIRE(separate_dt[b] > 0.0);
+            REQUIRE(pmb->GetBlockTimestep() == Approx(separate_dt[b]).epsilon(1.0e-14));
+          }
+          // the estimate reads the new state, which differs between the blocks
+          REQUIRE(separate_dt[0] != Approx(separate_dt[3]));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,135 @@
+//========================================================================================
+// (C) (or copyright) 2020. Triad National Security, LLC. All rights reserved.
+//
+// This program was produced under U.S. Government contract 89233218CNA000001 for Los
+// Alamos National Laboratory (LANL), which is operated by Triad National Security, LLC
+// for the U.S. Department of Energy/National Nuclear Security Administration. All rights
+// in the program are reserved by Triad National Security, LLC, and the U.S. Department
+// of Energy/National Nuclear Security Administration. The Government is granted for
+// itself and others acting on its behalf a nonexclusive, paid-up, irrevocable worldwide
+// license in this material to reproduce, prepare derivative works, distribute copies to
+// the public, perform publicly and display publicly, and to permit others to do so.
+//========================================================================================
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "interface/container_iterator.hpp"
+#include "kokkos_abstraction.hpp"
+#include "mesh_fixture.hpp"
+
+using parthenon::Container;
+using parthenon::ContainerIterator;
+using parthenon::MeshBlock;
+using parthenon::Metadata;
+using parthenon::Packages_t;
+using parthenon::ParameterInput;
+using parthenon::Real;
+using parthenon::StateDescriptor;
+
+namespace {
+
+// sets component l of the v-th independent variable of rc to f(v, l), ghosts included
+template <typename F>
+void Fill(Container<Real> &rc, const F &f) {
+  ContainerIterator<Real> iter(rc, {Metadata::Independent});
+  for (int v = 0; v < static_cast<int>(iter.vars.size()); v++) {
+    auto &q = iter.vars[v]->data;
+    auto q_h = q.GetHostMirror();
+    for (int l = 0; l < q.GetDim(4); l++)
+      for (int j = 0; j < q.GetDim(2); j++)
+        for (int i = 0; i < q.GetDim(1); i++)
+          q_h(l, 0, j, i) = f(v, l);
+    q.DeepCopy(q_h);
+  }
+}
+
+// the interior cells of rc whose component l of the v-th variable is not f(v, l)
+template <typename F>
+int WrongCells(MeshBlock *pmb, Container<Real> &rc, const F &f) {
+  Kokkos::fence();
+  ContainerIterator<Real> iter(rc, {Metadata::Independent});
+  int nwrong = 0;
+  for (int v = 0; v < static_cast<int>(iter.vars.size()); v++) {
+    auto &q = iter.vars[v]->data;
+    auto q_h = q.GetHostMirror();
+    q_h.DeepCopy(q);
+    for (int l = 0; l < q.GetDim(4); l++)
+      for (int j = pmb->js; j <= pmb->je; j++)
+        for (int i = pmb->is; i <= pmb->ie; i++)
+          if (std::abs(q_h(l, 0, j, i) - f(v, l)) > 1.0e-12) nwrong++;
+  }
+  return nwrong;
+}
+
+} // namespace
+
+TEST_CASE("WeightedAve of containers covers all of their variables", "[WeightedAve]") {
+  GIVEN("A block with ten independent variables, one of them with three components") {
+    ParameterInput pin;
+    mesh_fixture::SetMeshParameters(&pin, 2, 8, 8);
+    auto pkg = std::make_shared<StateDescriptor>("Test");
+    Metadata one({Metadata::Cell, Metadata::Independent, Metadata::FillGhost});
+    Metadata three({Metadata::Cell, Metadata::Independent, Metadata::FillGhost},
+                   std::vector<int>({3}));
+    pkg->AddField("b", three);
+    // more variables than one launch takes
+    for (int v = 0; v < 9; v++) {
+      pkg->AddField("a" + std::to_string(v), one);
+    }
+    Packages_t packages;
+    packages["Test"] = pkg;
+    auto pmesh = mesh_fixture::MakeMesh(&pin, packages);
+    MeshBlock *pmb = pmesh->pblock;
+    Container<Real> &u = pmb->real_containers.Get();
+    pmb->real_containers.Add("u1", u);
+    pmb->real_containers.Add("u2", u);
+    Container<Real> &u1 = pmb->real_containers.Get("u1");
+    Container<Real> &u2 = pmb->real_containers.Get("u2");
+    auto f0 = [](const int v, const int l) { return 1.0 + v + 0.5 * l; };
+    auto f1 = [](const int v, const int l) { return 2.0 * (v + 1) - l; };
+    auto f2 = [](const int v, const int l) { return 0.25 * l - v; };
+    Fill(u, f0);
+    Fill(u1, f1);
+    Fill(u2, f2);
+
+    WHEN("all three weights are general") {
+      const Real wght[3] = {0.5, 2.0, -1.0};
+      pmb->WeightedAve(u, u1, u2, wght);
+      THEN("every component of every variable is the weighted sum") {
+        REQUIRE(WrongCells(pmb, u, [&](const int v, const int l) {
+                  return 0.5 * f0(v, l) + 2.0 * f1(v, l) - f2(v, l);
+                }) == 0);
+      }
+    }
+
+    WHEN("the weights copy the first input") {
+      const Real wght[3] = {0.0, 1.0, 0.0};
+      pmb->WeightedAve(u, u1, u2, wght);
+      THEN("every variable holds its values") { REQUIRE(WrongCells(pmb, u, f1) == 0); }
+    }
+
+    WHEN("the weights accumulate the first input") {
+      const Real wght[3] = {1.0, 3.0, 0.0};
+      pmb->WeightedAve(u, u1, u2, wght);
+      THEN("every variable grows by three times its values") {
+        REQUIRE(WrongCells(pmb, u, [&](const int v, const int l) {
+                  return f0(v, l) + 3.0 * f1(v, l);
+                }) == 0);
+      }
+    }
+
+    WHEN("the containers are averaged by Update::AverageContainers") {
+      parthenon::Update::AverageContainers(u, u1, 0.25);
+      THEN("the result is the same weighted sum") {
+        REQUIRE(WrongCells(pmb, u, [&](const int v, const int l) {
+                  return 0.25 * f0(v, l) + 0.75 * f1(v, l);
+                }) == 0);
+      }
+    }
+  }
+}